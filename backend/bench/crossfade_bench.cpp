@@ -0,0 +1,176 @@
+/**
+ * 交叉淡化混音基准
+ *
+ * 对每个指令集（不超过当前 CPU 支持的最高级别）测量：
+ *   - 混音内核 mixCrossfade 的吞吐（帧/微秒，立体声），输出与标量实现比较，应当逐位一致
+ *   - Crossfader 按输出周期混合一次完整淡化的吞吐，以及混音循环中的内存分配次数（应为 0）
+ * 另外检查等功率曲线的折线逼近：对常数 1 的两路混合，各帧增益与精确的 sin / cos 比较。
+ *
+ * 用法: musicfree_crossfade_bench [fade_ms] [rounds]
+ */
+
+#include "../src/core/audio_mixer.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <vector>
+
+using namespace musicfree;
+
+namespace {
+
+// 统计混音循环中的分配：替换全局 operator new
+std::atomic<uint64_t> allocations{0};
+
+}  // namespace
+
+void* operator new(size_t size) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size == 0 ? 1 : size)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+    std::free(p);
+}
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr int kChannels = 2;
+constexpr int kSampleRate = 44100;
+constexpr size_t kPeriodFrames = 1024;
+constexpr size_t kKernelFrames = 4096;
+
+void fillNoise(std::vector<float>& samples, uint32_t seed) {
+    for (float& sample : samples) {
+        seed = seed * 1664525u + 1013904223u;
+        sample = static_cast<float>(static_cast<int16_t>(seed >> 16)) / 32768.0f;
+    }
+}
+
+double kernelRate(const std::vector<float>& a, const std::vector<float>& b, int rounds, SimdLevel level) {
+    std::vector<float> out(a.size());
+    double best = 1e18;
+    for (int i = 0; i < rounds; ++i) {
+        std::copy(a.begin(), a.end(), out.begin());
+        auto begin = Clock::now();
+        mixCrossfade(out.data(), b.data(), kKernelFrames, kChannels, 1.0f, -1.0f / kKernelFrames, 0.0f,
+                     1.0f / kKernelFrames, level);
+        best = std::min(best, std::chrono::duration<double, std::micro>(Clock::now() - begin).count());
+    }
+    return static_cast<double>(kKernelFrames) / best;
+}
+
+double kernelDifference(const std::vector<float>& a, const std::vector<float>& b, SimdLevel level) {
+    std::vector<float> expected(a), actual(a);
+    mixCrossfade(expected.data(), b.data(), kKernelFrames, kChannels, 0.9f, -0.7f / kKernelFrames, 0.1f,
+                 0.8f / kKernelFrames, SimdLevel::SCALAR);
+    mixCrossfade(actual.data(), b.data(), kKernelFrames, kChannels, 0.9f, -0.7f / kKernelFrames, 0.1f,
+                 0.8f / kKernelFrames, level);
+    double diff = 0;
+    for (size_t i = 0; i < expected.size(); ++i) {
+        diff = std::max(diff, std::fabs(static_cast<double>(expected[i]) - actual[i]));
+    }
+    return diff;
+}
+
+/**
+ * 按输出周期混合一次完整淡化，返回帧/微秒；allocs 输出混音循环中的分配次数
+ */
+double fadeRate(size_t fadeFrames, SimdLevel level, uint64_t& allocs) {
+    std::vector<float> out(kPeriodFrames * kChannels), in(kPeriodFrames * kChannels);
+    fillNoise(out, 1);
+    fillNoise(in, 2);
+    Crossfader crossfader(kChannels, level);
+
+    uint64_t before = allocations.load(std::memory_order_relaxed);
+    auto begin = Clock::now();
+    crossfader.start(fadeFrames, CrossfadeCurve::EQUAL_POWER);
+    while (crossfader.position() < crossfader.length()) {
+        crossfader.mix(out.data(), in.data(), kPeriodFrames);
+    }
+    double us = std::chrono::duration<double, std::micro>(Clock::now() - begin).count();
+    allocs = allocations.load(std::memory_order_relaxed) - before;
+    return static_cast<double>(fadeFrames) / us;
+}
+
+/**
+ * 等功率曲线折线逼近的最大增益误差
+ */
+double curveError(size_t fadeFrames) {
+    // 一路为 1、另一路为 0，混合结果就是为 1 的那一路的增益
+    std::vector<float> ones(kPeriodFrames * kChannels, 1.0f);
+    std::vector<float> fadeOut(ones.size()), fadeIn(ones.size()), zeros(ones.size());
+    Crossfader outOnly(kChannels), inOnly(kChannels);
+    outOnly.start(fadeFrames, CrossfadeCurve::EQUAL_POWER);
+    inOnly.start(fadeFrames, CrossfadeCurve::EQUAL_POWER);
+
+    double error = 0;
+    for (size_t frame = 0; frame < fadeFrames; frame += kPeriodFrames) {
+        size_t n = std::min(kPeriodFrames, fadeFrames - frame);
+        std::fill(fadeOut.begin(), fadeOut.end(), 1.0f);
+        std::fill(fadeIn.begin(), fadeIn.end(), 0.0f);
+        outOnly.mix(fadeOut.data(), zeros.data(), n);
+        inOnly.mix(fadeIn.data(), ones.data(), n);
+        for (size_t f = 0; f < n; ++f) {
+            float x = static_cast<float>(frame + f) / static_cast<float>(fadeFrames);
+            error = std::max(error, std::fabs(static_cast<double>(fadeOut[f * kChannels]) -
+                                              Crossfader::curveGain(CrossfadeCurve::EQUAL_POWER, x, false)));
+            error = std::max(error, std::fabs(static_cast<double>(fadeIn[f * kChannels]) -
+                                              Crossfader::curveGain(CrossfadeCurve::EQUAL_POWER, x, true)));
+        }
+    }
+    return error;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    int fadeMs = argc > 1 ? std::atoi(argv[1]) : 5000;
+    int rounds = argc > 2 ? std::atoi(argv[2]) : 2000;
+    if (fadeMs <= 0 || rounds <= 0) {
+        std::fprintf(stderr, "usage: musicfree_crossfade_bench [fade_ms] [rounds]\n");
+        return 1;
+    }
+    size_t fadeFrames = static_cast<size_t>(fadeMs) * kSampleRate / 1000;
+
+    std::vector<float> a(kKernelFrames * kChannels), b(kKernelFrames * kChannels);
+    fillNoise(a, 12345);
+    fillNoise(b, 67890);
+
+    std::printf("kernel %zu frames, fade %d ms (%zu frames) in %zu-frame periods, cpu supports %s\n",
+                kKernelFrames, fadeMs, fadeFrames, kPeriodFrames, simdLevelName(detectSimdLevel()));
+    bool ok = true;
+    for (int level = 0; level <= static_cast<int>(detectSimdLevel()); ++level) {
+        SimdLevel simd = static_cast<SimdLevel>(level);
+        double rate = kernelRate(a, b, rounds, simd);
+        double diff = kernelDifference(a, b, simd);
+        uint64_t allocs = 0;
+        double fade = fadeRate(fadeFrames, simd, allocs);
+        bool match = diff == 0.0 && allocs == 0;
+        ok = ok && match;
+        std::printf("%-8s kernel %9.1f frames/us   fade %9.1f frames/us   max diff %.3g   allocations %llu%s\n",
+                    simdLevelName(simd), rate, fade, diff, static_cast<unsigned long long>(allocs),
+                    match ? "" : "  FAIL");
+    }
+
+    double error = curveError(fadeFrames);
+    // 折线逼近的误差应低于 16 位量化步长的一半
+    bool accurate = error < 0.5 / 32768.0;
+    ok = ok && accurate;
+    std::printf("equal-power curve: max gain error %.3g (%.1f dB)%s\n", error, 20.0 * std::log10(error + 1e-30),
+                accurate ? "" : "  FAIL");
+    return ok ? 0 : 1;
+}
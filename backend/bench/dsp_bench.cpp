@@ -0,0 +1,221 @@
+/**
+ * DSP 处理链基准（均衡器 + 限幅器）
+ *
+ * 10 个频段（低频搁架 + 8 个峰值 + 高频搁架，增益交替 ±6 dB）、限幅器开启，
+ * 对 8 声道和立体声、每个指令集（不超过当前 CPU 支持的最高级别）测量：
+ *   - 吞吐（帧/微秒）和一路 48 kHz 实时流占用单核的百分比
+ *   - 与标量实现的输出比较，应当逐位一致
+ *   - 处理循环中的内存分配次数（另一个线程同时不停地发布新设置），应为 0
+ * 另外检查：峰值频段在中心频率的增益、限幅器输出不超过阈值、publish() 的耗时。
+ *
+ * 用法: musicfree_dsp_bench [periods] [rounds]
+ */
+
+#include "../src/core/audio_dsp.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <thread>
+#include <vector>
+
+using namespace musicfree;
+
+namespace {
+
+// 统计处理循环中的分配：替换全局 operator new
+std::atomic<uint64_t> allocations{0};
+
+}  // namespace
+
+void* operator new(size_t size) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size == 0 ? 1 : size)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+    std::free(p);
+}
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr int kSampleRate = 48000;
+constexpr size_t kPeriodFrames = 1024;
+constexpr double kPi = 3.14159265358979323846;
+
+void fillNoise(std::vector<float>& samples, uint32_t seed) {
+    for (float& sample : samples) {
+        seed = seed * 1664525u + 1013904223u;
+        sample = static_cast<float>(static_cast<int16_t>(seed >> 16)) / 65536.0f;
+    }
+}
+
+EqualizerSettings tenBands(double sign) {
+    EqualizerSettings settings;
+    settings.enabled = true;
+    settings.preampDb = -3;
+    const double frequencies[] = {31, 62, 125, 250, 500, 1000, 2000, 4000, 8000, 16000};
+    for (int i = 0; i < 10; ++i) {
+        EqBand band;
+        band.type = i == 0 ? EqBandType::LOW_SHELF : i == 9 ? EqBandType::HIGH_SHELF : EqBandType::PEAKING;
+        band.frequency = frequencies[i];
+        band.gainDb = (i % 2 == 0 ? 6.0 : -6.0) * sign;
+        band.q = 1.41;
+        settings.bands.push_back(band);
+    }
+    return settings;
+}
+
+/**
+ * 按周期处理 input，结果写进 output
+ */
+void run(DspChain& chain, const std::vector<float>& input, std::vector<float>& output, int channels) {
+    output = input;
+    size_t period = kPeriodFrames * static_cast<size_t>(channels);
+    for (size_t i = 0; i < output.size(); i += period) {
+        chain.process(output.data() + i, kPeriodFrames);
+    }
+}
+
+/**
+ * 单个正弦通过处理链之后的增益（dB），取后半段的峰值
+ */
+double sineGainDb(const EqualizerSettings& settings, double frequency, double amplitude, double* peak = nullptr) {
+    DspChain chain(kSampleRate, 2);
+    chain.publish(settings);
+    size_t frames = kPeriodFrames * 48;
+    std::vector<float> samples(frames * 2);
+    for (size_t i = 0; i < frames; ++i) {
+        float value = static_cast<float>(amplitude * std::sin(2.0 * kPi * frequency * static_cast<double>(i) /
+                                                              kSampleRate));
+        samples[i * 2] = value;
+        samples[i * 2 + 1] = value;
+    }
+    for (size_t i = 0; i < frames; i += kPeriodFrames) {
+        chain.process(samples.data() + i * 2, kPeriodFrames);
+    }
+    double max = 0;
+    for (size_t i = frames / 2; i < frames; ++i) {
+        max = std::max(max, static_cast<double>(std::fabs(samples[i * 2])));
+    }
+    if (peak != nullptr) {
+        *peak = max;
+    }
+    return 20.0 * std::log10(max / amplitude);
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    size_t periods = argc > 1 ? static_cast<size_t>(std::max(1, std::atoi(argv[1]))) : 64;
+    int rounds = argc > 2 ? std::max(1, std::atoi(argv[2])) : 5;
+    bool pass = true;
+
+    EqualizerSettings settings[2] = {tenBands(1.0), tenBands(-1.0)};
+    std::printf("10 bands, limiter on, %zu periods of %zu frames at %d Hz\n", periods, kPeriodFrames, kSampleRate);
+    for (int channels : {8, 2}) {
+        std::vector<float> input(periods * kPeriodFrames * static_cast<size_t>(channels));
+        fillNoise(input, 7);
+        std::vector<float> reference;
+        {
+            DspChain chain(kSampleRate, channels, SimdLevel::SCALAR);
+            chain.publish(settings[0]);
+            run(chain, input, reference, channels);
+        }
+
+        for (int l = 0; l <= static_cast<int>(detectSimdLevel()); ++l) {
+            SimdLevel level = static_cast<SimdLevel>(l);
+            DspChain chain(kSampleRate, channels, level);
+            chain.publish(settings[0]);
+            std::vector<float> output;
+            run(chain, input, output, channels);
+            bool exact = output == reference;
+
+            // 计时：每轮从同一份输入开始，复制不计入耗时；另一个线程同时不停地发布设置
+            std::vector<float> buffer(input);
+            std::atomic<bool> done{false};
+            std::thread publisher([&] {
+                for (uint64_t i = 0; !done.load(std::memory_order_relaxed); ++i) {
+                    chain.publish(settings[i % 2]);
+                    std::this_thread::sleep_for(std::chrono::microseconds(200));
+                }
+            });
+            double best = 1e18;
+            uint64_t before = allocations.load();
+            for (int r = 0; r < rounds; ++r) {
+                std::copy(input.begin(), input.end(), buffer.begin());
+                auto begin = Clock::now();
+                for (size_t i = 0; i < buffer.size(); i += kPeriodFrames * static_cast<size_t>(channels)) {
+                    chain.process(buffer.data() + i, kPeriodFrames);
+                }
+                best = std::min(best, std::chrono::duration<double, std::micro>(Clock::now() - begin).count());
+            }
+            uint64_t allocs = allocations.load() - before;
+            done.store(true);
+            publisher.join();
+
+            double framesPerUs = static_cast<double>(periods * kPeriodFrames) / best;
+            double core = kSampleRate / framesPerUs / 1e4;
+            std::printf("%d ch  %-8s %9.1f frames/us  %6.3f%% core per stream  %s  allocations %llu\n", channels,
+                        simdLevelName(level), framesPerUs, core, exact ? "matches scalar" : "DIFFERS FROM SCALAR",
+                        static_cast<unsigned long long>(allocs));
+            if (!exact || allocs != 0) {
+                pass = false;
+            }
+        }
+    }
+
+    // 峰值频段：中心频率 +6 dB，远离中心接近 0 dB
+    EqualizerSettings peaking;
+    peaking.enabled = true;
+    peaking.limiter = false;
+    EqBand band;
+    band.frequency = 1000;
+    band.gainDb = 6;
+    band.q = 1;
+    peaking.bands.push_back(band);
+    double center = sineGainDb(peaking, 1000, 0.25);
+    double far = sineGainDb(peaking, 60, 0.25);
+    std::printf("\npeaking +6 dB     %.3f dB at 1 kHz, %.3f dB at 60 Hz\n", center, far);
+    if (std::fabs(center - 6.0) > 0.05 || std::fabs(far) > 0.1) {
+        pass = false;
+    }
+
+    // 限幅器：+6 dBFS 的正弦，阈值 -1 dBFS
+    EqualizerSettings limited;
+    limited.enabled = true;
+    double peak = 0;
+    sineGainDb(limited, 440, 2.0, &peak);
+    double ceiling = std::pow(10.0, limited.limiterThresholdDb / 20.0);
+    std::printf("limiter           +6 dBFS sine -> peak %.6f (threshold %.6f)\n", peak, ceiling);
+    if (peak > ceiling * (1.0 + 1e-6)) {
+        pass = false;
+    }
+
+    // 发布耗时：计算 10 个频段的系数并交换
+    {
+        DspChain chain(kSampleRate, 8);
+        const int publishes = 20000;
+        auto begin = Clock::now();
+        for (int i = 0; i < publishes; ++i) {
+            chain.publish(settings[i % 2]);
+        }
+        double ns = std::chrono::duration<double, std::nano>(Clock::now() - begin).count() / publishes;
+        std::printf("publish           %.0f ns per call (10 bands)\n", ns);
+    }
+
+    std::printf("%s\n", pass ? "PASS" : "FAIL");
+    return pass ? 0 : 1;
+}
@@ -0,0 +1,235 @@
+/**
+ * 音频引擎离线基准
+ *
+ * 生成若干首 WAV（16 位立体声噪声），用不限速的输出端把整张列表无缝播完，测量：
+ *   - 实时倍率：音频时长 / 实际耗时
+ *   - 每首曲目在各阶段的耗时：解码（读数据源写环形缓冲区）、混音（取数据、切换、交叉淡化）、
+ *     增益、写输出端，以及进程总 CPU 时间
+ * 依次运行三种配置：丢弃输出；写 WAV 文件；丢弃输出并开启交叉淡化。
+ * 检查：没有欠载，每首都无缝切换；写出的 WAV 帧数等于各曲目之和，且与输入逐采样一致。
+ *
+ * 用法: musicfree_engine_bench [tracks] [seconds_per_track] [dir]
+ */
+
+#include "../include/audio_engine.h"
+#include <sys/stat.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace musicfree;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr int kSampleRate = 44100;
+constexpr int kChannels = 2;
+constexpr int kCrossfadeMs = 2000;
+constexpr size_t kWavHeaderBytes = 44;
+
+void putLe16(uint8_t* p, uint16_t value) {
+    p[0] = static_cast<uint8_t>(value);
+    p[1] = static_cast<uint8_t>(value >> 8);
+}
+
+void putLe32(uint8_t* p, uint32_t value) {
+    for (int i = 0; i < 4; ++i) {
+        p[i] = static_cast<uint8_t>(value >> (8 * i));
+    }
+}
+
+/**
+ * 写一首 16 位立体声 WAV，内容为确定的伪随机噪声
+ * @param samples 输出写入的采样（归一化到 float），供之后比对
+ */
+bool writeTrack(const std::string& path, uint64_t frames, uint32_t seed, std::vector<float>& samples) {
+    std::vector<uint8_t> data(kWavHeaderBytes + frames * kChannels * 2);
+    uint8_t* h = data.data();
+    std::copy_n("RIFF", 4, h);
+    putLe32(h + 4, static_cast<uint32_t>(data.size() - 8));
+    std::copy_n("WAVEfmt ", 8, h + 8);
+    putLe32(h + 16, 16);
+    putLe16(h + 20, 1);
+    putLe16(h + 22, kChannels);
+    putLe32(h + 24, kSampleRate);
+    putLe32(h + 28, kSampleRate * kChannels * 2);
+    putLe16(h + 32, kChannels * 2);
+    putLe16(h + 34, 16);
+    std::copy_n("data", 4, h + 36);
+    putLe32(h + 40, static_cast<uint32_t>(frames * kChannels * 2));
+
+    uint8_t* p = h + kWavHeaderBytes;
+    for (uint64_t i = 0; i < frames * kChannels; ++i) {
+        seed = seed * 1664525u + 1013904223u;
+        int16_t value = static_cast<int16_t>(seed >> 16) / 4;
+        putLe16(p, static_cast<uint16_t>(value));
+        p += 2;
+        samples.push_back(static_cast<float>(value) * (1.0f / 32768.0f));
+    }
+
+    FILE* file = std::fopen(path.c_str(), "wb");
+    if (!file) {
+        return false;
+    }
+    bool ok = std::fwrite(data.data(), 1, data.size(), file) == data.size();
+    return std::fclose(file) == 0 && ok;
+}
+
+struct RunResult {
+    double audioSeconds = 0;
+    double wallSeconds = 0;
+    double cpuSeconds = 0;
+    AudioEngineMetrics metrics;
+};
+
+/**
+ * 播放整张列表直到引擎停下
+ */
+RunResult runPlaylist(const std::vector<std::string>& files, AudioEngineOptions options, int crossfadeMs) {
+    options.volumeRampMs = 0;
+    options.crossfadeMs = crossfadeMs;
+    RunResult result;
+    std::clock_t cpuBegin = std::clock();
+    auto begin = Clock::now();
+    {
+        AudioEngine engine(options);
+        std::atomic<size_t> next{1};
+        engine.setNextTrackProvider([&](std::string& filePath) {
+            size_t index = next.fetch_add(1);
+            if (index >= files.size()) {
+                return false;
+            }
+            filePath = files[index];
+            return true;
+        });
+        engine.setVolume(100);
+        engine.load(files[0]);
+        engine.play();
+        while (engine.getState() == PlayState::PLAYING) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        result.metrics = engine.getMetrics();
+    }
+    result.wallSeconds = std::chrono::duration<double>(Clock::now() - begin).count();
+    result.cpuSeconds = static_cast<double>(std::clock() - cpuBegin) / CLOCKS_PER_SEC;
+    result.audioSeconds = static_cast<double>(result.metrics.framesPlayed) / kSampleRate;
+    return result;
+}
+
+void report(const char* name, const RunResult& r, size_t tracks) {
+    double perTrack = 1000.0 / static_cast<double>(tracks);
+    std::printf("%-10s %8.1f s audio in %7.3f s  %7.1fx realtime  cpu/track %7.2f ms  "
+                "decode %6.2f  mix %6.2f  dsp %6.2f  sink %6.2f ms/track  underruns %llu  transitions %llu\n",
+                name, r.audioSeconds, r.wallSeconds, r.audioSeconds / r.wallSeconds, r.cpuSeconds * perTrack,
+                r.metrics.decodeTime.sum() / 1e9 * perTrack, r.metrics.mixNanos / 1e9 * perTrack,
+                r.metrics.dspNanos / 1e9 * perTrack, r.metrics.sinkNanos / 1e9 * perTrack,
+                static_cast<unsigned long long>(r.metrics.underruns),
+                static_cast<unsigned long long>(r.metrics.gaplessTransitions));
+}
+
+/**
+ * 读回 WAV 输出端写的文件（float32），与各曲目首尾相接的输入比较
+ */
+bool verifyOutput(const std::string& path, const std::vector<float>& expected) {
+    FILE* file = std::fopen(path.c_str(), "rb");
+    if (!file) {
+        std::printf("cannot open %s\n", path.c_str());
+        return false;
+    }
+    std::vector<uint8_t> header(58);
+    std::vector<float> actual(expected.size() + 1);
+    bool ok = std::fread(header.data(), 1, header.size(), file) == header.size();
+    size_t count = ok ? std::fread(actual.data(), sizeof(float), actual.size(), file) : 0;
+    std::fclose(file);
+    uint32_t dataBytes = 0;
+    for (int i = 3; i >= 0; --i) {
+        dataBytes = (dataBytes << 8) | header[54 + i];
+    }
+    if (!ok || std::string(header.begin() + 50, header.begin() + 54) != "data" ||
+        dataBytes != expected.size() * sizeof(float) || count != expected.size()) {
+        std::printf("output length mismatch: %zu samples written, %zu expected\n", count, expected.size());
+        return false;
+    }
+    for (size_t i = 0; i < expected.size(); ++i) {
+        if (actual[i] != expected[i]) {
+            std::printf("output differs at frame %zu\n", i / kChannels);
+            return false;
+        }
+    }
+    return true;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    size_t tracks = argc > 1 ? static_cast<size_t>(std::max(2, std::atoi(argv[1]))) : 20;
+    int seconds = argc > 2 ? std::max(5, std::atoi(argv[2])) : 60;
+    std::string dir = argc > 3 ? argv[3] : "/tmp/musicfree_engine_bench";
+    mkdir(dir.c_str(), 0755);
+
+    std::vector<std::string> files;
+    std::vector<float> expected;
+    // 各曲目长度不是周期的整数倍，切换发生在周期中间
+    for (size_t i = 0; i < tracks; ++i) {
+        std::string path = dir + "/track" + std::to_string(i) + ".wav";
+        uint64_t frames = static_cast<uint64_t>(seconds) * kSampleRate + i * 173;
+        if (!writeTrack(path, frames, static_cast<uint32_t>(i) * 2654435761u + 1, expected)) {
+            std::printf("cannot write %s\n", path.c_str());
+            return 1;
+        }
+        files.push_back(path);
+    }
+    std::printf("%zu tracks x %d s, %d Hz stereo\n", tracks, seconds, kSampleRate);
+
+    bool pass = true;
+    // 输出的帧数应在 [minFrames, maxFrames] 内
+    auto check = [&](const char* name, const RunResult& r, uint64_t minFrames, uint64_t maxFrames,
+                     uint64_t crossfades) {
+        report(name, r, tracks);
+        if (r.metrics.underruns != 0 || r.metrics.gaplessTransitions != tracks - 1 ||
+            r.metrics.crossfades != crossfades || r.metrics.framesPlayed < minFrames ||
+            r.metrics.framesPlayed > maxFrames) {
+            std::printf("  unexpected: frames %llu (expected %llu..%llu), crossfades %llu\n",
+                        static_cast<unsigned long long>(r.metrics.framesPlayed),
+                        static_cast<unsigned long long>(minFrames), static_cast<unsigned long long>(maxFrames),
+                        static_cast<unsigned long long>(r.metrics.crossfades));
+            pass = false;
+        }
+    };
+    uint64_t totalFrames = expected.size() / kChannels;
+
+    AudioEngineOptions options;
+    options.outputSink = OutputSinkType::NULL_SINK;
+    check("null", runPlaylist(files, options, 0), totalFrames, totalFrames, 0);
+
+    options.outputSink = OutputSinkType::WAV_FILE;
+    options.outputPath = dir + "/output.wav";
+    check("wav", runPlaylist(files, options, 0), totalFrames, totalFrames, 0);
+    if (!verifyOutput(options.outputPath, expected)) {
+        pass = false;
+    } else {
+        std::printf("  %s matches the concatenated input sample for sample\n", options.outputPath.c_str());
+    }
+    std::remove(options.outputPath.c_str());
+
+    // 交叉淡化：淡化在剩余不超过 kCrossfadeMs 的第一个周期开始，每次切换两首重叠的帧数
+    // 比淡化时长少不到一个周期
+    options.outputSink = OutputSinkType::NULL_SINK;
+    uint64_t overlap = static_cast<uint64_t>(kCrossfadeMs) * kSampleRate / 1000;
+    check("crossfade", runPlaylist(files, options, kCrossfadeMs), totalFrames - overlap * (tracks - 1),
+          totalFrames - (overlap - options.periodFrames) * (tracks - 1), tracks - 1);
+
+    for (const auto& path : files) {
+        std::remove(path.c_str());
+    }
+    std::printf("%s\n", pass ? "PASS" : "FAIL");
+    return pass ? 0 : 1;
+}
@@ -0,0 +1,204 @@
+/**
+ * 引擎事件分发基准
+ *
+ *   - 控制操作延迟：状态事件有一个很慢的订阅者（每次 20ms），交替调用 play / pause / seek，
+ *     统计每次调用的耗时；事件异步分发，调用耗时与订阅者无关
+ *   - 多订阅者：另一个订阅者记录收到的状态事件，顺序应与调用顺序一致
+ *   - 并发注册：一个线程反复订阅 / 取消位置事件，取消返回之后回调不应再被调用
+ *   - 发布开销：多个线程同时向分发器成批发布事件，批与批之间等分发线程追上（队列不满），
+ *     统计每次发布的耗时、分发吞吐，应当没有丢弃
+ *
+ * 用法: musicfree_event_bench [operations] [publishers]
+ */
+
+#include "../include/audio_engine.h"
+#include "../src/core/audio_events.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace musicfree;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr auto kSlowSubscriber = std::chrono::milliseconds(20);
+constexpr int kPublishesPerThread = 200000;
+constexpr int kBurst = 64;
+
+double percentile(std::vector<double> values, double q) {
+    if (values.empty()) {
+        return 0;
+    }
+    std::sort(values.begin(), values.end());
+    return values[std::min(values.size() - 1, static_cast<size_t>(q * static_cast<double>(values.size())))];
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    int operations = argc > 1 ? std::max(3, std::atoi(argv[1])) : 150;
+    int publishers = argc > 2 ? std::max(1, std::atoi(argv[2])) : 4;
+    bool pass = true;
+
+    // ===== 控制操作延迟与事件顺序 =====
+    {
+        AudioEngine engine;
+        engine.load("event-bench.wav");
+
+        std::mutex mutex;
+        std::vector<PlayState> received;
+        engine.onPlayStateChanged([](PlayState) { std::this_thread::sleep_for(kSlowSubscriber); });
+        engine.onPlayStateChanged([&](PlayState state) {
+            std::lock_guard<std::mutex> lock(mutex);
+            received.push_back(state);
+        });
+
+        // 并发注册：取消返回之后回调不应再被调用
+        std::atomic<bool> done{false};
+        std::atomic<uint64_t> lateCalls{0};
+        std::atomic<uint64_t> cycles{0};
+        std::thread churn([&] {
+            while (!done.load()) {
+                auto active = std::make_shared<std::atomic<bool>>(true);
+                SubscriptionId id = engine.onPositionChanged([active, &lateCalls](int) {
+                    if (!active->load()) {
+                        lateCalls.fetch_add(1);
+                    }
+                });
+                std::this_thread::sleep_for(std::chrono::microseconds(200));
+                engine.unsubscribe(id);
+                active->store(false);
+                cycles.fetch_add(1);
+            }
+        });
+
+        std::vector<PlayState> expected;
+        std::vector<double> latencies;
+        for (int i = 0; i < operations; ++i) {
+            auto begin = Clock::now();
+            switch (i % 3) {
+                case 0:
+                    engine.play();
+                    expected.push_back(PlayState::PLAYING);
+                    break;
+                case 1:
+                    engine.seek(i * 100);
+                    break;
+                default:
+                    engine.pause();
+                    expected.push_back(PlayState::PAUSED);
+                    break;
+            }
+            latencies.push_back(std::chrono::duration<double, std::micro>(Clock::now() - begin).count());
+        }
+        double issueMs = 0;
+        for (double latency : latencies) {
+            issueMs += latency / 1000.0;
+        }
+
+        // 等慢订阅者处理完所有状态事件
+        auto deadline = Clock::now() + kSlowSubscriber * (expected.size() + 50);
+        size_t count = 0;
+        while (Clock::now() < deadline) {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                count = received.size();
+            }
+            if (count >= expected.size()) {
+                break;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+        done.store(true);
+        churn.join();
+
+        AudioEngineMetrics metrics = engine.getMetrics();
+        std::printf("control calls     %d in %.1f ms, p50 %.1f us, p99 %.1f us, max %.1f us "
+                    "(slow subscriber %lld ms per state event)\n",
+                    operations, issueMs, percentile(latencies, 0.5), percentile(latencies, 0.99),
+                    percentile(latencies, 1.0), static_cast<long long>(kSlowSubscriber.count()));
+        std::printf("event delay       p50 %.2f ms, max %.2f ms\n", metrics.eventLatency.quantile(0.5) / 1e6,
+                    metrics.eventLatency.quantile(1.0) / 1e6);
+        bool ordered;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            ordered = received == expected;
+        }
+        std::printf("state events      %zu / %zu delivered %s\n", count, expected.size(),
+                    ordered ? "in order" : "OUT OF ORDER");
+        std::printf("subscribe churn   %llu cycles, %llu calls after unsubscribe\n",
+                    static_cast<unsigned long long>(cycles.load()),
+                    static_cast<unsigned long long>(lateCalls.load()));
+        // 每次调用都同步执行的话至少要 20ms
+        if (!ordered || lateCalls.load() != 0 || percentile(latencies, 0.99) > 5000.0) {
+            pass = false;
+        }
+    }
+
+    // ===== 发布开销 =====
+    {
+        AudioEventDispatcher dispatcher(4096);
+        std::atomic<uint64_t> delivered{0};
+        dispatcher.subscribeTrackEnded([&delivered] { delivered.fetch_add(1, std::memory_order_relaxed); });
+        dispatcher.subscribeTrackEnded([] {});
+
+        std::atomic<bool> go{false};
+        std::atomic<uint64_t> published{0};
+        std::vector<std::thread> threads;
+        std::vector<double> perThreadNs(static_cast<size_t>(publishers));
+        for (int t = 0; t < publishers; ++t) {
+            threads.emplace_back([&, t] {
+                while (!go.load()) {
+                }
+                double ns = 0;
+                for (int i = 0; i < kPublishesPerThread; i += kBurst) {
+                    auto begin = Clock::now();
+                    for (int k = 0; k < kBurst; ++k) {
+                        dispatcher.publishTrackEnded();
+                    }
+                    ns += std::chrono::duration<double, std::nano>(Clock::now() - begin).count();
+                    // 队列容量 4096，各线程积压不超过一半
+                    while (published.fetch_add(kBurst) + kBurst > delivered.load() + 2048) {
+                        published.fetch_sub(kBurst);
+                        std::this_thread::yield();
+                    }
+                }
+                perThreadNs[static_cast<size_t>(t)] = ns / kPublishesPerThread;
+            });
+        }
+        auto begin = Clock::now();
+        go.store(true);
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        uint64_t total = static_cast<uint64_t>(publishers) * kPublishesPerThread;
+        auto deadline = Clock::now() + std::chrono::seconds(10);
+        while (delivered.load() + dispatcher.dropped() < total && Clock::now() < deadline) {
+            std::this_thread::yield();
+        }
+        double seconds = std::chrono::duration<double>(Clock::now() - begin).count();
+        double avgNs = 0;
+        for (double ns : perThreadNs) {
+            avgNs += ns / publishers;
+        }
+        std::printf("publish           %d threads, %.0f ns per publish, %.1f M events/s dispatched, "
+                    "%llu delivered, %llu dropped\n",
+                    publishers, avgNs, static_cast<double>(total) / seconds / 1e6,
+                    static_cast<unsigned long long>(delivered.load()),
+                    static_cast<unsigned long long>(dispatcher.dropped()));
+        if (delivered.load() != total || dispatcher.dropped() != 0) {
+            pass = false;
+        }
+    }
+
+    std::printf("%s\n", pass ? "PASS" : "FAIL");
+    return pass ? 0 : 1;
+}
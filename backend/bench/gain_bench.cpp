@@ -0,0 +1,132 @@
+/**
+ * 增益内核基准
+ *
+ * 对每个指令集（不超过当前 CPU 支持的最高级别）和每种采样格式（float32 / int16），测量：
+ *   - constant：恒定增益
+ *   - linear：线性斜坡
+ *   - exponential：指数斜坡
+ * 结果以每微秒处理的帧数表示（立体声）。缓冲区大小接近 L1，每轮处理整个缓冲区，取最好的一轮。
+ * 各指令集的输出与标量实现比较：线性斜坡应完全一致，指数斜坡允许 float 舍入级别的差异。
+ *
+ * 用法: musicfree_gain_bench [frames] [rounds]
+ */
+
+#include "../src/core/audio_gain.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+using namespace musicfree;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr int kChannels = 2;
+
+enum class Kernel { CONSTANT, LINEAR, EXPONENTIAL };
+
+const char* kernelName(Kernel kernel) {
+    switch (kernel) {
+        case Kernel::CONSTANT: return "constant";
+        case Kernel::LINEAR: return "linear";
+        case Kernel::EXPONENTIAL: return "exponential";
+    }
+    return "";
+}
+
+template <typename Sample>
+void apply(Kernel kernel, Sample* samples, size_t frames, SimdLevel level) {
+    // 增益在 0.5 附近，避免多轮之后数值衰减成非规格化数
+    switch (kernel) {
+        case Kernel::CONSTANT:
+            applyGainLinear(samples, frames, kChannels, 0.5f, 0.0f, level);
+            break;
+        case Kernel::LINEAR:
+            applyGainLinear(samples, frames, kChannels, 0.25f, 0.5f / static_cast<float>(frames), level);
+            break;
+        case Kernel::EXPONENTIAL:
+            applyGainExponential(samples, frames, kChannels, 0.25f,
+                                 std::pow(3.0f, 1.0f / static_cast<float>(frames)), level);
+            break;
+    }
+}
+
+template <typename Sample>
+double framesPerMicrosecond(Kernel kernel, const std::vector<Sample>& original, size_t frames, int rounds,
+                            SimdLevel level) {
+    std::vector<Sample> buffer(original);
+    double best = 1e18;
+    for (int i = 0; i < rounds; ++i) {
+        // 每轮从原始数据开始，复制不计入耗时
+        std::copy(original.begin(), original.end(), buffer.begin());
+        auto begin = Clock::now();
+        apply(kernel, buffer.data(), frames, level);
+        best = std::min(best, std::chrono::duration<double, std::micro>(Clock::now() - begin).count());
+    }
+    return static_cast<double>(frames) / best;
+}
+
+template <typename Sample>
+double maxDifference(Kernel kernel, const std::vector<Sample>& original, size_t frames, SimdLevel level) {
+    std::vector<Sample> expected(original);
+    std::vector<Sample> actual(original);
+    apply(kernel, expected.data(), frames, SimdLevel::SCALAR);
+    apply(kernel, actual.data(), frames, level);
+    double diff = 0;
+    for (size_t i = 0; i < expected.size(); ++i) {
+        diff = std::max(diff, std::fabs(static_cast<double>(expected[i]) - static_cast<double>(actual[i])));
+    }
+    return diff;
+}
+
+template <typename Sample>
+bool run(const char* format, const std::vector<Sample>& original, size_t frames, int rounds, double tolerance) {
+    bool ok = true;
+    for (Kernel kernel : {Kernel::CONSTANT, Kernel::LINEAR, Kernel::EXPONENTIAL}) {
+        for (int level = 0; level <= static_cast<int>(detectSimdLevel()); ++level) {
+            SimdLevel simd = static_cast<SimdLevel>(level);
+            double rate = framesPerMicrosecond(kernel, original, frames, rounds, simd);
+            double diff = maxDifference(kernel, original, frames, simd);
+            // 线性斜坡和恒定增益按相同公式计算，必须逐位一致
+            double limit = kernel == Kernel::EXPONENTIAL ? tolerance : 0.0;
+            bool match = diff <= limit;
+            ok = ok && match;
+            std::printf("%-8s %-12s %-8s %10.1f frames/us   max diff %.3g%s\n", format, kernelName(kernel),
+                        simdLevelName(simd), rate, diff, match ? "" : "  MISMATCH");
+        }
+    }
+    return ok;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    long frameCount = argc > 1 ? std::atol(argv[1]) : 4096;
+    int rounds = argc > 2 ? std::atoi(argv[2]) : 2000;
+    if (frameCount <= 0 || rounds <= 0) {
+        std::fprintf(stderr, "usage: musicfree_gain_bench [frames] [rounds]\n");
+        return 1;
+    }
+    size_t frames = static_cast<size_t>(frameCount);
+
+    std::vector<float> floatSamples(frames * kChannels);
+    std::vector<int16_t> intSamples(frames * kChannels);
+    uint32_t seed = 12345;
+    for (size_t i = 0; i < floatSamples.size(); ++i) {
+        seed = seed * 1664525u + 1013904223u;
+        int16_t value = static_cast<int16_t>(seed >> 16);
+        intSamples[i] = value;
+        floatSamples[i] = static_cast<float>(value) / 32768.0f;
+    }
+
+    std::printf("frames %zu x %d channels, best of %d rounds, cpu supports %s\n", frames, kChannels, rounds,
+                simdLevelName(detectSimdLevel()));
+    bool ok = run("float32", floatSamples, frames, rounds, 1e-5);
+    // int16 的指数斜坡在舍入边界上可能差 1
+    ok = run("int16", intSamples, frames, rounds, 1.0) && ok;
+    return ok ? 0 : 1;
+}
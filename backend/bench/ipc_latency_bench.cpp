@@ -0,0 +1,335 @@
+/**
+ * 本地传输延迟基准：HTTP/1.1 + JSON（TCP 回环） vs 二进制协议（Unix 域套接字）
+ *
+ * 在进程内启动 ApiServer（端口由系统分配），用阻塞套接字分别在两种传输上
+ * 串行发送相同的请求，测量包含客户端解码在内的往返延迟。
+ *
+ * 用法: musicfree_ipc_bench [iterations] [playlistSize]
+ */
+
+#include "../include/api_server.h"
+#include "../src/network/ipc_protocol.h"
+#include "../src/network/json.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+using namespace musicfree;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+bool sendAll(int fd, const std::string& data) {
+    size_t sent = 0;
+    while (sent < data.size()) {
+        ssize_t n = ::send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+        if (n <= 0) return false;
+        sent += static_cast<size_t>(n);
+    }
+    return true;
+}
+
+bool recvMore(int fd, std::string& buffer) {
+    char chunk[64 * 1024];
+    ssize_t n = ::recv(fd, chunk, sizeof(chunk), 0);
+    if (n <= 0) return false;
+    buffer.append(chunk, static_cast<size_t>(n));
+    return true;
+}
+
+int connectTcp(int port) {
+    int fd = ::socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(static_cast<uint16_t>(port));
+    ::inet_pton(AF_INET, "127.0.0.1", &addr.sin_addr);
+    if (::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) {
+        ::close(fd);
+        return -1;
+    }
+    int enable = 1;
+    ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &enable, sizeof(enable));
+    return fd;
+}
+
+int connectUnix(const std::string& path) {
+    int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    std::strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+    if (::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) {
+        ::close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+/**
+ * 发送一个 HTTP 请求并读取完整应答，body 为应答体
+ */
+bool httpRoundTrip(int fd, const std::string& request, std::string& buffer, std::string& body) {
+    if (!sendAll(fd, request)) return false;
+
+    buffer.clear();
+    size_t headerEnd = std::string::npos;
+    while ((headerEnd = buffer.find("\r\n\r\n")) == std::string::npos) {
+        if (!recvMore(fd, buffer)) return false;
+    }
+
+    size_t length = 0;
+    size_t pos = buffer.find("Content-Length: ");
+    if (pos != std::string::npos && pos < headerEnd) {
+        length = std::strtoul(buffer.c_str() + pos + 16, nullptr, 10);
+    }
+    while (buffer.size() < headerEnd + 4 + length) {
+        if (!recvMore(fd, buffer)) return false;
+    }
+    body.assign(buffer, headerEnd + 4, length);
+    return true;
+}
+
+/**
+ * 发送一个二进制请求帧并读取应答帧体
+ */
+bool ipcRoundTrip(int fd, uint32_t requestId, ipc::Opcode opcode, const std::string& args,
+                  std::string& buffer, std::string& reply) {
+    std::string frame(4, '\0');
+    ipc::Writer writer(frame);
+    writer.writeU32(requestId);
+    writer.writeU16(static_cast<uint16_t>(opcode));
+    frame += args;
+    ipc::storeU32(&frame[0], static_cast<uint32_t>(frame.size() - 4));
+    if (!sendAll(fd, frame)) return false;
+
+    buffer.clear();
+    while (buffer.size() < 4) {
+        if (!recvMore(fd, buffer)) return false;
+    }
+    size_t length = ipc::loadU32(buffer.data());
+    while (buffer.size() < 4 + length) {
+        if (!recvMore(fd, buffer)) return false;
+    }
+    reply.assign(buffer, 4, length);
+    return true;
+}
+
+struct Summary {
+    double mean = 0;
+    double p50 = 0;
+    double p99 = 0;
+    double p999 = 0;
+    size_t bytes = 0;
+};
+
+Summary summarize(std::vector<double>& micros, size_t bytes) {
+    Summary summary;
+    std::sort(micros.begin(), micros.end());
+    double total = 0;
+    for (double value : micros) total += value;
+    summary.mean = total / micros.size();
+    summary.p50 = micros[micros.size() / 2];
+    summary.p99 = micros[std::min(micros.size() - 1, micros.size() * 99 / 100)];
+    summary.p999 = micros[std::min(micros.size() - 1, micros.size() * 999 / 1000)];
+    summary.bytes = bytes;
+    return summary;
+}
+
+void printRow(const char* name, const char* transport, const Summary& s) {
+    std::printf("%-14s %-18s %9.2f %9.2f %9.2f %9.2f %10zu\n", name, transport, s.mean, s.p50, s.p99, s.p999,
+                s.bytes);
+}
+
+template <typename Fn>
+std::vector<double> measure(int iterations, Fn&& roundTrip) {
+    // 预热：建立连接后的首批请求会触发缺页和内核缓冲区分配
+    for (int i = 0; i < std::min(iterations, 1000); ++i) {
+        if (!roundTrip()) return {};
+    }
+
+    std::vector<double> micros;
+    micros.reserve(iterations);
+    for (int i = 0; i < iterations; ++i) {
+        auto begin = Clock::now();
+        if (!roundTrip()) return {};
+        micros.push_back(std::chrono::duration<double, std::micro>(Clock::now() - begin).count());
+    }
+    return micros;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    int iterations = argc > 1 ? std::atoi(argv[1]) : 20000;
+    int playlistSize = argc > 2 ? std::atoi(argv[2]) : 100;
+    if (iterations <= 0 || playlistSize < 0) {
+        std::cerr << "usage: musicfree_ipc_bench [iterations] [playlistSize]" << std::endl;
+        return 1;
+    }
+
+    ApiServerOptions options;
+    options.port = 0;
+    options.unixSocketPath = "/tmp/musicfree-ipc-bench-" + std::to_string(::getpid()) + ".sock";
+
+    ApiServer server;
+    if (!server.start(options)) {
+        std::cerr << "Failed to start server" << std::endl;
+        return 1;
+    }
+
+    int tcp = connectTcp(server.getPort());
+    int local = connectUnix(options.unixSocketPath);
+    if (tcp < 0 || local < 0) {
+        std::cerr << "Failed to connect" << std::endl;
+        return 1;
+    }
+
+    std::string buffer;
+    std::string reply;
+    uint32_t requestId = 0;
+
+    // 准备数据：加载一首本地轨道，并填充播放列表
+    {
+        std::string args;
+        ipc::Writer writer(args);
+        writer.writeString("/music/bench.flac");
+        ipcRoundTrip(local, ++requestId, ipc::Opcode::PLAYER_LOAD, args, buffer, reply);
+    }
+    for (int i = 0; i < playlistSize; ++i) {
+        Track track;
+        track.id = "bench-" + std::to_string(i);
+        track.title = "Benchmark Track " + std::to_string(i);
+        track.artist = "Benchmark Artist";
+        track.album = "Benchmark Album";
+        track.url = "/music/bench-" + std::to_string(i) + ".flac";
+        track.duration = 180000 + i;
+        track.source = "local";
+
+        std::string args;
+        ipc::Writer writer(args);
+        writer.writeTrack(track);
+        ipcRoundTrip(local, ++requestId, ipc::Opcode::PLAYLIST_ADD, args, buffer, reply);
+    }
+
+    const std::string statusRequest = "GET /api/player/status HTTP/1.1\r\nHost: 127.0.0.1\r\n\r\n";
+    const std::string playlistRequest = "GET /api/playlist HTTP/1.1\r\nHost: 127.0.0.1\r\n\r\n";
+    const std::string volumeRequest =
+        "POST /api/player/volume HTTP/1.1\r\nHost: 127.0.0.1\r\n"
+        "Content-Type: application/json\r\nContent-Length: 13\r\n\r\n{\"volume\":70}";
+
+    std::string body;
+    size_t httpBytes = 0;
+    size_t ipcBytes = 0;
+
+    auto httpStatus = [&] {
+        JsonValue json;
+        if (!httpRoundTrip(tcp, statusRequest, buffer, body) || !parseJson(body, json)) return false;
+        httpBytes = buffer.size();
+        return json.getString("state") == "stopped";
+    };
+    auto ipcStatus = [&] {
+        ipc::PlayerStatus status;
+        if (!ipcRoundTrip(local, ++requestId, ipc::Opcode::PLAYER_STATUS, std::string(), buffer, reply)) {
+            return false;
+        }
+        ipc::Reader reader(reply.data(), reply.size());
+        uint32_t id = 0;
+        uint16_t code = 0;
+        ipcBytes = buffer.size();
+        return reader.readU32(id) && reader.readU16(code) && code == 200 && reader.readStatus(status);
+    };
+
+    auto httpVolume = [&] {
+        JsonValue json;
+        if (!httpRoundTrip(tcp, volumeRequest, buffer, body) || !parseJson(body, json)) return false;
+        httpBytes = buffer.size();
+        return json.getNumber("volume") == 70;
+    };
+    auto ipcVolume = [&] {
+        std::string args;
+        ipc::Writer writer(args);
+        writer.writeI32(70);
+        ipc::PlayerStatus status;
+        if (!ipcRoundTrip(local, ++requestId, ipc::Opcode::PLAYER_VOLUME, args, buffer, reply)) return false;
+        ipc::Reader reader(reply.data(), reply.size());
+        uint32_t id = 0;
+        uint16_t code = 0;
+        ipcBytes = buffer.size();
+        return reader.readU32(id) && reader.readU16(code) && code == 200 && reader.readStatus(status) &&
+               status.volume == 70;
+    };
+
+    auto httpPlaylist = [&] {
+        JsonValue json;
+        if (!httpRoundTrip(tcp, playlistRequest, buffer, body) || !parseJson(body, json)) return false;
+        httpBytes = buffer.size();
+        const JsonValue* tracks = json.find("tracks");
+        if (tracks == nullptr || tracks->array.size() != static_cast<size_t>(playlistSize)) return false;
+        Track track;
+        for (const auto& item : tracks->array) {
+            if (!jsonToTrack(item, track)) return false;
+        }
+        return true;
+    };
+    auto ipcPlaylist = [&] {
+        Playlist playlist;
+        if (!ipcRoundTrip(local, ++requestId, ipc::Opcode::PLAYLIST_GET, std::string(), buffer, reply)) {
+            return false;
+        }
+        ipc::Reader reader(reply.data(), reply.size());
+        uint32_t id = 0;
+        uint16_t code = 0;
+        ipcBytes = buffer.size();
+        return reader.readU32(id) && reader.readU16(code) && code == 200 && reader.readPlaylist(playlist) &&
+               playlist.tracks.size() == static_cast<size_t>(playlistSize);
+    };
+
+    std::printf("iterations: %d, playlist size: %d (latency in microseconds)\n\n", iterations, playlistSize);
+    std::printf("%-14s %-18s %9s %9s %9s %9s %10s\n", "request", "transport", "mean", "p50", "p99", "p99.9",
+                "resp bytes");
+
+    struct Case {
+        const char* name;
+        std::function<bool()> http;
+        std::function<bool()> local;
+    };
+    std::vector<Case> cases = {
+        {"status", httpStatus, ipcStatus},
+        {"volume", httpVolume, ipcVolume},
+        {"playlist", httpPlaylist, ipcPlaylist},
+    };
+
+    bool ok = true;
+    for (auto& c : cases) {
+        std::vector<double> httpMicros = measure(iterations, c.http);
+        std::vector<double> ipcMicros = measure(iterations, c.local);
+        if (httpMicros.empty() || ipcMicros.empty()) {
+            std::cerr << "Request '" << c.name << "' failed" << std::endl;
+            ok = false;
+            break;
+        }
+        Summary http = summarize(httpMicros, httpBytes);
+        Summary local = summarize(ipcMicros, ipcBytes);
+        printRow(c.name, "tcp+http+json", http);
+        printRow(c.name, "unix+binary", local);
+        std::printf("%-14s %-18s %8.2fx\n\n", "", "speedup (p50)", http.p50 / local.p50);
+    }
+
+    ::close(tcp);
+    ::close(local);
+    server.stop();
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,131 @@
+/**
+ * 流式 JSON 序列化基准
+ *
+ * 序列化一个大播放列表，统计耗时和堆分配次数（替换全局 operator new 计数）：
+ *   - direct：JsonWriter 以分块编码直接写入复用的发送缓冲区（GET /api/playlist 的路径）
+ *   - copy：先拷贝播放列表、序列化到临时字符串再追加到发送缓冲区（之前的路径）
+ *
+ * 用法: musicfree_json_bench [tracks] [rounds]
+ */
+
+#include "../src/network/json.h"
+#include "../src/network/json_writer.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <string>
+#include <vector>
+
+namespace {
+
+std::atomic<uint64_t> g_allocations{0};
+
+}  // namespace
+
+void* operator new(std::size_t size) {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size == 0 ? 1 : size)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+    std::free(p);
+}
+
+using namespace musicfree;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct Result {
+    double bestMs = 0;
+    double meanMs = 0;
+    uint64_t allocations = 0;  // 最后一轮的分配次数
+    size_t bytes = 0;
+};
+
+template <typename Fn>
+Result run(int rounds, std::string& output, Fn&& serialize) {
+    Result result;
+    result.bestMs = 1e9;
+    double total = 0;
+    for (int i = 0; i < rounds; ++i) {
+        output.clear();
+        uint64_t before = g_allocations.load(std::memory_order_relaxed);
+        auto begin = Clock::now();
+        serialize(output);
+        double ms = std::chrono::duration<double, std::milli>(Clock::now() - begin).count();
+        result.allocations = g_allocations.load(std::memory_order_relaxed) - before;
+        result.bestMs = std::min(result.bestMs, ms);
+        total += ms;
+    }
+    result.meanMs = total / rounds;
+    result.bytes = output.size();
+    return result;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    int trackCount = argc > 1 ? std::atoi(argv[1]) : 100000;
+    int rounds = argc > 2 ? std::atoi(argv[2]) : 20;
+    if (trackCount <= 0 || rounds <= 0) {
+        std::fprintf(stderr, "usage: musicfree_json_bench [tracks] [rounds]\n");
+        return 1;
+    }
+
+    Playlist playlist;
+    playlist.id = "default";
+    playlist.name = "Default Playlist";
+    playlist.tracks.reserve(trackCount);
+    for (int i = 0; i < trackCount; ++i) {
+        Track track;
+        track.id = "local-" + std::to_string(1000000 + i);
+        track.title = "Track number " + std::to_string(i) + " (Remastered \"2024\")";
+        track.artist = "Some Artist With A Long Name";
+        track.album = "An Album Title That Exceeds SSO";
+        track.url = "/home/user/Music/Some Artist/An Album/" + std::to_string(i) + ".flac";
+        track.duration = 180000 + i;
+        track.source = "local";
+        track.coverUrl = "";
+        playlist.tracks.push_back(std::move(track));
+    }
+
+    std::string output;
+
+    Result direct = run(rounds, output, [&](std::string& out) {
+        JsonWriter writer(out, true);
+        writer.reserve(estimateJsonSize(playlist.tracks) + 128);
+        writeJson(writer, playlist);
+        writer.finish();
+    });
+
+    Result copy = run(rounds, output, [&](std::string& out) {
+        Playlist snapshot = playlist;
+        std::string json;
+        appendJson(json, snapshot);
+        out += json;
+    });
+
+    std::printf("tracks: %d, rounds: %d\n\n", trackCount, rounds);
+    std::printf("%-8s %10s %10s %12s %14s %12s\n", "path", "best ms", "mean ms", "MB/s", "allocations", "allocs/track");
+    auto print = [&](const char* name, const Result& r) {
+        std::printf("%-8s %10.2f %10.2f %12.0f %14llu %12.3f\n", name, r.bestMs, r.meanMs,
+                    r.bytes / 1e6 / (r.bestMs / 1e3), static_cast<unsigned long long>(r.allocations),
+                    static_cast<double>(r.allocations) / trackCount);
+    };
+    print("direct", direct);
+    print("copy", copy);
+    std::printf("\nresponse body: %zu bytes\n", direct.bytes);
+    return 0;
+}
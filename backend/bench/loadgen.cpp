@@ -0,0 +1,789 @@
+/**
+ * HTTP 负载生成器
+ *
+ * 按前端（frontend/src/services/api.ts）的使用方式混合发送请求：
+ *   - status：轮询 GET /api/player/status
+ *   - playlist：GET /api/playlist，带上次应答的 If-None-Match（浏览器对 Cache-Control: no-cache 的做法）
+ *   - search：GET /api/search?q=...
+ *   - favorite：收藏 / 取消收藏切换（POST /api/favorites 与 DELETE /api/favorites/{id} 交替）
+ *
+ * 每个客户端线程用一个 epoll 事件循环驱动若干个非阻塞连接。两种负载模型：
+ *   - 闭环（默认）：每个连接收到应答后立即发送下一个请求，测量的是服务器能达到的吞吐
+ *   - 开环（--rate）：请求按泊松过程以固定的总速率到达，连接都忙时排队等待；
+ *     延迟从计划发送时间开始计算，不会因为服务器变慢、发送推迟而低估（coordinated omission）
+ *
+ * 不指定 --port 时在进程内启动 ApiServer（端口由系统分配），不依赖任何外部服务。
+ * 指定 --port 时连接已运行的服务器；注意加载数据阶段会清空并重新填充目标服务器的播放列表。
+ *
+ * 延迟用 LatencyHistogram（include/metrics.h）记录，每个线程一份，结束后合并。
+ *
+ * 用法: musicfree_loadgen [--port=N] [--host=ADDR] [--server-threads=N] [--connections=N] [--threads=N]
+ *                         [--duration=SEC] [--warmup=SEC] [--rate=REQ_PER_SEC] [--no-keepalive]
+ *                         [--mix=status=60,playlist=20,search=10,favorite=10] [--playlist-size=N]
+ */
+
+#include "../include/api_server.h"
+#include "../include/metrics.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <cerrno>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <strings.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+
+using namespace musicfree;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+enum class RequestKind {
+    STATUS = 0,
+    PLAYLIST = 1,
+    SEARCH = 2,
+    FAVORITE = 3
+};
+
+constexpr int kKindCount = 4;
+const char* kKindNames[kKindCount] = {"status", "playlist", "search", "favorite"};
+const char* kSearchTerms[] = {"jay", "lofi", "piano", "beatles", "晴天", "rain", "jazz", "live"};
+
+constexpr auto kRetryDelay = std::chrono::milliseconds(10);  // 连接失败后重试前的等待
+
+struct Options {
+    std::string host = "127.0.0.1";
+    int port = 0;  // 0：进程内启动服务器
+    int serverThreads = 1;
+    int connections = 32;
+    int threads = 0;  // 0：min(connections, CPU 核心数)
+    double duration = 10;
+    double warmup = 2;
+    double rate = 0;  // 0：闭环
+    bool keepAlive = true;
+    int weights[kKindCount] = {60, 20, 10, 10};
+    int playlistSize = 100;
+};
+
+/**
+ * 应答的报文头信息
+ */
+struct Response {
+    int status = 0;
+    bool close = false;
+    std::string etag;
+};
+
+/**
+ * 解析缓冲区开头的一个完整 HTTP/1.1 应答（支持 Content-Length 和分块传输编码）
+ * @return 应答占用的字节数；不完整时返回 0，格式错误返回 -1
+ */
+long parseResponse(const std::string& in, Response& response) {
+    size_t headerEnd = in.find("\r\n\r\n");
+    if (headerEnd == std::string::npos) {
+        return 0;
+    }
+    if (in.compare(0, 5, "HTTP/") != 0 || in.size() < 12) {
+        return -1;
+    }
+    response = Response();
+    response.status = std::atoi(in.c_str() + 9);
+
+    size_t contentLength = 0;
+    bool chunked = false;
+    size_t pos = in.find("\r\n") + 2;
+    while (pos < headerEnd) {
+        size_t lineEnd = in.find("\r\n", pos);
+        size_t colon = in.find(':', pos);
+        if (colon != std::string::npos && colon < lineEnd) {
+            size_t valueStart = in.find_first_not_of(' ', colon + 1);
+            std::string value = in.substr(valueStart, lineEnd - valueStart);
+            size_t nameLength = colon - pos;
+            const char* name = in.c_str() + pos;
+            if (nameLength == 14 && strncasecmp(name, "Content-Length", 14) == 0) {
+                contentLength = std::strtoul(value.c_str(), nullptr, 10);
+            } else if (nameLength == 17 && strncasecmp(name, "Transfer-Encoding", 17) == 0) {
+                chunked = strcasecmp(value.c_str(), "chunked") == 0;
+            } else if (nameLength == 10 && strncasecmp(name, "Connection", 10) == 0) {
+                response.close = strcasecmp(value.c_str(), "close") == 0;
+            } else if (nameLength == 4 && strncasecmp(name, "ETag", 4) == 0) {
+                response.etag = value;
+            }
+        }
+        pos = lineEnd + 2;
+    }
+
+    size_t bodyStart = headerEnd + 4;
+    if (!chunked) {
+        return in.size() >= bodyStart + contentLength ? static_cast<long>(bodyStart + contentLength) : 0;
+    }
+
+    // 只跳过各个块找到报文结尾，不保留应答体
+    pos = bodyStart;
+    while (true) {
+        size_t lineEnd = in.find("\r\n", pos);
+        if (lineEnd == std::string::npos) {
+            return 0;
+        }
+        char* end = nullptr;
+        unsigned long size = std::strtoul(in.c_str() + pos, &end, 16);
+        if (end == in.c_str() + pos) {
+            return -1;
+        }
+        if (size == 0) {
+            // 结束块后没有 trailer，紧跟一个空行
+            return in.size() >= lineEnd + 4 ? static_cast<long>(lineEnd + 4) : 0;
+        }
+        pos = lineEnd + 2 + size + 2;
+        if (pos > in.size()) {
+            return 0;
+        }
+    }
+}
+
+std::string trackJson(const std::string& id, int index) {
+    return "{\"id\":\"" + id + "\",\"title\":\"Load Track " + std::to_string(index) +
+           "\",\"artist\":\"Load Artist\",\"album\":\"Load Album\",\"url\":\"/music/" + id +
+           ".flac\",\"duration\":" + std::to_string(180000 + index) + ",\"source\":\"local\"}";
+}
+
+std::string buildRequest(const Options& options, const char* method, const std::string& target,
+                         const std::string& extraHeaders = std::string(), const std::string& body = std::string()) {
+    std::string request = method;
+    request += ' ';
+    request += target;
+    request += " HTTP/1.1\r\nHost: ";
+    request += options.host;
+    request += "\r\n";
+    if (!options.keepAlive) {
+        request += "Connection: close\r\n";
+    }
+    request += extraHeaders;
+    if (!body.empty() || std::strcmp(method, "POST") == 0) {
+        request += "Content-Type: application/json\r\nContent-Length: " + std::to_string(body.size()) + "\r\n";
+    }
+    request += "\r\n";
+    request += body;
+    return request;
+}
+
+int connectSocket(const Options& options, bool blocking) {
+    int fd = ::socket(AF_INET, SOCK_STREAM | (blocking ? 0 : SOCK_NONBLOCK), 0);
+    if (fd < 0) {
+        return -1;
+    }
+    int enable = 1;
+    ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &enable, sizeof(enable));
+
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(static_cast<uint16_t>(options.port));
+    ::inet_pton(AF_INET, options.host.c_str(), &addr.sin_addr);
+    if (::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0 && errno != EINPROGRESS) {
+        ::close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+/**
+ * 阻塞地发送一个请求并等待应答（只用于加载数据阶段）
+ */
+bool roundTrip(int fd, const std::string& request, Response& response) {
+    size_t sent = 0;
+    while (sent < request.size()) {
+        ssize_t n = ::send(fd, request.data() + sent, request.size() - sent, MSG_NOSIGNAL);
+        if (n <= 0) return false;
+        sent += static_cast<size_t>(n);
+    }
+
+    std::string in;
+    char chunk[64 * 1024];
+    while (true) {
+        long consumed = parseResponse(in, response);
+        if (consumed < 0) return false;
+        if (consumed > 0) return true;
+        ssize_t n = ::recv(fd, chunk, sizeof(chunk), 0);
+        if (n <= 0) return false;
+        in.append(chunk, static_cast<size_t>(n));
+    }
+}
+
+/**
+ * 加载数据：一首已加载的轨道（status 返回 currentTrack）和指定长度的播放列表
+ */
+bool seed(Options options) {
+    options.keepAlive = true;
+    int fd = connectSocket(options, true);
+    if (fd < 0) {
+        return false;
+    }
+
+    Response response;
+    bool ok = roundTrip(fd, buildRequest(options, "POST", "/api/playlist/clear"), response) &&
+              response.status < 300 &&
+              roundTrip(fd, buildRequest(options, "POST", "/api/player/load", std::string(),
+                                         "{\"filePath\":\"/music/loadgen.flac\"}"), response) &&
+              response.status < 300;
+    if (ok && options.playlistSize > 0) {
+        std::string body = "[";
+        for (int i = 0; i < options.playlistSize; ++i) {
+            if (i > 0) body += ',';
+            body += trackJson("loadgen-" + std::to_string(i), i);
+        }
+        body += "]";
+        ok = roundTrip(fd, buildRequest(options, "POST", "/api/playlist/add", std::string(), body), response) &&
+             response.status < 300;
+    }
+    ::close(fd);
+    return ok;
+}
+
+/**
+ * 每种请求的统计（线程私有，线程结束后合并）
+ */
+struct KindStats {
+    LatencyHistogram latency;
+    uint64_t completed = 0;
+    uint64_t errors = 0;  // 4xx / 5xx 应答（收藏切换的 409 / 404 除外）和连接错误
+};
+
+/**
+ * 客户端线程：一个 epoll 事件循环驱动若干个连接
+ */
+class Worker {
+public:
+    Worker(const Options& options, int index, int connections, double rate)
+        : options_(options), index_(index), rate_(rate), random_(0x5eed + index), conns_(connections),
+          stats_(new KindStats[kKindCount]) {
+        for (int weight : options.weights) {
+            total_weight_ += weight;
+        }
+    }
+
+    ~Worker() {
+        for (auto& conn : conns_) {
+            if (conn.fd >= 0) ::close(conn.fd);
+        }
+        if (timer_fd_ >= 0) ::close(timer_fd_);
+        if (epoll_fd_ >= 0) ::close(epoll_fd_);
+    }
+
+    void run(Clock::time_point begin, Clock::time_point measureFrom, Clock::time_point end);
+
+    const KindStats& stats(int kind) const { return stats_[kind]; }
+    uint64_t socketErrors() const { return socket_errors_; }
+    size_t backlog() const { return backlog_.size(); }
+
+private:
+    struct Connection {
+        int fd = -1;
+        bool connecting = false;
+        bool busy = false;  // 有请求在途
+        std::string out;
+        size_t outOffset = 0;
+        std::string in;
+        RequestKind kind = RequestKind::STATUS;
+        Clock::time_point start;  // 闭环为实际发送时间，开环为计划到达时间
+        Clock::time_point retryAt;
+        std::string etag;
+        bool favorited = false;
+        uint64_t favoriteSeq = 0;
+        std::string favoriteId;
+    };
+
+    RequestKind pickKind();
+    void issue(size_t index, Clock::time_point start);
+    bool openSocket(Connection& conn, size_t index);
+    void closeSocket(Connection& conn);
+    void onEvent(size_t index, uint32_t mask, Clock::time_point measureFrom);
+    bool flush(Connection& conn);
+    void complete(Connection& conn, const Response& response, Clock::time_point measureFrom);
+    void fail(Connection& conn, Clock::time_point measureFrom);
+    void armTimer(Clock::time_point at);
+
+    const Options& options_;
+    int index_;
+    double rate_;
+    std::mt19937_64 random_;
+    int total_weight_ = 0;
+    std::vector<Connection> conns_;
+    std::unique_ptr<KindStats[]> stats_;
+    uint64_t socket_errors_ = 0;
+    int epoll_fd_ = -1;
+    int timer_fd_ = -1;
+
+    // 开环：已经到达、还没有空闲连接可以发送的请求（计划到达时间）
+    std::deque<Clock::time_point> backlog_;
+};
+
+RequestKind Worker::pickKind() {
+    int pick = static_cast<int>(random_() % static_cast<uint64_t>(total_weight_));
+    for (int kind = 0; kind < kKindCount; ++kind) {
+        if (pick < options_.weights[kind]) {
+            return static_cast<RequestKind>(kind);
+        }
+        pick -= options_.weights[kind];
+    }
+    return RequestKind::STATUS;
+}
+
+bool Worker::openSocket(Connection& conn, size_t index) {
+    conn.fd = connectSocket(options_, false);
+    if (conn.fd < 0) {
+        return false;
+    }
+    conn.connecting = true;
+    epoll_event ev{};
+    ev.events = EPOLLIN | EPOLLOUT;
+    ev.data.u64 = index;
+    ::epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, conn.fd, &ev);
+    return true;
+}
+
+void Worker::closeSocket(Connection& conn) {
+    if (conn.fd >= 0) {
+        ::epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, conn.fd, nullptr);
+        ::close(conn.fd);
+        conn.fd = -1;
+    }
+    conn.connecting = false;
+    conn.in.clear();
+    conn.out.clear();
+    conn.outOffset = 0;
+}
+
+void Worker::issue(size_t index, Clock::time_point start) {
+    Connection& conn = conns_[index];
+    conn.kind = pickKind();
+    conn.start = start;
+    conn.busy = true;
+
+    switch (conn.kind) {
+        case RequestKind::STATUS:
+            conn.out = buildRequest(options_, "GET", "/api/player/status");
+            break;
+        case RequestKind::PLAYLIST:
+            conn.out = buildRequest(options_, "GET", "/api/playlist",
+                                    conn.etag.empty() ? std::string() : "If-None-Match: " + conn.etag + "\r\n");
+            break;
+        case RequestKind::SEARCH: {
+            const char* term = kSearchTerms[random_() % (sizeof(kSearchTerms) / sizeof(kSearchTerms[0]))];
+            // 非 ASCII 关键词按 URL 编码发送
+            std::string target = "/api/search?limit=20&q=";
+            for (const unsigned char* p = reinterpret_cast<const unsigned char*>(term); *p; ++p) {
+                char escaped[4];
+                if (*p < 0x80) {
+                    target.push_back(static_cast<char>(*p));
+                } else {
+                    std::snprintf(escaped, sizeof(escaped), "%%%02X", *p);
+                    target += escaped;
+                }
+            }
+            conn.out = buildRequest(options_, "GET", target);
+            break;
+        }
+        case RequestKind::FAVORITE:
+            // 每个连接切换自己的轨道，连接之间不会互相冲突
+            if (!conn.favorited) {
+                conn.favoriteId = "loadgen-fav-" + std::to_string(index_) + "-" + std::to_string(index) + "-" +
+                                  std::to_string(conn.favoriteSeq++ % 8);
+                conn.out = buildRequest(options_, "POST", "/api/favorites", std::string(),
+                                        trackJson(conn.favoriteId, static_cast<int>(index)));
+            } else {
+                conn.out = buildRequest(options_, "DELETE", "/api/favorites/" + conn.favoriteId);
+            }
+            break;
+    }
+    conn.outOffset = 0;
+
+    if (conn.fd < 0 && !openSocket(conn, index)) {
+        ++socket_errors_;
+        conn.busy = false;
+        conn.retryAt = Clock::now() + kRetryDelay;
+        return;
+    }
+    if (!conn.connecting) {
+        flush(conn);
+    }
+}
+
+bool Worker::flush(Connection& conn) {
+    while (conn.outOffset < conn.out.size()) {
+        ssize_t n = ::send(conn.fd, conn.out.data() + conn.outOffset, conn.out.size() - conn.outOffset,
+                           MSG_NOSIGNAL);
+        if (n > 0) {
+            conn.outOffset += static_cast<size_t>(n);
+            continue;
+        }
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) return true;
+        return false;
+    }
+    return true;
+}
+
+void Worker::fail(Connection& conn, Clock::time_point measureFrom) {
+    ++socket_errors_;
+    if (conn.busy && conn.start >= measureFrom) {
+        ++stats_[static_cast<int>(conn.kind)].errors;
+    }
+    conn.busy = false;
+    conn.favorited = false;
+    conn.etag.clear();
+    conn.retryAt = Clock::now() + kRetryDelay;
+    closeSocket(conn);
+}
+
+void Worker::complete(Connection& conn, const Response& response, Clock::time_point measureFrom) {
+    auto now = Clock::now();
+    bool ok = response.status < 400;
+
+    switch (conn.kind) {
+        case RequestKind::PLAYLIST:
+            if (!response.etag.empty()) {
+                conn.etag = response.etag;
+            }
+            break;
+        case RequestKind::FAVORITE:
+            // 409（已收藏）/ 404（未收藏）说明本地状态与服务器不一致，按服务器状态纠正
+            if (response.status == 409 || response.status == 404) {
+                ok = true;
+            }
+            if (ok) {
+                conn.favorited = response.status == 409 || (!conn.favorited && response.status < 300);
+            }
+            break;
+        default:
+            break;
+    }
+
+    if (conn.start >= measureFrom) {
+        KindStats& stats = stats_[static_cast<int>(conn.kind)];
+        ++stats.completed;
+        if (!ok) {
+            ++stats.errors;
+        }
+        stats.latency.record(static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(now - conn.start).count()));
+    }
+
+    conn.busy = false;
+    conn.retryAt = now;
+    if (!options_.keepAlive || response.close) {
+        closeSocket(conn);
+    }
+}
+
+void Worker::onEvent(size_t index, uint32_t mask, Clock::time_point measureFrom) {
+    Connection& conn = conns_[index];
+    if (conn.fd < 0) {
+        return;
+    }
+
+    if (conn.connecting) {
+        if (!(mask & (EPOLLOUT | EPOLLERR | EPOLLHUP))) {
+            return;
+        }
+        int error = 0;
+        socklen_t length = sizeof(error);
+        ::getsockopt(conn.fd, SOL_SOCKET, SO_ERROR, &error, &length);
+        if (error != 0) {
+            fail(conn, measureFrom);
+            return;
+        }
+        conn.connecting = false;
+    }
+
+    if ((mask & EPOLLOUT) && !flush(conn)) {
+        fail(conn, measureFrom);
+        return;
+    }
+
+    if (mask & (EPOLLIN | EPOLLHUP | EPOLLERR)) {
+        char chunk[64 * 1024];
+        while (true) {
+            ssize_t n = ::recv(conn.fd, chunk, sizeof(chunk), 0);
+            if (n > 0) {
+                conn.in.append(chunk, static_cast<size_t>(n));
+                continue;
+            }
+            if (n < 0 && errno == EINTR) continue;
+            if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
+            // 对端关闭或出错：先处理已收到的应答
+            Response response;
+            if (conn.busy && parseResponse(conn.in, response) > 0) {
+                complete(conn, response, measureFrom);
+                closeSocket(conn);
+            } else {
+                fail(conn, measureFrom);
+            }
+            return;
+        }
+
+        if (conn.busy) {
+            Response response;
+            long consumed = parseResponse(conn.in, response);
+            if (consumed < 0) {
+                fail(conn, measureFrom);
+                return;
+            }
+            if (consumed > 0) {
+                conn.in.erase(0, static_cast<size_t>(consumed));
+                complete(conn, response, measureFrom);
+            }
+        }
+    }
+
+    // 只在还有数据没发出去时关注 EPOLLOUT
+    if (conn.fd >= 0) {
+        epoll_event ev{};
+        ev.events = EPOLLIN | (conn.outOffset < conn.out.size() ? static_cast<uint32_t>(EPOLLOUT) : 0u);
+        ev.data.u64 = index;
+        ::epoll_ctl(epoll_fd_, EPOLL_CTL_MOD, conn.fd, &ev);
+    }
+}
+
+void Worker::armTimer(Clock::time_point at) {
+    auto delay = std::chrono::duration_cast<std::chrono::nanoseconds>(at - Clock::now()).count();
+    itimerspec spec{};
+    delay = std::max<long long>(delay, 1000);
+    spec.it_value.tv_sec = static_cast<time_t>(delay / 1000000000);
+    spec.it_value.tv_nsec = static_cast<long>(delay % 1000000000);
+    ::timerfd_settime(timer_fd_, 0, &spec, nullptr);
+}
+
+void Worker::run(Clock::time_point begin, Clock::time_point measureFrom, Clock::time_point end) {
+    epoll_fd_ = ::epoll_create1(0);
+    timer_fd_ = ::timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK);
+    const uint64_t kTimerTag = ~uint64_t(0);
+    epoll_event timerEvent{};
+    timerEvent.events = EPOLLIN;
+    timerEvent.data.u64 = kTimerTag;
+    ::epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, timer_fd_, &timerEvent);
+
+    std::exponential_distribution<double> interval(rate_ > 0 ? rate_ : 1.0);
+    auto nextArrival = begin;
+    auto advance = [&] {
+        nextArrival += std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(interval(random_)));
+    };
+    if (rate_ > 0) {
+        advance();
+        armTimer(nextArrival);
+    }
+
+    epoll_event events[256];
+    while (true) {
+        auto now = Clock::now();
+        if (now >= end) {
+            break;
+        }
+
+        if (rate_ > 0) {
+            while (nextArrival <= now) {
+                backlog_.push_back(nextArrival);
+                advance();
+            }
+            for (size_t i = 0; i < conns_.size() && !backlog_.empty(); ++i) {
+                if (!conns_[i].busy && conns_[i].retryAt <= now) {
+                    Clock::time_point start = backlog_.front();
+                    backlog_.pop_front();
+                    issue(i, start);
+                }
+            }
+            armTimer(nextArrival);
+        } else {
+            for (size_t i = 0; i < conns_.size(); ++i) {
+                if (!conns_[i].busy && conns_[i].retryAt <= now) {
+                    issue(i, Clock::now());
+                }
+            }
+        }
+
+        int timeout = static_cast<int>(std::min<long long>(
+            10, std::chrono::duration_cast<std::chrono::milliseconds>(end - now).count() + 1));
+        int n = ::epoll_wait(epoll_fd_, events, 256, timeout);
+        for (int i = 0; i < n; ++i) {
+            if (events[i].data.u64 == kTimerTag) {
+                uint64_t expirations = 0;
+                ssize_t ignored = ::read(timer_fd_, &expirations, sizeof(expirations));
+                (void)ignored;
+                continue;
+            }
+            onEvent(static_cast<size_t>(events[i].data.u64), events[i].events, measureFrom);
+        }
+    }
+}
+
+bool parseMix(const std::string& text, int weights[kKindCount]) {
+    std::fill(weights, weights + kKindCount, 0);
+    size_t pos = 0;
+    int total = 0;
+    while (pos < text.size()) {
+        size_t end = text.find(',', pos);
+        if (end == std::string::npos) end = text.size();
+        std::string item = text.substr(pos, end - pos);
+        size_t eq = item.find('=');
+        if (eq == std::string::npos) return false;
+        std::string name = item.substr(0, eq);
+        int weight = std::atoi(item.c_str() + eq + 1);
+        int kind = 0;
+        while (kind < kKindCount && name != kKindNames[kind]) ++kind;
+        if (kind == kKindCount || weight < 0) return false;
+        weights[kind] = weight;
+        total += weight;
+        pos = end + 1;
+    }
+    return total > 0;
+}
+
+bool parseOptions(int argc, char* argv[], Options& options) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        size_t eq = arg.find('=');
+        std::string name = arg.substr(0, eq);
+        std::string value = eq == std::string::npos ? std::string() : arg.substr(eq + 1);
+        if (name == "--host") options.host = value;
+        else if (name == "--port") options.port = std::atoi(value.c_str());
+        else if (name == "--server-threads") options.serverThreads = std::atoi(value.c_str());
+        else if (name == "--connections") options.connections = std::atoi(value.c_str());
+        else if (name == "--threads") options.threads = std::atoi(value.c_str());
+        else if (name == "--duration") options.duration = std::atof(value.c_str());
+        else if (name == "--warmup") options.warmup = std::atof(value.c_str());
+        else if (name == "--rate") options.rate = std::atof(value.c_str());
+        else if (name == "--no-keepalive") options.keepAlive = false;
+        else if (name == "--playlist-size") options.playlistSize = std::atoi(value.c_str());
+        else if (name == "--mix") {
+            if (!parseMix(value, options.weights)) return false;
+        } else {
+            return false;
+        }
+    }
+    return options.connections > 0 && options.threads >= 0 && options.duration > 0 && options.warmup >= 0 &&
+           options.rate >= 0 && options.port >= 0 && options.serverThreads >= 0 && options.playlistSize >= 0;
+}
+
+void printRow(const char* name, const HistogramSnapshot& latency, uint64_t errors, double seconds) {
+    auto micros = [&](double q) { return static_cast<double>(latency.quantile(q)) / 1e3; };
+    std::printf("%-10s %10llu %8llu %10.0f %9.1f %9.1f %9.1f %9.1f %9.1f\n", name,
+                static_cast<unsigned long long>(latency.count()), static_cast<unsigned long long>(errors),
+                static_cast<double>(latency.count()) / seconds, micros(0.5), micros(0.9), micros(0.99),
+                micros(0.999), micros(1.0));
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    Options options;
+    if (!parseOptions(argc, argv, options)) {
+        std::cerr << "usage: musicfree_loadgen [--port=N] [--host=ADDR] [--server-threads=N] [--connections=N]\n"
+                     "                         [--threads=N] [--duration=SEC] [--warmup=SEC] [--rate=REQ_PER_SEC]\n"
+                     "                         [--no-keepalive] [--mix=status=60,playlist=20,search=10,favorite=10]\n"
+                     "                         [--playlist-size=N]"
+                  << std::endl;
+        return 1;
+    }
+
+    std::unique_ptr<ApiServer> server;
+    if (options.port == 0) {
+        ApiServerOptions serverOptions;
+        serverOptions.port = 0;
+        serverOptions.threads = options.serverThreads;
+        server = std::make_unique<ApiServer>();
+        if (!server->start(serverOptions)) {
+            std::cerr << "Failed to start server" << std::endl;
+            return 1;
+        }
+        options.port = server->getPort();
+    }
+
+    if (!seed(options)) {
+        std::cerr << "Failed to prepare data on " << options.host << ":" << options.port << std::endl;
+        return 1;
+    }
+
+    int threads = options.threads > 0 ? options.threads
+                                       : static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    threads = std::min(threads, options.connections);
+
+    std::printf("\ntarget: %s:%d (%s), connections: %d on %d threads, keep-alive: %s\n", options.host.c_str(),
+                options.port, server ? "in-process" : "external", options.connections, threads,
+                options.keepAlive ? "on" : "off");
+    if (options.rate > 0) {
+        std::printf("open loop: %.0f req/s (Poisson arrivals), ", options.rate);
+    } else {
+        std::printf("closed loop, ");
+    }
+    std::printf("duration: %.1fs after %.1fs warmup, mix: status=%d playlist=%d search=%d favorite=%d\n\n",
+                options.duration, options.warmup, options.weights[0], options.weights[1], options.weights[2],
+                options.weights[3]);
+
+    std::vector<std::unique_ptr<Worker>> workers;
+    for (int t = 0; t < threads; ++t) {
+        int connections = options.connections / threads + (t < options.connections % threads ? 1 : 0);
+        workers.push_back(std::make_unique<Worker>(options, t, connections, options.rate / threads));
+    }
+
+    auto begin = Clock::now();
+    auto measureFrom = begin + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(options.warmup));
+    auto end = measureFrom + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(options.duration));
+    std::vector<std::thread> runners;
+    for (auto& worker : workers) {
+        runners.emplace_back([&worker, begin, measureFrom, end] { worker->run(begin, measureFrom, end); });
+    }
+    for (auto& runner : runners) {
+        runner.join();
+    }
+
+    std::printf("%-10s %10s %8s %10s %9s %9s %9s %9s %9s\n", "request", "count", "errors", "req/s", "p50 us",
+                "p90 us", "p99 us", "p99.9 us", "max us");
+    HistogramSnapshot total;
+    uint64_t totalErrors = 0;
+    for (int kind = 0; kind < kKindCount; ++kind) {
+        HistogramSnapshot latency;
+        uint64_t errors = 0;
+        for (const auto& worker : workers) {
+            latency.merge(worker->stats(kind).latency);
+            errors += worker->stats(kind).errors;
+        }
+        if (latency.count() > 0) {
+            printRow(kKindNames[kind], latency, errors, options.duration);
+        }
+        total.merge(latency);
+        totalErrors += errors;
+    }
+    printRow("total", total, totalErrors, options.duration);
+
+    uint64_t socketErrors = 0;
+    size_t backlog = 0;
+    for (const auto& worker : workers) {
+        socketErrors += worker->socketErrors();
+        backlog += worker->backlog();
+    }
+    std::printf("\nsocket errors: %llu", static_cast<unsigned long long>(socketErrors));
+    if (options.rate > 0) {
+        // 结束时仍在排队说明服务器跟不上目标速率，上面的延迟包含了排队时间
+        std::printf(", unsent backlog at end: %zu", backlog);
+    }
+    std::printf("\n");
+
+    if (server) {
+        server->stop();
+    }
+    return 0;
+}
@@ -0,0 +1,362 @@
+/**
+ * 响度分析与归一化基准
+ *
+ *   1. 批量分析：生成若干首 16 位立体声 WAV（噪声，电平各不相同，分属 4 张专辑），用所有核心分析，
+ *      报告每分钟的曲目数（含折算成 4 分钟曲目的数字）、单核的实时倍率和峰值内存的增长；
+ *      检查各曲目响度与电平一致、专辑响度在曲目之间、专辑峰值为曲目峰值的最大值、
+ *      结果写进元数据缓存并能从缓存文件重新加载
+ *   2. 响度计的准确性（EBU Tech 3341 的几个用例，容差 ±0.1 LU）：立体声 1 kHz 正弦 -23 / -33 dBFS、
+ *      -36 / -23 / -36 dBFS 三段的门限、44.1 kHz 下的同一信号；
+ *      真峰值：fs/4、相位 45° 的正弦，采样峰值比真峰值低 3.01 dB（容差 ±0.2 dB）
+ *   3. 播放时的归一化：引擎用 WAV 输出端播放分析过的曲目，
+ *      单曲模式下安静的噪声输出响度等于目标 -18 LUFS，峰值很高的曲目被限制在 0 dBTP
+ *
+ * 用法: musicfree_loudness_bench [tracks] [seconds_per_track] [threads] [dir]
+ */
+
+#include "../include/audio_engine.h"
+#include "../include/loudness_analyzer.h"
+#include "../include/metadata_cache.h"
+#include "../src/core/loudness_meter.h"
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace musicfree;
+
+namespace {
+
+constexpr double kPi = 3.14159265358979323846;
+constexpr int kChannels = 2;
+constexpr int kAlbums = 4;
+
+void putLe16(std::vector<uint8_t>& out, uint16_t value) {
+    out.push_back(static_cast<uint8_t>(value));
+    out.push_back(static_cast<uint8_t>(value >> 8));
+}
+
+void putLe32(std::vector<uint8_t>& out, uint32_t value) {
+    for (int i = 0; i < 4; ++i) {
+        out.push_back(static_cast<uint8_t>(value >> (8 * i)));
+    }
+}
+
+void putTag(std::vector<uint8_t>& out, const char* tag) {
+    out.insert(out.end(), tag, tag + 4);
+}
+
+/**
+ * 写一首 16 位立体声 WAV，album 非空时带 LIST/INFO 的 IPRD
+ * 采样由 generate(帧号, 声道) 给出，分块写入，不在内存中保留整首
+ */
+template <typename Generator>
+bool writeTrack(const std::string& path, int sampleRate, uint64_t frames, const std::string& album,
+                Generator generate) {
+    std::vector<uint8_t> info;
+    if (!album.empty()) {
+        putTag(info, "INFO");
+        putTag(info, "IPRD");
+        putLe32(info, static_cast<uint32_t>(album.size() + 1));
+        info.insert(info.end(), album.begin(), album.end());
+        info.push_back(0);
+        if (info.size() & 1) {
+            info.push_back(0);
+        }
+    }
+    uint32_t dataBytes = static_cast<uint32_t>(frames * kChannels * 2);
+
+    std::vector<uint8_t> header;
+    putTag(header, "RIFF");
+    putLe32(header, static_cast<uint32_t>(4 + 24 + (info.empty() ? 0 : 8 + info.size()) + 8 + dataBytes));
+    putTag(header, "WAVE");
+    putTag(header, "fmt ");
+    putLe32(header, 16);
+    putLe16(header, 1);
+    putLe16(header, kChannels);
+    putLe32(header, static_cast<uint32_t>(sampleRate));
+    putLe32(header, static_cast<uint32_t>(sampleRate * kChannels * 2));
+    putLe16(header, kChannels * 2);
+    putLe16(header, 16);
+    if (!info.empty()) {
+        putTag(header, "LIST");
+        putLe32(header, static_cast<uint32_t>(info.size()));
+        header.insert(header.end(), info.begin(), info.end());
+    }
+    putTag(header, "data");
+    putLe32(header, dataBytes);
+
+    FILE* file = std::fopen(path.c_str(), "wb");
+    if (!file) {
+        return false;
+    }
+    bool ok = std::fwrite(header.data(), 1, header.size(), file) == header.size();
+    std::vector<uint8_t> block;
+    for (uint64_t f = 0; f < frames && ok; ++f) {
+        for (int c = 0; c < kChannels; ++c) {
+            double value = std::min(std::max(generate(f, c), -1.0), 32767.0 / 32768.0);
+            putLe16(block, static_cast<uint16_t>(static_cast<int16_t>(std::lround(value * 32768.0))));
+        }
+        if (block.size() >= 65536 || f + 1 == frames) {
+            ok = std::fwrite(block.data(), 1, block.size(), file) == block.size();
+            block.clear();
+        }
+    }
+    return std::fclose(file) == 0 && ok;
+}
+
+/**
+ * 确定的伪随机噪声，[-1, 1) 均匀分布
+ */
+struct Noise {
+    uint32_t seed;
+    double amplitude;
+    double operator()(uint64_t, int) {
+        seed = seed * 1664525u + 1013904223u;
+        return amplitude * static_cast<double>(static_cast<int32_t>(seed)) / 2147483648.0;
+    }
+};
+
+struct Measurement {
+    double loudness = 0;
+    double truePeakDb = 0;
+};
+
+Measurement measure(const std::vector<float>& samples, int sampleRate) {
+    LoudnessMeter meter(kChannels);
+    meter.reset(sampleRate);
+    meter.process(samples.data(), samples.size() / kChannels);
+    meter.finish();
+    return {meter.integratedLoudness(), 20.0 * std::log10(meter.truePeak())};
+}
+
+/**
+ * 立体声正弦，两个声道相同，amplitudeDb 为峰值电平（dBFS）
+ * @param fadeSeconds 首尾的升余弦淡入淡出（突然开始的正弦经过插值会有吉布斯过冲）
+ */
+void appendSine(std::vector<float>& samples, int sampleRate, double seconds, double frequency, double amplitudeDb,
+                double phase = 0, double fadeSeconds = 0) {
+    double amplitude = std::pow(10.0, amplitudeDb / 20.0);
+    size_t frames = static_cast<size_t>(seconds * sampleRate);
+    size_t fade = static_cast<size_t>(fadeSeconds * sampleRate);
+    for (size_t i = 0; i < frames; ++i) {
+        double envelope = 1.0;
+        size_t edge = std::min(i, frames - 1 - i);
+        if (edge < fade) {
+            envelope = 0.5 - 0.5 * std::cos(kPi * static_cast<double>(edge) / static_cast<double>(fade));
+        }
+        float value = static_cast<float>(envelope * amplitude *
+                                         std::sin(2.0 * kPi * frequency * static_cast<double>(i) / sampleRate + phase));
+        samples.push_back(value);
+        samples.push_back(value);
+    }
+}
+
+bool near(const char* name, double actual, double expected, double tolerance) {
+    bool ok = std::fabs(actual - expected) <= tolerance;
+    std::printf("  %-44s %8.3f (expected %7.2f)  %s\n", name, actual, expected, ok ? "ok" : "WRONG");
+    return ok;
+}
+
+long peakRssKb() {
+    rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+}
+
+/**
+ * 用引擎播放一首（WAV 输出端、音量 100）并读回输出
+ */
+std::vector<float> playThrough(const std::string& file, const std::string& outputPath, NormalizationMode mode,
+                               double targetLufs) {
+    AudioEngineOptions options;
+    options.outputSink = OutputSinkType::WAV_FILE;
+    options.outputPath = outputPath;
+    options.normalization = mode;
+    options.normalizationTargetLufs = targetLufs;
+    {
+        AudioEngine engine(options);
+        engine.setVolume(100);
+        engine.load(file);
+        engine.play();
+        while (engine.getState() == PlayState::PLAYING) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+
+    // WAV 输出端写 float32，文件头 58 字节
+    std::vector<float> samples;
+    FILE* out = std::fopen(outputPath.c_str(), "rb");
+    if (out != nullptr) {
+        std::fseek(out, 0, SEEK_END);
+        long size = std::ftell(out);
+        std::fseek(out, 58, SEEK_SET);
+        samples.resize(size > 58 ? static_cast<size_t>(size - 58) / sizeof(float) : 0);
+        samples.resize(std::fread(samples.data(), sizeof(float), samples.size(), out));
+        std::fclose(out);
+    }
+    std::remove(outputPath.c_str());
+    return samples;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    size_t tracks = argc > 1 ? static_cast<size_t>(std::max(kAlbums, std::atoi(argv[1]))) : 64;
+    int seconds = argc > 2 ? std::max(5, std::atoi(argv[2])) : 30;
+    int threads = argc > 3 ? std::max(0, std::atoi(argv[3])) : 0;
+    std::string dir = argc > 4 ? argv[4] : "/tmp/musicfree_loudness_bench";
+    mkdir(dir.c_str(), 0755);
+    bool pass = true;
+
+    // ===== 1. 批量分析（最先运行，峰值内存的增长不受其他部分影响）=====
+    const int sampleRate = 44100;
+    std::vector<std::string> files;
+    std::vector<double> amplitudes;
+    double fileMb = 0;
+    for (size_t i = 0; i < tracks; ++i) {
+        std::string path = dir + "/track" + std::to_string(i) + ".wav";
+        double amplitude = 0.02 * static_cast<double>(1 + i % 13);
+        uint64_t frames = static_cast<uint64_t>(seconds) * sampleRate + i * 331;
+        std::string album = "Album " + std::to_string(i % kAlbums);
+        if (!writeTrack(path, sampleRate, frames, album, Noise{static_cast<uint32_t>(i) * 2654435761u + 1,
+                                                              amplitude})) {
+            std::printf("cannot write %s\n", path.c_str());
+            return 1;
+        }
+        files.push_back(path);
+        amplitudes.push_back(amplitude);
+        fileMb = static_cast<double>(frames * kChannels * 2) / (1 << 20);
+    }
+
+    std::string cachePath = dir + "/metadata.cache";
+    std::remove(cachePath.c_str());
+    MetadataCache& cache = MetadataCache::getInstance();
+    cache.initialize(cachePath);
+
+    LoudnessAnalyzer analyzer(threads);
+    long rssBefore = peakRssKb();
+    LoudnessBatchResult result = analyzer.analyze(files);
+    long rssAfter = peakRssKb();
+    int workers = threads > 0 ? threads : static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+
+    std::printf("batch: %zu tracks x %d s, %d Hz 16-bit stereo (%.1f MB each), %d threads\n", tracks, seconds,
+                sampleRate, fileMb, workers);
+    std::printf("  analyzed %zu, skipped %zu, %zu albums in %.3f s\n", result.analyzed, result.skipped,
+                result.albums, result.seconds);
+    std::printf("  %.0f tracks/min, %.0f four-minute tracks/min, %.0fx realtime per thread\n",
+                static_cast<double>(result.analyzed) / result.seconds * 60,
+                result.audioSeconds / 240 / result.seconds * 60, result.audioSeconds / result.seconds / workers);
+    std::printf("  peak RSS %+.1f MB during the batch\n", static_cast<double>(rssAfter - rssBefore) / 1024);
+    if (result.analyzed != tracks || result.albums != static_cast<size_t>(kAlbums)) {
+        pass = false;
+    }
+
+    // 噪声的响度减去电平应当是同一个值
+    double offsetSum = 0;
+    for (size_t i = 0; i < tracks; ++i) {
+        offsetSum += result.tracks[i].loudness.trackLoudness - 20.0 * std::log10(amplitudes[i]);
+    }
+    double offset = offsetSum / static_cast<double>(tracks);
+    double worstOffset = 0;
+    bool albumsOk = true;
+    for (size_t i = 0; i < tracks; ++i) {
+        const LoudnessInfo& loudness = result.tracks[i].loudness;
+        worstOffset = std::max(worstOffset, std::fabs(loudness.trackLoudness - 20.0 * std::log10(amplitudes[i]) -
+                                                      offset));
+        double low = 1e9;
+        double high = -1e9;
+        double peak = -1e9;
+        for (size_t j = i % kAlbums; j < tracks; j += kAlbums) {
+            low = std::min(low, result.tracks[j].loudness.trackLoudness);
+            high = std::max(high, result.tracks[j].loudness.trackLoudness);
+            peak = std::max(peak, result.tracks[j].loudness.trackPeak);
+        }
+        if (loudness.albumLoudness < low || loudness.albumLoudness > high || loudness.albumPeak != peak) {
+            albumsOk = false;
+        }
+    }
+    std::printf("  track loudness follows level within %.3f LU; album loudness and peak %s\n", worstOffset,
+                albumsOk ? "consistent" : "INCONSISTENT");
+    if (worstOffset > 0.1 || !albumsOk) {
+        pass = false;
+    }
+
+    // 重新加载缓存文件
+    cache.initialize(cachePath);
+    LoudnessInfo cached;
+    bool reloaded = cache.getStats().loudnessEntries == tracks && cache.getLoudness(files[0], cached) &&
+                    cached.trackLoudness == result.tracks[0].loudness.trackLoudness &&
+                    cached.albumPeak == result.tracks[0].loudness.albumPeak;
+    std::printf("  metadata cache reloaded with %zu loudness entries %s\n", cache.getStats().loudnessEntries,
+                reloaded ? "ok" : "WRONG");
+    pass &= reloaded;
+
+    // ===== 2. 准确性 =====
+    std::printf("\nmeter (EBU Tech 3341)\n");
+    {
+        std::vector<float> samples;
+        appendSine(samples, 48000, 20, 1000, -23);
+        pass &= near("1 kHz -23 dBFS, 48 kHz (LUFS)", measure(samples, 48000).loudness, -23, 0.1);
+
+        samples.clear();
+        appendSine(samples, 48000, 20, 1000, -33);
+        pass &= near("1 kHz -33 dBFS, 48 kHz (LUFS)", measure(samples, 48000).loudness, -33, 0.1);
+
+        samples.clear();
+        appendSine(samples, 48000, 10, 1000, -36);
+        appendSine(samples, 48000, 60, 1000, -23);
+        appendSine(samples, 48000, 10, 1000, -36);
+        pass &= near("-36 / -23 / -36 dBFS gated (LUFS)", measure(samples, 48000).loudness, -23, 0.1);
+
+        samples.clear();
+        appendSine(samples, 44100, 20, 1000, -23);
+        pass &= near("1 kHz -23 dBFS, 44.1 kHz (LUFS)", measure(samples, 44100).loudness, -23, 0.1);
+
+        samples.clear();
+        appendSine(samples, 48000, 5, 12000, 0, kPi / 4, 0.05);
+        Measurement tp = measure(samples, 48000);
+        pass &= near("fs/4 sine, 45 deg, sample peak -3.01 (dBTP)", tp.truePeakDb, 0, 0.2);
+        pass &= near("sample peak of the same sine (dBFS)", 20.0 * std::log10(*std::max_element(samples.begin(),
+                                                                                               samples.end())),
+                     -3.01, 0.01);
+    }
+
+    // ===== 3. 播放时的归一化 =====
+    std::printf("\nplayback normalization (track mode, target -18 LUFS)\n");
+    std::string quiet = dir + "/quiet.wav";
+    std::string spiky = dir + "/spiky.wav";
+    writeTrack(quiet, sampleRate, 10 * sampleRate, "", Noise{12345, 0.03});
+    // 安静的噪声上每秒一个 -0.9 dBFS 的脉冲：按响度需要提升很多，但真峰值只允许 +0.9 dB
+    Noise floor{777, 0.01};
+    writeTrack(spiky, sampleRate, 10 * sampleRate, "", [&](uint64_t frame, int channel) {
+        double value = floor(frame, channel);
+        return frame % static_cast<uint64_t>(sampleRate) == 1000 ? std::pow(10.0, -0.9 / 20.0) : value;
+    });
+    LoudnessBatchResult single = analyzer.analyze({quiet, spiky});
+    pass &= single.analyzed == 2;
+
+    std::vector<float> output = playThrough(quiet, dir + "/output.wav", NormalizationMode::TRACK, -18);
+    pass &= near("quiet noise, output loudness (LUFS)", measure(output, sampleRate).loudness, -18, 0.1);
+    output = playThrough(spiky, dir + "/output.wav", NormalizationMode::TRACK, -18);
+    pass &= near("peaky track, output true peak (dBTP)", measure(output, sampleRate).truePeakDb, 0, 0.05);
+    output = playThrough(quiet, dir + "/output.wav", NormalizationMode::OFF, -18);
+    pass &= near("normalization off, output loudness (LUFS)", measure(output, sampleRate).loudness,
+                 single.tracks[0].loudness.trackLoudness, 0.05);
+
+    for (const auto& path : files) {
+        std::remove(path.c_str());
+    }
+    std::remove(quiet.c_str());
+    std::remove(spiky.c_str());
+    cache.shutdown();
+    std::remove(cachePath.c_str());
+    std::printf("%s\n", pass ? "PASS" : "FAIL");
+    return pass ? 0 : 1;
+}
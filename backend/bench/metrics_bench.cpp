@@ -0,0 +1,157 @@
+/**
+ * 请求指标记录开销基准
+ *
+ * 测量 Reactor 每个请求额外做的工作：
+ *   - record：直方图记录一个数值
+ *   - request：状态码类别 / 字节计数 + 进行中计数 + 暂存开始时间 + 事件结束时记录耗时，
+ *     即 Reactor::handleRequest / recordLatencies 中新增的全部开销
+ *
+ * 请求的开始和完成时间都取自事件循环时钟（每处理完一个连接的事件读一次，
+ * 原来读事件开始时就要读一次时钟更新 lastActive），所以每个请求不额外读时钟；
+ * steady_clock::now 一行给出单次读时钟的开销作为参考。
+ *
+ * 然后用多个线程各自写自己的分片，确认分片之间没有互相干扰（每线程耗时应与单线程接近）。
+ *
+ * 用法: musicfree_metrics_bench [iterations] [threads]
+ */
+
+#include "../include/metrics.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <thread>
+#include <vector>
+
+using namespace musicfree;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// 与 Reactor::RouteCounters 相同的布局
+struct RouteCounters {
+    std::atomic<uint64_t> responses[5] = {};
+    std::atomic<uint64_t> bytesIn{0};
+    std::atomic<uint64_t> bytesOut{0};
+    LatencyHistogram latency;
+};
+
+struct Shard {
+    std::unique_ptr<RouteCounters[]> routes{new RouteCounters[32]};
+    std::atomic<uint64_t> inFlight{0};
+};
+
+inline void bump(std::atomic<uint64_t>& counter, uint64_t delta) {
+    counter.store(counter.load(std::memory_order_relaxed) + delta, std::memory_order_relaxed);
+}
+
+double nsPerOp(Clock::time_point begin, long iterations) {
+    return std::chrono::duration<double, std::nano>(Clock::now() - begin).count() / static_cast<double>(iterations);
+}
+
+double benchRecord(long iterations) {
+    LatencyHistogram histogram;
+    uint64_t value = 12345;
+    auto begin = Clock::now();
+    for (long i = 0; i < iterations; ++i) {
+        // 线性同余，让数值分散到不同的桶
+        value = value * 6364136223846793005ULL + 1442695040888963407ULL;
+        histogram.record(value >> 40);
+    }
+    return nsPerOp(begin, iterations);
+}
+
+double benchRequest(Shard& shard, long iterations) {
+    std::vector<std::pair<LatencyHistogram*, Clock::time_point>> pending;
+    pending.reserve(16);
+    // 模拟事件循环时钟：每个“事件”处理一个请求，时间按固定步长前进
+    Clock::time_point now = Clock::now();
+    auto begin = Clock::now();
+    for (long i = 0; i < iterations; ++i) {
+        Clock::time_point start = now;
+        RouteCounters& route = shard.routes[i & 31];
+        bump(route.responses[1], 1);
+        bump(route.bytesIn, 200);
+        bump(route.bytesOut, 1500);
+        bump(shard.inFlight, 1);
+        pending.push_back({&route.latency, start});
+
+        now += std::chrono::nanoseconds(20000 + (i & 1023) * 37);
+        for (const auto& entry : pending) {
+            entry.first->record(static_cast<uint64_t>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(now - entry.second).count()));
+        }
+        pending.clear();
+        bump(shard.inFlight, static_cast<uint64_t>(-1));
+    }
+    return nsPerOp(begin, iterations);
+}
+
+double benchClock(long iterations) {
+    auto begin = Clock::now();
+    uint64_t sink = 0;
+    for (long i = 0; i < iterations; ++i) {
+        sink += static_cast<uint64_t>(Clock::now().time_since_epoch().count());
+    }
+    double result = nsPerOp(begin, iterations);
+    if (sink == 42) {
+        std::printf(" ");
+    }
+    return result;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    long iterations = argc > 1 ? std::atol(argv[1]) : 20000000;
+    int threads = argc > 2 ? std::atoi(argv[2]) : static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    if (iterations <= 0 || threads <= 0) {
+        std::fprintf(stderr, "usage: musicfree_metrics_bench [iterations] [threads]\n");
+        return 1;
+    }
+
+    std::printf("iterations: %ld, threads: %d\n\n", iterations, threads);
+    std::printf("steady_clock::now   %6.1f ns\n", benchClock(iterations));
+    std::printf("histogram record    %6.1f ns\n", benchRecord(iterations));
+
+    Shard single;
+    std::printf("request (1 thread)  %6.1f ns\n", benchRequest(single, iterations));
+
+    // 每个线程一个分片，对应每个事件循环线程一个 Reactor
+    std::vector<std::unique_ptr<Shard>> shards;
+    std::vector<double> results(threads);
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; ++t) {
+        shards.push_back(std::make_unique<Shard>());
+    }
+    for (int t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t] { results[t] = benchRequest(*shards[t], iterations); });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    std::printf("request (%d threads) %5.1f ns (slowest thread)\n", threads,
+                *std::max_element(results.begin(), results.end()));
+
+    // 合并分片并检查计数
+    HistogramSnapshot merged;
+    uint64_t total = 0;
+    for (const auto& shard : shards) {
+        for (int r = 0; r < 32; ++r) {
+            merged.merge(shard->routes[r].latency);
+            total += shard->routes[r].responses[1].load(std::memory_order_relaxed);
+        }
+    }
+    if (total != static_cast<uint64_t>(iterations) * threads || merged.count() != total) {
+        std::fprintf(stderr, "lost updates: %llu of %llu\n", static_cast<unsigned long long>(total),
+                     static_cast<unsigned long long>(iterations) * threads);
+        return 1;
+    }
+    std::printf("\nrecorded latency p50 %llu ns, p99 %llu ns\n",
+                static_cast<unsigned long long>(merged.quantile(0.5)),
+                static_cast<unsigned long long>(merged.quantile(0.99)));
+    return 0;
+}
@@ -0,0 +1,305 @@
+/**
+ * 内存映射 PCM 加载基准
+ *
+ * 1. 格式检查：生成 WAV（8 / 16 / 24 / 32 位整数、32 / 64 位浮点）、AIFF（16 / 24 位大端）、
+ *    AIFF-C（sowt 小端、fl32）和原始 PCM 文件，解码结果与写入的采样比较
+ * 2. 加载耗时：生成不同大小的 16 位立体声 WAV，测量 openPcmFile（映射 + 解析文件头）
+ *    和读出第一个周期的耗时（取中位数），应当与文件大小无关；再顺序读完整个文件，给出转换吞吐
+ *
+ * 用法: musicfree_pcm_load_bench [dir] [max_mb]
+ */
+
+#include "../src/core/pcm_file_source.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+using namespace musicfree;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr int kSampleRate = 44100;
+constexpr int kChannels = 2;
+constexpr size_t kPeriodFrames = 1024;
+constexpr size_t kCheckFrames = 5000;
+
+void put16le(std::vector<uint8_t>& out, uint32_t v) {
+    out.push_back(static_cast<uint8_t>(v));
+    out.push_back(static_cast<uint8_t>(v >> 8));
+}
+
+void put32le(std::vector<uint8_t>& out, uint32_t v) {
+    put16le(out, v & 0xFFFF);
+    put16le(out, v >> 16);
+}
+
+void put16be(std::vector<uint8_t>& out, uint32_t v) {
+    out.push_back(static_cast<uint8_t>(v >> 8));
+    out.push_back(static_cast<uint8_t>(v));
+}
+
+void put32be(std::vector<uint8_t>& out, uint32_t v) {
+    put16be(out, v >> 16);
+    put16be(out, v & 0xFFFF);
+}
+
+void putTag(std::vector<uint8_t>& out, const char* tag) {
+    for (int i = 0; i < 4; ++i) {
+        out.push_back(static_cast<uint8_t>(tag[i]));
+    }
+}
+
+/**
+ * 第 i 个采样的值：[-1, 1) 内的确定序列
+ */
+double sampleValue(size_t i) {
+    return std::sin(static_cast<double>(i) * 0.013) * 0.9;
+}
+
+/**
+ * 按编码把采样写成字节
+ */
+void encodeSample(std::vector<uint8_t>& out, double value, SampleEncoding encoding, bool bigEndian) {
+    auto putBytes = [&](uint64_t bits, int bytes) {
+        for (int b = 0; b < bytes; ++b) {
+            int shift = bigEndian ? (bytes - 1 - b) * 8 : b * 8;
+            out.push_back(static_cast<uint8_t>(bits >> shift));
+        }
+    };
+    switch (encoding) {
+        case SampleEncoding::UINT8:
+            out.push_back(static_cast<uint8_t>(std::lround(value * 127.0) + 128));
+            break;
+        case SampleEncoding::INT8:
+            out.push_back(static_cast<uint8_t>(static_cast<int8_t>(std::lround(value * 127.0))));
+            break;
+        case SampleEncoding::INT16:
+            putBytes(static_cast<uint16_t>(static_cast<int16_t>(std::lround(value * 32767.0))), 2);
+            break;
+        case SampleEncoding::INT24:
+            putBytes(static_cast<uint32_t>(static_cast<int32_t>(std::lround(value * 8388607.0))) & 0xFFFFFF, 3);
+            break;
+        case SampleEncoding::INT32:
+            putBytes(static_cast<uint32_t>(static_cast<int32_t>(std::lround(value * 2147483647.0))), 4);
+            break;
+        case SampleEncoding::FLOAT32: {
+            float f = static_cast<float>(value);
+            uint32_t bits;
+            std::memcpy(&bits, &f, sizeof(bits));
+            putBytes(bits, 4);
+            break;
+        }
+        case SampleEncoding::FLOAT64: {
+            uint64_t bits;
+            std::memcpy(&bits, &value, sizeof(bits));
+            putBytes(bits, 8);
+            break;
+        }
+    }
+}
+
+size_t containerBytes(SampleEncoding encoding) {
+    switch (encoding) {
+        case SampleEncoding::UINT8:
+        case SampleEncoding::INT8: return 1;
+        case SampleEncoding::INT16: return 2;
+        case SampleEncoding::INT24: return 3;
+        case SampleEncoding::INT32:
+        case SampleEncoding::FLOAT32: return 4;
+        case SampleEncoding::FLOAT64: return 8;
+    }
+    return 2;
+}
+
+std::vector<uint8_t> samples(size_t frames, int channels, SampleEncoding encoding, bool bigEndian) {
+    std::vector<uint8_t> out;
+    out.reserve(frames * static_cast<size_t>(channels) * containerBytes(encoding));
+    for (size_t i = 0; i < frames * static_cast<size_t>(channels); ++i) {
+        encodeSample(out, sampleValue(i), encoding, bigEndian);
+    }
+    return out;
+}
+
+std::vector<uint8_t> makeWav(size_t frames, int channels, SampleEncoding encoding) {
+    std::vector<uint8_t> data = samples(frames, channels, encoding, false);
+    bool isFloat = encoding == SampleEncoding::FLOAT32 || encoding == SampleEncoding::FLOAT64;
+    uint32_t bytes = static_cast<uint32_t>(containerBytes(encoding));
+    const char title[] = "Bench Title";
+
+    std::vector<uint8_t> out;
+    putTag(out, "RIFF");
+    put32le(out, 0);  // 大小字段由解析器忽略
+    putTag(out, "WAVE");
+    putTag(out, "fmt ");
+    put32le(out, 16);
+    put16le(out, isFloat ? 3 : 1);
+    put16le(out, static_cast<uint32_t>(channels));
+    put32le(out, kSampleRate);
+    put32le(out, kSampleRate * bytes * static_cast<uint32_t>(channels));
+    put16le(out, bytes * static_cast<uint32_t>(channels));
+    put16le(out, bytes * 8);
+    putTag(out, "LIST");
+    put32le(out, 4 + 8 + sizeof(title));  // 标题连同结尾的 NUL 是偶数字节，不需要补齐
+    putTag(out, "INFO");
+    putTag(out, "INAM");
+    put32le(out, sizeof(title));
+    out.insert(out.end(), title, title + sizeof(title));
+    putTag(out, "data");
+    put32le(out, static_cast<uint32_t>(data.size()));
+    out.insert(out.end(), data.begin(), data.end());
+    return out;
+}
+
+std::vector<uint8_t> makeAiff(size_t frames, int channels, SampleEncoding encoding, const char* compression) {
+    bool bigEndian = compression == nullptr || std::strcmp(compression, "sowt") != 0;
+    std::vector<uint8_t> data = samples(frames, channels, encoding, bigEndian);
+    std::vector<uint8_t> out;
+    putTag(out, "FORM");
+    put32le(out, 0);
+    putTag(out, compression ? "AIFC" : "AIFF");
+    putTag(out, "COMM");
+    put32be(out, compression ? 22 : 18);
+    put16be(out, static_cast<uint32_t>(channels));
+    put32be(out, static_cast<uint32_t>(frames));
+    put16be(out, static_cast<uint32_t>(containerBytes(encoding) * 8));
+    // 44100 的 80 位扩展精度表示
+    const uint8_t rate[10] = {0x40, 0x0E, 0xAC, 0x44, 0, 0, 0, 0, 0, 0};
+    out.insert(out.end(), rate, rate + 10);
+    if (compression) {
+        putTag(out, compression);
+    }
+    putTag(out, "SSND");
+    put32be(out, static_cast<uint32_t>(data.size() + 8));
+    put32be(out, 0);
+    put32be(out, 0);
+    out.insert(out.end(), data.begin(), data.end());
+    return out;
+}
+
+bool writeFile(const std::string& path, const std::vector<uint8_t>& bytes) {
+    FILE* f = std::fopen(path.c_str(), "wb");
+    if (!f) {
+        return false;
+    }
+    bool ok = std::fwrite(bytes.data(), 1, bytes.size(), f) == bytes.size();
+    return std::fclose(f) == 0 && ok;
+}
+
+bool check(const std::string& path, const char* name, int channels, double tolerance) {
+    std::unique_ptr<AudioSource> source;
+    AudioInfo info;
+    if (openPcmFile(path, kSampleRate, channels, source, info) != PcmOpenResult::OK) {
+        std::printf("%-22s open failed  FAIL\n", name);
+        return false;
+    }
+    // 多要几帧，确认读到结尾时返回的帧数
+    std::vector<float> out((kCheckFrames + 10) * static_cast<size_t>(channels));
+    size_t n = source->read(out.data(), kCheckFrames + 10);
+    double diff = 0;
+    for (size_t i = 0; i < n * static_cast<size_t>(channels); ++i) {
+        diff = std::max(diff, std::fabs(out[i] - sampleValue(i)));
+    }
+    bool ok = n == kCheckFrames && diff <= tolerance && info.sampleRate == kSampleRate && info.channels == channels;
+    std::printf("%-22s %-4s %2d bit  %zu frames  %d ms  max error %.3g%s\n", name, info.format.c_str(),
+                info.bitsPerSample, n, info.duration, diff, ok ? "" : "  FAIL");
+    return ok;
+}
+
+double median(std::vector<double> values) {
+    std::sort(values.begin(), values.end());
+    return values[values.size() / 2];
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    std::string dir = argc > 1 ? argv[1] : "/tmp";
+    long maxMb = argc > 2 ? std::atol(argv[2]) : 256;
+    if (maxMb <= 0) {
+        std::fprintf(stderr, "usage: musicfree_pcm_load_bench [dir] [max_mb]\n");
+        return 1;
+    }
+
+    struct FormatCase {
+        const char* name;
+        std::vector<uint8_t> bytes;
+        const char* extension;
+        double tolerance;
+    };
+    std::vector<FormatCase> cases;
+    cases.push_back({"wav u8", makeWav(kCheckFrames, kChannels, SampleEncoding::UINT8), "wav", 1.0 / 64});
+    cases.push_back({"wav s16", makeWav(kCheckFrames, kChannels, SampleEncoding::INT16), "wav", 1.0 / 16384});
+    cases.push_back({"wav s24", makeWav(kCheckFrames, kChannels, SampleEncoding::INT24), "wav", 1e-6});
+    cases.push_back({"wav s32", makeWav(kCheckFrames, kChannels, SampleEncoding::INT32), "wav", 1e-6});
+    cases.push_back({"wav f32", makeWav(kCheckFrames, kChannels, SampleEncoding::FLOAT32), "wav", 1e-7});
+    cases.push_back({"wav f64", makeWav(kCheckFrames, kChannels, SampleEncoding::FLOAT64), "wav", 1e-7});
+    cases.push_back({"aiff s16", makeAiff(kCheckFrames, kChannels, SampleEncoding::INT16, nullptr), "aiff",
+                     1.0 / 16384});
+    cases.push_back({"aiff s24", makeAiff(kCheckFrames, kChannels, SampleEncoding::INT24, nullptr), "aiff", 1e-6});
+    cases.push_back({"aifc sowt", makeAiff(kCheckFrames, kChannels, SampleEncoding::INT16, "sowt"), "aifc",
+                     1.0 / 16384});
+    cases.push_back({"aifc fl32", makeAiff(kCheckFrames, kChannels, SampleEncoding::FLOAT32, "fl32"), "aifc", 1e-7});
+    cases.push_back({"raw s16le", samples(kCheckFrames, kChannels, SampleEncoding::INT16, false), "pcm",
+                     1.0 / 16384});
+
+    bool ok = true;
+    for (const auto& c : cases) {
+        std::string path = dir + "/musicfree_pcm_check." + c.extension;
+        ok = writeFile(path, c.bytes) && check(path, c.name, kChannels, c.tolerance) && ok;
+        std::remove(path.c_str());
+    }
+
+    // 加载耗时
+    std::printf("\n%10s %14s %16s %18s\n", "size", "open (us)", "first read (us)", "decode (frames/us)");
+    std::vector<float> period(kPeriodFrames * kChannels);
+    for (long mb = 1; mb <= maxMb; mb *= 16) {
+        size_t frames = static_cast<size_t>(mb) * 1024 * 1024 / (2 * kChannels);
+        std::vector<uint8_t> bytes = makeWav(frames, kChannels, SampleEncoding::INT16);
+        std::string path = dir + "/musicfree_pcm_load_" + std::to_string(mb) + ".wav";
+        if (!writeFile(path, bytes)) {
+            std::printf("cannot write %s\n", path.c_str());
+            return 1;
+        }
+        bytes.clear();
+        bytes.shrink_to_fit();
+
+        std::vector<double> openTimes, readTimes;
+        for (int round = 0; round < 21; ++round) {
+            std::unique_ptr<AudioSource> source;
+            AudioInfo info;
+            auto begin = Clock::now();
+            PcmOpenResult result = openPcmFile(path, kSampleRate, kChannels, source, info);
+            auto opened = Clock::now();
+            if (result != PcmOpenResult::OK) {
+                std::printf("open failed: %s\n", path.c_str());
+                return 1;
+            }
+            source->read(period.data(), kPeriodFrames);
+            auto read = Clock::now();
+            openTimes.push_back(std::chrono::duration<double, std::micro>(opened - begin).count());
+            readTimes.push_back(std::chrono::duration<double, std::micro>(read - opened).count());
+        }
+
+        std::unique_ptr<AudioSource> source;
+        AudioInfo info;
+        openPcmFile(path, kSampleRate, kChannels, source, info);
+        auto begin = Clock::now();
+        size_t total = 0;
+        for (size_t n; (n = source->read(period.data(), kPeriodFrames)) > 0;) {
+            total += n;
+        }
+        double us = std::chrono::duration<double, std::micro>(Clock::now() - begin).count();
+        std::printf("%7ld MB %14.1f %16.1f %18.1f\n", mb, median(openTimes), median(readTimes),
+                    static_cast<double>(total) / us);
+        ok = ok && total == frames;
+        std::remove(path.c_str());
+    }
+    return ok ? 0 : 1;
+}
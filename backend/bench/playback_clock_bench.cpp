@@ -0,0 +1,207 @@
+/**
+ * 播放时钟漂移检查
+ *
+ * 播放位置（getPosition）由输出回调消费的帧数按采样率换算得到。这里拿它和输出端实际收到的帧数
+ * （AudioOutput 在写入输出端之后单独计数，见 AudioEngineMetrics::sinkFrames）比较，
+ * 两边是不同的计数器，也都不依赖系统时钟：
+ *   - 用不限速的丢弃输出端播放一个 8000 Hz 的 WAV（输出 44100 Hz，经过分数比的重采样），
+ *     一小时的曲目在几秒内放完，结果是确定的
+ *   - 每隔一小段时间暂停一次：pause() 返回时输出线程停在周期之间，两个计数器都不再变化，
+ *     位置减去输出端帧数换算的毫秒数（同样向下取整）就是漂移，整个过程中都应当为 0
+ *   - 暂停时已经取完最后一帧就不再继续：此时播放会从头开始
+ *   - 放完以后，输出端收到的总帧数与曲目按采样率换算的长度之差应当小于一个周期
+ * 曲目是稀疏文件（只写文件头再把文件扩展到完整长度），不占磁盘空间。
+ * 同时启动若干个忙循环线程制造 CPU 压力，另有一个线程不停调用 getPosition/getState，统计无锁读取的开销。
+ *
+ * 用法: musicfree_clock_bench [hours] [stress_threads] [dir]
+ * 注册为 CTest 测试 playback_clock，不通过时返回 1
+ */
+
+#include "../include/audio_engine.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+
+using namespace musicfree;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr int kMaxHours = 24;
+constexpr uint32_t kTrackSampleRate = 8000;
+constexpr auto kCheckInterval = std::chrono::milliseconds(20);
+
+void putLe16(std::vector<uint8_t>& out, uint16_t value) {
+    out.push_back(static_cast<uint8_t>(value));
+    out.push_back(static_cast<uint8_t>(value >> 8));
+}
+
+void putLe32(std::vector<uint8_t>& out, uint32_t value) {
+    for (int i = 0; i < 4; ++i) {
+        out.push_back(static_cast<uint8_t>(value >> (8 * i)));
+    }
+}
+
+void putTag(std::vector<uint8_t>& out, const char* tag) {
+    out.insert(out.end(), tag, tag + 4);
+}
+
+/**
+ * 写 16 位单声道 WAV：只写文件头，数据部分由 truncate 扩展成全零的稀疏区域
+ */
+bool writeSparseWav(const std::string& path, uint64_t frames) {
+    uint32_t dataBytes = static_cast<uint32_t>(frames * 2);
+    std::vector<uint8_t> header;
+    putTag(header, "RIFF");
+    putLe32(header, 36 + dataBytes);
+    putTag(header, "WAVE");
+    putTag(header, "fmt ");
+    putLe32(header, 16);
+    putLe16(header, 1);
+    putLe16(header, 1);
+    putLe32(header, kTrackSampleRate);
+    putLe32(header, kTrackSampleRate * 2);
+    putLe16(header, 2);
+    putLe16(header, 16);
+    putTag(header, "data");
+    putLe32(header, dataBytes);
+
+    FILE* file = std::fopen(path.c_str(), "wb");
+    if (!file) {
+        return false;
+    }
+    bool ok = std::fwrite(header.data(), 1, header.size(), file) == header.size();
+    ok = std::fclose(file) == 0 && ok;
+    return ok && ::truncate(path.c_str(), static_cast<off_t>(header.size() + dataBytes)) == 0;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    int hours = argc > 1 ? std::atoi(argv[1]) : 1;
+    int stressThreads = argc > 2 ? std::atoi(argv[2])
+                                 : static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    std::string dir = argc > 3 ? argv[3] : "/tmp";
+    if (hours <= 0 || hours > kMaxHours || stressThreads < 0) {
+        std::fprintf(stderr, "usage: musicfree_clock_bench [hours 1..%d] [stress_threads] [dir]\n", kMaxHours);
+        return 1;
+    }
+
+    uint64_t trackFrames = static_cast<uint64_t>(hours) * 3600 * kTrackSampleRate;
+    std::string track = dir + "/musicfree_clock_bench_" + std::to_string(::getpid()) + ".wav";
+    if (!writeSparseWav(track, trackFrames)) {
+        std::fprintf(stderr, "failed to write %s\n", track.c_str());
+        return 1;
+    }
+
+    AudioEngineOptions options;
+    options.outputSink = OutputSinkType::NULL_SINK;
+    options.resamplerQuality = ResamplerQuality::LOW;
+    double periodMs = static_cast<double>(options.periodFrames) * 1000.0 / options.sampleRate;
+    double expectedFrames = static_cast<double>(trackFrames) * options.sampleRate / kTrackSampleRate;
+
+    std::atomic<bool> done{false};
+    std::vector<std::thread> stress;
+    for (int i = 0; i < stressThreads; ++i) {
+        stress.emplace_back([&done, i] {
+            volatile uint64_t x = static_cast<uint64_t>(i) + 1;
+            while (!done.load(std::memory_order_relaxed)) {
+                for (int k = 0; k < 1000; ++k) {
+                    x = x * 6364136223846793005ULL + 1442695040888963407ULL;
+                }
+            }
+        });
+    }
+
+    AudioEngine engine(options);
+    bool loaded = engine.load(track);
+    ::unlink(track.c_str());  // 已经映射，删除目录项不影响读取
+    if (!loaded) {
+        done.store(true);
+        for (auto& t : stress) {
+            t.join();
+        }
+        std::fprintf(stderr, "failed to load %s\n", track.c_str());
+        return 1;
+    }
+
+    // 读者线程：统计无锁 getPosition/getState 的调用次数
+    std::atomic<uint64_t> reads{0};
+    std::thread reader([&] {
+        uint64_t n = 0;
+        while (!done.load(std::memory_order_relaxed)) {
+            for (int k = 0; k < 1000; ++k) {
+                if (engine.getState() == PlayState::PLAYING) {
+                    n += static_cast<uint64_t>(engine.getPosition() >= 0);
+                }
+            }
+            reads.store(n, std::memory_order_relaxed);
+        }
+    });
+
+    auto start = Clock::now();
+    engine.play();
+    int duration = engine.getAudioInfo().duration;
+    size_t checks = 0;
+    int64_t maxDrift = 0;
+    uint64_t sinkFrames = 0;
+    for (;;) {
+        std::this_thread::sleep_for(kCheckInterval);
+        if (!engine.pause()) {
+            break;  // 已经播完
+        }
+        sinkFrames = engine.getMetrics().sinkFrames;
+        int position = engine.getPosition();
+        int64_t sinkMs = static_cast<int64_t>(sinkFrames * 1000 / static_cast<uint64_t>(options.sampleRate));
+        int64_t drift = position - sinkMs;
+        if (std::llabs(drift) > std::llabs(maxDrift)) {
+            maxDrift = drift;
+        }
+        ++checks;
+        if (position >= duration || static_cast<double>(sinkFrames) >= expectedFrames) {
+            break;
+        }
+        engine.play();
+    }
+    while (engine.getState() == PlayState::PLAYING) {
+        std::this_thread::sleep_for(kCheckInterval);
+    }
+    double wallSeconds = std::chrono::duration<double>(Clock::now() - start).count();
+    uint64_t totalReads = reads.load(std::memory_order_relaxed);
+
+    done.store(true);
+    reader.join();
+    for (auto& t : stress) {
+        t.join();
+    }
+
+    AudioEngineMetrics metrics = engine.getMetrics();
+    double endError = static_cast<double>(metrics.sinkFrames) - expectedFrames;
+    std::printf("stress threads      %d\n", stressThreads);
+    std::printf("track               %d h @ %u Hz -> %d Hz, played in %.1f s\n", hours, kTrackSampleRate,
+                options.sampleRate, wallSeconds);
+    std::printf("period              %.3f ms (%zu frames)\n", periodMs, options.periodFrames);
+    std::printf("checkpoints         %zu, last at %.1f s of media\n", checks,
+                static_cast<double>(sinkFrames) / options.sampleRate);
+    std::printf("max position drift  %lld ms (position - sink frames)\n", static_cast<long long>(maxDrift));
+    std::printf("sink frames         %llu, expected %.0f (%+.0f frames)\n",
+                static_cast<unsigned long long>(metrics.sinkFrames), expectedFrames, endError);
+    std::printf("underruns           %llu\n", static_cast<unsigned long long>(metrics.underruns));
+    std::printf("lock-free reads     %.1f M/s from a concurrent reader\n",
+                static_cast<double>(totalReads) / wallSeconds / 1e6);
+
+    bool inSync = checks > 0 && maxDrift == 0;
+    bool fullLength = std::fabs(endError) < static_cast<double>(options.periodFrames);
+    bool ok = inSync && fullLength;
+    std::printf("%s: position %s the sink, track length %s one period\n", ok ? "PASS" : "FAIL",
+                inSync ? "in step with" : "drifted from", fullLength ? "within" : "off by more than");
+    return ok ? 0 : 1;
+}
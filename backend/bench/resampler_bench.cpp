@@ -0,0 +1,265 @@
+/**
+ * 重采样基准
+ *
+ *   - 速度：对每个质量档位、每种采样率比例、每个指令集（不超过当前 CPU 支持的最高级别），
+ *     重采样 seconds 秒立体声噪声，结果以每个输出帧的纳秒数和一路实时流占用单核的百分比表示
+ *   - 质量（每个档位）：
+ *       ripple    44.1 → 48 kHz 时通带内（0 ~ 通带边缘）各频率正弦的增益起伏
+ *       SINAD     44.1 → 48 kHz 时 997 Hz 正弦拟合之后的残差
+ *       rejection 96 → 44.1 kHz 时阻带（高于 44.1 kHz 奈奎斯特频率加过渡带）正弦泄漏到输出的最大电平
+ *   - SIMD 与标量输出的最大差异；跳转之后的输出应与从头重采样的结果完全一致
+ *
+ * 用法: musicfree_resampler_bench [seconds]
+ */
+
+#include "../src/core/resampler.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <random>
+#include <vector>
+
+using namespace musicfree;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr int kChannels = 2;
+constexpr double kPi = 3.14159265358979323846;
+
+struct Ratio {
+    int inputRate;
+    int outputRate;
+};
+
+const Ratio kRatios[] = {
+    {44100, 48000}, {48000, 44100}, {96000, 44100}, {88200, 44100}, {22050, 44100},
+};
+
+const ResamplerQuality kQualities[] = {
+    ResamplerQuality::LOW, ResamplerQuality::MEDIUM, ResamplerQuality::HIGH, ResamplerQuality::BEST,
+};
+
+/**
+ * 内存中的数据源，用来测试 ResamplingSource
+ */
+class MemorySource : public AudioSource {
+public:
+    MemorySource(const std::vector<float>& samples, int sampleRate)
+        : samples_(samples), sample_rate_(sampleRate) {}
+
+    int sampleRate() const override { return sample_rate_; }
+    int channels() const override { return kChannels; }
+    uint64_t totalFrames() const override { return samples_.size() / kChannels; }
+    size_t read(float* out, size_t frames) override {
+        frames = static_cast<size_t>(std::min<uint64_t>(frames, totalFrames() - position_));
+        std::copy_n(samples_.begin() + static_cast<ptrdiff_t>(position_ * kChannels), frames * kChannels, out);
+        position_ += frames;
+        return frames;
+    }
+    bool seek(uint64_t frame) override {
+        position_ = std::min(frame, totalFrames());
+        return true;
+    }
+
+private:
+    const std::vector<float>& samples_;
+    int sample_rate_;
+    uint64_t position_ = 0;
+};
+
+/**
+ * 把整段输入重采样（包括冲出尾部），返回输出
+ */
+std::vector<float> resample(const std::vector<float>& input, const Ratio& ratio, ResamplerQuality quality,
+                            SimdLevel level) {
+    Resampler resampler(ratio.inputRate, ratio.outputRate, kChannels, quality, level);
+    size_t inputFrames = input.size() / kChannels;
+    const ResamplerFilterBank& bank = resampler.filterBank();
+    size_t outputFrames = static_cast<size_t>(inputFrames * bank.upFactor / bank.downFactor);
+    std::vector<float> output(outputFrames * kChannels);
+    size_t consumed = 0;
+    size_t produced = 0;
+    while (produced < outputFrames) {
+        produced += resampler.pull(output.data() + produced * kChannels, outputFrames - produced);
+        size_t space = resampler.writable();
+        if (consumed < inputFrames) {
+            size_t frames = std::min(space, inputFrames - consumed);
+            resampler.push(input.data() + consumed * kChannels, frames);
+            consumed += frames;
+        } else {
+            resampler.pushSilence(space);
+        }
+    }
+    return output;
+}
+
+std::vector<float> sine(double frequency, int sampleRate, size_t frames, double amplitude) {
+    std::vector<float> samples(frames * kChannels);
+    for (size_t i = 0; i < frames; ++i) {
+        float value = static_cast<float>(amplitude * std::sin(2.0 * kPi * frequency * static_cast<double>(i) /
+                                                              sampleRate));
+        samples[i * kChannels] = value;
+        samples[i * kChannels + 1] = value;
+    }
+    return samples;
+}
+
+struct SineFit {
+    double amplitude;
+    double residualPower;
+};
+
+/**
+ * 对第一个声道的中间部分（避开首尾的滤波器过渡）做已知频率的最小二乘正弦拟合
+ */
+SineFit fitSine(const std::vector<float>& samples, double frequency, int sampleRate) {
+    size_t frames = samples.size() / kChannels;
+    size_t begin = frames / 8;
+    size_t end = frames - frames / 8;
+    double ss = 0, sc = 0, cc = 0, ys = 0, yc = 0;
+    for (size_t i = begin; i < end; ++i) {
+        double phase = 2.0 * kPi * frequency * static_cast<double>(i) / sampleRate;
+        double s = std::sin(phase), c = std::cos(phase), y = samples[i * kChannels];
+        ss += s * s;
+        sc += s * c;
+        cc += c * c;
+        ys += y * s;
+        yc += y * c;
+    }
+    double det = ss * cc - sc * sc;
+    double a = (ys * cc - yc * sc) / det;
+    double b = (yc * ss - ys * sc) / det;
+    double residual = 0;
+    for (size_t i = begin; i < end; ++i) {
+        double phase = 2.0 * kPi * frequency * static_cast<double>(i) / sampleRate;
+        double error = samples[i * kChannels] - (a * std::sin(phase) + b * std::cos(phase));
+        residual += error * error;
+    }
+    return {std::sqrt(a * a + b * b), residual / static_cast<double>(end - begin)};
+}
+
+double rms(const std::vector<float>& samples) {
+    size_t frames = samples.size() / kChannels;
+    double sum = 0;
+    for (size_t i = frames / 8; i < frames - frames / 8; ++i) {
+        sum += static_cast<double>(samples[i * kChannels]) * samples[i * kChannels];
+    }
+    return std::sqrt(sum / static_cast<double>(frames - frames / 4));
+}
+
+double toDb(double value) {
+    return 20.0 * std::log10(std::max(value, 1e-12));
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    double seconds = argc > 1 ? std::max(0.1, std::atof(argv[1])) : 2.0;
+    SimdLevel best = detectSimdLevel();
+    bool pass = true;
+
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<float> dist(-0.5f, 0.5f);
+
+    // ===== 速度 =====
+    std::printf("%-8s %-14s %-8s %6s %12s %10s\n", "quality", "ratio", "simd", "taps", "ns/frame", "core/stream");
+    for (ResamplerQuality quality : kQualities) {
+        for (const Ratio& ratio : kRatios) {
+            std::vector<float> input(static_cast<size_t>(seconds * ratio.inputRate) * kChannels);
+            for (float& sample : input) {
+                sample = dist(rng);
+            }
+            for (int l = 0; l <= static_cast<int>(best); ++l) {
+                SimdLevel level = static_cast<SimdLevel>(l);
+                auto begin = Clock::now();
+                std::vector<float> output = resample(input, ratio, quality, level);
+                double ns = std::chrono::duration<double, std::nano>(Clock::now() - begin).count();
+                double perFrame = ns / static_cast<double>(output.size() / kChannels);
+                char name[32];
+                std::snprintf(name, sizeof(name), "%d->%d", ratio.inputRate, ratio.outputRate);
+                std::printf("%-8s %-14s %-8s %6zu %12.1f %9.2f%%\n", resamplerQualityName(quality), name,
+                            simdLevelName(level), resamplerFilterBank(ratio.inputRate, ratio.outputRate, quality)->taps,
+                            perFrame, perFrame * ratio.outputRate / 1e7);
+            }
+        }
+    }
+
+    // ===== 质量 =====
+    std::printf("\n%-8s %10s %10s %12s %10s\n", "quality", "ripple dB", "SINAD dB", "rejection dB", "simd diff");
+    const Ratio up = {44100, 48000};
+    const Ratio down = {96000, 44100};
+    for (ResamplerQuality quality : kQualities) {
+        auto bank = resamplerFilterBank(up.inputRate, up.outputRate, quality);
+        size_t frames = static_cast<size_t>(up.inputRate / 4);
+
+        // 通带起伏：0 ~ 通带边缘均匀取 24 个频率
+        double minGain = 1e9, maxGain = -1e9;
+        for (int i = 1; i <= 24; ++i) {
+            double frequency = bank->passband * up.inputRate / 2.0 * i / 24.0;
+            std::vector<float> output = resample(sine(frequency, up.inputRate, frames, 0.5), up, quality, best);
+            double gain = toDb(fitSine(output, frequency, up.outputRate).amplitude / 0.5);
+            minGain = std::min(minGain, gain);
+            maxGain = std::max(maxGain, gain);
+        }
+
+        std::vector<float> tone = sine(997.0, up.inputRate, frames, 0.5);
+        std::vector<float> output = resample(tone, up, quality, best);
+        SineFit fit = fitSine(output, 997.0, up.outputRate);
+        double sinad = 10.0 * std::log10(fit.amplitude * fit.amplitude / 2.0 / fit.residualPower);
+
+        // 阻带：从阻带边缘到输入的奈奎斯特频率均匀取 16 个频率，取泄漏最大的
+        double stopEdge = (2.0 - bank->passband) * down.outputRate / 2.0;
+        double worst = -1e9;
+        for (int i = 0; i < 16; ++i) {
+            double frequency = stopEdge + (down.inputRate / 2.0 - stopEdge) * (i + 0.5) / 16.0;
+            std::vector<float> leaked =
+                resample(sine(frequency, down.inputRate, static_cast<size_t>(down.inputRate / 4), 0.5), down, quality,
+                         best);
+            worst = std::max(worst, toDb(rms(leaked) / (0.5 / std::sqrt(2.0))));
+        }
+
+        std::vector<float> scalar = resample(tone, up, quality, SimdLevel::SCALAR);
+        double diff = 0;
+        for (size_t i = 0; i < scalar.size(); ++i) {
+            diff = std::max(diff, static_cast<double>(std::abs(scalar[i] - output[i])));
+        }
+
+        double designed = resamplerFilterBank(down.inputRate, down.outputRate, quality)->stopbandDb;
+        std::printf("%-8s %10.4f %10.1f %12.1f %10.2e   (designed %.0f dB)\n", resamplerQualityName(quality),
+                    maxGain - minGain, sinad, worst, diff, designed);
+        if (worst > -designed + 6.0 || diff > 1e-5 || maxGain - minGain > 0.1) {
+            pass = false;
+        }
+    }
+
+    // ===== 跳转 =====
+    {
+        std::vector<float> input(static_cast<size_t>(up.inputRate) * kChannels);
+        for (float& sample : input) {
+            sample = dist(rng);
+        }
+        std::vector<float> reference = resample(input, up, ResamplerQuality::HIGH, best);
+        ResamplingSource source(std::make_unique<MemorySource>(input, up.inputRate), up.outputRate,
+                                ResamplerQuality::HIGH);
+        bool exact = source.totalFrames() == reference.size() / kChannels;
+        std::vector<float> chunk(1000 * kChannels);
+        for (uint64_t target : {uint64_t(0), uint64_t(1), uint64_t(12345), uint64_t(30001), uint64_t(47500)}) {
+            source.seek(target);
+            size_t frames = source.read(chunk.data(), 1000);
+            size_t expected = static_cast<size_t>(std::min<uint64_t>(1000, source.totalFrames() - target));
+            exact = exact && frames == expected &&
+                    std::equal(chunk.begin(), chunk.begin() + static_cast<ptrdiff_t>(frames * kChannels),
+                               reference.begin() + static_cast<ptrdiff_t>(target * kChannels));
+        }
+        std::printf("\nseek              %s\n", exact ? "matches continuous output" : "MISMATCH");
+        pass = pass && exact;
+    }
+
+    std::printf("%s\n", pass ? "PASS" : "FAIL");
+    return pass ? 0 : 1;
+}
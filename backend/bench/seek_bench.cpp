@@ -0,0 +1,363 @@
+/**
+ * 跳转表基准
+ *
+ * 生成一小时长的可变码率 MP3、FLAC 和 Ogg Vorbis 文件（只有帧头 / 页头有效，帧数据为填充），然后：
+ * 1. 第一次打开：建立跳转表并保存到缓存目录，给出耗时和跳转表大小
+ * 2. 再次打开：从缓存目录加载
+ * 3. 随机跳转 1000 次：测量 CompressedFileSource::seek 的耗时（二分查找 + 预读提示），
+ *    并与生成时记录的帧位置比较：定位到的必须是真实的帧（页）开头，丢弃的采样数正确且不超过
+ *    预滚 + 两倍跳转间隔 + 一帧
+ *
+ * 用法: musicfree_seek_bench [dir] [minutes]
+ */
+
+#include "metadata_cache.h"
+#include "../src/core/compressed_file_source.h"
+#include <algorithm>
+#include <chrono>
+#include <dirent.h>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+using namespace musicfree;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr int kSampleRate = 44100;
+constexpr int kSeeks = 1000;
+constexpr double kTargetSeekMs = 5.0;
+
+/**
+ * 生成的文件和每一帧（页）的真实位置
+ */
+struct GeneratedFile {
+    std::vector<uint8_t> bytes;
+    std::vector<SeekPoint> frames;  // 从 offset 开始解码时的第一个采样位置
+    uint64_t totalSamples = 0;
+    uint64_t maxFrameSamples = 0;
+};
+
+void put8(std::vector<uint8_t>& out, uint32_t v) {
+    out.push_back(static_cast<uint8_t>(v));
+}
+
+void put32be(std::vector<uint8_t>& out, uint32_t v) {
+    for (int i = 3; i >= 0; --i) {
+        put8(out, v >> (8 * i));
+    }
+}
+
+void put32le(std::vector<uint8_t>& out, uint32_t v) {
+    for (int i = 0; i < 4; ++i) {
+        put8(out, v >> (8 * i));
+    }
+}
+
+void putText(std::vector<uint8_t>& out, const char* text) {
+    for (; *text; ++text) {
+        put8(out, static_cast<uint8_t>(*text));
+    }
+}
+
+/**
+ * 填充帧数据：只用 0x00–0x7F，不会出现同步字
+ */
+void putPayload(std::vector<uint8_t>& out, size_t length, std::mt19937& rng) {
+    for (size_t i = 0; i < length; ++i) {
+        put8(out, rng() & 0x7F);
+    }
+}
+
+GeneratedFile makeMp3(uint64_t seconds, std::mt19937& rng) {
+    GeneratedFile file;
+    // 小 ID3v2 标签
+    putText(file.bytes, "ID3");
+    put8(file.bytes, 3);
+    put8(file.bytes, 0);
+    put8(file.bytes, 0);
+    put32be(file.bytes, 0);
+    // Info 帧（128 kbps，不含音频）
+    size_t start = file.bytes.size();
+    put32be(file.bytes, 0xFFFB9000);
+    file.bytes.resize(start + 36, 0);
+    putText(file.bytes, "Info");
+    file.bytes.resize(start + 417, 0);
+
+    // MPEG-1 Layer III 44100 Hz 立体声，码率在 64–192 kbps 之间随机（可变码率）
+    static const int kBitrates[] = {64, 80, 96, 112, 128, 160, 192};
+    uint64_t frames = seconds * kSampleRate / 1152;
+    for (uint64_t f = 0; f < frames; ++f) {
+        int index = static_cast<int>(rng() % 7);
+        size_t length = static_cast<size_t>(144 * kBitrates[index] * 1000 / kSampleRate);
+        file.frames.push_back({f * 1152, file.bytes.size()});
+        put32be(file.bytes, 0xFFFB0000 | (static_cast<uint32_t>(index + 5) << 12));
+        putPayload(file.bytes, length - 4, rng);
+    }
+    file.totalSamples = frames * 1152;
+    file.maxFrameSamples = 1152;
+    return file;
+}
+
+uint8_t crc8(const uint8_t* p, size_t length) {
+    uint8_t crc = 0;
+    for (size_t i = 0; i < length; ++i) {
+        crc ^= p[i];
+        for (int bit = 0; bit < 8; ++bit) {
+            crc = static_cast<uint8_t>((crc & 0x80) ? (crc << 1) ^ 0x07 : crc << 1);
+        }
+    }
+    return crc;
+}
+
+GeneratedFile makeFlac(uint64_t seconds, std::mt19937& rng) {
+    constexpr uint32_t kBlockSize = 4096;
+    GeneratedFile file;
+    uint64_t frames = seconds * kSampleRate / kBlockSize;
+    file.totalSamples = frames * kBlockSize;
+    file.maxFrameSamples = kBlockSize;
+
+    putText(file.bytes, "fLaC");
+    put8(file.bytes, 0x80);  // 最后一个元数据块：STREAMINFO
+    put8(file.bytes, 0);
+    put8(file.bytes, 0);
+    put8(file.bytes, 34);
+    put8(file.bytes, kBlockSize >> 8);
+    put8(file.bytes, kBlockSize & 0xFF);
+    put8(file.bytes, kBlockSize >> 8);
+    put8(file.bytes, kBlockSize & 0xFF);
+    file.bytes.resize(file.bytes.size() + 6, 0);
+    put8(file.bytes, kSampleRate >> 12);
+    put8(file.bytes, (kSampleRate >> 4) & 0xFF);
+    put8(file.bytes, ((kSampleRate & 0x0F) << 4) | (1 << 1) | 0);
+    put8(file.bytes, (15 << 4) | static_cast<uint32_t>(file.totalSamples >> 32));
+    put32be(file.bytes, static_cast<uint32_t>(file.totalSamples));
+    file.bytes.resize(file.bytes.size() + 16, 0);
+
+    for (uint64_t f = 0; f < frames; ++f) {
+        size_t start = file.bytes.size();
+        file.frames.push_back({f * kBlockSize, start});
+        put8(file.bytes, 0xFF);
+        put8(file.bytes, 0xF8);  // 固定块大小
+        put8(file.bytes, 0xC9);  // 4096 个采样，44100 Hz
+        put8(file.bytes, 0x18);  // 左右声道独立，16 位
+        // UTF-8 编码的帧号
+        if (f < 0x80) {
+            put8(file.bytes, static_cast<uint32_t>(f));
+        } else if (f < 0x800) {
+            put8(file.bytes, 0xC0 | static_cast<uint32_t>(f >> 6));
+            put8(file.bytes, 0x80 | static_cast<uint32_t>(f & 0x3F));
+        } else {
+            put8(file.bytes, 0xE0 | static_cast<uint32_t>(f >> 12));
+            put8(file.bytes, 0x80 | static_cast<uint32_t>((f >> 6) & 0x3F));
+            put8(file.bytes, 0x80 | static_cast<uint32_t>(f & 0x3F));
+        }
+        put8(file.bytes, crc8(file.bytes.data() + start, file.bytes.size() - start));
+        putPayload(file.bytes, 1000 + rng() % 4000, rng);
+    }
+    return file;
+}
+
+uint32_t oggCrc(const uint8_t* p, size_t length) {
+    static std::vector<uint32_t> table = [] {
+        std::vector<uint32_t> t(256);
+        for (uint32_t i = 0; i < 256; ++i) {
+            uint32_t r = i << 24;
+            for (int bit = 0; bit < 8; ++bit) {
+                r = (r & 0x80000000u) ? (r << 1) ^ 0x04C11DB7u : r << 1;
+            }
+            t[i] = r;
+        }
+        return t;
+    }();
+    uint32_t crc = 0;
+    for (size_t i = 0; i < length; ++i) {
+        crc = (crc << 8) ^ table[((crc >> 24) ^ p[i]) & 0xFF];
+    }
+    return crc;
+}
+
+void putOggPage(std::vector<uint8_t>& out, uint8_t type, uint64_t granule, uint32_t sequence,
+                const std::vector<uint8_t>& body) {
+    size_t start = out.size();
+    putText(out, "OggS");
+    put8(out, 0);
+    put8(out, type);
+    put32le(out, static_cast<uint32_t>(granule));
+    put32le(out, static_cast<uint32_t>(granule >> 32));
+    put32le(out, 0x4D465245);  // serial
+    put32le(out, sequence);
+    put32le(out, 0);  // CRC，最后填入
+    size_t segments = body.size() / 255 + 1;
+    put8(out, static_cast<uint32_t>(segments));
+    for (size_t i = 0; i + 1 < segments; ++i) {
+        put8(out, 255);
+    }
+    put8(out, static_cast<uint32_t>(body.size() % 255));
+    out.insert(out.end(), body.begin(), body.end());
+    uint32_t crc = oggCrc(out.data() + start, out.size() - start);
+    for (int i = 0; i < 4; ++i) {
+        out[start + 22 + i] = static_cast<uint8_t>(crc >> (8 * i));
+    }
+}
+
+GeneratedFile makeOgg(uint64_t seconds, std::mt19937& rng) {
+    constexpr uint64_t kPageSamples = 4096;
+    GeneratedFile file;
+    uint32_t sequence = 0;
+
+    std::vector<uint8_t> id;
+    putText(id, "\x01vorbis");
+    put32le(id, 0);
+    put8(id, 2);
+    put32le(id, kSampleRate);
+    put32le(id, 0);
+    put32le(id, 160000);
+    put32le(id, 0);
+    put8(id, 0xB8);
+    put8(id, 1);
+    putOggPage(file.bytes, 0x02, 0, sequence++, id);
+
+    std::vector<uint8_t> headers;
+    putText(headers, "\x03vorbis");
+    headers.resize(2000, 0);  // 注释和设置包
+    putOggPage(file.bytes, 0x00, 0, sequence++, headers);
+
+    uint64_t pages = seconds * kSampleRate / kPageSamples;
+    std::vector<uint8_t> body;
+    for (uint64_t p = 0; p < pages; ++p) {
+        file.frames.push_back({p * kPageSamples, file.bytes.size()});
+        body.clear();
+        putPayload(body, 1000 + rng() % 2000, rng);
+        putOggPage(file.bytes, p + 1 == pages ? 0x04 : 0x00, (p + 1) * kPageSamples, sequence++, body);
+    }
+    file.totalSamples = pages * kPageSamples;
+    file.maxFrameSamples = kPageSamples;
+    return file;
+}
+
+double median(std::vector<double> values) {
+    std::sort(values.begin(), values.end());
+    return values[values.size() / 2];
+}
+
+bool writeFile(const std::string& path, const std::vector<uint8_t>& bytes) {
+    FILE* f = std::fopen(path.c_str(), "wb");
+    if (!f) {
+        return false;
+    }
+    bool ok = std::fwrite(bytes.data(), 1, bytes.size(), f) == bytes.size();
+    return std::fclose(f) == 0 && ok;
+}
+
+double msSince(Clock::time_point begin) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - begin).count();
+}
+
+bool run(const char* name, const std::string& path, const GeneratedFile& generated, std::mt19937& rng) {
+    MetadataCache& cache = MetadataCache::getInstance();
+
+    SeekIndex index;
+    auto begin = Clock::now();
+    bool ok = cache.getSeekIndex(path, index);
+    double buildMs = msSince(begin);
+    std::string serialized;
+    serializeSeekIndex(index, serialized);
+
+    begin = Clock::now();
+    SeekIndex loaded;
+    ok = cache.getSeekIndex(path, loaded) && ok;
+    double loadMs = msSince(begin);
+    MetadataCacheStats stats = cache.getStats();
+
+    ok = ok && index.totalSamples == generated.totalSamples && loaded.points.size() == index.points.size();
+    std::printf("%-5s %6.1f MB  %6zu points  build %7.1f ms  index %6.1f KB  load %5.2f ms  total %s\n", name,
+                generated.bytes.size() / 1048576.0, index.points.size(), buildMs, serialized.size() / 1024.0, loadMs,
+                index.totalSamples == generated.totalSamples ? "exact" : "WRONG");
+
+    auto file = std::make_unique<MappedFile>();
+    if (!ok || !file->open(path)) {
+        return false;
+    }
+    CompressedFileSource source(std::move(file), std::move(loaded), kSampleRate, 2);
+
+    std::uniform_int_distribution<uint64_t> targets(0, generated.totalSamples - 1);
+    uint64_t slack = source.seekIndex().prerollSamples +
+                     static_cast<uint64_t>(kSampleRate) * kSeekPointIntervalMs / 1000 * 2 + generated.maxFrameSamples;
+    std::vector<double> times;
+    size_t errors = 0;
+    for (int i = 0; i < kSeeks; ++i) {
+        uint64_t target = targets(rng);
+        auto seekBegin = Clock::now();
+        source.seek(target);
+        times.push_back(msSince(seekBegin));
+
+        // 定位到的必须是真实的帧开头，丢弃的采样数与该帧的位置一致
+        auto it = std::lower_bound(generated.frames.begin(), generated.frames.end(), source.streamOffset(),
+                                   [](const SeekPoint& frame, uint64_t offset) { return frame.offset < offset; });
+        bool valid = it != generated.frames.end() && it->offset == source.streamOffset() &&
+                     it->sample + source.pendingDiscard() == target && source.pendingDiscard() <= slack &&
+                     (it->sample == 0 || source.pendingDiscard() >= source.seekIndex().prerollSamples);
+        errors += valid ? 0 : 1;
+    }
+    double maxMs = *std::max_element(times.begin(), times.end());
+    std::printf("      seek median %.4f ms  max %.4f ms  errors %zu  (built %llu, loaded %llu)\n", median(times),
+                maxMs, errors, static_cast<unsigned long long>(stats.seekIndexesBuilt),
+                static_cast<unsigned long long>(stats.seekIndexesLoaded));
+    return errors == 0 && maxMs < kTargetSeekMs;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    std::string dir = argc > 1 ? argv[1] : "/tmp";
+    long minutes = argc > 2 ? std::atol(argv[2]) : 60;
+    if (minutes <= 0) {
+        std::fprintf(stderr, "usage: musicfree_seek_bench [dir] [minutes]\n");
+        return 1;
+    }
+    uint64_t seconds = static_cast<uint64_t>(minutes) * 60;
+    std::string cachePath = dir + "/musicfree_seek_bench.cache";
+    MetadataCache& cache = MetadataCache::getInstance();
+    cache.initialize(cachePath);
+
+    struct Case {
+        const char* name;
+        GeneratedFile (*make)(uint64_t, std::mt19937&);
+        const char* extension;
+    };
+    const Case cases[] = {{"mp3", makeMp3, "mp3"}, {"flac", makeFlac, "flac"}, {"ogg", makeOgg, "ogg"}};
+
+    std::mt19937 rng(42);
+    bool ok = true;
+    for (const Case& c : cases) {
+        GeneratedFile generated = c.make(seconds, rng);
+        std::string path = dir + "/musicfree_seek_bench." + c.extension;
+        if (!writeFile(path, generated.bytes)) {
+            std::printf("cannot write %s\n", path.c_str());
+            return 1;
+        }
+        ok = run(c.name, path, generated, rng) && ok;
+        std::remove(path.c_str());
+    }
+
+    cache.shutdown();
+    std::remove(cachePath.c_str());
+    std::string indexDir = cachePath + ".seek";
+    if (DIR* d = opendir(indexDir.c_str())) {
+        while (dirent* entry = readdir(d)) {
+            if (entry->d_name[0] != '.') {
+                std::remove((indexDir + "/" + entry->d_name).c_str());
+            }
+        }
+        closedir(d);
+        rmdir(indexDir.c_str());
+    }
+    std::printf("%s (target: seek < %.0f ms on a %ld minute file)\n", ok ? "PASS" : "FAIL", kTargetSeekMs, minutes);
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,457 @@
+/**
+ * 标签读取与元数据缓存基准
+ *
+ * 生成 N 个小文件，轮流为 MP3（ID3v2.3 + 封面 + Xing 头）、FLAC（STREAMINFO + VORBIS_COMMENT）、
+ * M4A（mvhd / stsd / ilst）和 WAV，然后：
+ * 1. 冷启动：空缓存，逐个读取标签并与写入的值比较，保存缓存文件
+ * 2. 重新加载缓存文件，再次查询全部文件，应当全部命中（每个文件一次 stat）
+ * 3. 改写 1% 的文件，再次查询，只有这些文件重新读取标签
+ *
+ * 用法: musicfree_tag_bench [dir] [files]
+ */
+
+#include "metadata_cache.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+
+using namespace musicfree;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr size_t kFilesPerDir = 1000;
+constexpr size_t kCoverBytes = 512;
+
+void put8(std::vector<uint8_t>& out, uint32_t v) {
+    out.push_back(static_cast<uint8_t>(v));
+}
+
+void put16be(std::vector<uint8_t>& out, uint32_t v) {
+    put8(out, v >> 8);
+    put8(out, v);
+}
+
+void put32be(std::vector<uint8_t>& out, uint32_t v) {
+    put16be(out, v >> 16);
+    put16be(out, v & 0xFFFF);
+}
+
+void put32le(std::vector<uint8_t>& out, uint32_t v) {
+    for (int i = 0; i < 4; ++i) {
+        put8(out, v >> (8 * i));
+    }
+}
+
+void putText(std::vector<uint8_t>& out, const std::string& text) {
+    for (char c : text) {
+        out.push_back(static_cast<uint8_t>(c));
+    }
+}
+
+void patch32be(std::vector<uint8_t>& out, size_t offset, uint32_t v) {
+    out[offset] = static_cast<uint8_t>(v >> 24);
+    out[offset + 1] = static_cast<uint8_t>(v >> 16);
+    out[offset + 2] = static_cast<uint8_t>(v >> 8);
+    out[offset + 3] = static_cast<uint8_t>(v);
+}
+
+/**
+ * 第 i 个文件应当读出的信息
+ */
+AudioInfo expected(size_t i, int revision) {
+    static const char* kFormats[] = {"mp3", "flac", "m4a", "wav"};
+    AudioInfo info;
+    info.format = kFormats[i % 4];
+    if (info.format != "wav") {
+        info.title = "Title " + std::to_string(i) + (revision > 0 ? " (edit)" : "");
+        info.artist = "Artist " + std::to_string(i % 97);
+        info.album = "Album " + std::to_string(i % 13);
+    }
+    info.sampleRate = 44100;
+    info.channels = 2;
+    return info;
+}
+
+// ===== MP3 =====
+
+void id3Frame(std::vector<uint8_t>& out, const char* id, const std::vector<uint8_t>& body) {
+    putText(out, std::string(id, 4));
+    put32be(out, static_cast<uint32_t>(body.size()));
+    put16be(out, 0);
+    out.insert(out.end(), body.begin(), body.end());
+}
+
+std::vector<uint8_t> latin1Frame(const std::string& text) {
+    std::vector<uint8_t> body;
+    put8(body, 0);
+    putText(body, text);
+    return body;
+}
+
+std::vector<uint8_t> utf16Frame(const std::string& text) {
+    std::vector<uint8_t> body;
+    put8(body, 1);
+    put8(body, 0xFF);
+    put8(body, 0xFE);
+    for (char c : text) {
+        put8(body, static_cast<uint8_t>(c));
+        put8(body, 0);
+    }
+    return body;
+}
+
+std::vector<uint8_t> makeMp3(const AudioInfo& info, uint32_t frames) {
+    std::vector<uint8_t> tag;
+    id3Frame(tag, "TIT2", latin1Frame(info.title));
+    id3Frame(tag, "TPE1", utf16Frame(info.artist));
+    // 封面：读取时应当直接跳过
+    std::vector<uint8_t> cover(kCoverBytes, 0xAB);
+    id3Frame(tag, "APIC", cover);
+    id3Frame(tag, "TALB", latin1Frame(info.album));
+    tag.resize(tag.size() + 64, 0);  // 填充区
+
+    std::vector<uint8_t> out;
+    putText(out, "ID3");
+    put8(out, 3);
+    put8(out, 0);
+    put8(out, 0);
+    uint32_t size = static_cast<uint32_t>(tag.size());
+    put8(out, (size >> 21) & 0x7F);
+    put8(out, (size >> 14) & 0x7F);
+    put8(out, (size >> 7) & 0x7F);
+    put8(out, size & 0x7F);
+    out.insert(out.end(), tag.begin(), tag.end());
+
+    // MPEG-1 Layer III 128 kbps 44100 Hz 立体声，帧长 417 字节；第一帧带 Xing 头
+    constexpr size_t kFrameBytes = 417;
+    for (int f = 0; f < 2; ++f) {
+        size_t start = out.size();
+        put32be(out, 0xFFFB9000);
+        if (f == 0) {
+            out.resize(start + 4 + 32, 0);
+            putText(out, "Xing");
+            put32be(out, 0x01);
+            put32be(out, frames);
+        }
+        out.resize(start + kFrameBytes, 0);
+    }
+    return out;
+}
+
+// ===== FLAC =====
+
+std::vector<uint8_t> makeFlac(const AudioInfo& info, uint64_t samples) {
+    std::vector<uint8_t> out;
+    putText(out, "fLaC");
+    put8(out, 0x00);
+    put8(out, 0);
+    put16be(out, 34);
+    put16be(out, 4096);
+    put16be(out, 4096);
+    out.resize(out.size() + 6, 0);
+    // 20 位采样率、3 位声道数 - 1、5 位位深 - 1、36 位总采样数
+    uint32_t rate = 44100;
+    put8(out, rate >> 12);
+    put8(out, rate >> 4);
+    put8(out, ((rate & 0x0F) << 4) | ((2 - 1) << 1) | ((16 - 1) >> 4));
+    put8(out, (((16 - 1) & 0x0F) << 4) | static_cast<uint32_t>(samples >> 32));
+    put32be(out, static_cast<uint32_t>(samples));
+    out.resize(out.size() + 16, 0);
+
+    std::vector<std::string> comments = {"title=" + info.title, "ARTIST=" + info.artist, "Album=" + info.album,
+                                         "GENRE=Test"};
+    std::vector<uint8_t> body;
+    std::string vendor = "musicfree bench";
+    put32le(body, static_cast<uint32_t>(vendor.size()));
+    putText(body, vendor);
+    put32le(body, static_cast<uint32_t>(comments.size()));
+    for (const auto& comment : comments) {
+        put32le(body, static_cast<uint32_t>(comment.size()));
+        putText(body, comment);
+    }
+    put8(out, 0x80 | 4);
+    put8(out, static_cast<uint32_t>(body.size()) >> 16);
+    put16be(out, static_cast<uint32_t>(body.size()) & 0xFFFF);
+    out.insert(out.end(), body.begin(), body.end());
+    out.resize(out.size() + 256, 0);  // 音频帧
+    return out;
+}
+
+// ===== M4A =====
+
+size_t beginAtom(std::vector<uint8_t>& out, const char* type) {
+    size_t start = out.size();
+    put32be(out, 0);
+    putText(out, std::string(type, 4));
+    return start;
+}
+
+void endAtom(std::vector<uint8_t>& out, size_t start) {
+    patch32be(out, start, static_cast<uint32_t>(out.size() - start));
+}
+
+void ilstText(std::vector<uint8_t>& out, const char* name, const std::string& text) {
+    size_t item = out.size();
+    put32be(out, 0);
+    put8(out, 0xA9);
+    putText(out, name);
+    size_t data = beginAtom(out, "data");
+    put32be(out, 1);  // UTF-8
+    put32be(out, 0);
+    putText(out, text);
+    endAtom(out, data);
+    endAtom(out, item);
+}
+
+std::vector<uint8_t> makeM4a(const AudioInfo& info, uint32_t durationMs) {
+    std::vector<uint8_t> out;
+    size_t ftyp = beginAtom(out, "ftyp");
+    putText(out, "M4A ");
+    put32be(out, 0);
+    putText(out, "isomM4A ");
+    endAtom(out, ftyp);
+
+    size_t moov = beginAtom(out, "moov");
+    size_t mvhd = beginAtom(out, "mvhd");
+    put32be(out, 0);  // 版本 0
+    put32be(out, 0);
+    put32be(out, 0);
+    put32be(out, 1000);  // timescale
+    put32be(out, durationMs);
+    out.resize(out.size() + 80, 0);
+    endAtom(out, mvhd);
+
+    size_t trak = beginAtom(out, "trak");
+    size_t mdia = beginAtom(out, "mdia");
+    size_t minf = beginAtom(out, "minf");
+    size_t stbl = beginAtom(out, "stbl");
+    size_t stsd = beginAtom(out, "stsd");
+    put32be(out, 0);
+    put32be(out, 1);
+    size_t entry = beginAtom(out, "mp4a");
+    out.resize(out.size() + 6, 0);
+    put16be(out, 1);
+    out.resize(out.size() + 8, 0);
+    put16be(out, 2);   // 声道数
+    put16be(out, 16);  // 位深
+    put32be(out, 0);
+    put32be(out, 44100u << 16);
+    endAtom(out, entry);
+    endAtom(out, stsd);
+    size_t stsz = beginAtom(out, "stsz");
+    out.resize(out.size() + 512, 0);  // 采样表：读取时应当跳过
+    endAtom(out, stsz);
+    endAtom(out, stbl);
+    endAtom(out, minf);
+    endAtom(out, mdia);
+    endAtom(out, trak);
+
+    size_t udta = beginAtom(out, "udta");
+    size_t meta = beginAtom(out, "meta");
+    put32be(out, 0);
+    size_t hdlr = beginAtom(out, "hdlr");
+    put32be(out, 0);
+    put32be(out, 0);
+    putText(out, "mdirappl");
+    out.resize(out.size() + 9, 0);
+    endAtom(out, hdlr);
+    size_t ilst = beginAtom(out, "ilst");
+    ilstText(out, "nam", info.title);
+    ilstText(out, "ART", info.artist);
+    ilstText(out, "alb", info.album);
+    endAtom(out, ilst);
+    endAtom(out, meta);
+    endAtom(out, udta);
+    endAtom(out, moov);
+
+    size_t mdat = beginAtom(out, "mdat");
+    out.resize(out.size() + 256, 0);
+    endAtom(out, mdat);
+    return out;
+}
+
+// ===== WAV =====
+
+std::vector<uint8_t> makeWav(uint32_t frames) {
+    std::vector<uint8_t> out;
+    uint32_t dataBytes = frames * 4;
+    putText(out, "RIFF");
+    put32le(out, 36 + dataBytes);
+    putText(out, "WAVEfmt ");
+    put32le(out, 16);
+    put32le(out, 1 | (2 << 16));
+    put32le(out, 44100);
+    put32le(out, 44100 * 4);
+    put32le(out, 4 | (16 << 16));
+    putText(out, "data");
+    put32le(out, dataBytes);
+    out.resize(out.size() + dataBytes, 0);
+    return out;
+}
+
+/**
+ * 生成第 i 个文件
+ * @return 写入的内容应当读出的信息
+ */
+AudioInfo writeTrack(const std::string& path, size_t i, int revision) {
+    AudioInfo info = expected(i, revision);
+    std::vector<uint8_t> bytes;
+    if (info.format == "mp3") {
+        uint32_t frames = 2000 + static_cast<uint32_t>(i % 10000);
+        bytes = makeMp3(info, frames);
+        info.duration = static_cast<int>(static_cast<uint64_t>(frames) * 1152 * 1000 / 44100);
+    } else if (info.format == "flac") {
+        uint64_t samples = 44100ull * 60 + i * 7;
+        bytes = makeFlac(info, samples);
+        info.duration = static_cast<int>(samples * 1000 / 44100);
+        info.bitsPerSample = 16;
+    } else if (info.format == "m4a") {
+        info.duration = 90000 + static_cast<int>(i % 100000);
+        bytes = makeM4a(info, static_cast<uint32_t>(info.duration));
+        info.bitsPerSample = 16;
+    } else {
+        uint32_t frames = 441 * static_cast<uint32_t>(1 + i % 4 + revision);
+        bytes = makeWav(frames);
+        info.duration = static_cast<int>(static_cast<uint64_t>(frames) * 1000 / 44100);
+        info.bitsPerSample = 16;
+    }
+
+    FILE* f = std::fopen(path.c_str(), "wb");
+    if (!f || std::fwrite(bytes.data(), 1, bytes.size(), f) != bytes.size()) {
+        std::fprintf(stderr, "cannot write %s\n", path.c_str());
+        std::exit(1);
+    }
+    std::fclose(f);
+    return info;
+}
+
+bool matches(const AudioInfo& a, const AudioInfo& b) {
+    // WAV 没有标签时的标题由播放时的文件名兜底，这里只比较标签本身
+    return a.title == b.title && a.artist == b.artist && a.album == b.album && a.format == b.format &&
+           a.duration == b.duration && a.sampleRate == b.sampleRate && a.channels == b.channels;
+}
+
+std::string trackPath(const std::string& dir, size_t i) {
+    static const char* kExtensions[] = {"mp3", "flac", "m4a", "wav"};
+    return dir + "/" + std::to_string(i / kFilesPerDir) + "/track" + std::to_string(i) + "." +
+           kExtensions[i % 4];
+}
+
+double secondsSince(Clock::time_point begin) {
+    return std::chrono::duration<double>(Clock::now() - begin).count();
+}
+
+/**
+ * 查询全部文件并与期望值比较
+ * @return 不匹配的文件数
+ */
+size_t scan(const std::string& dir, const std::vector<AudioInfo>& infos, double& seconds) {
+    MetadataCache& cache = MetadataCache::getInstance();
+    size_t mismatches = 0;
+    auto begin = Clock::now();
+    for (size_t i = 0; i < infos.size(); ++i) {
+        AudioInfo info;
+        if (!cache.lookup(trackPath(dir, i), info) || !matches(info, infos[i])) {
+            if (mismatches++ < 5) {
+                std::printf("  mismatch %s: \"%s\" / \"%s\" / \"%s\" %s %d ms %d Hz %d ch\n",
+                            trackPath(dir, i).c_str(), info.title.c_str(), info.artist.c_str(),
+                            info.album.c_str(), info.format.c_str(), info.duration, info.sampleRate,
+                            info.channels);
+            }
+        }
+    }
+    seconds = secondsSince(begin);
+    return mismatches;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    std::string root = argc > 1 ? argv[1] : "/tmp";
+    long count = argc > 2 ? std::atol(argv[2]) : 100000;
+    if (count <= 0) {
+        std::fprintf(stderr, "usage: musicfree_tag_bench [dir] [files]\n");
+        return 1;
+    }
+    size_t files = static_cast<size_t>(count);
+    std::string dir = root + "/musicfree_tag_bench";
+    std::string cachePath = root + "/musicfree_tag_bench.cache";
+
+    mkdir(dir.c_str(), 0755);
+    for (size_t d = 0; d * kFilesPerDir < files; ++d) {
+        mkdir((dir + "/" + std::to_string(d)).c_str(), 0755);
+    }
+    std::vector<AudioInfo> infos(files);
+    auto begin = Clock::now();
+    for (size_t i = 0; i < files; ++i) {
+        infos[i] = writeTrack(trackPath(dir, i), i, 0);
+    }
+    std::printf("generated %zu files in %.2f s (mp3 / flac / m4a / wav)\n", files, secondsSince(begin));
+
+    MetadataCache& cache = MetadataCache::getInstance();
+    std::remove(cachePath.c_str());
+    cache.initialize(cachePath);
+
+    // 1. 冷启动（文件刚写入，位于页缓存中，测的是解析开销而不是磁盘）
+    double seconds = 0;
+    size_t mismatches = scan(dir, infos, seconds);
+    MetadataCacheStats stats = cache.getStats();
+    std::printf("cold:    %8.0f files/s  %6.2f us/file  misses %llu  mismatches %zu\n", files / seconds,
+                seconds * 1e6 / files, static_cast<unsigned long long>(stats.misses), mismatches);
+    bool ok = mismatches == 0 && stats.misses == files;
+
+    begin = Clock::now();
+    ok = cache.save() && ok;
+    double saveSeconds = secondsSince(begin);
+    struct stat st;
+    stat(cachePath.c_str(), &st);
+    std::printf("save:    %8.1f ms  %.1f MB (%.0f bytes/file)\n", saveSeconds * 1e3, st.st_size / 1048576.0,
+                static_cast<double>(st.st_size) / files);
+
+    // 2. 重新加载缓存，全部命中
+    begin = Clock::now();
+    ok = cache.initialize(cachePath) && ok;
+    double loadSeconds = secondsSince(begin);
+    stats = cache.getStats();
+    std::printf("load:    %8.1f ms  %zu entries\n", loadSeconds * 1e3, stats.entries);
+    ok = ok && stats.entries == files;
+
+    mismatches = scan(dir, infos, seconds);
+    stats = cache.getStats();
+    std::printf("warm:    %8.0f files/s  %6.2f us/file  hits %llu  misses %llu  mismatches %zu\n", files / seconds,
+                seconds * 1e6 / files, static_cast<unsigned long long>(stats.hits),
+                static_cast<unsigned long long>(stats.misses), mismatches);
+    ok = ok && mismatches == 0 && stats.hits == files && stats.misses == 0;
+
+    // 3. 改写 1% 的文件（长度变化），只有这些文件重新读取
+    size_t edited = 0;
+    for (size_t i = 0; i < files; i += 100, ++edited) {
+        infos[i] = writeTrack(trackPath(dir, i), i, 1);
+    }
+    uint64_t hitsBefore = stats.hits;
+    mismatches = scan(dir, infos, seconds);
+    stats = cache.getStats();
+    std::printf("edited:  %8.0f files/s  %zu edited  misses %llu  mismatches %zu\n", files / seconds, edited,
+                static_cast<unsigned long long>(stats.misses), mismatches);
+    ok = ok && mismatches == 0 && stats.misses == edited && stats.hits - hitsBefore == files - edited;
+
+    for (size_t i = 0; i < files; ++i) {
+        std::remove(trackPath(dir, i).c_str());
+    }
+    for (size_t d = 0; d * kFilesPerDir < files; ++d) {
+        rmdir((dir + "/" + std::to_string(d)).c_str());
+    }
+    rmdir(dir.c_str());
+    cache.shutdown();
+    std::remove(cachePath.c_str());
+
+    std::printf("%s\n", ok ? "PASS" : "FAIL");
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,142 @@
+/**
+ * 轨道请求体解析基准
+ *
+ * 解析一个批量添加的请求体（Track 数组），比较：
+ *   - dom：parseJson 构造 JsonValue，再逐个 jsonToTrack（之前的路径）
+ *   - scalar / sse4.2 / avx2：TrackParser 在请求缓冲区上原地解析，得到 TrackView
+ *
+ * 每轮先把原始请求体复制回缓冲区（原地解码会修改它），复制不计入耗时。
+ * 各路径解析出的轨道会逐字段比较，不一致时报错退出。
+ *
+ * 用法: musicfree_parse_bench [tracks] [rounds]
+ */
+
+#include "../src/network/json.h"
+#include "../src/network/json_writer.h"
+#include "../src/network/track_parser.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+using namespace musicfree;
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+bool sameTrack(const Track& a, const Track& b) {
+    return a.id == b.id && a.title == b.title && a.artist == b.artist && a.album == b.album &&
+           a.url == b.url && a.duration == b.duration && a.source == b.source && a.coverUrl == b.coverUrl;
+}
+
+template <typename Fn>
+double bestOf(int rounds, const std::string& original, std::string& body, Fn&& parse) {
+    double best = 1e9;
+    for (int i = 0; i < rounds; ++i) {
+        body.assign(original);
+        auto begin = Clock::now();
+        parse(body);
+        best = std::min(best, std::chrono::duration<double, std::milli>(Clock::now() - begin).count());
+    }
+    return best;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    int trackCount = argc > 1 ? std::atoi(argv[1]) : 50000;
+    int rounds = argc > 2 ? std::atoi(argv[2]) : 20;
+    if (trackCount <= 0 || rounds <= 0) {
+        std::fprintf(stderr, "usage: musicfree_parse_bench [tracks] [rounds]\n");
+        return 1;
+    }
+
+    // 请求体：前端批量添加时发送的 Track 数组，混入转义、非 ASCII 文本和未知字段
+    std::vector<Track> source;
+    source.reserve(trackCount);
+    for (int i = 0; i < trackCount; ++i) {
+        Track track;
+        track.id = "netease-" + std::to_string(3000000 + i);
+        track.title = i % 10 == 0 ? "Track \"" + std::to_string(i) + "\" (Live)\n" : "晴天 Track " + std::to_string(i);
+        track.artist = "Some Artist With A Long Name";
+        track.album = "An Album Title That Exceeds SSO";
+        track.url = "https://music.example.com/song/media/outer/url?id=" + std::to_string(3000000 + i) + ".mp3";
+        track.duration = 180000 + i;
+        track.source = "netease";
+        track.coverUrl = "https://p1.music.example.net/cover/" + std::to_string(i) + ".jpg";
+        source.push_back(std::move(track));
+    }
+
+    std::string original = "[";
+    for (int i = 0; i < trackCount; ++i) {
+        if (i > 0) {
+            original += ",\n  ";
+        }
+        std::string json;
+        appendJson(json, source[i]);
+        json.insert(json.size() - 1, ",\"extra\":{\"bitrate\":320,\"tags\":[\"pop\",\"live\"],\"hq\":true}");
+        original += json;
+    }
+    original += "]";
+
+    std::string body;
+    std::printf("tracks: %d, body: %.1f MB, rounds: %d, cpu: %s\n\n", trackCount, original.size() / 1e6, rounds,
+                simdLevelName(detectSimdLevel()));
+
+    // 之前的路径：DOM + jsonToTrack
+    std::vector<Track> expected;
+    double domMs = bestOf(rounds, original, body, [&](std::string& text) {
+        JsonValue value;
+        expected.clear();
+        if (!parseJson(text, value) || !value.isArray()) {
+            std::fprintf(stderr, "parseJson failed\n");
+            std::exit(1);
+        }
+        expected.reserve(value.array.size());
+        for (const auto& element : value.array) {
+            Track track;
+            jsonToTrack(element, track);
+            expected.push_back(std::move(track));
+        }
+    });
+    if (expected.size() != source.size() || !sameTrack(expected.front(), source.front()) ||
+        !sameTrack(expected.back(), source.back())) {
+        std::fprintf(stderr, "dom: unexpected result\n");
+        return 1;
+    }
+
+    std::printf("%-8s %10s %10s %10s\n", "path", "best ms", "MB/s", "speedup");
+    auto print = [&](const char* name, double ms) {
+        std::printf("%-8s %10.2f %10.0f %9.1fx\n", name, ms, original.size() / 1e6 / (ms / 1e3), domMs / ms);
+    };
+    print("dom", domMs);
+
+    for (int level = 0; level <= static_cast<int>(detectSimdLevel()); ++level) {
+        TrackParser parser(static_cast<SimdLevel>(level));
+        std::vector<TrackView> views;
+        bool isArray = false;
+        double ms = bestOf(rounds, original, body, [&](std::string& text) {
+            if (!parser.parse(text, views, isArray)) {
+                std::fprintf(stderr, "%s: %s\n", simdLevelName(parser.level()), parser.error().c_str());
+                std::exit(1);
+            }
+        });
+
+        // 最后一轮的结果仍指向 body，逐个与 DOM 路径比较
+        if (!isArray || views.size() != expected.size()) {
+            std::fprintf(stderr, "%s: got %zu tracks\n", simdLevelName(parser.level()), views.size());
+            return 1;
+        }
+        for (size_t i = 0; i < views.size(); ++i) {
+            if (!views[i].valid || !sameTrack(views[i].toTrack(), expected[i])) {
+                std::fprintf(stderr, "%s: track %zu differs\n", simdLevelName(parser.level()), i);
+                return 1;
+            }
+        }
+        print(simdLevelName(parser.level()), ms);
+    }
+    return 0;
+}
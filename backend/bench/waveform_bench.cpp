@@ -0,0 +1,423 @@
+/**
+ * 波形峰值与频谱基准
+ *
+ *   1. FFT：2048 点与双精度 DFT 比较（误差相对峰值 < 1e-5），SSE / AVX2 与标量逐位相同，各指令集的吞吐
+ *   2. 建立：生成一首 16 位立体声 WAV（电平起伏的噪声），WaveformStore 第一次查询排队、后台解码后就绪，
+ *      报告解码建立的实时倍率（只有峰值 / 带频谱）、缓存文件的大小和内存占用
+ *   3. 正确性：最细一级的每个桶、任意范围的查询结果与直接扫描采样的最小 / 最大值一致
+ *   4. 查询耗时：不同缩放级别和点数下每点的耗时，以及同样点数下 4 分钟与 4 小时曲目的耗时之比（应当接近 1）
+ *   5. 频谱：-6 dBFS 的 1 kHz 正弦落在包含 1 kHz 的频带（容差 ±3 dB），远处的频带低于 -60 dB
+ *   6. 重新加载：新的 WaveformStore 从缓存目录加载，不再解码，结果与第一次相同
+ *
+ * 用法: musicfree_waveform_bench [seconds] [dir]
+ */
+
+#include "../include/metadata_cache.h"
+#include "../include/waveform_store.h"
+#include "../src/core/fft.h"
+#include "../src/core/waveform.h"
+#include <dirent.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <complex>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace musicfree;
+
+namespace {
+
+constexpr double kPi = 3.14159265358979323846;
+constexpr int kChannels = 2;
+constexpr int kSampleRate = 44100;
+
+void putLe16(std::vector<uint8_t>& out, uint16_t value) {
+    out.push_back(static_cast<uint8_t>(value));
+    out.push_back(static_cast<uint8_t>(value >> 8));
+}
+
+void putLe32(std::vector<uint8_t>& out, uint32_t value) {
+    for (int i = 0; i < 4; ++i) {
+        out.push_back(static_cast<uint8_t>(value >> (8 * i)));
+    }
+}
+
+void putTag(std::vector<uint8_t>& out, const char* tag) {
+    out.insert(out.end(), tag, tag + 4);
+}
+
+/**
+ * 写 16 位立体声 WAV
+ */
+bool writeWav(const std::string& path, const std::vector<int16_t>& samples) {
+    uint32_t dataBytes = static_cast<uint32_t>(samples.size() * 2);
+    std::vector<uint8_t> header;
+    putTag(header, "RIFF");
+    putLe32(header, 36 + dataBytes);
+    putTag(header, "WAVE");
+    putTag(header, "fmt ");
+    putLe32(header, 16);
+    putLe16(header, 1);
+    putLe16(header, kChannels);
+    putLe32(header, kSampleRate);
+    putLe32(header, kSampleRate * kChannels * 2);
+    putLe16(header, kChannels * 2);
+    putLe16(header, 16);
+    putTag(header, "data");
+    putLe32(header, dataBytes);
+
+    FILE* file = std::fopen(path.c_str(), "wb");
+    if (!file) {
+        return false;
+    }
+    bool ok = std::fwrite(header.data(), 1, header.size(), file) == header.size() &&
+              std::fwrite(samples.data(), 2, samples.size(), file) == samples.size();
+    return std::fclose(file) == 0 && ok;
+}
+
+/**
+ * 与 WaveformBuilder 相同的量化：PCM 源把 int16 除以 32768，峰值再乘 32767 取整
+ */
+int16_t quantize(int16_t sample) {
+    return static_cast<int16_t>(std::lround(static_cast<float>(sample) / 32768.0f * 32767.0f));
+}
+
+/**
+ * 目录中的文件名（不含 . 和 ..）
+ */
+std::vector<std::string> listFiles(const std::string& directory) {
+    std::vector<std::string> names;
+    if (DIR* dir = opendir(directory.c_str())) {
+        while (dirent* entry = readdir(dir)) {
+            std::string name = entry->d_name;
+            if (name != "." && name != "..") {
+                names.push_back(name);
+            }
+        }
+        closedir(dir);
+    }
+    return names;
+}
+
+void removeDirectory(const std::string& directory) {
+    for (const std::string& name : listFiles(directory)) {
+        std::remove((directory + "/" + name).c_str());
+    }
+    rmdir(directory.c_str());
+}
+
+double secondsSince(std::chrono::steady_clock::time_point begin) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+}
+
+/**
+ * 轮询直到就绪或失败
+ */
+WaveformStatus waitReady(WaveformStore& store, const std::string& path, const WaveformQuery& query,
+                         WaveformView& view) {
+    for (;;) {
+        WaveformStatus status = store.query(path, query, view);
+        if (status != WaveformStatus::PENDING) {
+            return status;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    }
+}
+
+bool check(const char* name, bool ok) {
+    std::printf("  %-56s %s\n", name, ok ? "ok" : "WRONG");
+    return ok;
+}
+
+/**
+ * 每点的查询耗时（纳秒）
+ */
+double queryNsPerPoint(const WaveformData& data, const WaveformQuery& query, int repeats) {
+    WaveformView view;
+    auto begin = std::chrono::steady_clock::now();
+    size_t points = 0;
+    for (int i = 0; i < repeats; ++i) {
+        queryWaveform(data, query, view);
+        points += view.points();
+    }
+    return secondsSince(begin) * 1e9 / static_cast<double>(std::max<size_t>(points, 1));
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    int seconds = argc > 1 ? std::max(10, std::atoi(argv[1])) : 240;
+    std::string dir = argc > 2 ? argv[2] : "/tmp/musicfree_waveform_bench";
+    mkdir(dir.c_str(), 0755);
+    bool pass = true;
+
+    // ===== 1. FFT =====
+    std::printf("fft: 2048 points x %zu lanes\n", FftBatch::kLanes);
+    {
+        const size_t n = 2048;
+        const size_t lanes = FftBatch::kLanes;
+        std::vector<float> input(n * lanes);
+        uint32_t seed = 1;
+        for (float& value : input) {
+            seed = seed * 1664525u + 1013904223u;
+            value = static_cast<float>(static_cast<int32_t>(seed)) / 2147483648.0f;
+        }
+
+        // 第 3 路与双精度 DFT 比较
+        std::vector<float> re = input, im(n * lanes, 0.0f);
+        FftBatch(n, SimdLevel::SCALAR).transform(re.data(), im.data());
+        double worst = 0, largest = 0;
+        for (size_t k = 0; k < n; ++k) {
+            std::complex<double> sum;
+            for (size_t t = 0; t < n; ++t) {
+                sum += static_cast<double>(input[t * lanes + 3]) *
+                       std::polar(1.0, -2.0 * kPi * static_cast<double>((k * t) % n) / n);
+            }
+            worst = std::max(worst, std::abs(sum - std::complex<double>(re[k * lanes + 3], im[k * lanes + 3])));
+            largest = std::max(largest, std::abs(sum));
+        }
+        std::printf("  max error vs double DFT %.2e of peak\n", worst / largest);
+        pass &= check("matches the DFT", worst / largest < 1e-5);
+
+        SimdLevel best = detectSimdLevel();
+        for (SimdLevel level : {SimdLevel::SCALAR, SimdLevel::SSE42, SimdLevel::AVX2}) {
+            if (level > best) {
+                continue;
+            }
+            FftBatch fft(n, level);
+            std::vector<float> r = input, i(n * lanes, 0.0f);
+            fft.transform(r.data(), i.data());
+            bool exact = std::memcmp(r.data(), re.data(), r.size() * sizeof(float)) == 0 &&
+                         std::memcmp(i.data(), im.data(), i.size() * sizeof(float)) == 0;
+            const int repeats = 2000;
+            auto begin = std::chrono::steady_clock::now();
+            for (int k = 0; k < repeats; ++k) {
+                // 每次从原始输入开始（连续变换会溢出），拷贝计入耗时
+                std::copy(input.begin(), input.end(), r.begin());
+                std::fill(i.begin(), i.end(), 0.0f);
+                fft.transform(r.data(), i.data());
+            }
+            double us = secondsSince(begin) * 1e6 / repeats;
+            std::printf("  %-7s %7.1f us per batch, %6.2f us per transform, %s\n", simdLevelName(level), us,
+                        us / lanes, exact ? "bit-exact with scalar" : "DIFFERS from scalar");
+            pass &= exact;
+        }
+    }
+
+    // ===== 2. 建立 =====
+    std::string cachePath = dir + "/metadata.cache";
+    std::string track = dir + "/track.wav";
+    uint64_t frames = static_cast<uint64_t>(seconds) * kSampleRate + 123;
+    std::vector<int16_t> samples(frames * kChannels);
+    {
+        // 噪声，电平按 3 秒的周期起伏，两个声道不同
+        uint32_t seed = 7;
+        for (uint64_t f = 0; f < frames; ++f) {
+            double envelope = 0.05 + 0.9 * std::pow(std::sin(kPi * static_cast<double>(f) / (3.0 * kSampleRate)), 2);
+            for (int c = 0; c < kChannels; ++c) {
+                seed = seed * 1664525u + 1013904223u;
+                double value = envelope * (c == 0 ? 1.0 : 0.7) * static_cast<double>(static_cast<int32_t>(seed)) /
+                               2147483648.0;
+                samples[f * kChannels + c] = static_cast<int16_t>(std::lround(value * 32767.0));
+            }
+        }
+    }
+    if (!writeWav(track, samples)) {
+        std::printf("cannot write %s\n", track.c_str());
+        return 1;
+    }
+    std::string waveformDir = cachePath + ".waveform";
+    removeDirectory(waveformDir);
+    MetadataCache& cache = MetadataCache::getInstance();
+    cache.initialize(cachePath);
+
+    std::printf("\nbuild: %d s, %d Hz 16-bit stereo (%.1f MB)\n", seconds, kSampleRate,
+                static_cast<double>(samples.size() * 2) / (1 << 20));
+    WaveformData peaksOnly, withSpectrum;
+    auto begin = std::chrono::steady_clock::now();
+    pass &= buildWaveform(track, kSampleRate, false, peaksOnly);
+    double peaksSeconds = secondsSince(begin);
+    begin = std::chrono::steady_clock::now();
+    pass &= buildWaveform(track, kSampleRate, true, withSpectrum);
+    double spectrumSeconds = secondsSince(begin);
+    std::printf("  peaks only      %7.3f s, %6.0fx realtime\n", peaksSeconds, seconds / peaksSeconds);
+    std::printf("  with spectrum   %7.3f s, %6.0fx realtime\n", spectrumSeconds, seconds / spectrumSeconds);
+
+    WaveformStore store(kSampleRate);
+    WaveformQuery full;
+    full.resolution = 2000;
+    full.spectrum = true;
+    WaveformView view;
+    WaveformStatus first = store.query(track, full, view);
+    begin = std::chrono::steady_clock::now();
+    WaveformStatus status = waitReady(store, track, full, view);
+    std::printf("  store: first query %s, ready after %.3f s\n", first == WaveformStatus::PENDING ? "pending" : "?",
+                secondsSince(begin));
+    pass &= check("first query is pending, then ready", first == WaveformStatus::PENDING &&
+                                                         status == WaveformStatus::READY);
+
+    struct stat st;
+    std::vector<std::string> names = listFiles(waveformDir);
+    bool stored = names.size() == 1 && stat((waveformDir + "/" + names[0]).c_str(), &st) == 0;
+    double fileKb = stored ? static_cast<double>(st.st_size) / 1024 : 0;
+    std::printf("  cache file %.0f KB (%.1f KB per minute), %.0f KB in memory with all levels\n", fileKb,
+                fileKb * 60 / seconds, static_cast<double>(withSpectrum.memoryBytes()) / 1024);
+    pass &= check("waveform written to the cache directory", stored);
+
+    // ===== 3. 正确性 =====
+    std::printf("\ncorrectness\n");
+    {
+        const std::vector<WaveformPeak>& base = peaksOnly.levels[0];
+        bool bucketsOk = base.size() == (frames + kWaveformBucketFrames - 1) / kWaveformBucketFrames;
+        for (size_t b = 0; b < base.size() && bucketsOk; ++b) {
+            size_t first = b * kWaveformBucketFrames * kChannels;
+            size_t last = std::min(samples.size(), first + kWaveformBucketFrames * kChannels);
+            auto range = std::minmax_element(samples.begin() + first, samples.begin() + last);
+            bucketsOk = base[b].min == quantize(*range.first) && base[b].max == quantize(*range.second);
+        }
+        pass &= check("every base bucket equals the scanned min / max", bucketsOk);
+
+        // 随机范围：所有点的并集等于覆盖范围内扫描的结果，且点数符合请求
+        uint32_t seed = 99;
+        bool rangesOk = true;
+        uint64_t totalMs = frames * 1000 / kSampleRate;
+        for (int i = 0; i < 200 && rangesOk; ++i) {
+            seed = seed * 1664525u + 1013904223u;
+            WaveformQuery query;
+            query.startMs = seed % totalMs;
+            seed = seed * 1664525u + 1013904223u;
+            query.endMs = query.startMs + 1 + seed % (totalMs - query.startMs);
+            seed = seed * 1664525u + 1013904223u;
+            query.resolution = 1 + seed % 5000;
+            queryWaveform(peaksOnly, query, view);
+            size_t buckets = (view.endFrame - view.startFrame + kWaveformBucketFrames - 1) / kWaveformBucketFrames;
+            int16_t lo = 32767, hi = -32767;
+            for (size_t p = 0; p < view.points(); ++p) {
+                lo = std::min(lo, view.peaks[p * 2]);
+                hi = std::max(hi, view.peaks[p * 2 + 1]);
+            }
+            auto range = std::minmax_element(samples.begin() + view.startFrame * kChannels,
+                                             samples.begin() + view.endFrame * kChannels);
+            uint64_t requestedStart = query.startMs * kSampleRate / 1000;
+            uint64_t requestedEnd = std::min(frames, query.endMs * kSampleRate / 1000);
+            rangesOk = lo == quantize(*range.first) && hi == quantize(*range.second) &&
+                       view.startFrame <= requestedStart && view.endFrame >= requestedEnd &&
+                       view.points() == std::min(query.resolution, buckets) && view.points() > 0;
+        }
+        pass &= check("200 random ranges match the scanned samples", rangesOk);
+    }
+
+    // ===== 4. 查询耗时 =====
+    std::printf("\nquery time (ns per output point)\n");
+    {
+        std::printf("  %-12s %10s %10s %10s\n", "range", "100 pts", "1000 pts", "10000 pts");
+        uint64_t totalMs = frames * 1000 / kSampleRate;
+        const char* names[] = {"full track", "10%", "1%"};
+        uint64_t spans[] = {0, totalMs / 10, totalMs / 100};
+        for (int r = 0; r < 3; ++r) {
+            std::printf("  %-12s", names[r]);
+            for (size_t points : {100, 1000, 10000}) {
+                WaveformQuery query;
+                query.startMs = spans[r] == 0 ? 0 : totalMs / 3;
+                query.endMs = spans[r] == 0 ? 0 : query.startMs + spans[r];
+                query.resolution = points;
+                query.spectrum = true;
+                std::printf(" %10.1f", queryNsPerPoint(withSpectrum, query, 200000 / static_cast<int>(points)));
+            }
+            std::printf("\n");
+        }
+
+        // 4 小时的曲目：最细一级重复 60 次
+        WaveformData longTrack = peaksOnly;
+        std::vector<WaveformPeak> base;
+        for (int i = 0; i < 60; ++i) {
+            base.insert(base.end(), peaksOnly.levels[0].begin(), peaksOnly.levels[0].end());
+        }
+        longTrack.totalFrames = base.size() * kWaveformBucketFrames;
+        longTrack.levels.assign(1, std::move(base));
+        buildWaveformLevels(longTrack);
+        WaveformQuery query;
+        query.resolution = 1000;
+        double shortNs = queryNsPerPoint(peaksOnly, query, 2000);
+        double longNs = queryNsPerPoint(longTrack, query, 2000);
+        std::printf("  1000 points over the whole track: %.1f ns/point at %d s, %.1f ns/point at %d s (%.2fx)\n",
+                    shortNs, seconds, longNs, seconds * 60, longNs / shortNs);
+        pass &= check("query time independent of track length", longNs / shortNs < 3);
+
+        begin = std::chrono::steady_clock::now();
+        const int repeats = 2000;
+        for (int i = 0; i < repeats; ++i) {
+            store.query(track, full, view);
+        }
+        std::printf("  store.query (2000 points + spectrum, incl. stat) %.1f us\n",
+                    secondsSince(begin) * 1e6 / repeats);
+    }
+
+    // ===== 5. 频谱 =====
+    std::printf("\nspectrum\n");
+    {
+        std::string sinePath = dir + "/sine.wav";
+        std::vector<int16_t> sine(static_cast<size_t>(10 * kSampleRate) * kChannels);
+        double amplitude = std::pow(10.0, -6.0 / 20.0);
+        for (size_t f = 0; f < sine.size() / kChannels; ++f) {
+            double value = amplitude * std::sin(2.0 * kPi * 1000.0 * static_cast<double>(f) / kSampleRate);
+            sine[f * 2] = sine[f * 2 + 1] = static_cast<int16_t>(std::lround(value * 32767.0));
+        }
+        writeWav(sinePath, sine);
+        WaveformData data;
+        pass &= buildWaveform(sinePath, kSampleRate, true, data);
+        WaveformQuery query;
+        query.resolution = 10;
+        query.spectrum = true;
+        queryWaveform(data, query, view);
+        size_t band = 0;
+        while (band + 1 < view.bands && view.bandFrequencies[band + 1] <= 1000.0) {
+            ++band;
+        }
+        // 第 2 点：避开首尾不满的列
+        const uint8_t* column = view.spectrum.data() + 2 * view.bands;
+        double db = column[band] * -kSpectrumFloorDb / 255.0 + kSpectrumFloorDb;
+        uint8_t far = 0;
+        for (size_t b = 0; b < view.bands; ++b) {
+            if (view.bandFrequencies[b] > 4000.0) {
+                far = std::max(far, column[b]);
+            }
+        }
+        double farDb = far * -kSpectrumFloorDb / 255.0 + kSpectrumFloorDb;
+        std::printf("  1 kHz at -6 dBFS: band %zu (%.0f - %.0f Hz) %.1f dB, above 4 kHz at most %.1f dB\n", band,
+                    view.bandFrequencies[band], view.bandFrequencies[band + 1], db, farDb);
+        pass &= check("sine lands in its band", std::fabs(db + 6.0) <= 3.0 && farDb < -60.0);
+        std::remove(sinePath.c_str());
+    }
+
+    // ===== 6. 重新加载 =====
+    std::printf("\nreload\n");
+    {
+        WaveformStore fresh(kSampleRate);
+        WaveformView reloaded;
+        begin = std::chrono::steady_clock::now();
+        WaveformStatus reloadStatus = fresh.query(track, full, reloaded);
+        double ms = secondsSince(begin) * 1e3;
+        WaveformStoreStats stats = fresh.getStats();
+        std::printf("  first query of a new store: %.2f ms, built %llu, loaded %llu\n", ms,
+                    static_cast<unsigned long long>(stats.built), static_cast<unsigned long long>(stats.loaded));
+        store.query(track, full, view);
+        pass &= check("loaded from the cache directory without decoding",
+                      reloadStatus == WaveformStatus::READY && stats.built == 0 && stats.loaded == 1 &&
+                          reloaded.peaks == view.peaks && reloaded.spectrum == view.spectrum);
+    }
+
+    std::remove(track.c_str());
+    removeDirectory(waveformDir);
+    cache.shutdown();
+    std::remove(cachePath.c_str());
+    std::printf("%s\n", pass ? "PASS" : "FAIL");
+    return pass ? 0 : 1;
+}
@@ -3,9 +3,41 @@
 
 #include <string>
 #include <memory>
+#include <vector>
+#include <cstdint>
 
 namespace musicfree {
 
+/**
+ * API 服务器启动参数
+ */
+struct ApiServerOptions {
+    std::string host = "127.0.0.1";  // 绑定地址
+    int port = 8888;                 // HTTP 服务端口，0 表示由系统分配
+    int threads = 1;                 // 事件循环（Reactor）数量，0 表示使用 CPU 核心数
+    bool pinThreads = false;         // 是否把每个事件循环线程绑定到一个 CPU 核心
+    int eventIntervalMs = 200;       // /api/events 播放位置事件的最小推送间隔（毫秒）
+    int eventQueueDepth = 64;        // 每个事件流连接待发送事件的上限，超出后断开慢客户端
+    std::string unixSocketPath;      // 本地二进制协议的 Unix 域套接字路径，为空时不监听
+};
+
+/**
+ * 单个事件循环的运行统计
+ * 用于观察多个 Reactor 之间的负载是否均衡
+ */
+struct ReactorStats {
+    int index = 0;
+    uint64_t connectionsAccepted = 0;
+    uint64_t activeConnections = 0;
+    uint64_t requests = 0;
+    uint64_t bytesRead = 0;
+    uint64_t bytesWritten = 0;
+    uint64_t eventStreams = 0;       // 当前 /api/events 订阅连接数
+    uint64_t eventsDropped = 0;      // 慢客户端被断开时没有发出的事件数
+    uint64_t eventsCoalesced = 0;    // 合并掉的过期位置事件数
+    uint64_t requestsInFlight = 0;   // 已开始处理、应答尚未完全发出的请求数
+};
+
 /**
  * REST API 服务器
  * 向前端提供 HTTP 接口
@@ -22,9 +54,17 @@ public:
     /**
      * 启动 API 服务器
      * @param port HTTP 服务端口
+     * @param threads 事件循环线程数，0 表示使用 CPU 核心数
      * @return 成功返回 true
      */
-    bool start(int port = 8888);
+    bool start(int port = 8888, int threads = 1);
+
+    /**
+     * 按给定参数启动 API 服务器
+     * @param options 启动参数
+     * @return 成功返回 true
+     */
+    bool start(const ApiServerOptions& options);
 
     /**
      * 停止 API 服务器
@@ -43,6 +83,12 @@ public:
      */
     int getPort() const;
 
+    /**
+     * 获取各事件循环的运行统计
+     * @return 每个 Reactor 一项
+     */
+    std::vector<ReactorStats> getReactorStats() const;
+
 private:
     class Impl;
     std::unique_ptr<Impl> impl_;
@@ -1,8 +1,10 @@
 #ifndef MUSICFREE_AUDIO_ENGINE_H
 #define MUSICFREE_AUDIO_ENGINE_H
 
+#include "metrics.h"
 #include <string>
 #include <memory>
+#include <cstddef>
 #include <functional>
 #include <vector>
 
@@ -15,6 +17,16 @@ enum class PlayState {
     PAUSED = 2
 };
 
+/**
+ * 响度分析结果（EBU R128 / ITU-R BS.1770，按播放时的声道布局测量）
+ */
+struct LoudnessInfo {
+    double trackLoudness = 0;  // 积分响度（LUFS）
+    double trackPeak = 0;      // 真峰值（dBTP）
+    double albumLoudness = 0;  // 同一专辑所有曲目合在一起的积分响度；单独分析的曲目等于 trackLoudness
+    double albumPeak = 0;      // 同一专辑各曲目真峰值的最大值
+};
+
 // 音频信息结构
 struct AudioInfo {
     std::string title;
@@ -22,12 +34,144 @@ struct AudioInfo {
     std::string album;
     int duration = 0;  // 毫秒
     std::string format;
+    int sampleRate = 0;     // 文件的采样率、声道数和位深，未知时为 0
+    int channels = 0;
+    int bitsPerSample = 0;
+    bool loudnessAnalyzed = false;  // 响度分析器分析过（结果保存在元数据缓存里）
+    bool placeholder = false;       // 无法识别为音频的文件，用静音占位
+    LoudnessInfo loudness;
+};
+
+/**
+ * 音频引擎运行统计（自启动以来的累计值）
+ */
+struct AudioEngineMetrics {
+    uint64_t loads = 0;
+    uint64_t blocksDecoded = 0;       // 解码线程写入环形缓冲区的块数
+    uint64_t underruns = 0;           // 输出回调在环形缓冲区里取不满一个周期的次数
+    uint64_t framesPlayed = 0;        // 输出回调消费的帧数
+    uint64_t sinkFrames = 0;          // 交给输出端的帧数（实时输出端含欠载时填充的静音）
+    uint64_t gaplessTransitions = 0;  // 无缝切换到下一首的次数（含交叉淡化）
+    uint64_t crossfades = 0;          // 交叉淡化切换的次数
+    HistogramSnapshot decodeTime;     // 每块的解码耗时（纳秒）
+    // 输出线程各阶段的累计耗时（纳秒）
+    uint64_t mixNanos = 0;            // 从环形缓冲区取数据、切换曲目和交叉淡化
+    uint64_t dspNanos = 0;            // 均衡器、限幅器和音量
+    uint64_t sinkNanos = 0;           // 写入输出端
+    uint64_t eventsDropped = 0;       // 事件队列满而丢弃的事件数
+    HistogramSnapshot eventLatency;   // 事件从发布到开始分发的延迟（纳秒）
+};
+
+// 增益过渡曲线
+enum class GainCurve {
+    LINEAR = 0,       // 增益按线性倍数匀速变化
+    EXPONENTIAL = 1   // 增益按分贝匀速变化，听感更均匀
+};
+
+// 交叉淡化曲线
+enum class CrossfadeCurve {
+    LINEAR = 0,      // 两路增益线性交叉，中点响度下降约 3 dB
+    EQUAL_POWER = 1  // 正弦 / 余弦交叉，两路不相关时总功率不变
+};
+
+// 输出端
+enum class OutputSinkType {
+    DEVICE = 0,     // 声卡，按采样率实时输出
+    NULL_SINK = 1,  // 丢弃输出，不限速
+    WAV_FILE = 2    // 写入 WAV 文件（float32），不限速
+};
+
+// 重采样质量档位（通带边缘相对较低采样率的奈奎斯特频率 / 阻带衰减 / 每相抽头数）
+enum class ResamplerQuality {
+    LOW = 0,     // 0.80 / 约 54 dB / 16
+    MEDIUM = 1,  // 0.85 / 约 77 dB / 32
+    HIGH = 2,    // 0.90 / 约 100 dB / 64
+    BEST = 3     // 0.93 / 约 137 dB / 128
+};
+
+// 响度归一化模式（ReplayGain 风格）
+enum class NormalizationMode {
+    OFF = 0,    // 不调整
+    TRACK = 1,  // 每首调整到目标响度
+    ALBUM = 2   // 同一专辑用同一个增益，保留曲目之间的响度差；没有专辑结果时按单曲
+};
+
+// 均衡器频段类型（RBJ Audio EQ Cookbook 的二阶滤波器）
+enum class EqBandType {
+    PEAKING = 0,     // 峰值 / 凹陷
+    LOW_SHELF = 1,   // 低频搁架
+    HIGH_SHELF = 2,  // 高频搁架
+    LOW_PASS = 3,    // 低通，gainDb 不起作用
+    HIGH_PASS = 4    // 高通，gainDb 不起作用
+};
+
+// 均衡器最多的频段数
+constexpr size_t kMaxEqBands = 16;
+
+/**
+ * 均衡器的一个频段
+ */
+struct EqBand {
+    EqBandType type = EqBandType::PEAKING;
+    double frequency = 1000;  // 中心 / 转折频率（Hz），低于奈奎斯特频率
+    double gainDb = 0;        // -24 到 24 dB
+    double q = 0.707;         // 品质因数 0.1 到 24
+};
+
+/**
+ * 均衡器与限幅器设置
+ * 处理顺序：前级增益 → 各频段（级联）→ 限幅器 → 音量
+ */
+struct EqualizerSettings {
+    bool enabled = false;            // 关闭时整条处理链直通，输出与输入逐位一致
+    double preampDb = 0;             // -24 到 24 dB
+    std::vector<EqBand> bands;       // 最多 kMaxEqBands 个
+    bool limiter = true;             // 限幅器，只在 enabled 时生效
+    double limiterThresholdDb = -1;  // 输出峰值上限，-24 到 0 dBFS
+    double limiterReleaseMs = 100;   // 增益恢复的时间常数，1 到 2000 ms
+};
+
+/**
+ * 音频引擎配置
+ * 解码线程把 PCM 写进 bufferPeriods 个周期大小的环形缓冲区，输出线程每次取走 periodFrames 帧
+ */
+struct AudioEngineOptions {
+    int sampleRate = 44100;
+    int channels = 2;
+    size_t periodFrames = 1024;    // 每个输出周期的帧数（也是解码块大小）
+    size_t bufferPeriods = 8;      // 环形缓冲区深度（周期数）
+    int volumeRampMs = 20;         // 音量变化的过渡时长
+    GainCurve volumeCurve = GainCurve::LINEAR;
+    bool gapless = true;           // 曲目结束时无缝接上下一首（需要设置下一首的提供者）
+    int gaplessPrefetchMs = 2000;  // 当前曲目剩余多少时开始预取下一首
+    int crossfadeMs = 0;           // 切换曲目时的交叉淡化时长，0 表示直接无缝衔接
+    CrossfadeCurve crossfadeCurve = CrossfadeCurve::EQUAL_POWER;
+    // 不限速的输出端让整条管线以 CPU 能达到的最快速度运行（基准测试、离线渲染）
+    OutputSinkType outputSink = OutputSinkType::DEVICE;
+    std::string outputPath;        // WAV_FILE 的输出文件
+    // 采样率与输出不同的文件在解码线程上重采样
+    ResamplerQuality resamplerQuality = ResamplerQuality::HIGH;
+    // 分析过响度的曲目按目标响度调整增益，真峰值不超过 0 dBTP
+    NormalizationMode normalization = NormalizationMode::OFF;
+    double normalizationTargetLufs = -18;
 };
 
 // 播放器事件回调
+// 回调在引擎的事件分发线程上按发布顺序调用，不持有引擎的任何锁，可以在回调里调用引擎的方法
 using PlayStateChangedCallback = std::function<void(PlayState)>;
 using PositionChangedCallback = std::function<void(int)>;
 using TrackEndedCallback = std::function<void()>;
+using TrackChangedCallback = std::function<void(const std::string& filePath)>;
+
+// 事件订阅的标识，用于取消订阅
+using SubscriptionId = uint64_t;
+
+/**
+ * 下一首的提供者：在解码线程上调用，不持有引擎的锁
+ * @param filePath 输出下一首的文件路径
+ * @return 没有下一首返回 false
+ */
+using NextTrackProvider = std::function<bool(std::string& filePath)>;
 
 /**
  * 音频引擎类
@@ -35,7 +179,7 @@ using TrackEndedCallback = std::function<void()>;
  */
 class AudioEngine {
 public:
-    AudioEngine();
+    explicit AudioEngine(const AudioEngineOptions& options = AudioEngineOptions());
     ~AudioEngine();
 
     // 禁止拷贝
@@ -76,11 +220,53 @@ public:
 
     /**
      * 设置音量
+     * 输出端在 volumeRampMs 内平滑过渡到新增益（增益为 (volume / 100)^2）
      * @param volume 音量等级 0-100
      * @return 成功返回 true
      */
     bool setVolume(int volume);
 
+    /**
+     * 设置交叉淡化
+     * 之后的曲目切换把当前曲目的最后 durationMs 与下一首的开头混合；正在进行的淡化不受影响
+     * @param durationMs 淡化时长（毫秒），0 到 12000，0 表示关闭
+     * @param curve 淡化曲线
+     * @return 成功返回 true
+     */
+    bool setCrossfade(int durationMs, CrossfadeCurve curve);
+
+    /**
+     * 设置响度归一化
+     * 增益 = 目标响度 - 曲目（专辑）响度，再限制在使真峰值不超过 0 dBTP 的范围内；
+     * 在解码线程上按曲目施加，交叉淡化时两首各用自己的增益。正在播放的曲目在 volumeRampMs 内过渡，
+     * 生效时间滞后环形缓冲区的深度
+     * @param mode 模式
+     * @param targetLufs 目标响度，-30 到 -5 LUFS
+     * @return 成功返回 true
+     */
+    bool setNormalization(NormalizationMode mode, double targetLufs);
+
+    /**
+     * 获取当前的响度归一化设置
+     * @param targetLufs 输出目标响度
+     * @return 模式
+     */
+    NormalizationMode getNormalization(double& targetLufs) const;
+
+    /**
+     * 设置均衡器和限幅器
+     * 系数在调用线程上计算，无锁交给输出线程，下一个周期生效；频段数和类型不变时滤波器状态保留，
+     * 拖动参数不会产生爆音
+     * @param settings 设置，任何一项超出范围时整体不生效
+     * @return 成功返回 true
+     */
+    bool setEqualizer(const EqualizerSettings& settings);
+
+    /**
+     * 获取当前的均衡器设置
+     */
+    EqualizerSettings getEqualizer() const;
+
     /**
      * 获取当前音量
      * @return 音量等级 0-100
@@ -88,13 +274,13 @@ public:
     int getVolume() const;
 
     /**
-     * 获取当前播放位置
+     * 获取当前播放位置（由输出的帧数换算，无锁）
      * @return 位置（毫秒）
      */
     int getPosition() const;
 
     /**
-     * 获取当前播放状态
+     * 获取当前播放状态（无锁）
      * @return 播放状态
      */
     PlayState getState() const;
@@ -105,19 +291,44 @@ public:
      */
     AudioInfo getAudioInfo() const;
 
-    // 事件回调注册
-    void onPlayStateChanged(PlayStateChangedCallback callback);
-    void onPositionChanged(PositionChangedCallback callback);
-    void onTrackEnded(TrackEndedCallback callback);
+    /**
+     * 获取运行统计
+     * 计数器由解码线程和输出线程无锁写入，可以在任意线程读取
+     * @return 运行统计
+     */
+    AudioEngineMetrics getMetrics() const;
+
+    /**
+     * 设置下一首的提供者，用于无缝播放
+     * 当前曲目快结束时引擎向它要下一首，预先解码，在当前曲目最后一帧之后紧接着输出，
+     * 随后依次触发 onTrackEnded 和 onTrackChanged。加载、跳转或停止会丢弃已经预取的下一首
+     * @param provider 下一首的提供者，传空函数表示关闭
+     */
+    void setNextTrackProvider(NextTrackProvider provider);
+
+    /**
+     * 事件订阅
+     * 引擎发布事件时不加锁、不等待订阅者；同一种事件可以有多个订阅者，按订阅顺序调用。
+     * 可以在任意线程（包括回调中）订阅和取消
+     * @param callback 回调
+     * @return 订阅标识
+     */
+    SubscriptionId onPlayStateChanged(PlayStateChangedCallback callback);
+    SubscriptionId onPositionChanged(PositionChangedCallback callback);
+    SubscriptionId onTrackEnded(TrackEndedCallback callback);
+    SubscriptionId onTrackChanged(TrackChangedCallback callback);
+
+    /**
+     * 取消订阅
+     * 在回调之外调用时，返回后该回调不会再被调用
+     * @param id 订阅标识
+     * @return 找到该订阅返回 true
+     */
+    bool unsubscribe(SubscriptionId id);
 
 private:
     class Impl;
     std::unique_ptr<Impl> impl_;
-
-    // 回调函数
-    PlayStateChangedCallback state_callback_;
-    PositionChangedCallback position_callback_;
-    TrackEndedCallback track_ended_callback_;
 };
 
 }  // namespace musicfree
@@ -1,6 +1,7 @@
 #ifndef MUSICFREE_DATABASE_MANAGER_H
 #define MUSICFREE_DATABASE_MANAGER_H
 
+#include <cstdint>
 #include <string>
 #include <vector>
 #include <memory>
@@ -86,6 +87,13 @@ public:
      */
     bool addToFavorite(const Track& track);
 
+    /**
+     * 批量添加到收藏（一次加锁），已收藏的轨道和列表内重复的轨道会被跳过
+     * @param tracks 轨道列表
+     * @return 实际添加的数量
+     */
+    size_t addToFavorites(const std::vector<Track>& tracks);
+
     /**
      * 从收藏删除
      * @param trackId 轨道ID
@@ -99,6 +107,14 @@ public:
      */
     std::vector<Track> getFavorites() const;
 
+    /**
+     * 获取收藏的版本号，每次收藏变化时加一
+     * 与 getFavorites 配合使用时应先取版本号再取数据，
+     * 这样读到的数据只可能比版本号新，不会把旧数据当成新版本
+     * @return 版本号
+     */
+    uint64_t getFavoritesVersion() const;
+
     /**
      * 检查是否已收藏
      * @param trackId 轨道ID
@@ -121,6 +137,12 @@ public:
      */
     std::vector<Track> getHistory(int limit = 100) const;
 
+    /**
+     * 获取播放历史的版本号，每次历史变化时加一（用法同 getFavoritesVersion）
+     * @return 版本号
+     */
+    uint64_t getHistoryVersion() const;
+
     /**
      * 清空播放历史
      * @return 成功返回 true
@@ -146,7 +168,8 @@ public:
     std::string getSetting(const std::string& key, const std::string& defaultValue = "") const;
 
 private:
-    DatabaseManager() = default;
+    DatabaseManager();
+    ~DatabaseManager();
 
     class Impl;
     std::unique_ptr<Impl> impl_;
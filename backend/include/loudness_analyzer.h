@@ -0,0 +1,117 @@
+#ifndef MUSICFREE_LOUDNESS_ANALYZER_H
+#define MUSICFREE_LOUDNESS_ANALYZER_H
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+#include "audio_engine.h"
+#include "playlist_manager.h"
+
+namespace musicfree {
+
+/**
+ * 单个文件的分析结果
+ */
+struct LoudnessTrackResult {
+    std::string file;
+    bool analyzed = false;  // 无法打开或不支持的格式为 false
+    LoudnessInfo loudness;
+};
+
+/**
+ * 一批文件的分析结果
+ */
+struct LoudnessBatchResult {
+    size_t files = 0;
+    size_t analyzed = 0;
+    size_t skipped = 0;       // 无法打开、还没有解码器的压缩格式，或被取消
+    size_t albums = 0;        // 分析过的曲目分成的专辑数
+    double seconds = 0;       // 耗时
+    double audioSeconds = 0;  // 分析过的音频总时长
+    std::vector<LoudnessTrackResult> tracks;  // 与输入的文件顺序相同
+};
+
+/**
+ * 分析进度
+ */
+struct LoudnessProgress {
+    bool running = false;
+    size_t total = 0;
+    size_t completed = 0;
+};
+
+/**
+ * 批量响度分析器（EBU R128 积分响度 + 真峰值）
+ *
+ * 文件放在一个共享的工作队列里（原子下标），每个工作线程取一个分析一个，长短不一的文件自然均衡到各个核心。
+ * 每个线程只有一个响度计和一块固定大小的缓冲区，文件按顺序映射读取、分析完立即解除映射，
+ * 内存占用与文件数量和长度无关。
+ * 同一目录下专辑标签相同的曲目算作一张专辑：各曲目的门限块直方图合并后得到专辑响度，
+ * 专辑峰值取各曲目的最大值；没有专辑标签的曲目单独成一张。
+ * 结果写进元数据缓存（MetadataCache::storeLoudness），一批结束后保存一次缓存文件。
+ * 目前只有 WAV / AIFF / 原始 PCM 能解码，其他格式记为跳过。
+ */
+class LoudnessAnalyzer {
+public:
+    /**
+     * @param threads 工作线程数，0 表示使用 CPU 核心数
+     * @param rawSampleRate 原始 PCM 文件（.pcm / .raw）按这个采样率解释
+     */
+    explicit LoudnessAnalyzer(int threads = 0, int rawSampleRate = 44100);
+
+    // 禁止拷贝
+    LoudnessAnalyzer(const LoudnessAnalyzer&) = delete;
+    LoudnessAnalyzer& operator=(const LoudnessAnalyzer&) = delete;
+
+    /**
+     * 准备新的一批：清除取消标志，进度归零
+     * analyze() 本身不清除取消标志，在 reset() 之后调用的 cancel() 不会丢失
+     */
+    void reset();
+
+    /**
+     * 分析一批文件并把结果写进元数据缓存，在调用线程上等待全部完成
+     * 同一个分析器同时只能运行一批；取消过的分析器要先 reset()
+     * @param files 文件路径
+     * @return 分析结果
+     */
+    LoudnessBatchResult analyze(const std::vector<std::string>& files);
+
+    /**
+     * 取消正在运行（或已经 reset() 准备好）的一批：正在分析的文件在下一块数据处停止，
+     * 剩余的记为跳过（可以从任意线程调用）
+     */
+    void cancel();
+
+    /**
+     * 获取进度（可以从任意线程调用）
+     */
+    LoudnessProgress progress() const;
+
+    /**
+     * 递归列出目录下的音频文件（按扩展名），结果按路径排序
+     * 指向目录的符号链接会跟随，同一个目录只列出一次
+     * @param directory 目录
+     * @return 文件路径
+     */
+    static std::vector<std::string> listAudioFiles(const std::string& directory);
+
+    /**
+     * 播放列表中的本地文件（跳过 http:// 等远程地址），去掉重复
+     */
+    static std::vector<std::string> playlistFiles(const Playlist& playlist);
+
+private:
+    int threads_;
+    int raw_sample_rate_;
+    std::atomic<bool> running_{false};
+    std::atomic<bool> cancelled_{false};
+    std::atomic<size_t> total_{0};
+    std::atomic<size_t> completed_{0};
+};
+
+}  // namespace musicfree
+
+#endif  // MUSICFREE_LOUDNESS_ANALYZER_H
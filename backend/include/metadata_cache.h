@@ -0,0 +1,126 @@
+#ifndef MUSICFREE_METADATA_CACHE_H
+#define MUSICFREE_METADATA_CACHE_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include "audio_engine.h"
+
+namespace musicfree {
+
+struct SeekIndex;
+struct WaveformData;
+
+/**
+ * 元数据缓存统计
+ */
+struct MetadataCacheStats {
+    size_t entries = 0;   // 缓存的文件数
+    uint64_t hits = 0;    // 文件未变化、直接返回缓存的次数
+    uint64_t misses = 0;  // 重新读取标签的次数
+    uint64_t seekIndexesBuilt = 0;   // 建立跳转表的次数
+    uint64_t seekIndexesLoaded = 0;  // 从缓存目录加载跳转表的次数
+    size_t loudnessEntries = 0;      // 带有响度分析结果的文件数
+};
+
+/**
+ * 音频文件元数据缓存
+ * 以 (路径, 大小, 修改时间) 为键缓存读取到的 AudioInfo 并保存到磁盘，
+ * 重新打开曲库时每个文件只需要一次 stat()，文件变化后才重新读取标签
+ */
+class MetadataCache {
+public:
+    static MetadataCache& getInstance();
+
+    // 禁止拷贝
+    MetadataCache(const MetadataCache&) = delete;
+    MetadataCache& operator=(const MetadataCache&) = delete;
+
+    /**
+     * 清空缓存并从文件加载，文件不存在时从空缓存开始
+     * @param cachePath 缓存文件路径，为空时只缓存在内存中
+     * @return 成功返回 true；文件损坏时丢弃内容并返回 false
+     */
+    bool initialize(const std::string& cachePath);
+
+    /**
+     * 有变化时把缓存写回文件（先写临时文件再改名，中途退出不会留下半个文件）
+     * @return 成功或无需写入返回 true
+     */
+    bool save();
+
+    /**
+     * 保存并清空缓存
+     */
+    void shutdown();
+
+    /**
+     * 获取文件的音频信息，文件未变化时直接返回缓存，否则读取标签并更新缓存
+     * 无法识别的文件也会记录下来，文件不变就不会再次读取
+     * @param filePath 文件路径
+     * @param info 输出音频信息
+     * @return 识别出格式返回 true
+     */
+    bool lookup(const std::string& filePath, AudioInfo& info);
+
+    /**
+     * 获取压缩文件（MP3 / FLAC / Ogg）的跳转表
+     * 跳转表保存在缓存文件旁的目录中（缓存路径加 ".seek"），每个文件一个，带有文件的大小和修改时间；
+     * 文件未变化时直接加载，否则映射文件建立跳转表并保存，所以只在第一次打开时建立
+     * @param filePath 文件路径
+     * @param index 输出跳转表
+     * @return 成功返回 true；文件不是支持的压缩格式时返回 false
+     */
+    bool getSeekIndex(const std::string& filePath, SeekIndex& index);
+
+    /**
+     * 记录响度分析结果，文件还没有缓存条目时先读取标签建立条目
+     * 文件变化后条目重建，结果随之失效，需要重新分析
+     * @param filePath 文件路径
+     * @param loudness 分析结果
+     * @return 文件存在返回 true
+     */
+    bool storeLoudness(const std::string& filePath, const LoudnessInfo& loudness);
+
+    /**
+     * 获取响度分析结果，只检查缓存（一次 stat()），不读取文件
+     * @param filePath 文件路径
+     * @param loudness 输出分析结果
+     * @return 文件未变化且分析过返回 true
+     */
+    bool getLoudness(const std::string& filePath, LoudnessInfo& loudness);
+
+    /**
+     * 加载保存的波形数据，只读取缓存目录，不解码
+     * 波形保存在缓存文件旁的目录中（缓存路径加 ".waveform"），每个文件一个，带有文件的大小和修改时间
+     * @param filePath 文件路径
+     * @param waveform 输出波形数据（已建立金字塔）
+     * @return 保存过且文件未变化时返回 true；没有缓存路径时返回 false
+     */
+    bool getWaveform(const std::string& filePath, WaveformData& waveform);
+
+    /**
+     * 保存波形数据（只写最细一级，加载时重建其余级别）
+     * @param filePath 文件路径
+     * @param waveform 波形数据
+     * @return 写入成功返回 true；没有缓存路径时不写入并返回 false
+     */
+    bool storeWaveform(const std::string& filePath, const WaveformData& waveform);
+
+    /**
+     * 获取统计
+     * @return 统计快照
+     */
+    MetadataCacheStats getStats() const;
+
+private:
+    MetadataCache();
+    ~MetadataCache();
+
+    class Impl;
+    std::unique_ptr<Impl> impl_;
+};
+
+}  // namespace musicfree
+
+#endif  // MUSICFREE_METADATA_CACHE_H
@@ -0,0 +1,126 @@
+#ifndef MUSICFREE_METRICS_H
+#define MUSICFREE_METRICS_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace musicfree {
+
+/**
+ * 对数-线性分桶的耗时直方图（HDR Histogram 的分桶方式）
+ *
+ * 数值（纳秒）按最高有效位分段，每段再线性分成 2^kSubBucketBits 个子桶，
+ * 任意数值的相对误差不超过 1 / 2^kSubBucketBits（约 6%），从纳秒到数十秒只需要几百个桶。
+ *
+ * 单写者：同一个直方图只能由一个线程调用 record()（例如每个事件循环线程一份），
+ * 写入是 relaxed 的读-改-写，不加锁也不用带 lock 前缀的原子指令；其他线程可以随时
+ * snapshot()，读到的是某个时刻附近的一致性较弱的视图，足够用于监控。
+ */
+class LatencyHistogram {
+public:
+    static constexpr int kSubBucketBits = 4;
+    static constexpr int kMaxValueBits = 36;  // 超过 2^36 ns（约 68 秒）的数值计入最后一个桶
+    static constexpr size_t kBucketCount = static_cast<size_t>(kMaxValueBits - kSubBucketBits + 1)
+                                           << kSubBucketBits;
+
+    LatencyHistogram() = default;
+
+    // 禁止拷贝
+    LatencyHistogram(const LatencyHistogram&) = delete;
+    LatencyHistogram& operator=(const LatencyHistogram&) = delete;
+
+    /**
+     * 记录一个数值（仅限所属的写线程调用）
+     * @param nanos 耗时（纳秒）
+     */
+    void record(uint64_t nanos) {
+        bump(buckets_[bucketIndex(nanos)], 1);
+        bump(count_, 1);
+        bump(sum_, nanos);
+    }
+
+    /**
+     * 数值所在的桶
+     * @param value 数值
+     * @return 桶序号
+     */
+    static size_t bucketIndex(uint64_t value) {
+        constexpr uint64_t kSubCount = uint64_t(1) << kSubBucketBits;
+        if (value < kSubCount) {
+            return static_cast<size_t>(value);
+        }
+        int msb = 63 - __builtin_clzll(value);
+        if (msb >= kMaxValueBits) {
+            return kBucketCount - 1;
+        }
+        int shift = msb - kSubBucketBits;
+        return (static_cast<size_t>(shift + 1) << kSubBucketBits) +
+               static_cast<size_t>((value >> shift) & (kSubCount - 1));
+    }
+
+    /**
+     * 桶能容纳的最大数值
+     * @param index 桶序号
+     * @return 上界（含）
+     */
+    static uint64_t bucketUpperBound(size_t index);
+
+    friend class HistogramSnapshot;
+
+private:
+    static void bump(std::atomic<uint64_t>& cell, uint64_t delta) {
+        cell.store(cell.load(std::memory_order_relaxed) + delta, std::memory_order_relaxed);
+    }
+
+    std::atomic<uint64_t> buckets_[kBucketCount] = {};
+    std::atomic<uint64_t> count_{0};
+    std::atomic<uint64_t> sum_{0};
+};
+
+/**
+ * 直方图快照：普通整数，可以把多个线程的直方图合并后计算分位数
+ */
+class HistogramSnapshot {
+public:
+    HistogramSnapshot() : buckets_(LatencyHistogram::kBucketCount, 0) {}
+
+    /**
+     * 累加一个直方图的当前值
+     * @param histogram 直方图
+     */
+    void merge(const LatencyHistogram& histogram);
+
+    /**
+     * 累加另一个快照
+     * @param other 快照
+     */
+    void merge(const HistogramSnapshot& other);
+
+    uint64_t count() const { return count_; }
+    uint64_t sum() const { return sum_; }
+
+    /**
+     * 分位数
+     * @param quantile 0 ~ 1
+     * @return 分位数所在桶的上界（纳秒），没有数据时返回 0
+     */
+    uint64_t quantile(double quantile) const;
+
+    /**
+     * 不超过给定数值的样本数（按桶上界判断，误差与分桶精度相同）
+     * @param bound 上界（纳秒）
+     * @return 样本数
+     */
+    uint64_t countAtOrBelow(uint64_t bound) const;
+
+private:
+    std::vector<uint64_t> buckets_;
+    uint64_t count_ = 0;
+    uint64_t sum_ = 0;
+};
+
+}  // namespace musicfree
+
+#endif  // MUSICFREE_METRICS_H
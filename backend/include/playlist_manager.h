@@ -1,6 +1,8 @@
 #ifndef MUSICFREE_PLAYLIST_MANAGER_H
 #define MUSICFREE_PLAYLIST_MANAGER_H
 
+#include <atomic>
+#include <cstdint>
 #include <string>
 #include <vector>
 #include <memory>
@@ -41,6 +43,18 @@ enum class PlayMode {
     SHUFFLE = 3     // 随机播放
 };
 
+/**
+ * 播放列表修改计数（自启动以来的累计值）
+ */
+struct PlaylistMutationCounts {
+    uint64_t adds = 0;           // addTrack / addTracks 调用次数
+    uint64_t tracksAdded = 0;
+    uint64_t removes = 0;        // removeTrack 成功次数
+    uint64_t clears = 0;
+    uint64_t tracksRemoved = 0;  // removeTrack 和 clear 删除的轨道数
+    uint64_t batches = 0;        // 最外层 beginBatch / endBatch 的次数
+};
+
 using PlaylistChangedCallback = std::function<void(const Playlist&)>;
 
 /**
@@ -61,6 +75,12 @@ public:
      */
     void addTrack(const Track& track);
 
+    /**
+     * 批量添加轨道到当前播放列表，变更回调只触发一次
+     * @param tracks 轨道列表
+     */
+    void addTracks(const std::vector<Track>& tracks);
+
     /**
      * 删除指定索引的轨道
      * @param index 轨道索引
@@ -78,6 +98,28 @@ public:
      */
     Playlist getCurrentPlaylist() const;
 
+    /**
+     * 获取当前播放列表的只读引用（不拷贝）
+     * 引用在下一次修改播放列表之前有效，调用方需自行保证与修改操作互斥
+     * @return 播放列表
+     */
+    const Playlist& viewCurrentPlaylist() const;
+
+    /**
+     * 获取播放列表版本号
+     * 每次修改播放列表内容时加一，用于判断缓存的序列化结果是否过期
+     * （updatedAt 只精确到秒，同一秒内的多次修改无法区分）
+     * @return 版本号
+     */
+    uint64_t getVersion() const;
+
+    /**
+     * 获取修改计数
+     * 计数器是原子变量，可以在任意线程读取，不需要与修改操作互斥（监控接口使用）
+     * @return 修改计数
+     */
+    PlaylistMutationCounts getMutationCounts() const;
+
     /**
      * 获取当前轨道索引
      * @return 索引
@@ -102,6 +144,14 @@ public:
      */
     bool playPrevious();
 
+    /**
+     * 预测当前曲目自然播完之后要播放的轨道（不改变当前索引）
+     * 顺序播放到结尾返回 -1；单曲循环返回当前索引；随机播放的选择会被记住，
+     * 播放列表不变时，之后的 playNext() 选中同一首
+     * @return 轨道索引，没有下一首返回 -1
+     */
+    int peekNextTrackIndex();
+
     /**
      * 获取播放模式
      * @return 当前播放模式
@@ -133,11 +183,39 @@ public:
      */
     void onPlaylistChanged(PlaylistChangedCallback callback);
 
+    /**
+     * 开始批量修改
+     * 在对应的 endBatch() 之前，播放列表变化回调推迟到批量结束时最多触发一次；可以嵌套
+     */
+    void beginBatch();
+
+    /**
+     * 结束批量修改
+     * 最外层的批量结束且期间播放列表有变化时，触发一次变化回调
+     */
+    void endBatch();
+
 private:
+    void notifyChanged();
+    int takeShufflePick();
+
     Playlist current_playlist_;
+    uint64_t version_ = 0;
     int current_track_index_ = -1;
     PlayMode play_mode_ = PlayMode::ORDER;
     PlaylistChangedCallback playlist_changed_callback_;
+    int batch_depth_ = 0;
+    bool batch_changed_ = false;
+    int shuffle_next_ = -1;         // 随机播放预先选定的下一首
+    uint64_t shuffle_version_ = 0;  // 选定时的播放列表版本
+
+    // 修改操作由调用方互斥，计数器只有一个写者；用原子变量是为了让监控线程无锁读取
+    std::atomic<uint64_t> adds_{0};
+    std::atomic<uint64_t> tracks_added_{0};
+    std::atomic<uint64_t> removes_{0};
+    std::atomic<uint64_t> clears_{0};
+    std::atomic<uint64_t> tracks_removed_{0};
+    std::atomic<uint64_t> batches_{0};
 };
 
 }  // namespace musicfree
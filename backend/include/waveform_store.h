@@ -0,0 +1,119 @@
+#ifndef MUSICFREE_WAVEFORM_STORE_H
+#define MUSICFREE_WAVEFORM_STORE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace musicfree {
+
+// 一次查询最多返回的点数
+constexpr size_t kMaxWaveformResolution = 65536;
+
+/**
+ * 波形查询：时间范围和点数
+ */
+struct WaveformQuery {
+    uint64_t startMs = 0;
+    uint64_t endMs = 0;         // 0 表示到结尾
+    size_t resolution = 1000;   // 点数（范围内的数据不够时返回更少）
+    bool spectrum = false;      // 同时返回频谱
+};
+
+/**
+ * 波形查询结果
+ * 覆盖范围对齐到所选级别的桶边界，可能比请求的范围略宽
+ */
+struct WaveformView {
+    int sampleRate = 0;
+    int channels = 0;
+    uint64_t totalFrames = 0;
+
+    uint64_t startFrame = 0;      // 峰值覆盖的范围
+    uint64_t endFrame = 0;
+    std::vector<int16_t> peaks;   // 每点一对 (min, max)，各声道合并，满幅为 ±32767
+
+    bool hasSpectrum = false;
+    uint64_t spectrumStartFrame = 0;
+    uint64_t spectrumEndFrame = 0;
+    size_t bands = 0;
+    std::vector<double> bandFrequencies;  // bands + 1 个频带边界（Hz），按对数等分
+    std::vector<uint8_t> spectrum;        // 每点 bands 个值，0..255 线性对应 -100..0 dBFS
+
+    size_t points() const { return peaks.size() / 2; }
+    size_t spectrumPoints() const { return bands == 0 ? 0 : spectrum.size() / bands; }
+};
+
+// query() 的结果
+enum class WaveformStatus {
+    READY = 0,    // view 已填好
+    PENDING = 1,  // 已排队（或正在）解码，稍后再查询
+    FAILED = 2    // 文件不存在、无法解码或还没有解码器的格式
+};
+
+/**
+ * 波形存储统计
+ */
+struct WaveformStoreStats {
+    uint64_t built = 0;        // 解码建立的次数
+    uint64_t loaded = 0;       // 从缓存目录加载的次数
+    uint64_t memoryHits = 0;   // 直接由内存中的数据回答的查询数
+    uint64_t failed = 0;       // 解码失败的次数
+    size_t pending = 0;        // 排队中的文件数（含正在解码的）
+    size_t memoryEntries = 0;  // 内存中的文件数
+    double buildSeconds = 0;   // 解码建立的总耗时
+    double audioSeconds = 0;   // 解码建立的音频总时长
+};
+
+/**
+ * 预先计算的波形峰值和频谱
+ *
+ * 第一次查询某个文件时放进后台队列，由一个工作线程解码一遍，
+ * 算出每 256 帧一个桶的最小 / 最大值和（请求过频谱时）每 4096 帧一列的 64 个对数频带的频谱，
+ * 写进元数据缓存旁的目录（MetadataCache::storeWaveform），之后不再解码。
+ * 内存中两者都组织成金字塔（每级合并相邻两个桶），任何缩放级别都选点数不少于请求的最粗一级，
+ * 每个输出点合并一到三个桶，查询耗时只与输出点数成正比，与曲目长度和缩放级别无关。
+ * 最近使用的若干个文件的数据留在内存中，文件变化（大小或修改时间）后重新建立。
+ */
+class WaveformStore {
+public:
+    /**
+     * @param rawSampleRate 原始 PCM 文件（.pcm / .raw）按这个采样率解释
+     * @param memoryEntries 内存中最多保留的文件数
+     */
+    explicit WaveformStore(int rawSampleRate = 44100, size_t memoryEntries = 16);
+
+    /**
+     * 停止工作线程（正在解码的文件在下一块数据处放弃）
+     */
+    ~WaveformStore();
+
+    // 禁止拷贝
+    WaveformStore(const WaveformStore&) = delete;
+    WaveformStore& operator=(const WaveformStore&) = delete;
+
+    /**
+     * 查询波形（可以从任意线程调用）；还没有数据时排队解码并返回 PENDING
+     * @param filePath 本地文件路径
+     * @param query 时间范围和点数
+     * @param view 输出结果
+     * @return 查询状态
+     */
+    WaveformStatus query(const std::string& filePath, const WaveformQuery& query, WaveformView& view);
+
+    /**
+     * 获取统计
+     * @return 统计快照
+     */
+    WaveformStoreStats getStats() const;
+
+private:
+    class Impl;
+    std::unique_ptr<Impl> impl_;
+};
+
+}  // namespace musicfree
+
+#endif  // MUSICFREE_WAVEFORM_STORE_H
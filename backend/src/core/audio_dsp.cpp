@@ -0,0 +1,382 @@
+#include "audio_dsp.h"
+#include "audio_gain.h"
+#include <algorithm>
+#include <cmath>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define MUSICFREE_AUDIO_DSP_X86 1
+#endif
+
+namespace musicfree {
+
+namespace {
+
+constexpr double kPi = 3.14159265358979323846;
+
+// 小于这个值的滤波器状态在块结束时置 0（约 -300 dB）
+constexpr float kDenormalFloor = 1e-15f;
+
+// 限幅器增益恢复到这个值以上时视为 1，之后可以走只扫描峰值的快速路径
+constexpr float kUnityGain = 0.999999f;
+
+float dbToGain(double db) {
+    return static_cast<float>(std::pow(10.0, db / 20.0));
+}
+
+/**
+ * 标量内核：一个声道
+ */
+void biquadScalar(float* samples, size_t frames, int channels, int lane, const BiquadCoefficients* coefficients,
+                  size_t bands, float* state) {
+    for (size_t b = 0; b < bands; ++b) {
+        const BiquadCoefficients& c = coefficients[b];
+        float* s1 = state + (b * 2) * static_cast<size_t>(channels) + lane;
+        float* s2 = s1 + channels;
+        float z1 = *s1, z2 = *s2;
+        float* p = samples + lane;
+        for (size_t f = 0; f < frames; ++f, p += channels) {
+            float x = *p;
+            float y = c.b0 * x + z1;
+            z1 = (c.b1 * x - c.a1 * y) + z2;
+            z2 = c.b2 * x - c.a2 * y;
+            *p = y;
+        }
+        *s1 = z1;
+        *s2 = z2;
+    }
+}
+
+#ifdef MUSICFREE_AUDIO_DSP_X86
+
+/**
+ * SSE 内核：Lanes 为 4 时一次 4 个声道，为 2 时用低半部分处理 2 个声道
+ */
+template <int Lanes>
+struct SseLanes {
+    __attribute__((target("sse4.1")))
+    static __m128 load(const float* p) {
+        if (Lanes == 4) {
+            return _mm_loadu_ps(p);
+        }
+        return _mm_castpd_ps(_mm_load_sd(reinterpret_cast<const double*>(p)));
+    }
+
+    __attribute__((target("sse4.1")))
+    static void store(float* p, __m128 v) {
+        if (Lanes == 4) {
+            _mm_storeu_ps(p, v);
+        } else {
+            _mm_store_sd(reinterpret_cast<double*>(p), _mm_castps_pd(v));
+        }
+    }
+};
+
+template <int Lanes>
+__attribute__((target("sse4.1")))
+void biquadSse(float* samples, size_t frames, int channels, int lane, const BiquadCoefficients* coefficients,
+               size_t bands, float* state) {
+    using L = SseLanes<Lanes>;
+    for (size_t b = 0; b < bands; ++b) {
+        const BiquadCoefficients& c = coefficients[b];
+        float* s1 = state + (b * 2) * static_cast<size_t>(channels) + lane;
+        float* s2 = s1 + channels;
+        __m128 b0 = _mm_set1_ps(c.b0), b1 = _mm_set1_ps(c.b1), b2 = _mm_set1_ps(c.b2);
+        __m128 a1 = _mm_set1_ps(c.a1), a2 = _mm_set1_ps(c.a2);
+        __m128 z1 = L::load(s1), z2 = L::load(s2);
+        float* p = samples + lane;
+        for (size_t f = 0; f < frames; ++f, p += channels) {
+            __m128 x = L::load(p);
+            __m128 y = _mm_add_ps(_mm_mul_ps(b0, x), z1);
+            z1 = _mm_add_ps(_mm_sub_ps(_mm_mul_ps(b1, x), _mm_mul_ps(a1, y)), z2);
+            z2 = _mm_sub_ps(_mm_mul_ps(b2, x), _mm_mul_ps(a2, y));
+            L::store(p, y);
+        }
+        L::store(s1, z1);
+        L::store(s2, z2);
+    }
+}
+
+__attribute__((target("avx2")))
+void biquadAvx2(float* samples, size_t frames, int channels, int lane, const BiquadCoefficients* coefficients,
+                size_t bands, float* state) {
+    for (size_t b = 0; b < bands; ++b) {
+        const BiquadCoefficients& c = coefficients[b];
+        float* s1 = state + (b * 2) * static_cast<size_t>(channels) + lane;
+        float* s2 = s1 + channels;
+        __m256 b0 = _mm256_set1_ps(c.b0), b1 = _mm256_set1_ps(c.b1), b2 = _mm256_set1_ps(c.b2);
+        __m256 a1 = _mm256_set1_ps(c.a1), a2 = _mm256_set1_ps(c.a2);
+        __m256 z1 = _mm256_loadu_ps(s1), z2 = _mm256_loadu_ps(s2);
+        float* p = samples + lane;
+        for (size_t f = 0; f < frames; ++f, p += channels) {
+            __m256 x = _mm256_loadu_ps(p);
+            __m256 y = _mm256_add_ps(_mm256_mul_ps(b0, x), z1);
+            z1 = _mm256_add_ps(_mm256_sub_ps(_mm256_mul_ps(b1, x), _mm256_mul_ps(a1, y)), z2);
+            z2 = _mm256_sub_ps(_mm256_mul_ps(b2, x), _mm256_mul_ps(a2, y));
+            _mm256_storeu_ps(p, y);
+        }
+        _mm256_storeu_ps(s1, z1);
+        _mm256_storeu_ps(s2, z2);
+    }
+}
+
+__attribute__((target("sse4.1")))
+float peakSse(const float* samples, size_t count) {
+    const __m128 mask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+    __m128 peak = _mm_setzero_ps();
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        peak = _mm_max_ps(peak, _mm_and_ps(_mm_loadu_ps(samples + i), mask));
+    }
+    peak = _mm_max_ps(peak, _mm_movehl_ps(peak, peak));
+    peak = _mm_max_ss(peak, _mm_shuffle_ps(peak, peak, 1));
+    float result = _mm_cvtss_f32(peak);
+    for (; i < count; ++i) {
+        result = std::max(result, std::fabs(samples[i]));
+    }
+    return result;
+}
+
+__attribute__((target("avx2")))
+float peakAvx2(const float* samples, size_t count) {
+    const __m256 mask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7fffffff));
+    __m256 peak0 = _mm256_setzero_ps(), peak1 = _mm256_setzero_ps();
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        peak0 = _mm256_max_ps(peak0, _mm256_and_ps(_mm256_loadu_ps(samples + i), mask));
+        peak1 = _mm256_max_ps(peak1, _mm256_and_ps(_mm256_loadu_ps(samples + i + 8), mask));
+    }
+    __m256 peak8 = _mm256_max_ps(peak0, peak1);
+    __m128 peak = _mm_max_ps(_mm256_castps256_ps128(peak8), _mm256_extractf128_ps(peak8, 1));
+    peak = _mm_max_ps(peak, _mm_movehl_ps(peak, peak));
+    peak = _mm_max_ss(peak, _mm_shuffle_ps(peak, peak, 1));
+    float result = _mm_cvtss_f32(peak);
+    for (; i < count; ++i) {
+        result = std::max(result, std::fabs(samples[i]));
+    }
+    return result;
+}
+
+#endif  // MUSICFREE_AUDIO_DSP_X86
+
+}  // namespace
+
+BiquadCoefficients designBiquad(const EqBand& band, int sampleRate) {
+    double w0 = 2.0 * kPi * band.frequency / sampleRate;
+    double cosw = std::cos(w0);
+    double alpha = std::sin(w0) / (2.0 * band.q);
+    double a = std::pow(10.0, band.gainDb / 40.0);
+    double shelf = 2.0 * std::sqrt(a) * alpha;
+
+    double b0, b1, b2, a0, a1, a2;
+    switch (band.type) {
+        case EqBandType::LOW_SHELF:
+            b0 = a * ((a + 1) - (a - 1) * cosw + shelf);
+            b1 = 2 * a * ((a - 1) - (a + 1) * cosw);
+            b2 = a * ((a + 1) - (a - 1) * cosw - shelf);
+            a0 = (a + 1) + (a - 1) * cosw + shelf;
+            a1 = -2 * ((a - 1) + (a + 1) * cosw);
+            a2 = (a + 1) + (a - 1) * cosw - shelf;
+            break;
+        case EqBandType::HIGH_SHELF:
+            b0 = a * ((a + 1) + (a - 1) * cosw + shelf);
+            b1 = -2 * a * ((a - 1) + (a + 1) * cosw);
+            b2 = a * ((a + 1) + (a - 1) * cosw - shelf);
+            a0 = (a + 1) - (a - 1) * cosw + shelf;
+            a1 = 2 * ((a - 1) - (a + 1) * cosw);
+            a2 = (a + 1) - (a - 1) * cosw - shelf;
+            break;
+        case EqBandType::LOW_PASS:
+            b0 = (1 - cosw) / 2;
+            b1 = 1 - cosw;
+            b2 = (1 - cosw) / 2;
+            a0 = 1 + alpha;
+            a1 = -2 * cosw;
+            a2 = 1 - alpha;
+            break;
+        case EqBandType::HIGH_PASS:
+            b0 = (1 + cosw) / 2;
+            b1 = -(1 + cosw);
+            b2 = (1 + cosw) / 2;
+            a0 = 1 + alpha;
+            a1 = -2 * cosw;
+            a2 = 1 - alpha;
+            break;
+        case EqBandType::PEAKING:
+        default:
+            b0 = 1 + alpha * a;
+            b1 = -2 * cosw;
+            b2 = 1 - alpha * a;
+            a0 = 1 + alpha / a;
+            a1 = -2 * cosw;
+            a2 = 1 - alpha / a;
+            break;
+    }
+
+    BiquadCoefficients c;
+    c.b0 = static_cast<float>(b0 / a0);
+    c.b1 = static_cast<float>(b1 / a0);
+    c.b2 = static_cast<float>(b2 / a0);
+    c.a1 = static_cast<float>(a1 / a0);
+    c.a2 = static_cast<float>(a2 / a0);
+    return c;
+}
+
+void processBiquads(float* samples, size_t frames, int channels, const BiquadCoefficients* coefficients,
+                    size_t bands, float* state, SimdLevel level) {
+    // 声道按 8 / 4 / 2 / 1 个一组，每组用能用的最宽向量
+    int lane = 0;
+#ifdef MUSICFREE_AUDIO_DSP_X86
+    if (level == SimdLevel::AVX2) {
+        for (; lane + 8 <= channels; lane += 8) {
+            biquadAvx2(samples, frames, channels, lane, coefficients, bands, state);
+        }
+    }
+    if (level >= SimdLevel::SSE42) {
+        for (; lane + 4 <= channels; lane += 4) {
+            biquadSse<4>(samples, frames, channels, lane, coefficients, bands, state);
+        }
+        for (; lane + 2 <= channels; lane += 2) {
+            biquadSse<2>(samples, frames, channels, lane, coefficients, bands, state);
+        }
+    }
+#else
+    (void)level;
+#endif
+    for (; lane < channels; ++lane) {
+        biquadScalar(samples, frames, channels, lane, coefficients, bands, state);
+    }
+
+    float* end = state + bands * 2 * static_cast<size_t>(channels);
+    for (float* s = state; s != end; ++s) {
+        if (std::fabs(*s) < kDenormalFloor) {
+            *s = 0.0f;
+        }
+    }
+}
+
+float peakAbs(const float* samples, size_t count, SimdLevel level) {
+#ifdef MUSICFREE_AUDIO_DSP_X86
+    if (level == SimdLevel::AVX2) {
+        return peakAvx2(samples, count);
+    }
+    if (level == SimdLevel::SSE42) {
+        return peakSse(samples, count);
+    }
+#else
+    (void)level;
+#endif
+    float peak = 0.0f;
+    for (size_t i = 0; i < count; ++i) {
+        peak = std::max(peak, std::fabs(samples[i]));
+    }
+    return peak;
+}
+
+// ===== Limiter =====
+
+Limiter::Limiter(int channels, SimdLevel level)
+    : channels_(channels), level_(std::min(level, detectSimdLevel())) {}
+
+void Limiter::configure(float threshold, float release) {
+    threshold_ = threshold;
+    release_ = release;
+}
+
+void Limiter::process(float* samples, size_t frames) {
+    size_t channels = static_cast<size_t>(channels_);
+    if (gain_ == 1.0f && peakAbs(samples, frames * channels, level_) <= threshold_) {
+        return;
+    }
+
+    for (size_t f = 0; f < frames; ++f) {
+        float* frame = samples + f * channels;
+        float peak = 0.0f;
+        for (size_t c = 0; c < channels; ++c) {
+            peak = std::max(peak, std::fabs(frame[c]));
+        }
+        // 需要衰减时立即降到位（没有超过阈值的瞬间），否则向目标指数恢复，恢复过程中不会高于目标
+        float target = peak > threshold_ ? threshold_ / peak : 1.0f;
+        if (target < gain_) {
+            gain_ = target;
+        } else {
+            gain_ = target + (gain_ - target) * release_;
+            if (target == 1.0f && gain_ > kUnityGain) {
+                gain_ = 1.0f;
+            }
+        }
+        for (size_t c = 0; c < channels; ++c) {
+            frame[c] *= gain_;
+        }
+    }
+}
+
+// ===== DspChain =====
+
+DspChain::DspChain(int sampleRate, int channels, SimdLevel level)
+    : sample_rate_(sampleRate),
+      channels_(channels),
+      level_(std::min(level, detectSimdLevel())),
+      state_(kMaxEqBands * 2 * static_cast<size_t>(channels), 0.0f),
+      limiter_(channels, level) {}
+
+void DspChain::publish(const EqualizerSettings& settings) {
+    Params& params = slots_[back_];
+    params.enabled = settings.enabled;
+    params.preamp = dbToGain(settings.preampDb);
+    params.bands = std::min(settings.bands.size(), kMaxEqBands);
+    for (size_t i = 0; i < params.bands; ++i) {
+        params.types[i] = settings.bands[i].type;
+        params.coefficients[i] = designBiquad(settings.bands[i], sample_rate_);
+    }
+    if (params.bands > 0) {
+        BiquadCoefficients& first = params.coefficients[0];
+        first.b0 *= params.preamp;
+        first.b1 *= params.preamp;
+        first.b2 *= params.preamp;
+    }
+    params.limiter = settings.limiter;
+    params.threshold = dbToGain(settings.limiterThresholdDb);
+    params.release = static_cast<float>(std::exp(-1000.0 / (settings.limiterReleaseMs * sample_rate_)));
+
+    uint32_t previous = pending_.exchange(back_ | kFresh, std::memory_order_acq_rel);
+    back_ = previous & kIndexMask;
+}
+
+void DspChain::process(float* samples, size_t frames) {
+    if (pending_.load(std::memory_order_relaxed) & kFresh) {
+        front_ = pending_.exchange(front_, std::memory_order_acq_rel) & kIndexMask;
+        // 频段数或类型变了，旧状态对新滤波器没有意义
+        const Params& params = slots_[front_];
+        bool sameLayout = params.bands == active_bands_ &&
+                          std::equal(params.types, params.types + params.bands, active_types_);
+        if (!sameLayout) {
+            std::fill(state_.begin(), state_.end(), 0.0f);
+            active_bands_ = params.bands;
+            std::copy(params.types, params.types + params.bands, active_types_);
+        }
+    }
+
+    const Params& params = slots_[front_];
+    if (!params.enabled) {
+        was_enabled_ = false;
+        return;
+    }
+    if (!was_enabled_) {
+        std::fill(state_.begin(), state_.end(), 0.0f);
+        limiter_.reset();
+        was_enabled_ = true;
+    }
+
+    if (params.bands > 0) {
+        processBiquads(samples, frames, channels_, params.coefficients, params.bands, state_.data(), level_);
+    } else if (params.preamp != 1.0f) {
+        applyGainLinear(samples, frames, channels_, params.preamp, 0.0f, level_);
+    }
+    if (params.limiter) {
+        limiter_.configure(params.threshold, params.release);
+        limiter_.process(samples, frames);
+    }
+}
+
+}  // namespace musicfree
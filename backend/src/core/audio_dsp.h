@@ -0,0 +1,139 @@
+#ifndef MUSICFREE_AUDIO_DSP_H
+#define MUSICFREE_AUDIO_DSP_H
+
+#include "../include/audio_engine.h"
+#include "simd_level.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace musicfree {
+
+/**
+ * 双二阶滤波器系数（已按 a0 归一化）
+ *   y[n] = b0 x[n] + b1 x[n-1] + b2 x[n-2] - a1 y[n-1] - a2 y[n-2]
+ */
+struct BiquadCoefficients {
+    float b0 = 1.0f;
+    float b1 = 0.0f;
+    float b2 = 0.0f;
+    float a1 = 0.0f;
+    float a2 = 0.0f;
+};
+
+/**
+ * 按 RBJ Audio EQ Cookbook 计算一个频段的系数（double 计算，结果转成 float）
+ * @param band 频段，调用方保证参数在范围内
+ * @param sampleRate 采样率
+ */
+BiquadCoefficients designBiquad(const EqBand& band, int sampleRate);
+
+/**
+ * 级联双二阶滤波内核（转置直接 II 型，交错采样，原地处理）
+ *
+ * state 保存每个频段每个声道的两个状态，布局为 state[(band * 2 + k) * channels + c]，
+ * 同一频段同一状态的各声道相邻，可以直接按向量读写。逐个频段处理整块数据，
+ * 一个频段的状态和系数在整块内都留在寄存器里。
+ * SIMD 版本在声道上向量化：声道数是 8 的倍数用 AVX2，是 4 的倍数用 SSE，2 个声道用 SSE 的低半部分，
+ * 其他声道数退回标量实现。各指令集按同样的运算顺序计算，结果与标量实现逐位一致。
+ * 块结束时把接近 0 的状态置 0，静音输入下状态不会衰减成非规格化数。
+ */
+void processBiquads(float* samples, size_t frames, int channels, const BiquadCoefficients* coefficients,
+                    size_t bands, float* state, SimdLevel level);
+
+/**
+ * 一段交错采样的最大绝对值
+ */
+float peakAbs(const float* samples, size_t count, SimdLevel level);
+
+/**
+ * 峰值限幅器
+ *
+ * 各声道共用一个增益（立体声像不变）。某一帧的峰值超过阈值时增益立即降到刚好不超过阈值，
+ * 之后按释放时间常数指数恢复，输出峰值永远不超过阈值。整块峰值低于阈值、增益已经恢复到 1 时
+ * 只做一次向量化的峰值扫描。只由一个线程调用，不分配内存。
+ */
+class Limiter {
+public:
+    explicit Limiter(int channels, SimdLevel level = detectSimdLevel());
+
+    /**
+     * @param threshold 峰值上限（线性）
+     * @param release 每帧的恢复系数 exp(-1 / 释放帧数)
+     */
+    void configure(float threshold, float release);
+    void process(float* samples, size_t frames);
+    void reset() { gain_ = 1.0f; }
+
+    float gain() const { return gain_; }
+
+private:
+    int channels_;
+    SimdLevel level_;
+    float threshold_ = 1.0f;
+    float release_ = 0.0f;
+    float gain_ = 1.0f;
+};
+
+/**
+ * 引擎的 DSP 处理链：前级增益 → 参数均衡器（最多 kMaxEqBands 个级联双二阶）→ 限幅器
+ *
+ * 设置由控制线程 publish()：在调用线程上计算系数，写进三缓冲中属于写端的一份，
+ * 再用一次原子交换与"待取"的一份互换；输出线程在每个周期开始时发现有新参数就再换一次。
+ * 两端都不加锁、不等待，输出线程读到的参数总是某一次完整的 publish。
+ * 滤波器状态按最大频段数和声道数预先分配，process() 不分配内存。
+ */
+class DspChain {
+public:
+    DspChain(int sampleRate, int channels, SimdLevel level = detectSimdLevel());
+
+    // 禁止拷贝
+    DspChain(const DspChain&) = delete;
+    DspChain& operator=(const DspChain&) = delete;
+
+    /**
+     * 发布新设置（调用方保证参数在范围内，多个调用方之间需要串行）
+     */
+    void publish(const EqualizerSettings& settings);
+
+    /**
+     * 处理一个周期（输出线程）；关闭时直接返回，数据不变
+     */
+    void process(float* samples, size_t frames);
+
+private:
+    struct Params {
+        bool enabled = false;
+        float preamp = 1.0f;
+        size_t bands = 0;
+        EqBandType types[kMaxEqBands] = {};
+        BiquadCoefficients coefficients[kMaxEqBands];  // 前级增益并入第一个频段
+        bool limiter = false;
+        float threshold = 1.0f;
+        float release = 0.0f;
+    };
+
+    static constexpr uint32_t kIndexMask = 3;
+    static constexpr uint32_t kFresh = 4;
+
+    int sample_rate_;
+    int channels_;
+    SimdLevel level_;
+
+    Params slots_[3];
+    std::atomic<uint32_t> pending_{2};  // 待取的一份，带 kFresh 表示输出线程还没取过
+    uint32_t back_ = 1;                 // 写端的一份，只由 publish() 访问
+    uint32_t front_ = 0;                // 输出线程正在使用的一份，只由 process() 访问
+
+    // 以下只由输出线程访问
+    std::vector<float> state_;  // kMaxEqBands * 2 * channels
+    size_t active_bands_ = 0;   // 状态对应的频段数和类型
+    EqBandType active_types_[kMaxEqBands] = {};
+    Limiter limiter_;
+    bool was_enabled_ = false;
+};
+
+}  // namespace musicfree
+
+#endif  // MUSICFREE_AUDIO_DSP_H
@@ -1,4 +1,21 @@
 #include "../include/audio_engine.h"
+#include "../include/metadata_cache.h"
+#include "audio_dsp.h"
+#include "audio_events.h"
+#include "audio_gain.h"
+#include "audio_mixer.h"
+#include "audio_output.h"
+#include "audio_sink.h"
+#include "audio_source.h"
+#include "compressed_file_source.h"
+#include "pcm_file_source.h"
+#include "pcm_ring_buffer.h"
+#include "resampler.h"
+#include "tag_reader.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
 #include <iostream>
 #include <thread>
 #include <mutex>
@@ -6,130 +23,823 @@
 
 namespace musicfree {
 
+namespace {
+
+// 播放时位置回调的间隔
+constexpr auto kPositionInterval = std::chrono::milliseconds(100);
+
+// 控制操作重置数据流后同步预先解码的周期数，输出恢复时不至于马上欠载
+constexpr size_t kPrefillPeriods = 2;
+
+// 交叉淡化时长上限：淡化期间两路同时解码，内存只取决于环形缓冲区深度，与淡化时长无关；
+// 上限只是限制预取要提前多久开始
+constexpr int kMaxCrossfadeMs = 12000;
+
+// 还没有解码器，加载的文件先用 3 分钟静音占位
+constexpr int kPlaceholderDuration = 180000;
+
+// 音量等级到增益：平方曲线，比线性更接近响度感知
+float volumeToGain(int volume) {
+    float level = static_cast<float>(volume) / 100.0f;
+    return level * level;
+}
+
+/**
+ * 打开音频文件，得到解码后的数据源和音频信息
+ * WAV / AIFF / 原始 PCM 直接从内存映射读取，采样率与输出不同时套一层重采样；
+ * 其他格式还没有解码器，用静音占位
+ * @return 失败返回 nullptr
+ */
+std::unique_ptr<AudioSource> openSource(const std::string& filePath, const AudioEngineOptions& options,
+                                        AudioInfo& info) {
+    std::unique_ptr<AudioSource> source;
+    switch (openPcmFile(filePath, options.sampleRate, options.channels, source, info)) {
+        case PcmOpenResult::OK:
+            // 响度分析结果只在元数据缓存里，文件未变化时才有效
+            info.loudnessAnalyzed = MetadataCache::getInstance().getLoudness(filePath, info.loudness);
+            if (source->sampleRate() != options.sampleRate) {
+                source = std::make_unique<ResamplingSource>(std::move(source), options.sampleRate,
+                                                            options.resamplerQuality);
+            }
+            return source;
+        case PcmOpenResult::UNSUPPORTED:
+            std::cerr << "Unsupported audio file: " << filePath << std::endl;
+            return nullptr;
+        case PcmOpenResult::NOT_PCM:
+            break;
+    }
+
+    // 压缩格式：标签和时长来自元数据缓存（只读文件头），跳转表在第一次打开时建立并保存；
+    // 解码还没有接入，先用静音代替
+    // TODO: 使用 FFmpeg 解码
+    MetadataCache& cache = MetadataCache::getInstance();
+    bool tagged = cache.lookup(filePath, info);
+    SeekIndex index;
+    auto file = std::make_unique<MappedFile>();
+    if (cache.getSeekIndex(filePath, index) && index.sampleRate > 0 && file->open(filePath)) {
+        // 跳转表的总采样数是逐帧统计的精确值，比文件头里的估计准确
+        info.duration = static_cast<int>(index.totalSamples * 1000 / static_cast<uint64_t>(index.sampleRate));
+        info.sampleRate = index.sampleRate;
+        info.channels = index.channels;
+        if (info.format.empty()) {
+            info.format = streamFormatName(index.format);
+        }
+        if (info.title.empty()) {
+            info.title = fileStem(filePath);
+        }
+        return std::make_unique<CompressedFileSource>(std::move(file), std::move(index), options.sampleRate,
+                                                      options.channels);
+    }
+    if (!tagged || info.duration <= 0) {
+        info = AudioInfo();
+        info.duration = kPlaceholderDuration;  // 模拟：3分钟
+        info.title = "Sample Track";
+        info.artist = "Unknown Artist";
+        info.placeholder = true;
+    }
+
+    uint64_t frames = static_cast<uint64_t>(info.duration) * static_cast<uint64_t>(options.sampleRate) / 1000;
+    return std::make_unique<SilenceSource>(options.sampleRate, options.channels, frames);
+}
+
+/**
+ * 一路解码流：数据源和它的环形缓冲区
+ * 引擎有两路，一路正在播放，另一路在无缝切换前预先解码下一首
+ */
+struct DecodeStream {
+    DecodeStream(size_t capacityFrames, int channels) : gain(channels), ring(capacityFrames, channels) {}
+
+    // 以下由 decode_mutex 保护
+    std::unique_ptr<AudioSource> source;
+    std::string file;
+    AudioInfo info;
+    uint64_t total_frames = 0;  // 安装之后不再修改，输出回调可以读取
+    uint64_t decoded = 0;  // 下一块要解码的帧在曲目中的位置
+    bool eof = false;
+    GainStage gain;  // 响度归一化，写进环形缓冲区之前施加
+
+    // 与输出回调共享
+    PcmRingBuffer ring;
+    std::atomic<bool> done{false};  // 最后一帧已经写进环形缓冲区
+};
+
+}  // namespace
+
+/**
+ * 线程模型：
+ *   - 控制操作（load/play/pause/stop/seek）在调用线程上执行，持有 mutex；
+ *     状态和位置另外发布到原子变量，getState/getPosition 不加锁
+ *   - 解码线程把 PCM 写进环形缓冲区，预取下一首，并负责位置事件、曲目切换和结束；
+ *     解码时持有 decode_mutex，调用下一首的提供者时不持有任何锁
+ *   - 事件（状态、位置、曲目切换）无锁发布到 AudioEventDispatcher 的队列，由它的分发线程调用订阅者。
+ *     控制操作在 mutex 内发布，事件顺序与状态变化的顺序一致；订阅者再慢也不会拖住控制操作和解码线程
+ *   - 输出线程周期性调用 render()，从环形缓冲区取数据，不加任何锁
+ *   - 输出端不限速时（丢弃、写文件）输出线程不再是实时线程，render() 先持有 decode_mutex
+ *     等解码线程跟上：环形缓冲区至少有一个周期、下一首的预取和曲目切换都已经处理完。
+ *     解码线程每轮结束时通知 ready_cv，输出线程永远不会因为解码跟不上而欠载，
+ *     播放结果与实时播放逐帧相同
+ * 锁顺序为 mutex → decode_mutex。需要清空环形缓冲区时（加载、跳转、停止），
+ * 控制操作先暂停输出线程、再拿到 decode_mutex，两端都停下之后才重置。
+ *
+ * 无缝播放：当前曲目剩余不到 gaplessPrefetchMs 时，解码线程向提供者要下一首，
+ * 打开并预先解码到另一路。输出回调在当前这一路取空的同一个周期里接着从另一路取数据，
+ * 中间没有静音，下一首的第一帧不需要等待。
+ *
+ * 交叉淡化：开启时预取提前 crossfadeMs 开始。当前曲目剩余不到淡化时长且下一首已经装好时，
+ * 输出回调同时从两路取数据，下一首取到预先分配的混音缓冲区，按曲线混合进输出；
+ * 当前曲目取完时切换到下一首。淡化期间解码线程同时填充两路，内存仍然是两个环形缓冲区
+ * 加一个周期的混音缓冲区，与淡化时长无关。
+ *
+ * 输出回调的处理顺序：混音（交叉淡化）→ 均衡器与限幅器（DspChain）→ 音量斜坡。
+ * 响度归一化不在这条链上：解码线程把每块数据写进环形缓冲区之前按曲目施加，交叉淡化时两首各用自己的增益。
+ */
 class AudioEngine::Impl {
 public:
-    PlayState state = PlayState::STOPPED;
+    explicit Impl(const AudioEngineOptions& opts)
+        : options(opts),
+          decode_buffer(opts.periodFrames * static_cast<size_t>(opts.channels)),
+          prefetch_frames(static_cast<uint64_t>(opts.gaplessPrefetchMs) * static_cast<uint64_t>(opts.sampleRate) /
+                          1000),
+          crossfade_frames(msToFrames(std::min(std::max(opts.crossfadeMs, 0), kMaxCrossfadeMs), opts.sampleRate)),
+          crossfade_curve(opts.crossfadeCurve),
+          crossfader(opts.channels),
+          mix_buffer(opts.periodFrames * static_cast<size_t>(opts.channels)),
+          target_gain(volumeToGain(volume)),
+          gain(opts.channels, volumeToGain(volume)),
+          ramp_frames(static_cast<size_t>(opts.volumeRampMs) * static_cast<size_t>(opts.sampleRate) / 1000),
+          normalization_mode(opts.normalization),
+          normalization_target(static_cast<float>(std::min(std::max(opts.normalizationTargetLufs, -30.0), -5.0))),
+          dsp(opts.sampleRate, opts.channels) {
+        for (auto& stream : streams) {
+            stream = std::make_unique<DecodeStream>(opts.periodFrames * opts.bufferPeriods, opts.channels);
+        }
+    }
+
+    AudioEngineOptions options;
+
+    // 控制状态，由 mutex 保护；state 和 duration 只在 mutex 内（或输出回调切换曲目时）修改，可以无锁读取
+    std::mutex mutex;
+    std::atomic<PlayState> state{PlayState::STOPPED};
     std::string current_file;
-    int position = 0;
     int volume = 50;
     AudioInfo audio_info;
-    
-    std::thread playback_thread;
-    std::mutex mutex;
-    std::condition_variable cv;
+    std::atomic<int> duration{0};
+
+    // 解码端，由 decode_mutex 保护
+    std::mutex decode_mutex;
+    std::condition_variable decode_cv;
     bool should_stop = false;
+    std::vector<float> decode_buffer;
+    std::thread decoder_thread;
+    NextTrackProvider next_provider;
+    uint64_t prefetch_frames;
+    uint64_t generation = 0;      // 每次重置数据流加一，丢弃重置之前发起的预取
+    bool next_requested = false;  // 已经为当前曲目要过下一首
+    bool prefetching = false;     // 正在向提供者要下一首（期间释放了 decode_mutex）
+    uint64_t switches_seen = 0;   // 解码线程已经处理过的切换次数
+    // 输出端不限速时输出线程在这里等解码线程跟上；offline 在启动线程之前设置，之后只读
+    std::condition_variable ready_cv;
+    bool offline = false;
 
-    void playbackLoop() {
-        while (!should_stop) {
-            std::unique_lock<std::mutex> lock(mutex);
-            cv.wait(lock, [this] { return state == PlayState::PLAYING || should_stop; });
-
-            if (should_stop) break;
-
-            // 模拟音频播放
-            while (state == PlayState::PLAYING && !should_stop) {
-                lock.unlock();
-                
-                // 每100ms更新一次位置
-                std::this_thread::sleep_for(std::chrono::milliseconds(100));
-                position += 100;
-
-                lock.lock();
-                if (position >= audio_info.duration && audio_info.duration > 0) {
-                    state = PlayState::STOPPED;
-                    // 触发轨道结束事件
+    // 两路解码流；解码线程和输出回调之间只通过环形缓冲区和下面这些原子变量交换数据
+    std::unique_ptr<DecodeStream> streams[2];
+    std::atomic<int> active{0};            // 输出回调读取的一路，由输出回调切换（或在输出暂停时重置）
+    std::atomic<bool> next_ready{false};   // 另一路已经装好下一首，由解码线程置位、输出回调切换时清除
+    std::atomic<bool> playing{false};
+    std::atomic<bool> drained{false};      // 输出回调取走了最后一帧且没有下一首
+    std::atomic<uint64_t> switches{0};     // 无缝切换次数，只由输出回调写入
+    // 播放时钟：下一帧要输出的帧在曲目中的位置。只由输出回调推进（每周期加上实际取到的帧数），
+    // 输出暂停时由控制操作重置；位置由它按采样率换算，不受线程调度抖动影响
+    std::atomic<uint64_t> play_frame{0};
+
+    // 交叉淡化：设置发布到原子变量，输出回调在每次淡化开始时读取
+    std::atomic<uint64_t> crossfade_frames;
+    std::atomic<CrossfadeCurve> crossfade_curve;
+    Crossfader crossfader;          // 以下只由输出回调访问（或在输出暂停时重置）
+    std::vector<float> mix_buffer;  // 淡入一路的数据，一个周期
+    uint64_t next_frame = 0;        // 淡化期间从下一首取走的帧数
+    std::atomic<uint64_t> crossfades{0};
+
+    // 音量：setVolume 发布目标增益，输出回调发现变化后启动斜坡
+    std::atomic<float> target_gain;
+    GainStage gain;  // 只由输出回调访问
+    size_t ramp_frames;
+
+    // 响度归一化：设置发布到原子变量，解码线程每块读取一次，按曲目在写进环形缓冲区之前施加
+    std::atomic<NormalizationMode> normalization_mode;
+    std::atomic<float> normalization_target;  // LUFS
+
+    // 均衡器与限幅器：设置在 mutex 内发布（发布端因此串行），输出回调无锁取用
+    EqualizerSettings equalizer;
+    DspChain dsp;
+
+    std::unique_ptr<AudioOutput> output;
+    AudioEventDispatcher events;
+
+    // 运行统计：loads 在 mutex 内写入；blocks_decoded、decode_time 在 decode_mutex 内写入；
+    // underruns、frames_total 只由输出回调写入
+    std::atomic<uint64_t> loads{0};
+    std::atomic<uint64_t> blocks_decoded{0};
+    std::atomic<uint64_t> underruns{0};
+    std::atomic<uint64_t> frames_total{0};
+    LatencyHistogram decode_time;
+    std::atomic<uint64_t> mix_nanos{0};  // 以下两项只由输出回调写入
+    std::atomic<uint64_t> dsp_nanos{0};
+
+    static void bump(std::atomic<uint64_t>& counter, uint64_t delta = 1) {
+        counter.store(counter.load(std::memory_order_relaxed) + delta, std::memory_order_relaxed);
+    }
+
+    static uint64_t msToFrames(int ms, int sampleRate) {
+        return static_cast<uint64_t>(ms) * static_cast<uint64_t>(sampleRate) / 1000;
+    }
+
+    DecodeStream& activeStream() { return *streams[active.load(std::memory_order_acquire)]; }
+    DecodeStream& idleStream() { return *streams[1 - active.load(std::memory_order_acquire)]; }
+
+    /**
+     * 输出回调：运行在输出线程，不分配内存；输出端实时消费时不加锁
+     * @return 取到的有效帧数
+     */
+    size_t render(float* out, size_t frames) {
+        if (offline) {
+            waitForDecoder();
+        }
+        auto begin = std::chrono::steady_clock::now();
+        size_t n = mix(out, frames);
+        auto mixed = std::chrono::steady_clock::now();
+        dsp.process(out, frames);
+        applyGain(out, frames);
+        auto end = std::chrono::steady_clock::now();
+        bump(mix_nanos, nanosBetween(begin, mixed));
+        bump(dsp_nanos, nanosBetween(mixed, end));
+        return n;
+    }
+
+    static uint64_t nanosBetween(std::chrono::steady_clock::time_point begin,
+                                 std::chrono::steady_clock::time_point end) {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin).count());
+    }
+
+    /**
+     * 输出端不限速时，等解码线程准备好下一个周期需要的一切（输出线程调用）
+     */
+    void waitForDecoder() {
+        std::unique_lock<std::mutex> lock(decode_mutex);
+        if (decoderCaughtUp()) {
+            return;
+        }
+        decode_cv.notify_one();
+        ready_cv.wait(lock, [this] { return decoderCaughtUp(); });
+    }
+
+    /**
+     * 输出线程可以继续取数据，调用方持有 decode_mutex
+     * 每个不满足的条件都对应解码线程的一项工作，解码线程做完之后一定会通知 ready_cv
+     */
+    bool decoderCaughtUp() {
+        if (should_stop || !playing.load(std::memory_order_acquire)) {
+            return true;
+        }
+        if (prefetching || needNext() || switches.load(std::memory_order_acquire) != switches_seen) {
+            return false;
+        }
+        int index = active.load(std::memory_order_acquire);
+        return streamReady(*streams[index]) &&
+               (!next_ready.load(std::memory_order_acquire) || streamReady(*streams[1 - index]));
+    }
+
+    bool streamReady(const DecodeStream& stream) const {
+        return !stream.source || stream.eof || stream.ring.readAvailable() >= options.periodFrames;
+    }
+
+    /**
+     * 从环形缓冲区取一个周期，处理曲目切换和交叉淡化（输出线程调用）
+     * @return 取到的有效帧数，其余部分填充静音
+     */
+    size_t mix(float* out, size_t frames) {
+        size_t channels = static_cast<size_t>(options.channels);
+        size_t n = 0;
+        if (playing.load(std::memory_order_acquire)) {
+            DecodeStream& stream = activeStream();
+            if (!crossfader.active() && next_ready.load(std::memory_order_acquire)) {
+                startCrossfade(stream);
+            }
+            if (crossfader.active()) {
+                renderCrossfade(stream, out, frames);
+                return frames;
+            }
+            n = stream.ring.read(out, frames);
+            bump(play_frame, n);
+            if (n < frames) {
+                bool finished = stream.done.load(std::memory_order_acquire) && stream.ring.readAvailable() == 0;
+                if (!finished) {
+                    bump(underruns);
+                } else if (next_ready.load(std::memory_order_acquire)) {
+                    n += switchStream(out + n * channels, frames - n);
+                } else {
+                    drained.store(true, std::memory_order_release);
                 }
             }
+            bump(frames_total, n);
+        }
+        std::fill(out + n * channels, out + frames * channels, 0.0f);
+        return n;
+    }
+
+    void applyGain(float* out, size_t frames) {
+        float target = target_gain.load(std::memory_order_relaxed);
+        if (target != gain.target()) {
+            gain.setTarget(target, ramp_frames, options.volumeCurve);
+        }
+        gain.process(out, frames);
+    }
+
+    /**
+     * 当前曲目进入最后 crossfade_frames 帧时开始交叉淡化（输出线程调用）
+     * 下一首装得晚时淡化相应缩短
+     */
+    void startCrossfade(const DecodeStream& current) {
+        uint64_t fadeFrames = crossfade_frames.load(std::memory_order_relaxed);
+        uint64_t frame = play_frame.load(std::memory_order_relaxed);
+        if (fadeFrames == 0 || frame >= current.total_frames) {
+            return;
+        }
+        uint64_t remaining = current.total_frames - frame;
+        if (remaining > fadeFrames) {
+            return;
+        }
+        // next_ready 置位之后解码线程不会再修改这一路的信息
+        const DecodeStream& next = *streams[1 - active.load(std::memory_order_relaxed)];
+        crossfader.start(static_cast<size_t>(std::min(remaining, next.total_frames)),
+                         crossfade_curve.load(std::memory_order_relaxed));
+        next_frame = 0;
+    }
+
+    /**
+     * 淡化期间的一个周期：两路各取一个周期的数据混合，当前曲目取完时切换到下一首
+     */
+    void renderCrossfade(DecodeStream& current, float* out, size_t frames) {
+        size_t channels = static_cast<size_t>(options.channels);
+        DecodeStream& next = *streams[1 - active.load(std::memory_order_relaxed)];
+        float* in = mix_buffer.data();
+
+        size_t n = current.ring.read(out, frames);
+        size_t m = next.ring.read(in, frames);
+        std::fill(out + n * channels, out + frames * channels, 0.0f);
+        std::fill(in + m * channels, in + frames * channels, 0.0f);
+        bump(play_frame, n);
+        next_frame += m;
+
+        bool currentFinished = current.done.load(std::memory_order_acquire) && current.ring.readAvailable() == 0;
+        bool nextFinished = next.done.load(std::memory_order_acquire) && next.ring.readAvailable() == 0;
+        if ((n < frames && !currentFinished) || (m < frames && !nextFinished)) {
+            bump(underruns);
+        }
+        crossfader.mix(out, in, frames);
+        bump(frames_total, std::max(n, m));
+
+        // 曲目的实际长度与 totalFrames 不符时，淡化结束或当前曲目取完都切换
+        if (currentFinished || crossfader.position() >= crossfader.length()) {
+            crossfader.reset();
+            activateNext(next_frame);
+            bump(crossfades);
+        }
+    }
+
+    /**
+     * 切换到预先解码好的下一首（输出线程调用）
+     * @param consumed 已经从下一首取走的帧数
+     */
+    void activateNext(uint64_t consumed) {
+        int next = 1 - active.load(std::memory_order_relaxed);
+        duration.store(streams[next]->info.duration, std::memory_order_relaxed);
+        active.store(next, std::memory_order_release);
+        next_ready.store(false, std::memory_order_release);
+        play_frame.store(consumed, std::memory_order_relaxed);
+        switches.fetch_add(1, std::memory_order_release);
+    }
+
+    /**
+     * 切换到预先解码好的下一首，并用它填满本周期剩余的部分（输出线程调用）
+     * @return 取到的帧数
+     */
+    size_t switchStream(float* out, size_t frames) {
+        DecodeStream& stream = *streams[1 - active.load(std::memory_order_relaxed)];
+        size_t n = stream.ring.read(out, frames);
+        activateNext(n);
+        return n;
+    }
+
+    /**
+     * 需要解码的各路：正在播放的一路，以及已经装好的下一首（无缝衔接或交叉淡化时两路都要有数据）
+     * 调用方持有 decode_mutex
+     * @return 还有一路缺数据返回 true
+     */
+    bool needsDecode() {
+        // 输出回调随时可能切换，两路都按同一次读到的 active 取；切换之后另一路已经取完，不会再写入
+        int index = active.load(std::memory_order_acquire);
+        if (needsDecode(*streams[index])) {
+            return true;
+        }
+        return next_ready.load(std::memory_order_acquire) && needsDecode(*streams[1 - index]);
+    }
+
+    bool needsDecode(const DecodeStream& stream) const {
+        return stream.source && !stream.eof && stream.ring.writeAvailable() >= options.periodFrames;
+    }
+
+    /**
+     * 把各路填满，调用方持有 decode_mutex
+     */
+    void fillStreams() {
+        int index = active.load(std::memory_order_acquire);
+        while (needsDecode(*streams[index]) && decodeBlock(*streams[index])) {
+        }
+        if (next_ready.load(std::memory_order_acquire)) {
+            DecodeStream& next = *streams[1 - index];
+            while (needsDecode(next) && decodeBlock(next)) {
+            }
+        }
+    }
+
+    /**
+     * 解码一块写进环形缓冲区，调用方持有 decode_mutex
+     * @return 还有数据可以继续解码返回 true
+     */
+    bool decodeBlock(DecodeStream& stream) {
+        if (!stream.source || stream.eof) {
+            return false;
+        }
+        size_t frames = std::min(options.periodFrames, stream.ring.writeAvailable());
+        if (frames == 0) {
+            return false;
+        }
+
+        auto begin = std::chrono::steady_clock::now();
+        size_t n = stream.source->read(decode_buffer.data(), frames);
+        float normalization = normalizationGain(stream.info);
+        if (normalization != stream.gain.target()) {
+            stream.gain.setTarget(normalization, ramp_frames, options.volumeCurve);
+        }
+        stream.gain.process(decode_buffer.data(), n);
+        stream.ring.write(decode_buffer.data(), n);
+        stream.decoded += n;
+        if (n < frames) {
+            stream.eof = true;
+            stream.done.store(true, std::memory_order_release);
+        }
+        bump(blocks_decoded);
+        decode_time.record(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - begin).count()));
+        return !stream.eof;
+    }
+
+    /**
+     * 曲目的归一化增益：目标响度减曲目（专辑）响度，再限制在使真峰值不超过 0 dBTP 的范围内
+     * 关闭或没有分析过响度时为 1
+     */
+    float normalizationGain(const AudioInfo& info) const {
+        NormalizationMode mode = normalization_mode.load(std::memory_order_relaxed);
+        if (mode == NormalizationMode::OFF || !info.loudnessAnalyzed) {
+            return 1.0f;
+        }
+        bool album = mode == NormalizationMode::ALBUM;
+        double loudness = album ? info.loudness.albumLoudness : info.loudness.trackLoudness;
+        double peak = album ? info.loudness.albumPeak : info.loudness.trackPeak;
+        double db = std::min(normalization_target.load(std::memory_order_relaxed) - loudness, -peak);
+        return static_cast<float>(std::pow(10.0, db / 20.0));
+    }
+
+    /**
+     * 清空一路解码流，调用方持有 decode_mutex，且输出回调不会读取这一路
+     */
+    void resetDecodeStream(DecodeStream& stream, uint64_t frame) {
+        if (stream.source) {
+            stream.source->seek(frame);
+        }
+        stream.gain.setTarget(normalizationGain(stream.info), 0, options.volumeCurve);
+        stream.ring.reset();
+        stream.decoded = frame;
+        stream.eof = false;
+        stream.done.store(false, std::memory_order_relaxed);
+    }
+
+    /**
+     * 把正在播放的一路重置到 frame 处并预先解码几个周期，丢弃已经预取的下一首
+     * 调用方持有 mutex，且输出已经暂停
+     */
+    void resetStream(uint64_t frame) {
+        std::lock_guard<std::mutex> lock(decode_mutex);
+        ++generation;
+        next_requested = false;
+        next_ready.store(false, std::memory_order_relaxed);
+        crossfader.reset();
+        DecodeStream& idle = idleStream();
+        idle.source.reset();
+        resetDecodeStream(idle, 0);
+
+        DecodeStream& current = activeStream();
+        resetDecodeStream(current, frame);
+        drained.store(false, std::memory_order_relaxed);
+        play_frame.store(frame, std::memory_order_relaxed);
+        for (size_t i = 0; i < kPrefillPeriods && decodeBlock(current); ++i) {
+        }
+        decode_cv.notify_one();
+    }
+
+    /**
+     * 当前曲目快要解码完，需要预取下一首，调用方持有 decode_mutex
+     */
+    bool needNext() {
+        if (!options.gapless || !next_provider || next_requested) {
+            return false;
+        }
+        DecodeStream& current = activeStream();
+        uint64_t lead = prefetch_frames + crossfade_frames.load(std::memory_order_relaxed);
+        return current.source && (current.eof || current.total_frames - current.decoded <= lead);
+    }
+
+    /**
+     * 向提供者要下一首，打开并预先解码到空闲的一路
+     * 调用提供者和打开文件时释放 decode_mutex；期间数据流被重置过则丢弃结果
+     */
+    void prefetchNext(std::unique_lock<std::mutex>& lock) {
+        next_requested = true;
+        prefetching = true;
+        uint64_t requestGeneration = generation;
+        NextTrackProvider provider = next_provider;
+        lock.unlock();
+
+        std::string filePath;
+        AudioInfo info;
+        std::unique_ptr<AudioSource> source;
+        if (provider(filePath)) {
+            source = openSource(filePath, options, info);
+        }
+
+        lock.lock();
+        prefetching = false;
+        if (!source || requestGeneration != generation) {
+            return;
+        }
+        // next_ready 为 false，输出回调不会读取空闲的一路
+        DecodeStream& next = idleStream();
+        next.source = std::move(source);
+        next.file = filePath;
+        next.info = info;
+        next.total_frames = next.source->totalFrames();
+        resetDecodeStream(next, 0);
+        for (size_t i = 0; i < kPrefillPeriods && decodeBlock(next); ++i) {
+        }
+        next_ready.store(true, std::memory_order_release);
+    }
+
+    /**
+     * 设置播放标志并唤醒解码线程，调用方持有 mutex
+     */
+    void setPlaying(bool value) {
+        if (value) {
+            {
+                std::lock_guard<std::mutex> lock(decode_mutex);
+                playing.store(true, std::memory_order_release);
+            }
+            decode_cv.notify_one();
+            output->resume();
+        } else {
+            {
+                // 输出线程可能在等解码线程，在 decode_mutex 内清除标志才不会错过通知
+                std::lock_guard<std::mutex> lock(decode_mutex);
+                playing.store(false, std::memory_order_release);
+            }
+            ready_cv.notify_all();
+            output->pause();
+        }
+    }
+
+    /**
+     * 当前位置（毫秒），可以在任意线程无锁调用
+     */
+    int position() const {
+        uint64_t frame = play_frame.load(std::memory_order_relaxed);
+        int ms = static_cast<int>(frame * 1000 / static_cast<uint64_t>(options.sampleRate));
+        return std::min(ms, duration.load(std::memory_order_relaxed));
+    }
+
+    /**
+     * 输出回调已经切换到下一首：更新当前文件和音频信息，通知订阅者
+     * @param switched 处理到的切换次数
+     */
+    void trackSwitched(uint64_t switched) {
+        std::string file;
+        AudioInfo info;
+        {
+            std::lock_guard<std::mutex> decodeLock(decode_mutex);
+            DecodeStream& current = activeStream();
+            file = current.file;
+            info = current.info;
+            next_requested = false;
+            switches_seen = switched;
+            // 上一首的数据源已经用完
+            idleStream().source.reset();
+        }
+        std::lock_guard<std::mutex> lock(mutex);
+        current_file = file;
+        audio_info = info;
+        events.publishTrackEnded();
+        events.publishTrackChanged(file);
+    }
+
+    /**
+     * 最后一帧播完且没有下一首：切到停止状态并通知订阅者
+     */
+    void finishTrack() {
+        std::lock_guard<std::mutex> lock(mutex);
+        // 取到结束标志之后可能已经有控制操作重置了数据流，或者下一首刚刚装好
+        DecodeStream& current = activeStream();
+        if (state.load(std::memory_order_relaxed) != PlayState::PLAYING ||
+            !current.done.load(std::memory_order_acquire) || current.ring.readAvailable() != 0 ||
+            next_ready.load(std::memory_order_acquire)) {
+            return;
+        }
+        state.store(PlayState::STOPPED, std::memory_order_relaxed);
+        setPlaying(false);
+        events.publishPosition(position());
+        events.publishState(PlayState::STOPPED);
+        events.publishTrackEnded();
+    }
+
+    void decoderLoop() {
+        // 第一次加载其他采样率的文件时不用现场计算滤波器组
+        prewarmResamplerFilterBanks(options.sampleRate, options.resamplerQuality);
+
+        auto halfPeriod = std::chrono::nanoseconds(
+            static_cast<int64_t>(options.periodFrames) * 500000000LL / options.sampleRate);
+        auto lastPosition = std::chrono::steady_clock::now();
+        uint64_t seenSwitches = 0;
+
+        std::unique_lock<std::mutex> lock(decode_mutex);
+        while (!should_stop) {
+            if (offline) {
+                ready_cv.notify_all();
+            }
+            auto hasWork = [this] { return should_stop || needNext() || needsDecode(); };
+            if (playing.load(std::memory_order_relaxed)) {
+                // 实时输出时输出回调不能加锁，也就不能唤醒这里；播放时按半个周期轮询缓冲区
+                decode_cv.wait_for(lock, halfPeriod, [&] {
+                    return hasWork() || switches.load(std::memory_order_acquire) != seenSwitches ||
+                           drained.load(std::memory_order_acquire);
+                });
+            } else {
+                decode_cv.wait(lock, [&] { return hasWork() || playing.load(std::memory_order_relaxed); });
+            }
+            if (should_stop) {
+                break;
+            }
+
+            fillStreams();
+            if (needNext()) {
+                prefetchNext(lock);
+                continue;
+            }
+            if (!playing.load(std::memory_order_relaxed)) {
+                continue;
+            }
+
+            lock.unlock();
+            auto now = std::chrono::steady_clock::now();
+            uint64_t switched = switches.load(std::memory_order_acquire);
+            if (switched != seenSwitches) {
+                seenSwitches = switched;
+                trackSwitched(switched);
+            } else if (drained.exchange(false, std::memory_order_acq_rel)) {
+                finishTrack();
+            } else if (now - lastPosition >= kPositionInterval) {
+                lastPosition = now;
+                events.publishPosition(position());
+            }
+            lock.lock();
         }
     }
 };
 
-AudioEngine::AudioEngine() : impl_(std::make_unique<Impl>()) {
-    impl_->playback_thread = std::thread([this] { impl_->playbackLoop(); });
+AudioEngine::AudioEngine(const AudioEngineOptions& options) : impl_(std::make_unique<Impl>(options)) {
+    Impl* impl = impl_.get();
+    impl_->output = std::make_unique<AudioOutput>(
+        options.sampleRate, options.channels, options.periodFrames,
+        createAudioSink(options.outputSink, options.outputPath, options.sampleRate, options.channels),
+        [impl](float* out, size_t frames) { return impl->render(out, frames); });
+    impl_->offline = !impl_->output->realtime();
+    impl_->decoder_thread = std::thread([impl] { impl->decoderLoop(); });
 }
 
 AudioEngine::~AudioEngine() {
-    impl_->should_stop = true;
-    impl_->cv.notify_one();
-    if (impl_->playback_thread.joinable()) {
-        impl_->playback_thread.join();
+    {
+        std::lock_guard<std::mutex> lock(impl_->decode_mutex);
+        impl_->should_stop = true;
     }
+    impl_->decode_cv.notify_one();
+    impl_->ready_cv.notify_all();
+    if (impl_->decoder_thread.joinable()) {
+        impl_->decoder_thread.join();
+    }
+    impl_->output.reset();
 }
 
 bool AudioEngine::load(const std::string& filePath) {
+    AudioInfo info;
+    std::unique_ptr<AudioSource> source = openSource(filePath, impl_->options, info);
+    if (!source) {
+        return false;
+    }
+
     std::lock_guard<std::mutex> lock(impl_->mutex);
-    
+
+    Impl::bump(impl_->loads);
+    impl_->setPlaying(false);
     impl_->current_file = filePath;
-    impl_->position = 0;
-    impl_->state = PlayState::STOPPED;
-    
-    // TODO: 使用 FFmpeg 加载文件并获取元数据
-    impl_->audio_info.duration = 180000;  // 模拟：3分钟
-    impl_->audio_info.title = "Sample Track";
-    impl_->audio_info.artist = "Unknown Artist";
-    
+    impl_->state.store(PlayState::STOPPED, std::memory_order_relaxed);
+    impl_->audio_info = info;
+    impl_->duration.store(info.duration, std::memory_order_relaxed);
+
+    {
+        std::lock_guard<std::mutex> decodeLock(impl_->decode_mutex);
+        DecodeStream& stream = impl_->activeStream();
+        stream.source = std::move(source);
+        stream.file = filePath;
+        stream.info = info;
+        stream.total_frames = stream.source->totalFrames();
+    }
+    impl_->resetStream(0);
+
     return true;
 }
 
 bool AudioEngine::play() {
     std::lock_guard<std::mutex> lock(impl_->mutex);
-    
+
     if (impl_->current_file.empty()) {
         return false;
     }
-    
-    impl_->state = PlayState::PLAYING;
-    impl_->cv.notify_one();
-    
-    if (state_callback_) {
-        state_callback_(PlayState::PLAYING);
+
+    // 上一次已经播到结尾，从头开始
+    DecodeStream& current = impl_->activeStream();
+    if (impl_->state.load(std::memory_order_relaxed) != PlayState::PLAYING &&
+        current.done.load(std::memory_order_acquire) && current.ring.readAvailable() == 0) {
+        impl_->resetStream(0);
     }
-    
+
+    impl_->state.store(PlayState::PLAYING, std::memory_order_relaxed);
+    impl_->setPlaying(true);
+
+    impl_->events.publishState(PlayState::PLAYING);
+
     return true;
 }
 
 bool AudioEngine::pause() {
     std::lock_guard<std::mutex> lock(impl_->mutex);
-    
-    if (impl_->state != PlayState::PLAYING) {
+
+    if (impl_->state.load(std::memory_order_relaxed) != PlayState::PLAYING) {
         return false;
     }
-    
-    impl_->state = PlayState::PAUSED;
-    
-    if (state_callback_) {
-        state_callback_(PlayState::PAUSED);
-    }
-    
+
+    impl_->state.store(PlayState::PAUSED, std::memory_order_relaxed);
+    impl_->setPlaying(false);
+
+    impl_->events.publishState(PlayState::PAUSED);
+
     return true;
 }
 
 bool AudioEngine::stop() {
     std::lock_guard<std::mutex> lock(impl_->mutex);
-    
-    impl_->state = PlayState::STOPPED;
-    impl_->position = 0;
-    
-    if (state_callback_) {
-        state_callback_(PlayState::STOPPED);
-    }
-    
+
+    impl_->state.store(PlayState::STOPPED, std::memory_order_relaxed);
+    impl_->setPlaying(false);
+    impl_->resetStream(0);
+
+    impl_->events.publishState(PlayState::STOPPED);
+
     return true;
 }
 
 bool AudioEngine::seek(int position) {
     std::lock_guard<std::mutex> lock(impl_->mutex);
-    
-    if (position < 0 || position > impl_->audio_info.duration) {
+
+    if (position < 0 || position > impl_->duration.load(std::memory_order_relaxed)) {
         return false;
     }
-    
-    impl_->position = position;
-    
-    if (position_callback_) {
-        position_callback_(position);
+
+    bool wasPlaying = impl_->state.load(std::memory_order_relaxed) == PlayState::PLAYING;
+    impl_->setPlaying(false);
+    impl_->resetStream(static_cast<uint64_t>(position) * static_cast<uint64_t>(impl_->options.sampleRate) / 1000);
+    if (wasPlaying) {
+        impl_->setPlaying(true);
     }
-    
+
+    impl_->events.publishPosition(position);
+
     return true;
 }
 
@@ -137,25 +847,79 @@ bool AudioEngine::setVolume(int volume) {
     if (volume < 0 || volume > 100) {
         return false;
     }
-    
+
     std::lock_guard<std::mutex> lock(impl_->mutex);
     impl_->volume = volume;
+    impl_->target_gain.store(volumeToGain(volume), std::memory_order_relaxed);
+    return true;
+}
+
+bool AudioEngine::setCrossfade(int durationMs, CrossfadeCurve curve) {
+    if (durationMs < 0 || durationMs > kMaxCrossfadeMs) {
+        return false;
+    }
+
+    {
+        // 预取的提前量随淡化时长变化，唤醒解码线程重新判断
+        std::lock_guard<std::mutex> lock(impl_->decode_mutex);
+        impl_->crossfade_frames.store(Impl::msToFrames(durationMs, impl_->options.sampleRate),
+                                      std::memory_order_relaxed);
+        impl_->crossfade_curve.store(curve, std::memory_order_relaxed);
+    }
+    impl_->decode_cv.notify_one();
+    return true;
+}
+
+bool AudioEngine::setNormalization(NormalizationMode mode, double targetLufs) {
+    if (!(targetLufs >= -30 && targetLufs <= -5)) {
+        return false;
+    }
+    impl_->normalization_target.store(static_cast<float>(targetLufs), std::memory_order_relaxed);
+    impl_->normalization_mode.store(mode, std::memory_order_relaxed);
     return true;
 }
 
+NormalizationMode AudioEngine::getNormalization(double& targetLufs) const {
+    targetLufs = impl_->normalization_target.load(std::memory_order_relaxed);
+    return impl_->normalization_mode.load(std::memory_order_relaxed);
+}
+
+bool AudioEngine::setEqualizer(const EqualizerSettings& settings) {
+    auto within = [](double value, double low, double high) { return value >= low && value <= high; };
+    double nyquist = impl_->options.sampleRate / 2.0;
+    if (settings.bands.size() > kMaxEqBands || !within(settings.preampDb, -24, 24) ||
+        !within(settings.limiterThresholdDb, -24, 0) || !within(settings.limiterReleaseMs, 1, 2000)) {
+        return false;
+    }
+    for (const EqBand& band : settings.bands) {
+        if (!(band.frequency > 0 && band.frequency < nyquist) || !within(band.gainDb, -24, 24) ||
+            !within(band.q, 0.1, 24)) {
+            return false;
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(impl_->mutex);
+    impl_->equalizer = settings;
+    impl_->dsp.publish(settings);
+    return true;
+}
+
+EqualizerSettings AudioEngine::getEqualizer() const {
+    std::lock_guard<std::mutex> lock(impl_->mutex);
+    return impl_->equalizer;
+}
+
 int AudioEngine::getVolume() const {
     std::lock_guard<std::mutex> lock(impl_->mutex);
     return impl_->volume;
 }
 
 int AudioEngine::getPosition() const {
-    std::lock_guard<std::mutex> lock(impl_->mutex);
-    return impl_->position;
+    return impl_->position();
 }
 
 PlayState AudioEngine::getState() const {
-    std::lock_guard<std::mutex> lock(impl_->mutex);
-    return impl_->state;
+    return impl_->state.load(std::memory_order_relaxed);
 }
 
 AudioInfo AudioEngine::getAudioInfo() const {
@@ -163,16 +927,47 @@ AudioInfo AudioEngine::getAudioInfo() const {
     return impl_->audio_info;
 }
 
-void AudioEngine::onPlayStateChanged(PlayStateChangedCallback callback) {
-    state_callback_ = callback;
+AudioEngineMetrics AudioEngine::getMetrics() const {
+    AudioEngineMetrics metrics;
+    metrics.loads = impl_->loads.load(std::memory_order_relaxed);
+    metrics.blocksDecoded = impl_->blocks_decoded.load(std::memory_order_relaxed);
+    metrics.underruns = impl_->underruns.load(std::memory_order_relaxed);
+    metrics.framesPlayed = impl_->frames_total.load(std::memory_order_relaxed);
+    metrics.gaplessTransitions = impl_->switches.load(std::memory_order_relaxed);
+    metrics.crossfades = impl_->crossfades.load(std::memory_order_relaxed);
+    metrics.decodeTime.merge(impl_->decode_time);
+    metrics.mixNanos = impl_->mix_nanos.load(std::memory_order_relaxed);
+    metrics.dspNanos = impl_->dsp_nanos.load(std::memory_order_relaxed);
+    metrics.sinkNanos = impl_->output->sinkNanos();
+    metrics.sinkFrames = impl_->output->framesWritten();
+    metrics.eventsDropped = impl_->events.dropped();
+    metrics.eventLatency.merge(impl_->events.latency());
+    return metrics;
+}
+
+void AudioEngine::setNextTrackProvider(NextTrackProvider provider) {
+    std::lock_guard<std::mutex> lock(impl_->decode_mutex);
+    impl_->next_provider = std::move(provider);
+}
+
+SubscriptionId AudioEngine::onPlayStateChanged(PlayStateChangedCallback callback) {
+    return impl_->events.subscribeState(std::move(callback));
+}
+
+SubscriptionId AudioEngine::onPositionChanged(PositionChangedCallback callback) {
+    return impl_->events.subscribePosition(std::move(callback));
+}
+
+SubscriptionId AudioEngine::onTrackEnded(TrackEndedCallback callback) {
+    return impl_->events.subscribeTrackEnded(std::move(callback));
 }
 
-void AudioEngine::onPositionChanged(PositionChangedCallback callback) {
-    position_callback_ = callback;
+SubscriptionId AudioEngine::onTrackChanged(TrackChangedCallback callback) {
+    return impl_->events.subscribeTrackChanged(std::move(callback));
 }
 
-void AudioEngine::onTrackEnded(TrackEndedCallback callback) {
-    track_ended_callback_ = callback;
+bool AudioEngine::unsubscribe(SubscriptionId id) {
+    return impl_->events.unsubscribe(id);
 }
 
 }  // namespace musicfree
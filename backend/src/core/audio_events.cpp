@@ -0,0 +1,226 @@
+#include "audio_events.h"
+#include <algorithm>
+
+namespace musicfree {
+
+AudioEventDispatcher::AudioEventDispatcher(size_t capacity) : subscribers_(std::make_shared<Subscribers>()) {
+    size_t size = 2;
+    while (size < capacity) {
+        size <<= 1;
+    }
+    slots_ = std::vector<Slot>(size);
+    mask_ = size - 1;
+    for (size_t i = 0; i < size; ++i) {
+        slots_[i].sequence.store(i, std::memory_order_relaxed);
+    }
+    thread_ = std::thread([this] { run(); });
+}
+
+AudioEventDispatcher::~AudioEventDispatcher() {
+    {
+        std::lock_guard<std::mutex> lock(wake_mutex_);
+        should_stop_ = true;
+    }
+    wake_cv_.notify_one();
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+}
+
+void AudioEventDispatcher::publishState(PlayState state) {
+    AudioEvent event;
+    event.type = AudioEventType::STATE_CHANGED;
+    event.state = state;
+    publish(std::move(event));
+}
+
+void AudioEventDispatcher::publishPosition(int position) {
+    // 位置事件会被下一条覆盖，队列积压过半时直接丢弃
+    uint64_t backlog = tail_.load(std::memory_order_relaxed) - head_.load(std::memory_order_relaxed);
+    if (backlog > (mask_ + 1) / 2) {
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    AudioEvent event;
+    event.type = AudioEventType::POSITION_CHANGED;
+    event.position = position;
+    publish(std::move(event));
+}
+
+void AudioEventDispatcher::publishTrackEnded() {
+    AudioEvent event;
+    event.type = AudioEventType::TRACK_ENDED;
+    publish(std::move(event));
+}
+
+void AudioEventDispatcher::publishTrackChanged(const std::string& filePath) {
+    AudioEvent event;
+    event.type = AudioEventType::TRACK_CHANGED;
+    event.filePath = filePath;
+    publish(std::move(event));
+}
+
+bool AudioEventDispatcher::publish(AudioEvent&& event) {
+    event.published = std::chrono::steady_clock::now();
+
+    // 抢到一个 sequence 等于自己位置的槽；槽还没被读走说明队列已满
+    uint64_t pos = tail_.load(std::memory_order_relaxed);
+    Slot* slot = nullptr;
+    for (;;) {
+        slot = &slots_[pos & mask_];
+        uint64_t sequence = slot->sequence.load(std::memory_order_acquire);
+        int64_t diff = static_cast<int64_t>(sequence - pos);
+        if (diff == 0) {
+            if (tail_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                break;
+            }
+        } else if (diff < 0) {
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        } else {
+            pos = tail_.load(std::memory_order_relaxed);
+        }
+    }
+    slot->event = std::move(event);
+    slot->sequence.store(pos + 1, std::memory_order_release);
+
+    // 与 run() 中的栅栏配对：要么这里看到分发线程在睡眠，要么分发线程睡前看到这个事件
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (sleeping_.load(std::memory_order_relaxed)) {
+        std::lock_guard<std::mutex> lock(wake_mutex_);
+        wake_cv_.notify_one();
+    }
+    return true;
+}
+
+bool AudioEventDispatcher::pop(AudioEvent& event) {
+    uint64_t pos = head_.load(std::memory_order_relaxed);
+    Slot& slot = slots_[pos & mask_];
+    if (slot.sequence.load(std::memory_order_acquire) != pos + 1) {
+        return false;
+    }
+    event = std::move(slot.event);
+    slot.sequence.store(pos + mask_ + 1, std::memory_order_release);
+    head_.store(pos + 1, std::memory_order_relaxed);
+    return true;
+}
+
+bool AudioEventDispatcher::empty() const {
+    uint64_t pos = head_.load(std::memory_order_relaxed);
+    return slots_[pos & mask_].sequence.load(std::memory_order_acquire) != pos + 1;
+}
+
+void AudioEventDispatcher::deliver(const AudioEvent& event) {
+    std::shared_ptr<const Subscribers> subscribers;
+    {
+        std::lock_guard<std::mutex> lock(subscribers_mutex_);
+        subscribers = subscribers_;
+    }
+
+    std::lock_guard<std::mutex> lock(delivery_mutex_);
+    switch (event.type) {
+        case AudioEventType::STATE_CHANGED:
+            for (const auto& entry : subscribers->state) {
+                entry.second(event.state);
+            }
+            break;
+        case AudioEventType::POSITION_CHANGED:
+            for (const auto& entry : subscribers->position) {
+                entry.second(event.position);
+            }
+            break;
+        case AudioEventType::TRACK_ENDED:
+            for (const auto& entry : subscribers->trackEnded) {
+                entry.second();
+            }
+            break;
+        case AudioEventType::TRACK_CHANGED:
+            for (const auto& entry : subscribers->trackChanged) {
+                entry.second(event.filePath);
+            }
+            break;
+    }
+}
+
+void AudioEventDispatcher::run() {
+    AudioEvent event;
+    for (;;) {
+        while (pop(event)) {
+            latency_.record(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - event.published).count()));
+            deliver(event);
+        }
+
+        std::unique_lock<std::mutex> lock(wake_mutex_);
+        sleeping_.store(true, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        wake_cv_.wait(lock, [this] { return should_stop_ || !empty(); });
+        sleeping_.store(false, std::memory_order_relaxed);
+        if (should_stop_) {
+            break;
+        }
+    }
+}
+
+template <typename Update>
+SubscriptionId AudioEventDispatcher::updateSubscribers(Update update) {
+    std::lock_guard<std::mutex> lock(subscribers_mutex_);
+    auto next = std::make_shared<Subscribers>(*subscribers_);
+    SubscriptionId id = next_id_++;
+    update(*next, id);
+    subscribers_ = std::move(next);
+    return id;
+}
+
+SubscriptionId AudioEventDispatcher::subscribeState(PlayStateChangedCallback callback) {
+    return updateSubscribers([&](Subscribers& subscribers, SubscriptionId id) {
+        subscribers.state.emplace_back(id, std::move(callback));
+    });
+}
+
+SubscriptionId AudioEventDispatcher::subscribePosition(PositionChangedCallback callback) {
+    return updateSubscribers([&](Subscribers& subscribers, SubscriptionId id) {
+        subscribers.position.emplace_back(id, std::move(callback));
+    });
+}
+
+SubscriptionId AudioEventDispatcher::subscribeTrackEnded(TrackEndedCallback callback) {
+    return updateSubscribers([&](Subscribers& subscribers, SubscriptionId id) {
+        subscribers.trackEnded.emplace_back(id, std::move(callback));
+    });
+}
+
+SubscriptionId AudioEventDispatcher::subscribeTrackChanged(TrackChangedCallback callback) {
+    return updateSubscribers([&](Subscribers& subscribers, SubscriptionId id) {
+        subscribers.trackChanged.emplace_back(id, std::move(callback));
+    });
+}
+
+bool AudioEventDispatcher::unsubscribe(SubscriptionId id) {
+    bool found = false;
+    {
+        std::lock_guard<std::mutex> lock(subscribers_mutex_);
+        auto next = std::make_shared<Subscribers>(*subscribers_);
+        auto erase = [&](auto& list) {
+            auto it = std::remove_if(list.begin(), list.end(), [id](const auto& entry) { return entry.first == id; });
+            found = found || it != list.end();
+            list.erase(it, list.end());
+        };
+        erase(next->state);
+        erase(next->position);
+        erase(next->trackEnded);
+        erase(next->trackChanged);
+        if (!found) {
+            return false;
+        }
+        subscribers_ = std::move(next);
+    }
+
+    // 分发线程可能正拿着旧的列表调用它，等这一次分发结束
+    if (std::this_thread::get_id() != thread_.get_id()) {
+        std::lock_guard<std::mutex> lock(delivery_mutex_);
+    }
+    return true;
+}
+
+}  // namespace musicfree
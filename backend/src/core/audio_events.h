@@ -0,0 +1,135 @@
+#ifndef MUSICFREE_AUDIO_EVENTS_H
+#define MUSICFREE_AUDIO_EVENTS_H
+
+#include "../include/audio_engine.h"
+#include "../include/metrics.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace musicfree {
+
+// 引擎事件类型
+enum class AudioEventType {
+    STATE_CHANGED = 0,
+    POSITION_CHANGED = 1,
+    TRACK_ENDED = 2,
+    TRACK_CHANGED = 3
+};
+
+/**
+ * 引擎事件
+ */
+struct AudioEvent {
+    AudioEventType type = AudioEventType::STATE_CHANGED;
+    PlayState state = PlayState::STOPPED;  // STATE_CHANGED
+    int position = 0;                      // POSITION_CHANGED
+    std::string filePath;                  // TRACK_CHANGED
+    std::chrono::steady_clock::time_point published;
+};
+
+/**
+ * 引擎事件分发器
+ *
+ * 引擎的各个线程（控制操作、解码线程）把事件发布到有界的无锁多生产者队列，
+ * 分发线程按发布顺序取出事件，依次调用该类型的所有订阅者。
+ *   - publish() 不加锁、不等待订阅者；只有分发线程在睡眠时才短暂持有唤醒用的锁
+ *   - 队列满时丢弃事件并计数；位置事件是高频的可覆盖事件，队列过半就丢弃，为其他事件留出空间
+ *   - 订阅者列表写时复制：注册和取消在任意线程（包括回调中）都安全，分发时不持有列表的锁
+ * 析构时停止分发线程，队列中还没分发的事件直接丢弃。
+ */
+class AudioEventDispatcher {
+public:
+    /**
+     * 创建分发器并启动分发线程
+     * @param capacity 队列容量（向上取整到 2 的幂）
+     */
+    explicit AudioEventDispatcher(size_t capacity = 1024);
+    ~AudioEventDispatcher();
+
+    // 禁止拷贝
+    AudioEventDispatcher(const AudioEventDispatcher&) = delete;
+    AudioEventDispatcher& operator=(const AudioEventDispatcher&) = delete;
+
+    // 发布事件，可以在任意线程调用，不加锁
+    void publishState(PlayState state);
+    void publishPosition(int position);
+    void publishTrackEnded();
+    void publishTrackChanged(const std::string& filePath);
+
+    // 订阅事件
+    SubscriptionId subscribeState(PlayStateChangedCallback callback);
+    SubscriptionId subscribePosition(PositionChangedCallback callback);
+    SubscriptionId subscribeTrackEnded(TrackEndedCallback callback);
+    SubscriptionId subscribeTrackChanged(TrackChangedCallback callback);
+
+    /**
+     * 取消订阅
+     * 在分发线程之外调用时，返回后该回调不会再被调用（正在进行的调用已经结束），
+     * 所以调用方不能持有回调里要等的锁
+     * @return 找到该订阅返回 true
+     */
+    bool unsubscribe(SubscriptionId id);
+
+    // 队列满而丢弃的事件数
+    uint64_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+    // 发布到开始分发的延迟（纳秒），只由分发线程写入
+    const LatencyHistogram& latency() const { return latency_; }
+
+private:
+    struct Slot {
+        std::atomic<uint64_t> sequence{0};
+        AudioEvent event;
+    };
+
+    // 订阅者列表，发布后不再修改
+    struct Subscribers {
+        std::vector<std::pair<SubscriptionId, PlayStateChangedCallback>> state;
+        std::vector<std::pair<SubscriptionId, PositionChangedCallback>> position;
+        std::vector<std::pair<SubscriptionId, TrackEndedCallback>> trackEnded;
+        std::vector<std::pair<SubscriptionId, TrackChangedCallback>> trackChanged;
+    };
+
+    bool publish(AudioEvent&& event);
+    bool pop(AudioEvent& event);
+    bool empty() const;
+    void deliver(const AudioEvent& event);
+    void run();
+
+    template <typename Update>
+    SubscriptionId updateSubscribers(Update update);
+
+    // 无锁队列：每个槽的 sequence 表示它可以被第几个生产者写入 / 被消费者读取
+    std::vector<Slot> slots_;
+    size_t mask_;
+    std::atomic<uint64_t> tail_{0};  // 下一个要写入的位置，生产者竞争
+    std::atomic<uint64_t> head_{0};  // 下一个要读取的位置，只由分发线程写入
+    std::atomic<uint64_t> dropped_{0};
+    LatencyHistogram latency_;
+
+    // 分发线程没有事件时睡在这里
+    std::mutex wake_mutex_;
+    std::condition_variable wake_cv_;
+    std::atomic<bool> sleeping_{false};
+    bool should_stop_ = false;
+
+    std::mutex subscribers_mutex_;
+    std::shared_ptr<const Subscribers> subscribers_;
+    SubscriptionId next_id_ = 1;
+
+    // 分发线程在分发一个事件期间持有，unsubscribe() 借此等正在进行的调用结束
+    std::mutex delivery_mutex_;
+    std::thread thread_;
+};
+
+}  // namespace musicfree
+
+#endif  // MUSICFREE_AUDIO_EVENTS_H
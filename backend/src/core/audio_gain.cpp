@@ -0,0 +1,385 @@
+#include "audio_gain.h"
+#include <algorithm>
+#include <cmath>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define MUSICFREE_AUDIO_GAIN_X86 1
+#endif
+
+namespace musicfree {
+
+namespace {
+
+// 指数斜坡端点的下限（-60 dB），0 无法按倍数逼近
+constexpr float kExponentialFloor = 0.001f;
+
+// 指数斜坡逐帧累乘，每隔这么多帧用 pow 重新定位一次，限制累积的舍入误差；
+// 标量和向量版本在相同的帧上定位，结果只差段内累乘次数不同带来的舍入
+constexpr size_t kExponentialSegment = 256;
+
+inline void scale(float& sample, float gain) {
+    sample *= gain;
+}
+
+inline void scale(int16_t& sample, float gain) {
+    float value = std::nearbyint(static_cast<float>(sample) * gain);
+    sample = static_cast<int16_t>(std::min(std::max(value, -32768.0f), 32767.0f));
+}
+
+/**
+ * 标量线性斜坡，firstFrame 是 samples 第一帧在整个斜坡中的序号
+ * 与向量版本同样按 start + step * 帧序号 计算，两者结果一致
+ */
+template <typename Sample>
+void linearScalar(Sample* samples, size_t frames, int channels, float start, float step, size_t firstFrame) {
+    for (size_t f = 0; f < frames; ++f) {
+        float gain = start + step * static_cast<float>(firstFrame + f);
+        Sample* frame = samples + f * static_cast<size_t>(channels);
+        for (int c = 0; c < channels; ++c) {
+            scale(frame[c], gain);
+        }
+    }
+}
+
+template <typename Sample>
+void exponentialScalar(Sample* samples, size_t frames, int channels, float start, float ratio, size_t firstFrame) {
+    float gain = start * std::pow(ratio, static_cast<float>(firstFrame));
+    for (size_t f = 0; f < frames; ++f) {
+        size_t index = firstFrame + f;
+        if (index % kExponentialSegment == 0) {
+            gain = start * std::pow(ratio, static_cast<float>(index));
+        }
+        Sample* frame = samples + f * static_cast<size_t>(channels);
+        for (int c = 0; c < channels; ++c) {
+            scale(frame[c], gain);
+        }
+        gain *= ratio;
+    }
+}
+
+#ifdef MUSICFREE_AUDIO_GAIN_X86
+
+/**
+ * 向量内各采样所在帧相对向量起点的偏移：第 j 个采样属于第 j / channels 帧
+ */
+void laneFrames(float* offsets, int width, int channels) {
+    for (int j = 0; j < width; ++j) {
+        offsets[j] = static_cast<float>(j / channels);
+    }
+}
+
+// ===== SSE4.1：每个向量 4 个 float =====
+
+struct LinearSse {
+    __m128 start, step, frame, advance;
+
+    __attribute__((target("sse4.1")))
+    void init(float startGain, float stepGain, int channels) {
+        float offsets[4];
+        laneFrames(offsets, 4, channels);
+        start = _mm_set1_ps(startGain);
+        step = _mm_set1_ps(stepGain);
+        frame = _mm_loadu_ps(offsets);
+        advance = _mm_set1_ps(static_cast<float>(4 / channels));
+    }
+
+    __attribute__((target("sse4.1")))
+    __m128 next() {
+        __m128 gain = _mm_add_ps(start, _mm_mul_ps(step, frame));
+        frame = _mm_add_ps(frame, advance);
+        return gain;
+    }
+};
+
+struct ExponentialSse {
+    __m128 gain, advance;
+
+    __attribute__((target("sse4.1")))
+    void init(float start, const float* laneRatios, float advanceRatio) {
+        gain = _mm_mul_ps(_mm_set1_ps(start), _mm_loadu_ps(laneRatios));
+        advance = _mm_set1_ps(advanceRatio);
+    }
+
+    __attribute__((target("sse4.1")))
+    __m128 next() {
+        __m128 current = gain;
+        gain = _mm_mul_ps(gain, advance);
+        return current;
+    }
+};
+
+template <typename Gen>
+__attribute__((target("sse4.1")))
+size_t kernelSse(float* samples, size_t frames, int channels, Gen& gen) {
+    size_t framesPerVector = 4 / static_cast<size_t>(channels);
+    size_t vectors = frames / framesPerVector;
+    for (size_t i = 0; i < vectors; ++i) {
+        __m128 v = _mm_loadu_ps(samples + i * 4);
+        _mm_storeu_ps(samples + i * 4, _mm_mul_ps(v, gen.next()));
+    }
+    return vectors * framesPerVector;
+}
+
+template <typename Gen>
+__attribute__((target("sse4.1")))
+size_t kernelSse(int16_t* samples, size_t frames, int channels, Gen& gen) {
+    // 每次 8 个 int16：符号扩展成两组 int32 转 float，相乘后转回并饱和打包
+    size_t framesPerBlock = 8 / static_cast<size_t>(channels);
+    size_t blocks = frames / framesPerBlock;
+    for (size_t i = 0; i < blocks; ++i) {
+        __m128i* p = reinterpret_cast<__m128i*>(samples + i * 8);
+        __m128i v = _mm_loadu_si128(p);
+        __m128 lo = _mm_cvtepi32_ps(_mm_cvtepi16_epi32(v));
+        __m128 hi = _mm_cvtepi32_ps(_mm_cvtepi16_epi32(_mm_srli_si128(v, 8)));
+        lo = _mm_mul_ps(lo, gen.next());
+        hi = _mm_mul_ps(hi, gen.next());
+        _mm_storeu_si128(p, _mm_packs_epi32(_mm_cvtps_epi32(lo), _mm_cvtps_epi32(hi)));
+    }
+    return blocks * framesPerBlock;
+}
+
+template <typename Sample>
+__attribute__((target("sse4.1")))
+size_t linearSse(Sample* samples, size_t frames, int channels, float start, float step) {
+    LinearSse gen;
+    gen.init(start, step, channels);
+    return kernelSse(samples, frames, channels, gen);
+}
+
+template <typename Sample>
+__attribute__((target("sse4.1")))
+size_t exponentialSse(Sample* samples, size_t frames, int channels, float start, float ratio) {
+    float laneRatios[4];
+    laneFrames(laneRatios, 4, channels);
+    for (float& lane : laneRatios) {
+        lane = std::pow(ratio, lane);
+    }
+    float advance = std::pow(ratio, static_cast<float>(4 / channels));
+
+    size_t done = 0;
+    while (done < frames) {
+        size_t n = std::min(kExponentialSegment, frames - done);
+        ExponentialSse gen;
+        gen.init(start * std::pow(ratio, static_cast<float>(done)), laneRatios, advance);
+        size_t processed = kernelSse(samples + done * static_cast<size_t>(channels), n, channels, gen);
+        done += processed;
+        if (processed < n) {
+            break;
+        }
+    }
+    return done;
+}
+
+// ===== AVX2：每个向量 8 个 float =====
+
+struct LinearAvx2 {
+    __m256 start, step, frame, advance;
+
+    __attribute__((target("avx2")))
+    void init(float startGain, float stepGain, int channels) {
+        float offsets[8];
+        laneFrames(offsets, 8, channels);
+        start = _mm256_set1_ps(startGain);
+        step = _mm256_set1_ps(stepGain);
+        frame = _mm256_loadu_ps(offsets);
+        advance = _mm256_set1_ps(static_cast<float>(8 / channels));
+    }
+
+    __attribute__((target("avx2")))
+    __m256 next() {
+        __m256 gain = _mm256_add_ps(start, _mm256_mul_ps(step, frame));
+        frame = _mm256_add_ps(frame, advance);
+        return gain;
+    }
+};
+
+struct ExponentialAvx2 {
+    __m256 gain, advance;
+
+    __attribute__((target("avx2")))
+    void init(float start, const float* laneRatios, float advanceRatio) {
+        gain = _mm256_mul_ps(_mm256_set1_ps(start), _mm256_loadu_ps(laneRatios));
+        advance = _mm256_set1_ps(advanceRatio);
+    }
+
+    __attribute__((target("avx2")))
+    __m256 next() {
+        __m256 current = gain;
+        gain = _mm256_mul_ps(gain, advance);
+        return current;
+    }
+};
+
+template <typename Gen>
+__attribute__((target("avx2")))
+size_t kernelAvx2(float* samples, size_t frames, int channels, Gen& gen) {
+    size_t framesPerVector = 8 / static_cast<size_t>(channels);
+    size_t vectors = frames / framesPerVector;
+    for (size_t i = 0; i < vectors; ++i) {
+        __m256 v = _mm256_loadu_ps(samples + i * 8);
+        _mm256_storeu_ps(samples + i * 8, _mm256_mul_ps(v, gen.next()));
+    }
+    return vectors * framesPerVector;
+}
+
+template <typename Gen>
+__attribute__((target("avx2")))
+size_t kernelAvx2(int16_t* samples, size_t frames, int channels, Gen& gen) {
+    // 每次 16 个 int16；packs 在两个 128 位通道内分别打包，结果按 64 位重排回原顺序
+    size_t framesPerBlock = 16 / static_cast<size_t>(channels);
+    size_t blocks = frames / framesPerBlock;
+    for (size_t i = 0; i < blocks; ++i) {
+        __m256i* p = reinterpret_cast<__m256i*>(samples + i * 16);
+        __m256i v = _mm256_loadu_si256(p);
+        __m256 lo = _mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(_mm256_castsi256_si128(v)));
+        __m256 hi = _mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(_mm256_extracti128_si256(v, 1)));
+        lo = _mm256_mul_ps(lo, gen.next());
+        hi = _mm256_mul_ps(hi, gen.next());
+        __m256i packed = _mm256_packs_epi32(_mm256_cvtps_epi32(lo), _mm256_cvtps_epi32(hi));
+        _mm256_storeu_si256(p, _mm256_permute4x64_epi64(packed, 0xD8));
+    }
+    return blocks * framesPerBlock;
+}
+
+template <typename Sample>
+__attribute__((target("avx2")))
+size_t linearAvx2(Sample* samples, size_t frames, int channels, float start, float step) {
+    LinearAvx2 gen;
+    gen.init(start, step, channels);
+    return kernelAvx2(samples, frames, channels, gen);
+}
+
+template <typename Sample>
+__attribute__((target("avx2")))
+size_t exponentialAvx2(Sample* samples, size_t frames, int channels, float start, float ratio) {
+    float laneRatios[8];
+    laneFrames(laneRatios, 8, channels);
+    for (float& lane : laneRatios) {
+        lane = std::pow(ratio, lane);
+    }
+    float advance = std::pow(ratio, static_cast<float>(8 / channels));
+
+    size_t done = 0;
+    while (done < frames) {
+        size_t n = std::min(kExponentialSegment, frames - done);
+        ExponentialAvx2 gen;
+        gen.init(start * std::pow(ratio, static_cast<float>(done)), laneRatios, advance);
+        size_t processed = kernelAvx2(samples + done * static_cast<size_t>(channels), n, channels, gen);
+        done += processed;
+        if (processed < n) {
+            break;
+        }
+    }
+    return done;
+}
+
+#endif  // MUSICFREE_AUDIO_GAIN_X86
+
+template <typename Sample>
+void dispatchLinear(Sample* samples, size_t frames, int channels, float start, float step, SimdLevel level) {
+    size_t done = 0;
+#ifdef MUSICFREE_AUDIO_GAIN_X86
+    if (level == SimdLevel::AVX2 && 8 % channels == 0) {
+        done = linearAvx2(samples, frames, channels, start, step);
+    } else if (level >= SimdLevel::SSE42 && 4 % channels == 0) {
+        done = linearSse(samples, frames, channels, start, step);
+    }
+#else
+    (void)level;
+#endif
+    linearScalar(samples + done * static_cast<size_t>(channels), frames - done, channels, start, step, done);
+}
+
+template <typename Sample>
+void dispatchExponential(Sample* samples, size_t frames, int channels, float start, float ratio, SimdLevel level) {
+    size_t done = 0;
+#ifdef MUSICFREE_AUDIO_GAIN_X86
+    if (level == SimdLevel::AVX2 && 8 % channels == 0) {
+        done = exponentialAvx2(samples, frames, channels, start, ratio);
+    } else if (level >= SimdLevel::SSE42 && 4 % channels == 0) {
+        done = exponentialSse(samples, frames, channels, start, ratio);
+    }
+#else
+    (void)level;
+#endif
+    exponentialScalar(samples + done * static_cast<size_t>(channels), frames - done, channels, start, ratio, done);
+}
+
+}  // namespace
+
+void applyGainLinear(float* samples, size_t frames, int channels, float start, float step, SimdLevel level) {
+    dispatchLinear(samples, frames, channels, start, step, level);
+}
+
+void applyGainLinear(int16_t* samples, size_t frames, int channels, float start, float step, SimdLevel level) {
+    dispatchLinear(samples, frames, channels, start, step, level);
+}
+
+void applyGainExponential(float* samples, size_t frames, int channels, float start, float ratio, SimdLevel level) {
+    dispatchExponential(samples, frames, channels, start, ratio, level);
+}
+
+void applyGainExponential(int16_t* samples, size_t frames, int channels, float start, float ratio,
+                          SimdLevel level) {
+    dispatchExponential(samples, frames, channels, start, ratio, level);
+}
+
+// ===== GainStage =====
+
+GainStage::GainStage(int channels, float gain, SimdLevel level)
+    : channels_(channels), level_(std::min(level, detectSimdLevel())), gain_(gain), target_(gain) {}
+
+void GainStage::setTarget(float gain, size_t rampFrames, GainCurve curve) {
+    target_ = gain;
+    curve_ = curve;
+    if (rampFrames == 0 || gain == gain_) {
+        gain_ = gain;
+        remaining_ = 0;
+        return;
+    }
+
+    if (curve == GainCurve::LINEAR) {
+        step_ = (gain - gain_) / static_cast<float>(rampFrames);
+    } else {
+        float from = std::max(gain_, kExponentialFloor);
+        float to = std::max(gain, kExponentialFloor);
+        gain_ = from;
+        step_ = std::pow(to / from, 1.0f / static_cast<float>(rampFrames));
+    }
+    remaining_ = rampFrames;
+}
+
+template <typename Sample>
+void GainStage::run(Sample* samples, size_t frames) {
+    if (remaining_ > 0) {
+        size_t n = std::min(frames, remaining_);
+        if (curve_ == GainCurve::LINEAR) {
+            applyGainLinear(samples, n, channels_, gain_, step_, level_);
+            gain_ += step_ * static_cast<float>(n);
+        } else {
+            applyGainExponential(samples, n, channels_, gain_, step_, level_);
+            gain_ *= std::pow(step_, static_cast<float>(n));
+        }
+        remaining_ -= n;
+        if (remaining_ == 0) {
+            gain_ = target_;
+        }
+        samples += n * static_cast<size_t>(channels_);
+        frames -= n;
+    }
+
+    if (frames > 0 && gain_ != 1.0f) {
+        applyGainLinear(samples, frames, channels_, gain_, 0.0f, level_);
+    }
+}
+
+void GainStage::process(float* samples, size_t frames) {
+    run(samples, frames);
+}
+
+void GainStage::process(int16_t* samples, size_t frames) {
+    run(samples, frames);
+}
+
+}  // namespace musicfree
@@ -0,0 +1,74 @@
+#ifndef MUSICFREE_AUDIO_GAIN_H
+#define MUSICFREE_AUDIO_GAIN_H
+
+#include "../include/audio_engine.h"
+#include "simd_level.h"
+#include <cstddef>
+#include <cstdint>
+
+namespace musicfree {
+
+/**
+ * 增益内核（交错采样，原地处理）
+ *
+ * 第 n 帧（从 0 起）的增益：
+ *   - 线性：start + step * n
+ *   - 指数：start * ratio^n
+ * 同一帧的各声道乘以相同的增益；恒定增益即 step = 0。
+ * int16 结果四舍五入（就近取偶）并饱和到 [-32768, 32767]。
+ *
+ * SIMD 版本每次处理一个向量（SSE 4 个 / AVX2 8 个 float），要求声道数整除向量宽度，
+ * 否则整块退回标量实现；不足一个向量的尾部也用标量处理。
+ * 指数斜坡逐帧（向量里逐个向量）累乘，每 256 帧用 pow 重新定位，
+ * 各指令集之间只有 float 舍入级别的差异。
+ */
+void applyGainLinear(float* samples, size_t frames, int channels, float start, float step, SimdLevel level);
+void applyGainLinear(int16_t* samples, size_t frames, int channels, float start, float step, SimdLevel level);
+void applyGainExponential(float* samples, size_t frames, int channels, float start, float ratio, SimdLevel level);
+void applyGainExponential(int16_t* samples, size_t frames, int channels, float start, float ratio,
+                          SimdLevel level);
+
+/**
+ * 音量增益级
+ *
+ * 目标增益变化时，在指定的帧数内按斜坡过渡到新增益，避免直接跳变产生的咔嗒声和
+ * 阶梯噪声（zipper noise）。只由一个线程（输出线程）调用，不加锁、不分配内存。
+ */
+class GainStage {
+public:
+    explicit GainStage(int channels, float gain = 1.0f, SimdLevel level = detectSimdLevel());
+
+    /**
+     * 设置目标增益
+     * @param gain 目标增益（线性倍数）
+     * @param rampFrames 过渡帧数，0 表示立即生效
+     * @param curve 过渡曲线；指数斜坡的端点不低于 -60 dB，目标为 0 时斜坡结束后再置 0
+     */
+    void setTarget(float gain, size_t rampFrames, GainCurve curve);
+
+    /**
+     * 对一段交错采样应用增益，并推进斜坡
+     */
+    void process(float* samples, size_t frames);
+    void process(int16_t* samples, size_t frames);
+
+    float gain() const { return gain_; }
+    float target() const { return target_; }
+    bool ramping() const { return remaining_ > 0; }
+
+private:
+    template <typename Sample>
+    void run(Sample* samples, size_t frames);
+
+    int channels_;
+    SimdLevel level_;
+    float gain_;
+    float target_;
+    GainCurve curve_ = GainCurve::LINEAR;
+    float step_ = 0.0f;   // 线性：每帧增量；指数：每帧倍数
+    size_t remaining_ = 0;
+};
+
+}  // namespace musicfree
+
+#endif  // MUSICFREE_AUDIO_GAIN_H
@@ -0,0 +1,160 @@
+#include "audio_mixer.h"
+#include <algorithm>
+#include <cmath>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define MUSICFREE_AUDIO_MIXER_X86 1
+#endif
+
+namespace musicfree {
+
+namespace {
+
+constexpr float kHalfPi = 1.57079632679489661923f;
+
+// 等功率曲线按折线逼近的段长（帧）；段内最大误差约 (π/2)²/8 / (length/256)²，淡化 1 秒以上时低于 -90 dB
+constexpr size_t kCurveSegment = 256;
+
+void mixScalar(float* out, const float* in, size_t frames, int channels, float outStart, float outStep,
+               float inStart, float inStep, size_t firstFrame) {
+    for (size_t f = 0; f < frames; ++f) {
+        float index = static_cast<float>(firstFrame + f);
+        float outGain = outStart + outStep * index;
+        float inGain = inStart + inStep * index;
+        size_t base = f * static_cast<size_t>(channels);
+        for (int c = 0; c < channels; ++c) {
+            out[base + c] = out[base + c] * outGain + in[base + c] * inGain;
+        }
+    }
+}
+
+#ifdef MUSICFREE_AUDIO_MIXER_X86
+
+void laneFrames(float* offsets, int width, int channels) {
+    for (int j = 0; j < width; ++j) {
+        offsets[j] = static_cast<float>(j / channels);
+    }
+}
+
+__attribute__((target("sse4.1")))
+size_t mixSse(float* out, const float* in, size_t frames, int channels, float outStart, float outStep,
+              float inStart, float inStep) {
+    float offsets[4];
+    laneFrames(offsets, 4, channels);
+    __m128 frame = _mm_loadu_ps(offsets);
+    __m128 advance = _mm_set1_ps(static_cast<float>(4 / channels));
+    __m128 o0 = _mm_set1_ps(outStart), os = _mm_set1_ps(outStep);
+    __m128 i0 = _mm_set1_ps(inStart), is = _mm_set1_ps(inStep);
+
+    size_t framesPerVector = 4 / static_cast<size_t>(channels);
+    size_t vectors = frames / framesPerVector;
+    for (size_t i = 0; i < vectors; ++i) {
+        __m128 outGain = _mm_add_ps(o0, _mm_mul_ps(os, frame));
+        __m128 inGain = _mm_add_ps(i0, _mm_mul_ps(is, frame));
+        __m128 a = _mm_mul_ps(_mm_loadu_ps(out + i * 4), outGain);
+        __m128 b = _mm_mul_ps(_mm_loadu_ps(in + i * 4), inGain);
+        _mm_storeu_ps(out + i * 4, _mm_add_ps(a, b));
+        frame = _mm_add_ps(frame, advance);
+    }
+    return vectors * framesPerVector;
+}
+
+__attribute__((target("avx2")))
+size_t mixAvx2(float* out, const float* in, size_t frames, int channels, float outStart, float outStep,
+               float inStart, float inStep) {
+    float offsets[8];
+    laneFrames(offsets, 8, channels);
+    __m256 frame = _mm256_loadu_ps(offsets);
+    __m256 advance = _mm256_set1_ps(static_cast<float>(8 / channels));
+    __m256 o0 = _mm256_set1_ps(outStart), os = _mm256_set1_ps(outStep);
+    __m256 i0 = _mm256_set1_ps(inStart), is = _mm256_set1_ps(inStep);
+
+    size_t framesPerVector = 8 / static_cast<size_t>(channels);
+    size_t vectors = frames / framesPerVector;
+    for (size_t i = 0; i < vectors; ++i) {
+        __m256 outGain = _mm256_add_ps(o0, _mm256_mul_ps(os, frame));
+        __m256 inGain = _mm256_add_ps(i0, _mm256_mul_ps(is, frame));
+        __m256 a = _mm256_mul_ps(_mm256_loadu_ps(out + i * 8), outGain);
+        __m256 b = _mm256_mul_ps(_mm256_loadu_ps(in + i * 8), inGain);
+        _mm256_storeu_ps(out + i * 8, _mm256_add_ps(a, b));
+        frame = _mm256_add_ps(frame, advance);
+    }
+    return vectors * framesPerVector;
+}
+
+#endif  // MUSICFREE_AUDIO_MIXER_X86
+
+}  // namespace
+
+void mixCrossfade(float* out, const float* in, size_t frames, int channels, float outStart, float outStep,
+                  float inStart, float inStep, SimdLevel level) {
+    size_t done = 0;
+#ifdef MUSICFREE_AUDIO_MIXER_X86
+    if (level == SimdLevel::AVX2 && 8 % channels == 0) {
+        done = mixAvx2(out, in, frames, channels, outStart, outStep, inStart, inStep);
+    } else if (level >= SimdLevel::SSE42 && 4 % channels == 0) {
+        done = mixSse(out, in, frames, channels, outStart, outStep, inStart, inStep);
+    }
+#else
+    (void)level;
+#endif
+    size_t offset = done * static_cast<size_t>(channels);
+    mixScalar(out + offset, in + offset, frames - done, channels, outStart, outStep, inStart, inStep, done);
+}
+
+// ===== Crossfader =====
+
+Crossfader::Crossfader(int channels, SimdLevel level)
+    : channels_(channels), level_(std::min(level, detectSimdLevel())) {}
+
+float Crossfader::curveGain(CrossfadeCurve curve, float x, bool fadeIn) {
+    x = std::min(std::max(x, 0.0f), 1.0f);
+    if (curve == CrossfadeCurve::LINEAR) {
+        return fadeIn ? x : 1.0f - x;
+    }
+    return fadeIn ? std::sin(x * kHalfPi) : std::cos(x * kHalfPi);
+}
+
+void Crossfader::start(size_t fadeFrames, CrossfadeCurve curve) {
+    curve_ = curve;
+    length_ = fadeFrames;
+    position_ = 0;
+    active_ = fadeFrames > 0;
+}
+
+void Crossfader::reset() {
+    active_ = false;
+    length_ = 0;
+    position_ = 0;
+}
+
+void Crossfader::mix(float* out, const float* in, size_t frames) {
+    size_t channels = static_cast<size_t>(channels_);
+    float length = static_cast<float>(length_);
+    size_t done = 0;
+    while (done < frames && position_ < length_) {
+        // 段的边界对齐到淡化起点的整数倍，每段在端点上取曲线的精确值
+        size_t segmentEnd = std::min((position_ / kCurveSegment + 1) * kCurveSegment, length_);
+        size_t n = std::min(segmentEnd - position_, frames - done);
+        float x0 = static_cast<float>(position_) / length;
+        float x1 = static_cast<float>(segmentEnd) / length;
+        float span = static_cast<float>(segmentEnd - position_);
+        float outStart = curveGain(curve_, x0, false);
+        float inStart = curveGain(curve_, x0, true);
+        float outStep = (curveGain(curve_, x1, false) - outStart) / span;
+        float inStep = (curveGain(curve_, x1, true) - inStart) / span;
+
+        mixCrossfade(out + done * channels, in + done * channels, n, channels_, outStart, outStep, inStart,
+                     inStep, level_);
+        position_ += n;
+        done += n;
+    }
+
+    // 淡化已经结束：只剩淡入的一路
+    if (done < frames) {
+        std::copy(in + done * channels, in + frames * channels, out + done * channels);
+    }
+}
+
+}  // namespace musicfree
@@ -0,0 +1,74 @@
+#ifndef MUSICFREE_AUDIO_MIXER_H
+#define MUSICFREE_AUDIO_MIXER_H
+
+#include "../include/audio_engine.h"
+#include "simd_level.h"
+#include <cstddef>
+#include <cstdint>
+
+namespace musicfree {
+
+/**
+ * 交叉淡化混音内核（float32 交错采样，结果写回 out）
+ *
+ *   out[n] = out[n] * (outStart + outStep * n) + in[n] * (inStart + inStep * n)
+ *
+ * n 是帧序号（从 0 起），同一帧的各声道使用相同的增益。
+ * SIMD 版本的要求和尾部处理与增益内核相同；各指令集按同一公式、同样的运算顺序计算，
+ * 结果与标量实现逐位一致。
+ */
+void mixCrossfade(float* out, const float* in, size_t frames, int channels, float outStart, float outStep,
+                  float inStart, float inStep, SimdLevel level);
+
+/**
+ * 两路流的交叉淡化器
+ *
+ * 在 fadeFrames 帧内把淡出的一路（当前曲目的尾部）和淡入的一路（下一首的开头）按曲线混合。
+ * 等功率曲线用每 256 帧一段的折线逼近（段端点上精确），每段调用一次向量化的线性混音内核。
+ * 只由一个线程（输出线程）调用，不加锁、不分配内存。
+ */
+class Crossfader {
+public:
+    explicit Crossfader(int channels, SimdLevel level = detectSimdLevel());
+
+    /**
+     * 开始一次淡化
+     * @param fadeFrames 淡化总帧数
+     * @param curve 淡化曲线
+     */
+    void start(size_t fadeFrames, CrossfadeCurve curve);
+
+    /**
+     * 混合一段数据并推进淡化进度；超过淡化长度的部分只保留淡入的一路
+     * @param out 淡出的一路，结果写回这里
+     * @param in 淡入的一路
+     */
+    void mix(float* out, const float* in, size_t frames);
+
+    /**
+     * 结束（或放弃）当前淡化
+     */
+    void reset();
+
+    bool active() const { return active_; }
+    size_t position() const { return position_; }
+    size_t length() const { return length_; }
+
+    /**
+     * 淡化曲线在 x（0 到 1）处的增益
+     * @param fadeIn true 取淡入的一路，否则取淡出的一路
+     */
+    static float curveGain(CrossfadeCurve curve, float x, bool fadeIn);
+
+private:
+    int channels_;
+    SimdLevel level_;
+    CrossfadeCurve curve_ = CrossfadeCurve::EQUAL_POWER;
+    size_t length_ = 0;
+    size_t position_ = 0;
+    bool active_ = false;
+};
+
+}  // namespace musicfree
+
+#endif  // MUSICFREE_AUDIO_MIXER_H
@@ -0,0 +1,93 @@
+#include "audio_output.h"
+
+namespace musicfree {
+
+AudioOutput::AudioOutput(int sampleRate, int channels, size_t periodFrames, std::unique_ptr<AudioSink> sink,
+                         RenderCallback render)
+    : sample_rate_(static_cast<uint64_t>(sampleRate)),
+      period_frames_(periodFrames),
+      period_(std::chrono::nanoseconds(static_cast<int64_t>(periodFrames) * 1000000000LL / sampleRate)),
+      sink_(std::move(sink)),
+      realtime_(sink_->realtime()),
+      render_(std::move(render)),
+      buffer_(periodFrames * static_cast<size_t>(channels)) {
+    thread_ = std::thread([this] { run(); });
+}
+
+AudioOutput::~AudioOutput() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        should_stop_ = true;
+    }
+    cv_.notify_all();
+    if (thread_.joinable()) {
+        thread_.join();
+    }
+    sink_->close();
+}
+
+void AudioOutput::resume() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    running_ = true;
+    cv_.notify_all();
+}
+
+void AudioOutput::pause() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    running_ = false;
+    cv_.notify_all();
+    cv_.wait(lock, [this] { return parked_ || should_stop_; });
+}
+
+void AudioOutput::run() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    // 第 n 个周期的到期时间由 base + n 个周期的帧数换算得到，而不是逐个周期累加，
+    // 周期时长除不尽的零头不会累积成漂移
+    auto base = std::chrono::steady_clock::now();
+    uint64_t framesSinceBase = 0;
+    while (!should_stop_) {
+        if (!running_) {
+            parked_ = true;
+            cv_.notify_all();
+            cv_.wait(lock, [this] { return running_ || should_stop_; });
+            parked_ = false;
+            base = std::chrono::steady_clock::now();
+            framesSinceBase = 0;
+            continue;
+        }
+
+        lock.unlock();
+        size_t frames = render_(buffer_.data(), period_frames_);
+        auto begin = std::chrono::steady_clock::now();
+        size_t written = realtime_ ? period_frames_ : frames;
+        sink_->write(buffer_.data(), written);
+        frames_written_.store(frames_written_.load(std::memory_order_relaxed) + written, std::memory_order_relaxed);
+        sink_nanos_.store(sink_nanos_.load(std::memory_order_relaxed) +
+                              static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                  std::chrono::steady_clock::now() - begin).count()),
+                          std::memory_order_relaxed);
+        lock.lock();
+
+        if (!realtime_) {
+            if (frames == 0) {
+                cv_.wait_for(lock, period_, [this] { return !running_ || should_stop_; });
+            }
+            continue;
+        }
+
+        framesSinceBase += period_frames_;
+        auto deadline = base + std::chrono::nanoseconds(framesSinceBase * 1000000000ULL / sample_rate_);
+        auto now = std::chrono::steady_clock::now();
+        if (now - deadline > period_) {
+            // 落后超过一个周期说明设备已经播空，从现在重新计时
+            base = now;
+            framesSinceBase = 0;
+            deadline = now;
+        }
+        cv_.wait_until(lock, deadline, [this] { return !running_ || should_stop_; });
+    }
+    parked_ = true;
+    cv_.notify_all();
+}
+
+}  // namespace musicfree
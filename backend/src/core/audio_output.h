@@ -0,0 +1,98 @@
+#ifndef MUSICFREE_AUDIO_OUTPUT_H
+#define MUSICFREE_AUDIO_OUTPUT_H
+
+#include "audio_sink.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace musicfree {
+
+/**
+ * 音频输出
+ *
+ * 输出线程每次调用 render 回调填满一个周期（period）的输出缓冲区，再交给输出端（AudioSink）。
+ * 回调在锁外执行；实时输出端下回调必须无锁、不分配内存。
+ *   - 实时输出端：按设备采样率定时拉取，到期时间按已输出的帧数换算，长时间运行也不会相对系统时钟漂移
+ *   - 非实时输出端：不等待，渲染完一个周期马上渲染下一个；回调没有产出数据（曲目已经播完）时
+ *     才等一个周期，避免空转
+ * 线程只在周期之间的等待中持有内部的锁，pause() / resume() 借此随时停下或恢复线程。
+ */
+class AudioOutput {
+public:
+    /**
+     * 渲染回调
+     * @param out 交错的 float32 采样，frames * channels 个
+     * @param frames 帧数
+     * @return 有效的帧数，其后是填充的静音；非实时输出端只写入有效的部分
+     */
+    using RenderCallback = std::function<size_t(float* out, size_t frames)>;
+
+    /**
+     * 创建输出并启动输出线程（初始为暂停状态）
+     * @param sampleRate 采样率
+     * @param channels 声道数
+     * @param periodFrames 每个周期的帧数
+     * @param sink 已经打开的输出端，析构时关闭
+     * @param render 渲染回调
+     */
+    AudioOutput(int sampleRate, int channels, size_t periodFrames, std::unique_ptr<AudioSink> sink,
+                RenderCallback render);
+    ~AudioOutput();
+
+    // 禁止拷贝
+    AudioOutput(const AudioOutput&) = delete;
+    AudioOutput& operator=(const AudioOutput&) = delete;
+
+    /**
+     * 开始（继续）拉取音频
+     */
+    void resume();
+
+    /**
+     * 暂停拉取音频
+     * 返回时输出线程已经停在周期之间，不会再调用 render，直到下一次 resume()
+     */
+    void pause();
+
+    size_t periodFrames() const { return period_frames_; }
+
+    // 输出端是否按采样率实时消费
+    bool realtime() const { return realtime_; }
+
+    // 写入输出端的累计耗时（纳秒）
+    uint64_t sinkNanos() const { return sink_nanos_.load(std::memory_order_relaxed); }
+
+    // 交给输出端的累计帧数（实时输出端每次整个周期，含填充的静音）
+    uint64_t framesWritten() const { return frames_written_.load(std::memory_order_relaxed); }
+
+private:
+    void run();
+
+    uint64_t sample_rate_;
+    size_t period_frames_;
+    std::chrono::nanoseconds period_;
+    std::unique_ptr<AudioSink> sink_;
+    bool realtime_;
+    RenderCallback render_;
+    std::vector<float> buffer_;
+    std::atomic<uint64_t> sink_nanos_{0};  // 只由输出线程写入
+    std::atomic<uint64_t> frames_written_{0};
+
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    bool running_ = false;
+    bool parked_ = true;
+    bool should_stop_ = false;
+    std::thread thread_;
+};
+
+}  // namespace musicfree
+
+#endif  // MUSICFREE_AUDIO_OUTPUT_H
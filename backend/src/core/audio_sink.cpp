@@ -0,0 +1,133 @@
+#include "audio_sink.h"
+#include <algorithm>
+#include <iostream>
+
+namespace musicfree {
+
+namespace {
+
+// WAV 文件头：RIFF + fmt（18 字节，WAVE_FORMAT_IEEE_FLOAT）+ fact + data
+constexpr size_t kWavHeaderBytes = 58;
+constexpr long kRiffSizeOffset = 4;
+constexpr long kFactFramesOffset = 46;
+constexpr long kDataSizeOffset = 54;
+constexpr uint16_t kWaveFloat = 3;
+
+void putLe16(uint8_t* p, uint16_t value) {
+    p[0] = static_cast<uint8_t>(value);
+    p[1] = static_cast<uint8_t>(value >> 8);
+}
+
+void putLe32(uint8_t* p, uint32_t value) {
+    for (int i = 0; i < 4; ++i) {
+        p[i] = static_cast<uint8_t>(value >> (8 * i));
+    }
+}
+
+// 超过 4 GB 的文件长度字段写满，读取方按文件实际长度截断
+uint32_t clampSize(uint64_t value) {
+    return static_cast<uint32_t>(std::min<uint64_t>(value, 0xFFFFFFFFu));
+}
+
+}  // namespace
+
+WavFileSink::WavFileSink(std::string path) : path_(std::move(path)) {}
+
+WavFileSink::~WavFileSink() {
+    close();
+}
+
+bool WavFileSink::open(int sampleRate, int channels) {
+    file_ = std::fopen(path_.c_str(), "wb");
+    if (!file_) {
+        std::cerr << "Failed to create output file: " << path_ << std::endl;
+        return false;
+    }
+    channels_ = channels;
+    data_bytes_ = 0;
+    failed_ = false;
+
+    uint16_t blockAlign = static_cast<uint16_t>(channels * 4);
+    uint8_t header[kWavHeaderBytes] = {};
+    std::copy_n("RIFF", 4, header);
+    std::copy_n("WAVE", 4, header + 8);
+    std::copy_n("fmt ", 4, header + 12);
+    putLe32(header + 16, 18);
+    putLe16(header + 20, kWaveFloat);
+    putLe16(header + 22, static_cast<uint16_t>(channels));
+    putLe32(header + 24, static_cast<uint32_t>(sampleRate));
+    putLe32(header + 28, static_cast<uint32_t>(sampleRate) * blockAlign);
+    putLe16(header + 32, blockAlign);
+    putLe16(header + 34, 32);
+    putLe16(header + 36, 0);
+    std::copy_n("fact", 4, header + 38);
+    putLe32(header + 42, 4);
+    std::copy_n("data", 4, header + 50);
+    putLe32(header + kRiffSizeOffset, static_cast<uint32_t>(kWavHeaderBytes - 8));
+    if (std::fwrite(header, 1, sizeof(header), file_) != sizeof(header)) {
+        std::cerr << "Failed to write output file: " << path_ << std::endl;
+        std::fclose(file_);
+        file_ = nullptr;
+        return false;
+    }
+    return true;
+}
+
+void WavFileSink::write(const float* samples, size_t frames) {
+    if (!file_ || failed_ || frames == 0) {
+        return;
+    }
+    // 采样按主机字节序写出，目前支持的平台都是小端
+    size_t count = frames * static_cast<size_t>(channels_);
+    if (std::fwrite(samples, sizeof(float), count, file_) != count) {
+        // 只报告一次，之后的数据丢弃，不让输出线程反复报错
+        std::cerr << "Failed to write output file: " << path_ << std::endl;
+        failed_ = true;
+        return;
+    }
+    data_bytes_ += count * sizeof(float);
+}
+
+void WavFileSink::close() {
+    if (!file_) {
+        return;
+    }
+    uint8_t field[4];
+    uint64_t frames = channels_ > 0 ? data_bytes_ / (static_cast<uint64_t>(channels_) * 4) : 0;
+    bool ok = true;
+    putLe32(field, clampSize(kWavHeaderBytes - 8 + data_bytes_));
+    ok = ok && std::fseek(file_, kRiffSizeOffset, SEEK_SET) == 0 && std::fwrite(field, 1, 4, file_) == 4;
+    putLe32(field, clampSize(frames));
+    ok = ok && std::fseek(file_, kFactFramesOffset, SEEK_SET) == 0 && std::fwrite(field, 1, 4, file_) == 4;
+    putLe32(field, clampSize(data_bytes_));
+    ok = ok && std::fseek(file_, kDataSizeOffset, SEEK_SET) == 0 && std::fwrite(field, 1, 4, file_) == 4;
+    if (std::fclose(file_) != 0 || !ok) {
+        std::cerr << "Failed to write output file: " << path_ << std::endl;
+    }
+    file_ = nullptr;
+}
+
+std::unique_ptr<AudioSink> createAudioSink(OutputSinkType type, const std::string& path, int sampleRate,
+                                           int channels) {
+    std::unique_ptr<AudioSink> sink;
+    switch (type) {
+        case OutputSinkType::NULL_SINK:
+            sink = std::make_unique<NullSink>();
+            break;
+        case OutputSinkType::WAV_FILE:
+            sink = std::make_unique<WavFileSink>(path);
+            break;
+        case OutputSinkType::DEVICE:
+        default:
+            sink = std::make_unique<DeviceSink>();
+            break;
+    }
+    if (!sink->open(sampleRate, channels)) {
+        std::cerr << "Failed to open audio sink, discarding output instead" << std::endl;
+        sink = std::make_unique<NullSink>();
+        sink->open(sampleRate, channels);
+    }
+    return sink;
+}
+
+}  // namespace musicfree
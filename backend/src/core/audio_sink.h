@@ -0,0 +1,112 @@
+#ifndef MUSICFREE_AUDIO_SINK_H
+#define MUSICFREE_AUDIO_SINK_H
+
+#include "../include/audio_engine.h"
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+
+namespace musicfree {
+
+/**
+ * 输出端：接收输出线程渲染好的周期
+ *
+ * 实时输出端（声卡）决定节奏，输出线程按采样率定时拉取；
+ * 非实时输出端（丢弃、写文件）不限速，输出线程渲染完一个周期马上渲染下一个，
+ * 整条解码 → 混音 → 增益管线以 CPU 能达到的最快速度运行。
+ * write() 在输出线程上调用。
+ */
+class AudioSink {
+public:
+    virtual ~AudioSink() = default;
+
+    /**
+     * 打开输出端
+     * @param sampleRate 采样率
+     * @param channels 声道数
+     * @return 成功返回 true
+     */
+    virtual bool open(int sampleRate, int channels) = 0;
+
+    /**
+     * 写入一段音频
+     * @param samples 交错的 float32 采样，frames * channels 个
+     * @param frames 帧数
+     */
+    virtual void write(const float* samples, size_t frames) = 0;
+
+    /**
+     * 关闭输出端，写完所有数据
+     */
+    virtual void close() = 0;
+
+    /**
+     * 是否按采样率实时消费
+     */
+    virtual bool realtime() const = 0;
+};
+
+/**
+ * 声卡输出：目前还没有接入声卡，数据直接丢弃，只保留设备的节奏
+ */
+class DeviceSink : public AudioSink {
+public:
+    bool open(int, int) override { return true; }
+    void write(const float*, size_t) override {}
+    void close() override {}
+    bool realtime() const override { return true; }
+};
+
+/**
+ * 丢弃所有数据，不限速
+ */
+class NullSink : public AudioSink {
+public:
+    bool open(int, int) override { return true; }
+    void write(const float*, size_t frames) override { frames_ += frames; }
+    void close() override {}
+    bool realtime() const override { return false; }
+
+    uint64_t frames() const { return frames_; }
+
+private:
+    uint64_t frames_ = 0;
+};
+
+/**
+ * 写入 WAV 文件（IEEE float32），不限速
+ * 打开时先写长度为 0 的文件头，关闭时回填 RIFF 和 data 块的长度
+ */
+class WavFileSink : public AudioSink {
+public:
+    explicit WavFileSink(std::string path);
+    ~WavFileSink() override;
+
+    bool open(int sampleRate, int channels) override;
+    void write(const float* samples, size_t frames) override;
+    void close() override;
+    bool realtime() const override { return false; }
+
+private:
+    std::string path_;
+    FILE* file_ = nullptr;
+    int channels_ = 0;
+    uint64_t data_bytes_ = 0;
+    bool failed_ = false;
+};
+
+/**
+ * 按配置创建并打开输出端；文件打不开时退回丢弃输出端
+ * @param type 输出端类型
+ * @param path WAV_FILE 的输出文件
+ * @param sampleRate 采样率
+ * @param channels 声道数
+ */
+std::unique_ptr<AudioSink> createAudioSink(OutputSinkType type, const std::string& path, int sampleRate,
+                                           int channels);
+
+}  // namespace musicfree
+
+#endif  // MUSICFREE_AUDIO_SINK_H
@@ -0,0 +1,22 @@
+#include "audio_source.h"
+#include <algorithm>
+#include <cstring>
+
+namespace musicfree {
+
+size_t SilenceSource::read(float* out, size_t frames) {
+    size_t n = static_cast<size_t>(std::min<uint64_t>(frames, total_frames_ - position_));
+    std::memset(out, 0, n * static_cast<size_t>(channels_) * sizeof(float));
+    position_ += n;
+    return n;
+}
+
+bool SilenceSource::seek(uint64_t frame) {
+    if (frame > total_frames_) {
+        return false;
+    }
+    position_ = frame;
+    return true;
+}
+
+}  // namespace musicfree
@@ -0,0 +1,64 @@
+#ifndef MUSICFREE_AUDIO_SOURCE_H
+#define MUSICFREE_AUDIO_SOURCE_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace musicfree {
+
+/**
+ * 解码后的 PCM 数据源（float32 交错采样）
+ * 只由解码线程访问；控制操作（加载、跳转）在解码线程空闲时调用
+ */
+class AudioSource {
+public:
+    virtual ~AudioSource() = default;
+
+    virtual int sampleRate() const = 0;
+    virtual int channels() const = 0;
+
+    /**
+     * 总帧数
+     */
+    virtual uint64_t totalFrames() const = 0;
+
+    /**
+     * 读取（解码）后续的帧
+     * @param out 输出缓冲区，至少 frames * channels() 个采样
+     * @param frames 最多读取的帧数
+     * @return 实际读取的帧数，少于 frames 表示已到结尾
+     */
+    virtual size_t read(float* out, size_t frames) = 0;
+
+    /**
+     * 跳转
+     * @param frame 目标帧
+     * @return 成功返回 true
+     */
+    virtual bool seek(uint64_t frame) = 0;
+};
+
+/**
+ * 静音数据源：还没有解码器的格式用它占位，时长取自元数据
+ */
+class SilenceSource : public AudioSource {
+public:
+    SilenceSource(int sampleRate, int channels, uint64_t totalFrames)
+        : sample_rate_(sampleRate), channels_(channels), total_frames_(totalFrames) {}
+
+    int sampleRate() const override { return sample_rate_; }
+    int channels() const override { return channels_; }
+    uint64_t totalFrames() const override { return total_frames_; }
+    size_t read(float* out, size_t frames) override;
+    bool seek(uint64_t frame) override;
+
+private:
+    int sample_rate_;
+    int channels_;
+    uint64_t total_frames_;
+    uint64_t position_ = 0;
+};
+
+}  // namespace musicfree
+
+#endif  // MUSICFREE_AUDIO_SOURCE_H
@@ -0,0 +1,44 @@
+#include "compressed_file_source.h"
+
+namespace musicfree {
+
+namespace {
+
+// 跳转后对新位置预读的字节数
+constexpr size_t kSeekReadahead = 256 * 1024;
+
+uint64_t toOutputFrames(const SeekIndex& index, int sampleRate) {
+    if (index.sampleRate <= 0) {
+        return 0;
+    }
+    return index.totalSamples * static_cast<uint64_t>(sampleRate) / static_cast<uint64_t>(index.sampleRate);
+}
+
+}  // namespace
+
+CompressedFileSource::CompressedFileSource(std::unique_ptr<MappedFile> file, SeekIndex index, int sampleRate,
+                                           int channels)
+    : SilenceSource(sampleRate, channels, toOutputFrames(index, sampleRate)),
+      file_(std::move(file)),
+      index_(std::move(index)),
+      output_rate_(sampleRate) {
+    SeekPoint start = index_.find(0);
+    stream_offset_ = start.offset;
+}
+
+bool CompressedFileSource::seek(uint64_t frame) {
+    if (!SilenceSource::seek(frame)) {
+        return false;
+    }
+    // 输出帧换算成流的采样位置（还没有重采样时两者的采样率可能不同）
+    uint64_t sample = frame * static_cast<uint64_t>(index_.sampleRate) / static_cast<uint64_t>(output_rate_);
+    SeekPoint point = index_.find(sample);
+    stream_offset_ = point.offset;
+    pending_discard_ = sample - point.sample;
+    if (file_) {
+        file_->adviseWillNeed(static_cast<size_t>(point.offset), kSeekReadahead);
+    }
+    return true;
+}
+
+}  // namespace musicfree
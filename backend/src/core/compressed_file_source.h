@@ -0,0 +1,48 @@
+#ifndef MUSICFREE_COMPRESSED_FILE_SOURCE_H
+#define MUSICFREE_COMPRESSED_FILE_SOURCE_H
+
+#include "audio_source.h"
+#include "mapped_file.h"
+#include "seek_index.h"
+#include <memory>
+
+namespace musicfree {
+
+/**
+ * 压缩文件（MP3 / FLAC / Ogg）数据源
+ *
+ * 解码器还没有接入，读出的仍是静音，总帧数取自跳转表（精确到采样）。
+ * 跳转时用跳转表二分定位到目标之前的帧并对该位置发起预读；解码器接入后
+ * 从 streamOffset() 开始解码、丢弃 pendingDiscard() 个采样即可精确到采样。
+ */
+class CompressedFileSource : public SilenceSource {
+public:
+    /**
+     * @param file 已映射的文件
+     * @param index 文件的跳转表
+     * @param sampleRate 输出采样率
+     * @param channels 输出声道数
+     */
+    CompressedFileSource(std::unique_ptr<MappedFile> file, SeekIndex index, int sampleRate, int channels);
+
+    bool seek(uint64_t frame) override;
+
+    const SeekIndex& seekIndex() const { return index_; }
+
+    // 下一次解码的起始字节偏移（帧或 Ogg 页的开头）
+    uint64_t streamOffset() const { return stream_offset_; }
+
+    // 从 streamOffset() 解码后需要丢弃的采样数（以流的采样率计）
+    uint64_t pendingDiscard() const { return pending_discard_; }
+
+private:
+    std::unique_ptr<MappedFile> file_;
+    SeekIndex index_;
+    int output_rate_;
+    uint64_t stream_offset_ = 0;
+    uint64_t pending_discard_ = 0;
+};
+
+}  // namespace musicfree
+
+#endif  // MUSICFREE_COMPRESSED_FILE_SOURCE_H
@@ -0,0 +1,138 @@
+#include "fft.h"
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define MUSICFREE_FFT_X86 1
+#endif
+
+namespace musicfree {
+
+namespace {
+
+constexpr double kPi = 3.14159265358979323846;
+constexpr size_t kLanes = FftBatch::kLanes;
+
+/**
+ * 标量内核：逐级蝶形，每个蝶形处理 8 路
+ *   t = b·w，b' = a - t，a' = a + t
+ */
+void butterfliesScalar(float* re, float* im, size_t n, const float* cosTable, const float* sinTable) {
+    for (size_t half = 1, step = n / 2; half < n; half <<= 1, step >>= 1) {
+        for (size_t start = 0; start < n; start += half * 2) {
+            for (size_t j = 0; j < half; ++j) {
+                float wr = cosTable[j * step], wi = sinTable[j * step];
+                float* ar = re + (start + j) * kLanes;
+                float* ai = im + (start + j) * kLanes;
+                float* br = ar + half * kLanes;
+                float* bi = ai + half * kLanes;
+                for (size_t l = 0; l < kLanes; ++l) {
+                    float tr = br[l] * wr - bi[l] * wi;
+                    float ti = br[l] * wi + bi[l] * wr;
+                    br[l] = ar[l] - tr;
+                    bi[l] = ai[l] - ti;
+                    ar[l] = ar[l] + tr;
+                    ai[l] = ai[l] + ti;
+                }
+            }
+        }
+    }
+}
+
+#ifdef MUSICFREE_FFT_X86
+
+__attribute__((target("sse4.1")))
+void butterfliesSse(float* re, float* im, size_t n, const float* cosTable, const float* sinTable) {
+    for (size_t half = 1, step = n / 2; half < n; half <<= 1, step >>= 1) {
+        for (size_t start = 0; start < n; start += half * 2) {
+            for (size_t j = 0; j < half; ++j) {
+                __m128 wr = _mm_set1_ps(cosTable[j * step]), wi = _mm_set1_ps(sinTable[j * step]);
+                float* ar = re + (start + j) * kLanes;
+                float* ai = im + (start + j) * kLanes;
+                float* br = ar + half * kLanes;
+                float* bi = ai + half * kLanes;
+                for (size_t l = 0; l < kLanes; l += 4) {
+                    __m128 xr = _mm_loadu_ps(br + l), xi = _mm_loadu_ps(bi + l);
+                    __m128 tr = _mm_sub_ps(_mm_mul_ps(xr, wr), _mm_mul_ps(xi, wi));
+                    __m128 ti = _mm_add_ps(_mm_mul_ps(xr, wi), _mm_mul_ps(xi, wr));
+                    __m128 yr = _mm_loadu_ps(ar + l), yi = _mm_loadu_ps(ai + l);
+                    _mm_storeu_ps(br + l, _mm_sub_ps(yr, tr));
+                    _mm_storeu_ps(bi + l, _mm_sub_ps(yi, ti));
+                    _mm_storeu_ps(ar + l, _mm_add_ps(yr, tr));
+                    _mm_storeu_ps(ai + l, _mm_add_ps(yi, ti));
+                }
+            }
+        }
+    }
+}
+
+__attribute__((target("avx2")))
+void butterfliesAvx2(float* re, float* im, size_t n, const float* cosTable, const float* sinTable) {
+    for (size_t half = 1, step = n / 2; half < n; half <<= 1, step >>= 1) {
+        for (size_t start = 0; start < n; start += half * 2) {
+            for (size_t j = 0; j < half; ++j) {
+                __m256 wr = _mm256_set1_ps(cosTable[j * step]), wi = _mm256_set1_ps(sinTable[j * step]);
+                float* ar = re + (start + j) * kLanes;
+                float* ai = im + (start + j) * kLanes;
+                float* br = ar + half * kLanes;
+                float* bi = ai + half * kLanes;
+                __m256 xr = _mm256_loadu_ps(br), xi = _mm256_loadu_ps(bi);
+                __m256 tr = _mm256_sub_ps(_mm256_mul_ps(xr, wr), _mm256_mul_ps(xi, wi));
+                __m256 ti = _mm256_add_ps(_mm256_mul_ps(xr, wi), _mm256_mul_ps(xi, wr));
+                __m256 yr = _mm256_loadu_ps(ar), yi = _mm256_loadu_ps(ai);
+                _mm256_storeu_ps(br, _mm256_sub_ps(yr, tr));
+                _mm256_storeu_ps(bi, _mm256_sub_ps(yi, ti));
+                _mm256_storeu_ps(ar, _mm256_add_ps(yr, tr));
+                _mm256_storeu_ps(ai, _mm256_add_ps(yi, ti));
+            }
+        }
+    }
+}
+
+#endif
+
+}  // namespace
+
+FftBatch::FftBatch(size_t size, SimdLevel level)
+    : size_(size), level_(std::min(level, detectSimdLevel())), cos_(size / 2), sin_(size / 2) {
+    for (size_t j = 0; j < size / 2; ++j) {
+        double angle = -2.0 * kPi * static_cast<double>(j) / static_cast<double>(size);
+        cos_[j] = static_cast<float>(std::cos(angle));
+        sin_[j] = static_cast<float>(std::sin(angle));
+    }
+    size_t bits = 0;
+    while ((static_cast<size_t>(1) << bits) < size) {
+        ++bits;
+    }
+    for (size_t i = 0; i < size; ++i) {
+        size_t reversed = 0;
+        for (size_t b = 0; b < bits; ++b) {
+            reversed |= ((i >> b) & 1) << (bits - 1 - b);
+        }
+        if (i < reversed) {
+            swaps_.emplace_back(static_cast<uint32_t>(i), static_cast<uint32_t>(reversed));
+        }
+    }
+}
+
+void FftBatch::transform(float* re, float* im) const {
+    for (const auto& swap : swaps_) {
+        std::swap_ranges(re + swap.first * kLanes, re + (swap.first + 1) * kLanes, re + swap.second * kLanes);
+        std::swap_ranges(im + swap.first * kLanes, im + (swap.first + 1) * kLanes, im + swap.second * kLanes);
+    }
+#ifdef MUSICFREE_FFT_X86
+    if (level_ == SimdLevel::AVX2) {
+        butterfliesAvx2(re, im, size_, cos_.data(), sin_.data());
+        return;
+    }
+    if (level_ == SimdLevel::SSE42) {
+        butterfliesSse(re, im, size_, cos_.data(), sin_.data());
+        return;
+    }
+#endif
+    butterfliesScalar(re, im, size_, cos_.data(), sin_.data());
+}
+
+}  // namespace musicfree
@@ -0,0 +1,50 @@
+#ifndef MUSICFREE_FFT_H
+#define MUSICFREE_FFT_H
+
+#include "simd_level.h"
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace musicfree {
+
+/**
+ * 成批的复数 FFT（基 2，时间抽取，float32）
+ *
+ * 一次变换 kLanes 个等长的序列，数据按 [点][路] 交错存放：第 k 个点第 l 路在下标 k * kLanes + l。
+ * 同一个蝶形的旋转因子对各路相同，向量化沿“路”的方向，不需要重排或 gather：
+ * AVX2 一次处理 8 路，SSE 两个寄存器各 4 路。
+ * 各版本按相同顺序分别做乘法和加法（不用 FMA），结果与标量逐位相同。
+ * 旋转因子和位反转表在构造时计算，transform() 不分配内存。
+ */
+class FftBatch {
+public:
+    static constexpr size_t kLanes = 8;
+
+    /**
+     * @param size 点数，2 的幂且不小于 2
+     * @param level 使用的指令集（不超过 CPU 支持的）
+     */
+    explicit FftBatch(size_t size, SimdLevel level = detectSimdLevel());
+
+    size_t size() const { return size_; }
+
+    /**
+     * 原地正变换 X[k] = Σ x[n]·e^(-2πikn/N)，不归一化
+     * @param re 实部，size * kLanes
+     * @param im 虚部，size * kLanes
+     */
+    void transform(float* re, float* im) const;
+
+private:
+    size_t size_;
+    SimdLevel level_;
+    std::vector<float> cos_;  // 旋转因子 e^(-2πij/N) 的实部，j < N / 2
+    std::vector<float> sin_;  // 虚部
+    std::vector<std::pair<uint32_t, uint32_t>> swaps_;  // 位反转需要交换的点对
+};
+
+}  // namespace musicfree
+
+#endif  // MUSICFREE_FFT_H
@@ -0,0 +1,270 @@
+#include "../include/loudness_analyzer.h"
+#include "../include/metadata_cache.h"
+#include "audio_source.h"
+#include "loudness_meter.h"
+#include "pcm_file_source.h"
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <dirent.h>
+#include <sys/stat.h>
+
+namespace musicfree {
+
+namespace {
+
+// 每次从数据源读取的帧数
+constexpr size_t kBlockFrames = 4096;
+
+// 按播放时的布局测量：引擎输出立体声，单声道复制到两个声道
+constexpr int kChannels = 2;
+
+// 静音的峰值记为 -200 dBTP
+constexpr double kMinPeak = 1e-10;
+
+const char* const kAudioExtensions[] = {"wav", "wave", "aif", "aiff", "aifc", "pcm", "raw",
+                                        "mp3", "flac", "ogg", "oga", "opus", "m4a", "aac"};
+
+double peakDb(double peak) {
+    return 20.0 * std::log10(std::max(peak, kMinPeak));
+}
+
+bool hasAudioExtension(const std::string& name) {
+    size_t dot = name.rfind('.');
+    if (dot == std::string::npos) {
+        return false;
+    }
+    std::string extension = name.substr(dot + 1);
+    std::transform(extension.begin(), extension.end(), extension.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    for (const char* candidate : kAudioExtensions) {
+        if (extension == candidate) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * 递归列出目录下的音频文件
+ * 跟随指向目录的符号链接，但每个目录（设备号 + inode）只进入一次，链接成环时不会无限递归
+ * @param visited 已经进入过的目录
+ */
+void listDirectory(const std::string& directory, std::set<std::pair<dev_t, ino_t>>& visited,
+                   std::vector<std::string>& files) {
+    struct stat self;
+    if (stat(directory.c_str(), &self) != 0 || !visited.emplace(self.st_dev, self.st_ino).second) {
+        return;
+    }
+    DIR* dir = opendir(directory.c_str());
+    if (dir == nullptr) {
+        return;
+    }
+    while (dirent* entry = readdir(dir)) {
+        std::string name = entry->d_name;
+        if (name == "." || name == "..") {
+            continue;
+        }
+        std::string path = directory + "/" + name;
+        struct stat st;
+        if (stat(path.c_str(), &st) != 0) {
+            continue;
+        }
+        if (S_ISDIR(st.st_mode)) {
+            listDirectory(path, visited, files);
+        } else if (S_ISREG(st.st_mode) && hasAudioExtension(name)) {
+            files.push_back(std::move(path));
+        }
+    }
+    closedir(dir);
+}
+
+/**
+ * 专辑的键：所在目录加专辑标签；没有专辑标签的曲目自成一张（以路径为键）
+ */
+std::string albumKey(const std::string& filePath, const std::string& album) {
+    if (album.empty()) {
+        return filePath;
+    }
+    size_t slash = filePath.rfind('/');
+    return (slash == std::string::npos ? std::string() : filePath.substr(0, slash)) + "\n" + album;
+}
+
+/**
+ * 一张专辑：各曲目门限块直方图之和与最大真峰值（线性）
+ */
+struct AlbumAccumulator {
+    LoudnessHistogram histogram;
+    double peak = 0;
+};
+
+}  // namespace
+
+LoudnessAnalyzer::LoudnessAnalyzer(int threads, int rawSampleRate)
+    : threads_(threads > 0 ? threads : static_cast<int>(std::max(1u, std::thread::hardware_concurrency()))),
+      raw_sample_rate_(rawSampleRate) {}
+
+LoudnessBatchResult LoudnessAnalyzer::analyze(const std::vector<std::string>& files) {
+    auto begin = std::chrono::steady_clock::now();
+    LoudnessBatchResult result;
+    result.files = files.size();
+    result.tracks.resize(files.size());
+
+    completed_.store(0);
+    total_.store(files.size());
+    running_.store(true);
+
+    // 每个工作线程只写自己取到的下标，专辑累加器由 albumMutex 保护
+    std::atomic<size_t> next{0};
+    std::vector<std::string> albumKeys(files.size());
+    std::vector<uint64_t> frames(files.size(), 0);
+    std::vector<int> rates(files.size(), 0);
+    std::unordered_map<std::string, AlbumAccumulator> albums;
+    std::mutex albumMutex;
+
+    auto work = [&] {
+        LoudnessMeter meter(kChannels);
+        std::vector<float> buffer(kBlockFrames * kChannels);
+        while (!cancelled_.load(std::memory_order_relaxed)) {
+            size_t index = next.fetch_add(1);
+            if (index >= files.size()) {
+                break;
+            }
+            LoudnessTrackResult& track = result.tracks[index];
+            track.file = files[index];
+
+            std::unique_ptr<AudioSource> source;
+            AudioInfo info;
+            if (openPcmFile(track.file, raw_sample_rate_, kChannels, source, info) == PcmOpenResult::OK) {
+                meter.reset(source->sampleRate());
+                bool complete = true;
+                for (;;) {
+                    if (cancelled_.load(std::memory_order_relaxed)) {
+                        complete = false;
+                        break;
+                    }
+                    size_t n = source->read(buffer.data(), kBlockFrames);
+                    meter.process(buffer.data(), n);
+                    frames[index] += n;
+                    if (n < kBlockFrames) {
+                        break;
+                    }
+                }
+                source.reset();  // 立即解除映射
+                if (complete) {
+                    meter.finish();
+                    track.analyzed = true;
+                    track.loudness.trackLoudness = meter.integratedLoudness();
+                    track.loudness.trackPeak = peakDb(meter.truePeak());
+                    rates[index] = meter.sampleRate();
+
+                    std::string key = albumKey(track.file, info.album);
+                    std::lock_guard<std::mutex> lock(albumMutex);
+                    AlbumAccumulator& album = albums[key];
+                    album.histogram.merge(meter.histogram());
+                    album.peak = std::max(album.peak, static_cast<double>(meter.truePeak()));
+                    albumKeys[index] = std::move(key);
+                }
+            }
+            completed_.fetch_add(1, std::memory_order_relaxed);
+        }
+    };
+
+    size_t threadCount = std::min(static_cast<size_t>(threads_), std::max<size_t>(files.size(), 1));
+    std::vector<std::thread> workers;
+    for (size_t i = 1; i < threadCount; ++i) {
+        workers.emplace_back(work);
+    }
+    work();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+
+    // 专辑结果要等所有曲目分析完，最后统一写进元数据缓存
+    MetadataCache& cache = MetadataCache::getInstance();
+    std::unordered_map<std::string, LoudnessInfo> albumResults;
+    for (const auto& item : albums) {
+        LoudnessInfo& album = albumResults[item.first];
+        album.albumLoudness = item.second.histogram.integrated();
+        album.albumPeak = peakDb(item.second.peak);
+    }
+    for (size_t i = 0; i < result.tracks.size(); ++i) {
+        LoudnessTrackResult& track = result.tracks[i];
+        if (track.file.empty()) {
+            track.file = files[i];  // 取消时没有轮到的文件
+        }
+        if (!track.analyzed) {
+            ++result.skipped;
+            continue;
+        }
+        const LoudnessInfo& album = albumResults[albumKeys[i]];
+        track.loudness.albumLoudness = album.albumLoudness;
+        track.loudness.albumPeak = album.albumPeak;
+        if (!cache.storeLoudness(track.file, track.loudness)) {
+            std::cerr << "Failed to store loudness for " << track.file << std::endl;
+        }
+        ++result.analyzed;
+        result.audioSeconds += static_cast<double>(frames[i]) / rates[i];
+    }
+    result.albums = albums.size();
+    if (result.analyzed > 0) {
+        cache.save();
+    }
+
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    running_.store(false);
+    return result;
+}
+
+void LoudnessAnalyzer::reset() {
+    cancelled_.store(false);
+    completed_.store(0);
+    total_.store(0);
+}
+
+void LoudnessAnalyzer::cancel() {
+    cancelled_.store(true);
+}
+
+LoudnessProgress LoudnessAnalyzer::progress() const {
+    LoudnessProgress progress;
+    progress.running = running_.load();
+    progress.total = total_.load();
+    progress.completed = std::min(completed_.load(), progress.total);
+    return progress;
+}
+
+std::vector<std::string> LoudnessAnalyzer::listAudioFiles(const std::string& directory) {
+    std::vector<std::string> files;
+    std::string root = directory;
+    while (root.size() > 1 && root.back() == '/') {
+        root.pop_back();
+    }
+    std::set<std::pair<dev_t, ino_t>> visited;
+    listDirectory(root, visited, files);
+    std::sort(files.begin(), files.end());
+    return files;
+}
+
+std::vector<std::string> LoudnessAnalyzer::playlistFiles(const Playlist& playlist) {
+    std::vector<std::string> files;
+    std::unordered_set<std::string> seen;
+    for (const Track& track : playlist.tracks) {
+        if (track.url.empty() || track.url.find("://") != std::string::npos) {
+            continue;
+        }
+        if (seen.insert(track.url).second) {
+            files.push_back(track.url);
+        }
+    }
+    return files;
+}
+
+}  // namespace musicfree
@@ -0,0 +1,384 @@
+#include "loudness_meter.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define MUSICFREE_LOUDNESS_X86 1
+#endif
+
+namespace musicfree {
+
+namespace {
+
+constexpr double kPi = 3.14159265358979323846;
+
+// 每次处理的最大帧数（K 计权缓冲区和真峰值历史的大小）
+constexpr size_t kChunkFrames = 4096;
+
+// 真峰值插值滤波器的档位：通带到较低奈奎斯特频率的 0.85，每相 32 个抽头
+constexpr ResamplerQuality kTruePeakQuality = ResamplerQuality::MEDIUM;
+
+// BS.1770 的块响度：-0.691 + 10 log10(各声道均方和)
+constexpr double kLoudnessOffset = -0.691;
+
+double blockLoudness(double meanSquare) {
+    return kLoudnessOffset + 10.0 * std::log10(meanSquare);
+}
+
+/**
+ * BS.1770 的 K 计权：48 kHz 下给出的两个双二阶由模拟原型按采样率换算（与 libebur128 相同）
+ */
+void kWeighting(int sampleRate, BiquadCoefficients* out) {
+    double fs = sampleRate;
+
+    // 第一级：约 1.68 kHz 以上 +4 dB 的高频搁架（头部的声学效应）
+    double f0 = 1681.974450955533;
+    double gain = 3.999843853973347;
+    double q = 0.7071752369554196;
+    double k = std::tan(kPi * f0 / fs);
+    double vh = std::pow(10.0, gain / 20.0);
+    double vb = std::pow(vh, 0.4996667741545416);
+    double a0 = 1.0 + k / q + k * k;
+    out[0].b0 = static_cast<float>((vh + vb * k / q + k * k) / a0);
+    out[0].b1 = static_cast<float>(2.0 * (k * k - vh) / a0);
+    out[0].b2 = static_cast<float>((vh - vb * k / q + k * k) / a0);
+    out[0].a1 = static_cast<float>(2.0 * (k * k - 1.0) / a0);
+    out[0].a2 = static_cast<float>((1.0 - k / q + k * k) / a0);
+
+    // 第二级：约 38 Hz 的高通（RLB 计权）
+    f0 = 38.13547087602444;
+    q = 0.5003270373238773;
+    k = std::tan(kPi * f0 / fs);
+    a0 = 1.0 + k / q + k * k;
+    out[1].b0 = 1.0f;
+    out[1].b1 = -2.0f;
+    out[1].b2 = 1.0f;
+    out[1].a1 = static_cast<float>(2.0 * (k * k - 1.0) / a0);
+    out[1].a2 = static_cast<float>((1.0 - k / q + k * k) / a0);
+}
+
+double sumSquares(const float* samples, size_t count) {
+    float acc[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        for (int k = 0; k < 4; ++k) {
+            acc[k] += samples[i + static_cast<size_t>(k)] * samples[i + static_cast<size_t>(k)];
+        }
+    }
+    double sum = static_cast<double>(acc[0]) + acc[1] + acc[2] + acc[3];
+    for (; i < count; ++i) {
+        sum += static_cast<double>(samples[i]) * samples[i];
+    }
+    return sum;
+}
+
+/**
+ * 插值真峰值内核：窗口 s（0 <= s < windows）在 P 个插值相上的结果的最大绝对值，
+ * 第 p 相第 s 个窗口的结果为 sum_k rows[p][k] * x[s + k]
+ * SIMD 版本一次算 16 个（AVX2）/ 4 个（SSE）相邻的窗口：逐个抽头广播系数、乘上 x 的一段连续采样累加，
+ * 各相共用同一次加载，不需要水平求和。结果只用来取最大值，与标量实现之间允许 float 舍入级别的差异
+ */
+template <size_t P>
+float interpolatedPeakScalar(const float* const* rows, size_t taps, const float* x, size_t windows) {
+    float peak = 0.0f;
+    for (size_t s = 0; s < windows; ++s) {
+        for (size_t p = 0; p < P; ++p) {
+            float sum = 0.0f;
+            for (size_t k = 0; k < taps; ++k) {
+                sum += rows[p][k] * x[s + k];
+            }
+            peak = std::max(peak, std::fabs(sum));
+        }
+    }
+    return peak;
+}
+
+#ifdef MUSICFREE_LOUDNESS_X86
+
+template <size_t P>
+__attribute__((target("sse4.1")))
+float interpolatedPeakSse(const float* const* rows, size_t taps, const float* x, size_t windows) {
+    const __m128 mask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+    __m128 peak = _mm_setzero_ps();
+    size_t s = 0;
+    for (; s + 4 <= windows; s += 4) {
+        __m128 acc[P];
+        for (size_t p = 0; p < P; ++p) {
+            acc[p] = _mm_setzero_ps();
+        }
+        for (size_t k = 0; k < taps; ++k) {
+            __m128 v = _mm_loadu_ps(x + s + k);
+            for (size_t p = 0; p < P; ++p) {
+                acc[p] = _mm_add_ps(acc[p], _mm_mul_ps(_mm_set1_ps(rows[p][k]), v));
+            }
+        }
+        for (size_t p = 0; p < P; ++p) {
+            peak = _mm_max_ps(peak, _mm_and_ps(acc[p], mask));
+        }
+    }
+    peak = _mm_max_ps(peak, _mm_movehl_ps(peak, peak));
+    peak = _mm_max_ss(peak, _mm_shuffle_ps(peak, peak, 1));
+    float result = _mm_cvtss_f32(peak);
+    if (s < windows) {
+        result = std::max(result, interpolatedPeakScalar<P>(rows, taps, x + s, windows - s));
+    }
+    return result;
+}
+
+template <size_t P>
+__attribute__((target("avx2")))
+float interpolatedPeakAvx2(const float* const* rows, size_t taps, const float* x, size_t windows) {
+    const __m256 mask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7fffffff));
+    __m256 peak = _mm256_setzero_ps();
+    size_t s = 0;
+    // 一次 16 个窗口：两组累加器互不依赖，加法的延迟可以重叠
+    for (; s + 16 <= windows; s += 16) {
+        __m256 lo[P], hi[P];
+        for (size_t p = 0; p < P; ++p) {
+            lo[p] = _mm256_setzero_ps();
+            hi[p] = _mm256_setzero_ps();
+        }
+        for (size_t k = 0; k < taps; ++k) {
+            __m256 a = _mm256_loadu_ps(x + s + k);
+            __m256 b = _mm256_loadu_ps(x + s + k + 8);
+            for (size_t p = 0; p < P; ++p) {
+                __m256 h = _mm256_broadcast_ss(rows[p] + k);
+                lo[p] = _mm256_add_ps(lo[p], _mm256_mul_ps(h, a));
+                hi[p] = _mm256_add_ps(hi[p], _mm256_mul_ps(h, b));
+            }
+        }
+        for (size_t p = 0; p < P; ++p) {
+            peak = _mm256_max_ps(peak, _mm256_max_ps(_mm256_and_ps(lo[p], mask), _mm256_and_ps(hi[p], mask)));
+        }
+    }
+    __m128 half = _mm_max_ps(_mm256_castps256_ps128(peak), _mm256_extractf128_ps(peak, 1));
+    half = _mm_max_ps(half, _mm_movehl_ps(half, half));
+    half = _mm_max_ss(half, _mm_shuffle_ps(half, half, 1));
+    float result = _mm_cvtss_f32(half);
+    if (s < windows) {
+        result = std::max(result, interpolatedPeakScalar<P>(rows, taps, x + s, windows - s));
+    }
+    return result;
+}
+
+#endif  // MUSICFREE_LOUDNESS_X86
+
+template <size_t P>
+float interpolatedPeak(const float* const* rows, size_t taps, const float* x, size_t windows, SimdLevel level) {
+#ifdef MUSICFREE_LOUDNESS_X86
+    if (level == SimdLevel::AVX2) {
+        return interpolatedPeakAvx2<P>(rows, taps, x, windows);
+    }
+    if (level == SimdLevel::SSE42) {
+        return interpolatedPeakSse<P>(rows, taps, x, windows);
+    }
+#else
+    (void)level;
+#endif
+    return interpolatedPeakScalar<P>(rows, taps, x, windows);
+}
+
+}  // namespace
+
+// ===== LoudnessHistogram =====
+
+void LoudnessHistogram::add(double meanSquare) {
+    double loudness = meanSquare > 0 ? blockLoudness(meanSquare) : kMinLoudness - 1;
+    if (!(loudness >= kMinLoudness)) {
+        return;  // 绝对门限
+    }
+    size_t index = static_cast<size_t>(std::min(static_cast<int>((loudness - kMinLoudness) / kBinWidth), kBins - 1));
+    ++counts[index];
+    energies[index] += meanSquare;
+}
+
+void LoudnessHistogram::merge(const LoudnessHistogram& other) {
+    for (size_t i = 0; i < counts.size(); ++i) {
+        counts[i] += other.counts[i];
+        energies[i] += other.energies[i];
+    }
+}
+
+uint64_t LoudnessHistogram::blocks() const {
+    uint64_t total = 0;
+    for (uint32_t count : counts) {
+        total += count;
+    }
+    return total;
+}
+
+double LoudnessHistogram::integrated() const {
+    double energy = 0;
+    uint64_t blocks = 0;
+    for (size_t i = 0; i < counts.size(); ++i) {
+        energy += energies[i];
+        blocks += counts[i];
+    }
+    if (blocks == 0) {
+        return kMinLoudness;
+    }
+
+    // 相对门限所在的箱及以上
+    double relative = blockLoudness(energy / static_cast<double>(blocks)) - 10.0;
+    int first = std::max(0, static_cast<int>(std::floor((relative - kMinLoudness) / kBinWidth)));
+    energy = 0;
+    blocks = 0;
+    for (size_t i = static_cast<size_t>(std::min(first, kBins)); i < counts.size(); ++i) {
+        energy += energies[i];
+        blocks += counts[i];
+    }
+    return blocks == 0 ? kMinLoudness : blockLoudness(energy / static_cast<double>(blocks));
+}
+
+// ===== LoudnessMeter =====
+
+LoudnessMeter::LoudnessMeter(int channels, SimdLevel level)
+    : channels_(channels),
+      level_(std::min(level, detectSimdLevel())),
+      k_state_(2 * 2 * static_cast<size_t>(channels), 0.0f),
+      weighted_(kChunkFrames * static_cast<size_t>(channels)) {}
+
+void LoudnessMeter::reset(int sampleRate) {
+    if (sampleRate != sample_rate_) {
+        sample_rate_ = sampleRate;
+        kWeighting(sampleRate, k_weighting_);
+        int factor = sampleRate < 96000 ? 4 : sampleRate < 192000 ? 2 : 1;
+        bank_.reset();
+        bound_ = 1.0f;
+        taps_ = 0;
+        if (factor > 1) {
+            bank_ = resamplerFilterBank(sampleRate, sampleRate * factor, kTruePeakQuality);
+            taps_ = bank_->taps;
+            for (size_t p = 1; p < bank_->phases; ++p) {
+                rows_[p - 1] = bank_->phase(p);
+            }
+            for (size_t p = 0; p < bank_->phases; ++p) {
+                float sum = 0.0f;
+                for (size_t k = 0; k < taps_; ++k) {
+                    sum += std::fabs(bank_->phase(p)[k]);
+                }
+                bound_ = std::max(bound_, sum);
+            }
+            if (capacity_ < kChunkFrames + taps_) {
+                capacity_ = kChunkFrames + taps_;
+                history_.assign(capacity_ * static_cast<size_t>(channels_), 0.0f);
+            }
+        }
+    }
+
+    std::fill(k_state_.begin(), k_state_.end(), 0.0f);
+    sub_block_frames_ = static_cast<size_t>((sampleRate + 5) / 10);
+    sub_frames_ = 0;
+    sub_energy_ = 0;
+    sub_blocks_ = 0;
+    histogram_.clear();
+    true_peak_ = 0.0f;
+    skipped_frames_ = 0;
+    oversampled_frames_ = 0;
+
+    // 第一个窗口以第一帧为中心，之前补静音
+    count_ = taps_ > 0 ? taps_ / 2 - 1 : 0;
+    for (int c = 0; c < channels_ && taps_ > 0; ++c) {
+        std::fill_n(history_.begin() + static_cast<ptrdiff_t>(static_cast<size_t>(c) * capacity_), count_, 0.0f);
+    }
+}
+
+void LoudnessMeter::process(const float* samples, size_t frames) {
+    size_t channels = static_cast<size_t>(channels_);
+    while (frames > 0) {
+        size_t n = std::min(frames, kChunkFrames);
+        processChunk(samples, n);
+        samples += n * channels;
+        frames -= n;
+    }
+}
+
+void LoudnessMeter::processChunk(const float* samples, size_t frames) {
+    size_t channels = static_cast<size_t>(channels_);
+
+    // K 计权之后按 100 ms 子块累计能量
+    std::copy_n(samples, frames * channels, weighted_.begin());
+    processBiquads(weighted_.data(), frames, channels_, k_weighting_, 2, k_state_.data(), level_);
+    const float* weighted = weighted_.data();
+    size_t remaining = frames;
+    while (remaining > 0) {
+        size_t n = std::min(remaining, sub_block_frames_ - sub_frames_);
+        sub_energy_ += sumSquares(weighted, n * channels);
+        sub_frames_ += n;
+        weighted += n * channels;
+        remaining -= n;
+        if (sub_frames_ == sub_block_frames_) {
+            recent_[sub_blocks_ % 4] = sub_energy_;
+            ++sub_blocks_;
+            sub_energy_ = 0;
+            sub_frames_ = 0;
+            if (sub_blocks_ >= 4) {
+                double meanSquare = (recent_[0] + recent_[1] + recent_[2] + recent_[3]) /
+                                    (4.0 * static_cast<double>(sub_block_frames_));
+                histogram_.add(meanSquare);
+            }
+        }
+    }
+
+    // 采样值本身就是插值的第 0 相
+    true_peak_ = std::max(true_peak_, peakAbs(samples, frames * channels, level_));
+    if (!bank_) {
+        return;
+    }
+    for (size_t c = 0; c < channels; ++c) {
+        float* dst = history_.data() + c * capacity_ + count_;
+        for (size_t f = 0; f < frames; ++f) {
+            dst[f] = samples[f * channels + c];
+        }
+    }
+    count_ += frames;
+    measureTruePeak(frames);
+}
+
+void LoudnessMeter::measureTruePeak(size_t frames) {
+    if (count_ < taps_) {
+        return;
+    }
+    size_t windows = count_ - taps_ + 1;
+    size_t channels = static_cast<size_t>(channels_);
+
+    float peak = 0.0f;
+    for (size_t c = 0; c < channels; ++c) {
+        peak = std::max(peak, peakAbs(history_.data() + c * capacity_, count_, level_));
+    }
+    if (peak * bound_ > true_peak_) {
+        // 第 0 相就是采样本身，只需要插值其余各相
+        for (size_t c = 0; c < channels; ++c) {
+            const float* x = history_.data() + c * capacity_;
+            float channelPeak = bank_->phases == 4 ? interpolatedPeak<3>(rows_, taps_, x, windows, level_)
+                                                   : interpolatedPeak<1>(rows_, taps_, x, windows, level_);
+            true_peak_ = std::max(true_peak_, channelPeak);
+        }
+        oversampled_frames_ += frames;
+    } else {
+        skipped_frames_ += frames;
+    }
+
+    // 留下还凑不满一个窗口的尾部
+    for (size_t c = 0; c < channels; ++c) {
+        float* x = history_.data() + c * capacity_;
+        std::memmove(x, x + windows, (taps_ - 1) * sizeof(float));
+    }
+    count_ = taps_ - 1;
+}
+
+void LoudnessMeter::finish() {
+    if (!bank_) {
+        return;
+    }
+    size_t pad = taps_ / 2;
+    for (size_t c = 0; c < static_cast<size_t>(channels_); ++c) {
+        std::fill_n(history_.begin() + static_cast<ptrdiff_t>(c * capacity_ + count_), pad, 0.0f);
+    }
+    count_ += pad;
+    measureTruePeak(0);
+}
+
+}  // namespace musicfree
@@ -0,0 +1,119 @@
+#ifndef MUSICFREE_LOUDNESS_METER_H
+#define MUSICFREE_LOUDNESS_METER_H
+
+#include "audio_dsp.h"
+#include "resampler.h"
+#include "simd_level.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace musicfree {
+
+/**
+ * 门限块响度的直方图
+ * -70 到 +5 LUFS 按 0.1 LU 分箱（全满幅的立体声方波约 +2.3 LUFS），每箱记块数和块能量之和，
+ * 积分响度由能量之和精确得到，只有相对门限按箱取整（门限所在的箱整箱计入）。
+ * 大小固定（约 9 KB），与曲目长度无关，合并一张专辑的所有曲目只需逐箱相加。
+ */
+struct LoudnessHistogram {
+    static constexpr int kBins = 750;
+    static constexpr double kMinLoudness = -70.0;
+    static constexpr double kBinWidth = 0.1;
+
+    std::array<uint32_t, kBins> counts{};
+    std::array<double, kBins> energies{};  // 各块的均方能量之和
+
+    /**
+     * @param meanSquare 一个门限块 K 计权后各声道均方之和
+     */
+    void add(double meanSquare);
+    void merge(const LoudnessHistogram& other);
+    void clear() {
+        counts.fill(0);
+        energies.fill(0);
+    }
+    uint64_t blocks() const;
+
+    /**
+     * 积分响度：绝对门限 -70 LUFS，相对门限为绝对门限以上各块平均能量的响度减 10 LU
+     * @return LUFS；没有超过绝对门限的块时返回 kMinLoudness
+     */
+    double integrated() const;
+};
+
+/**
+ * EBU R128 / ITU-R BS.1770-4 响度计（float32 交错采样，流式）
+ *
+ *   - K 计权：高频搁架 + 高通两个双二阶（系数按采样率由 BS.1770 的模拟原型换算），
+ *     用 audio_dsp.h 的级联滤波内核在声道上向量化
+ *   - 门限块：400 ms 一块、每 100 ms 一块（75% 重叠），各声道权重为 1（立体声、单声道）
+ *   - 真峰值：低于 96 kHz 时 4 倍、低于 192 kHz 时 2 倍过采样，多相插值滤波器取自重采样器的滤波器组缓存。
+ *     滤波器每相系数绝对值之和给出插值结果的上界，一块数据的采样峰值乘上这个上界仍不超过已知的真峰值时
+ *     跳过这一块的插值，结果与逐帧插值相同
+ * 缓冲区在构造时按声道数分配，process() 不分配内存；reset() 换采样率时取（必要时计算）滤波器组。
+ */
+class LoudnessMeter {
+public:
+    explicit LoudnessMeter(int channels, SimdLevel level = detectSimdLevel());
+
+    /**
+     * 开始测量一首新曲目
+     */
+    void reset(int sampleRate);
+
+    void process(const float* samples, size_t frames);
+
+    /**
+     * 输入结束：冲出真峰值插值滤波器的尾部
+     */
+    void finish();
+
+    int sampleRate() const { return sample_rate_; }
+    double integratedLoudness() const { return histogram_.integrated(); }
+    double truePeak() const { return true_peak_; }  // 线性
+    const LoudnessHistogram& histogram() const { return histogram_; }
+
+    // 因采样峰值足够低而跳过插值的帧数 / 插值的帧数
+    uint64_t skippedFrames() const { return skipped_frames_; }
+    uint64_t oversampledFrames() const { return oversampled_frames_; }
+
+private:
+    void processChunk(const float* samples, size_t frames);
+    void measureTruePeak(size_t frames);
+
+    int channels_;
+    SimdLevel level_;
+    int sample_rate_ = 0;
+
+    // K 计权
+    BiquadCoefficients k_weighting_[2];
+    std::vector<float> k_state_;     // 2 个频段 * 2 * channels
+    std::vector<float> weighted_;    // 一块 K 计权后的采样
+
+    // 门限块：100 ms 子块的能量，最近 4 个组成一个 400 ms 的块
+    size_t sub_block_frames_ = 0;
+    size_t sub_frames_ = 0;
+    double sub_energy_ = 0;
+    double recent_[4] = {};
+    size_t sub_blocks_ = 0;
+    LoudnessHistogram histogram_;
+
+    // 真峰值：各声道的历史（窗口起点之前补静音）
+    std::shared_ptr<const ResamplerFilterBank> bank_;
+    float bound_ = 1.0f;  // 各相系数绝对值之和的最大值
+    const float* rows_[3] = {};  // 第 1 到 phases - 1 相的系数（2 倍时只有一相）
+    size_t taps_ = 0;
+    size_t capacity_ = 0;
+    size_t count_ = 0;
+    std::vector<float> history_;  // channels * capacity_
+    float true_peak_ = 0.0f;
+    uint64_t skipped_frames_ = 0;
+    uint64_t oversampled_frames_ = 0;
+};
+
+}  // namespace musicfree
+
+#endif  // MUSICFREE_LOUDNESS_METER_H
@@ -0,0 +1,82 @@
+#include "mapped_file.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define MUSICFREE_HAVE_MMAP 1
+#endif
+
+namespace musicfree {
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+bool MappedFile::open(const std::string& path) {
+    close();
+#ifdef MUSICFREE_HAVE_MMAP
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || st.st_size <= 0) {
+        ::close(fd);
+        return false;
+    }
+
+    size_t size = static_cast<size_t>(st.st_size);
+    void* data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    // 映射建立之后文件描述符就不再需要
+    ::close(fd);
+    if (data == MAP_FAILED) {
+        return false;
+    }
+
+    data_ = static_cast<const uint8_t*>(data);
+    size_ = size;
+    return true;
+#else
+    (void)path;
+    return false;
+#endif
+}
+
+void MappedFile::close() {
+#ifdef MUSICFREE_HAVE_MMAP
+    if (data_ != nullptr) {
+        munmap(const_cast<uint8_t*>(data_), size_);
+    }
+#endif
+    data_ = nullptr;
+    size_ = 0;
+}
+
+void MappedFile::adviseSequential() {
+#ifdef MUSICFREE_HAVE_MMAP
+    if (data_ != nullptr) {
+        madvise(const_cast<uint8_t*>(data_), size_, MADV_SEQUENTIAL);
+    }
+#endif
+}
+
+void MappedFile::adviseWillNeed(size_t offset, size_t length) {
+#ifdef MUSICFREE_HAVE_MMAP
+    if (data_ == nullptr || offset >= size_) {
+        return;
+    }
+    // madvise 的起始地址必须按页对齐
+    size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    size_t begin = offset / page * page;
+    size_t end = offset + length < size_ ? offset + length : size_;
+    madvise(const_cast<uint8_t*>(data_) + begin, end - begin, MADV_WILLNEED);
+#else
+    (void)offset;
+    (void)length;
+#endif
+}
+
+}  // namespace musicfree
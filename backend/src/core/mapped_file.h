@@ -0,0 +1,58 @@
+#ifndef MUSICFREE_MAPPED_FILE_H
+#define MUSICFREE_MAPPED_FILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace musicfree {
+
+/**
+ * 只读的文件内存映射
+ *
+ * 打开时只建立映射、不读取内容，耗时与文件大小无关；页面在首次访问时由内核按需读入。
+ * 不支持 mmap 的平台上 open() 总是失败。
+ */
+class MappedFile {
+public:
+    MappedFile() = default;
+    ~MappedFile();
+
+    // 禁止拷贝
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    /**
+     * 映射整个文件
+     * @param path 文件路径
+     * @return 成功返回 true；空文件、目录或无法打开时返回 false
+     */
+    bool open(const std::string& path);
+
+    /**
+     * 解除映射
+     */
+    void close();
+
+    bool isOpen() const { return data_ != nullptr; }
+    const uint8_t* data() const { return data_; }
+    size_t size() const { return size_; }
+
+    /**
+     * 提示内核按顺序访问：加大预读、读过的页面优先回收
+     */
+    void adviseSequential();
+
+    /**
+     * 提示内核即将访问 [offset, offset + length)，提前发起预读（跳转之后调用）
+     */
+    void adviseWillNeed(size_t offset, size_t length);
+
+private:
+    const uint8_t* data_ = nullptr;
+    size_t size_ = 0;
+};
+
+}  // namespace musicfree
+
+#endif  // MUSICFREE_MAPPED_FILE_H
@@ -0,0 +1,66 @@
+#include "../include/metrics.h"
+#include <cmath>
+
+namespace musicfree {
+
+uint64_t LatencyHistogram::bucketUpperBound(size_t index) {
+    constexpr uint64_t kSubCount = uint64_t(1) << kSubBucketBits;
+    if (index < kSubCount) {
+        return index;
+    }
+    int shift = static_cast<int>(index >> kSubBucketBits) - 1;
+    uint64_t lower = (kSubCount + (index & (kSubCount - 1))) << shift;
+    return lower + (uint64_t(1) << shift) - 1;
+}
+
+void HistogramSnapshot::merge(const LatencyHistogram& histogram) {
+    for (size_t i = 0; i < LatencyHistogram::kBucketCount; ++i) {
+        buckets_[i] += histogram.buckets_[i].load(std::memory_order_relaxed);
+    }
+    count_ += histogram.count_.load(std::memory_order_relaxed);
+    sum_ += histogram.sum_.load(std::memory_order_relaxed);
+}
+
+void HistogramSnapshot::merge(const HistogramSnapshot& other) {
+    for (size_t i = 0; i < buckets_.size(); ++i) {
+        buckets_[i] += other.buckets_[i];
+    }
+    count_ += other.count_;
+    sum_ += other.sum_;
+}
+
+uint64_t HistogramSnapshot::quantile(double quantile) const {
+    // count_ 与各桶不是同一时刻读到的，按桶的实际总数计算排名
+    uint64_t total = 0;
+    for (uint64_t bucket : buckets_) {
+        total += bucket;
+    }
+    if (total == 0) {
+        return 0;
+    }
+
+    double clamped = quantile < 0 ? 0 : (quantile > 1 ? 1 : quantile);
+    uint64_t rank = static_cast<uint64_t>(std::ceil(clamped * static_cast<double>(total)));
+    if (rank == 0) {
+        rank = 1;
+    }
+
+    uint64_t seen = 0;
+    for (size_t i = 0; i < buckets_.size(); ++i) {
+        seen += buckets_[i];
+        if (seen >= rank) {
+            return LatencyHistogram::bucketUpperBound(i);
+        }
+    }
+    return LatencyHistogram::bucketUpperBound(buckets_.size() - 1);
+}
+
+uint64_t HistogramSnapshot::countAtOrBelow(uint64_t bound) const {
+    uint64_t result = 0;
+    for (size_t i = 0; i < buckets_.size() && LatencyHistogram::bucketUpperBound(i) <= bound; ++i) {
+        result += buckets_[i];
+    }
+    return result;
+}
+
+}  // namespace musicfree
@@ -0,0 +1,444 @@
+#include "pcm_file_source.h"
+#include "tag_reader.h"
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstring>
+
+namespace musicfree {
+
+namespace {
+
+// WAVE 格式标签
+constexpr uint16_t kWavePcm = 0x0001;
+constexpr uint16_t kWaveFloat = 0x0003;
+constexpr uint16_t kWaveExtensible = 0xFFFE;
+
+// 跳转后预读的长度
+constexpr size_t kSeekReadahead = 256 * 1024;
+
+uint16_t le16(const uint8_t* p) {
+    return static_cast<uint16_t>(p[0] | (p[1] << 8));
+}
+
+uint32_t le32(const uint8_t* p) {
+    return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) | (static_cast<uint32_t>(p[2]) << 16) |
+           (static_cast<uint32_t>(p[3]) << 24);
+}
+
+uint16_t be16(const uint8_t* p) {
+    return static_cast<uint16_t>((p[0] << 8) | p[1]);
+}
+
+uint32_t be32(const uint8_t* p) {
+    return (static_cast<uint32_t>(p[0]) << 24) | (static_cast<uint32_t>(p[1]) << 16) |
+           (static_cast<uint32_t>(p[2]) << 8) | static_cast<uint32_t>(p[3]);
+}
+
+uint64_t be64(const uint8_t* p) {
+    return (static_cast<uint64_t>(be32(p)) << 32) | be32(p + 4);
+}
+
+uint64_t le64(const uint8_t* p) {
+    return (static_cast<uint64_t>(le32(p + 4)) << 32) | le32(p);
+}
+
+bool tagIs(const uint8_t* p, const char* id) {
+    return std::memcmp(p, id, 4) == 0;
+}
+
+/**
+ * AIFF 的 80 位扩展精度浮点数（采样率）
+ */
+double extendedToDouble(const uint8_t* p) {
+    int exponent = ((p[0] & 0x7F) << 8) | p[1];
+    uint64_t mantissa = be64(p + 2);
+    if (exponent == 0 && mantissa == 0) {
+        return 0.0;
+    }
+    double value = std::ldexp(static_cast<double>(mantissa), exponent - 16383 - 63);
+    return (p[0] & 0x80) ? -value : value;
+}
+
+/**
+ * 文本块内容（去掉结尾的 NUL 和空白）
+ */
+std::string chunkText(const uint8_t* p, size_t size) {
+    size_t end = 0;
+    while (end < size && p[end] != 0) {
+        ++end;
+    }
+    while (end > 0 && (p[end - 1] == ' ' || p[end - 1] == '\n' || p[end - 1] == '\r')) {
+        --end;
+    }
+    return std::string(reinterpret_cast<const char*>(p), end);
+}
+
+/**
+ * 由数据区的位置和大小（截断到文件末尾）计算帧数
+ */
+bool finishLayout(PcmLayout& layout, size_t fileSize, uint64_t dataOffset, uint64_t dataBytes) {
+    if (layout.channels <= 0 || layout.sampleRate <= 0 || layout.frameBytes == 0 || dataOffset > fileSize) {
+        return false;
+    }
+    uint64_t available = std::min<uint64_t>(dataBytes, fileSize - dataOffset);
+    layout.dataOffset = dataOffset;
+    layout.frames = available / layout.frameBytes;
+    return true;
+}
+
+bool encodingForContainer(size_t bytes, bool isFloat, bool unsigned8, SampleEncoding& encoding) {
+    if (isFloat) {
+        if (bytes == 4) { encoding = SampleEncoding::FLOAT32; return true; }
+        if (bytes == 8) { encoding = SampleEncoding::FLOAT64; return true; }
+        return false;
+    }
+    switch (bytes) {
+        case 1: encoding = unsigned8 ? SampleEncoding::UINT8 : SampleEncoding::INT8; return true;
+        case 2: encoding = SampleEncoding::INT16; return true;
+        case 3: encoding = SampleEncoding::INT24; return true;
+        case 4: encoding = SampleEncoding::INT32; return true;
+        default: return false;
+    }
+}
+
+// ===== 采样转换 =====
+
+template <SampleEncoding Encoding, bool BigEndian>
+inline float decodeSample(const uint8_t* p) {
+    switch (Encoding) {
+        case SampleEncoding::UINT8:
+            return (static_cast<float>(p[0]) - 128.0f) * (1.0f / 128.0f);
+        case SampleEncoding::INT8:
+            return static_cast<float>(static_cast<int8_t>(p[0])) * (1.0f / 128.0f);
+        case SampleEncoding::INT16:
+            return static_cast<float>(static_cast<int16_t>(BigEndian ? be16(p) : le16(p))) * (1.0f / 32768.0f);
+        case SampleEncoding::INT24: {
+            uint32_t raw = BigEndian ? (static_cast<uint32_t>(p[0]) << 24) | (static_cast<uint32_t>(p[1]) << 16) |
+                                           (static_cast<uint32_t>(p[2]) << 8)
+                                     : (static_cast<uint32_t>(p[2]) << 24) | (static_cast<uint32_t>(p[1]) << 16) |
+                                           (static_cast<uint32_t>(p[0]) << 8);
+            return static_cast<float>(static_cast<int32_t>(raw)) * (1.0f / 2147483648.0f);
+        }
+        case SampleEncoding::INT32:
+            return static_cast<float>(static_cast<int32_t>(BigEndian ? be32(p) : le32(p))) * (1.0f / 2147483648.0f);
+        case SampleEncoding::FLOAT32: {
+            uint32_t bits = BigEndian ? be32(p) : le32(p);
+            float value;
+            std::memcpy(&value, &bits, sizeof(value));
+            return value;
+        }
+        case SampleEncoding::FLOAT64: {
+            uint64_t bits = BigEndian ? be64(p) : le64(p);
+            double value;
+            std::memcpy(&value, &bits, sizeof(value));
+            return static_cast<float>(value);
+        }
+    }
+    return 0.0f;
+}
+
+template <SampleEncoding Encoding, bool BigEndian>
+void convertFrames(const uint8_t* src, size_t frames, const PcmLayout& layout, float* out, int outputChannels) {
+    size_t sampleBytes = layout.frameBytes / static_cast<size_t>(layout.channels);
+    int channels = layout.channels;
+    if (channels == outputChannels) {
+        // 常见情况：逐个采样转换，编译器可以展开和向量化
+        size_t samples = frames * static_cast<size_t>(channels);
+        for (size_t i = 0; i < samples; ++i) {
+            out[i] = decodeSample<Encoding, BigEndian>(src + i * sampleBytes);
+        }
+        return;
+    }
+
+    for (size_t f = 0; f < frames; ++f) {
+        const uint8_t* frame = src + f * layout.frameBytes;
+        float* dst = out + f * static_cast<size_t>(outputChannels);
+        if (channels == 1) {
+            float value = decodeSample<Encoding, BigEndian>(frame);
+            std::fill(dst, dst + outputChannels, value);
+        } else if (outputChannels == 1) {
+            float sum = 0.0f;
+            for (int c = 0; c < channels; ++c) {
+                sum += decodeSample<Encoding, BigEndian>(frame + static_cast<size_t>(c) * sampleBytes);
+            }
+            dst[0] = sum / static_cast<float>(channels);
+        } else {
+            for (int c = 0; c < outputChannels; ++c) {
+                dst[c] = c < channels ? decodeSample<Encoding, BigEndian>(frame + static_cast<size_t>(c) * sampleBytes)
+                                      : 0.0f;
+            }
+        }
+    }
+}
+
+template <SampleEncoding Encoding>
+void convertEndian(const uint8_t* src, size_t frames, const PcmLayout& layout, float* out, int outputChannels) {
+    if (layout.bigEndian) {
+        convertFrames<Encoding, true>(src, frames, layout, out, outputChannels);
+    } else {
+        convertFrames<Encoding, false>(src, frames, layout, out, outputChannels);
+    }
+}
+
+void convert(const uint8_t* src, size_t frames, const PcmLayout& layout, float* out, int outputChannels) {
+    switch (layout.encoding) {
+        case SampleEncoding::UINT8:
+            convertEndian<SampleEncoding::UINT8>(src, frames, layout, out, outputChannels);
+            break;
+        case SampleEncoding::INT8:
+            convertEndian<SampleEncoding::INT8>(src, frames, layout, out, outputChannels);
+            break;
+        case SampleEncoding::INT16:
+            convertEndian<SampleEncoding::INT16>(src, frames, layout, out, outputChannels);
+            break;
+        case SampleEncoding::INT24:
+            convertEndian<SampleEncoding::INT24>(src, frames, layout, out, outputChannels);
+            break;
+        case SampleEncoding::INT32:
+            convertEndian<SampleEncoding::INT32>(src, frames, layout, out, outputChannels);
+            break;
+        case SampleEncoding::FLOAT32:
+            convertEndian<SampleEncoding::FLOAT32>(src, frames, layout, out, outputChannels);
+            break;
+        case SampleEncoding::FLOAT64:
+            convertEndian<SampleEncoding::FLOAT64>(src, frames, layout, out, outputChannels);
+            break;
+    }
+}
+
+const char* formatName(const std::string& filePath, const uint8_t* data, size_t size) {
+    if (size >= 12 && tagIs(data, "RIFF") && tagIs(data + 8, "WAVE")) {
+        return "wav";
+    }
+    if (size >= 12 && tagIs(data, "FORM") && (tagIs(data + 8, "AIFF") || tagIs(data + 8, "AIFC"))) {
+        return "aiff";
+    }
+    std::string extension;
+    size_t dot = filePath.find_last_of('.');
+    if (dot != std::string::npos && filePath.find_first_of("/\\", dot) == std::string::npos) {
+        extension = filePath.substr(dot + 1);
+        std::transform(extension.begin(), extension.end(), extension.begin(),
+                       [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    }
+    if (extension == "pcm" || extension == "raw") {
+        return "pcm";
+    }
+    return nullptr;
+}
+
+}  // namespace
+
+bool parseWavHeader(const uint8_t* data, size_t size, PcmLayout& layout, AudioInfo& info) {
+    if (size < 12 || !tagIs(data, "RIFF") || !tagIs(data + 8, "WAVE")) {
+        return false;
+    }
+
+    bool haveFormat = false;
+    uint16_t formatTag = 0;
+    size_t blockAlign = 0;
+    uint64_t dataOffset = 0, dataBytes = 0;
+    bool haveData = false;
+
+    size_t pos = 12;
+    while (pos + 8 <= size) {
+        const uint8_t* chunk = data + pos;
+        uint64_t chunkSize = le32(chunk + 4);
+        const uint8_t* body = chunk + 8;
+        size_t bodySize = static_cast<size_t>(std::min<uint64_t>(chunkSize, size - pos - 8));
+
+        if (tagIs(chunk, "fmt ") && bodySize >= 16) {
+            formatTag = le16(body);
+            layout.channels = le16(body + 2);
+            layout.sampleRate = static_cast<int>(le32(body + 4));
+            blockAlign = le16(body + 12);
+            layout.bitsPerSample = le16(body + 14);
+            if (formatTag == kWaveExtensible && bodySize >= 40) {
+                uint16_t validBits = le16(body + 18);
+                if (validBits != 0) {
+                    layout.bitsPerSample = validBits;
+                }
+                // 子格式 GUID 的前两个字节就是对应的格式标签
+                formatTag = le16(body + 24);
+            }
+            haveFormat = true;
+        } else if (tagIs(chunk, "data")) {
+            dataOffset = pos + 8;
+            // 流式写入的文件大小字段可能是 0 或 0xFFFFFFFF，按到文件末尾处理
+            dataBytes = (chunkSize == 0 || chunkSize == 0xFFFFFFFFu) ? size - dataOffset : chunkSize;
+            haveData = true;
+            if (dataOffset + dataBytes >= size) {
+                break;
+            }
+        } else if (tagIs(chunk, "LIST") && bodySize >= 4 && tagIs(body, "INFO")) {
+            size_t sub = 4;
+            while (sub + 8 <= bodySize) {
+                const uint8_t* item = body + sub;
+                size_t itemSize = std::min<size_t>(le32(item + 4), bodySize - sub - 8);
+                if (tagIs(item, "INAM")) {
+                    info.title = chunkText(item + 8, itemSize);
+                } else if (tagIs(item, "IART")) {
+                    info.artist = chunkText(item + 8, itemSize);
+                } else if (tagIs(item, "IPRD")) {
+                    info.album = chunkText(item + 8, itemSize);
+                }
+                sub += 8 + itemSize + (itemSize & 1);
+            }
+        }
+        // 块按偶数字节对齐
+        pos += 8 + static_cast<size_t>(std::min<uint64_t>(chunkSize + (chunkSize & 1), size));
+    }
+
+    if (!haveFormat || !haveData || layout.channels <= 0 || blockAlign == 0 ||
+        blockAlign % static_cast<size_t>(layout.channels) != 0) {
+        return false;
+    }
+    if (formatTag != kWavePcm && formatTag != kWaveFloat) {
+        return false;
+    }
+
+    size_t container = blockAlign / static_cast<size_t>(layout.channels);
+    if (!encodingForContainer(container, formatTag == kWaveFloat, true, layout.encoding)) {
+        return false;
+    }
+    layout.bigEndian = false;
+    layout.frameBytes = blockAlign;
+    return finishLayout(layout, size, dataOffset, dataBytes);
+}
+
+bool parseAiffHeader(const uint8_t* data, size_t size, PcmLayout& layout, AudioInfo& info) {
+    if (size < 12 || !tagIs(data, "FORM") || !(tagIs(data + 8, "AIFF") || tagIs(data + 8, "AIFC"))) {
+        return false;
+    }
+    bool aifc = tagIs(data + 8, "AIFC");
+
+    bool haveCommon = false, haveSound = false;
+    bool isFloat = false;
+    uint64_t declaredFrames = 0;
+    uint64_t dataOffset = 0, dataBytes = 0;
+    layout.bigEndian = true;
+
+    size_t pos = 12;
+    while (pos + 8 <= size) {
+        const uint8_t* chunk = data + pos;
+        uint64_t chunkSize = be32(chunk + 4);
+        const uint8_t* body = chunk + 8;
+        size_t bodySize = static_cast<size_t>(std::min<uint64_t>(chunkSize, size - pos - 8));
+
+        if (tagIs(chunk, "COMM") && bodySize >= 18) {
+            layout.channels = static_cast<int16_t>(be16(body));
+            declaredFrames = be32(body + 2);
+            layout.bitsPerSample = static_cast<int16_t>(be16(body + 6));
+            layout.sampleRate = static_cast<int>(std::lround(extendedToDouble(body + 8)));
+            if (aifc && bodySize >= 22) {
+                const uint8_t* compression = body + 18;
+                if (tagIs(compression, "sowt")) {
+                    layout.bigEndian = false;
+                } else if (tagIs(compression, "fl32") || tagIs(compression, "FL32") ||
+                           tagIs(compression, "fl64") || tagIs(compression, "FL64")) {
+                    isFloat = true;
+                } else if (!tagIs(compression, "NONE") && !tagIs(compression, "twos")) {
+                    return false;
+                }
+                if (isFloat) {
+                    layout.bitsPerSample = (compression[2] == '6') ? 64 : 32;
+                }
+            }
+            haveCommon = true;
+        } else if (tagIs(chunk, "SSND") && bodySize >= 8) {
+            uint32_t offset = be32(body);
+            dataOffset = pos + 16 + offset;
+            dataBytes = chunkSize >= 8 + static_cast<uint64_t>(offset) ? chunkSize - 8 - offset : 0;
+            haveSound = true;
+        } else if (tagIs(chunk, "NAME")) {
+            info.title = chunkText(body, bodySize);
+        } else if (tagIs(chunk, "AUTH")) {
+            info.artist = chunkText(body, bodySize);
+        }
+        pos += 8 + static_cast<size_t>(std::min<uint64_t>(chunkSize + (chunkSize & 1), size));
+    }
+
+    if (!haveCommon || !haveSound || layout.channels <= 0 || layout.bitsPerSample <= 0) {
+        return false;
+    }
+
+    // 采样按整字节存放，有效位数不足时左对齐
+    size_t container = (static_cast<size_t>(layout.bitsPerSample) + 7) / 8;
+    if (!encodingForContainer(container, isFloat, false, layout.encoding)) {
+        return false;
+    }
+    layout.frameBytes = container * static_cast<size_t>(layout.channels);
+    if (!finishLayout(layout, size, dataOffset, dataBytes)) {
+        return false;
+    }
+    layout.frames = std::min(layout.frames, declaredFrames);
+    return true;
+}
+
+// ===== PcmFileSource =====
+
+PcmFileSource::PcmFileSource(std::unique_ptr<MappedFile> file, const PcmLayout& layout, int outputChannels)
+    : file_(std::move(file)), layout_(layout), output_channels_(outputChannels) {
+    file_->adviseSequential();
+}
+
+size_t PcmFileSource::read(float* out, size_t frames) {
+    uint64_t remaining = layout_.frames - position_;
+    size_t n = static_cast<size_t>(std::min<uint64_t>(frames, remaining));
+    const uint8_t* src = file_->data() + layout_.dataOffset + position_ * layout_.frameBytes;
+    convert(src, n, layout_, out, output_channels_);
+    position_ += n;
+    return n;
+}
+
+bool PcmFileSource::seek(uint64_t frame) {
+    position_ = std::min(frame, layout_.frames);
+    file_->adviseWillNeed(static_cast<size_t>(layout_.dataOffset + position_ * layout_.frameBytes), kSeekReadahead);
+    return true;
+}
+
+PcmOpenResult openPcmFile(const std::string& filePath, int sampleRate, int channels,
+                          std::unique_ptr<AudioSource>& source, AudioInfo& info) {
+    auto file = std::make_unique<MappedFile>();
+    if (!file->open(filePath)) {
+        return PcmOpenResult::NOT_PCM;
+    }
+    const char* format = formatName(filePath, file->data(), file->size());
+    if (format == nullptr) {
+        return PcmOpenResult::NOT_PCM;
+    }
+
+    PcmLayout layout;
+    AudioInfo parsed;
+    bool valid = false;
+    if (std::strcmp(format, "wav") == 0) {
+        valid = parseWavHeader(file->data(), file->size(), layout, parsed);
+    } else if (std::strcmp(format, "aiff") == 0) {
+        valid = parseAiffHeader(file->data(), file->size(), layout, parsed);
+    } else {
+        layout.encoding = SampleEncoding::INT16;
+        layout.sampleRate = sampleRate;
+        layout.channels = channels;
+        layout.bitsPerSample = 16;
+        layout.frameBytes = 2 * static_cast<size_t>(channels);
+        valid = finishLayout(layout, file->size(), 0, file->size());
+    }
+    if (!valid) {
+        return PcmOpenResult::UNSUPPORTED;
+    }
+
+    info = parsed;
+    if (info.title.empty()) {
+        info.title = fileStem(filePath);
+    }
+    info.duration = static_cast<int>(layout.frames * 1000 / static_cast<uint64_t>(layout.sampleRate));
+    info.format = format;
+    info.sampleRate = layout.sampleRate;
+    info.channels = layout.channels;
+    info.bitsPerSample = layout.bitsPerSample;
+
+    source = std::make_unique<PcmFileSource>(std::move(file), layout, channels);
+    return PcmOpenResult::OK;
+}
+
+}  // namespace musicfree
@@ -0,0 +1,100 @@
+#ifndef MUSICFREE_PCM_FILE_SOURCE_H
+#define MUSICFREE_PCM_FILE_SOURCE_H
+
+#include "../include/audio_engine.h"
+#include "audio_source.h"
+#include "mapped_file.h"
+#include <memory>
+#include <string>
+
+namespace musicfree {
+
+// PCM 采样编码
+enum class SampleEncoding {
+    UINT8 = 0,    // WAV 的 8 位（无符号，偏移 128）
+    INT8 = 1,     // AIFF 的 8 位
+    INT16 = 2,
+    INT24 = 3,
+    INT32 = 4,
+    FLOAT32 = 5,
+    FLOAT64 = 6
+};
+
+/**
+ * 未压缩 PCM 数据在文件中的布局（由文件头解析得到）
+ */
+struct PcmLayout {
+    SampleEncoding encoding = SampleEncoding::INT16;
+    bool bigEndian = false;
+    int sampleRate = 0;
+    int channels = 0;
+    int bitsPerSample = 0;    // 有效位数
+    size_t frameBytes = 0;    // 每帧字节数（各声道的采样容器之和）
+    uint64_t dataOffset = 0;  // 第一帧在文件中的偏移
+    uint64_t frames = 0;      // 按文件实际长度截断后的帧数
+};
+
+// openPcmFile 的结果
+enum class PcmOpenResult {
+    OK = 0,
+    NOT_PCM = 1,     // 不是 WAV / AIFF / 原始 PCM，或文件无法映射（交给其他解码器）
+    UNSUPPORTED = 2  // 格式可以识别，但文件头损坏或编码不支持
+};
+
+/**
+ * 解析 WAV（RIFF / WAVE，PCM、IEEE float 和 WAVE_FORMAT_EXTENSIBLE）文件头
+ * 标签取自 LIST/INFO 块（INAM / IART / IPRD）
+ * @return 文件头有效且编码受支持时返回 true
+ */
+bool parseWavHeader(const uint8_t* data, size_t size, PcmLayout& layout, AudioInfo& info);
+
+/**
+ * 解析 AIFF / AIFF-C（NONE / twos / sowt / fl32 / fl64）文件头
+ * 标签取自 NAME / AUTH 块
+ * @return 文件头有效且编码受支持时返回 true
+ */
+bool parseAiffHeader(const uint8_t* data, size_t size, PcmLayout& layout, AudioInfo& info);
+
+/**
+ * 映射文件的 PCM 数据源
+ *
+ * 直接从映射读取并转换成 float32，不经过 read() 拷贝；打开时提示内核顺序访问，
+ * 跳转后对新位置发起预读。声道数与输出不同时：单声道复制到各声道，
+ * 输出为单声道时取各声道平均，其他情况取前几个声道。
+ */
+class PcmFileSource : public AudioSource {
+public:
+    PcmFileSource(std::unique_ptr<MappedFile> file, const PcmLayout& layout, int outputChannels);
+
+    int sampleRate() const override { return layout_.sampleRate; }
+    int channels() const override { return output_channels_; }
+    uint64_t totalFrames() const override { return layout_.frames; }
+    size_t read(float* out, size_t frames) override;
+    bool seek(uint64_t frame) override;
+
+    const PcmLayout& layout() const { return layout_; }
+
+private:
+    std::unique_ptr<MappedFile> file_;
+    PcmLayout layout_;
+    int output_channels_;
+    uint64_t position_ = 0;
+};
+
+/**
+ * 打开 WAV / AIFF / 原始 PCM 文件（按文件头识别；扩展名为 .pcm / .raw 时按原始 PCM 处理，
+ * 格式为 16 位小端、采样率和声道数与输出相同）
+ * 只建立映射并解析文件头，耗时与文件大小无关
+ * @param filePath 文件路径
+ * @param sampleRate 输出采样率（原始 PCM 按这个采样率解释）；数据源保持文件自己的采样率，由调用方重采样
+ * @param channels 输出声道数
+ * @param source 成功时输出数据源
+ * @param info 成功时输出音频信息，标题缺省为文件名
+ * @return 打开结果
+ */
+PcmOpenResult openPcmFile(const std::string& filePath, int sampleRate, int channels,
+                          std::unique_ptr<AudioSource>& source, AudioInfo& info);
+
+}  // namespace musicfree
+
+#endif  // MUSICFREE_PCM_FILE_SOURCE_H
@@ -0,0 +1,76 @@
+#include "pcm_ring_buffer.h"
+#include <algorithm>
+#include <cstring>
+
+namespace musicfree {
+
+PcmRingBuffer::PcmRingBuffer(size_t capacityFrames, int channels) : channels_(channels) {
+    capacity_ = 1;
+    while (capacity_ < capacityFrames) {
+        capacity_ <<= 1;
+    }
+    mask_ = capacity_ - 1;
+    data_.assign(capacity_ * static_cast<size_t>(channels_), 0.0f);
+}
+
+size_t PcmRingBuffer::write(const float* frames, size_t count) {
+    uint64_t writePos = write_pos_.load(std::memory_order_relaxed);
+    if (capacity_ - (writePos - cached_read_pos_) < count) {
+        cached_read_pos_ = read_pos_.load(std::memory_order_acquire);
+    }
+    size_t n = std::min(count, static_cast<size_t>(capacity_ - (writePos - cached_read_pos_)));
+    if (n == 0) {
+        return 0;
+    }
+
+    size_t offset = static_cast<size_t>(writePos) & mask_;
+    size_t first = std::min(n, capacity_ - offset);
+    size_t channels = static_cast<size_t>(channels_);
+    std::memcpy(&data_[offset * channels], frames, first * channels * sizeof(float));
+    if (n > first) {
+        std::memcpy(&data_[0], frames + first * channels, (n - first) * channels * sizeof(float));
+    }
+
+    write_pos_.store(writePos + n, std::memory_order_release);
+    return n;
+}
+
+size_t PcmRingBuffer::read(float* out, size_t count) {
+    uint64_t readPos = read_pos_.load(std::memory_order_relaxed);
+    if (cached_write_pos_ - readPos < count) {
+        cached_write_pos_ = write_pos_.load(std::memory_order_acquire);
+    }
+    size_t n = std::min(count, static_cast<size_t>(cached_write_pos_ - readPos));
+    if (n == 0) {
+        return 0;
+    }
+
+    size_t offset = static_cast<size_t>(readPos) & mask_;
+    size_t first = std::min(n, capacity_ - offset);
+    size_t channels = static_cast<size_t>(channels_);
+    std::memcpy(out, &data_[offset * channels], first * channels * sizeof(float));
+    if (n > first) {
+        std::memcpy(out + first * channels, &data_[0], (n - first) * channels * sizeof(float));
+    }
+
+    read_pos_.store(readPos + n, std::memory_order_release);
+    return n;
+}
+
+size_t PcmRingBuffer::readAvailable() const {
+    return static_cast<size_t>(write_pos_.load(std::memory_order_acquire) -
+                               read_pos_.load(std::memory_order_acquire));
+}
+
+size_t PcmRingBuffer::writeAvailable() const {
+    return capacity_ - readAvailable();
+}
+
+void PcmRingBuffer::reset() {
+    write_pos_.store(0, std::memory_order_relaxed);
+    read_pos_.store(0, std::memory_order_relaxed);
+    cached_read_pos_ = 0;
+    cached_write_pos_ = 0;
+}
+
+}  // namespace musicfree
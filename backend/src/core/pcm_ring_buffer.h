@@ -0,0 +1,83 @@
+#ifndef MUSICFREE_PCM_RING_BUFFER_H
+#define MUSICFREE_PCM_RING_BUFFER_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace musicfree {
+
+/**
+ * 单生产者 / 单消费者的 PCM 环形缓冲区（float32 交错采样）
+ *
+ * 解码线程写入、输出线程读取，两端都不加锁也不分配内存：读写位置是单调递增的
+ * 64 位帧计数（不会回绕），生产者以 release 发布写位置，消费者以 acquire 读取，反之亦然。
+ * 两端各自缓存对方的位置，只有缓存的值显示空间不够时才重新读取对方的原子变量，
+ * 减少两个核之间的缓存行来回。
+ *
+ * 容量向上取整为 2 的幂帧数。reset() 只能在两端都停下时调用。
+ */
+class PcmRingBuffer {
+public:
+    /**
+     * @param capacityFrames 最少容纳的帧数
+     * @param channels 声道数
+     */
+    PcmRingBuffer(size_t capacityFrames, int channels);
+
+    // 禁止拷贝
+    PcmRingBuffer(const PcmRingBuffer&) = delete;
+    PcmRingBuffer& operator=(const PcmRingBuffer&) = delete;
+
+    /**
+     * 写入帧（仅生产者调用）
+     * @param frames 交错采样
+     * @param count 帧数
+     * @return 实际写入的帧数，空间不足时少于 count
+     */
+    size_t write(const float* frames, size_t count);
+
+    /**
+     * 读取帧（仅消费者调用）
+     * @param out 输出缓冲区，至少 count * channels 个采样
+     * @param count 帧数
+     * @return 实际读取的帧数，数据不足时少于 count
+     */
+    size_t read(float* out, size_t count);
+
+    /**
+     * 可读帧数（消费者调用时是准确值，生产者调用时是下限）
+     */
+    size_t readAvailable() const;
+
+    /**
+     * 可写帧数（生产者调用时是准确值，消费者调用时是下限）
+     */
+    size_t writeAvailable() const;
+
+    /**
+     * 清空缓冲区
+     * 调用方必须保证生产者和消费者都没有在访问缓冲区（例如两端都在等待同一把锁之后）
+     */
+    void reset();
+
+    size_t capacity() const { return capacity_; }
+    int channels() const { return channels_; }
+
+private:
+    std::vector<float> data_;
+    size_t capacity_;
+    size_t mask_;
+    int channels_;
+
+    // 生产者和消费者的位置放在不同的缓存行，避免伪共享
+    alignas(64) std::atomic<uint64_t> write_pos_{0};
+    uint64_t cached_read_pos_ = 0;  // 生产者看到的读位置
+    alignas(64) std::atomic<uint64_t> read_pos_{0};
+    uint64_t cached_write_pos_ = 0;  // 消费者看到的写位置
+};
+
+}  // namespace musicfree
+
+#endif  // MUSICFREE_PCM_RING_BUFFER_H
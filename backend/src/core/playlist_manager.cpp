@@ -5,6 +5,15 @@
 
 namespace musicfree {
 
+namespace {
+
+// 计数器只有一个写者（修改操作由调用方互斥），不需要原子加法
+void bump(std::atomic<uint64_t>& counter, uint64_t delta) {
+    counter.store(counter.load(std::memory_order_relaxed) + delta, std::memory_order_relaxed);
+}
+
+}  // namespace
+
 PlaylistManager::PlaylistManager() {
     // 初始化播放列表
     current_playlist_.id = "default";
@@ -17,10 +26,25 @@ PlaylistManager::~PlaylistManager() = default;
 void PlaylistManager::addTrack(const Track& track) {
     current_playlist_.tracks.push_back(track);
     current_playlist_.updatedAt = std::time(nullptr);
+    ++version_;
+    bump(adds_, 1);
+    bump(tracks_added_, 1);
     
-    if (playlist_changed_callback_) {
-        playlist_changed_callback_(current_playlist_);
+    notifyChanged();
+}
+
+void PlaylistManager::addTracks(const std::vector<Track>& tracks) {
+    if (tracks.empty()) {
+        return;
     }
+
+    current_playlist_.tracks.insert(current_playlist_.tracks.end(), tracks.begin(), tracks.end());
+    current_playlist_.updatedAt = std::time(nullptr);
+    ++version_;
+    bump(adds_, 1);
+    bump(tracks_added_, tracks.size());
+    
+    notifyChanged();
 }
 
 void PlaylistManager::removeTrack(int index) {
@@ -30,30 +54,51 @@ void PlaylistManager::removeTrack(int index) {
     
     current_playlist_.tracks.erase(current_playlist_.tracks.begin() + index);
     current_playlist_.updatedAt = std::time(nullptr);
+    ++version_;
+    bump(removes_, 1);
+    bump(tracks_removed_, 1);
     
     if (current_track_index_ >= static_cast<int>(current_playlist_.tracks.size())) {
         current_track_index_ = current_playlist_.tracks.size() - 1;
     }
     
-    if (playlist_changed_callback_) {
-        playlist_changed_callback_(current_playlist_);
-    }
+    notifyChanged();
 }
 
 void PlaylistManager::clear() {
+    bump(clears_, 1);
+    bump(tracks_removed_, current_playlist_.tracks.size());
     current_playlist_.tracks.clear();
     current_playlist_.updatedAt = std::time(nullptr);
+    ++version_;
     current_track_index_ = -1;
     
-    if (playlist_changed_callback_) {
-        playlist_changed_callback_(current_playlist_);
-    }
+    notifyChanged();
 }
 
 Playlist PlaylistManager::getCurrentPlaylist() const {
     return current_playlist_;
 }
 
+const Playlist& PlaylistManager::viewCurrentPlaylist() const {
+    return current_playlist_;
+}
+
+uint64_t PlaylistManager::getVersion() const {
+    return version_;
+}
+
+PlaylistMutationCounts PlaylistManager::getMutationCounts() const {
+    PlaylistMutationCounts counts;
+    counts.adds = adds_.load(std::memory_order_relaxed);
+    counts.tracksAdded = tracks_added_.load(std::memory_order_relaxed);
+    counts.removes = removes_.load(std::memory_order_relaxed);
+    counts.clears = clears_.load(std::memory_order_relaxed);
+    counts.tracksRemoved = tracks_removed_.load(std::memory_order_relaxed);
+    counts.batches = batches_.load(std::memory_order_relaxed);
+    return counts;
+}
+
 int PlaylistManager::getCurrentTrackIndex() const {
     return current_track_index_;
 }
@@ -61,6 +106,7 @@ int PlaylistManager::getCurrentTrackIndex() const {
 void PlaylistManager::setCurrentTrackIndex(int index) {
     if (index >= 0 && index < static_cast<int>(current_playlist_.tracks.size())) {
         current_track_index_ = index;
+        shuffle_next_ = -1;
     }
 }
 
@@ -70,7 +116,7 @@ bool PlaylistManager::playNext() {
     }
     
     if (play_mode_ == PlayMode::SHUFFLE) {
-        current_track_index_ = rand() % current_playlist_.tracks.size();
+        current_track_index_ = takeShufflePick();
     } else {
         current_track_index_++;
         
@@ -92,6 +138,7 @@ bool PlaylistManager::playPrevious() {
         return false;
     }
     
+    shuffle_next_ = -1;
     current_track_index_--;
     
     if (current_track_index_ < 0) {
@@ -106,6 +153,38 @@ bool PlaylistManager::playPrevious() {
     return true;
 }
 
+int PlaylistManager::peekNextTrackIndex() {
+    int count = static_cast<int>(current_playlist_.tracks.size());
+    if (count == 0) {
+        return -1;
+    }
+
+    switch (play_mode_) {
+        case PlayMode::SHUFFLE:
+            if (shuffle_next_ < 0 || shuffle_next_ >= count || shuffle_version_ != version_) {
+                shuffle_next_ = rand() % count;
+                shuffle_version_ = version_;
+            }
+            return shuffle_next_;
+        case PlayMode::REPEAT_ONE:
+            if (current_track_index_ >= 0 && current_track_index_ < count) {
+                return current_track_index_;
+            }
+            return 0;
+        case PlayMode::REPEAT_ALL:
+            return current_track_index_ + 1 < count ? current_track_index_ + 1 : 0;
+        case PlayMode::ORDER:
+            break;
+    }
+    return current_track_index_ + 1 < count ? current_track_index_ + 1 : -1;
+}
+
+int PlaylistManager::takeShufflePick() {
+    int index = peekNextTrackIndex();
+    shuffle_next_ = -1;
+    return index;
+}
+
 PlayMode PlaylistManager::getPlayMode() const {
     return play_mode_;
 }
@@ -129,4 +208,30 @@ void PlaylistManager::onPlaylistChanged(PlaylistChangedCallback callback) {
     playlist_changed_callback_ = callback;
 }
 
+void PlaylistManager::beginBatch() {
+    if (batch_depth_++ == 0) {
+        bump(batches_, 1);
+    }
+}
+
+void PlaylistManager::endBatch() {
+    if (batch_depth_ == 0 || --batch_depth_ > 0) {
+        return;
+    }
+    if (batch_changed_) {
+        batch_changed_ = false;
+        notifyChanged();
+    }
+}
+
+void PlaylistManager::notifyChanged() {
+    if (batch_depth_ > 0) {
+        batch_changed_ = true;
+        return;
+    }
+    if (playlist_changed_callback_) {
+        playlist_changed_callback_(current_playlist_);
+    }
+}
+
 }  // namespace musicfree
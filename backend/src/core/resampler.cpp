@@ -0,0 +1,378 @@
+#include "resampler.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <numeric>
+#include <tuple>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define MUSICFREE_RESAMPLER_X86 1
+#endif
+
+namespace musicfree {
+
+namespace {
+
+constexpr double kPi = 3.14159265358979323846;
+
+// 每次 push 最多的帧数（历史缓冲区在滤波器长度之外的余量）
+constexpr size_t kMaxPushFrames = 4096;
+
+/**
+ * 质量档位的设计参数：以较低采样率计的每相抽头数、通带边缘和阻带边缘
+ * （相对较低采样率的奈奎斯特频率，关于 1 对称）
+ */
+struct QualitySpec {
+    size_t taps;
+    double passband;
+    double stopband;
+};
+
+QualitySpec qualitySpec(ResamplerQuality quality) {
+    switch (quality) {
+        case ResamplerQuality::LOW: return {16, 0.80, 1.20};
+        case ResamplerQuality::MEDIUM: return {32, 0.85, 1.15};
+        case ResamplerQuality::HIGH: return {64, 0.90, 1.10};
+        case ResamplerQuality::BEST: return {128, 0.93, 1.07};
+    }
+    return {64, 0.90, 1.10};
+}
+
+// 第一类零阶修正贝塞尔函数（级数展开）
+double besselI0(double x) {
+    double sum = 1.0, term = 1.0;
+    double half = x / 2.0;
+    for (int k = 1; k < 200; ++k) {
+        term *= (half / k) * (half / k);
+        sum += term;
+        if (term < sum * 1e-16) {
+            break;
+        }
+    }
+    return sum;
+}
+
+/**
+ * 按 Kaiser 公式由抽头数和过渡带宽估计阻带衰减，再得到窗的 β
+ */
+double kaiserAttenuation(const QualitySpec& spec) {
+    double transition = kPi * (spec.stopband - spec.passband);
+    return std::max(21.0, 8.0 + 2.285 * transition * static_cast<double>(spec.taps));
+}
+
+double kaiserBeta(double attenuation) {
+    if (attenuation > 50.0) {
+        return 0.1102 * (attenuation - 8.7);
+    }
+    if (attenuation >= 21.0) {
+        return 0.5842 * std::pow(attenuation - 21.0, 0.4) + 0.07886 * (attenuation - 21.0);
+    }
+    return 0.0;
+}
+
+std::shared_ptr<ResamplerFilterBank> designFilterBank(uint64_t up, uint64_t down, ResamplerQuality quality) {
+    QualitySpec spec = qualitySpec(quality);
+    auto bank = std::make_shared<ResamplerFilterBank>();
+    bank->upFactor = up;
+    bank->downFactor = down;
+    bank->passband = spec.passband;
+    bank->stopbandDb = kaiserAttenuation(spec);
+
+    // 降采样时截止频率按比例降低，同样的过渡带在输入采样率下要按比例多用抽头
+    double ratio = static_cast<double>(up) / static_cast<double>(down);
+    double scale = std::min(1.0, ratio);
+    size_t taps = static_cast<size_t>(std::ceil(static_cast<double>(spec.taps) / scale));
+    taps = (taps + 7) / 8 * 8;
+    bank->taps = taps;
+    bank->interpolated = up > kMaxExactPhases;
+    bank->phases = bank->interpolated ? kInterpolatedPhases + 1 : static_cast<size_t>(up);
+    bank->coefficients.resize(bank->phases * taps);
+
+    double half = static_cast<double>(taps / 2);
+    double cutoff = 0.5 * scale;  // 每个输入采样的周期数
+    double beta = kaiserBeta(bank->stopbandDb);
+    double norm = besselI0(beta);
+    for (size_t p = 0; p < bank->phases; ++p) {
+        double offset = bank->interpolated ? static_cast<double>(p) / kInterpolatedPhases
+                                           : static_cast<double>(p) / static_cast<double>(up);
+        float* row = bank->coefficients.data() + p * taps;
+        double sum = 0.0;
+        std::vector<double> values(taps);
+        for (size_t k = 0; k < taps; ++k) {
+            double t = offset + half - 1.0 - static_cast<double>(k);
+            double x = 2.0 * cutoff * t;
+            double sinc = std::abs(x) < 1e-12 ? 1.0 : std::sin(kPi * x) / (kPi * x);
+            double w = t / half;
+            double window = std::abs(w) >= 1.0 ? 0.0 : besselI0(beta * std::sqrt(1.0 - w * w)) / norm;
+            values[k] = sinc * window;
+            sum += values[k];
+        }
+        for (size_t k = 0; k < taps; ++k) {
+            row[k] = static_cast<float>(values[k] / sum);
+        }
+    }
+    return bank;
+}
+
+float dotScalar(const float* a, const float* b, size_t n) {
+    float sum = 0.0f;
+    for (size_t i = 0; i < n; ++i) {
+        sum += a[i] * b[i];
+    }
+    return sum;
+}
+
+#ifdef MUSICFREE_RESAMPLER_X86
+
+__attribute__((target("sse4.1")))
+float dotSse(const float* a, const float* b, size_t n) {
+    __m128 acc0 = _mm_setzero_ps(), acc1 = _mm_setzero_ps();
+    for (size_t i = 0; i < n; i += 8) {
+        acc0 = _mm_add_ps(acc0, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+        acc1 = _mm_add_ps(acc1, _mm_mul_ps(_mm_loadu_ps(a + i + 4), _mm_loadu_ps(b + i + 4)));
+    }
+    __m128 acc = _mm_add_ps(acc0, acc1);
+    acc = _mm_add_ps(acc, _mm_movehl_ps(acc, acc));
+    acc = _mm_add_ss(acc, _mm_shuffle_ps(acc, acc, 1));
+    return _mm_cvtss_f32(acc);
+}
+
+__attribute__((target("avx2")))
+float dotAvx2(const float* a, const float* b, size_t n) {
+    __m256 acc0 = _mm256_setzero_ps(), acc1 = _mm256_setzero_ps();
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        acc0 = _mm256_add_ps(acc0, _mm256_mul_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i)));
+        acc1 = _mm256_add_ps(acc1, _mm256_mul_ps(_mm256_loadu_ps(a + i + 8), _mm256_loadu_ps(b + i + 8)));
+    }
+    if (i < n) {
+        acc0 = _mm256_add_ps(acc0, _mm256_mul_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i)));
+    }
+    __m256 acc = _mm256_add_ps(acc0, acc1);
+    __m128 sum = _mm_add_ps(_mm256_castps256_ps128(acc), _mm256_extractf128_ps(acc, 1));
+    sum = _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+    sum = _mm_add_ss(sum, _mm_shuffle_ps(sum, sum, 1));
+    return _mm_cvtss_f32(sum);
+}
+
+#endif  // MUSICFREE_RESAMPLER_X86
+
+// 滤波器组缓存：键为 (L, M, 档位)
+std::mutex bank_mutex;
+std::map<std::tuple<uint64_t, uint64_t, int>, std::shared_ptr<const ResamplerFilterBank>> bank_cache;
+
+}  // namespace
+
+std::shared_ptr<const ResamplerFilterBank> resamplerFilterBank(int inputRate, int outputRate,
+                                                               ResamplerQuality quality) {
+    uint64_t g = std::gcd(static_cast<uint64_t>(inputRate), static_cast<uint64_t>(outputRate));
+    uint64_t up = static_cast<uint64_t>(outputRate) / g;
+    uint64_t down = static_cast<uint64_t>(inputRate) / g;
+    auto key = std::make_tuple(up, down, static_cast<int>(quality));
+    {
+        std::lock_guard<std::mutex> lock(bank_mutex);
+        auto it = bank_cache.find(key);
+        if (it != bank_cache.end()) {
+            return it->second;
+        }
+    }
+    // 在锁外计算；两个线程同时计算同一组时保留先放进缓存的那个
+    std::shared_ptr<const ResamplerFilterBank> bank = designFilterBank(up, down, quality);
+    std::lock_guard<std::mutex> lock(bank_mutex);
+    return bank_cache.emplace(key, std::move(bank)).first->second;
+}
+
+void prewarmResamplerFilterBanks(int outputRate, ResamplerQuality quality) {
+    static const int kCommonRates[] = {22050, 32000, 44100, 48000, 88200, 96000, 176400, 192000};
+    for (int rate : kCommonRates) {
+        if (rate != outputRate) {
+            resamplerFilterBank(rate, outputRate, quality);
+        }
+    }
+}
+
+const char* resamplerQualityName(ResamplerQuality quality) {
+    switch (quality) {
+        case ResamplerQuality::LOW: return "low";
+        case ResamplerQuality::MEDIUM: return "medium";
+        case ResamplerQuality::HIGH: return "high";
+        case ResamplerQuality::BEST: return "best";
+    }
+    return "high";
+}
+
+float resamplerDot(const float* a, const float* b, size_t n, SimdLevel level) {
+#ifdef MUSICFREE_RESAMPLER_X86
+    if (level == SimdLevel::AVX2) {
+        return dotAvx2(a, b, n);
+    }
+    if (level == SimdLevel::SSE42) {
+        return dotSse(a, b, n);
+    }
+#else
+    (void)level;
+#endif
+    return dotScalar(a, b, n);
+}
+
+// ===== Resampler =====
+
+Resampler::Resampler(int inputRate, int outputRate, int channels, ResamplerQuality quality, SimdLevel level)
+    : bank_(resamplerFilterBank(inputRate, outputRate, quality)),
+      channels_(channels),
+      level_(std::min(level, detectSimdLevel())),
+      taps_(bank_->taps),
+      half_(bank_->taps / 2),
+      capacity_(bank_->taps + kMaxPushFrames) {
+    history_.resize(capacity_ * static_cast<size_t>(channels_));
+    if (bank_->interpolated) {
+        blended_.resize(taps_);
+    }
+    restart(0);
+}
+
+uint64_t Resampler::restart(uint64_t outputFrame) {
+    uint64_t up = bank_->upFactor;
+    uint64_t down = bank_->downFactor;
+    // 输出帧的输入时间为 outputFrame * M / L；分开整数和分数部分避免溢出
+    uint64_t index = outputFrame / up * down + (outputFrame % up) * down / up;
+    phase_ = (outputFrame % up) * down % up;
+
+    // 窗口从 index - half + 1 开始，起点之前的部分补静音
+    uint64_t lead = static_cast<uint64_t>(half_ - 1);
+    uint64_t first = index >= lead ? index - lead : 0;
+    size_t zeros = static_cast<size_t>(lead - (index - first));
+    start_ = 0;
+    count_ = zeros;
+    for (int c = 0; c < channels_; ++c) {
+        std::fill_n(history_.begin() + static_cast<ptrdiff_t>(static_cast<size_t>(c) * capacity_), zeros, 0.0f);
+    }
+    return first;
+}
+
+size_t Resampler::writable() const {
+    return capacity_ - (count_ - start_);
+}
+
+void Resampler::compact() {
+    if (start_ == 0) {
+        return;
+    }
+    size_t remaining = count_ - start_;
+    for (int c = 0; c < channels_; ++c) {
+        float* channel = history_.data() + static_cast<size_t>(c) * capacity_;
+        std::memmove(channel, channel + start_, remaining * sizeof(float));
+    }
+    start_ = 0;
+    count_ = remaining;
+}
+
+void Resampler::push(const float* in, size_t frames) {
+    frames = std::min(frames, writable());
+    if (count_ + frames > capacity_) {
+        compact();
+    }
+    size_t channels = static_cast<size_t>(channels_);
+    for (size_t c = 0; c < channels; ++c) {
+        float* dst = history_.data() + c * capacity_ + count_;
+        const float* src = in + c;
+        for (size_t f = 0; f < frames; ++f) {
+            dst[f] = src[f * channels];
+        }
+    }
+    count_ += frames;
+}
+
+void Resampler::pushSilence(size_t frames) {
+    frames = std::min(frames, writable());
+    if (count_ + frames > capacity_) {
+        compact();
+    }
+    for (int c = 0; c < channels_; ++c) {
+        std::fill_n(history_.begin() + static_cast<ptrdiff_t>(static_cast<size_t>(c) * capacity_ + count_), frames,
+                    0.0f);
+    }
+    count_ += frames;
+}
+
+size_t Resampler::pull(float* out, size_t frames) {
+    const ResamplerFilterBank& bank = *bank_;
+    uint64_t up = bank.upFactor;
+    uint64_t down = bank.downFactor;
+    size_t channels = static_cast<size_t>(channels_);
+    size_t produced = 0;
+    while (produced < frames && start_ + taps_ <= count_) {
+        const float* row;
+        if (bank.interpolated) {
+            // 分数相位落在表里相邻两相之间，按距离混合出这一相
+            uint64_t scaled = phase_ * kInterpolatedPhases;
+            size_t index = static_cast<size_t>(scaled / up);
+            float frac = static_cast<float>(scaled % up) / static_cast<float>(up);
+            const float* a = bank.phase(index);
+            const float* b = bank.phase(index + 1);
+            for (size_t k = 0; k < taps_; ++k) {
+                blended_[k] = a[k] + (b[k] - a[k]) * frac;
+            }
+            row = blended_.data();
+        } else {
+            row = bank.phase(static_cast<size_t>(phase_));
+        }
+        for (size_t c = 0; c < channels; ++c) {
+            out[produced * channels + c] = resamplerDot(row, history_.data() + c * capacity_ + start_, taps_, level_);
+        }
+        ++produced;
+        phase_ += down;
+        start_ += static_cast<size_t>(phase_ / up);
+        phase_ %= up;
+    }
+    return produced;
+}
+
+// ===== ResamplingSource =====
+
+ResamplingSource::ResamplingSource(std::unique_ptr<AudioSource> inner, int outputRate, ResamplerQuality quality)
+    : inner_(std::move(inner)),
+      output_rate_(outputRate),
+      resampler_(inner_->sampleRate(), outputRate, inner_->channels(), quality),
+      input_(kMaxPushFrames * static_cast<size_t>(inner_->channels())) {
+    const ResamplerFilterBank& bank = resampler_.filterBank();
+    uint64_t frames = inner_->totalFrames();
+    total_frames_ = frames / bank.downFactor * bank.upFactor + frames % bank.downFactor * bank.upFactor / bank.downFactor;
+    seek(0);
+}
+
+size_t ResamplingSource::read(float* out, size_t frames) {
+    size_t channels = static_cast<size_t>(inner_->channels());
+    frames = static_cast<size_t>(std::min<uint64_t>(frames, total_frames_ - position_));
+    size_t produced = 0;
+    for (;;) {
+        size_t n = resampler_.pull(out + produced * channels, frames - produced);
+        produced += n;
+        if (produced == frames) {
+            break;
+        }
+        // 历史不够一个窗口，补充输入；内部数据源取完之后补静音
+        size_t space = std::min(resampler_.writable(), kMaxPushFrames);
+        if (!inner_eof_) {
+            size_t got = inner_->read(input_.data(), space);
+            resampler_.push(input_.data(), got);
+            inner_eof_ = got < space;
+        } else {
+            resampler_.pushSilence(space);
+        }
+    }
+    position_ += produced;
+    return produced;
+}
+
+bool ResamplingSource::seek(uint64_t frame) {
+    position_ = std::min(frame, total_frames_);
+    uint64_t input = resampler_.restart(position_);
+    inner_eof_ = input >= inner_->totalFrames();
+    return inner_->seek(std::min(input, inner_->totalFrames()));
+}
+
+}  // namespace musicfree
@@ -0,0 +1,154 @@
+#ifndef MUSICFREE_RESAMPLER_H
+#define MUSICFREE_RESAMPLER_H
+
+#include "../include/audio_engine.h"
+#include "audio_source.h"
+#include "simd_level.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace musicfree {
+
+/**
+ * 多相滤波器组
+ *
+ * 原型滤波器是 Kaiser 窗 sinc，截止在两个采样率中较低者的奈奎斯特频率，
+ * 过渡带关于截止频率对称（过渡带内的混叠只落在通带之外）。
+ * 输出采样率 / 输入采样率约分为 L / M，第 p 相是原型在 p / L 个输入采样偏移处的 taps 个抽头，
+ * 按输入时间顺序排列，每相归一化为直流增益 1。
+ * L 超过 kMaxExactPhases（不常见的采样率比例）时只建 kInterpolatedPhases + 1 相，
+ * 相邻两相按分数相位线性插值。
+ */
+struct ResamplerFilterBank {
+    uint64_t upFactor = 1;    // L
+    uint64_t downFactor = 1;  // M
+    size_t phases = 1;        // 表里的相数（插值时为 kInterpolatedPhases + 1）
+    size_t taps = 0;          // 每相的抽头数（8 的倍数）
+    bool interpolated = false;
+    double passband = 0;      // 通带边缘，相对较低采样率的奈奎斯特频率
+    double stopbandDb = 0;    // 设计的阻带衰减
+    std::vector<float> coefficients;  // phases * taps
+
+    const float* phase(size_t index) const { return coefficients.data() + index * taps; }
+};
+
+// 精确相位的上限；常见比例（44.1 ↔ 48 kHz 为 160 / 147）都在范围内
+constexpr uint64_t kMaxExactPhases = 1024;
+constexpr size_t kInterpolatedPhases = 512;
+
+/**
+ * 取（必要时计算）滤波器组。结果按 (L, M, 档位) 缓存在进程内，线程安全
+ * @param inputRate 输入采样率
+ * @param outputRate 输出采样率
+ * @param quality 质量档位
+ */
+std::shared_ptr<const ResamplerFilterBank> resamplerFilterBank(int inputRate, int outputRate,
+                                                               ResamplerQuality quality);
+
+/**
+ * 预先计算常见输入采样率（22.05 / 32 / 44.1 / 48 / 88.2 / 96 / 176.4 / 192 kHz）到输出采样率的滤波器组
+ */
+void prewarmResamplerFilterBanks(int outputRate, ResamplerQuality quality);
+
+const char* resamplerQualityName(ResamplerQuality quality);
+
+/**
+ * 点积内核：n 是 8 的倍数
+ * SIMD 版本用多个累加器，求和顺序与标量不同，结果相差在舍入误差范围内
+ */
+float resamplerDot(const float* a, const float* b, size_t n, SimdLevel level);
+
+/**
+ * 流式多相重采样器（float32 交错采样）
+ *
+ * 输入先拆成各声道连续的历史缓冲区，每个输出帧对每个声道做一次 taps 长的点积。
+ * 输出第 n 帧对应输入时间 n * M / L，前后各需要 taps / 2 个输入采样；
+ * 起点之前按静音处理，输出与输入在时间上对齐（没有群延迟）。
+ * 只由一个线程使用，push / pull 不分配内存。
+ */
+class Resampler {
+public:
+    Resampler(int inputRate, int outputRate, int channels, ResamplerQuality quality,
+              SimdLevel level = detectSimdLevel());
+
+    /**
+     * 从输出第 outputFrame 帧（输入时间 outputFrame * M / L）重新开始，清空历史
+     * @param outputFrame 下一个输出帧的序号
+     * @return 调用方应从这一输入帧开始 push（已经为滤波器的前半部分留出历史）
+     */
+    uint64_t restart(uint64_t outputFrame);
+
+    /**
+     * 还能接收的输入帧数
+     */
+    size_t writable() const;
+
+    /**
+     * 追加输入
+     * @param frames 不超过 writable()
+     */
+    void push(const float* in, size_t frames);
+
+    /**
+     * 追加静音（输入结束后用来冲出最后几个输出）
+     */
+    void pushSilence(size_t frames);
+
+    /**
+     * 用已有的输入产生输出
+     * @return 产生的帧数，可能少于 frames（需要更多输入）
+     */
+    size_t pull(float* out, size_t frames);
+
+    const ResamplerFilterBank& filterBank() const { return *bank_; }
+    size_t latencyFrames() const { return half_; }
+
+private:
+    void compact();
+
+    std::shared_ptr<const ResamplerFilterBank> bank_;
+    int channels_;
+    SimdLevel level_;
+    size_t taps_;
+    size_t half_;  // 当前输出时间之前（含）需要的输入采样数：taps / 2
+
+    // 各声道的历史，channels_ 段，每段 capacity_ 个采样
+    std::vector<float> history_;
+    size_t capacity_;
+    size_t start_ = 0;   // 窗口第一个采样在历史中的位置
+    size_t count_ = 0;   // 历史中的采样数
+    uint64_t phase_ = 0; // 当前输出时间的分数部分（单位 1 / L）
+    std::vector<float> blended_;  // 插值模式下混合出的一相
+};
+
+/**
+ * 把另一个数据源重采样到输出采样率的数据源
+ * 总帧数为 内部总帧数 * L / M（向下取整）；内部数据源取完之后补静音冲出滤波器尾部
+ */
+class ResamplingSource : public AudioSource {
+public:
+    ResamplingSource(std::unique_ptr<AudioSource> inner, int outputRate, ResamplerQuality quality);
+
+    int sampleRate() const override { return output_rate_; }
+    int channels() const override { return inner_->channels(); }
+    uint64_t totalFrames() const override { return total_frames_; }
+    size_t read(float* out, size_t frames) override;
+    bool seek(uint64_t frame) override;
+
+    const Resampler& resampler() const { return resampler_; }
+
+private:
+    std::unique_ptr<AudioSource> inner_;
+    int output_rate_;
+    Resampler resampler_;
+    uint64_t total_frames_;
+    uint64_t position_ = 0;
+    bool inner_eof_ = false;
+    std::vector<float> input_;  // 从内部数据源读取的一块
+};
+
+}  // namespace musicfree
+
+#endif  // MUSICFREE_RESAMPLER_H
@@ -0,0 +1,560 @@
+#include "seek_index.h"
+#include "tag_reader.h"
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+namespace musicfree {
+
+namespace {
+
+// 查找帧头（Ogg 页头）的范围：在这个范围内找不到就认为到了文件末尾的标签或数据已损坏
+constexpr size_t kSyncSearchBytes = 64 * 1024;
+
+// FLAC / Ogg 取样的最小字节间隔
+constexpr uint64_t kMinStrideBytes = 4096;
+
+// 不同格式的解码器预滚采样数
+constexpr uint32_t kMp3PrerollFrames = 3;  // 位池最多引用前 511 字节，再加上 MDCT 重叠
+constexpr uint32_t kVorbisPreroll = 4096;  // 第一个包只用于重叠相加
+constexpr uint32_t kOpusPreroll = 3840;    // 规范建议的 80 ms
+
+uint32_t be32(const uint8_t* p) {
+    return (static_cast<uint32_t>(p[0]) << 24) | (static_cast<uint32_t>(p[1]) << 16) |
+           (static_cast<uint32_t>(p[2]) << 8) | p[3];
+}
+
+uint32_t le16(const uint8_t* p) {
+    return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8);
+}
+
+uint32_t le32(const uint8_t* p) {
+    return le16(p) | (le16(p + 2) << 16);
+}
+
+uint64_t le64(const uint8_t* p) {
+    return static_cast<uint64_t>(le32(p)) | (static_cast<uint64_t>(le32(p + 4)) << 32);
+}
+
+uint64_t samplesForInterval(int sampleRate) {
+    return std::max<uint64_t>(1, static_cast<uint64_t>(sampleRate) * kSeekPointIntervalMs / 1000);
+}
+
+/**
+ * 按字节等距取样时的步长：约为一个跳转间隔对应的字节数
+ */
+uint64_t strideBytes(uint64_t audioBytes, uint64_t totalSamples, int sampleRate) {
+    if (totalSamples == 0) {
+        return kMinStrideBytes * 16;
+    }
+    double bytesPerSample = static_cast<double>(audioBytes) / static_cast<double>(totalSamples);
+    uint64_t stride = static_cast<uint64_t>(bytesPerSample * static_cast<double>(samplesForInterval(sampleRate)));
+    return std::max(kMinStrideBytes, stride);
+}
+
+/**
+ * 按字节等距取样建立跳转点，适用于帧头（页头）自带采样位置的格式
+ * 先每隔 stride 字节取样一次；帧长变化较大时相邻两点的采样间隔可能远大于目标间隔，
+ * 再对这样的区间取字节中点继续取样，直到间隔不超过两倍目标间隔或区间内没有其他帧
+ * @param probe bool(uint64_t offset, SeekPoint& point)：查找 offset 之后的第一个跳转点
+ */
+template <typename Probe>
+void sampleByStride(SeekIndex& index, uint64_t begin, uint64_t end, uint64_t stride, Probe probe) {
+    std::vector<SeekPoint> coarse;
+    SeekPoint point;
+    for (uint64_t offset = begin; offset < end; offset += stride) {
+        if (probe(offset, point) && (coarse.empty() || (point.sample > coarse.back().sample &&
+                                                        point.offset > coarse.back().offset))) {
+            coarse.push_back(point);
+        }
+    }
+
+    uint64_t maxGap = 2 * samplesForInterval(index.sampleRate);
+    std::vector<std::pair<SeekPoint, SeekPoint>> pending;
+    for (size_t i = 0; i < coarse.size(); ++i) {
+        index.points.push_back(coarse[i]);
+        if (i + 1 == coarse.size()) {
+            break;
+        }
+        // 细分 [coarse[i], coarse[i + 1]]，结果按采样位置插入到两点之间
+        std::vector<SeekPoint> fine;
+        pending.assign(1, {coarse[i], coarse[i + 1]});
+        while (!pending.empty()) {
+            SeekPoint lo = pending.back().first;
+            SeekPoint hi = pending.back().second;
+            pending.pop_back();
+            if (hi.sample - lo.sample <= maxGap || hi.offset - lo.offset <= kMinStrideBytes) {
+                continue;
+            }
+            uint64_t middle = lo.offset + (hi.offset - lo.offset) / 2;
+            if (!probe(middle, point) || point.sample <= lo.sample || point.sample >= hi.sample ||
+                point.offset >= hi.offset) {
+                continue;
+            }
+            fine.push_back(point);
+            pending.push_back({lo, point});
+            pending.push_back({point, hi});
+        }
+        std::sort(fine.begin(), fine.end(),
+                  [](const SeekPoint& a, const SeekPoint& b) { return a.sample < b.sample; });
+        index.points.insert(index.points.end(), fine.begin(), fine.end());
+    }
+}
+
+// ===== MP3 =====
+
+/**
+ * 在 [pos, pos + kSyncSearchBytes) 中查找有效帧头，要求下一帧的帧头也有效
+ * @return 帧的偏移，找不到时返回 size
+ */
+size_t findMpegFrame(const uint8_t* data, size_t size, size_t pos) {
+    size_t end = std::min(size, pos + kSyncSearchBytes);
+    for (; pos + 4 <= end; ++pos) {
+        MpegFrameHeader frame, next;
+        if (data[pos] != 0xFF || !parseMpegFrameHeader(data + pos, frame)) {
+            continue;
+        }
+        size_t nextPos = pos + frame.length;
+        if (nextPos + 4 > size || parseMpegFrameHeader(data + nextPos, next)) {
+            return pos;
+        }
+    }
+    return size;
+}
+
+bool buildMp3Index(const uint8_t* data, size_t size, size_t audioStart, SeekIndex& index) {
+    size_t pos = findMpegFrame(data, size, audioStart);
+    if (pos >= size) {
+        return false;
+    }
+
+    MpegFrameHeader first;
+    parseMpegFrameHeader(data + pos, first);
+    uint64_t infoFrames = 0;
+    if (parseMpegInfoFrame(data + pos, size - pos, first, infoFrames)) {
+        pos += first.length;  // 信息帧不含音频
+    }
+
+    index.format = StreamFormat::MP3;
+    index.sampleRate = first.sampleRate;
+    index.channels = first.channels;
+    index.prerollSamples = kMp3PrerollFrames * static_cast<uint32_t>(first.samplesPerFrame);
+
+    // 可变码率的帧长各不相同，只能从头逐帧累加采样数；每帧只读 4 字节帧头
+    uint64_t interval = samplesForInterval(first.sampleRate);
+    uint64_t sample = 0;
+    uint64_t nextPoint = 0;
+    while (pos + 4 <= size) {
+        MpegFrameHeader frame;
+        if (!parseMpegFrameHeader(data + pos, frame) || frame.sampleRate != first.sampleRate ||
+            pos + frame.length > size) {
+            // 损坏的帧或文件末尾的 ID3v1 / APE 标签：重新同步，找不到就结束
+            size_t next = findMpegFrame(data, size, pos + 1);
+            if (next >= size) {
+                break;
+            }
+            pos = next;
+            continue;
+        }
+        if (sample >= nextPoint) {
+            index.points.push_back({sample, pos});
+            nextPoint = sample + interval;
+        }
+        sample += static_cast<uint64_t>(frame.samplesPerFrame);
+        pos += frame.length;
+    }
+    index.totalSamples = sample;
+    return !index.points.empty();
+}
+
+// ===== FLAC =====
+
+struct FlacStreamInfo {
+    uint32_t minBlockSize = 0;
+    uint32_t maxBlockSize = 0;
+    int sampleRate = 0;
+    int channels = 0;
+    uint64_t totalSamples = 0;
+};
+
+uint8_t crc8(const uint8_t* p, size_t length) {
+    uint8_t crc = 0;
+    for (size_t i = 0; i < length; ++i) {
+        crc ^= p[i];
+        for (int bit = 0; bit < 8; ++bit) {
+            crc = static_cast<uint8_t>((crc & 0x80) ? (crc << 1) ^ 0x07 : crc << 1);
+        }
+    }
+    return crc;
+}
+
+/**
+ * 解析 FLAC 帧头，校验 CRC-8
+ * @param sample 输出帧的第一个采样位置
+ * @return 帧头有效时返回 true
+ */
+bool parseFlacFrameHeader(const uint8_t* p, size_t available, const FlacStreamInfo& info, uint64_t& sample) {
+    if (available < 6 || p[0] != 0xFF || (p[1] & 0xFE) != 0xF8) {
+        return false;
+    }
+    bool variable = (p[1] & 0x01) != 0;
+    int blockCode = p[2] >> 4;
+    int rateCode = p[2] & 0x0F;
+    int channelCode = p[3] >> 4;
+    int sizeCode = (p[3] >> 1) & 0x07;
+    if (blockCode == 0 || rateCode == 15 || channelCode > 10 || sizeCode == 3 || (p[3] & 0x01) != 0) {
+        return false;
+    }
+
+    // UTF-8 编码的帧号（固定块大小）或采样号（可变块大小）
+    size_t pos = 4;
+    uint64_t number = p[pos];
+    int extra = 0;
+    if (number >= 0x80) {
+        if (number == 0xFF || (number & 0xC0) == 0x80) {
+            return false;
+        }
+        uint8_t mask = 0x40;
+        while (number & mask) {
+            ++extra;
+            mask >>= 1;
+        }
+        number &= static_cast<uint64_t>(mask - 1);
+    }
+    ++pos;
+    if (pos + static_cast<size_t>(extra) + 4 > available) {
+        return false;
+    }
+    for (int i = 0; i < extra; ++i, ++pos) {
+        if ((p[pos] & 0xC0) != 0x80) {
+            return false;
+        }
+        number = (number << 6) | (p[pos] & 0x3F);
+    }
+
+    pos += blockCode == 6 ? 1 : (blockCode == 7 ? 2 : 0);
+    pos += rateCode == 12 ? 1 : ((rateCode == 13 || rateCode == 14) ? 2 : 0);
+    if (pos >= available || crc8(p, pos) != p[pos]) {
+        return false;
+    }
+
+    sample = variable ? number : number * info.minBlockSize;
+    return info.totalSamples == 0 || sample < info.totalSamples;
+}
+
+/**
+ * 在 [pos, pos + kSyncSearchBytes) 中查找 FLAC 帧
+ * @return 帧的偏移，找不到时返回 size
+ */
+size_t findFlacFrame(const uint8_t* data, size_t size, size_t pos, const FlacStreamInfo& info, uint64_t& sample) {
+    size_t end = std::min(size, pos + kSyncSearchBytes);
+    for (; pos + 2 <= end; ++pos) {
+        if (data[pos] == 0xFF && parseFlacFrameHeader(data + pos, size - pos, info, sample)) {
+            return pos;
+        }
+    }
+    return size;
+}
+
+bool buildFlacIndex(const uint8_t* data, size_t size, size_t start, SeekIndex& index) {
+    FlacStreamInfo info;
+    size_t pos = start + 4;
+    bool haveStreamInfo = false;
+    for (;;) {
+        if (pos + 4 > size) {
+            return false;
+        }
+        bool last = (data[pos] & 0x80) != 0;
+        int type = data[pos] & 0x7F;
+        size_t length = (static_cast<size_t>(data[pos + 1]) << 16) | (data[pos + 2] << 8) | data[pos + 3];
+        if (type == 0 && length >= 34 && pos + 4 + 34 <= size) {
+            const uint8_t* p = data + pos + 4;
+            info.minBlockSize = (static_cast<uint32_t>(p[0]) << 8) | p[1];
+            info.maxBlockSize = (static_cast<uint32_t>(p[2]) << 8) | p[3];
+            info.sampleRate = static_cast<int>((static_cast<uint32_t>(p[10]) << 12) | (p[11] << 4) | (p[12] >> 4));
+            info.channels = ((p[12] >> 1) & 0x07) + 1;
+            info.totalSamples = (static_cast<uint64_t>(p[13] & 0x0F) << 32) | be32(p + 14);
+            haveStreamInfo = true;
+        }
+        pos += 4 + length;
+        if (last) {
+            break;
+        }
+    }
+    if (!haveStreamInfo || info.sampleRate <= 0 || info.minBlockSize == 0) {
+        return false;
+    }
+
+    index.format = StreamFormat::FLAC;
+    index.sampleRate = info.sampleRate;
+    index.channels = info.channels;
+    index.totalSamples = info.totalSamples;
+    index.prerollSamples = 0;  // FLAC 帧相互独立
+
+    // 帧头带有采样位置，按字节等距取样即可，不需要读取中间的帧
+    uint64_t stride = strideBytes(size - pos, info.totalSamples, info.sampleRate);
+    sampleByStride(index, pos, size, stride, [&](uint64_t offset, SeekPoint& point) {
+        size_t found = findFlacFrame(data, size, static_cast<size_t>(offset), info, point.sample);
+        point.offset = found;
+        return found < size;
+    });
+    return !index.points.empty() && index.points.front().sample == 0;
+}
+
+// ===== Ogg =====
+
+uint32_t oggCrc(const uint8_t* p, size_t length) {
+    static uint32_t table[256];
+    static bool ready = [] {
+        for (uint32_t i = 0; i < 256; ++i) {
+            uint32_t r = i << 24;
+            for (int bit = 0; bit < 8; ++bit) {
+                r = (r & 0x80000000u) ? (r << 1) ^ 0x04C11DB7u : r << 1;
+            }
+            table[i] = r;
+        }
+        return true;
+    }();
+    (void)ready;
+
+    uint32_t crc = 0;
+    for (size_t i = 0; i < length; ++i) {
+        // 校验和字段（第 22–25 字节）按 0 计算
+        uint8_t byte = (i >= 22 && i < 26) ? 0 : p[i];
+        crc = (crc << 8) ^ table[((crc >> 24) ^ byte) & 0xFF];
+    }
+    return crc;
+}
+
+struct OggPage {
+    uint64_t granule = 0;
+    uint32_t serial = 0;
+    size_t headerSize = 0;
+    size_t size = 0;  // 整页长度
+};
+
+bool parseOggPage(const uint8_t* data, size_t size, size_t pos, OggPage& page, bool checkCrc) {
+    if (pos + 27 > size || std::memcmp(data + pos, "OggS", 4) != 0 || data[pos + 4] != 0) {
+        return false;
+    }
+    const uint8_t* p = data + pos;
+    size_t segments = p[26];
+    if (pos + 27 + segments > size) {
+        return false;
+    }
+    size_t body = 0;
+    for (size_t i = 0; i < segments; ++i) {
+        body += p[27 + i];
+    }
+    page.granule = le64(p + 6);
+    page.serial = le32(p + 14);
+    page.headerSize = 27 + segments;
+    page.size = page.headerSize + body;
+    if (pos + page.size > size) {
+        return false;
+    }
+    return !checkCrc || oggCrc(p, page.size) == le32(p + 22);
+}
+
+size_t findOggPage(const uint8_t* data, size_t size, size_t pos, uint32_t serial, OggPage& page) {
+    size_t end = std::min(size, pos + kSyncSearchBytes);
+    for (; pos + 4 <= end; ++pos) {
+        if (data[pos] == 'O' && parseOggPage(data, size, pos, page, true) && page.serial == serial) {
+            return pos;
+        }
+    }
+    return size;
+}
+
+bool buildOggIndex(const uint8_t* data, size_t size, SeekIndex& index) {
+    OggPage page;
+    if (!parseOggPage(data, size, 0, page, true)) {
+        return false;
+    }
+    uint32_t serial = page.serial;
+    const uint8_t* packet = data + page.headerSize;
+    size_t packetSize = page.size - page.headerSize;
+    uint64_t preSkip = 0;
+    if (packetSize >= 16 && std::memcmp(packet, "\x01vorbis", 7) == 0) {
+        index.channels = packet[11];
+        index.sampleRate = static_cast<int>(le32(packet + 12));
+        index.prerollSamples = kVorbisPreroll;
+    } else if (packetSize >= 19 && std::memcmp(packet, "OpusHead", 8) == 0) {
+        index.channels = packet[9];
+        preSkip = le16(packet + 10);
+        index.sampleRate = 48000;  // Opus 的 granule position 总是以 48 kHz 计
+        index.prerollSamples = kOpusPreroll;
+    } else {
+        return false;
+    }
+    if (index.sampleRate <= 0) {
+        return false;
+    }
+    index.format = StreamFormat::OGG;
+
+    // 头部包（标识、注释、设置）所在页的 granule position 为 0，之后才是音频页
+    size_t pos = 0;
+    while (parseOggPage(data, size, pos, page, false) && (page.serial != serial || page.granule == 0)) {
+        pos += page.size;
+    }
+    if (pos >= size) {
+        return false;
+    }
+    size_t audioStart = pos;
+
+    // 总长度取自最后一页
+    uint64_t lastGranule = 0;
+    size_t tail = size > kSyncSearchBytes ? size - kSyncSearchBytes : audioStart;
+    for (size_t probe = tail; probe < size;) {
+        size_t found = findOggPage(data, size, probe, serial, page);
+        if (found >= size) {
+            break;
+        }
+        if (page.granule != UINT64_MAX) {
+            lastGranule = page.granule;
+        }
+        probe = found + page.size;
+    }
+    index.totalSamples = lastGranule > preSkip ? lastGranule - preSkip : 0;
+
+    // 页的 granule position 是页内最后一个完整包结束时的采样位置，也就是下一页开始解码的位置
+    uint64_t stride = strideBytes(size - audioStart, index.totalSamples, index.sampleRate);
+    sampleByStride(index, audioStart, size, stride, [&](uint64_t offset, SeekPoint& point) {
+        if (offset == audioStart) {
+            point = {0, audioStart};
+            return true;
+        }
+        // 没有完整包结束的页（granule 为 -1）不能作为跳转点，继续找下一页
+        for (size_t pos = static_cast<size_t>(offset); pos < size;) {
+            OggPage found;
+            size_t at = findOggPage(data, size, pos, serial, found);
+            if (at >= size || at + found.size >= size) {
+                return false;
+            }
+            if (found.granule != UINT64_MAX) {
+                point.sample = found.granule > preSkip ? found.granule - preSkip : 0;
+                point.offset = at + found.size;
+                return true;
+            }
+            pos = at + found.size;
+        }
+        return false;
+    });
+    return !index.points.empty();
+}
+
+void putVarint(std::string& out, uint64_t value) {
+    while (value >= 0x80) {
+        out += static_cast<char>((value & 0x7F) | 0x80);
+        value >>= 7;
+    }
+    out += static_cast<char>(value);
+}
+
+bool getVarint(const uint8_t* data, size_t size, size_t& pos, uint64_t& value) {
+    value = 0;
+    for (int shift = 0; shift < 64 && pos < size; shift += 7) {
+        uint8_t byte = data[pos++];
+        value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+}  // namespace
+
+const char* streamFormatName(StreamFormat format) {
+    switch (format) {
+        case StreamFormat::MP3:
+            return "mp3";
+        case StreamFormat::FLAC:
+            return "flac";
+        case StreamFormat::OGG:
+            return "ogg";
+    }
+    return "";
+}
+
+SeekPoint SeekIndex::find(uint64_t sample) const {
+    uint64_t target = sample > prerollSamples ? sample - prerollSamples : 0;
+    auto it = std::upper_bound(points.begin(), points.end(), target,
+                               [](uint64_t value, const SeekPoint& point) { return value < point.sample; });
+    if (it == points.begin()) {
+        return points.empty() ? SeekPoint() : points.front();
+    }
+    return *(it - 1);
+}
+
+bool buildSeekIndex(const uint8_t* data, size_t size, SeekIndex& index) {
+    index = SeekIndex();
+    if (size < 12) {
+        return false;
+    }
+    if (std::memcmp(data, "OggS", 4) == 0) {
+        return buildOggIndex(data, size, index);
+    }
+
+    size_t start = 0;
+    if (std::memcmp(data, "ID3", 3) == 0) {
+        size_t tagSize = (static_cast<size_t>(data[6] & 0x7F) << 21) | ((data[7] & 0x7F) << 14) |
+                         ((data[8] & 0x7F) << 7) | (data[9] & 0x7F);
+        start = 10 + tagSize + ((data[3] >= 4 && (data[5] & 0x10)) ? 10 : 0);
+        if (start + 4 > size) {
+            return false;
+        }
+    }
+    if (std::memcmp(data + start, "fLaC", 4) == 0) {
+        return buildFlacIndex(data, size, start, index);
+    }
+    return buildMp3Index(data, size, start, index);
+}
+
+void serializeSeekIndex(const SeekIndex& index, std::string& out) {
+    out += static_cast<char>(index.format);
+    putVarint(out, static_cast<uint64_t>(index.sampleRate));
+    putVarint(out, static_cast<uint64_t>(index.channels));
+    putVarint(out, index.totalSamples);
+    putVarint(out, index.prerollSamples);
+    putVarint(out, index.points.size());
+    SeekPoint previous;
+    for (const SeekPoint& point : index.points) {
+        putVarint(out, point.sample - previous.sample);
+        putVarint(out, point.offset - previous.offset);
+        previous = point;
+    }
+}
+
+bool deserializeSeekIndex(const uint8_t* data, size_t size, SeekIndex& index) {
+    index = SeekIndex();
+    if (size < 1 || data[0] > static_cast<uint8_t>(StreamFormat::OGG)) {
+        return false;
+    }
+    index.format = static_cast<StreamFormat>(data[0]);
+    size_t pos = 1;
+    uint64_t sampleRate, channels, preroll, count;
+    if (!getVarint(data, size, pos, sampleRate) || !getVarint(data, size, pos, channels) ||
+        !getVarint(data, size, pos, index.totalSamples) || !getVarint(data, size, pos, preroll) ||
+        !getVarint(data, size, pos, count) || sampleRate == 0 || sampleRate > 1000000 || count > size) {
+        return false;
+    }
+    index.sampleRate = static_cast<int>(sampleRate);
+    index.channels = static_cast<int>(channels);
+    index.prerollSamples = static_cast<uint32_t>(preroll);
+
+    index.points.resize(static_cast<size_t>(count));
+    SeekPoint previous;
+    for (SeekPoint& point : index.points) {
+        uint64_t sampleDelta, offsetDelta;
+        if (!getVarint(data, size, pos, sampleDelta) || !getVarint(data, size, pos, offsetDelta)) {
+            return false;
+        }
+        point.sample = previous.sample + sampleDelta;
+        point.offset = previous.offset + offsetDelta;
+        previous = point;
+    }
+    return pos == size;
+}
+
+}  // namespace musicfree
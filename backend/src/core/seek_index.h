@@ -0,0 +1,84 @@
+#ifndef MUSICFREE_SEEK_INDEX_H
+#define MUSICFREE_SEEK_INDEX_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace musicfree {
+
+// 压缩流格式
+enum class StreamFormat {
+    MP3 = 0,
+    FLAC = 1,
+    OGG = 2  // Vorbis / Opus
+};
+
+/**
+ * 跳转点：从 offset 处的帧（Ogg 为页）开始解码，第一个采样是流中的第 sample 个采样
+ */
+struct SeekPoint {
+    uint64_t sample = 0;
+    uint64_t offset = 0;
+};
+
+/**
+ * 压缩流的跳转表
+ *
+ * 跳转点按采样位置递增，间隔约 kSeekPointIntervalMs（FLAC / Ogg 不超过两倍，除非单帧更长）；
+ * 查找为二分，与文件长度无关。
+ * 解码器从跳转点开始解码，丢弃目标之前的采样即可精确到采样。
+ */
+struct SeekIndex {
+    StreamFormat format = StreamFormat::MP3;
+    int sampleRate = 0;            // 采样位置的单位（Opus 固定为 48000）
+    int channels = 0;
+    uint64_t totalSamples = 0;
+    uint32_t prerollSamples = 0;   // 解码器需要预先解码的采样数（MP3 位池、Vorbis 重叠、Opus 预滚）
+    std::vector<SeekPoint> points;
+
+    /**
+     * 查找不晚于目标的最后一个跳转点，已经为预滚留出余量
+     * @param sample 目标采样位置
+     * @return 跳转点；没有跳转点时返回文件开头
+     */
+    SeekPoint find(uint64_t sample) const;
+};
+
+/**
+ * 格式名（与 AudioInfo::format 一致）
+ */
+const char* streamFormatName(StreamFormat format);
+
+// 相邻跳转点的目标间隔（毫秒）
+constexpr int kSeekPointIntervalMs = 250;
+
+/**
+ * 从文件内容建立跳转表
+ *   - MP3：依次解析帧头（只读帧头，不读帧数据），跳过 Xing / Info / VBRI 帧
+ *   - FLAC：按字节等距取样，在每个取样位置向后查找通过 CRC-8 校验的帧头，帧头带有采样位置；
+ *     间隔过大的区间再按字节二分补点
+ *   - Ogg：同样按字节取样，查找通过 CRC 校验的页头，页的 granule position 给出采样位置
+ * FLAC 和 Ogg 只读取取样位置附近的几 KB，不扫描整个文件
+ * @param data 文件内容
+ * @param size 文件大小
+ * @param index 输出跳转表
+ * @return 识别出格式并至少有一个跳转点时返回 true
+ */
+bool buildSeekIndex(const uint8_t* data, size_t size, SeekIndex& index);
+
+/**
+ * 序列化跳转表（追加到 out），跳转点按差值变长编码
+ */
+void serializeSeekIndex(const SeekIndex& index, std::string& out);
+
+/**
+ * 解析 serializeSeekIndex 的输出
+ * @return 数据完整时返回 true
+ */
+bool deserializeSeekIndex(const uint8_t* data, size_t size, SeekIndex& index);
+
+}  // namespace musicfree
+
+#endif  // MUSICFREE_SEEK_INDEX_H
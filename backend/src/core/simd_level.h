@@ -0,0 +1,24 @@
+#ifndef MUSICFREE_SIMD_LEVEL_H
+#define MUSICFREE_SIMD_LEVEL_H
+
+namespace musicfree {
+
+/**
+ * SIMD 内核使用的指令集，按运行时检测结果分派
+ */
+enum class SimdLevel {
+    SCALAR = 0,
+    SSE42 = 1,
+    AVX2 = 2
+};
+
+/**
+ * 检测当前 CPU 支持的最高指令集
+ */
+SimdLevel detectSimdLevel();
+
+const char* simdLevelName(SimdLevel level);
+
+}  // namespace musicfree
+
+#endif  // MUSICFREE_SIMD_LEVEL_H
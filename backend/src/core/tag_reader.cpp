@@ -0,0 +1,617 @@
+#include "tag_reader.h"
+#include "mapped_file.h"
+#include "pcm_file_source.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+namespace musicfree {
+
+namespace {
+
+// 单个标签字段最多读取的字节数，更长的内容（歌词、封面）直接跳过
+constexpr size_t kMaxFieldBytes = 4096;
+
+// VORBIS_COMMENT 块最多读取的字节数
+constexpr size_t kMaxCommentBytes = 64 * 1024;
+
+// 在 ID3v2 标签之后寻找第一帧 MPEG 同步字的范围
+constexpr size_t kSyncSearchBytes = 64 * 1024;
+
+// MP4 容器的最大嵌套深度
+constexpr int kMaxAtomDepth = 8;
+
+/**
+ * 按偏移读取的文件：标签分散在文件各处，每次只读需要的几个字节
+ */
+class FileReader {
+public:
+    ~FileReader() {
+        if (file_) {
+            std::fclose(file_);
+        }
+    }
+
+    bool open(const std::string& path) {
+        file_ = std::fopen(path.c_str(), "rb");
+        if (!file_ || std::fseek(file_, 0, SEEK_END) != 0) {
+            return false;
+        }
+        long size = std::ftell(file_);
+        if (size <= 0) {
+            return false;
+        }
+        size_ = static_cast<uint64_t>(size);
+        return true;
+    }
+
+    uint64_t size() const { return size_; }
+
+    /**
+     * 读取 [offset, offset + length)，超出文件末尾的部分不读
+     * @return 实际读取的字节数
+     */
+    size_t read(uint64_t offset, void* buffer, size_t length) {
+        if (offset >= size_ || std::fseek(file_, static_cast<long>(offset), SEEK_SET) != 0) {
+            return 0;
+        }
+        length = static_cast<size_t>(std::min<uint64_t>(length, size_ - offset));
+        return std::fread(buffer, 1, length, file_);
+    }
+
+    bool readExact(uint64_t offset, void* buffer, size_t length) {
+        return read(offset, buffer, length) == length;
+    }
+
+private:
+    std::FILE* file_ = nullptr;
+    uint64_t size_ = 0;
+};
+
+uint32_t be24(const uint8_t* p) {
+    return (static_cast<uint32_t>(p[0]) << 16) | (static_cast<uint32_t>(p[1]) << 8) | p[2];
+}
+
+uint32_t be32(const uint8_t* p) {
+    return (static_cast<uint32_t>(p[0]) << 24) | be24(p + 1);
+}
+
+uint64_t be64(const uint8_t* p) {
+    return (static_cast<uint64_t>(be32(p)) << 32) | be32(p + 4);
+}
+
+uint32_t le32(const uint8_t* p) {
+    return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) | (static_cast<uint32_t>(p[2]) << 16) |
+           (static_cast<uint32_t>(p[3]) << 24);
+}
+
+uint32_t syncsafe32(const uint8_t* p) {
+    return (static_cast<uint32_t>(p[0] & 0x7F) << 21) | (static_cast<uint32_t>(p[1] & 0x7F) << 14) |
+           (static_cast<uint32_t>(p[2] & 0x7F) << 7) | (p[3] & 0x7F);
+}
+
+void appendUtf8(std::string& out, uint32_t code) {
+    if (code < 0x80) {
+        out += static_cast<char>(code);
+    } else if (code < 0x800) {
+        out += static_cast<char>(0xC0 | (code >> 6));
+        out += static_cast<char>(0x80 | (code & 0x3F));
+    } else if (code < 0x10000) {
+        out += static_cast<char>(0xE0 | (code >> 12));
+        out += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (code & 0x3F));
+    } else {
+        out += static_cast<char>(0xF0 | (code >> 18));
+        out += static_cast<char>(0x80 | ((code >> 12) & 0x3F));
+        out += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (code & 0x3F));
+    }
+}
+
+std::string latin1ToUtf8(const uint8_t* p, size_t size) {
+    std::string out;
+    out.reserve(size);
+    for (size_t i = 0; i < size && p[i] != 0; ++i) {
+        appendUtf8(out, p[i]);
+    }
+    return out;
+}
+
+std::string utf16ToUtf8(const uint8_t* p, size_t size, bool bigEndian) {
+    std::string out;
+    for (size_t i = 0; i + 1 < size; i += 2) {
+        uint32_t unit = bigEndian ? (p[i] << 8) | p[i + 1] : p[i] | (p[i + 1] << 8);
+        if (unit == 0) {
+            break;
+        }
+        // 代理对
+        if (unit >= 0xD800 && unit < 0xDC00 && i + 3 < size) {
+            uint32_t low = bigEndian ? (p[i + 2] << 8) | p[i + 3] : p[i + 2] | (p[i + 3] << 8);
+            if (low >= 0xDC00 && low < 0xE000) {
+                unit = 0x10000 + ((unit - 0xD800) << 10) + (low - 0xDC00);
+                i += 2;
+            }
+        }
+        appendUtf8(out, unit);
+    }
+    return out;
+}
+
+std::string trimmed(std::string text) {
+    size_t end = text.find('\0');
+    if (end != std::string::npos) {
+        text.resize(end);
+    }
+    while (!text.empty() && (text.back() == ' ' || text.back() == '\n' || text.back() == '\r')) {
+        text.pop_back();
+    }
+    return text;
+}
+
+/**
+ * ID3v2 文本帧：第一个字节是编码，之后是文本（2.4 的多个值以 NUL 分隔，只取第一个）
+ */
+std::string id3Text(const uint8_t* p, size_t size) {
+    if (size < 1) {
+        return std::string();
+    }
+    uint8_t encoding = p[0];
+    const uint8_t* text = p + 1;
+    size_t length = size - 1;
+    switch (encoding) {
+        case 1:  // UTF-16，带 BOM
+            if (length >= 2 && text[0] == 0xFE && text[1] == 0xFF) {
+                return trimmed(utf16ToUtf8(text + 2, length - 2, true));
+            }
+            if (length >= 2 && text[0] == 0xFF && text[1] == 0xFE) {
+                return trimmed(utf16ToUtf8(text + 2, length - 2, false));
+            }
+            return trimmed(utf16ToUtf8(text, length, false));
+        case 2:  // UTF-16BE
+            return trimmed(utf16ToUtf8(text, length, true));
+        case 3:  // UTF-8
+            return trimmed(std::string(reinterpret_cast<const char*>(text), length));
+        default:
+            return trimmed(latin1ToUtf8(text, length));
+    }
+}
+
+/**
+ * 读取 ID3v2 标签
+ * @return 标签的总长度（包括头和尾），没有标签返回 0
+ */
+uint64_t readId3v2(FileReader& reader, uint64_t offset, AudioInfo& info) {
+    uint8_t header[10];
+    if (!reader.readExact(offset, header, sizeof(header)) || std::memcmp(header, "ID3", 3) != 0) {
+        return 0;
+    }
+    int version = header[3];
+    uint8_t flags = header[5];
+    uint64_t tagSize = syncsafe32(header + 6);
+    uint64_t total = 10 + tagSize + ((version >= 4 && (flags & 0x10)) ? 10 : 0);
+    if (version < 2 || version > 4) {
+        return total;
+    }
+
+    uint64_t pos = offset + 10;
+    uint64_t end = std::min(offset + 10 + tagSize, reader.size());
+    // 扩展头
+    if ((flags & 0x40) && version >= 3) {
+        uint8_t ext[4];
+        if (!reader.readExact(pos, ext, 4)) {
+            return total;
+        }
+        pos += version == 4 ? syncsafe32(ext) : 4 + be32(ext);
+    }
+
+    size_t headerSize = version == 2 ? 6 : 10;
+    size_t idSize = version == 2 ? 3 : 4;
+    std::vector<uint8_t> body;
+    while (pos + headerSize <= end) {
+        uint8_t frame[10];
+        if (!reader.readExact(pos, frame, headerSize) || frame[0] == 0) {
+            break;  // 填充区
+        }
+        uint64_t size = version == 2 ? be24(frame + 3) : (version == 4 ? syncsafe32(frame + 4) : be32(frame + 4));
+        uint64_t bodyOffset = pos + headerSize;
+        pos = bodyOffset + size;
+        if (size == 0 || pos > end) {
+            break;
+        }
+
+        std::string id(reinterpret_cast<const char*>(frame), idSize);
+        std::string* field = nullptr;
+        bool length = false;
+        if (id == "TIT2" || id == "TT2") {
+            field = &info.title;
+        } else if (id == "TPE1" || id == "TP1") {
+            field = &info.artist;
+        } else if (id == "TALB" || id == "TAL") {
+            field = &info.album;
+        } else if (id == "TLEN" || id == "TLE") {
+            length = true;
+        }
+        if (field == nullptr && !length) {
+            continue;  // 封面、歌词等不读
+        }
+
+        body.resize(static_cast<size_t>(std::min<uint64_t>(size, kMaxFieldBytes)));
+        if (!reader.readExact(bodyOffset, body.data(), body.size())) {
+            break;
+        }
+        std::string text = id3Text(body.data(), body.size());
+        if (field != nullptr) {
+            *field = text;
+        } else if (!text.empty()) {
+            info.duration = std::atoi(text.c_str());
+        }
+    }
+    return total;
+}
+
+/**
+ * 文件末尾的 ID3v1 标签，只补全缺失的字段
+ */
+void readId3v1(FileReader& reader, AudioInfo& info) {
+    uint8_t tag[128];
+    if (reader.size() < 128 || !reader.readExact(reader.size() - 128, tag, sizeof(tag)) ||
+        std::memcmp(tag, "TAG", 3) != 0) {
+        return;
+    }
+    if (info.title.empty()) info.title = trimmed(latin1ToUtf8(tag + 3, 30));
+    if (info.artist.empty()) info.artist = trimmed(latin1ToUtf8(tag + 33, 30));
+    if (info.album.empty()) info.album = trimmed(latin1ToUtf8(tag + 63, 30));
+}
+
+/**
+ * 从第一帧的流信息计算 MP3 的时长：优先用 Xing / Info / VBRI 头里的总帧数，否则按固定码率估算
+ */
+bool readMpegStream(FileReader& reader, uint64_t offset, AudioInfo& info) {
+    std::vector<uint8_t> buffer(kSyncSearchBytes);
+    size_t n = reader.read(offset, buffer.data(), buffer.size());
+
+    for (size_t i = 0; i + 4 <= n; ++i) {
+        MpegFrameHeader frame;
+        if (!parseMpegFrameHeader(buffer.data() + i, frame)) {
+            continue;
+        }
+        // 下一帧也要是有效的帧头，排除数据里偶然出现的同步字
+        MpegFrameHeader next;
+        if (i + frame.length + 4 <= n && !parseMpegFrameHeader(buffer.data() + i + frame.length, next)) {
+            continue;
+        }
+
+        info.sampleRate = frame.sampleRate;
+        info.channels = frame.channels;
+        if (info.duration > 0) {
+            return true;  // TLEN 已经给出
+        }
+
+        uint64_t frames = 0;
+        parseMpegInfoFrame(buffer.data() + i, n - i, frame, frames);
+        if (frames > 0) {
+            info.duration = static_cast<int>(frames * static_cast<uint64_t>(frame.samplesPerFrame) * 1000 /
+                                             static_cast<uint64_t>(frame.sampleRate));
+        } else {
+            uint64_t audioBytes = reader.size() - (offset + i);
+            info.duration = static_cast<int>(audioBytes * 8 / static_cast<uint64_t>(frame.bitrate));
+        }
+        return true;
+    }
+    return false;
+}
+
+// ===== FLAC =====
+
+void readVorbisComments(const uint8_t* p, size_t size, AudioInfo& info) {
+    size_t pos = 0;
+    if (size < 4) {
+        return;
+    }
+    pos = 4 + le32(p);  // 跳过 vendor
+    if (pos + 4 > size) {
+        return;
+    }
+    uint32_t count = le32(p + pos);
+    pos += 4;
+    for (uint32_t i = 0; i < count && pos + 4 <= size; ++i) {
+        uint32_t length = le32(p + pos);
+        pos += 4;
+        if (length > size - pos) {
+            break;
+        }
+        std::string comment(reinterpret_cast<const char*>(p + pos), length);
+        pos += length;
+
+        size_t eq = comment.find('=');
+        if (eq == std::string::npos) {
+            continue;
+        }
+        std::string key = comment.substr(0, eq);
+        std::transform(key.begin(), key.end(), key.begin(),
+                       [](unsigned char c) { return static_cast<char>(std::toupper(c)); });
+        if (key == "TITLE" && info.title.empty()) {
+            info.title = comment.substr(eq + 1);
+        } else if (key == "ARTIST" && info.artist.empty()) {
+            info.artist = comment.substr(eq + 1);
+        } else if (key == "ALBUM" && info.album.empty()) {
+            info.album = comment.substr(eq + 1);
+        }
+    }
+}
+
+bool readFlac(FileReader& reader, uint64_t offset, AudioInfo& info) {
+    uint64_t pos = offset + 4;
+    std::vector<uint8_t> body;
+    bool haveStreamInfo = false;
+    for (;;) {
+        uint8_t header[4];
+        if (!reader.readExact(pos, header, sizeof(header))) {
+            break;
+        }
+        bool last = (header[0] & 0x80) != 0;
+        int type = header[0] & 0x7F;
+        uint32_t length = be24(header + 1);
+        uint64_t bodyOffset = pos + 4;
+        pos = bodyOffset + length;
+
+        if (type == 0 && length >= 34) {
+            uint8_t streamInfo[34];
+            if (!reader.readExact(bodyOffset, streamInfo, sizeof(streamInfo))) {
+                return false;
+            }
+            const uint8_t* p = streamInfo + 10;
+            int sampleRate = static_cast<int>((static_cast<uint32_t>(p[0]) << 12) | (p[1] << 4) | (p[2] >> 4));
+            int channels = ((p[2] >> 1) & 0x07) + 1;
+            int bits = (((p[2] & 0x01) << 4) | (p[3] >> 4)) + 1;
+            uint64_t samples = (static_cast<uint64_t>(p[3] & 0x0F) << 32) | be32(p + 4);
+            info.sampleRate = sampleRate;
+            info.channels = channels;
+            info.bitsPerSample = bits;
+            if (sampleRate > 0) {
+                info.duration = static_cast<int>(samples * 1000 / static_cast<uint64_t>(sampleRate));
+            }
+            haveStreamInfo = true;
+        } else if (type == 4) {
+            body.resize(std::min<size_t>(length, kMaxCommentBytes));
+            size_t n = reader.read(bodyOffset, body.data(), body.size());
+            readVorbisComments(body.data(), n, info);
+        }
+        if (last) {
+            break;
+        }
+    }
+    return haveStreamInfo;
+}
+
+// ===== MP4 =====
+
+struct Mp4State {
+    bool haveDuration = false;
+};
+
+bool isContainer(const char* type) {
+    static const char* kContainers[] = {"moov", "trak", "mdia", "minf", "stbl", "udta", "ilst"};
+    for (const char* container : kContainers) {
+        if (std::memcmp(type, container, 4) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void readMp4Atoms(FileReader& reader, uint64_t begin, uint64_t end, int depth, AudioInfo& info, Mp4State& state) {
+    uint64_t pos = begin;
+    while (pos + 8 <= end && depth < kMaxAtomDepth) {
+        uint8_t header[16];
+        if (!reader.readExact(pos, header, 8)) {
+            return;
+        }
+        uint64_t size = be32(header);
+        size_t headerSize = 8;
+        if (size == 1) {
+            if (!reader.readExact(pos + 8, header + 8, 8)) {
+                return;
+            }
+            size = be64(header + 8);
+            headerSize = 16;
+        } else if (size == 0) {
+            size = end - pos;
+        }
+        if (size < headerSize || pos + size > end) {
+            return;
+        }
+        const char* type = reinterpret_cast<const char*>(header + 4);
+        uint64_t bodyOffset = pos + headerSize;
+        uint64_t bodySize = size - headerSize;
+
+        if (isContainer(type)) {
+            readMp4Atoms(reader, bodyOffset, pos + size, depth + 1, info, state);
+        } else if (std::memcmp(type, "meta", 4) == 0 && bodySize >= 4) {
+            // ISO 的 meta 是完整 box，子 atom 之前有 4 字节的版本和标志
+            readMp4Atoms(reader, bodyOffset + 4, pos + size, depth + 1, info, state);
+        } else if (std::memcmp(type, "mvhd", 4) == 0 && bodySize >= 32) {
+            uint8_t body[32];
+            reader.readExact(bodyOffset, body, sizeof(body));
+            uint64_t timescale, duration;
+            if (body[0] == 1) {
+                timescale = be32(body + 20);
+                duration = be64(body + 24);
+            } else {
+                timescale = be32(body + 12);
+                duration = be32(body + 16);
+            }
+            if (timescale > 0) {
+                info.duration = static_cast<int>(duration * 1000 / timescale);
+                state.haveDuration = true;
+            }
+        } else if (std::memcmp(type, "stsd", 4) == 0 && bodySize >= 8 + 36 && info.sampleRate == 0) {
+            uint8_t body[8 + 36];
+            reader.readExact(bodyOffset, body, sizeof(body));
+            // 第一个音频采样描述：声道数、采样位数，采样率为 16.16 定点数
+            const uint8_t* entry = body + 8;
+            int channels = (entry[24] << 8) | entry[25];
+            int bits = (entry[26] << 8) | entry[27];
+            int sampleRate = static_cast<int>(be32(entry + 32) >> 16);
+            if (channels > 0 && channels <= 8 && sampleRate > 0) {
+                info.channels = channels;
+                info.bitsPerSample = bits;
+                info.sampleRate = sampleRate;
+            }
+        } else if (header[4] == 0xA9 && bodySize >= 16 && depth > 0) {
+            // ilst 中的文本项：子 atom data 的 8 字节头、4 字节类型和 4 字节区域之后是 UTF-8 文本
+            std::string* field = nullptr;
+            if (std::memcmp(type + 1, "nam", 3) == 0) {
+                field = &info.title;
+            } else if (std::memcmp(type + 1, "ART", 3) == 0) {
+                field = &info.artist;
+            } else if (std::memcmp(type + 1, "alb", 3) == 0) {
+                field = &info.album;
+            }
+            if (field != nullptr) {
+                std::vector<uint8_t> body(static_cast<size_t>(std::min<uint64_t>(bodySize, kMaxFieldBytes)));
+                if (reader.readExact(bodyOffset, body.data(), body.size()) &&
+                    std::memcmp(body.data() + 4, "data", 4) == 0) {
+                    size_t dataSize = std::min<size_t>(be32(body.data()), body.size());
+                    if (dataSize > 16) {
+                        *field = std::string(reinterpret_cast<const char*>(body.data() + 16), dataSize - 16);
+                    }
+                }
+            }
+        }
+        // mdat、stts、stsz 等直接跳过，不读取内容
+        pos += size;
+    }
+}
+
+bool readMp4(FileReader& reader, AudioInfo& info) {
+    Mp4State state;
+    readMp4Atoms(reader, 0, reader.size(), 0, info, state);
+    return state.haveDuration;
+}
+
+bool readPcmHeader(const std::string& filePath, bool wav, AudioInfo& info) {
+    // 映射之后解析器只访问文件头所在的页面（以及 data 之后的标签块）
+    MappedFile file;
+    if (!file.open(filePath)) {
+        return false;
+    }
+    PcmLayout layout;
+    bool ok = wav ? parseWavHeader(file.data(), file.size(), layout, info)
+                  : parseAiffHeader(file.data(), file.size(), layout, info);
+    if (!ok || layout.sampleRate <= 0) {
+        return false;
+    }
+    info.duration = static_cast<int>(layout.frames * 1000 / static_cast<uint64_t>(layout.sampleRate));
+    info.sampleRate = layout.sampleRate;
+    info.channels = layout.channels;
+    info.bitsPerSample = layout.bitsPerSample;
+    info.format = wav ? "wav" : "aiff";
+    return true;
+}
+
+}  // namespace
+
+std::string fileStem(const std::string& filePath) {
+    size_t slash = filePath.find_last_of("/\\");
+    std::string name = slash == std::string::npos ? filePath : filePath.substr(slash + 1);
+    size_t dot = name.find_last_of('.');
+    return dot == std::string::npos || dot == 0 ? name : name.substr(0, dot);
+}
+
+bool readAudioTags(const std::string& filePath, AudioInfo& info) {
+    info = AudioInfo();
+
+    FileReader reader;
+    if (!reader.open(filePath)) {
+        return false;
+    }
+    uint8_t magic[12] = {};
+    reader.read(0, magic, sizeof(magic));
+
+    if (std::memcmp(magic, "RIFF", 4) == 0 && std::memcmp(magic + 8, "WAVE", 4) == 0) {
+        return readPcmHeader(filePath, true, info);
+    }
+    if (std::memcmp(magic, "FORM", 4) == 0 &&
+        (std::memcmp(magic + 8, "AIFF", 4) == 0 || std::memcmp(magic + 8, "AIFC", 4) == 0)) {
+        return readPcmHeader(filePath, false, info);
+    }
+    if (std::memcmp(magic + 4, "ftyp", 4) == 0) {
+        info.format = "m4a";
+        return readMp4(reader, info);
+    }
+
+    uint64_t audioOffset = readId3v2(reader, 0, info);
+    uint8_t flac[4] = {};
+    reader.read(audioOffset, flac, sizeof(flac));
+    if (std::memcmp(flac, "fLaC", 4) == 0) {
+        info.format = "flac";
+        return readFlac(reader, audioOffset, info);
+    }
+
+    readId3v1(reader, info);
+    if (readMpegStream(reader, audioOffset, info)) {
+        info.format = "mp3";
+        return true;
+    }
+    return false;
+}
+
+bool parseMpegFrameHeader(const uint8_t* p, MpegFrameHeader& frame) {
+    static const int kBitrates[2][3][15] = {
+        {{0, 32, 64, 96, 128, 160, 192, 224, 256, 288, 320, 352, 384, 416, 448},
+         {0, 32, 48, 56, 64, 80, 96, 112, 128, 160, 192, 224, 256, 320, 384},
+         {0, 32, 40, 48, 56, 64, 80, 96, 112, 128, 160, 192, 224, 256, 320}},
+        {{0, 32, 48, 56, 64, 80, 96, 112, 128, 144, 160, 176, 192, 224, 256},
+         {0, 8, 16, 24, 32, 40, 48, 56, 64, 80, 96, 112, 128, 144, 160},
+         {0, 8, 16, 24, 32, 40, 48, 56, 64, 80, 96, 112, 128, 144, 160}}};
+    static const int kSampleRates[3] = {44100, 48000, 32000};
+
+    if (p[0] != 0xFF || (p[1] & 0xE0) != 0xE0) {
+        return false;
+    }
+    int versionBits = (p[1] >> 3) & 0x03;
+    int layerBits = (p[1] >> 1) & 0x03;
+    int bitrateIndex = (p[2] >> 4) & 0x0F;
+    int rateIndex = (p[2] >> 2) & 0x03;
+    if (versionBits == 1 || layerBits == 0 || bitrateIndex == 0 || bitrateIndex == 15 || rateIndex == 3) {
+        return false;
+    }
+
+    frame.version = versionBits == 3 ? 1 : (versionBits == 2 ? 2 : 25);
+    frame.layer = 4 - layerBits;
+    frame.bitrate = kBitrates[frame.version == 1 ? 0 : 1][frame.layer - 1][bitrateIndex];
+    frame.sampleRate = kSampleRates[rateIndex] / (frame.version == 1 ? 1 : (frame.version == 2 ? 2 : 4));
+    frame.channels = ((p[3] >> 6) & 0x03) == 3 ? 1 : 2;
+    int padding = (p[2] >> 1) & 0x01;
+    if (frame.layer == 1) {
+        frame.samplesPerFrame = 384;
+        frame.length = static_cast<size_t>((12 * frame.bitrate * 1000 / frame.sampleRate + padding) * 4);
+    } else {
+        frame.samplesPerFrame = (frame.layer == 3 && frame.version != 1) ? 576 : 1152;
+        frame.length = static_cast<size_t>(frame.samplesPerFrame / 8 * frame.bitrate * 1000 / frame.sampleRate +
+                                           padding);
+    }
+    return frame.length > 4;
+}
+
+bool parseMpegInfoFrame(const uint8_t* p, size_t available, const MpegFrameHeader& frame, uint64_t& frames) {
+    frames = 0;
+    size_t sideInfo = frame.version == 1 ? (frame.channels == 1 ? 17 : 32) : (frame.channels == 1 ? 9 : 17);
+    if (available >= 4 + sideInfo + 12 &&
+        (std::memcmp(p + 4 + sideInfo, "Xing", 4) == 0 || std::memcmp(p + 4 + sideInfo, "Info", 4) == 0)) {
+        const uint8_t* xing = p + 4 + sideInfo;
+        if (be32(xing + 4) & 0x01) {
+            frames = be32(xing + 8);
+        }
+        return true;
+    }
+    if (available >= 36 + 18 && std::memcmp(p + 36, "VBRI", 4) == 0) {
+        frames = be32(p + 36 + 14);
+        return true;
+    }
+    return false;
+}
+
+}  // namespace musicfree
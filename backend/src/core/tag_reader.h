@@ -0,0 +1,60 @@
+#ifndef MUSICFREE_TAG_READER_H
+#define MUSICFREE_TAG_READER_H
+
+#include "../include/audio_engine.h"
+#include <string>
+
+namespace musicfree {
+
+/**
+ * 读取音频文件的标签和流信息，不解码音频
+ *
+ * 只读取文件头和标签所在的字节，跳过封面图片、音频数据和采样表：
+ *   - MP3：ID3v2（2.2 / 2.3 / 2.4）标题 / 艺术家 / 专辑 / TLEN，缺失的字段由文件末尾的 ID3v1 补全；
+ *     时长取自第一帧的 Xing / Info / VBRI 头，没有时按固定码率估算
+ *   - FLAC：STREAMINFO 和 VORBIS_COMMENT（前面带 ID3v2 的也能识别）
+ *   - MP4 / M4A：mvhd 时长、stsd 采样率和声道、ilst 中的 ©nam / ©ART / ©alb
+ *   - WAV / AIFF：与播放共用的文件头解析
+ * @param filePath 文件路径
+ * @param info 输出音频信息；format 为 mp3 / flac / m4a / wav / aiff
+ * @return 识别出格式返回 true（标签字段可能为空）
+ */
+bool readAudioTags(const std::string& filePath, AudioInfo& info);
+
+/**
+ * 没有标题标签时的标题：去掉目录和扩展名的文件名
+ */
+std::string fileStem(const std::string& filePath);
+
+/**
+ * MPEG 音频帧头
+ */
+struct MpegFrameHeader {
+    int version = 0;  // 1 = MPEG-1，2 = MPEG-2，25 = MPEG-2.5
+    int layer = 0;
+    int bitrate = 0;  // kbps
+    int sampleRate = 0;
+    int channels = 0;
+    int samplesPerFrame = 0;
+    size_t length = 0;  // 帧长（字节）
+};
+
+/**
+ * 解析 4 字节的 MPEG 音频帧头（不支持自由码率）
+ * @return 帧头有效时返回 true
+ */
+bool parseMpegFrameHeader(const uint8_t* p, MpegFrameHeader& frame);
+
+/**
+ * 检查帧是否为 Xing / Info / VBRI 信息帧（编码器写在第一帧位置，不含音频）
+ * @param p 帧的起始位置
+ * @param available p 之后可读的字节数
+ * @param frame 已解析的帧头
+ * @param frames 输出信息帧记录的音频帧数，没有记录时为 0
+ * @return 是信息帧时返回 true
+ */
+bool parseMpegInfoFrame(const uint8_t* p, size_t available, const MpegFrameHeader& frame, uint64_t& frames);
+
+}  // namespace musicfree
+
+#endif  // MUSICFREE_TAG_READER_H
@@ -0,0 +1,576 @@
+#include "waveform.h"
+#include "audio_source.h"
+#include "pcm_file_source.h"
+#include <algorithm>
+#include <cmath>
+#include <memory>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define MUSICFREE_WAVEFORM_X86 1
+#endif
+
+namespace musicfree {
+
+namespace {
+
+constexpr double kPi = 3.14159265358979323846;
+constexpr size_t kLanes = FftBatch::kLanes;
+
+// 每次从数据源读取的帧数
+constexpr size_t kBlockFrames = 4096;
+
+// 按播放时的布局解码：单声道复制到两个声道
+constexpr int kChannels = 2;
+
+// 文件中频带数的上限（防止损坏的文件导致巨大的分配）
+constexpr uint32_t kMaxBands = 1024;
+
+int16_t quantize(float sample) {
+    float scaled = std::max(-1.0f, std::min(1.0f, sample)) * 32767.0f;
+    return static_cast<int16_t>(std::lround(scaled));
+}
+
+void minMaxScalar(const float* samples, size_t count, float& lo, float& hi) {
+    float mn = samples[0], mx = samples[0];
+    for (size_t i = 1; i < count; ++i) {
+        mn = std::min(mn, samples[i]);
+        mx = std::max(mx, samples[i]);
+    }
+    lo = mn;
+    hi = mx;
+}
+
+#ifdef MUSICFREE_WAVEFORM_X86
+
+__attribute__((target("sse4.1")))
+void minMaxSse(const float* samples, size_t count, float& lo, float& hi) {
+    if (count < 4) {
+        minMaxScalar(samples, count, lo, hi);
+        return;
+    }
+    __m128 mn = _mm_loadu_ps(samples), mx = mn;
+    size_t i = 4;
+    for (; i + 4 <= count; i += 4) {
+        __m128 x = _mm_loadu_ps(samples + i);
+        mn = _mm_min_ps(mn, x);
+        mx = _mm_max_ps(mx, x);
+    }
+    mn = _mm_min_ps(mn, _mm_movehl_ps(mn, mn));
+    mn = _mm_min_ss(mn, _mm_shuffle_ps(mn, mn, 1));
+    mx = _mm_max_ps(mx, _mm_movehl_ps(mx, mx));
+    mx = _mm_max_ss(mx, _mm_shuffle_ps(mx, mx, 1));
+    float a = _mm_cvtss_f32(mn), b = _mm_cvtss_f32(mx);
+    for (; i < count; ++i) {
+        a = std::min(a, samples[i]);
+        b = std::max(b, samples[i]);
+    }
+    lo = a;
+    hi = b;
+}
+
+__attribute__((target("avx2")))
+void minMaxAvx2(const float* samples, size_t count, float& lo, float& hi) {
+    if (count < 16) {
+        minMaxScalar(samples, count, lo, hi);
+        return;
+    }
+    __m256 mn0 = _mm256_loadu_ps(samples), mx0 = mn0;
+    __m256 mn1 = _mm256_loadu_ps(samples + 8), mx1 = mn1;
+    size_t i = 16;
+    for (; i + 16 <= count; i += 16) {
+        __m256 x0 = _mm256_loadu_ps(samples + i), x1 = _mm256_loadu_ps(samples + i + 8);
+        mn0 = _mm256_min_ps(mn0, x0);
+        mx0 = _mm256_max_ps(mx0, x0);
+        mn1 = _mm256_min_ps(mn1, x1);
+        mx1 = _mm256_max_ps(mx1, x1);
+    }
+    __m256 mn8 = _mm256_min_ps(mn0, mn1), mx8 = _mm256_max_ps(mx0, mx1);
+    __m128 mn = _mm_min_ps(_mm256_castps256_ps128(mn8), _mm256_extractf128_ps(mn8, 1));
+    __m128 mx = _mm_max_ps(_mm256_castps256_ps128(mx8), _mm256_extractf128_ps(mx8, 1));
+    mn = _mm_min_ps(mn, _mm_movehl_ps(mn, mn));
+    mn = _mm_min_ss(mn, _mm_shuffle_ps(mn, mn, 1));
+    mx = _mm_max_ps(mx, _mm_movehl_ps(mx, mx));
+    mx = _mm_max_ss(mx, _mm_shuffle_ps(mx, mx, 1));
+    float a = _mm_cvtss_f32(mn), b = _mm_cvtss_f32(mx);
+    for (; i < count; ++i) {
+        a = std::min(a, samples[i]);
+        b = std::max(b, samples[i]);
+    }
+    lo = a;
+    hi = b;
+}
+
+#endif
+
+/**
+ * 最小值和最大值，count 不为 0
+ */
+void minMax(const float* samples, size_t count, float& lo, float& hi, SimdLevel level) {
+#ifdef MUSICFREE_WAVEFORM_X86
+    if (level == SimdLevel::AVX2) {
+        minMaxAvx2(samples, count, lo, hi);
+        return;
+    }
+    if (level == SimdLevel::SSE42) {
+        minMaxSse(samples, count, lo, hi);
+        return;
+    }
+#else
+    (void)level;
+#endif
+    minMaxScalar(samples, count, lo, hi);
+}
+
+WaveformPeak mergePeaks(const WaveformPeak& a, const WaveformPeak& b) {
+    WaveformPeak peak;
+    peak.min = std::min(a.min, b.min);
+    peak.max = std::max(a.max, b.max);
+    return peak;
+}
+
+/**
+ * 金字塔中的一段：第 level 级的 [begin, end) 个桶
+ */
+struct LevelSpan {
+    size_t level = 0;
+    size_t begin = 0;
+    size_t end = 0;
+};
+
+/**
+ * 最细一级的 [b0, b1) 个桶（b0 < b1，points 不超过 b1 - b0）对应的最粗一级，这一级的桶数不少于 points、少于约 2 * points + 2
+ */
+LevelSpan selectSpan(size_t levels, size_t b0, size_t b1, size_t points) {
+    LevelSpan span;
+    while (span.level + 1 < levels && ((b1 - b0) >> (span.level + 1)) >= points) {
+        ++span.level;
+    }
+    span.begin = b0 >> span.level;
+    span.end = (b1 + (static_cast<size_t>(1) << span.level) - 1) >> span.level;
+    return span;
+}
+
+/**
+ * 把帧范围换算成最细一级的桶范围，返回输出点数（范围为空时为 0）
+ */
+size_t bucketRange(uint64_t startFrame, uint64_t endFrame, uint64_t unit, size_t count, size_t resolution,
+                   size_t& b0, size_t& b1) {
+    b0 = static_cast<size_t>(std::min<uint64_t>(startFrame / unit, count));
+    b1 = static_cast<size_t>(std::min<uint64_t>((endFrame + unit - 1) / unit, count));
+    return b1 > b0 ? std::min(resolution, b1 - b0) : 0;
+}
+
+void putU32(std::string& out, uint32_t value) {
+    for (int i = 0; i < 4; ++i) {
+        out += static_cast<char>((value >> (8 * i)) & 0xFF);
+    }
+}
+
+void putU64(std::string& out, uint64_t value) {
+    putU32(out, static_cast<uint32_t>(value));
+    putU32(out, static_cast<uint32_t>(value >> 32));
+}
+
+bool getU32(const uint8_t* data, size_t size, size_t& pos, uint32_t& value) {
+    if (size - pos < 4) {
+        return false;
+    }
+    value = static_cast<uint32_t>(data[pos]) | static_cast<uint32_t>(data[pos + 1]) << 8 |
+            static_cast<uint32_t>(data[pos + 2]) << 16 | static_cast<uint32_t>(data[pos + 3]) << 24;
+    pos += 4;
+    return true;
+}
+
+bool getU64(const uint8_t* data, size_t size, size_t& pos, uint64_t& value) {
+    uint32_t low, high;
+    if (!getU32(data, size, pos, low) || !getU32(data, size, pos, high)) {
+        return false;
+    }
+    value = static_cast<uint64_t>(high) << 32 | low;
+    return true;
+}
+
+}  // namespace
+
+size_t WaveformData::memoryBytes() const {
+    size_t bytes = 0;
+    for (const auto& level : levels) {
+        bytes += level.size() * sizeof(WaveformPeak);
+    }
+    for (const auto& level : spectrumLevels) {
+        bytes += level.size();
+    }
+    return bytes;
+}
+
+void buildWaveformLevels(WaveformData& data) {
+    data.levels.resize(1);
+    while (data.levels.back().size() > 1) {
+        const std::vector<WaveformPeak>& previous = data.levels.back();
+        std::vector<WaveformPeak> next((previous.size() + 1) / 2);
+        for (size_t i = 0; i < next.size(); ++i) {
+            next[i] = 2 * i + 1 < previous.size() ? mergePeaks(previous[2 * i], previous[2 * i + 1])
+                                                  : previous[2 * i];
+        }
+        data.levels.push_back(std::move(next));
+    }
+
+    if (!data.hasSpectrum()) {
+        data.spectrumLevels.clear();
+        return;
+    }
+    size_t bands = data.bands;
+    data.spectrumLevels.resize(1);
+    while (data.spectrumLevels.back().size() > bands) {
+        const std::vector<uint8_t>& previous = data.spectrumLevels.back();
+        size_t columns = previous.size() / bands;
+        std::vector<uint8_t> next((columns + 1) / 2 * bands);
+        for (size_t i = 0; i < columns; ++i) {
+            uint8_t* out = next.data() + (i / 2) * bands;
+            const uint8_t* in = previous.data() + i * bands;
+            for (size_t b = 0; b < bands; ++b) {
+                out[b] = std::max(out[b], in[b]);
+            }
+        }
+        data.spectrumLevels.push_back(std::move(next));
+    }
+}
+
+std::vector<double> spectrumBandEdges(int sampleRate, uint32_t bands) {
+    std::vector<double> edges(bands + 1);
+    double nyquist = sampleRate / 2.0;
+    double low = std::min(kSpectrumMinFrequency, nyquist / 2);
+    for (uint32_t b = 0; b <= bands; ++b) {
+        edges[b] = low * std::pow(nyquist / low, static_cast<double>(b) / bands);
+    }
+    return edges;
+}
+
+// ===== WaveformBuilder =====
+
+WaveformBuilder::WaveformBuilder(int sampleRate, int channels, bool spectrum, SimdLevel level)
+    : sample_rate_(sampleRate),
+      channels_(channels),
+      level_(std::min(level, detectSimdLevel())),
+      spectrum_(spectrum),
+      fft_(kSpectrumFftSize, level) {
+    if (!spectrum_) {
+        return;
+    }
+    window_.resize(kSpectrumFftSize);
+    for (size_t i = 0; i < kSpectrumFftSize; ++i) {
+        window_[i] = static_cast<float>(0.5 - 0.5 * std::cos(2.0 * kPi * static_cast<double>(i) / kSpectrumFftSize));
+    }
+    re_.assign(kSpectrumFftSize * kLanes, 0.0f);
+    im_.assign(kSpectrumFftSize * kLanes, 0.0f);
+
+    // 频带包含中心频率落在边界之间的 FFT 点；低频的窄频带可能一个点也没有，取离频带中心最近的点
+    std::vector<double> edges = spectrumBandEdges(sampleRate, kSpectrumBands);
+    double pointsPerHz = static_cast<double>(kSpectrumFftSize) / sampleRate;
+    uint32_t last = kSpectrumFftSize / 2 + 1;
+    for (uint32_t b = 0; b < kSpectrumBands; ++b) {
+        auto begin = static_cast<uint32_t>(std::ceil(edges[b] * pointsPerHz));
+        auto end = b + 1 == kSpectrumBands ? last : static_cast<uint32_t>(std::ceil(edges[b + 1] * pointsPerHz));
+        if (end <= begin) {
+            begin = static_cast<uint32_t>(std::lround(std::sqrt(edges[b] * edges[b + 1]) * pointsPerHz));
+            end = begin + 1;
+        }
+        begin = std::max<uint32_t>(begin, 1);
+        end = std::min(std::max(end, begin + 1), last);
+        band_begin_.push_back(begin);
+        band_end_.push_back(end);
+    }
+}
+
+void WaveformBuilder::process(const float* samples, size_t frames) {
+    size_t channels = static_cast<size_t>(channels_);
+    const float* p = samples;
+    for (size_t remaining = frames; remaining > 0;) {
+        size_t n = std::min(remaining, kWaveformBucketFrames - bucket_fill_);
+        float lo, hi;
+        minMax(p, n * channels, lo, hi, level_);
+        if (bucket_fill_ == 0) {
+            bucket_min_ = lo;
+            bucket_max_ = hi;
+        } else {
+            bucket_min_ = std::min(bucket_min_, lo);
+            bucket_max_ = std::max(bucket_max_, hi);
+        }
+        bucket_fill_ += n;
+        if (bucket_fill_ == kWaveformBucketFrames) {
+            flushBucket();
+        }
+        p += n * channels;
+        remaining -= n;
+    }
+    frames_ += frames;
+
+    if (!spectrum_) {
+        return;
+    }
+    // 每列只有开头 kSpectrumFftSize 帧进入 FFT，其余帧跳过
+    float scale = 1.0f / static_cast<float>(channels);
+    for (size_t f = 0; f < frames;) {
+        if (column_pos_ < kSpectrumFftSize) {
+            size_t n = std::min(frames - f, kSpectrumFftSize - column_pos_);
+            const float* src = samples + f * channels;
+            float* dst = re_.data() + column_pos_ * kLanes + lane_;
+            const float* window = window_.data() + column_pos_;
+            for (size_t i = 0; i < n; ++i, src += channels) {
+                float sum = 0.0f;
+                for (size_t c = 0; c < channels; ++c) {
+                    sum += src[c];
+                }
+                dst[i * kLanes] = sum * scale * window[i];
+            }
+            column_pos_ += n;
+            f += n;
+        } else {
+            size_t n = std::min(frames - f, kSpectrumHopFrames - column_pos_);
+            column_pos_ += n;
+            f += n;
+        }
+        if (column_pos_ == kSpectrumHopFrames) {
+            column_pos_ = 0;
+            if (++lane_ == kLanes) {
+                flushSpectrum(kLanes);
+            }
+        }
+    }
+}
+
+void WaveformBuilder::flushBucket() {
+    WaveformPeak peak;
+    peak.min = quantize(bucket_min_);
+    peak.max = quantize(bucket_max_);
+    peaks_.push_back(peak);
+    bucket_fill_ = 0;
+}
+
+void WaveformBuilder::flushSpectrum(size_t columns) {
+    fft_.transform(re_.data(), im_.data());
+    // 满幅正弦加 Hann 窗后峰值点的幅度为 N / 4
+    double reference = 16.0 / (static_cast<double>(kSpectrumFftSize) * kSpectrumFftSize);
+    for (size_t lane = 0; lane < columns; ++lane) {
+        for (size_t b = 0; b < kSpectrumBands; ++b) {
+            float power = 0.0f;
+            for (size_t k = band_begin_[b]; k < band_end_[b]; ++k) {
+                float r = re_[k * kLanes + lane], i = im_[k * kLanes + lane];
+                power = std::max(power, r * r + i * i);
+            }
+            double db = 10.0 * std::log10(std::max(power * reference, 1e-20));
+            double value = (db - kSpectrumFloorDb) * 255.0 / -kSpectrumFloorDb;
+            columns_.push_back(static_cast<uint8_t>(std::lround(std::max(0.0, std::min(255.0, value)))));
+        }
+    }
+    std::fill(im_.begin(), im_.end(), 0.0f);
+    lane_ = 0;
+}
+
+void WaveformBuilder::finish(WaveformData& data) {
+    if (bucket_fill_ > 0) {
+        flushBucket();
+    }
+    if (spectrum_) {
+        // 最后不满的一列补静音
+        if (column_pos_ > 0) {
+            for (size_t k = std::min<size_t>(column_pos_, kSpectrumFftSize); k < kSpectrumFftSize; ++k) {
+                re_[k * kLanes + lane_] = 0.0f;
+            }
+            column_pos_ = 0;
+            ++lane_;
+        }
+        if (lane_ > 0) {
+            flushSpectrum(lane_);
+        }
+    }
+
+    data = WaveformData();
+    data.sampleRate = sample_rate_;
+    data.channels = channels_;
+    data.totalFrames = frames_;
+    data.levels.resize(1);
+    data.levels[0] = std::move(peaks_);
+    if (spectrum_) {
+        data.fftSize = kSpectrumFftSize;
+        data.hopFrames = kSpectrumHopFrames;
+        data.bands = kSpectrumBands;
+        data.spectrumLevels.resize(1);
+        data.spectrumLevels[0] = std::move(columns_);
+    }
+    buildWaveformLevels(data);
+    peaks_.clear();
+    columns_.clear();
+    frames_ = 0;
+}
+
+bool buildWaveform(const std::string& filePath, int rawSampleRate, bool spectrum, WaveformData& data,
+                   const std::atomic<bool>* cancelled) {
+    std::unique_ptr<AudioSource> source;
+    AudioInfo info;
+    if (openPcmFile(filePath, rawSampleRate, kChannels, source, info) != PcmOpenResult::OK) {
+        return false;
+    }
+    WaveformBuilder builder(source->sampleRate(), kChannels, spectrum);
+    std::vector<float> buffer(kBlockFrames * kChannels);
+    for (;;) {
+        if (cancelled != nullptr && cancelled->load(std::memory_order_relaxed)) {
+            return false;
+        }
+        size_t n = source->read(buffer.data(), kBlockFrames);
+        builder.process(buffer.data(), n);
+        if (n < kBlockFrames) {
+            break;
+        }
+    }
+    builder.finish(data);
+    if (info.channels > 0) {
+        data.channels = info.channels;
+    }
+    return true;
+}
+
+void serializeWaveform(const WaveformData& data, std::string& out) {
+    static const std::vector<WaveformPeak> kEmptyPeaks;
+    static const std::vector<uint8_t> kEmptyColumns;
+    const std::vector<WaveformPeak>& peaks = data.levels.empty() ? kEmptyPeaks : data.levels[0];
+    const std::vector<uint8_t>& columns = data.spectrumLevels.empty() ? kEmptyColumns : data.spectrumLevels[0];
+
+    out.reserve(out.size() + 48 + peaks.size() * 4 + columns.size());
+    putU32(out, static_cast<uint32_t>(data.sampleRate));
+    putU32(out, static_cast<uint32_t>(data.channels));
+    putU64(out, data.totalFrames);
+    putU32(out, data.bucketFrames);
+    putU32(out, static_cast<uint32_t>(peaks.size()));
+    for (const WaveformPeak& peak : peaks) {
+        uint32_t packed = static_cast<uint16_t>(peak.min) | static_cast<uint32_t>(static_cast<uint16_t>(peak.max)) << 16;
+        putU32(out, packed);
+    }
+    putU32(out, data.fftSize);
+    putU32(out, data.hopFrames);
+    putU32(out, data.bands);
+    putU32(out, data.bands == 0 ? 0 : static_cast<uint32_t>(columns.size() / data.bands));
+    out.append(reinterpret_cast<const char*>(columns.data()), columns.size());
+}
+
+bool deserializeWaveform(const uint8_t* data, size_t size, WaveformData& waveform) {
+    waveform = WaveformData();
+    size_t pos = 0;
+    uint32_t sampleRate, channels, bucketFrames, count;
+    if (!getU32(data, size, pos, sampleRate) || !getU32(data, size, pos, channels) ||
+        !getU64(data, size, pos, waveform.totalFrames) || !getU32(data, size, pos, bucketFrames) ||
+        !getU32(data, size, pos, count) || sampleRate == 0 || sampleRate > 1000000 || bucketFrames == 0 ||
+        count != (waveform.totalFrames + bucketFrames - 1) / bucketFrames || (size - pos) / 4 < count) {
+        return false;
+    }
+    waveform.sampleRate = static_cast<int>(sampleRate);
+    waveform.channels = static_cast<int>(channels);
+    waveform.bucketFrames = bucketFrames;
+
+    waveform.levels.resize(1);
+    std::vector<WaveformPeak>& peaks = waveform.levels[0];
+    peaks.resize(count);
+    for (WaveformPeak& peak : peaks) {
+        uint32_t packed = 0;
+        getU32(data, size, pos, packed);  // 长度已经检查过
+        peak.min = static_cast<int16_t>(packed & 0xFFFF);
+        peak.max = static_cast<int16_t>(packed >> 16);
+    }
+
+    uint32_t columns;
+    if (!getU32(data, size, pos, waveform.fftSize) || !getU32(data, size, pos, waveform.hopFrames) ||
+        !getU32(data, size, pos, waveform.bands) || !getU32(data, size, pos, columns)) {
+        return false;
+    }
+    if (waveform.fftSize != 0) {
+        if (waveform.hopFrames == 0 || waveform.bands == 0 || waveform.bands > kMaxBands ||
+            columns != (waveform.totalFrames + waveform.hopFrames - 1) / waveform.hopFrames ||
+            size - pos != static_cast<size_t>(columns) * waveform.bands) {
+            return false;
+        }
+        waveform.spectrumLevels.resize(1);
+        waveform.spectrumLevels[0].assign(data + pos, data + size);
+        pos = size;
+    }
+    if (pos != size) {
+        return false;
+    }
+    buildWaveformLevels(waveform);
+    return true;
+}
+
+void queryWaveform(const WaveformData& data, const WaveformQuery& query, WaveformView& view) {
+    view = WaveformView();
+    view.sampleRate = data.sampleRate;
+    view.channels = data.channels;
+    view.totalFrames = data.totalFrames;
+    if (data.sampleRate <= 0 || data.levels.empty()) {
+        return;
+    }
+
+    size_t resolution = std::max<size_t>(1, std::min(query.resolution, kMaxWaveformResolution));
+    uint64_t rate = static_cast<uint64_t>(data.sampleRate);
+    // 先把毫秒限制在曲目长度内，换算成帧时不会溢出
+    uint64_t maxMs = data.totalFrames * 1000 / rate + 1;
+    uint64_t startFrame = std::min(std::min(query.startMs, maxMs) * rate / 1000, data.totalFrames);
+    uint64_t endFrame = query.endMs == 0 ? data.totalFrames
+                                         : std::min(std::min(query.endMs, maxMs) * rate / 1000, data.totalFrames);
+    view.startFrame = view.endFrame = startFrame;
+
+    // 峰值：输出第 i 点合并所选级别的 [begin + i * n / points, begin + (i + 1) * n / points) 个桶
+    size_t b0, b1;
+    size_t points = bucketRange(startFrame, endFrame, data.bucketFrames, data.levels[0].size(), resolution, b0, b1);
+    if (points > 0) {
+        LevelSpan span = selectSpan(data.levels.size(), b0, b1, points);
+        const std::vector<WaveformPeak>& level = data.levels[span.level];
+        size_t n = span.end - span.begin;
+        view.peaks.resize(points * 2);
+        for (size_t i = 0; i < points; ++i) {
+            size_t first = span.begin + i * n / points;
+            size_t last = span.begin + (i + 1) * n / points;
+            WaveformPeak peak = level[first];
+            for (size_t j = first + 1; j < last; ++j) {
+                peak = mergePeaks(peak, level[j]);
+            }
+            view.peaks[i * 2] = peak.min;
+            view.peaks[i * 2 + 1] = peak.max;
+        }
+        uint64_t unit = static_cast<uint64_t>(data.bucketFrames) << span.level;
+        view.startFrame = span.begin * unit;
+        view.endFrame = std::min<uint64_t>(span.end * unit, data.totalFrames);
+    }
+
+    if (!query.spectrum || !data.hasSpectrum() || data.spectrumLevels.empty()) {
+        return;
+    }
+    view.hasSpectrum = true;
+    view.bands = data.bands;
+    view.bandFrequencies = spectrumBandEdges(data.sampleRate, data.bands);
+    size_t bands = data.bands;
+    view.spectrumStartFrame = view.spectrumEndFrame = startFrame;
+    points = bucketRange(startFrame, endFrame, data.hopFrames, data.spectrumLevels[0].size() / bands, resolution,
+                         b0, b1);
+    if (points == 0) {
+        return;
+    }
+    LevelSpan span = selectSpan(data.spectrumLevels.size(), b0, b1, points);
+    const std::vector<uint8_t>& level = data.spectrumLevels[span.level];
+    size_t n = span.end - span.begin;
+    view.spectrum.assign(points * bands, 0);
+    for (size_t i = 0; i < points; ++i) {
+        uint8_t* out = view.spectrum.data() + i * bands;
+        size_t last = span.begin + (i + 1) * n / points;
+        for (size_t j = span.begin + i * n / points; j < last; ++j) {
+            const uint8_t* in = level.data() + j * bands;
+            for (size_t b = 0; b < bands; ++b) {
+                out[b] = std::max(out[b], in[b]);
+            }
+        }
+    }
+    uint64_t unit = static_cast<uint64_t>(data.hopFrames) << span.level;
+    view.spectrumStartFrame = span.begin * unit;
+    view.spectrumEndFrame = std::min<uint64_t>(span.end * unit, data.totalFrames);
+}
+
+}  // namespace musicfree
@@ -0,0 +1,149 @@
+#ifndef MUSICFREE_WAVEFORM_H
+#define MUSICFREE_WAVEFORM_H
+
+#include "../include/waveform_store.h"
+#include "fft.h"
+#include "simd_level.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace musicfree {
+
+// 最细一级每个峰值桶的帧数
+constexpr uint32_t kWaveformBucketFrames = 256;
+
+// 频谱：每 kSpectrumHopFrames 帧取开头 kSpectrumFftSize 帧（Hann 窗）做一次 FFT
+constexpr uint32_t kSpectrumFftSize = 2048;
+constexpr uint32_t kSpectrumHopFrames = 4096;
+constexpr uint32_t kSpectrumBands = 64;
+constexpr double kSpectrumMinFrequency = 20.0;
+constexpr double kSpectrumFloorDb = -100.0;
+
+/**
+ * 一个峰值桶（各声道合并后的最小值和最大值）
+ */
+struct WaveformPeak {
+    int16_t min = 0;
+    int16_t max = 0;
+};
+
+/**
+ * 一个文件的波形数据
+ * levels[k] 的每个桶覆盖 bucketFrames << k 帧，由 levels[k - 1] 的相邻两个桶合并得到，最粗一级只有一个桶；
+ * spectrumLevels 同样组织，每列 bands 个值（取各频带功率的最大值），合并时逐频带取最大值。
+ * 序列化时只写最细一级，加载后重建其余级别（约为最细一级的一倍大小）。
+ */
+struct WaveformData {
+    int sampleRate = 0;
+    int channels = 0;
+    uint64_t totalFrames = 0;
+    uint32_t bucketFrames = kWaveformBucketFrames;
+    std::vector<std::vector<WaveformPeak>> levels;
+
+    uint32_t fftSize = 0;  // 0 表示没有频谱
+    uint32_t hopFrames = 0;
+    uint32_t bands = 0;
+    std::vector<std::vector<uint8_t>> spectrumLevels;  // 列数 * bands
+
+    bool hasSpectrum() const { return fftSize != 0; }
+
+    /**
+     * 在内存中占用的字节数（各级合计）
+     */
+    size_t memoryBytes() const;
+};
+
+/**
+ * 由最细一级建立金字塔的其余级别
+ */
+void buildWaveformLevels(WaveformData& data);
+
+/**
+ * 频谱各频带的边界：kSpectrumMinFrequency 到奈奎斯特频率按对数等分
+ * @return bands + 1 个频率（Hz）
+ */
+std::vector<double> spectrumBandEdges(int sampleRate, uint32_t bands);
+
+/**
+ * 流式波形计算（float32 交错采样）
+ *
+ * 峰值：每 kWaveformBucketFrames 帧用 SIMD 求一次最小 / 最大值，量化到 int16（舍入是单调的，
+ * 量化后的最值等于最值的量化）。
+ * 频谱：各声道平均后加窗写进 FftBatch 的一路，凑满 8 列做一次成批变换，
+ * 每个频带取最大的功率换算成 dBFS（满幅正弦为 0 dB）。
+ * 缓冲区在构造时分配，process() 不分配内存（结果数组按需增长）。
+ */
+class WaveformBuilder {
+public:
+    WaveformBuilder(int sampleRate, int channels, bool spectrum, SimdLevel level = detectSimdLevel());
+
+    void process(const float* samples, size_t frames);
+
+    /**
+     * 输入结束：写出最后不满的桶和列，建立金字塔
+     * @param data 输出（已建立金字塔）
+     */
+    void finish(WaveformData& data);
+
+private:
+    void flushBucket();
+    void flushSpectrum(size_t columns);
+
+    int sample_rate_;
+    int channels_;
+    SimdLevel level_;
+    uint64_t frames_ = 0;
+
+    std::vector<WaveformPeak> peaks_;
+    float bucket_min_ = 0.0f;
+    float bucket_max_ = 0.0f;
+    size_t bucket_fill_ = 0;
+
+    bool spectrum_;
+    FftBatch fft_;
+    std::vector<float> window_;
+    std::vector<float> re_;  // kSpectrumFftSize * kLanes
+    std::vector<float> im_;
+    std::vector<uint32_t> band_begin_;  // 各频带的 FFT 点范围 [begin, end)
+    std::vector<uint32_t> band_end_;
+    size_t column_pos_ = 0;  // 当前列已经读过的帧数
+    size_t lane_ = 0;        // 当前列在这一批中的路号
+    std::vector<uint8_t> columns_;
+};
+
+/**
+ * 解码文件并计算波形（WAV / AIFF / 原始 PCM，按文件自身的采样率）
+ * @param filePath 文件路径
+ * @param rawSampleRate 原始 PCM 文件按这个采样率解释
+ * @param spectrum 同时计算频谱
+ * @param data 输出
+ * @param cancelled 不为空且变为 true 时放弃
+ * @return 成功返回 true；无法打开、没有解码器或被取消时返回 false
+ */
+bool buildWaveform(const std::string& filePath, int rawSampleRate, bool spectrum, WaveformData& data,
+                   const std::atomic<bool>* cancelled = nullptr);
+
+/**
+ * 序列化最细一级（追加到 out，小端）：
+ *   采样率 u32 | 声道数 u32 | 总帧数 u64 | 桶帧数 u32 | 桶数 u32 | 桶（min i16, max i16）... |
+ *   FFT 点数 u32（0 表示没有频谱） | 列间隔 u32 | 频带数 u32 | 列数 u32 | 列数 * 频带数 u8
+ */
+void serializeWaveform(const WaveformData& data, std::string& out);
+
+/**
+ * 解析 serializeWaveform 的输出并建立金字塔
+ * @return 数据完整且一致时返回 true
+ */
+bool deserializeWaveform(const uint8_t* data, size_t size, WaveformData& waveform);
+
+/**
+ * 查询：峰值和频谱分别选桶数不少于点数的最粗一级，每点合并一到三个桶，耗时与点数成正比
+ */
+void queryWaveform(const WaveformData& data, const WaveformQuery& query, WaveformView& view);
+
+}  // namespace musicfree
+
+#endif  // MUSICFREE_WAVEFORM_H
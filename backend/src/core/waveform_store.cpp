@@ -0,0 +1,232 @@
+#include "../include/waveform_store.h"
+#include "../include/metadata_cache.h"
+#include "waveform.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <iostream>
+#include <list>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <sys/stat.h>
+
+namespace musicfree {
+
+namespace {
+
+/**
+ * 文件的大小和修改时间，任何一个变化都视为文件已修改
+ */
+struct FileStamp {
+    uint64_t size = 0;
+    int64_t mtime = 0;  // 纳秒
+
+    bool operator==(const FileStamp& other) const { return size == other.size && mtime == other.mtime; }
+};
+
+bool statFile(const std::string& filePath, FileStamp& stamp) {
+    struct stat st;
+    if (stat(filePath.c_str(), &st) != 0) {
+        return false;
+    }
+    stamp.size = static_cast<uint64_t>(st.st_size);
+#if defined(__APPLE__)
+    stamp.mtime = static_cast<int64_t>(st.st_mtimespec.tv_sec) * 1000000000 + st.st_mtimespec.tv_nsec;
+#elif defined(__unix__)
+    stamp.mtime = static_cast<int64_t>(st.st_mtim.tv_sec) * 1000000000 + st.st_mtim.tv_nsec;
+#else
+    stamp.mtime = static_cast<int64_t>(st.st_mtime) * 1000000000;
+#endif
+    return true;
+}
+
+}  // namespace
+
+class WaveformStore::Impl {
+public:
+    struct Entry {
+        FileStamp stamp;
+        std::shared_ptr<const WaveformData> data;
+        std::list<std::string>::iterator position;  // 在 recent 中的位置
+    };
+
+    struct Job {
+        std::string path;
+        bool spectrum = false;
+    };
+
+    int raw_sample_rate;
+    size_t memory_entries;
+
+    mutable std::mutex mutex;
+    std::condition_variable wake;
+    std::unordered_map<std::string, Entry> entries;
+    std::list<std::string> recent;  // 最近使用的在前
+    std::unordered_map<std::string, FileStamp> failed;
+    std::deque<Job> queue;
+    std::unordered_map<std::string, bool> pending;  // 路径 -> 是否需要频谱（含正在解码的）
+    std::thread worker;
+    std::atomic<bool> stopping{false};
+    WaveformStoreStats stats;
+
+    Impl(int rawSampleRate, size_t memoryEntries)
+        : raw_sample_rate(rawSampleRate), memory_entries(std::max<size_t>(memoryEntries, 1)) {}
+
+    /**
+     * 放进内存并淘汰最久没有使用的文件，调用方持有 mutex
+     */
+    void remember(const std::string& path, const FileStamp& stamp, std::shared_ptr<const WaveformData> data) {
+        auto it = entries.find(path);
+        if (it != entries.end()) {
+            recent.erase(it->second.position);
+            entries.erase(it);
+        }
+        recent.push_front(path);
+        Entry& entry = entries[path];
+        entry.stamp = stamp;
+        entry.data = std::move(data);
+        entry.position = recent.begin();
+        while (entries.size() > memory_entries) {
+            entries.erase(recent.back());
+            recent.pop_back();
+        }
+    }
+
+    /**
+     * 排队解码（已在队列中时只合并频谱需求），需要时启动工作线程，调用方持有 mutex
+     */
+    void enqueue(const std::string& path, bool spectrum) {
+        auto it = pending.find(path);
+        if (it != pending.end()) {
+            it->second = it->second || spectrum;
+            return;
+        }
+        pending[path] = spectrum;
+        queue.push_back(Job{path, spectrum});
+        if (!worker.joinable()) {
+            worker = std::thread([this] { run(); });
+        }
+        wake.notify_one();
+    }
+
+    void run() {
+        std::unique_lock<std::mutex> lock(mutex);
+        for (;;) {
+            wake.wait(lock, [this] { return stopping.load() || !queue.empty(); });
+            if (stopping.load()) {
+                return;
+            }
+            Job job = std::move(queue.front());
+            queue.pop_front();
+            // 排队期间可能有查询要求了频谱
+            job.spectrum = pending[job.path] || job.spectrum;
+            lock.unlock();
+
+            auto begin = std::chrono::steady_clock::now();
+            FileStamp stamp;
+            auto data = std::make_shared<WaveformData>();
+            bool ok = statFile(job.path, stamp) &&
+                      buildWaveform(job.path, raw_sample_rate, job.spectrum, *data, &stopping);
+            if (ok) {
+                // 没有缓存路径时不写入，只留在内存中
+                MetadataCache::getInstance().storeWaveform(job.path, *data);
+            }
+            double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+            lock.lock();
+            bool wantsSpectrum = pending[job.path];
+            pending.erase(job.path);
+            if (stopping.load()) {
+                return;
+            }
+            if (ok) {
+                ++stats.built;
+                stats.buildSeconds += seconds;
+                stats.audioSeconds += static_cast<double>(data->totalFrames) / data->sampleRate;
+                remember(job.path, stamp, std::move(data));
+                failed.erase(job.path);
+                if (wantsSpectrum && !job.spectrum) {
+                    enqueue(job.path, true);
+                }
+            } else {
+                ++stats.failed;
+                failed[job.path] = stamp;
+                std::cerr << "Failed to build waveform: " << job.path << std::endl;
+            }
+        }
+    }
+};
+
+WaveformStore::WaveformStore(int rawSampleRate, size_t memoryEntries)
+    : impl_(std::make_unique<Impl>(rawSampleRate, memoryEntries)) {}
+
+WaveformStore::~WaveformStore() {
+    {
+        std::lock_guard<std::mutex> lock(impl_->mutex);
+        impl_->stopping.store(true);
+    }
+    impl_->wake.notify_all();
+    if (impl_->worker.joinable()) {
+        impl_->worker.join();
+    }
+}
+
+WaveformStatus WaveformStore::query(const std::string& filePath, const WaveformQuery& query, WaveformView& view) {
+    FileStamp stamp;
+    if (!statFile(filePath, stamp)) {
+        return WaveformStatus::FAILED;
+    }
+
+    std::shared_ptr<const WaveformData> data;
+    {
+        std::lock_guard<std::mutex> lock(impl_->mutex);
+        auto it = impl_->entries.find(filePath);
+        if (it != impl_->entries.end() && it->second.stamp == stamp &&
+            (!query.spectrum || it->second.data->hasSpectrum())) {
+            impl_->recent.splice(impl_->recent.begin(), impl_->recent, it->second.position);
+            ++impl_->stats.memoryHits;
+            data = it->second.data;
+        } else {
+            auto failed = impl_->failed.find(filePath);
+            if (failed != impl_->failed.end() && failed->second == stamp) {
+                return WaveformStatus::FAILED;
+            }
+            if (impl_->pending.count(filePath) != 0) {
+                impl_->enqueue(filePath, query.spectrum);
+                return WaveformStatus::PENDING;
+            }
+        }
+    }
+
+    if (!data) {
+        // 内存中没有：先找缓存目录（只读文件，不解码），还没有保存过才排队解码
+        auto loaded = std::make_shared<WaveformData>();
+        bool found = MetadataCache::getInstance().getWaveform(filePath, *loaded) &&
+                     (!query.spectrum || loaded->hasSpectrum());
+        std::lock_guard<std::mutex> lock(impl_->mutex);
+        if (!found) {
+            impl_->enqueue(filePath, query.spectrum);
+            return WaveformStatus::PENDING;
+        }
+        ++impl_->stats.loaded;
+        impl_->remember(filePath, stamp, loaded);
+        data = std::move(loaded);
+    }
+
+    // 数据不可变，查询不持有锁
+    queryWaveform(*data, query, view);
+    return WaveformStatus::READY;
+}
+
+WaveformStoreStats WaveformStore::getStats() const {
+    std::lock_guard<std::mutex> lock(impl_->mutex);
+    WaveformStoreStats stats = impl_->stats;
+    stats.pending = impl_->pending.size();
+    stats.memoryEntries = impl_->entries.size();
+    return stats;
+}
+
+}  // namespace musicfree
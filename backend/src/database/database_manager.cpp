@@ -0,0 +1,245 @@
+/**
+ * 数据库管理器实现
+ * 当前为内存存储，进程退出后数据不保留
+ * TODO: 接入 SQLite3 做持久化（见 CMakeLists.txt 中的可选依赖）
+ */
+
+#include "../include/database_manager.h"
+#include <algorithm>
+#include <ctime>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <unordered_set>
+
+namespace musicfree {
+
+class DatabaseManager::Impl {
+public:
+    mutable std::mutex mutex;
+    std::string db_path;
+    bool initialized = false;
+
+    std::map<std::string, Playlist> playlists;
+    std::vector<Track> favorites;
+    std::unordered_set<std::string> favorite_ids;  // 收藏去重，批量添加时避免逐个线性查找
+    std::deque<Track> history;
+    uint64_t favorites_version = 0;
+    uint64_t history_version = 0;
+    std::map<std::string, std::string> settings;
+    int next_playlist_id = 1;
+
+    static constexpr size_t kMaxHistory = 1000;
+};
+
+DatabaseManager::DatabaseManager() : impl_(std::make_unique<Impl>()) {}
+
+DatabaseManager::~DatabaseManager() = default;
+
+DatabaseManager& DatabaseManager::getInstance() {
+    static DatabaseManager instance;
+    return instance;
+}
+
+bool DatabaseManager::initialize(const std::string& dbPath) {
+    std::lock_guard<std::mutex> lock(impl_->mutex);
+    impl_->db_path = dbPath;
+    impl_->initialized = true;
+    return true;
+}
+
+void DatabaseManager::shutdown() {
+    std::lock_guard<std::mutex> lock(impl_->mutex);
+    impl_->initialized = false;
+}
+
+// ===== 播放列表操作 =====
+
+std::string DatabaseManager::createPlaylist(const std::string& playlistName) {
+    std::lock_guard<std::mutex> lock(impl_->mutex);
+
+    Playlist playlist;
+    playlist.id = "playlist-" + std::to_string(impl_->next_playlist_id++);
+    playlist.name = playlistName;
+    playlist.createdAt = std::time(nullptr);
+    playlist.updatedAt = playlist.createdAt;
+
+    impl_->playlists[playlist.id] = playlist;
+    return playlist.id;
+}
+
+bool DatabaseManager::deletePlaylist(const std::string& playlistId) {
+    std::lock_guard<std::mutex> lock(impl_->mutex);
+    return impl_->playlists.erase(playlistId) > 0;
+}
+
+std::vector<Playlist> DatabaseManager::getAllPlaylists() const {
+    std::lock_guard<std::mutex> lock(impl_->mutex);
+
+    std::vector<Playlist> result;
+    result.reserve(impl_->playlists.size());
+    for (const auto& entry : impl_->playlists) {
+        result.push_back(entry.second);
+    }
+    return result;
+}
+
+Playlist DatabaseManager::getPlaylist(const std::string& playlistId) const {
+    std::lock_guard<std::mutex> lock(impl_->mutex);
+
+    auto it = impl_->playlists.find(playlistId);
+    if (it == impl_->playlists.end()) {
+        return Playlist();
+    }
+    return it->second;
+}
+
+bool DatabaseManager::addTrackToPlaylist(const std::string& playlistId, const Track& track) {
+    std::lock_guard<std::mutex> lock(impl_->mutex);
+
+    auto it = impl_->playlists.find(playlistId);
+    if (it == impl_->playlists.end()) {
+        return false;
+    }
+
+    it->second.tracks.push_back(track);
+    it->second.updatedAt = std::time(nullptr);
+    return true;
+}
+
+bool DatabaseManager::removeTrackFromPlaylist(const std::string& playlistId, const std::string& trackId) {
+    std::lock_guard<std::mutex> lock(impl_->mutex);
+
+    auto it = impl_->playlists.find(playlistId);
+    if (it == impl_->playlists.end()) {
+        return false;
+    }
+
+    auto& tracks = it->second.tracks;
+    auto pos = std::find_if(tracks.begin(), tracks.end(),
+                            [&](const Track& t) { return t.id == trackId; });
+    if (pos == tracks.end()) {
+        return false;
+    }
+
+    tracks.erase(pos);
+    it->second.updatedAt = std::time(nullptr);
+    return true;
+}
+
+// ===== 收藏操作 =====
+
+bool DatabaseManager::addToFavorite(const Track& track) {
+    std::lock_guard<std::mutex> lock(impl_->mutex);
+
+    if (!impl_->favorite_ids.insert(track.id).second) {
+        return false;
+    }
+
+    impl_->favorites.push_back(track);
+    ++impl_->favorites_version;
+    return true;
+}
+
+size_t DatabaseManager::addToFavorites(const std::vector<Track>& tracks) {
+    std::lock_guard<std::mutex> lock(impl_->mutex);
+
+    size_t added = 0;
+    for (const auto& track : tracks) {
+        if (impl_->favorite_ids.insert(track.id).second) {
+            impl_->favorites.push_back(track);
+            ++added;
+        }
+    }
+    if (added > 0) {
+        ++impl_->favorites_version;
+    }
+    return added;
+}
+
+bool DatabaseManager::removeFromFavorite(const std::string& trackId) {
+    std::lock_guard<std::mutex> lock(impl_->mutex);
+
+    auto& favorites = impl_->favorites;
+    auto pos = std::find_if(favorites.begin(), favorites.end(),
+                            [&](const Track& t) { return t.id == trackId; });
+    if (pos == favorites.end()) {
+        return false;
+    }
+
+    impl_->favorite_ids.erase(trackId);
+    favorites.erase(pos);
+    ++impl_->favorites_version;
+    return true;
+}
+
+std::vector<Track> DatabaseManager::getFavorites() const {
+    std::lock_guard<std::mutex> lock(impl_->mutex);
+    return impl_->favorites;
+}
+
+uint64_t DatabaseManager::getFavoritesVersion() const {
+    std::lock_guard<std::mutex> lock(impl_->mutex);
+    return impl_->favorites_version;
+}
+
+bool DatabaseManager::isFavorited(const std::string& trackId) const {
+    std::lock_guard<std::mutex> lock(impl_->mutex);
+
+    return impl_->favorite_ids.count(trackId) > 0;
+}
+
+// ===== 播放历史操作 =====
+
+void DatabaseManager::addToHistory(const Track& track) {
+    std::lock_guard<std::mutex> lock(impl_->mutex);
+
+    // 最近播放的排在最前
+    impl_->history.push_front(track);
+    if (impl_->history.size() > Impl::kMaxHistory) {
+        impl_->history.pop_back();
+    }
+    ++impl_->history_version;
+}
+
+std::vector<Track> DatabaseManager::getHistory(int limit) const {
+    std::lock_guard<std::mutex> lock(impl_->mutex);
+
+    size_t count = impl_->history.size();
+    if (limit >= 0 && static_cast<size_t>(limit) < count) {
+        count = limit;
+    }
+    return std::vector<Track>(impl_->history.begin(), impl_->history.begin() + count);
+}
+
+uint64_t DatabaseManager::getHistoryVersion() const {
+    std::lock_guard<std::mutex> lock(impl_->mutex);
+    return impl_->history_version;
+}
+
+bool DatabaseManager::clearHistory() {
+    std::lock_guard<std::mutex> lock(impl_->mutex);
+    impl_->history.clear();
+    ++impl_->history_version;
+    return true;
+}
+
+// ===== 用户设置操作 =====
+
+bool DatabaseManager::setSetting(const std::string& key, const std::string& value) {
+    std::lock_guard<std::mutex> lock(impl_->mutex);
+    impl_->settings[key] = value;
+    return true;
+}
+
+std::string DatabaseManager::getSetting(const std::string& key, const std::string& defaultValue) const {
+    std::lock_guard<std::mutex> lock(impl_->mutex);
+
+    auto it = impl_->settings.find(key);
+    if (it == impl_->settings.end()) {
+        return defaultValue;
+    }
+    return it->second;
+}
+
+}  // namespace musicfree
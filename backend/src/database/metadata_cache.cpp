@@ -0,0 +1,587 @@
+/**
+ * 元数据缓存实现
+ * 缓存文件为小端二进制格式：
+ *   "MFMC" | 版本 u32 | 条目数 u32 | 条目...
+ *   条目：路径 | 大小 u64 | 修改时间 i64（纳秒） | 已识别 u8 |
+ *         标题 | 艺术家 | 专辑 | 格式 | 时长 i32 | 采样率 i32 | 声道数 i32 | 位深 i32 |
+ *         已分析响度 u8 | 单曲响度 | 单曲峰值 | 专辑响度 | 专辑峰值（f64，版本 2 起）
+ *   字符串为长度 u32 加 UTF-8 字节，f64 按 IEEE 754 位模式存为 u64
+ *   版本 1 的文件照常加载，条目视为没有分析过响度
+ *
+ * 跳转表保存在 <缓存路径>.seek/ 目录中，文件名为路径的 64 位 FNV-1a 散列：
+ *   "MFSI" | 版本 u32 | 路径 | 大小 u64 | 修改时间 i64 | serializeSeekIndex 的输出
+ * 波形数据同样保存在 <缓存路径>.waveform/ 目录中：
+ *   "MFWF" | 版本 u32 | 路径 | 大小 u64 | 修改时间 i64 | serializeWaveform 的输出
+ */
+
+#include "../include/metadata_cache.h"
+#include "../core/mapped_file.h"
+#include "../core/seek_index.h"
+#include "../core/tag_reader.h"
+#include "../core/waveform.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <mutex>
+#include <sys/stat.h>
+#if defined(_WIN32)
+#include <direct.h>
+#endif
+#include <unordered_map>
+#include <vector>
+
+namespace musicfree {
+
+namespace {
+
+constexpr char kMagic[4] = {'M', 'F', 'M', 'C'};
+constexpr uint32_t kFormatVersion = 2;
+constexpr uint32_t kMinFormatVersion = 1;
+
+constexpr char kSeekIndexMagic[4] = {'M', 'F', 'S', 'I'};
+constexpr uint32_t kSeekIndexVersion = 1;
+
+constexpr char kWaveformMagic[4] = {'M', 'F', 'W', 'F'};
+constexpr uint32_t kWaveformVersion = 1;
+
+// 所有字符串为空时一个条目的长度（版本 1）
+constexpr size_t kMinEntryBytes = 4 + 8 + 8 + 1 + 4 * 4 + 4 * 4;
+
+uint64_t doubleBits(double value) {
+    uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+double bitsDouble(uint64_t bits) {
+    double value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+/**
+ * 文件的大小和修改时间，任何一个变化都视为文件已修改
+ */
+struct FileStamp {
+    uint64_t size = 0;
+    int64_t mtime = 0;  // 纳秒
+
+    bool operator==(const FileStamp& other) const { return size == other.size && mtime == other.mtime; }
+};
+
+bool statFile(const std::string& filePath, FileStamp& stamp) {
+    struct stat st;
+    if (stat(filePath.c_str(), &st) != 0) {
+        return false;
+    }
+    stamp.size = static_cast<uint64_t>(st.st_size);
+#if defined(__APPLE__)
+    stamp.mtime = static_cast<int64_t>(st.st_mtimespec.tv_sec) * 1000000000 + st.st_mtimespec.tv_nsec;
+#elif defined(__unix__)
+    stamp.mtime = static_cast<int64_t>(st.st_mtim.tv_sec) * 1000000000 + st.st_mtim.tv_nsec;
+#else
+    stamp.mtime = static_cast<int64_t>(st.st_mtime) * 1000000000;
+#endif
+    return true;
+}
+
+class Writer {
+public:
+    explicit Writer(std::string& out) : out_(out) {}
+
+    void u8(uint8_t value) { out_ += static_cast<char>(value); }
+
+    void u32(uint32_t value) {
+        for (int i = 0; i < 4; ++i) {
+            out_ += static_cast<char>((value >> (8 * i)) & 0xFF);
+        }
+    }
+
+    void u64(uint64_t value) {
+        u32(static_cast<uint32_t>(value));
+        u32(static_cast<uint32_t>(value >> 32));
+    }
+
+    void str(const std::string& value) {
+        u32(static_cast<uint32_t>(value.size()));
+        out_ += value;
+    }
+
+private:
+    std::string& out_;
+};
+
+/**
+ * 带边界检查的读取，越界后所有读取都失败
+ */
+class Reader {
+public:
+    explicit Reader(const std::string& data) : data_(data) {}
+
+    bool ok() const { return ok_; }
+    size_t position() const { return pos_; }
+
+    uint8_t u8() {
+        if (!need(1)) return 0;
+        return static_cast<uint8_t>(data_[pos_++]);
+    }
+
+    uint32_t u32() {
+        if (!need(4)) return 0;
+        uint32_t value = 0;
+        for (int i = 0; i < 4; ++i) {
+            value |= static_cast<uint32_t>(static_cast<uint8_t>(data_[pos_++])) << (8 * i);
+        }
+        return value;
+    }
+
+    uint64_t u64() {
+        uint64_t low = u32();
+        return low | (static_cast<uint64_t>(u32()) << 32);
+    }
+
+    std::string str() {
+        uint32_t length = u32();
+        if (!need(length)) return std::string();
+        std::string value = data_.substr(pos_, length);
+        pos_ += length;
+        return value;
+    }
+
+private:
+    bool need(size_t n) {
+        if (!ok_ || data_.size() - pos_ < n) {
+            ok_ = false;
+        }
+        return ok_;
+    }
+
+    const std::string& data_;
+    size_t pos_ = 0;
+    bool ok_ = true;
+};
+
+/**
+ * 跳转表和波形文件名：路径的 64 位 FNV-1a 散列（文件中另存完整路径，散列冲突时视为未命中）
+ */
+std::string cacheFileName(const std::string& filePath, const char* extension) {
+    uint64_t hash = 1469598103934665603ull;
+    for (char c : filePath) {
+        hash = (hash ^ static_cast<uint8_t>(c)) * 1099511628211ull;
+    }
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx.%s", static_cast<unsigned long long>(hash), extension);
+    return name;
+}
+
+/**
+ * 跳转表和波形文件的文件头：魔数 | 版本 | 路径 | 大小 | 修改时间
+ */
+void writeFileHeader(std::string& data, const char* magic, uint32_t version, const std::string& filePath,
+                     const FileStamp& stamp) {
+    Writer writer(data);
+    data.append(magic, 4);
+    writer.u32(version);
+    writer.str(filePath);
+    writer.u64(stamp.size);
+    writer.u64(static_cast<uint64_t>(stamp.mtime));
+}
+
+/**
+ * 检查文件头，文件已变化或属于其他路径（散列冲突）时返回 false
+ */
+bool readFileHeader(Reader& reader, const char* magic, uint32_t version, const std::string& filePath,
+                    const FileStamp& stamp) {
+    bool valid = true;
+    for (int i = 0; i < 4; ++i) {
+        valid = reader.u8() == static_cast<uint8_t>(magic[i]) && valid;
+    }
+    valid = reader.u32() == version && valid;
+    valid = reader.str() == filePath && valid;
+    valid = reader.u64() == stamp.size && valid;
+    valid = static_cast<int64_t>(reader.u64()) == stamp.mtime && valid;
+    return valid && reader.ok();
+}
+
+void makeDirectory(const std::string& path) {
+#if defined(_WIN32)
+    _mkdir(path.c_str());
+#else
+    mkdir(path.c_str(), 0755);
+#endif
+}
+
+bool readFile(const std::string& path, std::string& data) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        return false;
+    }
+    data.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    return true;
+}
+
+/**
+ * 写入临时文件后改名，中途退出不会留下半个文件
+ */
+bool writeFileAtomically(const std::string& path, const std::string& data) {
+    std::string tempPath = path + ".tmp";
+    {
+        std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+        file.write(data.data(), static_cast<std::streamsize>(data.size()));
+        if (!file.flush()) {
+            std::remove(tempPath.c_str());
+            return false;
+        }
+    }
+    if (std::rename(tempPath.c_str(), path.c_str()) != 0) {
+        std::remove(tempPath.c_str());
+        return false;
+    }
+    return true;
+}
+
+}  // namespace
+
+class MetadataCache::Impl {
+public:
+    struct Entry {
+        FileStamp stamp;
+        bool recognized = false;
+        AudioInfo info;
+    };
+
+    mutable std::mutex mutex;
+    std::string cache_path;
+    std::unordered_map<std::string, Entry> entries;
+    bool dirty = false;
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t seek_indexes_built = 0;
+    uint64_t seek_indexes_loaded = 0;
+
+    /**
+     * 解析缓存文件内容，调用方持有 mutex
+     */
+    bool load(const std::string& data) {
+        Reader reader(data);
+        for (char c : kMagic) {
+            if (reader.u8() != static_cast<uint8_t>(c)) {
+                return false;
+            }
+        }
+        uint32_t version = reader.u32();
+        if (version < kMinFormatVersion || version > kFormatVersion) {
+            return false;
+        }
+        uint32_t count = reader.u32();
+        // 条目数来自文件，按最小条目长度限制预留量，损坏的文件不会导致巨大的分配
+        entries.reserve(std::min<size_t>(count, data.size() / kMinEntryBytes));
+        for (uint32_t i = 0; i < count && reader.ok(); ++i) {
+            std::string path = reader.str();
+            Entry entry;
+            entry.stamp.size = reader.u64();
+            entry.stamp.mtime = static_cast<int64_t>(reader.u64());
+            entry.recognized = reader.u8() != 0;
+            entry.info.title = reader.str();
+            entry.info.artist = reader.str();
+            entry.info.album = reader.str();
+            entry.info.format = reader.str();
+            entry.info.duration = static_cast<int32_t>(reader.u32());
+            entry.info.sampleRate = static_cast<int32_t>(reader.u32());
+            entry.info.channels = static_cast<int32_t>(reader.u32());
+            entry.info.bitsPerSample = static_cast<int32_t>(reader.u32());
+            if (version >= 2) {
+                entry.info.loudnessAnalyzed = reader.u8() != 0;
+                entry.info.loudness.trackLoudness = bitsDouble(reader.u64());
+                entry.info.loudness.trackPeak = bitsDouble(reader.u64());
+                entry.info.loudness.albumLoudness = bitsDouble(reader.u64());
+                entry.info.loudness.albumPeak = bitsDouble(reader.u64());
+            }
+            if (reader.ok()) {
+                entries.emplace(std::move(path), std::move(entry));
+            }
+        }
+        return reader.ok();
+    }
+
+    /**
+     * 序列化全部条目，调用方持有 mutex
+     */
+    std::string serialize() const {
+        std::string out;
+        out.reserve(16 + entries.size() * 128);
+        Writer writer(out);
+        out.append(kMagic, 4);
+        writer.u32(kFormatVersion);
+        writer.u32(static_cast<uint32_t>(entries.size()));
+        for (const auto& item : entries) {
+            const Entry& entry = item.second;
+            writer.str(item.first);
+            writer.u64(entry.stamp.size);
+            writer.u64(static_cast<uint64_t>(entry.stamp.mtime));
+            writer.u8(entry.recognized ? 1 : 0);
+            writer.str(entry.info.title);
+            writer.str(entry.info.artist);
+            writer.str(entry.info.album);
+            writer.str(entry.info.format);
+            writer.u32(static_cast<uint32_t>(entry.info.duration));
+            writer.u32(static_cast<uint32_t>(entry.info.sampleRate));
+            writer.u32(static_cast<uint32_t>(entry.info.channels));
+            writer.u32(static_cast<uint32_t>(entry.info.bitsPerSample));
+            writer.u8(entry.info.loudnessAnalyzed ? 1 : 0);
+            writer.u64(doubleBits(entry.info.loudness.trackLoudness));
+            writer.u64(doubleBits(entry.info.loudness.trackPeak));
+            writer.u64(doubleBits(entry.info.loudness.albumLoudness));
+            writer.u64(doubleBits(entry.info.loudness.albumPeak));
+        }
+        return out;
+    }
+};
+
+MetadataCache::MetadataCache() : impl_(std::make_unique<Impl>()) {}
+
+MetadataCache::~MetadataCache() = default;
+
+MetadataCache& MetadataCache::getInstance() {
+    static MetadataCache instance;
+    return instance;
+}
+
+bool MetadataCache::initialize(const std::string& cachePath) {
+    std::lock_guard<std::mutex> lock(impl_->mutex);
+    impl_->cache_path = cachePath;
+    impl_->entries.clear();
+    impl_->dirty = false;
+    impl_->hits = 0;
+    impl_->misses = 0;
+    impl_->seek_indexes_built = 0;
+    impl_->seek_indexes_loaded = 0;
+    if (cachePath.empty()) {
+        return true;
+    }
+
+    std::string data;
+    if (!readFile(cachePath, data)) {
+        return true;  // 第一次运行
+    }
+    if (!impl_->load(data)) {
+        std::cerr << "Discarding corrupt metadata cache: " << cachePath << std::endl;
+        impl_->entries.clear();
+        return false;
+    }
+    return true;
+}
+
+bool MetadataCache::save() {
+    std::string data;
+    std::string path;
+    {
+        std::lock_guard<std::mutex> lock(impl_->mutex);
+        if (!impl_->dirty || impl_->cache_path.empty()) {
+            return true;
+        }
+        data = impl_->serialize();
+        path = impl_->cache_path;
+        impl_->dirty = false;
+    }
+
+    if (!writeFileAtomically(path, data)) {
+        std::cerr << "Failed to write metadata cache: " << path << std::endl;
+        std::lock_guard<std::mutex> lock(impl_->mutex);
+        impl_->dirty = true;
+        return false;
+    }
+    return true;
+}
+
+void MetadataCache::shutdown() {
+    save();
+    std::lock_guard<std::mutex> lock(impl_->mutex);
+    impl_->entries.clear();
+    impl_->cache_path.clear();
+}
+
+bool MetadataCache::lookup(const std::string& filePath, AudioInfo& info) {
+    FileStamp stamp;
+    if (!statFile(filePath, stamp)) {
+        return false;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(impl_->mutex);
+        auto it = impl_->entries.find(filePath);
+        if (it != impl_->entries.end() && it->second.stamp == stamp) {
+            ++impl_->hits;
+            info = it->second.info;
+            return it->second.recognized;
+        }
+        ++impl_->misses;
+    }
+
+    // 读取标签需要磁盘 I/O，不持有锁
+    Impl::Entry entry;
+    entry.stamp = stamp;
+    bool recognized = readAudioTags(filePath, entry.info);
+    entry.recognized = recognized;
+    info = entry.info;
+
+    std::lock_guard<std::mutex> lock(impl_->mutex);
+    impl_->entries[filePath] = std::move(entry);
+    impl_->dirty = true;
+    return recognized;
+}
+
+bool MetadataCache::getSeekIndex(const std::string& filePath, SeekIndex& index) {
+    FileStamp stamp;
+    if (!statFile(filePath, stamp)) {
+        return false;
+    }
+    std::string directory;
+    {
+        std::lock_guard<std::mutex> lock(impl_->mutex);
+        if (!impl_->cache_path.empty()) {
+            directory = impl_->cache_path + ".seek";
+        }
+    }
+    std::string indexPath = directory.empty() ? std::string() : directory + "/" + cacheFileName(filePath, "idx");
+
+    std::string data;
+    if (!indexPath.empty() && readFile(indexPath, data)) {
+        Reader reader(data);
+        bool valid = readFileHeader(reader, kSeekIndexMagic, kSeekIndexVersion, filePath, stamp);
+        const uint8_t* body = reinterpret_cast<const uint8_t*>(data.data()) + reader.position();
+        if (valid && reader.ok() && deserializeSeekIndex(body, data.size() - reader.position(), index)) {
+            std::lock_guard<std::mutex> lock(impl_->mutex);
+            ++impl_->seek_indexes_loaded;
+            return true;
+        }
+    }
+
+    // 第一次打开或文件已变化：建立跳转表，不持有锁
+    MappedFile file;
+    if (!file.open(filePath) || !buildSeekIndex(file.data(), file.size(), index)) {
+        return false;
+    }
+    {
+        std::lock_guard<std::mutex> lock(impl_->mutex);
+        ++impl_->seek_indexes_built;
+    }
+    if (indexPath.empty()) {
+        return true;
+    }
+
+    data.clear();
+    writeFileHeader(data, kSeekIndexMagic, kSeekIndexVersion, filePath, stamp);
+    serializeSeekIndex(index, data);
+    makeDirectory(directory);
+    if (!writeFileAtomically(indexPath, data)) {
+        std::cerr << "Failed to write seek index: " << indexPath << std::endl;
+    }
+    return true;
+}
+
+bool MetadataCache::storeLoudness(const std::string& filePath, const LoudnessInfo& loudness) {
+    AudioInfo info;
+    lookup(filePath, info);
+    FileStamp stamp;
+    if (!statFile(filePath, stamp)) {
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(impl_->mutex);
+    auto it = impl_->entries.find(filePath);
+    if (it == impl_->entries.end() || !(it->second.stamp == stamp)) {
+        return false;
+    }
+    it->second.info.loudnessAnalyzed = true;
+    it->second.info.loudness = loudness;
+    impl_->dirty = true;
+    return true;
+}
+
+bool MetadataCache::getLoudness(const std::string& filePath, LoudnessInfo& loudness) {
+    FileStamp stamp;
+    if (!statFile(filePath, stamp)) {
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(impl_->mutex);
+    auto it = impl_->entries.find(filePath);
+    if (it == impl_->entries.end() || !(it->second.stamp == stamp) || !it->second.info.loudnessAnalyzed) {
+        return false;
+    }
+    loudness = it->second.info.loudness;
+    return true;
+}
+
+bool MetadataCache::getWaveform(const std::string& filePath, WaveformData& waveform) {
+    FileStamp stamp;
+    if (!statFile(filePath, stamp)) {
+        return false;
+    }
+    std::string path;
+    {
+        std::lock_guard<std::mutex> lock(impl_->mutex);
+        if (impl_->cache_path.empty()) {
+            return false;
+        }
+        path = impl_->cache_path + ".waveform/" + cacheFileName(filePath, "wf");
+    }
+
+    std::string data;
+    if (!readFile(path, data)) {
+        return false;
+    }
+    Reader reader(data);
+    if (!readFileHeader(reader, kWaveformMagic, kWaveformVersion, filePath, stamp)) {
+        return false;
+    }
+    const uint8_t* body = reinterpret_cast<const uint8_t*>(data.data()) + reader.position();
+    return deserializeWaveform(body, data.size() - reader.position(), waveform);
+}
+
+bool MetadataCache::storeWaveform(const std::string& filePath, const WaveformData& waveform) {
+    FileStamp stamp;
+    if (!statFile(filePath, stamp)) {
+        return false;
+    }
+    std::string directory;
+    {
+        std::lock_guard<std::mutex> lock(impl_->mutex);
+        if (impl_->cache_path.empty()) {
+            return false;
+        }
+        directory = impl_->cache_path + ".waveform";
+    }
+
+    std::string data;
+    writeFileHeader(data, kWaveformMagic, kWaveformVersion, filePath, stamp);
+    serializeWaveform(waveform, data);
+    makeDirectory(directory);
+    std::string path = directory + "/" + cacheFileName(filePath, "wf");
+    if (!writeFileAtomically(path, data)) {
+        std::cerr << "Failed to write waveform: " << path << std::endl;
+        return false;
+    }
+    return true;
+}
+
+MetadataCacheStats MetadataCache::getStats() const {
+    std::lock_guard<std::mutex> lock(impl_->mutex);
+    MetadataCacheStats stats;
+    stats.entries = impl_->entries.size();
+    stats.hits = impl_->hits;
+    stats.misses = impl_->misses;
+    stats.seekIndexesBuilt = impl_->seek_indexes_built;
+    stats.seekIndexesLoaded = impl_->seek_indexes_loaded;
+    for (const auto& item : impl_->entries) {
+        if (item.second.info.loudnessAnalyzed) {
+            ++stats.loudnessEntries;
+        }
+    }
+    return stats;
+}
+
+}  // namespace musicfree
@@ -2,6 +2,7 @@
 #include "../include/audio_engine.h"
 #include "../include/playlist_manager.h"
 #include "../include/database_manager.h"
+#include "../include/metadata_cache.h"
 #include <iostream>
 #include <csignal>
 #include <atomic>
@@ -31,14 +32,27 @@ int main(int argc, char* argv[]) {
     // 启动 API 服务器
     ApiServer api_server;
     
-    int port = 8888;
+    // 用法: musicfree_server [port] [threads] [unixSocketPath] [metadataCachePath]
+    ApiServerOptions options;
     if (argc > 1) {
-        port = std::stoi(argv[1]);
+        options.port = std::stoi(argv[1]);
     }
+    if (argc > 2) {
+        options.threads = std::stoi(argv[2]);
+    }
+    if (argc > 3) {
+        options.unixSocketPath = argv[3];
+    }
+
+    // 元数据缓存：未指定路径时只缓存在内存中
+    std::string metadataCachePath = argc > 4 ? argv[4] : "";
+    MetadataCache::getInstance().initialize(metadataCachePath);
+
+    int port = options.port;
 
     std::cout << "Starting API server on port " << port << "..." << std::endl;
     
-    if (!api_server.start(port)) {
+    if (!api_server.start(options)) {
         std::cerr << "Failed to start API server!" << std::endl;
         return 1;
     }
@@ -65,6 +79,7 @@ int main(int argc, char* argv[]) {
 
     std::cout << "Stopping API server..." << std::endl;
     api_server.stop();
+    MetadataCache::getInstance().shutdown();
     std::cout << "[OK] Server stopped" << std::endl;
 
     return 0;
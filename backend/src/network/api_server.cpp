@@ -1,9 +1,9 @@
 /**
  * REST API 服务器实现
- * 使用简单的 HTTP 服务处理前端请求
- * 
+ * 基于 epoll 的非阻塞 HTTP/1.1 服务（见 reactor.h），处理前端请求
+ *
  * API 端点列表：
- * 
+ *
  * 音乐播放：
  *   POST   /api/player/load           - 加载音乐文件
  *   POST   /api/player/play           - 播放
@@ -11,66 +11,1940 @@
  *   POST   /api/player/stop           - 停止
  *   POST   /api/player/seek           - 跳转到指定位置
  *   POST   /api/player/volume         - 设置音量
+ *   POST   /api/player/crossfade      - 设置曲目切换的交叉淡化（duration 毫秒，curve 为 linear / equalPower）
+ *   GET    /api/player/eq             - 获取均衡器与限幅器设置
+ *   POST   /api/player/eq             - 修改均衡器与限幅器设置（省略的字段保持不变，bands 整体替换）
+ *   GET    /api/player/normalization  - 获取响度归一化设置
+ *   POST   /api/player/normalization  - 设置响度归一化（mode 为 off / track / album，target 为目标 LUFS）
  *   GET    /api/player/status         - 获取播放器状态
- * 
+ *   GET    /api/stream/{trackId}      - 读取已加载的本地音频文件（只限识别为音频的已知扩展名，支持 Range，sendfile 零拷贝发送）
+ *
  * 播放列表：
- *   GET    /api/playlist              - 获取当前播放列表
- *   POST   /api/playlist/add          - 添加轨道
+ *   GET    /api/playlist              - 获取当前播放列表（支持 ETag / If-None-Match）
+ *   POST   /api/playlist/add          - 添加轨道（请求体为 Track 数组时批量添加）
+ *   POST   /api/playlist/clear        - 清空播放列表
  *   DELETE /api/playlist/{index}      - 删除轨道
  *   GET    /api/playlist/next         - 下一首
  *   GET    /api/playlist/prev         - 上一首
- * 
+ *   POST   /api/playlist/mode         - 设置播放模式（order / repeatAll / repeatOne / shuffle）
+ *
+ * 响度分析：
+ *   POST   /api/loudness/analyze      - 在后台分析目录（directory，递归）或当前播放列表中的本地文件，
+ *                                       结果写进元数据缓存；已有一批在运行时返回 409，
+ *                                       文件列表也在后台收集，文件数见 /api/loudness/status
+ *   GET    /api/loudness/status       - 分析进度和上一批的结果
+ *
+ * 波形：
+ *   GET    /api/track/{id}/waveform   - 已加载或在播放列表中的本地文件的波形峰值（resolution 为点数，
+ *                                       start / end 为毫秒范围，spectrum=1 时同时返回频谱）；
+ *                                       第一次请求时在后台解码，返回 202，之后的任何缩放级别都不再解码
+ *
  * 搜索和发现：
  *   GET    /api/search?q=keyword      - 搜索音乐
  *   GET    /api/plugins              - 获取已加载插件
- * 
+ *
  * 用户数据：
- *   GET    /api/favorites            - 获取收藏
- *   POST   /api/favorites            - 添加到收藏
+ *   GET    /api/favorites            - 获取收藏（支持 ETag / If-None-Match）
+ *   POST   /api/favorites            - 添加到收藏（请求体为 Track 数组时批量添加，跳过已收藏的）
  *   DELETE /api/favorites/{id}       - 删除收藏
- *   GET    /api/history              - 获取播放历史
+ *   GET    /api/history              - 获取播放历史（支持 ETag / If-None-Match）
+ *   DELETE /api/history              - 清空播放历史
+ *
+ * 批量操作：
+ *   POST   /api/batch                - 在一次加锁内按顺序执行多个播放器 / 播放列表操作
+ *
+ * 事件推送：
+ *   GET    /api/events               - 播放器事件流（SSE；带 Upgrade: websocket 时为 WebSocket）
+ *                                      事件：status（连接时的完整状态）、state、position、trackEnded、
+ *                                      trackChanged（无缝切换到播放列表的下一首，数据为新的轨道）、
+ *                                      playlistChanged（版本号和轨道数，批量操作只推送一次）
+ *
+ * 系统：
+ *   GET    /api/health               - 健康检查
+ *   GET    /api/server/stats         - 各事件循环的连接 / 请求统计
+ *   GET    /api/metrics              - Prometheus 文本格式的运行指标：各路由的请求数、错误数、字节数、
+ *                                      耗时直方图和分位数，进行中的请求数，音频引擎和播放列表的计数
+ *
+ * 本地前端还可以通过 Unix 域套接字（ApiServerOptions::unixSocketPath）访问播放控制和
+ * 播放列表接口，使用长度前缀的二进制协议而不是 HTTP + JSON，见 ipc_protocol.h。
  */
 
 #include "../include/api_server.h"
 #include "../include/audio_engine.h"
 #include "../include/playlist_manager.h"
 #include "../include/database_manager.h"
+#include "../include/loudness_analyzer.h"
+#include "../include/plugin_manager.h"
+#include "../include/waveform_store.h"
+#include "ipc_protocol.h"
+#include "json.h"
+#include "json_writer.h"
+#include "prometheus.h"
+#include "reactor.h"
+#include "router.h"
+#include "track_parser.h"
+#include <strings.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
 #include <iostream>
-#include <sstream>
+#include <limits>
+#include <mutex>
 #include <thread>
 #include <atomic>
+#include <unordered_map>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
 
 namespace musicfree {
 
+namespace {
+
+const char* kServerVersion = "0.1.0";
+
+// 单个批量请求最多包含的操作数：批量期间一直持有 state_mutex
+constexpr size_t kMaxBatchOps = 10000;
+
+bool parseInt(const std::string& text, int& value) {
+    if (text.empty()) {
+        return false;
+    }
+    char* end = nullptr;
+    long parsed = std::strtol(text.c_str(), &end, 10);
+    if (end != text.c_str() + text.size() || parsed < std::numeric_limits<int>::min() ||
+        parsed > std::numeric_limits<int>::max()) {
+        return false;
+    }
+    value = static_cast<int>(parsed);
+    return true;
+}
+
+/**
+ * 本地文件的轨道 ID：路径的 FNV-1a 哈希
+ */
+std::string makeLocalTrackId(const std::string& filePath) {
+    uint64_t hash = 1469598103934665603ULL;
+    for (unsigned char c : filePath) {
+        hash ^= c;
+        hash *= 1099511628211ULL;
+    }
+    char id[24];
+    std::snprintf(id, sizeof(id), "local-%016llx", static_cast<unsigned long long>(hash));
+    return id;
+}
+
+/**
+ * 本地文件路径（而不是 http:// 等远程地址）
+ */
+bool isLocalPath(const std::string& url) {
+    return !url.empty() && url.find("://") == std::string::npos;
+}
+
+/**
+ * 根据扩展名推断音频文件的 Content-Type
+ * @return 不是已知的音频扩展名时返回 nullptr
+ */
+const char* audioContentType(const std::string& filePath) {
+    static const std::pair<const char*, const char*> kTypes[] = {
+        {".mp3", "audio/mpeg"},
+        {".flac", "audio/flac"},
+        {".wav", "audio/wav"},
+        {".ogg", "audio/ogg"},
+        {".opus", "audio/ogg"},
+        {".m4a", "audio/mp4"},
+        {".aac", "audio/aac"},
+        {".aiff", "audio/aiff"},
+        {".aif", "audio/aiff"},
+    };
+
+    size_t dot = filePath.rfind('.');
+    if (dot != std::string::npos && filePath.find('/', dot) == std::string::npos) {
+        std::string ext = filePath.substr(dot);
+        for (const auto& type : kTypes) {
+            if (strcasecmp(ext.c_str(), type.first) == 0) {
+                return type.second;
+            }
+        }
+    }
+    return nullptr;
+}
+
+}  // namespace
+
 class ApiServer::Impl {
 public:
-    std::thread server_thread;
     std::atomic<bool> running{false};
     int port = 8888;
+    ApiServerOptions options;
 
     // 全局引擎实例
     std::unique_ptr<AudioEngine> audio_engine;
     std::unique_ptr<PlaylistManager> playlist_manager;
 
+    // 每个事件循环线程一个 Reactor，路由表在启动前注册完毕，之后只读
+    std::vector<std::unique_ptr<Reactor>> reactors;
+    std::vector<std::thread> reactor_threads;
+    Router router;
+
+    // 事件发布：引擎回调可能在任意线程触发，publish_mutex 保护 reactors 的读取
+    std::mutex publish_mutex;
+    bool publishing = false;
+
+    // 保护 playlist_manager 和当前轨道：处理函数会在多个事件循环线程上并发执行
+    std::mutex state_mutex;
+    Track current_track;
+    bool has_current_track = false;
+    // 交给引擎预取的下一首，引擎切换过去之后成为当前轨道
+    Track pending_track;
+    int pending_index = -1;
+
+    // 轨道 ID → 本地文件路径：/api/stream 只开放通过引擎加载过的文件
+    std::unordered_map<std::string, std::string> local_files;
+
+    /**
+     * 按数据版本缓存的响应体
+     * 同一版本只序列化一次，之后的请求共享这份内容；If-None-Match 匹配时直接返回 304
+     */
+    struct CachedBody {
+        std::mutex mutex;
+        uint64_t version = 0;
+        int limit = -1;  // 播放历史的条数参数
+        std::shared_ptr<const std::string> body;
+    };
+
+    CachedBody playlist_cache;
+    CachedBody favorites_cache;
+    CachedBody history_cache;
+
+    // 响度分析：同时只运行一批，在后台线程上执行；loudness_mutex 保护线程和上一批的结果
+    LoudnessAnalyzer loudness_analyzer;
+    std::mutex loudness_mutex;
+    std::thread loudness_thread;
+    bool loudness_running = false;
+    bool loudness_finished = false;  // 有上一批的结果
+    bool loudness_stopping = false;  // 服务器正在析构，收集完文件列表后不再开始分析
+    LoudnessBatchResult loudness_result;
+
+    // 波形：后台解码一次，之后的查询由内存或缓存目录中的峰值金字塔回答
+    WaveformStore waveform_store;
+
+    // ETag 前缀：版本号每次启动从 0 开始，加上启动时间避免重启后把旧的 ETag 当成有效
+    std::string etag_epoch;
+
     Impl() {
         audio_engine = std::make_unique<AudioEngine>();
         playlist_manager = std::make_unique<PlaylistManager>();
         // db_manager 使用单例模式，不需要手动创建
+        registerRoutes();
+
+        char epoch[24];
+        auto now = std::chrono::system_clock::now().time_since_epoch();
+        std::snprintf(epoch, sizeof(epoch), "%llx", static_cast<unsigned long long>(
+                          std::chrono::duration_cast<std::chrono::microseconds>(now).count()));
+        etag_epoch = epoch;
+
+        audio_engine->onPlayStateChanged([this](PlayState state) {
+            std::string json = "{\"state\":\"";
+            json += playStateName(state);
+            json += "\"}";
+            publishEvent("state", std::move(json), false);
+        });
+        audio_engine->onPositionChanged([this](int position) {
+            publishEvent("position", "{\"position\":" + std::to_string(position) + "}", true);
+        });
+        audio_engine->onTrackEnded([this] {
+            publishEvent("trackEnded", "{}", false);
+        });
+        // 提供者在引擎的解码线程上调用，事件回调在引擎的事件分发线程上调用，都不持有引擎的锁
+        audio_engine->setNextTrackProvider([this](std::string& filePath) {
+            return nextPlaylistTrack(filePath);
+        });
+        audio_engine->onTrackChanged([this](const std::string& filePath) {
+            std::string json;
+            {
+                std::lock_guard<std::mutex> lock(state_mutex);
+                if (pending_index < 0 || pending_track.url != filePath) {
+                    return;
+                }
+                // 预取之后播放列表可能被修改过，索引仍指向同一首时才跟着前进
+                if (playlist_manager->getTrackAt(pending_index).id == pending_track.id) {
+                    playlist_manager->setCurrentTrackIndex(pending_index);
+                }
+                pending_index = -1;
+                setCurrentTrack(pending_track);
+                appendJson(json, current_track);
+            }
+            publishEvent("trackChanged", std::move(json), false);
+        });
+        // 在修改播放列表的处理函数中触发（持有 state_mutex），批量操作只触发一次
+        playlist_manager->onPlaylistChanged([this](const Playlist& playlist) {
+            std::string json = "{\"version\":";
+            json += std::to_string(playlist_manager->getVersion());
+            json += ",\"trackCount\":";
+            json += std::to_string(playlist.tracks.size());
+            json += "}";
+            publishEvent("playlistChanged", std::move(json), false);
+        });
+    }
+
+    ~Impl() {
+        // 分析线程结束前要拿 loudness_mutex，在锁外等待；
+        // 取消在锁内进行，一定晚于排队时的 reset()，不会被清除
+        std::thread analysis;
+        {
+            std::lock_guard<std::mutex> lock(loudness_mutex);
+            loudness_stopping = true;
+            loudness_analyzer.cancel();
+            analysis = std::move(loudness_thread);
+        }
+        if (analysis.joinable()) {
+            analysis.join();
+        }
+        // 先停掉引擎的播放线程，它的回调引用了下面的成员
+        audio_engine.reset();
+    }
+
+    /**
+     * 把事件推送给所有 Reactor 上的 /api/events 订阅者
+     * @param coalesce 高频事件：每个连接只保留最新一条并限速发送
+     */
+    void publishEvent(const char* name, std::string json, bool coalesce) {
+        auto event = std::make_shared<ServerEvent>();
+        event->name = name;
+        event->data = std::move(json);
+        event->coalesce = coalesce;
+
+        std::lock_guard<std::mutex> lock(publish_mutex);
+        if (!publishing) {
+            return;
+        }
+        for (auto& reactor : reactors) {
+            reactor->publish(event);
+        }
+    }
+
+    void runServer(size_t index) {
+#if defined(__linux__)
+        if (options.pinThreads) {
+            unsigned cores = std::max(1u, std::thread::hardware_concurrency());
+            cpu_set_t cpus;
+            CPU_ZERO(&cpus);
+            CPU_SET(index % cores, &cpus);
+            pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus);
+        }
+#endif
+        reactors[index]->run();
+    }
+
+    // ===== 路由 =====
+
+    using Handler = void (Impl::*)(HttpRequest&, HttpResponse&);
+
+    void route(const char* method, const char* pattern, Handler handler) {
+        router.add(method, pattern, [this, handler](HttpRequest& req, HttpResponse& res) {
+            (this->*handler)(req, res);
+        });
+    }
+
+    void registerRoutes() {
+        route("POST", "/api/player/load", &Impl::handlePlayerLoad);
+        route("POST", "/api/player/play", &Impl::handlePlayerPlay);
+        route("POST", "/api/player/pause", &Impl::handlePlayerPause);
+        route("POST", "/api/player/stop", &Impl::handlePlayerStop);
+        route("POST", "/api/player/seek", &Impl::handlePlayerSeek);
+        route("POST", "/api/player/volume", &Impl::handlePlayerVolume);
+        route("POST", "/api/player/crossfade", &Impl::handlePlayerCrossfade);
+        route("GET", "/api/player/eq", &Impl::handlePlayerEqGet);
+        route("POST", "/api/player/eq", &Impl::handlePlayerEq);
+        route("GET", "/api/player/normalization", &Impl::handlePlayerNormalizationGet);
+        route("POST", "/api/player/normalization", &Impl::handlePlayerNormalization);
+        route("GET", "/api/player/status", &Impl::handlePlayerStatus);
+        route("GET", "/api/stream/{trackId}", &Impl::handleStream);
+
+        route("GET", "/api/playlist", &Impl::handlePlaylistGet);
+        route("POST", "/api/playlist/add", &Impl::handlePlaylistAdd);
+        route("POST", "/api/playlist/clear", &Impl::handlePlaylistClear);
+        route("GET", "/api/playlist/next", &Impl::handlePlaylistNext);
+        route("GET", "/api/playlist/prev", &Impl::handlePlaylistPrev);
+        route("POST", "/api/playlist/mode", &Impl::handlePlaylistMode);
+        route("DELETE", "/api/playlist/{index}", &Impl::handlePlaylistRemove);
+
+        route("POST", "/api/loudness/analyze", &Impl::handleLoudnessAnalyze);
+        route("GET", "/api/loudness/status", &Impl::handleLoudnessStatus);
+
+        route("GET", "/api/track/{id}/waveform", &Impl::handleTrackWaveform);
+
+        route("GET", "/api/search", &Impl::handleSearch);
+        route("GET", "/api/plugins", &Impl::handlePlugins);
+
+        route("GET", "/api/favorites", &Impl::handleFavoritesGet);
+        route("POST", "/api/favorites", &Impl::handleFavoritesAdd);
+        route("DELETE", "/api/favorites/{id}", &Impl::handleFavoritesRemove);
+        route("GET", "/api/history", &Impl::handleHistoryGet);
+        route("DELETE", "/api/history", &Impl::handleHistoryClear);
+
+        route("POST", "/api/batch", &Impl::handleBatch);
+
+        route("GET", "/api/events", &Impl::handleEvents);
+
+        route("GET", "/api/health", &Impl::handleHealth);
+        route("GET", "/api/server/stats", &Impl::handleServerStats);
+        route("GET", "/api/metrics", &Impl::handleMetrics);
+    }
+
+    // ===== 辅助函数 =====
+
+    static bool parseBody(const HttpRequest& req, HttpResponse& res, JsonValue& body) {
+        if (!parseJson(req.body, body) || !body.isObject()) {
+            res.setError(400, "Request body must be a JSON object");
+            return false;
+        }
+        return true;
+    }
+
+    /**
+     * 解析轨道请求体：单个 Track 对象，或 Track 数组（批量）
+     * 直接在请求缓冲区上做结构扫描，不构造 JSON DOM（见 track_parser.h）
+     * @param isArray 输出：请求体是否为数组
+     */
+    static bool parseTrackBody(HttpRequest& req, HttpResponse& res, std::vector<Track>& tracks, bool& isArray) {
+        thread_local TrackParser parser;
+        std::vector<TrackView> views;
+        if (!parser.parse(req.body, views, isArray)) {
+            res.setError(400, parser.error());
+            return false;
+        }
+
+        tracks.reserve(views.size());
+        for (size_t i = 0; i < views.size(); ++i) {
+            if (!views[i].valid) {
+                res.setError(400, isArray ? "Invalid track at index " + std::to_string(i) : "Invalid track");
+                return false;
+            }
+            tracks.push_back(views[i].toTrack());
+        }
+        return true;
+    }
+
+    void respondStatus(HttpResponse& res) {
+        res.setJson(200, statusJson());
+    }
+
+    ipc::PlayerStatus playerStatus() {
+        std::lock_guard<std::mutex> lock(state_mutex);
+        return playerStatusLocked();
+    }
+
+    /**
+     * 获取播放器状态，调用方需持有 state_mutex
+     */
+    ipc::PlayerStatus playerStatusLocked() {
+        ipc::PlayerStatus status;
+        status.hasTrack = has_current_track;
+        if (status.hasTrack) {
+            status.currentTrack = current_track;
+        }
+        status.state = audio_engine->getState();
+        status.position = audio_engine->getPosition();
+        status.volume = audio_engine->getVolume();
+        status.duration = audio_engine->getAudioInfo().duration;
+        return status;
+    }
+
+    std::string statusJson() {
+        return statusJson(playerStatus());
+    }
+
+    static std::string statusJson(const ipc::PlayerStatus& status) {
+        std::string json = "{\"state\":\"";
+        json += playStateName(status.state);
+        json += "\",\"position\":";
+        json += std::to_string(status.position);
+        json += ",\"volume\":";
+        json += std::to_string(status.volume);
+        json += ",\"duration\":";
+        json += std::to_string(status.duration);
+        if (status.hasTrack) {
+            json += ",\"currentTrack\":";
+            appendJson(json, status.currentTrack);
+        }
+        json += "}";
+        return json;
+    }
+
+    std::string makeETag(char kind, uint64_t version) const {
+        std::string etag = "\"";
+        etag += etag_epoch;
+        etag.push_back('-');
+        etag.push_back(kind);
+        etag += std::to_string(version);
+        etag.push_back('"');
+        return etag;
+    }
+
+    /**
+     * 取缓存的响应体，版本（或条数）不一致时重新序列化并替换缓存
+     * @param version 数据版本，必须在读取数据之前取得：这样缓存内容只可能比版本新，
+     *                客户端拿着旧 ETag 重新验证时会得到完整应答，而不会误得 304
+     * @param serialize 序列化当前数据，只在未命中时调用
+     */
+    template <typename Serialize>
+    std::shared_ptr<const std::string> cachedBody(CachedBody& cache, uint64_t version, int limit,
+                                                  Serialize&& serialize) {
+        {
+            std::lock_guard<std::mutex> lock(cache.mutex);
+            if (cache.body && cache.version == version && cache.limit == limit) {
+                return cache.body;
+            }
+        }
+
+        auto json = std::make_shared<std::string>();
+        {
+            JsonWriter writer(*json);
+            serialize(writer);
+            writer.finish();
+        }
+
+        std::lock_guard<std::mutex> lock(cache.mutex);
+        // 多个线程同时未命中时保留版本较新的一份
+        if (!cache.body || version >= cache.version) {
+            cache.version = version;
+            cache.limit = limit;
+            cache.body = json;
+        }
+        return json;
+    }
+
+    /**
+     * 应答当前播放列表，调用方需持有 state_mutex
+     * 序列化结果按播放列表版本缓存，内容不变时重复请求只复制缓存
+     */
+    void respondPlaylist(HttpResponse& res) {
+        res.setSharedBody(200, cachedBody(playlist_cache, playlist_manager->getVersion(), -1,
+                                          [this](JsonWriter& writer) {
+            const Playlist& playlist = playlist_manager->viewCurrentPlaylist();
+            writer.reserve(estimateJsonSize(playlist.tracks) + 128);
+            writeJson(writer, playlist);
+        }));
+    }
+
+    void respondFavorites(HttpResponse& res, uint64_t version) {
+        res.setSharedBody(200, cachedBody(favorites_cache, version, -1, [](JsonWriter& writer) {
+            std::vector<Track> favorites = DatabaseManager::getInstance().getFavorites();
+            writer.reserve(estimateJsonSize(favorites));
+            writeJson(writer, favorites);
+        }));
+    }
+
+    void respondTracks(HttpResponse& res, std::vector<Track> tracks) {
+        res.setJsonWriter(200, [tracks = std::move(tracks)](JsonWriter& writer) {
+            writer.reserve(estimateJsonSize(tracks));
+            writeJson(writer, tracks);
+        });
+    }
+
+    void respondTrack(HttpResponse& res, const Track& track) {
+        std::string json;
+        appendJson(json, track);
+        res.setJson(200, std::move(json));
+    }
+
+    static Track makeLocalTrack(const std::string& filePath) {
+        Track track;
+        track.id = makeLocalTrackId(filePath);
+        track.url = filePath;
+        track.source = "local";
+        return track;
+    }
+
+    /**
+     * 把轨道加载到音频引擎，并记录到播放历史
+     * 轨道中缺少的元数据由引擎读取到的音频信息补全；调用方需持有 state_mutex
+     */
+    bool loadTrack(const Track& track) {
+        if (!audio_engine->load(track.url)) {
+            return false;
+        }
+        setCurrentTrack(track);
+        return true;
+    }
+
+    /**
+     * 记录引擎已经加载的轨道，调用方需持有 state_mutex
+     */
+    void setCurrentTrack(const Track& track) {
+        AudioInfo info = audio_engine->getAudioInfo();
+        current_track = track;
+        if (current_track.title.empty()) current_track.title = info.title;
+        if (current_track.artist.empty()) current_track.artist = info.artist;
+        if (current_track.album.empty()) current_track.album = info.album;
+        if (current_track.duration <= 0) current_track.duration = info.duration;
+        has_current_track = true;
+
+        // 只有真正识别为音频的文件才能通过 /api/stream 读取，占位的任意文件不登记
+        if (isLocalPath(track.url) && !current_track.id.empty() && !info.placeholder) {
+            local_files[current_track.id] = track.url;
+        }
+
+        DatabaseManager::getInstance().addToHistory(current_track);
+    }
+
+    /**
+     * 引擎的下一首提供者：当前轨道来自播放列表时，按播放模式给出自然播完后的下一首
+     * @param filePath 输出下一首的地址
+     * @return 没有下一首返回 false
+     */
+    bool nextPlaylistTrack(std::string& filePath) {
+        std::lock_guard<std::mutex> lock(state_mutex);
+        int current = playlist_manager->getCurrentTrackIndex();
+        if (!has_current_track || current < 0 || playlist_manager->getTrackAt(current).id != current_track.id) {
+            return false;
+        }
+
+        int index = playlist_manager->peekNextTrackIndex();
+        if (index < 0) {
+            return false;
+        }
+        Track track = playlist_manager->getTrackAt(index);
+        if (track.url.empty()) {
+            return false;
+        }
+        pending_track = track;
+        pending_index = index;
+        filePath = track.url;
+        return true;
+    }
+
+    // ===== 音乐播放 =====
+
+    void handlePlayerLoad(HttpRequest& req, HttpResponse& res) {
+        JsonValue body;
+        if (!parseBody(req, res, body)) {
+            return;
+        }
+
+        std::string filePath = body.getString("filePath");
+        if (filePath.empty()) {
+            res.setError(400, "Missing filePath");
+            return;
+        }
+
+        std::lock_guard<std::mutex> lock(state_mutex);
+        if (!loadTrack(makeLocalTrack(filePath))) {
+            res.setError(400, "Failed to load: " + filePath);
+            return;
+        }
+        respondTrack(res, current_track);
+    }
+
+    void handlePlayerPlay(HttpRequest&, HttpResponse& res) {
+        if (!audio_engine->play()) {
+            res.setError(409, "No track loaded");
+            return;
+        }
+        respondStatus(res);
+    }
+
+    void handlePlayerPause(HttpRequest&, HttpResponse& res) {
+        if (!audio_engine->pause()) {
+            res.setError(409, "Player is not playing");
+            return;
+        }
+        respondStatus(res);
+    }
+
+    void handlePlayerStop(HttpRequest&, HttpResponse& res) {
+        audio_engine->stop();
+        respondStatus(res);
+    }
+
+    void handlePlayerSeek(HttpRequest& req, HttpResponse& res) {
+        JsonValue body;
+        if (!parseBody(req, res, body)) {
+            return;
+        }
+
+        int position = 0;
+        if (!readInt(body, "position", position) || !audio_engine->seek(position)) {
+            res.setError(400, "Invalid position");
+            return;
+        }
+        respondStatus(res);
+    }
+
+    void handlePlayerVolume(HttpRequest& req, HttpResponse& res) {
+        JsonValue body;
+        if (!parseBody(req, res, body)) {
+            return;
+        }
+
+        int volume = 0;
+        if (!readInt(body, "volume", volume) || !audio_engine->setVolume(volume)) {
+            res.setError(400, "Volume must be between 0 and 100");
+            return;
+        }
+        respondStatus(res);
+    }
+
+    void handlePlayerCrossfade(HttpRequest& req, HttpResponse& res) {
+        JsonValue body;
+        if (!parseBody(req, res, body)) {
+            return;
+        }
+
+        int duration = 0;
+        if (!readInt(body, "duration", duration)) {
+            res.setError(400, "Missing duration");
+            return;
+        }
+        CrossfadeCurve curve = CrossfadeCurve::EQUAL_POWER;
+        std::string curveName = body.getString("curve");
+        if (curveName == "linear") {
+            curve = CrossfadeCurve::LINEAR;
+        } else if (!curveName.empty() && curveName != "equalPower") {
+            res.setError(400, "Curve must be linear or equalPower");
+            return;
+        }
+        if (!audio_engine->setCrossfade(duration, curve)) {
+            res.setError(400, "Duration must be between 0 and 12000");
+            return;
+        }
+        res.setJson(200, "{\"duration\":" + std::to_string(duration) + ",\"curve\":\"" +
+                             (curve == CrossfadeCurve::LINEAR ? "linear" : "equalPower") + "\"}");
+    }
+
+    void handlePlayerEqGet(HttpRequest&, HttpResponse& res) {
+        res.setJson(200, equalizerJson(audio_engine->getEqualizer()));
+    }
+
+    void handlePlayerEq(HttpRequest& req, HttpResponse& res) {
+        JsonValue body;
+        if (!parseBody(req, res, body)) {
+            return;
+        }
+
+        EqualizerSettings settings = audio_engine->getEqualizer();
+        std::string error;
+        if (!readEqualizer(body, settings, error)) {
+            res.setError(400, error);
+            return;
+        }
+        if (!audio_engine->setEqualizer(settings)) {
+            res.setError(400, "Equalizer settings out of range");
+            return;
+        }
+        res.setJson(200, equalizerJson(settings));
+    }
+
+    static const char* normalizationModeName(NormalizationMode mode) {
+        switch (mode) {
+            case NormalizationMode::OFF: return "off";
+            case NormalizationMode::TRACK: return "track";
+            case NormalizationMode::ALBUM: return "album";
+        }
+        return "off";
+    }
+
+    std::string normalizationJson() const {
+        double target = 0;
+        NormalizationMode mode = audio_engine->getNormalization(target);
+        std::string json = "{\"mode\":\"";
+        json += normalizationModeName(mode);
+        json += "\",\"target\":" + formatNumber(target) + "}";
+        return json;
+    }
+
+    void handlePlayerNormalizationGet(HttpRequest&, HttpResponse& res) {
+        res.setJson(200, normalizationJson());
+    }
+
+    void handlePlayerNormalization(HttpRequest& req, HttpResponse& res) {
+        JsonValue body;
+        if (!parseBody(req, res, body)) {
+            return;
+        }
+
+        // 省略的字段保持不变
+        double target = 0;
+        NormalizationMode mode = audio_engine->getNormalization(target);
+        const JsonValue* modeField = body.find("mode");
+        if (modeField != nullptr) {
+            static const NormalizationMode kModes[] = {NormalizationMode::OFF, NormalizationMode::TRACK,
+                                                       NormalizationMode::ALBUM};
+            std::string name = modeField->type == JsonValue::Type::STRING ? modeField->string : "";
+            auto it = std::find_if(std::begin(kModes), std::end(kModes),
+                                   [&](NormalizationMode candidate) { return name == normalizationModeName(candidate); });
+            if (it == std::end(kModes)) {
+                res.setError(400, "Mode must be off, track or album");
+                return;
+            }
+            mode = *it;
+        }
+        const JsonValue* targetField = body.find("target");
+        if (targetField != nullptr) {
+            if (targetField->type != JsonValue::Type::NUMBER) {
+                res.setError(400, "target must be a number");
+                return;
+            }
+            target = targetField->number;
+        }
+        if (!audio_engine->setNormalization(mode, target)) {
+            res.setError(400, "Target must be between -30 and -5 LUFS");
+            return;
+        }
+        res.setJson(200, normalizationJson());
+    }
+
+    static const char* eqBandTypeName(EqBandType type) {
+        switch (type) {
+            case EqBandType::PEAKING: return "peaking";
+            case EqBandType::LOW_SHELF: return "lowShelf";
+            case EqBandType::HIGH_SHELF: return "highShelf";
+            case EqBandType::LOW_PASS: return "lowPass";
+            case EqBandType::HIGH_PASS: return "highPass";
+        }
+        return "peaking";
+    }
+
+    static bool parseEqBandType(const std::string& name, EqBandType& type) {
+        static const EqBandType kTypes[] = {EqBandType::PEAKING, EqBandType::LOW_SHELF, EqBandType::HIGH_SHELF,
+                                            EqBandType::LOW_PASS, EqBandType::HIGH_PASS};
+        for (EqBandType candidate : kTypes) {
+            if (name == eqBandTypeName(candidate)) {
+                type = candidate;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    static std::string formatNumber(double value) {
+        char buffer[32];
+        std::snprintf(buffer, sizeof(buffer), "%.6g", value);
+        return buffer;
+    }
+
+    static std::string equalizerJson(const EqualizerSettings& settings) {
+        std::string json = "{\"enabled\":";
+        json += settings.enabled ? "true" : "false";
+        json += ",\"preamp\":" + formatNumber(settings.preampDb);
+        json += ",\"bands\":[";
+        for (size_t i = 0; i < settings.bands.size(); ++i) {
+            const EqBand& band = settings.bands[i];
+            json += i == 0 ? "{" : ",{";
+            json += "\"type\":\"";
+            json += eqBandTypeName(band.type);
+            json += "\",\"frequency\":" + formatNumber(band.frequency);
+            json += ",\"gain\":" + formatNumber(band.gainDb);
+            json += ",\"q\":" + formatNumber(band.q) + "}";
+        }
+        json += "],\"limiter\":";
+        json += settings.limiter ? "true" : "false";
+        json += ",\"limiterThreshold\":" + formatNumber(settings.limiterThresholdDb);
+        json += ",\"limiterRelease\":" + formatNumber(settings.limiterReleaseMs) + "}";
+        return json;
+    }
+
+    /**
+     * 把请求体中出现的字段合并进 settings；范围由 AudioEngine::setEqualizer 检查
+     * @param error 失败时输出错误信息
+     */
+    static bool readEqualizer(const JsonValue& body, EqualizerSettings& settings, std::string& error) {
+        auto readBool = [&](const char* name, bool& value) {
+            const JsonValue* field = body.find(name);
+            if (field == nullptr) {
+                return true;
+            }
+            if (field->type != JsonValue::Type::BOOLEAN) {
+                error = std::string(name) + " must be a boolean";
+                return false;
+            }
+            value = field->boolean;
+            return true;
+        };
+        auto readNumber = [&](const JsonValue& object, const char* name, double& value) {
+            const JsonValue* field = object.find(name);
+            if (field == nullptr) {
+                return true;
+            }
+            if (field->type != JsonValue::Type::NUMBER) {
+                error = std::string(name) + " must be a number";
+                return false;
+            }
+            value = field->number;
+            return true;
+        };
+
+        if (!readBool("enabled", settings.enabled) || !readNumber(body, "preamp", settings.preampDb) ||
+            !readBool("limiter", settings.limiter) ||
+            !readNumber(body, "limiterThreshold", settings.limiterThresholdDb) ||
+            !readNumber(body, "limiterRelease", settings.limiterReleaseMs)) {
+            return false;
+        }
+
+        const JsonValue* bands = body.find("bands");
+        if (bands == nullptr) {
+            return true;
+        }
+        if (!bands->isArray() || bands->array.size() > kMaxEqBands) {
+            error = "bands must be an array of at most " + std::to_string(kMaxEqBands) + " bands";
+            return false;
+        }
+        settings.bands.clear();
+        for (const JsonValue& item : bands->array) {
+            EqBand band;
+            std::string type = item.isObject() ? item.getString("type", "peaking") : "";
+            if (!item.isObject() || !parseEqBandType(type, band.type)) {
+                error = "Band type must be peaking, lowShelf, highShelf, lowPass or highPass";
+                return false;
+            }
+            if (!readNumber(item, "frequency", band.frequency) || !readNumber(item, "gain", band.gainDb) ||
+                !readNumber(item, "q", band.q)) {
+                return false;
+            }
+            settings.bands.push_back(band);
+        }
+        return true;
+    }
+
+    void handlePlayerStatus(HttpRequest&, HttpResponse& res) {
+        respondStatus(res);
     }
 
-    void runServer() {
-        // TODO: 实现真实的 HTTP 服务器
-        // 可以使用库如：Crow、Beast (Asio)、cpp-httplib 等
-        
-        std::cout << "API Server started on port " << port << std::endl;
-        std::cout << "Base URL: http://127.0.0.1:" << port << std::endl;
-        
-        running = true;
-        
-        // 示例：等待停止信号
-        while (running) {
-            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    void handleStream(HttpRequest& req, HttpResponse& res) {
+        // 音频元素播放跨域媒体不需要 CORS，不让其他网页的脚本读取文件内容
+        res.crossOrigin = false;
+        std::string filePath;
+        {
+            std::lock_guard<std::mutex> lock(state_mutex);
+            auto it = local_files.find(req.pathParam("trackId"));
+            if (it == local_files.end()) {
+                res.setError(404, "Track not found");
+                return;
+            }
+            filePath = it->second;
         }
+
+        const char* contentType = audioContentType(filePath);
+        if (contentType == nullptr) {
+            res.setError(403, "Not an audio file");
+            return;
+        }
+        // 文件内容由 Reactor 在报文头之后用 sendfile 发送
+        setFileResponse(req, res, filePath, contentType);
+    }
+
+    // ===== 播放列表 =====
+
+    void handlePlaylistGet(HttpRequest& req, HttpResponse& res) {
+        std::lock_guard<std::mutex> lock(state_mutex);
+        if (checkNotModified(req, res, makeETag('p', playlist_manager->getVersion()))) {
+            return;
+        }
+        respondPlaylist(res);
+    }
+
+    void handlePlaylistAdd(HttpRequest& req, HttpResponse& res) {
+        std::vector<Track> tracks;
+        bool isArray = false;
+        if (!parseTrackBody(req, res, tracks, isArray)) {
+            return;
+        }
+
+        std::lock_guard<std::mutex> lock(state_mutex);
+        if (isArray) {
+            playlist_manager->addTracks(tracks);
+        } else {
+            playlist_manager->addTrack(tracks.front());
+        }
+        respondPlaylist(res);
+    }
+
+    void handlePlaylistClear(HttpRequest&, HttpResponse& res) {
+        std::lock_guard<std::mutex> lock(state_mutex);
+        playlist_manager->clear();
+        respondPlaylist(res);
+    }
+
+    void handlePlaylistMode(HttpRequest& req, HttpResponse& res) {
+        JsonValue body;
+        if (!parseBody(req, res, body)) {
+            return;
+        }
+
+        PlayMode mode = PlayMode::ORDER;
+        if (!parsePlayMode(body.getString("mode"), mode)) {
+            res.setError(400, "Mode must be order, repeatAll, repeatOne or shuffle");
+            return;
+        }
+
+        std::lock_guard<std::mutex> lock(state_mutex);
+        playlist_manager->setPlayMode(mode);
+        res.setJson(200, std::string("{\"mode\":\"") + playModeName(mode) + "\"}");
+    }
+
+    void handlePlaylistRemove(HttpRequest& req, HttpResponse& res) {
+        int index = -1;
+        if (!parseInt(req.pathParam("index"), index)) {
+            res.setError(400, "Invalid index");
+            return;
+        }
+
+        std::lock_guard<std::mutex> lock(state_mutex);
+        if (index < 0 || index >= playlist_manager->getTrackCount()) {
+            res.setError(404, "Track index out of range");
+            return;
+        }
+
+        playlist_manager->removeTrack(index);
+        respondPlaylist(res);
+    }
+
+    void handlePlaylistNext(HttpRequest&, HttpResponse& res) {
+        std::lock_guard<std::mutex> lock(state_mutex);
+        if (!playlist_manager->playNext()) {
+            res.setError(404, "No next track");
+            return;
+        }
+        respondPlaylistStep(res);
+    }
+
+    void handlePlaylistPrev(HttpRequest&, HttpResponse& res) {
+        std::lock_guard<std::mutex> lock(state_mutex);
+        if (!playlist_manager->playPrevious()) {
+            res.setError(404, "No previous track");
+            return;
+        }
+        respondPlaylistStep(res);
+    }
+
+    void respondPlaylistStep(HttpResponse& res) {
+        Track track = playlist_manager->getTrackAt(playlist_manager->getCurrentTrackIndex());
+        if (!loadTrack(track)) {
+            res.setError(500, "Failed to load: " + track.url);
+            return;
+        }
+        respondTrack(res, current_track);
+    }
+
+    // ===== 搜索和发现 =====
+
+    void handleSearch(HttpRequest& req, HttpResponse& res) {
+        std::string query = req.queryParam("q");
+        if (query.empty()) {
+            res.setError(400, "Missing query parameter q");
+            return;
+        }
+
+        int limit = 20;
+        if (!parseInt(req.queryParam("limit", "20"), limit) || limit <= 0) {
+            res.setError(400, "Invalid limit");
+            return;
+        }
+
+        std::vector<Track> results = PluginManager::getInstance().searchMusic(query);
+        if (results.size() > static_cast<size_t>(limit)) {
+            results.resize(limit);
+        }
+        respondTracks(res, results);
+    }
+
+    void handlePlugins(HttpRequest&, HttpResponse& res) {
+        std::string json = "[";
+        for (const auto& name : PluginManager::getInstance().getLoadedPlugins()) {
+            if (json.size() > 1) {
+                json.push_back(',');
+            }
+            appendJsonString(json, name);
+        }
+        json += "]";
+        res.setJson(200, std::move(json));
+    }
+
+    // ===== 用户数据 =====
+
+    void handleFavoritesGet(HttpRequest& req, HttpResponse& res) {
+        uint64_t version = DatabaseManager::getInstance().getFavoritesVersion();
+        if (checkNotModified(req, res, makeETag('f', version))) {
+            return;
+        }
+        respondFavorites(res, version);
+    }
+
+    void handleFavoritesAdd(HttpRequest& req, HttpResponse& res) {
+        std::vector<Track> tracks;
+        bool isArray = false;
+        if (!parseTrackBody(req, res, tracks, isArray)) {
+            return;
+        }
+
+        if (isArray) {
+            DatabaseManager::getInstance().addToFavorites(tracks);
+        } else if (!DatabaseManager::getInstance().addToFavorite(tracks.front())) {
+            res.setError(409, "Already in favorites");
+            return;
+        }
+        respondFavorites(res, DatabaseManager::getInstance().getFavoritesVersion());
+    }
+
+    void handleFavoritesRemove(HttpRequest& req, HttpResponse& res) {
+        if (!DatabaseManager::getInstance().removeFromFavorite(req.pathParam("id"))) {
+            res.setError(404, "Not in favorites");
+            return;
+        }
+        respondFavorites(res, DatabaseManager::getInstance().getFavoritesVersion());
+    }
+
+    void handleHistoryGet(HttpRequest& req, HttpResponse& res) {
+        int limit = 100;
+        if (!parseInt(req.queryParam("limit", "100"), limit) || limit < 0) {
+            res.setError(400, "Invalid limit");
+            return;
+        }
+
+        uint64_t version = DatabaseManager::getInstance().getHistoryVersion();
+        if (checkNotModified(req, res, makeETag('h', version))) {
+            return;
+        }
+        res.setSharedBody(200, cachedBody(history_cache, version, limit, [limit](JsonWriter& writer) {
+            std::vector<Track> history = DatabaseManager::getInstance().getHistory(limit);
+            writer.reserve(estimateJsonSize(history));
+            writeJson(writer, history);
+        }));
+    }
+
+    void handleHistoryClear(HttpRequest&, HttpResponse& res) {
+        DatabaseManager::getInstance().clearHistory();
+        res.status = 204;
+        res.contentType.clear();
+    }
+
+    // ===== 批量操作 =====
+
+    /**
+     * 批量操作名称与 IPC 操作码一一对应，名称取自对应的 HTTP 路径
+     */
+    static bool batchOpcode(const std::string& name, ipc::Opcode& opcode) {
+        static const std::pair<const char*, ipc::Opcode> kOps[] = {
+            {"player/load", ipc::Opcode::PLAYER_LOAD},
+            {"player/play", ipc::Opcode::PLAYER_PLAY},
+            {"player/pause", ipc::Opcode::PLAYER_PAUSE},
+            {"player/stop", ipc::Opcode::PLAYER_STOP},
+            {"player/seek", ipc::Opcode::PLAYER_SEEK},
+            {"player/volume", ipc::Opcode::PLAYER_VOLUME},
+            {"player/status", ipc::Opcode::PLAYER_STATUS},
+            {"playlist/add", ipc::Opcode::PLAYLIST_ADD},
+            {"playlist/remove", ipc::Opcode::PLAYLIST_REMOVE},
+            {"playlist/clear", ipc::Opcode::PLAYLIST_CLEAR},
+            {"playlist/next", ipc::Opcode::PLAYLIST_NEXT},
+            {"playlist/prev", ipc::Opcode::PLAYLIST_PREV},
+        };
+        for (const auto& op : kOps) {
+            if (name == op.first) {
+                opcode = op.second;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /**
+     * 批量期间推迟播放列表变化回调，结束时（包括异常退出）最多触发一次
+     */
+    class PlaylistBatch {
+    public:
+        explicit PlaylistBatch(PlaylistManager& manager) : manager_(manager) { manager_.beginBatch(); }
+        ~PlaylistBatch() { manager_.endBatch(); }
+
+        PlaylistBatch(const PlaylistBatch&) = delete;
+        PlaylistBatch& operator=(const PlaylistBatch&) = delete;
+
+    private:
+        PlaylistManager& manager_;
+    };
+
+    static bool batchError(JsonWriter& writer, int status, const std::string& message) {
+        writer.key("status");
+        writer.value(status);
+        writer.key("message");
+        writer.value(message);
+        return false;
+    }
+
+    /**
+     * 读取整数字段：先把客户端给出的数值限制在 int 范围内再转换（超出范围的转换是未定义行为）
+     * @return 字段存在且为有限的数值时返回 true
+     */
+    static bool readInt(const JsonValue& op, const char* name, int& value) {
+        const JsonValue* field = op.find(name);
+        if (field == nullptr || field->type != JsonValue::Type::NUMBER || !std::isfinite(field->number)) {
+            return false;
+        }
+        value = static_cast<int>(std::max<double>(std::min<double>(field->number, std::numeric_limits<int>::max()),
+                                                  std::numeric_limits<int>::min()));
+        return true;
+    }
+
+    /**
+     * 执行一个批量操作并写入结果对象的字段，调用方需持有 state_mutex
+     * 参数与对应的 HTTP 接口相同；playlist/add 接受 track（单个）或 tracks（数组）
+     * @return 成功返回 true
+     */
+    bool runBatchOp(ipc::Opcode opcode, const JsonValue& op, JsonWriter& writer) {
+        switch (opcode) {
+            case ipc::Opcode::PLAYER_LOAD: {
+                std::string filePath = op.getString("filePath");
+                if (filePath.empty()) {
+                    return batchError(writer, 400, "Missing filePath");
+                }
+                if (!loadTrack(makeLocalTrack(filePath))) {
+                    return batchError(writer, 400, "Failed to load: " + filePath);
+                }
+                break;
+            }
+            case ipc::Opcode::PLAYER_PLAY:
+                if (!audio_engine->play()) {
+                    return batchError(writer, 409, "No track loaded");
+                }
+                break;
+            case ipc::Opcode::PLAYER_PAUSE:
+                if (!audio_engine->pause()) {
+                    return batchError(writer, 409, "Player is not playing");
+                }
+                break;
+            case ipc::Opcode::PLAYER_STOP:
+                audio_engine->stop();
+                break;
+            case ipc::Opcode::PLAYER_SEEK: {
+                int position = 0;
+                if (!readInt(op, "position", position) || !audio_engine->seek(position)) {
+                    return batchError(writer, 400, "Invalid position");
+                }
+                break;
+            }
+            case ipc::Opcode::PLAYER_VOLUME: {
+                int volume = 0;
+                if (!readInt(op, "volume", volume) || !audio_engine->setVolume(volume)) {
+                    return batchError(writer, 400, "Volume must be between 0 and 100");
+                }
+                break;
+            }
+            case ipc::Opcode::PLAYER_STATUS:
+                break;
+
+            case ipc::Opcode::PLAYLIST_ADD: {
+                std::vector<Track> tracks;
+                const JsonValue* list = op.find("tracks");
+                const JsonValue* single = op.find("track");
+                if (list != nullptr && list->isArray()) {
+                    tracks.resize(list->array.size());
+                    for (size_t i = 0; i < tracks.size(); ++i) {
+                        if (!jsonToTrack(list->array[i], tracks[i])) {
+                            return batchError(writer, 400, "Invalid track at index " + std::to_string(i));
+                        }
+                    }
+                } else if (single != nullptr) {
+                    tracks.emplace_back();
+                    if (!jsonToTrack(*single, tracks.back())) {
+                        return batchError(writer, 400, "Invalid track");
+                    }
+                } else {
+                    return batchError(writer, 400, "Missing track");
+                }
+                playlist_manager->addTracks(tracks);
+                break;
+            }
+            case ipc::Opcode::PLAYLIST_REMOVE: {
+                int index = -1;
+                if (!readInt(op, "index", index)) {
+                    return batchError(writer, 400, "Invalid index");
+                }
+                if (index < 0 || index >= playlist_manager->getTrackCount()) {
+                    return batchError(writer, 404, "Track index out of range");
+                }
+                playlist_manager->removeTrack(index);
+                break;
+            }
+            case ipc::Opcode::PLAYLIST_CLEAR:
+                playlist_manager->clear();
+                break;
+            case ipc::Opcode::PLAYLIST_NEXT:
+            case ipc::Opcode::PLAYLIST_PREV: {
+                bool next = opcode == ipc::Opcode::PLAYLIST_NEXT;
+                if (next ? !playlist_manager->playNext() : !playlist_manager->playPrevious()) {
+                    return batchError(writer, 404, next ? "No next track" : "No previous track");
+                }
+                Track track = playlist_manager->getTrackAt(playlist_manager->getCurrentTrackIndex());
+                if (!loadTrack(track)) {
+                    return batchError(writer, 500, "Failed to load: " + track.url);
+                }
+                break;
+            }
+            default:
+                return batchError(writer, 404, "Unknown operation");
+        }
+
+        writer.key("status");
+        writer.value(200);
+        // 加载了新轨道的操作附带轨道信息，播放列表操作附带轨道数
+        if (opcode == ipc::Opcode::PLAYER_LOAD || opcode == ipc::Opcode::PLAYLIST_NEXT ||
+            opcode == ipc::Opcode::PLAYLIST_PREV) {
+            writer.key("track");
+            writeJson(writer, current_track);
+        } else if (opcode >= ipc::Opcode::PLAYLIST_GET) {
+            writer.key("trackCount");
+            writer.value(playlist_manager->getTrackCount());
+        }
+        return true;
+    }
+
+    /**
+     * 请求体：{"ops": [{"op": "playlist/clear"}, {"op": "playlist/add", "tracks": [...]},
+     *                  {"op": "player/load", "filePath": "..."}, {"op": "player/play"}],
+     *         "stopOnError": false}
+     * 所有操作在一次 state_mutex 加锁内按顺序执行，其他请求看不到中间状态；
+     * 应答包含每个操作的结果、最终的播放器状态和播放列表版本。
+     * stopOnError 为 true 时，第一个失败之后的操作不执行，结果的 status 为 424。
+     */
+    void handleBatch(HttpRequest& req, HttpResponse& res) {
+        JsonValue body;
+        if (!parseBody(req, res, body)) {
+            return;
+        }
+
+        const JsonValue* ops = body.find("ops");
+        if (ops == nullptr || !ops->isArray()) {
+            res.setError(400, "Missing ops");
+            return;
+        }
+        if (ops->array.size() > kMaxBatchOps) {
+            res.setError(400, "Too many operations");
+            return;
+        }
+        const JsonValue* stopOnError = body.find("stopOnError");
+        bool stop = stopOnError != nullptr && stopOnError->type == JsonValue::Type::BOOLEAN && stopOnError->boolean;
+
+        std::string json;
+        JsonWriter writer(json);
+        writer.beginObject();
+        writer.key("results");
+        writer.beginArray();
+        {
+            std::lock_guard<std::mutex> lock(state_mutex);
+            {
+                PlaylistBatch batch(*playlist_manager);
+                bool failed = false;
+                for (const auto& op : ops->array) {
+                    std::string name = op.getString("op");
+                    writer.beginObject();
+                    writer.key("op");
+                    writer.value(name);
+
+                    ipc::Opcode opcode = ipc::Opcode::PLAYER_STATUS;
+                    if (failed && stop) {
+                        batchError(writer, 424, "Skipped after an earlier failure");
+                    } else if (!batchOpcode(name, opcode)) {
+                        failed = true;
+                        batchError(writer, 404, "Unknown operation");
+                    } else if (!runBatchOp(opcode, op, writer)) {
+                        failed = true;
+                    }
+                    writer.endObject();
+                }
+            }
+            writer.endArray();
+
+            writer.key("player");
+            writer.raw(statusJson(playerStatusLocked()));
+            writer.key("playlist");
+            writer.beginObject();
+            writer.key("version");
+            writer.value(static_cast<int64_t>(playlist_manager->getVersion()));
+            writer.key("trackCount");
+            writer.value(playlist_manager->getTrackCount());
+            writer.endObject();
+        }
+        writer.endObject();
+        writer.finish();
+        res.setJson(200, std::move(json));
+    }
+
+    // ===== 事件推送 =====
+
+    void handleEvents(HttpRequest& req, HttpResponse& res) {
+        const std::string* upgrade = req.header("Upgrade");
+        if (upgrade != nullptr && strcasecmp(upgrade->c_str(), "websocket") == 0) {
+            const std::string* key = req.header("Sec-WebSocket-Key");
+            if (key == nullptr || key->empty()) {
+                res.setError(400, "Missing Sec-WebSocket-Key");
+                return;
+            }
+            res.setStream(StreamMode::WEBSOCKET, "status", statusJson());
+            return;
+        }
+
+        res.setStream(StreamMode::SSE, "status", statusJson());
+    }
+
+    // ===== 本地二进制协议 =====
+
+    /**
+     * 处理 Unix 域套接字上的一个请求帧，语义与对应的 HTTP 接口一致
+     * @param data 请求帧体
+     * @param size 帧体长度
+     * @param out 追加应答帧体
+     */
+    void handleIpcMessage(const char* data, size_t size, std::string& out) {
+        ipc::Reader reader(data, size);
+        ipc::Writer writer(out);
+
+        uint32_t requestId = 0;
+        uint16_t opcode = 0;
+        if (!reader.readU32(requestId) || !reader.readU16(opcode)) {
+            writer.writeU32(requestId);
+            writer.writeU16(400);
+            writer.writeString("Malformed request");
+            return;
+        }
+        writer.writeU32(requestId);
+
+        // 先按成功写入状态码，失败时由 ipcError 从 mark 处改写
+        size_t mark = out.size();
+        writer.writeU16(200);
+        dispatchIpc(static_cast<ipc::Opcode>(opcode), reader, out, mark);
+    }
+
+    /**
+     * 失败应答：丢弃已写入的状态码和结果，改为错误状态码和错误信息
+     */
+    static void ipcError(std::string& out, size_t mark, int status, const std::string& message) {
+        out.resize(mark);
+        ipc::Writer writer(out);
+        writer.writeU16(static_cast<uint16_t>(status));
+        writer.writeString(message);
+    }
+
+    void dispatchIpc(ipc::Opcode opcode, ipc::Reader& reader, std::string& out, size_t mark) {
+        ipc::Writer writer(out);
+
+        switch (opcode) {
+            case ipc::Opcode::PLAYER_LOAD: {
+                std::string filePath;
+                if (!reader.readString(filePath) || filePath.empty()) {
+                    return ipcError(out, mark, 400, "Missing filePath");
+                }
+                std::lock_guard<std::mutex> lock(state_mutex);
+                if (!loadTrack(makeLocalTrack(filePath))) {
+                    return ipcError(out, mark, 400, "Failed to load: " + filePath);
+                }
+                writer.writeTrack(current_track);
+                return;
+            }
+            case ipc::Opcode::PLAYER_PLAY:
+                if (!audio_engine->play()) {
+                    return ipcError(out, mark, 409, "No track loaded");
+                }
+                break;
+            case ipc::Opcode::PLAYER_PAUSE:
+                if (!audio_engine->pause()) {
+                    return ipcError(out, mark, 409, "Player is not playing");
+                }
+                break;
+            case ipc::Opcode::PLAYER_STOP:
+                audio_engine->stop();
+                break;
+            case ipc::Opcode::PLAYER_SEEK: {
+                int32_t position = 0;
+                if (!reader.readI32(position) || !audio_engine->seek(position)) {
+                    return ipcError(out, mark, 400, "Invalid position");
+                }
+                break;
+            }
+            case ipc::Opcode::PLAYER_VOLUME: {
+                int32_t volume = 0;
+                if (!reader.readI32(volume) || !audio_engine->setVolume(volume)) {
+                    return ipcError(out, mark, 400, "Volume must be between 0 and 100");
+                }
+                break;
+            }
+            case ipc::Opcode::PLAYER_STATUS:
+                break;
+            case ipc::Opcode::AUDIO_INFO:
+                writer.writeAudioInfo(audio_engine->getAudioInfo());
+                return;
+
+            case ipc::Opcode::PLAYLIST_GET: {
+                std::lock_guard<std::mutex> lock(state_mutex);
+                writer.writePlaylist(playlist_manager->viewCurrentPlaylist());
+                return;
+            }
+            case ipc::Opcode::PLAYLIST_ADD: {
+                Track track;
+                if (!reader.readTrack(track) || track.id.empty()) {
+                    return ipcError(out, mark, 400, "Invalid track");
+                }
+                std::lock_guard<std::mutex> lock(state_mutex);
+                playlist_manager->addTrack(track);
+                writer.writePlaylist(playlist_manager->viewCurrentPlaylist());
+                return;
+            }
+            case ipc::Opcode::PLAYLIST_REMOVE: {
+                int32_t index = -1;
+                if (!reader.readI32(index)) {
+                    return ipcError(out, mark, 400, "Invalid index");
+                }
+                std::lock_guard<std::mutex> lock(state_mutex);
+                if (index < 0 || index >= playlist_manager->getTrackCount()) {
+                    return ipcError(out, mark, 404, "Track index out of range");
+                }
+                playlist_manager->removeTrack(index);
+                writer.writePlaylist(playlist_manager->viewCurrentPlaylist());
+                return;
+            }
+            case ipc::Opcode::PLAYLIST_CLEAR: {
+                std::lock_guard<std::mutex> lock(state_mutex);
+                playlist_manager->clear();
+                writer.writePlaylist(playlist_manager->viewCurrentPlaylist());
+                return;
+            }
+            case ipc::Opcode::PLAYLIST_NEXT:
+            case ipc::Opcode::PLAYLIST_PREV: {
+                bool next = opcode == ipc::Opcode::PLAYLIST_NEXT;
+                std::lock_guard<std::mutex> lock(state_mutex);
+                if (next ? !playlist_manager->playNext() : !playlist_manager->playPrevious()) {
+                    return ipcError(out, mark, 404, next ? "No next track" : "No previous track");
+                }
+                Track track = playlist_manager->getTrackAt(playlist_manager->getCurrentTrackIndex());
+                if (!loadTrack(track)) {
+                    return ipcError(out, mark, 500, "Failed to load: " + track.url);
+                }
+                writer.writeTrack(current_track);
+                return;
+            }
+            default:
+                return ipcError(out, mark, 404, "Unknown opcode");
+        }
+
+        // 播放控制类请求统一返回最新的播放器状态
+        writer.writeStatus(playerStatus());
+    }
+
+    // ===== 响度分析 =====
+
+    void handleLoudnessAnalyze(HttpRequest& req, HttpResponse& res) {
+        std::string directory;
+        if (!req.body.empty()) {
+            JsonValue body;
+            if (!parseBody(req, res, body)) {
+                return;
+            }
+            directory = body.getString("directory");
+        }
+
+        std::lock_guard<std::mutex> lock(loudness_mutex);
+        if (loudness_running) {
+            res.setError(409, "Loudness analysis is already running");
+            return;
+        }
+        if (loudness_thread.joinable()) {
+            loudness_thread.join();  // 上一批已经结束
+        }
+        // 在这里置位而不是等分析器开始，紧接着的第二个请求也会得到 409；
+        // 进度同时归零，收集文件列表期间查询到的是 0 / 0 而不是上一批的进度
+        loudness_running = true;
+        loudness_analyzer.reset();
+        // 遍历目录可能很慢（大目录、网络盘），放到后台线程里，不阻塞事件循环
+        loudness_thread = std::thread([this, directory = std::move(directory)] {
+            std::vector<std::string> files;
+            if (!directory.empty()) {
+                files = LoudnessAnalyzer::listAudioFiles(directory);
+            } else {
+                std::lock_guard<std::mutex> lock(state_mutex);
+                files = LoudnessAnalyzer::playlistFiles(playlist_manager->getCurrentPlaylist());
+            }
+            {
+                std::lock_guard<std::mutex> lock(loudness_mutex);
+                if (loudness_stopping) {
+                    loudness_running = false;
+                    return;
+                }
+            }
+            LoudnessBatchResult result = loudness_analyzer.analyze(files);
+            result.tracks.clear();  // 逐个文件的结果已经写进元数据缓存
+            std::lock_guard<std::mutex> lock(loudness_mutex);
+            loudness_result = std::move(result);
+            loudness_running = false;
+            loudness_finished = true;
+        });
+        res.setJson(202, "{\"running\":true}");
+    }
+
+    void handleLoudnessStatus(HttpRequest&, HttpResponse& res) {
+        LoudnessProgress progress = loudness_analyzer.progress();
+        std::lock_guard<std::mutex> lock(loudness_mutex);
+        std::string json = "{\"running\":";
+        json += loudness_running ? "true" : "false";
+        json += ",\"total\":" + std::to_string(progress.total);
+        json += ",\"completed\":" + std::to_string(progress.completed);
+        json += ",\"last\":";
+        if (!loudness_finished) {
+            json += "null}";
+        } else {
+            const LoudnessBatchResult& result = loudness_result;
+            json += "{\"files\":" + std::to_string(result.files);
+            json += ",\"analyzed\":" + std::to_string(result.analyzed);
+            json += ",\"skipped\":" + std::to_string(result.skipped);
+            json += ",\"albums\":" + std::to_string(result.albums);
+            json += ",\"seconds\":" + formatNumber(result.seconds);
+            json += ",\"audioSeconds\":" + formatNumber(result.audioSeconds) + "}}";
+        }
+        res.setJson(200, std::move(json));
+    }
+
+    // ===== 波形 =====
+
+    /**
+     * 轨道 ID 对应的本地文件：通过引擎加载过的文件，或当前播放列表中的本地轨道
+     * @return 文件路径，找不到时为空
+     */
+    std::string localTrackPath(const std::string& trackId) {
+        std::lock_guard<std::mutex> lock(state_mutex);
+        auto it = local_files.find(trackId);
+        if (it != local_files.end()) {
+            return it->second;
+        }
+        for (const Track& track : playlist_manager->viewCurrentPlaylist().tracks) {
+            if (track.id == trackId && isLocalPath(track.url)) {
+                return track.url;
+            }
+        }
+        return std::string();
+    }
+
+    void handleTrackWaveform(HttpRequest& req, HttpResponse& res) {
+        int resolution = 1000;
+        if (!parseInt(req.queryParam("resolution", "1000"), resolution) || resolution <= 0 ||
+            static_cast<size_t>(resolution) > kMaxWaveformResolution) {
+            res.setError(400, "Invalid resolution");
+            return;
+        }
+        int start = 0;
+        int end = 0;
+        if (!parseInt(req.queryParam("start", "0"), start) || !parseInt(req.queryParam("end", "0"), end) ||
+            start < 0 || end < 0 || (end != 0 && end <= start)) {
+            res.setError(400, "Invalid range");
+            return;
+        }
+        std::string spectrum = req.queryParam("spectrum", "0");
+        if (spectrum != "0" && spectrum != "1" && spectrum != "false" && spectrum != "true") {
+            res.setError(400, "Invalid spectrum");
+            return;
+        }
+
+        std::string filePath = localTrackPath(req.pathParam("id"));
+        if (filePath.empty()) {
+            res.setError(404, "Track not found");
+            return;
+        }
+
+        WaveformQuery query;
+        query.startMs = static_cast<uint64_t>(start);
+        query.endMs = static_cast<uint64_t>(end);
+        query.resolution = static_cast<size_t>(resolution);
+        query.spectrum = spectrum == "1" || spectrum == "true";
+        WaveformView view;
+        WaveformStatus status = waveform_store.query(filePath, query, view);
+        if (status == WaveformStatus::PENDING) {
+            res.setJson(202, "{\"status\":\"pending\"}");
+            return;
+        }
+        if (status == WaveformStatus::FAILED) {
+            res.setError(501, "Waveform is not available for this file");
+            return;
+        }
+
+        // 最多 65536 点（频谱再乘频带数），直接写进发送缓冲区
+        res.setJsonWriter(200, [view = std::move(view)](JsonWriter& writer) {
+            uint64_t rate = static_cast<uint64_t>(view.sampleRate);
+            auto toMs = [rate](uint64_t frame, bool roundUp) {
+                return static_cast<int64_t>((frame * 1000 + (roundUp ? rate - 1 : 0)) / rate);
+            };
+            writer.reserve(128 + view.peaks.size() * 7 + view.spectrum.size() * 4);
+            writer.beginObject();
+            writer.key("status");
+            writer.value("ready");
+            writer.key("sampleRate");
+            writer.value(view.sampleRate);
+            writer.key("channels");
+            writer.value(view.channels);
+            writer.key("duration");
+            writer.value(toMs(view.totalFrames, true));
+            writer.key("start");
+            writer.value(toMs(view.startFrame, false));
+            writer.key("end");
+            writer.value(toMs(view.endFrame, true));
+            writer.key("points");
+            writer.value(static_cast<int64_t>(view.points()));
+            writer.key("peaks");  // 每点 min, max，满幅为 ±32767
+            writer.beginArray();
+            for (int16_t peak : view.peaks) {
+                writer.value(static_cast<int64_t>(peak));
+            }
+            writer.endArray();
+            if (view.hasSpectrum) {
+                writer.key("spectrum");
+                writer.beginObject();
+                writer.key("start");
+                writer.value(toMs(view.spectrumStartFrame, false));
+                writer.key("end");
+                writer.value(toMs(view.spectrumEndFrame, true));
+                writer.key("points");
+                writer.value(static_cast<int64_t>(view.spectrumPoints()));
+                writer.key("bands");
+                writer.value(static_cast<int64_t>(view.bands));
+                writer.key("frequencies");
+                writer.beginArray();
+                for (double frequency : view.bandFrequencies) {
+                    writer.raw(formatNumber(frequency));
+                }
+                writer.endArray();
+                writer.key("values");  // 每点 bands 个，0..255 对应 -100..0 dBFS
+                writer.beginArray();
+                for (uint8_t value : view.spectrum) {
+                    writer.value(static_cast<int64_t>(value));
+                }
+                writer.endArray();
+                writer.endObject();
+            }
+            writer.endObject();
+        });
+    }
+
+    // ===== 系统 =====
+
+    void handleHealth(HttpRequest&, HttpResponse& res) {
+        std::string json = "{\"status\":\"ok\",\"version\":\"";
+        json += kServerVersion;
+        json += "\"}";
+        res.setJson(200, std::move(json));
+    }
+
+    void handleServerStats(HttpRequest&, HttpResponse& res) {
+        std::string json = "{\"reactors\":[";
+        bool first = true;
+        for (const auto& stats : collectStats()) {
+            if (!first) {
+                json.push_back(',');
+            }
+            first = false;
+            json += "{\"index\":" + std::to_string(stats.index);
+            json += ",\"connectionsAccepted\":" + std::to_string(stats.connectionsAccepted);
+            json += ",\"activeConnections\":" + std::to_string(stats.activeConnections);
+            json += ",\"requests\":" + std::to_string(stats.requests);
+            json += ",\"bytesRead\":" + std::to_string(stats.bytesRead);
+            json += ",\"bytesWritten\":" + std::to_string(stats.bytesWritten);
+            json += ",\"eventStreams\":" + std::to_string(stats.eventStreams);
+            json += ",\"eventsDropped\":" + std::to_string(stats.eventsDropped);
+            json += ",\"eventsCoalesced\":" + std::to_string(stats.eventsCoalesced);
+            json += ",\"requestsInFlight\":" + std::to_string(stats.requestsInFlight);
+            json += "}";
+        }
+        json += "]}";
+        res.setJson(200, std::move(json));
+    }
+
+    /**
+     * 输出 Prometheus 指标
+     * 各 Reactor 的计数器由各自的事件循环线程无锁写入，这里只做读取和合并，
+     * 不会阻塞请求处理；同一次输出中不同计数器之间不保证是同一时刻的值
+     */
+    void handleMetrics(HttpRequest&, HttpResponse& res) {
+        std::string& out = res.body;
+        out.reserve(64 * 1024);
+        PrometheusWriter writer(out);
+
+        // 各路由的计数：合并所有 Reactor，最后一个槽位是未匹配任何路由的请求
+        size_t routeCount = router.routeCount();
+        struct RouteTotals {
+            uint64_t responses[5] = {};
+            uint64_t bytesIn = 0;
+            uint64_t bytesOut = 0;
+            HistogramSnapshot latency;
+        };
+        std::vector<RouteTotals> totals(routeCount + 1);
+        for (const auto& reactor : reactors) {
+            for (size_t i = 0; i <= routeCount; ++i) {
+                const Reactor::RouteCounters& counters = reactor->routeCounters(i);
+                RouteTotals& total = totals[i];
+                for (int c = 0; c < 5; ++c) {
+                    total.responses[c] += counters.responses[c].load(std::memory_order_relaxed);
+                }
+                total.bytesIn += counters.bytesIn.load(std::memory_order_relaxed);
+                total.bytesOut += counters.bytesOut.load(std::memory_order_relaxed);
+                total.latency.merge(counters.latency);
+            }
+        }
+
+        static const std::string kUnmatched = "(unmatched)";
+        static const std::string kAnyMethod;
+        auto method = [&](size_t i) -> const std::string& { return i < routeCount ? router.routeMethod(i) : kAnyMethod; };
+        auto pattern = [&](size_t i) -> const std::string& { return i < routeCount ? router.routePattern(i) : kUnmatched; };
+
+        // 与 Prometheus 客户端库一样，只输出出现过请求的路由
+        std::vector<size_t> observed;
+        for (size_t i = 0; i <= routeCount; ++i) {
+            const uint64_t* responses = totals[i].responses;
+            if (responses[0] + responses[1] + responses[2] + responses[3] + responses[4] > 0) {
+                observed.push_back(i);
+            }
+        }
+
+        static const char* kStatusClasses[] = {"1xx", "2xx", "3xx", "4xx", "5xx"};
+        writer.family("musicfree_http_requests_total", "counter", "HTTP requests by route and status class.");
+        for (size_t i : observed) {
+            for (int c = 0; c < 5; ++c) {
+                if (totals[i].responses[c] > 0) {
+                    writer.sample("musicfree_http_requests_total",
+                                  {{"method", method(i)}, {"route", pattern(i)}, {"code", kStatusClasses[c]}},
+                                  totals[i].responses[c]);
+                }
+            }
+        }
+        writer.family("musicfree_http_request_errors_total", "counter", "HTTP requests answered with 4xx or 5xx.");
+        for (size_t i : observed) {
+            writer.sample("musicfree_http_request_errors_total", {{"method", method(i)}, {"route", pattern(i)}},
+                          totals[i].responses[3] + totals[i].responses[4]);
+        }
+        writer.family("musicfree_http_request_bytes_total", "counter", "HTTP request bytes (head and body).");
+        for (size_t i : observed) {
+            writer.sample("musicfree_http_request_bytes_total", {{"method", method(i)}, {"route", pattern(i)}},
+                          totals[i].bytesIn);
+        }
+        writer.family("musicfree_http_response_bytes_total", "counter",
+                      "HTTP response bytes including file bodies sent with sendfile.");
+        for (size_t i : observed) {
+            writer.sample("musicfree_http_response_bytes_total", {{"method", method(i)}, {"route", pattern(i)}},
+                          totals[i].bytesOut);
+        }
+        writer.family("musicfree_http_request_duration_seconds", "histogram",
+                      "Time from reading the request until the response is handed to the kernel.");
+        for (size_t i : observed) {
+            writer.histogram("musicfree_http_request_duration_seconds", {{"method", method(i)}, {"route", pattern(i)}},
+                             totals[i].latency);
+        }
+        writer.family("musicfree_http_request_latency_seconds", "summary",
+                      "Request duration quantiles from the HDR histogram.");
+        for (size_t i : observed) {
+            writer.summary("musicfree_http_request_latency_seconds", {{"method", method(i)}, {"route", pattern(i)}},
+                           totals[i].latency);
+        }
+
+        // 各事件循环的连接计数
+        std::vector<ReactorStats> stats = collectStats();
+        std::vector<std::string> indexes;
+        for (const auto& reactor : stats) {
+            indexes.push_back(std::to_string(reactor.index));
+        }
+        auto perReactor = [&](const char* name, const char* type, const char* help, uint64_t ReactorStats::*field) {
+            writer.family(name, type, help);
+            for (size_t i = 0; i < stats.size(); ++i) {
+                writer.sample(name, {{"reactor", indexes[i]}}, stats[i].*field);
+            }
+        };
+        perReactor("musicfree_http_requests_in_flight", "gauge",
+                   "Requests being handled or whose response is not fully sent yet.", &ReactorStats::requestsInFlight);
+        perReactor("musicfree_http_connections_active", "gauge", "Open connections.", &ReactorStats::activeConnections);
+        perReactor("musicfree_http_connections_accepted_total", "counter", "Accepted connections.",
+                   &ReactorStats::connectionsAccepted);
+        perReactor("musicfree_http_read_bytes_total", "counter", "Bytes read from sockets.", &ReactorStats::bytesRead);
+        perReactor("musicfree_http_written_bytes_total", "counter", "Bytes written to sockets.",
+                   &ReactorStats::bytesWritten);
+        perReactor("musicfree_event_streams", "gauge", "Open /api/events streams.", &ReactorStats::eventStreams);
+        perReactor("musicfree_events_dropped_total", "counter",
+                   "Events not sent because the stream was closed for falling behind.", &ReactorStats::eventsDropped);
+        perReactor("musicfree_events_coalesced_total", "counter", "Position events superseded before being sent.",
+                   &ReactorStats::eventsCoalesced);
+
+        // 音频引擎
+        AudioEngineMetrics audio = audio_engine->getMetrics();
+        writer.family("musicfree_audio_loads_total", "counter", "Audio files loaded.");
+        writer.sample("musicfree_audio_loads_total", {}, audio.loads);
+        writer.family("musicfree_audio_blocks_decoded_total", "counter", "Audio blocks written to the PCM ring buffer by the decoder thread.");
+        writer.sample("musicfree_audio_blocks_decoded_total", {}, audio.blocksDecoded);
+        writer.family("musicfree_audio_underruns_total", "counter", "Output periods the PCM ring buffer could not fill.");
+        writer.sample("musicfree_audio_underruns_total", {}, audio.underruns);
+        writer.family("musicfree_audio_frames_played_total", "counter", "PCM frames consumed by the output.");
+        writer.sample("musicfree_audio_frames_played_total", {}, audio.framesPlayed);
+        writer.family("musicfree_audio_sink_frames_total", "counter",
+                      "PCM frames written to the sink, including silence padded on underruns.");
+        writer.sample("musicfree_audio_sink_frames_total", {}, audio.sinkFrames);
+        writer.family("musicfree_audio_gapless_transitions_total", "counter",
+                      "Tracks started by switching to the pre-decoded next track.");
+        writer.sample("musicfree_audio_gapless_transitions_total", {}, audio.gaplessTransitions);
+        writer.family("musicfree_audio_crossfades_total", "counter", "Track transitions mixed with a crossfade.");
+        writer.sample("musicfree_audio_crossfades_total", {}, audio.crossfades);
+        writer.family("musicfree_audio_decode_duration_seconds", "histogram", "Time to produce one audio block.");
+        writer.histogram("musicfree_audio_decode_duration_seconds", {}, audio.decodeTime);
+        writer.family("musicfree_audio_decode_latency_seconds", "summary", "Audio block decode time quantiles.");
+        writer.summary("musicfree_audio_decode_latency_seconds", {}, audio.decodeTime);
+        writer.family("musicfree_audio_stage_seconds_total", "counter", "Time spent in each audio pipeline stage.");
+        writer.sample("musicfree_audio_stage_seconds_total", {{"stage", "decode"}}, audio.decodeTime.sum() / 1e9);
+        writer.sample("musicfree_audio_stage_seconds_total", {{"stage", "mix"}}, audio.mixNanos / 1e9);
+        writer.sample("musicfree_audio_stage_seconds_total", {{"stage", "dsp"}}, audio.dspNanos / 1e9);
+        writer.sample("musicfree_audio_stage_seconds_total", {{"stage", "sink"}}, audio.sinkNanos / 1e9);
+        writer.family("musicfree_audio_events_dropped_total", "counter", "Engine events dropped because the event queue was full.");
+        writer.sample("musicfree_audio_events_dropped_total", {}, audio.eventsDropped);
+        writer.family("musicfree_audio_event_delay_seconds", "histogram", "Time from publishing an engine event to dispatching it.");
+        writer.histogram("musicfree_audio_event_delay_seconds", {}, audio.eventLatency);
+
+        // 播放列表：计数器无锁读取，轨道数需要持有 state_mutex
+        PlaylistMutationCounts playlist = playlist_manager->getMutationCounts();
+        uint64_t trackCount = 0;
+        {
+            std::lock_guard<std::mutex> lock(state_mutex);
+            trackCount = static_cast<uint64_t>(playlist_manager->getTrackCount());
+        }
+        writer.family("musicfree_playlist_mutations_total", "counter", "Playlist modifications by operation.");
+        writer.sample("musicfree_playlist_mutations_total", {{"op", "add"}}, playlist.adds);
+        writer.sample("musicfree_playlist_mutations_total", {{"op", "remove"}}, playlist.removes);
+        writer.sample("musicfree_playlist_mutations_total", {{"op", "clear"}}, playlist.clears);
+        writer.family("musicfree_playlist_tracks_added_total", "counter", "Tracks added to the playlist.");
+        writer.sample("musicfree_playlist_tracks_added_total", {}, playlist.tracksAdded);
+        writer.family("musicfree_playlist_tracks_removed_total", "counter", "Tracks removed from the playlist.");
+        writer.sample("musicfree_playlist_tracks_removed_total", {}, playlist.tracksRemoved);
+        writer.family("musicfree_playlist_batches_total", "counter", "Batches of playlist modifications.");
+        writer.sample("musicfree_playlist_batches_total", {}, playlist.batches);
+        writer.family("musicfree_playlist_tracks", "gauge", "Tracks in the current playlist.");
+        writer.sample("musicfree_playlist_tracks", {}, trackCount);
+
+        res.status = 200;
+        res.contentType = PrometheusWriter::kContentType;
+    }
+
+    std::vector<ReactorStats> collectStats() const {
+        std::vector<ReactorStats> result;
+        result.reserve(reactors.size());
+        for (size_t i = 0; i < reactors.size(); ++i) {
+            const Reactor::Counters& counters = reactors[i]->counters();
+            ReactorStats stats;
+            stats.index = static_cast<int>(i);
+            stats.connectionsAccepted = counters.accepted.load(std::memory_order_relaxed);
+            stats.activeConnections = counters.active.load(std::memory_order_relaxed);
+            stats.requests = counters.requests.load(std::memory_order_relaxed);
+            stats.bytesRead = counters.bytesRead.load(std::memory_order_relaxed);
+            stats.bytesWritten = counters.bytesWritten.load(std::memory_order_relaxed);
+            stats.eventStreams = counters.streams.load(std::memory_order_relaxed);
+            stats.eventsDropped = counters.eventsDropped.load(std::memory_order_relaxed);
+            stats.eventsCoalesced = counters.eventsCoalesced.load(std::memory_order_relaxed);
+            stats.requestsInFlight = counters.inFlight.load(std::memory_order_relaxed);
+            result.push_back(stats);
+        }
+        return result;
     }
 };
 
@@ -80,18 +1954,73 @@ ApiServer::~ApiServer() {
     stop();
 }
 
-bool ApiServer::start(int port) {
+bool ApiServer::start(int port, int threads) {
+    ApiServerOptions options;
+    options.port = port;
+    options.threads = threads;
+    return start(options);
+}
+
+bool ApiServer::start(const ApiServerOptions& options) {
     if (impl_->running) {
         return false;
     }
 
-    impl_->port = port;
-    impl_->server_thread = std::thread([this] { impl_->runServer(); });
-    
-    // 等待服务器启动
-    std::this_thread::sleep_for(std::chrono::milliseconds(100));
-    
-    return impl_->running;
+    Impl* impl = impl_.get();
+    impl->options = options;
+
+    int threads = options.threads;
+    if (threads <= 0) {
+        threads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+    }
+
+    // 在调用线程上完成绑定，端口被占用时可以直接返回失败。
+    // 端口为 0 时第一个 Reactor 拿到系统分配的端口，其余 Reactor 复用该端口。
+    ReactorOptions reactorOptions;
+    reactorOptions.coalesceInterval = std::chrono::milliseconds(std::max(0, options.eventIntervalMs));
+    reactorOptions.eventQueueDepth = static_cast<size_t>(std::max(1, options.eventQueueDepth));
+    reactorOptions.routeCount = impl->router.routeCount();
+
+    int port = options.port;
+    for (int i = 0; i < threads; ++i) {
+        auto reactor = std::make_unique<Reactor>([impl](HttpRequest& req, HttpResponse& res) {
+            impl->router.dispatch(req, res);
+        }, reactorOptions);
+        if (!reactor->listen(options.host, port, threads > 1)) {
+            impl->reactors.clear();
+            return false;
+        }
+        port = reactor->localPort();
+        impl->reactors.push_back(std::move(reactor));
+    }
+
+    // 本地前端只有一个客户端，Unix 域套接字挂在第一个事件循环上即可
+    if (!options.unixSocketPath.empty() &&
+        !impl->reactors.front()->listenUnix(options.unixSocketPath, [impl](const char* data, size_t size, std::string& out) {
+            impl->handleIpcMessage(data, size, out);
+        })) {
+        impl->reactors.clear();
+        return false;
+    }
+
+    impl->port = port;
+    impl->running = true;
+    {
+        std::lock_guard<std::mutex> lock(impl->publish_mutex);
+        impl->publishing = true;
+    }
+    for (size_t i = 0; i < impl->reactors.size(); ++i) {
+        impl->reactor_threads.emplace_back([impl, i] { impl->runServer(i); });
+    }
+
+    std::cout << "API Server started on port " << port << " with " << threads
+              << (threads > 1 ? " event loops" : " event loop") << std::endl;
+    std::cout << "Base URL: http://" << options.host << ":" << port << std::endl;
+    if (!options.unixSocketPath.empty()) {
+        std::cout << "Local IPC socket: " << options.unixSocketPath << std::endl;
+    }
+
+    return true;
 }
 
 void ApiServer::stop() {
@@ -99,11 +2028,24 @@ void ApiServer::stop() {
         return;
     }
 
-    impl_->running = false;
-    
-    if (impl_->server_thread.joinable()) {
-        impl_->server_thread.join();
+    // 先停止事件发布：引擎回调可能正持有引擎的锁，不能让它等待事件循环线程退出
+    {
+        std::lock_guard<std::mutex> lock(impl_->publish_mutex);
+        impl_->publishing = false;
+    }
+
+    for (auto& reactor : impl_->reactors) {
+        reactor->stop();
     }
+    for (auto& thread : impl_->reactor_threads) {
+        if (thread.joinable()) {
+            thread.join();
+        }
+    }
+
+    impl_->reactor_threads.clear();
+    impl_->reactors.clear();
+    impl_->running = false;
 }
 
 bool ApiServer::isRunning() const {
@@ -114,4 +2056,8 @@ int ApiServer::getPort() const {
     return impl_->port;
 }
 
+std::vector<ReactorStats> ApiServer::getReactorStats() const {
+    return impl_->collectStats();
+}
+
 }  // namespace musicfree
@@ -0,0 +1,431 @@
+#include "http_message.h"
+#include "json_writer.h"
+#include <strings.h>
+#include <cerrno>
+#include <cstdlib>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace musicfree {
+
+namespace {
+
+int hexValue(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+void appendDecimal(std::string& out, uint64_t value) {
+    char digits[24];
+    int n = 0;
+    do {
+        digits[n++] = static_cast<char>('0' + value % 10);
+        value /= 10;
+    } while (value > 0);
+    while (n > 0) {
+        out.push_back(digits[--n]);
+    }
+}
+
+bool parseUnsigned(const std::string& text, size_t begin, size_t end, uint64_t& value) {
+    if (begin >= end) {
+        return false;
+    }
+    value = 0;
+    for (size_t i = begin; i < end; ++i) {
+        if (text[i] < '0' || text[i] > '9') {
+            return false;
+        }
+        uint64_t next = value * 10 + static_cast<uint64_t>(text[i] - '0');
+        if (next < value) {
+            return false;
+        }
+        value = next;
+    }
+    return true;
+}
+
+enum class RangeResult {
+    FULL = 0,          // 没有 Range 或无法识别（按 RFC 7233 忽略），发送整个文件
+    PARTIAL = 1,       // 单段可满足的范围
+    UNSATISFIABLE = 2  // 起点超出文件大小
+};
+
+/**
+ * 解析 Range 请求头，只支持单段字节范围：bytes=a-b、bytes=a-、bytes=-n
+ * 多段范围按整个文件应答
+ */
+RangeResult parseByteRange(const std::string& header, uint64_t size, uint64_t& first, uint64_t& last) {
+    const char* kUnit = "bytes=";
+    if (strncasecmp(header.c_str(), kUnit, 6) != 0 || header.find(',') != std::string::npos) {
+        return RangeResult::FULL;
+    }
+
+    size_t dash = header.find('-', 6);
+    if (dash == std::string::npos) {
+        return RangeResult::FULL;
+    }
+
+    uint64_t start = 0;
+    uint64_t end = 0;
+    bool hasStart = parseUnsigned(header, 6, dash, start);
+    bool hasEnd = parseUnsigned(header, dash + 1, header.size(), end);
+
+    if (!hasStart) {
+        // 后缀范围：最后 n 个字节
+        if (!hasEnd || dash != 6) return RangeResult::FULL;
+        if (end == 0 || size == 0) return RangeResult::UNSATISFIABLE;
+        first = end >= size ? 0 : size - end;
+        last = size - 1;
+        return RangeResult::PARTIAL;
+    }
+    if (dash + 1 < header.size() && !hasEnd) {
+        return RangeResult::FULL;
+    }
+    if (hasEnd && end < start) {
+        return RangeResult::FULL;
+    }
+    if (start >= size) {
+        return RangeResult::UNSATISFIABLE;
+    }
+
+    first = start;
+    last = (!hasEnd || end >= size) ? size - 1 : end;
+    return RangeResult::PARTIAL;
+}
+
+/**
+ * If-None-Match 中是否有与 etag 匹配的项（"*" 或逗号分隔的列表，按弱比较忽略 W/ 前缀）
+ */
+bool etagListMatches(const std::string& header, const std::string& etag) {
+    size_t pos = 0;
+    while (pos < header.size()) {
+        size_t end = header.find(',', pos);
+        if (end == std::string::npos) {
+            end = header.size();
+        }
+        size_t begin = pos;
+        while (begin < end && (header[begin] == ' ' || header[begin] == '\t')) ++begin;
+        size_t last = end;
+        while (last > begin && (header[last - 1] == ' ' || header[last - 1] == '\t')) --last;
+        if (last - begin >= 2 && header.compare(begin, 2, "W/") == 0) {
+            begin += 2;
+        }
+
+        if (header.compare(begin, last - begin, "*") == 0 || header.compare(begin, last - begin, etag) == 0) {
+            return true;
+        }
+        pos = end + 1;
+    }
+    return false;
+}
+
+}  // namespace
+
+// ===== HttpRequest =====
+
+const std::string* HttpRequest::header(const std::string& name) const {
+    for (const auto& entry : headers) {
+        if (strcasecmp(entry.first.c_str(), name.c_str()) == 0) {
+            return &entry.second;
+        }
+    }
+    return nullptr;
+}
+
+std::string HttpRequest::queryParam(const std::string& name, const std::string& defaultValue) const {
+    size_t pos = 0;
+    while (pos <= query.size()) {
+        size_t end = query.find('&', pos);
+        if (end == std::string::npos) {
+            end = query.size();
+        }
+
+        size_t eq = query.find('=', pos);
+        size_t keyEnd = (eq == std::string::npos || eq > end) ? end : eq;
+        if (urlDecode(query.substr(pos, keyEnd - pos), true) == name) {
+            if (keyEnd == end) {
+                return std::string();
+            }
+            return urlDecode(query.substr(keyEnd + 1, end - keyEnd - 1), true);
+        }
+
+        pos = end + 1;
+    }
+    return defaultValue;
+}
+
+std::string HttpRequest::pathParam(const std::string& name) const {
+    for (const auto& entry : pathParams) {
+        if (entry.first == name) {
+            return entry.second;
+        }
+    }
+    return std::string();
+}
+
+void HttpRequest::clear() {
+    method.clear();
+    path.clear();
+    query.clear();
+    versionMinor = 1;
+    headers.clear();
+    body.clear();
+    keepAlive = true;
+    pathParams.clear();
+    route = -1;
+}
+
+// ===== HttpResponse =====
+
+void HttpResponse::setJson(int statusCode, std::string json) {
+    status = statusCode;
+    contentType = "application/json";
+    body = std::move(json);
+}
+
+void HttpResponse::setError(int statusCode, const std::string& message) {
+    // 消息可能带有客户端给出的内容（路径、URL），按 JsonWriter 的规则转义控制字符
+    std::string json = "{\"message\":";
+    appendJsonString(json, message.data(), message.size());
+    json += "}";
+    setJson(statusCode, std::move(json));
+}
+
+void HttpResponse::setJsonWriter(int statusCode, std::function<void(JsonWriter&)> writer) {
+    status = statusCode;
+    contentType = "application/json";
+    body.clear();
+    jsonWriter = std::move(writer);
+}
+
+void HttpResponse::setSharedBody(int statusCode, std::shared_ptr<const std::string> json) {
+    status = statusCode;
+    contentType = "application/json";
+    body.clear();
+    sharedBody = std::move(json);
+}
+
+void HttpResponse::setStream(StreamMode mode, std::string initialEvent, std::string json) {
+    status = mode == StreamMode::WEBSOCKET ? 101 : 200;
+    stream = mode;
+    streamEvent = std::move(initialEvent);
+    body = std::move(json);
+}
+
+void HttpResponse::setFile(int fd, uint64_t offset, uint64_t length) {
+    if (fileFd >= 0 && fileFd != fd) {
+        ::close(fileFd);
+    }
+    body.clear();
+    fileFd = fd;
+    fileOffset = offset;
+    fileLength = length;
+}
+
+int HttpResponse::releaseFile() {
+    int fd = fileFd;
+    fileFd = -1;
+    fileOffset = 0;
+    fileLength = 0;
+    return fd;
+}
+
+void HttpResponse::clear() {
+    status = 200;
+    contentType = "application/json";
+    headers.clear();
+    body.clear();
+    stream = StreamMode::NONE;
+    streamEvent.clear();
+    jsonWriter = nullptr;
+    sharedBody.reset();
+    crossOrigin = true;
+    if (fileFd >= 0) {
+        ::close(fileFd);
+    }
+    releaseFile();
+}
+
+const char* httpStatusText(int status) {
+    switch (status) {
+        case 101: return "Switching Protocols";
+        case 200: return "OK";
+        case 201: return "Created";
+        case 202: return "Accepted";
+        case 204: return "No Content";
+        case 206: return "Partial Content";
+        case 304: return "Not Modified";
+        case 400: return "Bad Request";
+        case 403: return "Forbidden";
+        case 404: return "Not Found";
+        case 405: return "Method Not Allowed";
+        case 408: return "Request Timeout";
+        case 409: return "Conflict";
+        case 411: return "Length Required";
+        case 413: return "Payload Too Large";
+        case 415: return "Unsupported Media Type";
+        case 416: return "Range Not Satisfiable";
+        case 431: return "Request Header Fields Too Large";
+        case 500: return "Internal Server Error";
+        case 501: return "Not Implemented";
+        case 503: return "Service Unavailable";
+        case 505: return "HTTP Version Not Supported";
+        default:  return "Unknown";
+    }
+}
+
+void appendHttpResponse(std::string& out, const HttpResponse& response, bool keepAlive, bool headOnly,
+                        bool allowChunked) {
+    bool streamed = static_cast<bool>(response.jsonWriter);
+
+    out += "HTTP/1.1 ";
+    appendDecimal(out, response.status);
+    out.push_back(' ');
+    out += httpStatusText(response.status);
+    out += "\r\n";
+
+    if (response.status != 204 && response.status != 304) {
+        if (!response.contentType.empty()) {
+            out += "Content-Type: ";
+            out += response.contentType;
+            out += "\r\n";
+        }
+        if (!streamed) {
+            out += "Content-Length: ";
+            uint64_t length = response.body.size();
+            if (response.fileFd >= 0) {
+                length = response.fileLength;
+            } else if (response.sharedBody) {
+                length = response.sharedBody->size();
+            }
+            appendDecimal(out, length);
+            out += "\r\n";
+        } else if (allowChunked) {
+            out += "Transfer-Encoding: chunked\r\n";
+        }
+    }
+
+    // 前端由 Electron / 开发服务器加载，需要允许跨域访问
+    if (response.crossOrigin) {
+        out += "Access-Control-Allow-Origin: *\r\n";
+    }
+
+    for (const auto& header : response.headers) {
+        out += header.first;
+        out += ": ";
+        out += header.second;
+        out += "\r\n";
+    }
+
+    out += keepAlive ? "Connection: keep-alive\r\n\r\n" : "Connection: close\r\n\r\n";
+
+    if (headOnly) {
+        return;
+    }
+    if (streamed) {
+        JsonWriter writer(out, allowChunked);
+        response.jsonWriter(writer);
+        writer.finish();
+    } else if (response.sharedBody) {
+        out += *response.sharedBody;
+    } else {
+        out += response.body;
+    }
+}
+
+bool checkNotModified(const HttpRequest& request, HttpResponse& response, const std::string& etag) {
+    response.headers.emplace_back("ETag", etag);
+    // 内容随时可能变化：允许缓存，但每次使用前都要带 If-None-Match 重新验证
+    response.headers.emplace_back("Cache-Control", "no-cache");
+    response.headers.emplace_back("Access-Control-Expose-Headers", "ETag");
+
+    const std::string* ifNoneMatch = request.header("If-None-Match");
+    if (ifNoneMatch == nullptr || !etagListMatches(*ifNoneMatch, etag)) {
+        return false;
+    }
+    response.status = 304;
+    response.body.clear();
+    return true;
+}
+
+void setFileResponse(const HttpRequest& request, HttpResponse& response, const std::string& path,
+                     const std::string& contentType) {
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        response.setError(errno == ENOENT ? 404 : 403, "Cannot open file");
+        return;
+    }
+
+    struct stat st;
+    if (::fstat(fd, &st) < 0 || !S_ISREG(st.st_mode)) {
+        ::close(fd);
+        response.setError(404, "Not a regular file");
+        return;
+    }
+
+    uint64_t size = static_cast<uint64_t>(st.st_size);
+    uint64_t first = 0;
+    uint64_t last = size == 0 ? 0 : size - 1;
+    const std::string* range = request.header("Range");
+    RangeResult result = range != nullptr ? parseByteRange(*range, size, first, last) : RangeResult::FULL;
+
+    if (result == RangeResult::UNSATISFIABLE) {
+        ::close(fd);
+        std::string contentRange = "bytes */";
+        appendDecimal(contentRange, size);
+        response.setError(416, "Range Not Satisfiable");
+        response.headers.emplace_back("Content-Range", std::move(contentRange));
+        return;
+    }
+
+    uint64_t length = size == 0 ? 0 : last - first + 1;
+    response.status = 200;
+    response.contentType = contentType;
+    response.headers.emplace_back("Accept-Ranges", "bytes");
+    response.headers.emplace_back("Access-Control-Expose-Headers", "Content-Range, Content-Length, Accept-Ranges");
+    if (result == RangeResult::PARTIAL) {
+        std::string contentRange = "bytes ";
+        appendDecimal(contentRange, first);
+        contentRange.push_back('-');
+        appendDecimal(contentRange, last);
+        contentRange.push_back('/');
+        appendDecimal(contentRange, size);
+        response.status = 206;
+        response.headers.emplace_back("Content-Range", std::move(contentRange));
+    }
+
+#if defined(POSIX_FADV_SEQUENTIAL)
+    // 播放器基本是顺序读取，让内核加大预读
+    ::posix_fadvise(fd, static_cast<off_t>(first), static_cast<off_t>(length), POSIX_FADV_SEQUENTIAL);
+#endif
+    response.setFile(fd, first, length);
+}
+
+std::string urlDecode(const std::string& text, bool plusAsSpace) {
+    std::string result;
+    result.reserve(text.size());
+
+    for (size_t i = 0; i < text.size(); ++i) {
+        char c = text[i];
+        if (c == '%' && i + 2 < text.size()) {
+            int hi = hexValue(text[i + 1]);
+            int lo = hexValue(text[i + 2]);
+            if (hi >= 0 && lo >= 0) {
+                result.push_back(static_cast<char>(hi * 16 + lo));
+                i += 2;
+                continue;
+            }
+        } else if (c == '+' && plusAsSpace) {
+            result.push_back(' ');
+            continue;
+        }
+        result.push_back(c);
+    }
+    return result;
+}
+
+}  // namespace musicfree
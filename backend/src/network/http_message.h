@@ -0,0 +1,187 @@
+#ifndef MUSICFREE_HTTP_MESSAGE_H
+#define MUSICFREE_HTTP_MESSAGE_H
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace musicfree {
+
+class JsonWriter;
+
+using HttpHeaders = std::vector<std::pair<std::string, std::string>>;
+
+/**
+ * HTTP 请求
+ * 由 HttpParser 解析得到，路由匹配后会填充 pathParams
+ */
+struct HttpRequest {
+    std::string method;
+    std::string path;      // 不含查询串，已做 URL 解码
+    std::string query;     // '?' 之后的原始查询串
+    int versionMinor = 1;  // HTTP/1.x 的 x
+    HttpHeaders headers;
+    std::string body;
+    bool keepAlive = true;
+    HttpHeaders pathParams;  // 路由中 {name} 占位符匹配到的值
+    int route = -1;          // 匹配到的路由序号（Router 的注册顺序），未匹配时为 -1
+
+    /**
+     * 获取请求头（名称不区分大小写）
+     * @param name 请求头名称
+     * @return 请求头的值，不存在时返回 nullptr
+     */
+    const std::string* header(const std::string& name) const;
+
+    /**
+     * 获取查询参数（已做 URL 解码）
+     * @param name 参数名
+     * @param defaultValue 不存在时的默认值
+     * @return 参数值
+     */
+    std::string queryParam(const std::string& name, const std::string& defaultValue = "") const;
+
+    /**
+     * 获取路由参数
+     * @param name 占位符名称
+     * @return 参数值，不存在时返回空字符串
+     */
+    std::string pathParam(const std::string& name) const;
+
+    void clear();
+};
+
+/**
+ * 事件推送方式
+ */
+enum class StreamMode {
+    NONE = 0,       // 普通请求 / 应答
+    SSE = 1,        // Server-Sent Events（text/event-stream）
+    WEBSOCKET = 2   // WebSocket 文本帧
+};
+
+/**
+ * HTTP 响应
+ */
+struct HttpResponse {
+    int status = 200;
+    std::string contentType = "application/json";
+    HttpHeaders headers;
+    std::string body;
+
+    // 不为 NONE 时连接升级为事件推送流（见 Reactor::publish），
+    // body 作为名为 streamEvent 的第一条事件立即发送
+    StreamMode stream = StreamMode::NONE;
+    std::string streamEvent;
+
+    // 文件响应体：fileFd 有效时忽略 body，报文头之后由 Reactor 用 sendfile 直接从文件发送
+    // 文件描述符归响应所有，clear() 会关闭尚未被 Reactor 接管的描述符
+    int fileFd = -1;
+    uint64_t fileOffset = 0;
+    uint64_t fileLength = 0;
+
+    // 流式 JSON 响应体：设置后忽略 body，写完报文头后直接序列化进连接的发送缓冲区，
+    // HTTP/1.1 使用分块传输编码，HTTP/1.0 以关闭连接结束
+    std::function<void(JsonWriter&)> jsonWriter;
+
+    // 共享的响应体：设置后忽略 body，多个响应引用同一份已序列化的内容（见 ApiServer 的响应缓存）
+    std::shared_ptr<const std::string> sharedBody;
+
+    // 允许任意来源的网页读取应答（Access-Control-Allow-Origin: *）
+    bool crossOrigin = true;
+
+    void setJson(int statusCode, std::string json);
+    void setError(int statusCode, const std::string& message);
+
+    /**
+     * 设置流式 JSON 响应体
+     * @param statusCode 状态码
+     * @param writer 序列化函数，在处理函数返回后由 Reactor 调用
+     */
+    void setJsonWriter(int statusCode, std::function<void(JsonWriter&)> writer);
+
+    /**
+     * 设置共享的 JSON 响应体，发送时直接复制进发送缓冲区
+     * @param statusCode 状态码
+     * @param json 已序列化的 JSON
+     */
+    void setSharedBody(int statusCode, std::shared_ptr<const std::string> json);
+
+    /**
+     * 把连接升级为事件推送流
+     * @param mode SSE 或 WebSocket
+     * @param initialEvent 第一条事件名
+     * @param json 第一条事件的数据
+     */
+    void setStream(StreamMode mode, std::string initialEvent, std::string json);
+
+    /**
+     * 以文件的一段作为响应体
+     * @param fd 已打开的文件描述符，所有权转移给响应
+     * @param offset 起始偏移
+     * @param length 字节数
+     */
+    void setFile(int fd, uint64_t offset, uint64_t length);
+
+    /**
+     * 取走文件描述符的所有权
+     * @return 文件描述符，没有文件响应体时返回 -1
+     */
+    int releaseFile();
+
+    void clear();
+};
+
+/**
+ * 获取状态码对应的原因短语
+ * @param status HTTP 状态码
+ * @return 原因短语，例如 "OK"
+ */
+const char* httpStatusText(int status);
+
+/**
+ * 将响应序列化为 HTTP/1.1 报文并追加到输出缓冲区
+ * @param out 输出缓冲区
+ * @param response 响应
+ * @param keepAlive 是否保持连接（流式响应体且不允许分块时必须为 false）
+ * @param headOnly 为 true 时只写入报文头（HEAD 请求）
+ * @param allowChunked 客户端是否支持分块传输编码（HTTP/1.1）
+ */
+void appendHttpResponse(std::string& out, const HttpResponse& response, bool keepAlive, bool headOnly = false,
+                        bool allowChunked = true);
+
+/**
+ * 用本地文件应答 GET / HEAD 请求，支持单段 Range 请求
+ * 成功时设置 200 或 206 与文件响应体；文件不存在返回 404，范围无法满足返回 416
+ * @param request 请求（读取 Range 请求头）
+ * @param response 响应
+ * @param path 文件路径
+ * @param contentType 响应的 Content-Type
+ */
+void setFileResponse(const HttpRequest& request, HttpResponse& response, const std::string& path,
+                     const std::string& contentType);
+
+/**
+ * 处理条件 GET：设置 ETag 和 Cache-Control: no-cache，
+ * 请求的 If-None-Match 与 etag 匹配时把响应设为 304
+ * @param request 请求（读取 If-None-Match 请求头）
+ * @param response 响应
+ * @param etag 当前内容的 ETag（带引号）
+ * @return 已应答 304 时返回 true，调用方不需要再生成响应体
+ */
+bool checkNotModified(const HttpRequest& request, HttpResponse& response, const std::string& etag);
+
+/**
+ * URL 解码（%XX 以及 '+' 转空格）
+ * @param text 编码后的文本
+ * @param plusAsSpace 是否把 '+' 解码为空格（查询串中使用）
+ * @return 解码后的文本
+ */
+std::string urlDecode(const std::string& text, bool plusAsSpace);
+
+}  // namespace musicfree
+
+#endif  // MUSICFREE_HTTP_MESSAGE_H
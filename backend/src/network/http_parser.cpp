@@ -0,0 +1,244 @@
+#include "http_parser.h"
+#include <cstring>
+#include <strings.h>
+
+namespace musicfree {
+
+namespace {
+
+bool isTokenChar(char c) {
+    if ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9')) {
+        return true;
+    }
+    return std::strchr("!#$%&'*+-.^_`|~", c) != nullptr && c != '\0';
+}
+
+const char* trimLeft(const char* begin, const char* end) {
+    while (begin < end && (*begin == ' ' || *begin == '\t')) ++begin;
+    return begin;
+}
+
+const char* trimRight(const char* begin, const char* end) {
+    while (end > begin && (end[-1] == ' ' || end[-1] == '\t')) --end;
+    return end;
+}
+
+bool containsToken(const std::string& value, const char* token) {
+    size_t len = std::strlen(token);
+    size_t pos = 0;
+    while (pos < value.size()) {
+        size_t end = value.find(',', pos);
+        if (end == std::string::npos) end = value.size();
+
+        const char* b = trimLeft(value.data() + pos, value.data() + end);
+        const char* e = trimRight(b, value.data() + end);
+        if (static_cast<size_t>(e - b) == len && strncasecmp(b, token, len) == 0) {
+            return true;
+        }
+        pos = end + 1;
+    }
+    return false;
+}
+
+}  // namespace
+
+HttpParser::HttpParser(size_t maxHeaderBytes, size_t maxBodyBytes)
+    : max_header_bytes_(maxHeaderBytes), max_body_bytes_(maxBodyBytes) {}
+
+HttpParser::Result HttpParser::parse(const char* data, size_t size, HttpRequest& request, size_t& consumed) {
+    consumed = 0;
+
+    if (header_size_ == 0) {
+        // 只扫描新到达的字节（回退 3 字节以覆盖跨越两次读取的 "\r\n\r\n"）
+        size_t from = scan_offset_ > 3 ? scan_offset_ - 3 : 0;
+        const char* found = nullptr;
+        for (const char* p = data + from; p + 4 <= data + size; ++p) {
+            p = static_cast<const char*>(std::memchr(p, '\r', data + size - p));
+            if (p == nullptr || p + 4 > data + size) {
+                break;
+            }
+            if (p[1] == '\n' && p[2] == '\r' && p[3] == '\n') {
+                found = p;
+                break;
+            }
+        }
+
+        if (found == nullptr) {
+            scan_offset_ = size;
+            if (size > max_header_bytes_) {
+                return fail(431);
+            }
+            return Result::INCOMPLETE;
+        }
+
+        header_size_ = static_cast<size_t>(found - data) + 4;
+        if (header_size_ > max_header_bytes_) {
+            return fail(431);
+        }
+
+        request.clear();
+        if (!parseHead(data, header_size_, request)) {
+            return Result::ERROR;
+        }
+    }
+
+    if (size - header_size_ < content_length_) {
+        return Result::INCOMPLETE;
+    }
+
+    request.body.assign(data + header_size_, content_length_);
+    consumed = header_size_ + content_length_;
+    reset();
+    return Result::COMPLETE;
+}
+
+bool HttpParser::takeContinue() {
+    bool pending = continue_pending_;
+    continue_pending_ = false;
+    return pending;
+}
+
+void HttpParser::reset() {
+    scan_offset_ = 0;
+    header_size_ = 0;
+    content_length_ = 0;
+    continue_pending_ = false;
+    error_status_ = 400;
+}
+
+HttpParser::Result HttpParser::fail(int status) {
+    error_status_ = status;
+    return Result::ERROR;
+}
+
+bool HttpParser::parseHead(const char* data, size_t size, HttpRequest& request) {
+    const char* p = data;
+    const char* end = data + size - 2;  // 去掉最后的空行
+
+    // 容忍请求之间多余的空行
+    while (p + 1 < end && p[0] == '\r' && p[1] == '\n') {
+        p += 2;
+    }
+
+    // ----- 请求行：METHOD SP request-target SP HTTP/1.x -----
+    const char* lineEnd = static_cast<const char*>(std::memchr(p, '\r', end - p));
+    if (lineEnd == nullptr) {
+        fail(400);
+        return false;
+    }
+
+    const char* sp1 = static_cast<const char*>(std::memchr(p, ' ', lineEnd - p));
+    if (sp1 == nullptr || sp1 == p) {
+        fail(400);
+        return false;
+    }
+    for (const char* c = p; c < sp1; ++c) {
+        if (!isTokenChar(*c)) {
+            fail(400);
+            return false;
+        }
+    }
+    request.method.assign(p, sp1);
+
+    const char* target = sp1 + 1;
+    const char* sp2 = static_cast<const char*>(std::memchr(target, ' ', lineEnd - target));
+    if (sp2 == nullptr || sp2 == target) {
+        fail(400);
+        return false;
+    }
+
+    const char* version = sp2 + 1;
+    if (lineEnd - version != 8 || std::memcmp(version, "HTTP/1.", 7) != 0) {
+        fail(lineEnd - version >= 5 && std::memcmp(version, "HTTP/", 5) == 0 ? 505 : 400);
+        return false;
+    }
+    if (version[7] != '0' && version[7] != '1') {
+        fail(505);
+        return false;
+    }
+    request.versionMinor = version[7] - '0';
+
+    const char* question = static_cast<const char*>(std::memchr(target, '?', sp2 - target));
+    const char* pathEnd = question != nullptr ? question : sp2;
+    request.path = urlDecode(std::string(target, pathEnd), false);
+    if (question != nullptr) {
+        request.query.assign(question + 1, sp2);
+    }
+
+    // ----- 请求头 -----
+    p = lineEnd + 2;
+    while (p < end) {
+        lineEnd = static_cast<const char*>(std::memchr(p, '\r', end - p));
+        if (lineEnd == nullptr || lineEnd[1] != '\n') {
+            fail(400);
+            return false;
+        }
+        if (*p == ' ' || *p == '\t') {
+            // 已废弃的多行折叠写法
+            fail(400);
+            return false;
+        }
+
+        const char* colon = static_cast<const char*>(std::memchr(p, ':', lineEnd - p));
+        if (colon == nullptr || colon == p) {
+            fail(400);
+            return false;
+        }
+        for (const char* c = p; c < colon; ++c) {
+            if (!isTokenChar(*c)) {
+                fail(400);
+                return false;
+            }
+        }
+
+        const char* valueBegin = trimLeft(colon + 1, lineEnd);
+        const char* valueEnd = trimRight(valueBegin, lineEnd);
+        request.headers.emplace_back(std::string(p, colon), std::string(valueBegin, valueEnd));
+        p = lineEnd + 2;
+    }
+
+    // ----- 连接语义与报文体长度 -----
+    const std::string* connection = request.header("Connection");
+    if (request.versionMinor == 0) {
+        request.keepAlive = connection != nullptr && containsToken(*connection, "keep-alive");
+    } else {
+        request.keepAlive = connection == nullptr || !containsToken(*connection, "close");
+    }
+
+    if (request.header("Transfer-Encoding") != nullptr) {
+        // 前端只会发送带 Content-Length 的请求体，暂不支持分块上传
+        fail(411);
+        return false;
+    }
+
+    content_length_ = 0;
+    const std::string* length = request.header("Content-Length");
+    if (length != nullptr) {
+        if (length->empty() || length->size() > 19) {
+            fail(400);
+            return false;
+        }
+        size_t value = 0;
+        for (char c : *length) {
+            if (c < '0' || c > '9') {
+                fail(400);
+                return false;
+            }
+            value = value * 10 + static_cast<size_t>(c - '0');
+        }
+        if (value > max_body_bytes_) {
+            fail(413);
+            return false;
+        }
+        content_length_ = value;
+    }
+
+    const std::string* expect = request.header("Expect");
+    if (expect != nullptr && strcasecmp(expect->c_str(), "100-continue") == 0 && content_length_ > 0) {
+        continue_pending_ = true;
+    }
+
+    return true;
+}
+
+}  // namespace musicfree
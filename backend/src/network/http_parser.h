@@ -0,0 +1,72 @@
+#ifndef MUSICFREE_HTTP_PARSER_H
+#define MUSICFREE_HTTP_PARSER_H
+
+#include "http_message.h"
+#include <cstddef>
+
+namespace musicfree {
+
+/**
+ * 增量式 HTTP/1.1 请求解析器
+ *
+ * 每个连接持有一个解析器。数据到达后，用连接输入缓冲区中尚未消费的部分调用
+ * parse()；报文不完整时返回 INCOMPLETE，并记住已经扫描过的位置，下次只扫描
+ * 新到达的字节。一次调用只解析一个请求，流水线（pipelining）请求由调用方
+ * 循环调用直到返回 INCOMPLETE。
+ */
+class HttpParser {
+public:
+    enum class Result {
+        INCOMPLETE = 0,  // 需要更多数据
+        COMPLETE = 1,    // 解析出一个完整请求
+        ERROR = 2        // 报文非法，errorStatus() 给出应答状态码
+    };
+
+    static constexpr size_t kDefaultMaxHeaderBytes = 16 * 1024;
+    static constexpr size_t kDefaultMaxBodyBytes = 64 * 1024 * 1024;
+
+    explicit HttpParser(size_t maxHeaderBytes = kDefaultMaxHeaderBytes,
+                        size_t maxBodyBytes = kDefaultMaxBodyBytes);
+
+    /**
+     * 解析一个请求
+     * @param data 未消费输入的起点（同一请求的多次调用起点必须相同）
+     * @param size 可用字节数
+     * @param request 输出：解析得到的请求
+     * @param consumed 输出：返回 COMPLETE 时该请求占用的字节数
+     * @return 解析结果
+     */
+    Result parse(const char* data, size_t size, HttpRequest& request, size_t& consumed);
+
+    /**
+     * 获取错误对应的 HTTP 状态码（400 / 411 / 413 / 431 / 505 等）
+     */
+    int errorStatus() const { return error_status_; }
+
+    /**
+     * 客户端发送了 "Expect: 100-continue" 且正在等待请求体时返回 true（只返回一次）
+     */
+    bool takeContinue();
+
+    /**
+     * 重置状态，准备解析下一个请求
+     */
+    void reset();
+
+private:
+    bool parseHead(const char* data, size_t size, HttpRequest& request);
+    Result fail(int status);
+
+    size_t max_header_bytes_;
+    size_t max_body_bytes_;
+
+    size_t scan_offset_ = 0;     // 已扫描过的字节数，避免重复查找报文头结尾
+    size_t header_size_ = 0;     // 报文头长度（含空行），0 表示尚未完整
+    size_t content_length_ = 0;
+    bool continue_pending_ = false;
+    int error_status_ = 400;
+};
+
+}  // namespace musicfree
+
+#endif  // MUSICFREE_HTTP_PARSER_H
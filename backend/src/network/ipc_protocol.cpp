@@ -0,0 +1,215 @@
+#include "ipc_protocol.h"
+
+namespace musicfree {
+namespace ipc {
+
+void storeU32(char* bytes, uint32_t value) {
+    for (int i = 0; i < 4; ++i) {
+        bytes[i] = static_cast<char>((value >> (i * 8)) & 0xFF);
+    }
+}
+
+uint32_t loadU32(const char* bytes) {
+    const auto* p = reinterpret_cast<const uint8_t*>(bytes);
+    return uint32_t(p[0]) | (uint32_t(p[1]) << 8) | (uint32_t(p[2]) << 16) | (uint32_t(p[3]) << 24);
+}
+
+// ===== Writer =====
+
+void Writer::writeU8(uint8_t value) {
+    out_.push_back(static_cast<char>(value));
+}
+
+void Writer::writeU16(uint16_t value) {
+    out_.push_back(static_cast<char>(value & 0xFF));
+    out_.push_back(static_cast<char>(value >> 8));
+}
+
+void Writer::writeU32(uint32_t value) {
+    char bytes[4];
+    storeU32(bytes, value);
+    out_.append(bytes, sizeof(bytes));
+}
+
+void Writer::writeI32(int32_t value) {
+    writeU32(static_cast<uint32_t>(value));
+}
+
+void Writer::writeI64(int64_t value) {
+    uint64_t bits = static_cast<uint64_t>(value);
+    writeU32(static_cast<uint32_t>(bits & 0xFFFFFFFFu));
+    writeU32(static_cast<uint32_t>(bits >> 32));
+}
+
+void Writer::writeString(const std::string& value) {
+    writeU32(static_cast<uint32_t>(value.size()));
+    out_ += value;
+}
+
+void Writer::writePlayState(PlayState state) {
+    writeU8(static_cast<uint8_t>(state));
+}
+
+void Writer::writeTrack(const Track& track) {
+    writeString(track.id);
+    writeString(track.title);
+    writeString(track.artist);
+    writeString(track.album);
+    writeString(track.url);
+    writeI32(track.duration);
+    writeString(track.source);
+    writeString(track.coverUrl);
+}
+
+void Writer::writePlaylist(const Playlist& playlist) {
+    writeString(playlist.id);
+    writeString(playlist.name);
+    writeI64(playlist.createdAt);
+    writeI64(playlist.updatedAt);
+    writeU32(static_cast<uint32_t>(playlist.tracks.size()));
+    for (const auto& track : playlist.tracks) {
+        writeTrack(track);
+    }
+}
+
+void Writer::writeAudioInfo(const AudioInfo& info) {
+    writeString(info.title);
+    writeString(info.artist);
+    writeString(info.album);
+    writeI32(info.duration);
+    writeString(info.format);
+}
+
+void Writer::writeStatus(const PlayerStatus& status) {
+    writePlayState(status.state);
+    writeI32(status.position);
+    writeI32(status.volume);
+    writeI32(status.duration);
+    writeU8(status.hasTrack ? 1 : 0);
+    if (status.hasTrack) {
+        writeTrack(status.currentTrack);
+    }
+}
+
+// ===== Reader =====
+
+bool Reader::take(size_t count, const char*& bytes) {
+    if (failed_ || size_ - offset_ < count) {
+        failed_ = true;
+        return false;
+    }
+    bytes = data_ + offset_;
+    offset_ += count;
+    return true;
+}
+
+bool Reader::readU8(uint8_t& value) {
+    const char* bytes = nullptr;
+    if (!take(1, bytes)) return false;
+    value = static_cast<uint8_t>(bytes[0]);
+    return true;
+}
+
+bool Reader::readU16(uint16_t& value) {
+    const char* bytes = nullptr;
+    if (!take(2, bytes)) return false;
+    const auto* p = reinterpret_cast<const uint8_t*>(bytes);
+    value = static_cast<uint16_t>(p[0] | (p[1] << 8));
+    return true;
+}
+
+bool Reader::readU32(uint32_t& value) {
+    const char* bytes = nullptr;
+    if (!take(4, bytes)) return false;
+    value = loadU32(bytes);
+    return true;
+}
+
+bool Reader::readI32(int32_t& value) {
+    uint32_t bits = 0;
+    if (!readU32(bits)) return false;
+    value = static_cast<int32_t>(bits);
+    return true;
+}
+
+bool Reader::readI64(int64_t& value) {
+    uint32_t low = 0;
+    uint32_t high = 0;
+    if (!readU32(low) || !readU32(high)) return false;
+    value = static_cast<int64_t>((uint64_t(high) << 32) | low);
+    return true;
+}
+
+bool Reader::readString(std::string& value) {
+    uint32_t length = 0;
+    const char* bytes = nullptr;
+    if (!readU32(length) || !take(length, bytes)) return false;
+    value.assign(bytes, length);
+    return true;
+}
+
+bool Reader::readPlayState(PlayState& state) {
+    uint8_t value = 0;
+    if (!readU8(value)) return false;
+    if (value > static_cast<uint8_t>(PlayState::PAUSED)) {
+        failed_ = true;
+        return false;
+    }
+    state = static_cast<PlayState>(value);
+    return true;
+}
+
+bool Reader::readTrack(Track& track) {
+    int32_t duration = 0;
+    bool ok = readString(track.id) && readString(track.title) && readString(track.artist) &&
+              readString(track.album) && readString(track.url) && readI32(duration) &&
+              readString(track.source) && readString(track.coverUrl);
+    track.duration = duration;
+    return ok;
+}
+
+bool Reader::readPlaylist(Playlist& playlist) {
+    uint32_t count = 0;
+    if (!readString(playlist.id) || !readString(playlist.name) || !readI64(playlist.createdAt) ||
+        !readI64(playlist.updatedAt) || !readU32(count)) {
+        return false;
+    }
+
+    // 每个轨道至少占 32 字节（7 个空字符串 + 时长），防止伪造的数量导致超大分配
+    if (count > remaining() / 32) {
+        failed_ = true;
+        return false;
+    }
+    playlist.tracks.resize(count);
+    for (auto& track : playlist.tracks) {
+        if (!readTrack(track)) return false;
+    }
+    return true;
+}
+
+bool Reader::readAudioInfo(AudioInfo& info) {
+    int32_t duration = 0;
+    bool ok = readString(info.title) && readString(info.artist) && readString(info.album) &&
+              readI32(duration) && readString(info.format);
+    info.duration = duration;
+    return ok;
+}
+
+bool Reader::readStatus(PlayerStatus& status) {
+    int32_t position = 0;
+    int32_t volume = 0;
+    int32_t duration = 0;
+    uint8_t hasTrack = 0;
+    if (!readPlayState(status.state) || !readI32(position) || !readI32(volume) ||
+        !readI32(duration) || !readU8(hasTrack)) {
+        return false;
+    }
+    status.position = position;
+    status.volume = volume;
+    status.duration = duration;
+    status.hasTrack = hasTrack != 0;
+    return !status.hasTrack || readTrack(status.currentTrack);
+}
+
+}  // namespace ipc
+}  // namespace musicfree
@@ -0,0 +1,127 @@
+#ifndef MUSICFREE_IPC_PROTOCOL_H
+#define MUSICFREE_IPC_PROTOCOL_H
+
+#include "../include/audio_engine.h"
+#include "../include/playlist_manager.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace musicfree {
+
+/**
+ * 本地前端使用的二进制协议（Unix 域套接字）
+ *
+ * 所有整数均为小端序：
+ *   帧      u32 帧体长度（不含这 4 字节） + 帧体
+ *   请求体  u32 请求号 + u16 操作码 + 参数
+ *   应答体  u32 请求号 + u16 状态码（与 HTTP 状态码一致） + 结果
+ *           状态码不是 2xx 时结果为一个字符串形式的错误信息
+ *   字符串  u32 字节数 + UTF-8 字节
+ *
+ * 同一连接上可以连续发送多个请求，应答按请求顺序返回。
+ */
+namespace ipc {
+
+constexpr uint32_t kMaxFrameSize = 16 * 1024 * 1024;
+
+enum class Opcode : uint16_t {
+    // 播放控制
+    PLAYER_LOAD = 0x01,      // string filePath               → Track
+    PLAYER_PLAY = 0x02,      //                               → PlayerStatus
+    PLAYER_PAUSE = 0x03,     //                               → PlayerStatus
+    PLAYER_STOP = 0x04,      //                               → PlayerStatus
+    PLAYER_SEEK = 0x05,      // i32 position（毫秒）           → PlayerStatus
+    PLAYER_VOLUME = 0x06,    // i32 volume（0-100）            → PlayerStatus
+    PLAYER_STATUS = 0x07,    //                               → PlayerStatus
+    AUDIO_INFO = 0x08,       //                               → AudioInfo
+
+    // 播放列表
+    PLAYLIST_GET = 0x20,     //                               → Playlist
+    PLAYLIST_ADD = 0x21,     // Track                         → Playlist
+    PLAYLIST_REMOVE = 0x22,  // i32 index                     → Playlist
+    PLAYLIST_CLEAR = 0x23,   //                               → Playlist
+    PLAYLIST_NEXT = 0x24,    //                               → Track
+    PLAYLIST_PREV = 0x25     //                               → Track
+};
+
+/**
+ * 播放器状态，对应 GET /api/player/status
+ * 编码：PlayState + i32 position + i32 volume + i32 duration + u8 hasTrack [+ Track]
+ */
+struct PlayerStatus {
+    PlayState state = PlayState::STOPPED;
+    int position = 0;
+    int volume = 0;
+    int duration = 0;
+    bool hasTrack = false;
+    Track currentTrack;
+};
+
+/**
+ * 向缓冲区追加编码后的数据
+ */
+class Writer {
+public:
+    explicit Writer(std::string& out) : out_(out) {}
+
+    void writeU8(uint8_t value);
+    void writeU16(uint16_t value);
+    void writeU32(uint32_t value);
+    void writeI32(int32_t value);
+    void writeI64(int64_t value);
+    void writeString(const std::string& value);
+
+    void writePlayState(PlayState state);
+    void writeTrack(const Track& track);
+    void writePlaylist(const Playlist& playlist);
+    void writeAudioInfo(const AudioInfo& info);
+    void writeStatus(const PlayerStatus& status);
+
+private:
+    std::string& out_;
+};
+
+/**
+ * 从帧体中按顺序解码
+ * 每个 read 函数在数据不足或格式错误时返回 false，之后的读取全部失败
+ */
+class Reader {
+public:
+    Reader(const char* data, size_t size) : data_(data), size_(size) {}
+
+    bool readU8(uint8_t& value);
+    bool readU16(uint16_t& value);
+    bool readU32(uint32_t& value);
+    bool readI32(int32_t& value);
+    bool readI64(int64_t& value);
+    bool readString(std::string& value);
+
+    bool readPlayState(PlayState& state);
+    bool readTrack(Track& track);
+    bool readPlaylist(Playlist& playlist);
+    bool readAudioInfo(AudioInfo& info);
+    bool readStatus(PlayerStatus& status);
+
+    size_t remaining() const { return size_ - offset_; }
+
+private:
+    bool take(size_t count, const char*& bytes);
+
+    const char* data_;
+    size_t size_;
+    size_t offset_ = 0;
+    bool failed_ = false;
+};
+
+/**
+ * 读写帧头中的 u32 长度
+ */
+void storeU32(char* bytes, uint32_t value);
+uint32_t loadU32(const char* bytes);
+
+}  // namespace ipc
+
+}  // namespace musicfree
+
+#endif  // MUSICFREE_IPC_PROTOCOL_H
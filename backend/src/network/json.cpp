@@ -0,0 +1,342 @@
+#include "json.h"
+#include "json_writer.h"
+#include <cstdlib>
+
+namespace musicfree {
+
+namespace {
+
+class JsonParser {
+public:
+    explicit JsonParser(const std::string& text) : p_(text.data()), end_(text.data() + text.size()) {}
+
+    bool parseDocument(JsonValue& out) {
+        if (!parseValue(out, 0)) {
+            return false;
+        }
+        skipWhitespace();
+        return p_ == end_;
+    }
+
+private:
+    static constexpr int kMaxDepth = 64;
+
+    void skipWhitespace() {
+        while (p_ < end_ && (*p_ == ' ' || *p_ == '\t' || *p_ == '\n' || *p_ == '\r')) {
+            ++p_;
+        }
+    }
+
+    bool consume(char c) {
+        skipWhitespace();
+        if (p_ < end_ && *p_ == c) {
+            ++p_;
+            return true;
+        }
+        return false;
+    }
+
+    bool matchLiteral(const char* literal) {
+        const char* q = p_;
+        for (; *literal != '\0'; ++literal, ++q) {
+            if (q >= end_ || *q != *literal) {
+                return false;
+            }
+        }
+        p_ = q;
+        return true;
+    }
+
+    bool parseValue(JsonValue& out, int depth) {
+        if (depth > kMaxDepth) {
+            return false;
+        }
+
+        skipWhitespace();
+        if (p_ >= end_) {
+            return false;
+        }
+
+        switch (*p_) {
+            case '{': return parseObject(out, depth);
+            case '[': return parseArray(out, depth);
+            case '"':
+                out.type = JsonValue::Type::STRING;
+                return parseString(out.string);
+            case 't':
+                out.type = JsonValue::Type::BOOLEAN;
+                out.boolean = true;
+                return matchLiteral("true");
+            case 'f':
+                out.type = JsonValue::Type::BOOLEAN;
+                out.boolean = false;
+                return matchLiteral("false");
+            case 'n':
+                out.type = JsonValue::Type::NUL;
+                return matchLiteral("null");
+            default:
+                return parseNumber(out);
+        }
+    }
+
+    bool parseObject(JsonValue& out, int depth) {
+        out.type = JsonValue::Type::OBJECT;
+        ++p_;  // '{'
+
+        if (consume('}')) {
+            return true;
+        }
+
+        do {
+            skipWhitespace();
+            std::pair<std::string, JsonValue> member;
+            if (p_ >= end_ || *p_ != '"' || !parseString(member.first)) {
+                return false;
+            }
+            if (!consume(':') || !parseValue(member.second, depth + 1)) {
+                return false;
+            }
+            out.object.push_back(std::move(member));
+        } while (consume(','));
+
+        return consume('}');
+    }
+
+    bool parseArray(JsonValue& out, int depth) {
+        out.type = JsonValue::Type::ARRAY;
+        ++p_;  // '['
+
+        if (consume(']')) {
+            return true;
+        }
+
+        do {
+            JsonValue element;
+            if (!parseValue(element, depth + 1)) {
+                return false;
+            }
+            out.array.push_back(std::move(element));
+        } while (consume(','));
+
+        return consume(']');
+    }
+
+    bool parseHex4(unsigned& code) {
+        if (end_ - p_ < 4) {
+            return false;
+        }
+        code = 0;
+        for (int i = 0; i < 4; ++i) {
+            char c = *p_++;
+            code <<= 4;
+            if (c >= '0' && c <= '9') code |= c - '0';
+            else if (c >= 'a' && c <= 'f') code |= c - 'a' + 10;
+            else if (c >= 'A' && c <= 'F') code |= c - 'A' + 10;
+            else return false;
+        }
+        return true;
+    }
+
+    static void appendUtf8(std::string& out, unsigned code) {
+        if (code < 0x80) {
+            out.push_back(static_cast<char>(code));
+        } else if (code < 0x800) {
+            out.push_back(static_cast<char>(0xC0 | (code >> 6)));
+            out.push_back(static_cast<char>(0x80 | (code & 0x3F)));
+        } else if (code < 0x10000) {
+            out.push_back(static_cast<char>(0xE0 | (code >> 12)));
+            out.push_back(static_cast<char>(0x80 | ((code >> 6) & 0x3F)));
+            out.push_back(static_cast<char>(0x80 | (code & 0x3F)));
+        } else {
+            out.push_back(static_cast<char>(0xF0 | (code >> 18)));
+            out.push_back(static_cast<char>(0x80 | ((code >> 12) & 0x3F)));
+            out.push_back(static_cast<char>(0x80 | ((code >> 6) & 0x3F)));
+            out.push_back(static_cast<char>(0x80 | (code & 0x3F)));
+        }
+    }
+
+    bool parseString(std::string& out) {
+        ++p_;  // '"'
+        out.clear();
+
+        while (p_ < end_) {
+            char c = *p_++;
+            if (c == '"') {
+                return true;
+            }
+            if (static_cast<unsigned char>(c) < 0x20) {
+                return false;
+            }
+            if (c != '\\') {
+                out.push_back(c);
+                continue;
+            }
+
+            if (p_ >= end_) {
+                return false;
+            }
+            char e = *p_++;
+            switch (e) {
+                case '"':  out.push_back('"'); break;
+                case '\\': out.push_back('\\'); break;
+                case '/':  out.push_back('/'); break;
+                case 'b':  out.push_back('\b'); break;
+                case 'f':  out.push_back('\f'); break;
+                case 'n':  out.push_back('\n'); break;
+                case 'r':  out.push_back('\r'); break;
+                case 't':  out.push_back('\t'); break;
+                case 'u': {
+                    unsigned code = 0;
+                    if (!parseHex4(code)) {
+                        return false;
+                    }
+                    // UTF-16 代理对
+                    if (code >= 0xD800 && code < 0xDC00) {
+                        unsigned low = 0;
+                        if (end_ - p_ < 2 || p_[0] != '\\' || p_[1] != 'u') {
+                            return false;
+                        }
+                        p_ += 2;
+                        if (!parseHex4(low) || low < 0xDC00 || low >= 0xE000) {
+                            return false;
+                        }
+                        code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+                    }
+                    appendUtf8(out, code);
+                    break;
+                }
+                default:
+                    return false;
+            }
+        }
+        return false;
+    }
+
+    bool parseNumber(JsonValue& out) {
+        const char* start = p_;
+        if (p_ < end_ && *p_ == '-') ++p_;
+        while (p_ < end_ && ((*p_ >= '0' && *p_ <= '9') || *p_ == '.' || *p_ == 'e' ||
+                             *p_ == 'E' || *p_ == '+' || *p_ == '-')) {
+            ++p_;
+        }
+        if (p_ == start) {
+            return false;
+        }
+
+        std::string literal(start, p_);
+        char* parsedEnd = nullptr;
+        out.type = JsonValue::Type::NUMBER;
+        out.number = std::strtod(literal.c_str(), &parsedEnd);
+        return parsedEnd == literal.c_str() + literal.size();
+    }
+
+    const char* p_;
+    const char* end_;
+};
+
+}  // namespace
+
+// ===== JsonValue =====
+
+const JsonValue* JsonValue::find(const std::string& key) const {
+    if (type != Type::OBJECT) {
+        return nullptr;
+    }
+    for (const auto& member : object) {
+        if (member.first == key) {
+            return &member.second;
+        }
+    }
+    return nullptr;
+}
+
+std::string JsonValue::getString(const std::string& key, const std::string& defaultValue) const {
+    const JsonValue* value = find(key);
+    if (value == nullptr || value->type != Type::STRING) {
+        return defaultValue;
+    }
+    return value->string;
+}
+
+double JsonValue::getNumber(const std::string& key, double defaultValue) const {
+    const JsonValue* value = find(key);
+    if (value == nullptr || value->type != Type::NUMBER) {
+        return defaultValue;
+    }
+    return value->number;
+}
+
+bool parseJson(const std::string& text, JsonValue& out) {
+    out = JsonValue();
+    JsonParser parser(text);
+    return parser.parseDocument(out);
+}
+
+bool jsonToTrack(const JsonValue& value, Track& track) {
+    const JsonValue* id = value.find("id");
+    if (id == nullptr || id->type != JsonValue::Type::STRING) {
+        return false;
+    }
+
+    track.id = id->string;
+    track.title = value.getString("title");
+    track.artist = value.getString("artist");
+    track.album = value.getString("album");
+    track.url = value.getString("url");
+    track.duration = static_cast<int>(value.getNumber("duration"));
+    track.source = value.getString("source");
+    track.coverUrl = value.getString("coverUrl");
+    return true;
+}
+
+// ===== 序列化 =====
+
+void appendJsonString(std::string& out, const std::string& text) {
+    appendJsonString(out, text.data(), text.size());
+}
+
+void appendJson(std::string& out, const Track& track) {
+    JsonWriter writer(out);
+    writeJson(writer, track);
+}
+
+void appendJson(std::string& out, const std::vector<Track>& tracks) {
+    JsonWriter writer(out);
+    writeJson(writer, tracks);
+}
+
+void appendJson(std::string& out, const Playlist& playlist) {
+    JsonWriter writer(out);
+    writeJson(writer, playlist);
+}
+
+const char* playStateName(PlayState state) {
+    switch (state) {
+        case PlayState::PLAYING: return "playing";
+        case PlayState::PAUSED:  return "paused";
+        case PlayState::STOPPED:
+        default:                 return "stopped";
+    }
+}
+
+const char* playModeName(PlayMode mode) {
+    switch (mode) {
+        case PlayMode::REPEAT_ALL: return "repeatAll";
+        case PlayMode::REPEAT_ONE: return "repeatOne";
+        case PlayMode::SHUFFLE:    return "shuffle";
+        case PlayMode::ORDER:
+        default:                   return "order";
+    }
+}
+
+bool parsePlayMode(const std::string& name, PlayMode& mode) {
+    for (PlayMode candidate : {PlayMode::ORDER, PlayMode::REPEAT_ALL, PlayMode::REPEAT_ONE, PlayMode::SHUFFLE}) {
+        if (name == playModeName(candidate)) {
+            mode = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+}  // namespace musicfree
@@ -0,0 +1,84 @@
+#ifndef MUSICFREE_JSON_H
+#define MUSICFREE_JSON_H
+
+#include "../include/audio_engine.h"
+#include "../include/playlist_manager.h"
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace musicfree {
+
+/**
+ * 简单的 JSON 值（DOM）
+ * 用于解析前端发来的请求体
+ */
+class JsonValue {
+public:
+    enum class Type {
+        NUL = 0,
+        BOOLEAN = 1,
+        NUMBER = 2,
+        STRING = 3,
+        ARRAY = 4,
+        OBJECT = 5
+    };
+
+    Type type = Type::NUL;
+    bool boolean = false;
+    double number = 0;
+    std::string string;
+    std::vector<JsonValue> array;
+    std::vector<std::pair<std::string, JsonValue>> object;
+
+    bool isObject() const { return type == Type::OBJECT; }
+    bool isArray() const { return type == Type::ARRAY; }
+
+    /**
+     * 查找对象成员
+     * @param key 成员名
+     * @return 成员值，不存在或不是对象时返回 nullptr
+     */
+    const JsonValue* find(const std::string& key) const;
+
+    std::string getString(const std::string& key, const std::string& defaultValue = "") const;
+    double getNumber(const std::string& key, double defaultValue = 0) const;
+};
+
+/**
+ * 解析 JSON 文本
+ * @param text JSON 文本
+ * @param out 输出：解析结果
+ * @return 成功返回 true
+ */
+bool parseJson(const std::string& text, JsonValue& out);
+
+/**
+ * 从 JSON 对象读取轨道信息
+ * @param value JSON 对象
+ * @param track 输出：轨道信息
+ * @return value 是对象且包含字符串类型的 id 时返回 true
+ */
+bool jsonToTrack(const JsonValue& value, Track& track);
+
+// ===== 序列化 =====
+
+void appendJsonString(std::string& out, const std::string& text);
+void appendJson(std::string& out, const Track& track);
+void appendJson(std::string& out, const std::vector<Track>& tracks);
+void appendJson(std::string& out, const Playlist& playlist);
+
+/**
+ * 播放状态转换为前端使用的字符串（"playing" / "paused" / "stopped"）
+ */
+const char* playStateName(PlayState state);
+
+/**
+ * 播放模式与前端使用的字符串（"order" / "repeatAll" / "repeatOne" / "shuffle"）互相转换
+ */
+const char* playModeName(PlayMode mode);
+bool parsePlayMode(const std::string& name, PlayMode& mode);
+
+}  // namespace musicfree
+
+#endif  // MUSICFREE_JSON_H
@@ -0,0 +1,349 @@
+#include "json_writer.h"
+#include <algorithm>
+#include <cstring>
+
+namespace musicfree {
+
+namespace {
+
+// 块头："XXXXXXXX\r\n"，8 位十六进制长度（允许前导零）
+constexpr size_t kChunkHeaderSize = 10;
+constexpr size_t kMinGrowth = 64 * 1024;
+
+const char* kHex = "0123456789abcdef";
+
+// 需要转义的字节：控制字符、引号和反斜杠
+struct EscapeTable {
+    bool needs[256] = {};
+    EscapeTable() {
+        for (int c = 0; c < 0x20; ++c) needs[c] = true;
+        needs[static_cast<unsigned char>('"')] = true;
+        needs[static_cast<unsigned char>('\\')] = true;
+    }
+};
+
+const EscapeTable kEscape;
+
+constexpr uint64_t kOnes = 0x0101010101010101ULL;
+constexpr uint64_t kHighBits = 0x8080808080808080ULL;
+
+/**
+ * 8 个字节中是否可能有需要转义的字节（控制字符、'"'、'\\'）
+ * 只用于快速排除，结果为真时再逐字节检查
+ */
+inline bool mayNeedEscape(uint64_t x) {
+    uint64_t control = (x - kOnes * 0x20) & ~x & kHighBits;
+    uint64_t quote = x ^ (kOnes * '"');
+    uint64_t backslash = x ^ (kOnes * '\\');
+    quote = (quote - kOnes) & ~quote & kHighBits;
+    backslash = (backslash - kOnes) & ~backslash & kHighBits;
+    return (control | quote | backslash) != 0;
+}
+
+inline char* escapeByte(char* dst, unsigned char c) {
+    if (!kEscape.needs[c]) {
+        *dst++ = static_cast<char>(c);
+        return dst;
+    }
+
+    *dst++ = '\\';
+    switch (c) {
+        case '"':  *dst++ = '"'; break;
+        case '\\': *dst++ = '\\'; break;
+        case '\b': *dst++ = 'b'; break;
+        case '\f': *dst++ = 'f'; break;
+        case '\n': *dst++ = 'n'; break;
+        case '\r': *dst++ = 'r'; break;
+        case '\t': *dst++ = 't'; break;
+        default:
+            *dst++ = 'u';
+            *dst++ = '0';
+            *dst++ = '0';
+            *dst++ = kHex[c >> 4];
+            *dst++ = kHex[c & 0xF];
+    }
+    return dst;
+}
+
+template <size_t N>
+inline char* writeLiteral(char* dst, const char (&text)[N]) {
+    std::memcpy(dst, text, N - 1);
+    return dst + N - 1;
+}
+
+}  // namespace
+
+char* writeJsonInteger(char* dst, int64_t number) {
+    char digits[24];
+    int n = 0;
+    uint64_t magnitude = number < 0 ? 0 - static_cast<uint64_t>(number) : static_cast<uint64_t>(number);
+    do {
+        digits[n++] = static_cast<char>('0' + magnitude % 10);
+        magnitude /= 10;
+    } while (magnitude > 0);
+    if (number < 0) {
+        digits[n++] = '-';
+    }
+
+    for (int i = n - 1; i >= 0; --i) {
+        *dst++ = digits[i];
+    }
+    return dst;
+}
+
+char* writeJsonString(char* dst, const char* text, size_t size) {
+    *dst++ = '"';
+
+    size_t i = 0;
+    while (i + 8 <= size) {
+        uint64_t block;
+        std::memcpy(&block, text + i, sizeof(block));
+        if (!mayNeedEscape(block)) {
+            std::memcpy(dst, &block, sizeof(block));
+            dst += 8;
+            i += 8;
+            continue;
+        }
+        for (size_t end = i + 8; i < end; ++i) {
+            dst = escapeByte(dst, static_cast<unsigned char>(text[i]));
+        }
+    }
+    for (; i < size; ++i) {
+        dst = escapeByte(dst, static_cast<unsigned char>(text[i]));
+    }
+
+    *dst++ = '"';
+    return dst;
+}
+
+void appendJsonString(std::string& out, const char* text, size_t size) {
+    size_t offset = out.size();
+    out.resize(offset + size * 6 + 2);
+    char* end = writeJsonString(&out[offset], text, size);
+    out.resize(static_cast<size_t>(end - out.data()));
+}
+
+// ===== JsonWriter =====
+
+JsonWriter::JsonWriter(std::string& out, bool chunked) : out_(out), pos_(out.size()), chunked_(chunked) {
+    if (chunked_) {
+        openChunk();
+    }
+}
+
+JsonWriter::~JsonWriter() {
+    out_.resize(pos_);
+}
+
+void JsonWriter::grow(size_t bytes) {
+    size_t needed = pos_ + bytes;
+    out_.resize(std::max(needed, std::max(out_.size() * 2, pos_ + kMinGrowth)));
+}
+
+void JsonWriter::append(const char* text, size_t size) {
+    std::memcpy(ensure(size), text, size);
+    pos_ += size;
+}
+
+void JsonWriter::separate() {
+    if (after_key_) {
+        after_key_ = false;
+        return;
+    }
+    uint64_t bit = uint64_t(1) << (depth_ & 63);
+    if (has_items_ & bit) {
+        *ensure(1) = ',';
+        ++pos_;
+    }
+    has_items_ |= bit;
+}
+
+void JsonWriter::afterValue() {
+    if (chunked_ && pos_ - chunk_start_ - kChunkHeaderSize >= kChunkSize) {
+        closeChunk();
+        openChunk();
+    }
+}
+
+void JsonWriter::beginObject() {
+    separate();
+    append("{", 1);
+    ++depth_;
+    has_items_ &= ~(uint64_t(1) << (depth_ & 63));
+}
+
+void JsonWriter::endObject() {
+    --depth_;
+    append("}", 1);
+    afterValue();
+}
+
+void JsonWriter::beginArray() {
+    separate();
+    append("[", 1);
+    ++depth_;
+    has_items_ &= ~(uint64_t(1) << (depth_ & 63));
+}
+
+void JsonWriter::endArray() {
+    --depth_;
+    append("]", 1);
+    afterValue();
+}
+
+void JsonWriter::value(const std::string& text) {
+    separate();
+    char* begin = ensure(text.size() * 6 + 2);
+    pos_ += static_cast<size_t>(writeJsonString(begin, text.data(), text.size()) - begin);
+    afterValue();
+}
+
+void JsonWriter::value(const char* text) {
+    separate();
+    size_t size = std::strlen(text);
+    char* begin = ensure(size * 6 + 2);
+    pos_ += static_cast<size_t>(writeJsonString(begin, text, size) - begin);
+    afterValue();
+}
+
+void JsonWriter::value(int64_t number) {
+    separate();
+    char* begin = ensure(20);
+    pos_ += static_cast<size_t>(writeJsonInteger(begin, number) - begin);
+    afterValue();
+}
+
+void JsonWriter::value(bool flag) {
+    separate();
+    if (flag) {
+        append("true", 4);
+    } else {
+        append("false", 5);
+    }
+    afterValue();
+}
+
+void JsonWriter::null() {
+    separate();
+    append("null", 4);
+    afterValue();
+}
+
+void JsonWriter::raw(const std::string& json) {
+    separate();
+    append(json.data(), json.size());
+    afterValue();
+}
+
+char* JsonWriter::beginRaw(size_t bytes) {
+    separate();
+    return ensure(bytes);
+}
+
+void JsonWriter::endRaw(char* end) {
+    pos_ = static_cast<size_t>(end - out_.data());
+    afterValue();
+}
+
+void JsonWriter::reserve(size_t bytes) {
+    if (chunked_) {
+        bytes += (bytes / kChunkSize + 2) * (kChunkHeaderSize + 2) + 5;
+    }
+    ensure(bytes);
+}
+
+void JsonWriter::finish() {
+    if (chunked_) {
+        closeChunk();
+        append("0\r\n\r\n", 5);
+        chunked_ = false;
+    }
+    out_.resize(pos_);
+}
+
+void JsonWriter::openChunk() {
+    chunk_start_ = pos_;
+    char* p = ensure(kChunkHeaderSize);
+    std::memset(p, '0', 8);
+    p[8] = '\r';
+    p[9] = '\n';
+    pos_ += kChunkHeaderSize;
+}
+
+void JsonWriter::closeChunk() {
+    size_t size = pos_ - chunk_start_ - kChunkHeaderSize;
+    if (size == 0) {
+        // 空块会被当作结束块，直接去掉占位
+        pos_ = chunk_start_;
+        return;
+    }
+    for (int i = 7; i >= 0; --i) {
+        out_[chunk_start_ + i] = kHex[size & 0xF];
+        size >>= 4;
+    }
+    append("\r\n", 2);
+}
+
+// ===== 数据结构 =====
+
+void writeJson(JsonWriter& writer, const Track& track) {
+    // 播放列表的热点：按最坏情况（每个字节都转义成 \uXXXX）一次预留，然后直接写入
+    size_t text = track.id.size() + track.title.size() + track.artist.size() + track.album.size() +
+                  track.url.size() + track.source.size() + track.coverUrl.size();
+    char* p = writer.beginRaw(text * 6 + 128);
+
+    p = writeLiteral(p, "{\"id\":");
+    p = writeJsonString(p, track.id.data(), track.id.size());
+    p = writeLiteral(p, ",\"title\":");
+    p = writeJsonString(p, track.title.data(), track.title.size());
+    p = writeLiteral(p, ",\"artist\":");
+    p = writeJsonString(p, track.artist.data(), track.artist.size());
+    p = writeLiteral(p, ",\"album\":");
+    p = writeJsonString(p, track.album.data(), track.album.size());
+    p = writeLiteral(p, ",\"url\":");
+    p = writeJsonString(p, track.url.data(), track.url.size());
+    p = writeLiteral(p, ",\"duration\":");
+    p = writeJsonInteger(p, track.duration);
+    p = writeLiteral(p, ",\"source\":");
+    p = writeJsonString(p, track.source.data(), track.source.size());
+    p = writeLiteral(p, ",\"coverUrl\":");
+    p = writeJsonString(p, track.coverUrl.data(), track.coverUrl.size());
+    *p++ = '}';
+
+    writer.endRaw(p);
+}
+
+void writeJson(JsonWriter& writer, const std::vector<Track>& tracks) {
+    writer.beginArray();
+    for (const auto& track : tracks) {
+        writeJson(writer, track);
+    }
+    writer.endArray();
+}
+
+void writeJson(JsonWriter& writer, const Playlist& playlist) {
+    writer.beginObject();
+    writer.key("id");
+    writer.value(playlist.id);
+    writer.key("name");
+    writer.value(playlist.name);
+    writer.key("tracks");
+    writeJson(writer, playlist.tracks);
+    writer.key("createdAt");
+    writer.value(playlist.createdAt);
+    writer.key("updatedAt");
+    writer.value(playlist.updatedAt);
+    writer.endObject();
+}
+
+size_t estimateJsonSize(const std::vector<Track>& tracks) {
+    // 8 个键、引号和分隔符约 90 字节，时长最多 11 字节
+    size_t bytes = 2;
+    for (const auto& track : tracks) {
+        bytes += 101 + track.id.size() + track.title.size() + track.artist.size() + track.album.size() +
+                 track.url.size() + track.source.size() + track.coverUrl.size();
+    }
+    return bytes;
+}
+
+}  // namespace musicfree
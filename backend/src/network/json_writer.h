@@ -0,0 +1,157 @@
+#ifndef MUSICFREE_JSON_WRITER_H
+#define MUSICFREE_JSON_WRITER_H
+
+#include "../include/playlist_manager.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace musicfree {
+
+/**
+ * 流式 JSON 写入器
+ *
+ * 直接向输出缓冲区（通常就是连接的发送缓冲区）追加 JSON 文本，不构造中间字符串或 DOM。
+ * 逗号由写入器按嵌套层级自动插入。
+ *
+ * 写入期间输出缓冲区按块扩容，超出已写入部分的字节是未定义内容；每次写入只按最坏情况
+ * 检查一次剩余空间，然后通过指针直接写入。finish() 或析构时把缓冲区截断到实际长度，
+ * 在此之前调用方不能直接修改输出缓冲区。
+ *
+ * chunked 模式下输出同时按 HTTP/1.1 分块传输编码分帧：每个块先写入定长的块头占位，
+ * 块写满 kChunkSize 后回填长度再开始下一块，finish() 写入结束块。
+ */
+class JsonWriter {
+public:
+    static constexpr size_t kChunkSize = 64 * 1024;
+
+    /**
+     * @param out 输出缓冲区，写入内容追加在末尾
+     * @param chunked 是否按分块传输编码分帧
+     */
+    explicit JsonWriter(std::string& out, bool chunked = false);
+    ~JsonWriter();
+
+    // 禁止拷贝
+    JsonWriter(const JsonWriter&) = delete;
+    JsonWriter& operator=(const JsonWriter&) = delete;
+
+    void beginObject();
+    void endObject();
+    void beginArray();
+    void endArray();
+
+    /**
+     * 写入对象的键，名称必须是不需要转义的字面量
+     */
+    template <size_t N>
+    void key(const char (&name)[N]) {
+        separate();
+        char* p = ensure(N + 2);
+        *p++ = '"';
+        for (size_t i = 0; i + 1 < N; ++i) {
+            *p++ = name[i];
+        }
+        *p++ = '"';
+        *p++ = ':';
+        pos_ += N + 2;
+        after_key_ = true;
+    }
+
+    void value(const std::string& text);
+    void value(const char* text);
+    void value(int64_t number);
+    void value(int number) { value(static_cast<int64_t>(number)); }
+    void value(bool flag);
+    void null();
+
+    /**
+     * 写入一段已经是合法 JSON 的文本
+     */
+    void raw(const std::string& json);
+
+    /**
+     * 原始写入：在当前位置写入一个完整的值（会先写入需要的逗号）
+     * 用于热点路径一次检查剩余空间后直接写入多个字段，写完后必须调用 endRaw
+     * @param bytes 最多写入的字节数
+     * @return 写入位置
+     */
+    char* beginRaw(size_t bytes);
+
+    /**
+     * 提交原始写入
+     * @param end 写入内容的末尾
+     */
+    void endRaw(char* end);
+
+    /**
+     * 预留输出缓冲区空间，避免序列化大列表时反复扩容
+     */
+    void reserve(size_t bytes);
+
+    /**
+     * 结束输出：chunked 模式下回填最后一块并写入结束块，并把缓冲区截断到实际长度
+     */
+    void finish();
+
+private:
+    /**
+     * 保证从当前位置起至少有 bytes 字节可写
+     * @return 写入位置，写完后由调用方推进 pos_
+     */
+    char* ensure(size_t bytes) {
+        if (out_.size() - pos_ < bytes) {
+            grow(bytes);
+        }
+        return &out_[pos_];
+    }
+
+    void grow(size_t bytes);
+    void append(const char* text, size_t size);
+    void separate();
+    void afterValue();
+    void openChunk();
+    void closeChunk();
+
+    std::string& out_;
+    size_t pos_;              // 已写入内容的末尾
+    bool chunked_;
+    size_t chunk_start_ = 0;  // 当前块头占位的位置
+    int depth_ = 0;
+    bool after_key_ = false;
+    uint64_t has_items_ = 0;  // 每层一位：该层是否已经写入过元素（嵌套不超过 63 层）
+};
+
+/**
+ * 写入带引号并转义的 JSON 字符串
+ * 每次检查 8 个字节，不含需要转义字符的整段直接复制
+ * @param dst 写入位置，至少有 size * 6 + 2 字节可写
+ * @return 写入内容的末尾
+ */
+char* writeJsonString(char* dst, const char* text, size_t size);
+
+/**
+ * 写入十进制整数
+ * @param dst 写入位置，至少有 20 字节可写
+ * @return 写入内容的末尾
+ */
+char* writeJsonInteger(char* dst, int64_t number);
+
+/**
+ * 追加带引号并转义的 JSON 字符串
+ */
+void appendJsonString(std::string& out, const char* text, size_t size);
+
+void writeJson(JsonWriter& writer, const Track& track);
+void writeJson(JsonWriter& writer, const std::vector<Track>& tracks);
+void writeJson(JsonWriter& writer, const Playlist& playlist);
+
+/**
+ * 估算序列化后的大小，用于预留缓冲区
+ */
+size_t estimateJsonSize(const std::vector<Track>& tracks);
+
+}  // namespace musicfree
+
+#endif  // MUSICFREE_JSON_WRITER_H
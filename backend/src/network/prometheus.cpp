@@ -0,0 +1,130 @@
+#include "prometheus.h"
+#include <cstdio>
+
+namespace musicfree {
+
+namespace {
+
+// 直方图的上界（纳秒）：覆盖缓存命中的几十微秒到大文件流式发送的数秒
+constexpr uint64_t kBucketBounds[] = {
+    10000,      25000,      50000,      100000,      250000,      500000,
+    1000000,    2500000,    5000000,    10000000,    25000000,    50000000,
+    100000000,  250000000,  500000000,  1000000000,  2500000000,  10000000000,
+};
+
+constexpr double kQuantiles[] = {0.5, 0.9, 0.99, 0.999};
+
+void appendEscaped(std::string& out, std::string_view value) {
+    for (char c : value) {
+        switch (c) {
+            case '\\': out += "\\\\"; break;
+            case '"': out += "\\\""; break;
+            case '\n': out += "\\n"; break;
+            default: out.push_back(c); break;
+        }
+    }
+}
+
+}  // namespace
+
+void PrometheusWriter::family(const char* name, const char* type, const char* help) {
+    out_ += "# HELP ";
+    out_ += name;
+    out_.push_back(' ');
+    out_ += help;
+    out_ += "\n# TYPE ";
+    out_ += name;
+    out_.push_back(' ');
+    out_ += type;
+    out_.push_back('\n');
+}
+
+void PrometheusWriter::sample(const char* name, MetricLabels labels, uint64_t value) {
+    appendName(name, "", labels);
+    out_ += std::to_string(value);
+    out_.push_back('\n');
+}
+
+void PrometheusWriter::sample(const char* name, MetricLabels labels, double value) {
+    appendName(name, "", labels);
+    appendValue(value);
+    out_.push_back('\n');
+}
+
+void PrometheusWriter::histogram(const char* name, MetricLabels labels, const HistogramSnapshot& histogram) {
+    char bound[32];
+    for (uint64_t nanos : kBucketBounds) {
+        std::snprintf(bound, sizeof(bound), "%g", static_cast<double>(nanos) / 1e9);
+        appendName(name, "_bucket", labels, "le", bound);
+        out_ += std::to_string(histogram.countAtOrBelow(nanos));
+        out_.push_back('\n');
+    }
+    appendName(name, "_bucket", labels, "le", "+Inf");
+    out_ += std::to_string(histogram.count());
+    out_.push_back('\n');
+
+    appendName(name, "_sum", labels);
+    appendValue(static_cast<double>(histogram.sum()) / 1e9);
+    out_.push_back('\n');
+    appendName(name, "_count", labels);
+    out_ += std::to_string(histogram.count());
+    out_.push_back('\n');
+}
+
+void PrometheusWriter::summary(const char* name, MetricLabels labels, const HistogramSnapshot& histogram) {
+    char quantile[16];
+    for (double q : kQuantiles) {
+        std::snprintf(quantile, sizeof(quantile), "%g", q);
+        appendName(name, "", labels, "quantile", quantile);
+        appendValue(static_cast<double>(histogram.quantile(q)) / 1e9);
+        out_.push_back('\n');
+    }
+
+    appendName(name, "_sum", labels);
+    appendValue(static_cast<double>(histogram.sum()) / 1e9);
+    out_.push_back('\n');
+    appendName(name, "_count", labels);
+    out_ += std::to_string(histogram.count());
+    out_.push_back('\n');
+}
+
+void PrometheusWriter::appendName(const char* name, const char* suffix, MetricLabels labels, const char* extraName,
+                                  const char* extraValue) {
+    out_ += name;
+    out_ += suffix;
+    if (labels.size() == 0 && !extraName) {
+        out_.push_back(' ');
+        return;
+    }
+
+    out_.push_back('{');
+    bool first = true;
+    for (const auto& label : labels) {
+        if (!first) {
+            out_.push_back(',');
+        }
+        first = false;
+        out_ += label.first;
+        out_ += "=\"";
+        appendEscaped(out_, label.second);
+        out_.push_back('"');
+    }
+    if (extraName) {
+        if (!first) {
+            out_.push_back(',');
+        }
+        out_ += extraName;
+        out_ += "=\"";
+        out_ += extraValue;
+        out_.push_back('"');
+    }
+    out_ += "} ";
+}
+
+void PrometheusWriter::appendValue(double value) {
+    char text[32];
+    std::snprintf(text, sizeof(text), "%.9g", value);
+    out_ += text;
+}
+
+}  // namespace musicfree
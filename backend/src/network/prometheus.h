@@ -0,0 +1,74 @@
+#ifndef MUSICFREE_PROMETHEUS_H
+#define MUSICFREE_PROMETHEUS_H
+
+#include "../include/metrics.h"
+#include <cstdint>
+#include <initializer_list>
+#include <string>
+#include <string_view>
+#include <utility>
+
+namespace musicfree {
+
+using MetricLabels = std::initializer_list<std::pair<const char*, std::string_view>>;
+
+/**
+ * Prometheus 文本格式（text/plain; version=0.0.4）写入器
+ *
+ * 同一指标族的样本必须连续写入：先 family() 写 HELP / TYPE，再写各个样本。
+ * 耗时直方图以纳秒记录，输出时换算为秒（Prometheus 的基本单位）。
+ */
+class PrometheusWriter {
+public:
+    static constexpr const char* kContentType = "text/plain; version=0.0.4; charset=utf-8";
+
+    /**
+     * @param out 输出缓冲区，写入内容追加在末尾
+     */
+    explicit PrometheusWriter(std::string& out) : out_(out) {}
+
+    /**
+     * 开始一个指标族
+     * @param name 指标名
+     * @param type counter / gauge / histogram / summary
+     * @param help 说明
+     */
+    void family(const char* name, const char* type, const char* help);
+
+    /**
+     * 写入一个样本
+     * @param name 指标名（直方图等需要带 _bucket / _sum 之类的后缀）
+     * @param labels 标签，值会按格式要求转义
+     * @param value 数值
+     */
+    void sample(const char* name, MetricLabels labels, uint64_t value);
+    void sample(const char* name, MetricLabels labels, double value);
+
+    /**
+     * 写入直方图的 _bucket（固定的秒级上界 + "+Inf"）、_sum 和 _count
+     * 各上界的计数按 HDR 桶的上界累计，误差与分桶精度相同
+     * @param name 指标名（不带后缀）
+     * @param labels 标签
+     * @param histogram 耗时直方图（纳秒）
+     */
+    void histogram(const char* name, MetricLabels labels, const HistogramSnapshot& histogram);
+
+    /**
+     * 写入由 HDR 直方图算出的分位数（summary：0.5 / 0.9 / 0.99 / 0.999）、_sum 和 _count
+     * @param name 指标名（不带后缀）
+     * @param labels 标签
+     * @param histogram 耗时直方图（纳秒）
+     */
+    void summary(const char* name, MetricLabels labels, const HistogramSnapshot& histogram);
+
+private:
+    void appendName(const char* name, const char* suffix, MetricLabels labels, const char* extraName = nullptr,
+                    const char* extraValue = nullptr);
+    void appendValue(double value);
+
+    std::string& out_;
+};
+
+}  // namespace musicfree
+
+#endif  // MUSICFREE_PROMETHEUS_H
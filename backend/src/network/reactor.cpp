@@ -0,0 +1,844 @@
+#include "reactor.h"
+#include "ipc_protocol.h"
+#include "websocket.h"
+#include <algorithm>
+#include <exception>
+#include <iostream>
+
+#if defined(__linux__)
+#include <arpa/inet.h>
+#include <cerrno>
+#include <cstring>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/sendfile.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+namespace musicfree {
+
+#if defined(__linux__)
+
+namespace {
+
+constexpr int kMaxEvents = 256;
+constexpr size_t kReadChunk = 64 * 1024;
+constexpr int kMaxReadsPerEvent = 16;                 // 单次事件最多读取 1MB，保证连接间公平
+constexpr size_t kMaxPendingOutput = 4 * 1024 * 1024;  // 输出积压上限
+constexpr size_t kSendfileChunk = 512 * 1024;          // 单次 sendfile 的上限，单次事件最多发送 8MB
+constexpr auto kIdleTimeout = std::chrono::seconds(60);
+constexpr auto kSweepInterval = std::chrono::seconds(1);
+constexpr size_t kStreamHighWater = 64 * 1024;       // 事件流输出积压超过该值时暂缓写入新事件
+constexpr auto kHeartbeatInterval = std::chrono::seconds(15);
+
+// 单写者计数器：只有事件循环线程写入，不需要带 lock 前缀的原子加法
+inline void bump(std::atomic<uint64_t>& counter, uint64_t delta) {
+    counter.store(counter.load(std::memory_order_relaxed) + delta, std::memory_order_relaxed);
+}
+
+const char* kSseHead =
+    "HTTP/1.1 200 OK\r\n"
+    "Content-Type: text/event-stream\r\n"
+    "Cache-Control: no-cache\r\n"
+    "Access-Control-Allow-Origin: *\r\n"
+    "Connection: keep-alive\r\n\r\n"
+    "retry: 2000\n\n";
+
+}  // namespace
+
+Reactor::Connection::~Connection() {
+    if (fileFd >= 0) {
+        ::close(fileFd);
+    }
+}
+
+Reactor::Reactor(RequestHandler handler, ReactorOptions options)
+    : handler_(std::move(handler)),
+      options_(options),
+      routes_(new RouteCounters[options.routeCount + 1]),
+      read_buffer_(kReadChunk) {}
+
+Reactor::~Reactor() {
+    for (auto& entry : connections_) {
+        ::close(entry.first);
+    }
+    connections_.clear();
+
+    if (listen_fd_ >= 0) ::close(listen_fd_);
+    if (unix_listen_fd_ >= 0) {
+        ::close(unix_listen_fd_);
+        ::unlink(unix_path_.c_str());
+    }
+    if (wake_fd_ >= 0) ::close(wake_fd_);
+    if (epoll_fd_ >= 0) ::close(epoll_fd_);
+}
+
+bool Reactor::listen(const std::string& host, int port, bool reusePort) {
+    epoll_fd_ = ::epoll_create1(EPOLL_CLOEXEC);
+    wake_fd_ = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    listen_fd_ = ::socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (epoll_fd_ < 0 || wake_fd_ < 0 || listen_fd_ < 0) {
+        std::cerr << "Failed to create server sockets: " << std::strerror(errno) << std::endl;
+        return false;
+    }
+
+    int enable = 1;
+    ::setsockopt(listen_fd_, SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(enable));
+    if (reusePort && ::setsockopt(listen_fd_, SOL_SOCKET, SO_REUSEPORT, &enable, sizeof(enable)) < 0) {
+        std::cerr << "Failed to enable SO_REUSEPORT: " << std::strerror(errno) << std::endl;
+        return false;
+    }
+
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(static_cast<uint16_t>(port));
+    if (::inet_pton(AF_INET, host.c_str(), &addr.sin_addr) != 1) {
+        std::cerr << "Invalid listen address: " << host << std::endl;
+        return false;
+    }
+
+    if (::bind(listen_fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) {
+        std::cerr << "Failed to bind " << host << ":" << port << ": " << std::strerror(errno) << std::endl;
+        return false;
+    }
+    if (::listen(listen_fd_, SOMAXCONN) < 0) {
+        std::cerr << "Failed to listen: " << std::strerror(errno) << std::endl;
+        return false;
+    }
+
+    epoll_event ev{};
+    ev.events = EPOLLIN;
+    ev.data.fd = listen_fd_;
+    ::epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, listen_fd_, &ev);
+    ev.data.fd = wake_fd_;
+    ::epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, wake_fd_, &ev);
+
+    return true;
+}
+
+bool Reactor::listenUnix(const std::string& path, MessageHandler handler) {
+    sockaddr_un addr{};
+    if (epoll_fd_ < 0 || path.empty() || path.size() >= sizeof(addr.sun_path)) {
+        std::cerr << "Invalid unix socket path: " << path << std::endl;
+        return false;
+    }
+
+    unix_listen_fd_ = ::socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (unix_listen_fd_ < 0) {
+        std::cerr << "Failed to create unix socket: " << std::strerror(errno) << std::endl;
+        return false;
+    }
+
+    addr.sun_family = AF_UNIX;
+    std::memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+
+    // 上次异常退出留下的套接字文件会导致 bind 失败
+    ::unlink(path.c_str());
+    if (::bind(unix_listen_fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) {
+        std::cerr << "Failed to bind " << path << ": " << std::strerror(errno) << std::endl;
+        ::close(unix_listen_fd_);
+        unix_listen_fd_ = -1;
+        return false;
+    }
+    unix_path_ = path;
+    ::chmod(path.c_str(), S_IRUSR | S_IWUSR);
+
+    if (::listen(unix_listen_fd_, SOMAXCONN) < 0) {
+        std::cerr << "Failed to listen on " << path << ": " << std::strerror(errno) << std::endl;
+        return false;
+    }
+
+    epoll_event ev{};
+    ev.events = EPOLLIN;
+    ev.data.fd = unix_listen_fd_;
+    ::epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, unix_listen_fd_, &ev);
+
+    message_handler_ = std::move(handler);
+    return true;
+}
+
+int Reactor::localPort() const {
+    sockaddr_in addr{};
+    socklen_t len = sizeof(addr);
+    if (listen_fd_ < 0 || ::getsockname(listen_fd_, reinterpret_cast<sockaddr*>(&addr), &len) < 0) {
+        return -1;
+    }
+    return ntohs(addr.sin_port);
+}
+
+void Reactor::run() {
+    epoll_event events[kMaxEvents];
+    auto lastSweep = std::chrono::steady_clock::now();
+
+    while (!stopping_) {
+        // 有事件流连接时按合并间隔醒来，发送被限速的位置事件
+        int timeout = streams_.empty() ? 1000 : static_cast<int>(
+            std::max<int64_t>(1, std::min<int64_t>(1000, options_.coalesceInterval.count())));
+        int n = ::epoll_wait(epoll_fd_, events, kMaxEvents, timeout);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            std::cerr << "epoll_wait failed: " << std::strerror(errno) << std::endl;
+            break;
+        }
+
+        now_ = std::chrono::steady_clock::now();
+        for (int i = 0; i < n; ++i) {
+            int fd = events[i].data.fd;
+            uint32_t mask = events[i].events;
+
+            if (fd == listen_fd_ || fd == unix_listen_fd_) {
+                acceptConnections(fd);
+                continue;
+            }
+            if (fd == wake_fd_) {
+                uint64_t value = 0;
+                ssize_t ignored = ::read(wake_fd_, &value, sizeof(value));
+                (void)ignored;
+                drainMailbox();
+                continue;
+            }
+
+            handleConnectionEvent(fd, mask);
+
+            // 处理完一个连接后更新一次时钟：既是本连接上请求的完成时间，也是下一个连接的开始时间
+            now_ = std::chrono::steady_clock::now();
+            recordLatencies();
+        }
+
+        if (!streams_.empty()) {
+            pumpStreams();
+        }
+
+        auto now = std::chrono::steady_clock::now();
+        if (now - lastSweep >= kSweepInterval) {
+            closeIdleConnections();
+            lastSweep = now;
+        }
+    }
+
+    while (!connections_.empty()) {
+        closeConnection(connections_.begin()->first);
+    }
+}
+
+void Reactor::handleConnectionEvent(int fd, uint32_t mask) {
+    auto it = connections_.find(fd);
+    if (it == connections_.end()) {
+        return;
+    }
+    Connection& conn = *it->second;
+
+    if (mask & EPOLLERR) {
+        closeConnection(fd);
+        return;
+    }
+    if (mask & (EPOLLIN | EPOLLHUP | EPOLLRDHUP)) {
+        if (!onReadable(conn)) return;
+    }
+    if (mask & EPOLLOUT) {
+        flushOutput(conn);
+    }
+}
+
+void Reactor::stop() {
+    stopping_ = true;
+    if (wake_fd_ >= 0) {
+        uint64_t one = 1;
+        ssize_t ignored = ::write(wake_fd_, &one, sizeof(one));
+        (void)ignored;
+    }
+}
+
+void Reactor::publish(std::shared_ptr<const ServerEvent> event) {
+    // 没有订阅者时不唤醒事件循环；新订阅者连接时会先收到一份完整状态
+    if (counters_.streams.load(std::memory_order_relaxed) == 0) {
+        return;
+    }
+
+    bool wasEmpty = false;
+    {
+        std::lock_guard<std::mutex> lock(mailbox_mutex_);
+        wasEmpty = mailbox_.empty();
+        mailbox_.push_back(std::move(event));
+    }
+
+    if (wasEmpty && wake_fd_ >= 0) {
+        uint64_t one = 1;
+        ssize_t ignored = ::write(wake_fd_, &one, sizeof(one));
+        (void)ignored;
+    }
+}
+
+void Reactor::acceptConnections(int listenFd) {
+    bool framed = listenFd == unix_listen_fd_;
+
+    while (true) {
+        int fd = ::accept4(listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            if (errno == EINTR) continue;
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                std::cerr << "accept failed: " << std::strerror(errno) << std::endl;
+            }
+            return;
+        }
+
+        if (!framed) {
+            int enable = 1;
+            ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &enable, sizeof(enable));
+        }
+
+        auto conn = std::make_unique<Connection>();
+        conn->fd = fd;
+        conn->framed = framed;
+        conn->events = EPOLLIN | EPOLLRDHUP;
+        conn->lastActive = std::chrono::steady_clock::now();
+
+        epoll_event ev{};
+        ev.events = conn->events;
+        ev.data.fd = fd;
+        if (::epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &ev) < 0) {
+            ::close(fd);
+            continue;
+        }
+        connections_[fd] = std::move(conn);
+        counters_.accepted.fetch_add(1, std::memory_order_relaxed);
+        counters_.active.store(connections_.size(), std::memory_order_relaxed);
+    }
+}
+
+bool Reactor::onReadable(Connection& conn) {
+    conn.lastActive = now_;
+
+    for (int i = 0; i < kMaxReadsPerEvent; ++i) {
+        ssize_t n = ::recv(conn.fd, read_buffer_.data(), read_buffer_.size(), 0);
+        if (n > 0) {
+            conn.input.append(read_buffer_.data(), static_cast<size_t>(n));
+            counters_.bytesRead.fetch_add(static_cast<uint64_t>(n), std::memory_order_relaxed);
+            if (static_cast<size_t>(n) < read_buffer_.size()) break;
+            continue;
+        }
+        if (n == 0) {
+            conn.peerClosed = true;
+            break;
+        }
+        if (errno == EINTR) continue;
+        if (errno == EAGAIN || errno == EWOULDBLOCK) break;
+
+        closeConnection(conn.fd);
+        return false;
+    }
+
+    processInput(conn);
+    return flushOutput(conn);
+}
+
+void Reactor::processInput(Connection& conn) {
+    if (conn.framed) {
+        processFrames(conn);
+        return;
+    }
+    if (conn.stream != StreamMode::NONE) {
+        processStreamInput(conn);
+        return;
+    }
+
+    size_t offset = 0;
+
+    while (!conn.closeAfterWrite && conn.stream == StreamMode::NONE && offset < conn.input.size()) {
+        if (conn.fileFd >= 0 || conn.output.size() - conn.outputOffset > kMaxPendingOutput) {
+            conn.readPaused = true;
+            break;
+        }
+
+        size_t consumed = 0;
+        auto result = conn.parser.parse(conn.input.data() + offset, conn.input.size() - offset,
+                                        conn.request, consumed);
+
+        if (result == HttpParser::Result::INCOMPLETE) {
+            if (conn.parser.takeContinue()) {
+                conn.output += "HTTP/1.1 100 Continue\r\n\r\n";
+            }
+            break;
+        }
+
+        if (result == HttpParser::Result::ERROR) {
+            int status = conn.parser.errorStatus();
+            response_.clear();
+            response_.setError(status, httpStatusText(status));
+            appendHttpResponse(conn.output, response_, false);
+            conn.closeAfterWrite = true;
+            break;
+        }
+
+        offset += consumed;
+        handleRequest(conn, consumed);
+    }
+
+    conn.input.erase(0, offset);
+
+    if (conn.stream != StreamMode::NONE) {
+        processStreamInput(conn);
+    }
+}
+
+void Reactor::processFrames(Connection& conn) {
+    size_t offset = 0;
+
+    while (!conn.closeAfterWrite && conn.input.size() - offset >= 4) {
+        if (conn.output.size() - conn.outputOffset > kMaxPendingOutput) {
+            conn.readPaused = true;
+            break;
+        }
+
+        uint32_t length = ipc::loadU32(conn.input.data() + offset);
+        if (length > ipc::kMaxFrameSize) {
+            // 帧长度异常说明双方已经失去同步，只能断开
+            conn.closeAfterWrite = true;
+            break;
+        }
+        if (conn.input.size() - offset - 4 < length) {
+            break;
+        }
+
+        counters_.requests.fetch_add(1, std::memory_order_relaxed);
+        size_t header = conn.output.size();
+        conn.output.append(4, '\0');
+        try {
+            message_handler_(conn.input.data() + offset + 4, length, conn.output);
+        } catch (const std::exception& e) {
+            std::cerr << "IPC handler failed: " << e.what() << std::endl;
+            conn.output.resize(header);
+            conn.closeAfterWrite = true;
+            break;
+        }
+        ipc::storeU32(&conn.output[header], static_cast<uint32_t>(conn.output.size() - header - 4));
+        offset += 4 + length;
+    }
+
+    conn.input.erase(0, offset);
+}
+
+void Reactor::handleRequest(Connection& conn, size_t requestBytes) {
+    counters_.requests.fetch_add(1, std::memory_order_relaxed);
+    response_.clear();
+    try {
+        handler_(conn.request, response_);
+    } catch (const std::exception& e) {
+        response_.clear();
+        response_.setError(500, e.what());
+    }
+
+    size_t route = conn.request.route >= 0 && static_cast<size_t>(conn.request.route) < options_.routeCount
+                       ? static_cast<size_t>(conn.request.route)
+                       : options_.routeCount;
+    RouteCounters& stats = routes_[route];
+
+    if (response_.stream != StreamMode::NONE) {
+        startStream(conn);
+        recordRequest(stats, conn.lastActive, requestBytes, 0);
+        return;
+    }
+
+    // HTTP/1.0 不支持分块传输编码，流式响应体只能以关闭连接结束
+    bool http10 = conn.request.versionMinor == 0;
+    bool keepAlive = conn.request.keepAlive && !stopping_ && !(http10 && response_.jsonWriter);
+    bool headOnly = conn.request.method == "HEAD";
+    size_t outputBefore = conn.output.size();
+    appendHttpResponse(conn.output, response_, keepAlive, headOnly, !http10);
+    if (!keepAlive) {
+        conn.closeAfterWrite = true;
+    }
+
+    uint64_t bytesOut = conn.output.size() - outputBefore;
+    if (response_.fileFd >= 0 && !headOnly && response_.fileLength > 0) {
+        conn.fileOffset = response_.fileOffset;
+        conn.fileRemaining = response_.fileLength;
+        conn.fileFd = response_.releaseFile();
+        bytesOut += conn.fileRemaining;
+    }
+
+    ++conn.unsent;
+    bump(counters_.inFlight, 1);
+    recordRequest(stats, conn.lastActive, requestBytes, bytesOut);
+}
+
+void Reactor::recordRequest(RouteCounters& stats, std::chrono::steady_clock::time_point start,
+                            size_t requestBytes, uint64_t bytesOut) {
+    int statusClass = response_.status / 100 - 1;
+    bump(stats.responses[statusClass >= 0 && statusClass < 5 ? statusClass : 4], 1);
+    bump(stats.bytesIn, requestBytes);
+    bump(stats.bytesOut, bytesOut);
+    // 耗时等到事件处理完、读到下一次时钟时再记录，每个请求不需要单独读时钟
+    pending_latencies_.push_back({&stats.latency, start});
+}
+
+void Reactor::recordLatencies() {
+    for (const auto& pending : pending_latencies_) {
+        auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(now_ - pending.second).count();
+        pending.first->record(elapsed > 0 ? static_cast<uint64_t>(elapsed) : 0);
+    }
+    pending_latencies_.clear();
+}
+
+void Reactor::releaseInFlight(Connection& conn) {
+    if (conn.unsent > 0) {
+        counters_.inFlight.store(counters_.inFlight.load(std::memory_order_relaxed) - conn.unsent,
+                                 std::memory_order_relaxed);
+        conn.unsent = 0;
+    }
+}
+
+bool Reactor::flushOutput(Connection& conn) {
+    while (true) {
+        while (conn.outputOffset < conn.output.size()) {
+            // 后面紧跟文件内容时让内核把报文头和文件数据合并成完整的报文段
+            int flags = MSG_NOSIGNAL | (conn.fileFd >= 0 ? MSG_MORE : 0);
+            ssize_t n = ::send(conn.fd, conn.output.data() + conn.outputOffset,
+                               conn.output.size() - conn.outputOffset, flags);
+            if (n > 0) {
+                conn.outputOffset += static_cast<size_t>(n);
+                counters_.bytesWritten.fetch_add(static_cast<uint64_t>(n), std::memory_order_relaxed);
+                continue;
+            }
+            if (n < 0 && errno == EINTR) continue;
+            if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
+
+            closeConnection(conn.fd);
+            return false;
+        }
+
+        if (conn.outputOffset < conn.output.size()) {
+            // 内核发送缓冲区已满，丢弃已发送的前缀，等待 EPOLLOUT
+            if (conn.outputOffset > kReadChunk && conn.outputOffset * 2 > conn.output.size()) {
+                conn.output.erase(0, conn.outputOffset);
+                conn.outputOffset = 0;
+            }
+            break;
+        }
+
+        conn.output.clear();
+        conn.outputOffset = 0;
+
+        if (conn.fileFd >= 0) {
+            if (!sendFileBody(conn)) {
+                return false;
+            }
+            if (conn.fileFd >= 0) {
+                // 发送缓冲区已满或本次配额用完，等待 EPOLLOUT
+                break;
+            }
+        }
+        releaseInFlight(conn);
+
+        if (conn.closeAfterWrite || (conn.peerClosed && !conn.readPaused)) {
+            closeConnection(conn.fd);
+            return false;
+        }
+        if (conn.stream != StreamMode::NONE && !conn.pendingEvents.empty()) {
+            // 积压已清空，继续写入排队的事件
+            fillStream(conn, std::chrono::steady_clock::now());
+            continue;
+        }
+        if (!conn.readPaused) {
+            break;
+        }
+
+        // 积压已清空，继续处理之前暂停的流水线请求
+        conn.readPaused = false;
+        processInput(conn);
+    }
+
+    updateInterest(conn);
+    return true;
+}
+
+bool Reactor::sendFileBody(Connection& conn) {
+    for (int i = 0; i < kMaxReadsPerEvent && conn.fileRemaining > 0; ++i) {
+        off_t offset = static_cast<off_t>(conn.fileOffset);
+        size_t chunk = static_cast<size_t>(std::min<uint64_t>(conn.fileRemaining, kSendfileChunk));
+        ssize_t n = ::sendfile(conn.fd, conn.fileFd, &offset, chunk);
+        if (n > 0) {
+            conn.fileOffset += static_cast<uint64_t>(n);
+            conn.fileRemaining -= static_cast<uint64_t>(n);
+            conn.lastActive = std::chrono::steady_clock::now();
+            counters_.bytesWritten.fetch_add(static_cast<uint64_t>(n), std::memory_order_relaxed);
+            continue;
+        }
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) return true;
+
+        // 出错，或文件在发送过程中被截断（n == 0），已无法满足 Content-Length
+        closeConnection(conn.fd);
+        return false;
+    }
+
+    if (conn.fileRemaining == 0) {
+        ::close(conn.fileFd);
+        conn.fileFd = -1;
+    }
+    return true;
+}
+
+void Reactor::updateInterest(Connection& conn) {
+    uint32_t events = 0;
+    if (!conn.readPaused && !conn.peerClosed && !conn.closeAfterWrite) {
+        events |= EPOLLIN | EPOLLRDHUP;
+    }
+    if (conn.outputOffset < conn.output.size() || conn.fileFd >= 0) {
+        events |= EPOLLOUT;
+    }
+
+    if (events != conn.events) {
+        epoll_event ev{};
+        ev.events = events;
+        ev.data.fd = conn.fd;
+        ::epoll_ctl(epoll_fd_, EPOLL_CTL_MOD, conn.fd, &ev);
+        conn.events = events;
+    }
+}
+
+void Reactor::closeConnection(int fd) {
+    ::epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, fd, nullptr);
+    ::close(fd);
+    auto it = connections_.find(fd);
+    if (it != connections_.end()) {
+        releaseInFlight(*it->second);
+        connections_.erase(it);
+    }
+    counters_.active.store(connections_.size(), std::memory_order_relaxed);
+
+    if (streams_.erase(fd) > 0) {
+        counters_.streams.store(streams_.size(), std::memory_order_relaxed);
+    }
+}
+
+void Reactor::closeIdleConnections() {
+    auto deadline = std::chrono::steady_clock::now() - kIdleTimeout;
+
+    std::vector<int> idle;
+    for (const auto& entry : connections_) {
+        const Connection& conn = *entry.second;
+        // 本地 IPC 连接是前端的长连接控制通道，不做空闲回收
+        if (conn.stream == StreamMode::NONE && !conn.framed && conn.fileFd < 0 && conn.lastActive < deadline &&
+            conn.outputOffset == conn.output.size()) {
+            idle.push_back(entry.first);
+        }
+    }
+    for (int fd : idle) {
+        closeConnection(fd);
+    }
+}
+
+// ===== 事件流 =====
+
+void Reactor::startStream(Connection& conn) {
+    conn.stream = response_.stream;
+    conn.lastFrameSent = std::chrono::steady_clock::now();
+
+    if (conn.stream == StreamMode::WEBSOCKET) {
+        const std::string* key = conn.request.header("Sec-WebSocket-Key");
+        conn.output += "HTTP/1.1 101 Switching Protocols\r\n"
+                       "Upgrade: websocket\r\n"
+                       "Connection: Upgrade\r\n"
+                       "Sec-WebSocket-Accept: ";
+        conn.output += websocket::acceptKey(key != nullptr ? *key : std::string());
+        conn.output += "\r\n\r\n";
+    } else {
+        conn.output += kSseHead;
+    }
+
+    if (!response_.streamEvent.empty()) {
+        ServerEvent initial;
+        initial.name = response_.streamEvent;
+        initial.data = response_.body;
+        appendEventFrame(conn, initial);
+    }
+
+    streams_.insert(conn.fd);
+    counters_.streams.store(streams_.size(), std::memory_order_relaxed);
+}
+
+void Reactor::processStreamInput(Connection& conn) {
+    if (conn.stream == StreamMode::SSE) {
+        // SSE 是单向的，忽略客户端之后发来的任何数据
+        conn.input.clear();
+        return;
+    }
+
+    size_t offset = 0;
+    websocket::Frame frame;
+    while (!conn.closeAfterWrite && offset < conn.input.size()) {
+        size_t consumed = 0;
+        auto result = websocket::parseFrame(conn.input.data() + offset, conn.input.size() - offset,
+                                            frame, consumed);
+        if (result == websocket::ParseResult::INCOMPLETE) {
+            break;
+        }
+        if (result == websocket::ParseResult::ERROR) {
+            const char protocolError[] = {0x03, static_cast<char>(0xEA)};  // 1002
+            websocket::appendFrame(conn.output, websocket::CLOSE, protocolError, sizeof(protocolError));
+            conn.closeAfterWrite = true;
+            break;
+        }
+
+        offset += consumed;
+        if (frame.opcode == websocket::CLOSE) {
+            websocket::appendFrame(conn.output, websocket::CLOSE, frame.payload.data(),
+                                   std::min<size_t>(frame.payload.size(), 2));
+            conn.closeAfterWrite = true;
+        } else if (frame.opcode == websocket::PING) {
+            websocket::appendFrame(conn.output, websocket::PONG, frame.payload.data(), frame.payload.size());
+        }
+        // 客户端发来的数据帧和 PONG 直接忽略
+    }
+
+    conn.input.erase(0, offset);
+}
+
+void Reactor::appendEventFrame(Connection& conn, const ServerEvent& event) {
+    if (conn.stream == StreamMode::WEBSOCKET) {
+        frame_buffer_.clear();
+        frame_buffer_ += "{\"event\":\"";
+        frame_buffer_ += event.name;
+        frame_buffer_ += "\",\"data\":";
+        frame_buffer_ += event.data;
+        frame_buffer_ += "}";
+        websocket::appendFrame(conn.output, websocket::TEXT, frame_buffer_.data(), frame_buffer_.size());
+    } else {
+        conn.output += "event: ";
+        conn.output += event.name;
+        conn.output += "\ndata: ";
+        conn.output += event.data;
+        conn.output += "\n\n";
+    }
+    conn.lastFrameSent = std::chrono::steady_clock::now();
+}
+
+void Reactor::fillStream(Connection& conn, std::chrono::steady_clock::time_point now) {
+    auto backlog = [&conn] { return conn.output.size() - conn.outputOffset; };
+
+    while (!conn.pendingEvents.empty() && backlog() < kStreamHighWater) {
+        appendEventFrame(conn, *conn.pendingEvents.front());
+        conn.pendingEvents.pop_front();
+    }
+
+    if (conn.pendingCoalesced && backlog() < kStreamHighWater &&
+        now - conn.lastCoalescedSent >= options_.coalesceInterval) {
+        appendEventFrame(conn, *conn.pendingCoalesced);
+        conn.pendingCoalesced.reset();
+        conn.lastCoalescedSent = now;
+    }
+
+    // 长时间没有事件时发送心跳，及时发现已断开的客户端
+    if (backlog() == 0 && now - conn.lastFrameSent >= kHeartbeatInterval) {
+        if (conn.stream == StreamMode::WEBSOCKET) {
+            websocket::appendFrame(conn.output, websocket::PING, nullptr, 0);
+        } else {
+            conn.output += ": ping\n\n";
+        }
+        conn.lastFrameSent = now;
+    }
+}
+
+void Reactor::drainMailbox() {
+    {
+        std::lock_guard<std::mutex> lock(mailbox_mutex_);
+        delivering_.swap(mailbox_);
+    }
+    if (delivering_.empty()) {
+        return;
+    }
+
+    scratch_fds_.clear();
+    for (int fd : streams_) {
+        Connection& conn = *connections_[fd];
+        for (size_t i = 0; i < delivering_.size(); ++i) {
+            const auto& event = delivering_[i];
+            if (event->coalesce) {
+                if (conn.pendingCoalesced) {
+                    counters_.eventsCoalesced.fetch_add(1, std::memory_order_relaxed);
+                }
+                conn.pendingCoalesced = event;
+            } else if (conn.pendingEvents.size() < options_.eventQueueDepth) {
+                conn.pendingEvents.push_back(event);
+            } else {
+                // 客户端长期不读取，断开后由客户端重连并重新获取完整状态；
+                // 排队中的和这一批剩下的事件都不会再发给它
+                counters_.eventsDropped.fetch_add(conn.pendingEvents.size() + (delivering_.size() - i),
+                                                  std::memory_order_relaxed);
+                scratch_fds_.push_back(fd);
+                break;
+            }
+        }
+    }
+    delivering_.clear();
+
+    for (int fd : scratch_fds_) {
+        closeConnection(fd);
+    }
+}
+
+void Reactor::pumpStreams() {
+    auto now = std::chrono::steady_clock::now();
+
+    scratch_fds_.assign(streams_.begin(), streams_.end());
+    for (int fd : scratch_fds_) {
+        auto it = connections_.find(fd);
+        if (it == connections_.end()) {
+            continue;
+        }
+        Connection& conn = *it->second;
+        fillStream(conn, now);
+        if (conn.outputOffset < conn.output.size()) {
+            flushOutput(conn);
+        }
+    }
+}
+
+#else  // !__linux__
+
+// TODO: Windows 版本需要基于 IOCP / WSAPoll 实现
+Reactor::Connection::~Connection() = default;
+
+Reactor::Reactor(RequestHandler handler, ReactorOptions options)
+    : handler_(std::move(handler)), options_(options), routes_(new RouteCounters[options.routeCount + 1]) {}
+
+Reactor::~Reactor() = default;
+
+bool Reactor::listen(const std::string& host, int port, bool reusePort) {
+    (void)host;
+    (void)port;
+    (void)reusePort;
+    std::cerr << "HTTP server is only implemented on Linux (epoll)" << std::endl;
+    return false;
+}
+
+bool Reactor::listenUnix(const std::string& path, MessageHandler handler) {
+    (void)path;
+    (void)handler;
+    std::cerr << "Unix socket transport is only implemented on Linux" << std::endl;
+    return false;
+}
+
+int Reactor::localPort() const {
+    return -1;
+}
+
+void Reactor::run() {}
+
+void Reactor::stop() {
+    stopping_ = true;
+}
+
+void Reactor::publish(std::shared_ptr<const ServerEvent> event) {
+    (void)event;
+}
+
+#endif  // __linux__
+
+}  // namespace musicfree
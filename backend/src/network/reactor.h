@@ -0,0 +1,241 @@
+#ifndef MUSICFREE_REACTOR_H
+#define MUSICFREE_REACTOR_H
+
+#include "../include/metrics.h"
+#include "http_message.h"
+#include "http_parser.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace musicfree {
+
+/**
+ * 推送给事件流连接（SSE / WebSocket）的事件
+ */
+struct ServerEvent {
+    std::string name;
+    std::string data;       // JSON
+    bool coalesce = false;  // 高频事件（播放位置）：每个连接只保留最新一条，按 coalesceInterval 限速发送
+};
+
+/**
+ * 事件循环参数
+ */
+struct ReactorOptions {
+    std::chrono::milliseconds coalesceInterval{200};  // 可合并事件的最小发送间隔
+    size_t eventQueueDepth = 64;                      // 每个连接待发送离散事件的上限，超出视为慢客户端并断开
+    size_t routeCount = 0;                            // 按路由统计的路由数（见 HttpRequest::route）
+};
+
+/**
+ * 基于 epoll 的单线程 HTTP/1.1 事件循环
+ *
+ * - 非阻塞套接字 + 水平触发，一个线程服务所有连接
+ * - 支持 keep-alive 和流水线：同一连接上的多个请求按顺序解析、按顺序应答
+ * - 输出积压超过上限时暂停读取，避免慢客户端撑爆内存
+ * - 文件响应体由内核直接从页缓存发送（sendfile），不经过用户态缓冲区
+ *
+ * 多线程模式下每个线程运行一个独立的 Reactor：各自的监听套接字（SO_REUSEPORT，
+ * 由内核分发新连接）、epoll 实例和连接表，接收/读/写路径上没有共享锁。
+ *
+ * 处理函数可以把连接升级为事件流（HttpResponse::setStream），之后通过 publish()
+ * 投递的事件会推送给该 Reactor 上的所有事件流连接。
+ *
+ * 另外可以监听一个 Unix 域套接字（listenUnix），其上的连接不走 HTTP，
+ * 而是 u32 长度前缀的二进制帧（见 ipc_protocol.h），每个请求帧交给 MessageHandler 处理。
+ */
+class Reactor {
+public:
+    using RequestHandler = std::function<void(HttpRequest&, HttpResponse&)>;
+
+    /**
+     * 二进制帧处理函数
+     * @param data 请求帧体（不含长度前缀）
+     * @param size 帧体长度
+     * @param out 输出缓冲区，处理函数在末尾追加应答帧体，长度前缀由 Reactor 回填
+     */
+    using MessageHandler = std::function<void(const char* data, size_t size, std::string& out)>;
+
+    /**
+     * 运行计数器
+     * 只由所属的事件循环线程写入（relaxed），其他线程可以随时读取
+     */
+    struct Counters {
+        std::atomic<uint64_t> accepted{0};
+        std::atomic<uint64_t> active{0};
+        std::atomic<uint64_t> requests{0};
+        std::atomic<uint64_t> bytesRead{0};
+        std::atomic<uint64_t> bytesWritten{0};    // 含 sendfile 发送的文件字节
+        std::atomic<uint64_t> streams{0};         // 当前事件流连接数
+        std::atomic<uint64_t> eventsDropped{0};   // 客户端读得太慢被断开时没有发出的事件
+        std::atomic<uint64_t> eventsCoalesced{0}; // 被更新的事件覆盖而丢弃的过期位置事件
+        std::atomic<uint64_t> inFlight{0};        // 已开始处理、应答尚未完全发出的请求数
+    };
+
+    /**
+     * 单个路由的请求统计，与 Counters 一样只由所属的事件循环线程写入
+     */
+    struct RouteCounters {
+        std::atomic<uint64_t> responses[5] = {};  // 按状态码类别（1xx ~ 5xx）计数
+        std::atomic<uint64_t> bytesIn{0};         // 请求报文字节数（报文头 + 请求体）
+        std::atomic<uint64_t> bytesOut{0};        // 应答报文字节数，含 sendfile 发送的文件内容
+        LatencyHistogram latency;                 // 从读到请求到应答交给内核发送的耗时
+    };
+
+    explicit Reactor(RequestHandler handler, ReactorOptions options = ReactorOptions());
+    ~Reactor();
+
+    // 禁止拷贝
+    Reactor(const Reactor&) = delete;
+    Reactor& operator=(const Reactor&) = delete;
+
+    /**
+     * 创建监听套接字
+     * @param host 绑定地址（IPv4）
+     * @param port 端口
+     * @param reusePort 是否设置 SO_REUSEPORT，允许多个 Reactor 监听同一端口
+     * @return 成功返回 true
+     */
+    bool listen(const std::string& host, int port, bool reusePort = false);
+
+    /**
+     * 额外监听一个 Unix 域套接字，使用长度前缀的二进制帧
+     * 路径上已存在的旧套接字文件会被删除，新文件权限为 0600（仅当前用户可连接）
+     * @param path 套接字路径
+     * @param handler 帧处理函数
+     * @return 成功返回 true
+     */
+    bool listenUnix(const std::string& path, MessageHandler handler);
+
+    /**
+     * 获取实际监听的端口（listen 传入 0 时由系统分配）
+     * @return 端口号，未监听时返回 -1
+     */
+    int localPort() const;
+
+    /**
+     * 运行事件循环，直到 stop() 被调用
+     */
+    void run();
+
+    /**
+     * 请求事件循环退出（线程安全）
+     */
+    void stop();
+
+    /**
+     * 向本 Reactor 上的所有事件流连接推送事件（线程安全）
+     * 事件放入信箱后唤醒事件循环，由事件循环线程完成分发
+     */
+    void publish(std::shared_ptr<const ServerEvent> event);
+
+    const Counters& counters() const { return counters_; }
+
+    /**
+     * 获取路由统计
+     * @param index 路由序号；等于 ReactorOptions::routeCount 时为未匹配任何路由的请求（404 / 405 / OPTIONS）
+     */
+    const RouteCounters& routeCounters(size_t index) const { return routes_[index]; }
+
+private:
+    struct Connection {
+        int fd = -1;
+        std::string input;
+        std::string output;
+        size_t outputOffset = 0;
+        HttpParser parser;
+        HttpRequest request;
+        bool closeAfterWrite = false;
+        bool peerClosed = false;     // 对端已关闭写方向
+        bool readPaused = false;     // 输出积压时暂停读取
+        bool framed = false;         // 来自 Unix 域套接字：二进制帧而不是 HTTP
+        uint32_t unsent = 0;         // 应答尚未完全发出的请求数（计入 Counters::inFlight）
+        uint32_t events = 0;         // 当前在 epoll 中注册的事件
+        std::chrono::steady_clock::time_point lastActive;
+
+        // 文件响应体：output 中的报文头发送完毕后用 sendfile 发送，发送期间暂停处理后续请求
+        int fileFd = -1;
+        uint64_t fileOffset = 0;
+        uint64_t fileRemaining = 0;
+
+        // 事件流状态
+        StreamMode stream = StreamMode::NONE;
+        std::deque<std::shared_ptr<const ServerEvent>> pendingEvents;  // 待发送的离散事件
+        std::shared_ptr<const ServerEvent> pendingCoalesced;           // 最新的可合并事件，新事件直接覆盖
+        std::chrono::steady_clock::time_point lastCoalescedSent;
+        std::chrono::steady_clock::time_point lastFrameSent;
+
+        Connection() = default;
+        Connection(const Connection&) = delete;
+        Connection& operator=(const Connection&) = delete;
+        ~Connection();
+    };
+
+    // 返回 false 表示连接已被关闭，调用方不能再访问 conn
+    void acceptConnections(int listenFd);
+    bool onReadable(Connection& conn);
+    void processInput(Connection& conn);
+    void processFrames(Connection& conn);
+    void handleConnectionEvent(int fd, uint32_t mask);
+    void handleRequest(Connection& conn, size_t requestBytes);
+    void recordRequest(RouteCounters& stats, std::chrono::steady_clock::time_point start, size_t requestBytes,
+                       uint64_t bytesOut);
+    void recordLatencies();
+    void releaseInFlight(Connection& conn);
+    bool flushOutput(Connection& conn);
+    bool sendFileBody(Connection& conn);
+    void updateInterest(Connection& conn);
+    void closeConnection(int fd);
+    void closeIdleConnections();
+
+    // 事件流
+    void startStream(Connection& conn);
+    void processStreamInput(Connection& conn);
+    void appendEventFrame(Connection& conn, const ServerEvent& event);
+    void fillStream(Connection& conn, std::chrono::steady_clock::time_point now);
+    void drainMailbox();
+    void pumpStreams();
+
+    RequestHandler handler_;
+    MessageHandler message_handler_;
+    ReactorOptions options_;
+    HttpResponse response_;  // 处理函数是同步的，所有连接复用同一个响应对象
+
+    int listen_fd_ = -1;
+    int unix_listen_fd_ = -1;
+    std::string unix_path_;
+    int epoll_fd_ = -1;
+    int wake_fd_ = -1;
+    std::atomic<bool> stopping_{false};
+    Counters counters_;
+    std::unique_ptr<RouteCounters[]> routes_;  // routeCount + 1 个，最后一个记录未匹配的请求
+
+    // 事件循环时钟：epoll_wait 返回后以及每处理完一个连接的事件后更新。
+    // 连接的读事件以它作为开始时间，处理完后的新值作为其上请求的完成时间，
+    // 每个请求的耗时统计不需要额外读时钟（虚拟机上一次 steady_clock::now() 要几十纳秒）
+    std::chrono::steady_clock::time_point now_;
+    std::vector<std::pair<LatencyHistogram*, std::chrono::steady_clock::time_point>> pending_latencies_;
+
+    std::unordered_map<int, std::unique_ptr<Connection>> connections_;
+    std::vector<char> read_buffer_;
+
+    std::mutex mailbox_mutex_;
+    std::vector<std::shared_ptr<const ServerEvent>> mailbox_;
+    std::vector<std::shared_ptr<const ServerEvent>> delivering_;
+    std::unordered_set<int> streams_;
+    std::vector<int> scratch_fds_;
+    std::string frame_buffer_;
+};
+
+}  // namespace musicfree
+
+#endif  // MUSICFREE_REACTOR_H
@@ -0,0 +1,155 @@
+#include "router.h"
+#include <strings.h>
+
+namespace musicfree {
+
+namespace {
+
+/**
+ * Content-Type 是否为 application/json（忽略参数和大小写）
+ */
+bool isJsonContentType(const std::string* value) {
+    if (value == nullptr) {
+        return false;
+    }
+    std::string_view type(*value);
+    type = type.substr(0, type.find(';'));
+    while (!type.empty() && (type.back() == ' ' || type.back() == '\t')) {
+        type.remove_suffix(1);
+    }
+    static constexpr std::string_view kJson = "application/json";
+    return type.size() == kJson.size() && strncasecmp(type.data(), kJson.data(), kJson.size()) == 0;
+}
+
+/**
+ * 是否为本机加载的页面：Electron 的本地文件（Origin 为 null 或 file://）和本机的开发服务器
+ */
+bool isLocalOrigin(std::string_view origin) {
+    if (origin == "null" || origin.rfind("file://", 0) == 0) {
+        return true;
+    }
+    for (std::string_view scheme : {"http://", "https://"}) {
+        if (origin.rfind(scheme, 0) != 0) {
+            continue;
+        }
+        std::string_view host = origin.substr(scheme.size());
+        for (std::string_view local : {"localhost", "127.0.0.1", "[::1]"}) {
+            if (host.rfind(local, 0) == 0 && (host.size() == local.size() || host[local.size()] == ':')) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+}  // namespace
+
+void splitPath(std::string_view path, std::vector<std::string_view>& segments) {
+    segments.clear();
+
+    size_t pos = 0;
+    while (pos < path.size()) {
+        size_t end = path.find('/', pos);
+        if (end == std::string_view::npos) {
+            end = path.size();
+        }
+        if (end > pos) {
+            segments.push_back(path.substr(pos, end - pos));
+        }
+        pos = end + 1;
+    }
+}
+
+void Router::add(const std::string& method, const std::string& pattern, RouteHandler handler) {
+    Route route;
+    route.method = method;
+    route.pattern = pattern;
+    route.handler = std::move(handler);
+
+    std::vector<std::string_view> segments;
+    splitPath(pattern, segments);
+    for (auto segment : segments) {
+        route.segments.emplace_back(segment);
+    }
+
+    routes_.push_back(std::move(route));
+}
+
+bool Router::match(const Route& route, const std::vector<std::string_view>& segments, HttpHeaders& params) {
+    if (route.segments.size() != segments.size()) {
+        return false;
+    }
+
+    for (size_t i = 0; i < segments.size(); ++i) {
+        const std::string& expected = route.segments[i];
+        if (expected.size() > 2 && expected.front() == '{' && expected.back() == '}') {
+            continue;
+        }
+        if (expected != segments[i]) {
+            return false;
+        }
+    }
+
+    params.clear();
+    for (size_t i = 0; i < segments.size(); ++i) {
+        const std::string& expected = route.segments[i];
+        if (expected.size() > 2 && expected.front() == '{' && expected.back() == '}') {
+            params.emplace_back(expected.substr(1, expected.size() - 2), std::string(segments[i]));
+        }
+    }
+    return true;
+}
+
+void Router::dispatch(HttpRequest& request, HttpResponse& response) const {
+    std::vector<std::string_view> segments;
+    splitPath(request.path, segments);
+
+    static const std::string kGet = "GET";
+    const std::string& method = request.method == "HEAD" ? kGet : request.method;
+    std::string allowed;
+
+    // 按注册顺序匹配，静态路由需要先于同形的 {param} 路由注册
+    for (size_t i = 0; i < routes_.size(); ++i) {
+        const Route& route = routes_[i];
+        if (!match(route, segments, request.pathParams)) {
+            continue;
+        }
+        if (route.method == method) {
+            request.route = static_cast<int>(i);
+            // 修改状态的请求只接受 JSON：其他网页不经预检能发出的只有 text/plain、表单等简单请求
+            if (method == "POST" && !isJsonContentType(request.header("Content-Type"))) {
+                response.setError(415, "Content-Type must be application/json");
+                return;
+            }
+            route.handler(request, response);
+            return;
+        }
+        if (allowed.find(route.method) == std::string::npos) {
+            allowed += allowed.empty() ? route.method : ", " + route.method;
+        }
+    }
+
+    if (allowed.empty()) {
+        response.setError(404, "Not found: " + request.path);
+        return;
+    }
+
+    if (request.method == "OPTIONS") {
+        const std::string* origin = request.header("Origin");
+        if (origin != nullptr && !isLocalOrigin(*origin)) {
+            response.setError(403, "Origin not allowed");
+            return;
+        }
+        response.status = 204;
+        response.contentType.clear();
+        response.headers.emplace_back("Access-Control-Allow-Methods", allowed + ", OPTIONS");
+        response.headers.emplace_back("Access-Control-Allow-Headers", "Content-Type, If-None-Match, Range");
+        response.headers.emplace_back("Access-Control-Max-Age", "86400");
+        return;
+    }
+
+    response.setError(405, "Method not allowed");
+    response.headers.emplace_back("Allow", allowed);
+}
+
+}  // namespace musicfree
@@ -0,0 +1,68 @@
+#ifndef MUSICFREE_ROUTER_H
+#define MUSICFREE_ROUTER_H
+
+#include "http_message.h"
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace musicfree {
+
+using RouteHandler = std::function<void(HttpRequest&, HttpResponse&)>;
+
+/**
+ * 请求路由
+ * 路径模式按 '/' 分段，"{name}" 段匹配任意非空段并写入 HttpRequest::pathParams
+ */
+class Router {
+public:
+    /**
+     * 注册路由
+     * @param method HTTP 方法（GET / POST / DELETE ...）
+     * @param pattern 路径模式，例如 "/api/playlist/{index}"
+     * @param handler 处理函数
+     */
+    void add(const std::string& method, const std::string& pattern, RouteHandler handler);
+
+    /**
+     * 分发请求
+     * 找不到路径返回 404，路径存在但方法不匹配返回 405，POST 的 Content-Type 不是 application/json 返回 415；
+     * HEAD 按 GET 处理，OPTIONS 作为跨域预检直接应答（只允许本机加载的页面，其他来源返回 403）
+     * 匹配到的路由序号写入 HttpRequest::route
+     * @param request 请求
+     * @param response 输出：响应
+     */
+    void dispatch(HttpRequest& request, HttpResponse& response) const;
+
+    /**
+     * 已注册的路由数，路由序号按注册顺序从 0 开始
+     */
+    size_t routeCount() const { return routes_.size(); }
+
+    const std::string& routeMethod(size_t index) const { return routes_[index].method; }
+    const std::string& routePattern(size_t index) const { return routes_[index].pattern; }
+
+private:
+    struct Route {
+        std::string method;
+        std::string pattern;
+        std::vector<std::string> segments;
+        RouteHandler handler;
+    };
+
+    static bool match(const Route& route, const std::vector<std::string_view>& segments, HttpHeaders& params);
+
+    std::vector<Route> routes_;
+};
+
+/**
+ * 把路径拆分为段（忽略首尾和重复的 '/'）
+ * @param path 路径
+ * @param segments 输出：指向 path 内部的各段
+ */
+void splitPath(std::string_view path, std::vector<std::string_view>& segments);
+
+}  // namespace musicfree
+
+#endif  // MUSICFREE_ROUTER_H
@@ -0,0 +1,705 @@
+#include "track_parser.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define MUSICFREE_TRACK_PARSER_X86 1
+#endif
+
+namespace musicfree {
+
+namespace {
+
+constexpr int kMaxDepth = 64;
+constexpr size_t kBlockSize = 64;
+constexpr size_t kBatchBlocks = 64;  // 每次分类 4 KB，摊薄按指令集分派的调用开销
+constexpr size_t kMaxRetainedIndex = 256 * 1024;  // 解析大请求后不保留超过 1 MB 的索引
+
+/**
+ * 64 字节块的分类结果，第 i 位对应块内第 i 个字节
+ */
+struct BlockMasks {
+    uint64_t quote;
+    uint64_t backslash;
+    uint64_t op;       // { } [ ] : ,
+    uint64_t control;  // 小于 0x20 的字节
+};
+
+// ===== 第一阶段：分类 =====
+
+enum : uint8_t {
+    kClassQuote = 1,
+    kClassBackslash = 2,
+    kClassOp = 4,
+    kClassControl = 8
+};
+
+struct ClassTable {
+    uint8_t cls[256] = {};
+    ClassTable() {
+        for (int c = 0; c < 0x20; ++c) cls[c] = kClassControl;
+        cls[static_cast<unsigned char>('"')] = kClassQuote;
+        cls[static_cast<unsigned char>('\\')] = kClassBackslash;
+        for (char c : {'{', '}', '[', ']', ':', ','}) {
+            cls[static_cast<unsigned char>(c)] = kClassOp;
+        }
+    }
+};
+
+const ClassTable kClass;
+
+void classifyScalar(const char* data, size_t blocks, BlockMasks* masks) {
+    for (size_t b = 0; b < blocks; ++b) {
+        const unsigned char* p = reinterpret_cast<const unsigned char*>(data + b * kBlockSize);
+        uint64_t quote = 0, backslash = 0, op = 0, control = 0;
+        for (size_t i = 0; i < kBlockSize; ++i) {
+            uint64_t c = kClass.cls[p[i]];
+            quote |= (c & 1) << i;
+            backslash |= ((c >> 1) & 1) << i;
+            op |= ((c >> 2) & 1) << i;
+            control |= ((c >> 3) & 1) << i;
+        }
+        masks[b] = {quote, backslash, op, control};
+    }
+}
+
+#ifdef MUSICFREE_TRACK_PARSER_X86
+
+/**
+ * SSE4.2：每块 4 × 16 字节，结构字符用 PCMPESTRM 对字符集合做一次匹配
+ */
+__attribute__((target("sse4.2")))
+void classifySse42(const char* data, size_t blocks, BlockMasks* masks) {
+    const __m128i quoteChar = _mm_set1_epi8('"');
+    const __m128i backslashChar = _mm_set1_epi8('\\');
+    const __m128i controlMax = _mm_set1_epi8(0x1F);
+    const __m128i opSet = _mm_setr_epi8('{', '}', '[', ']', ':', ',', 0, 0, 0, 0, 0, 0, 0, 0, 0, 0);
+    constexpr int kMode = _SIDD_UBYTE_OPS | _SIDD_CMP_EQUAL_ANY | _SIDD_BIT_MASK;
+
+    for (size_t b = 0; b < blocks; ++b) {
+        const char* p = data + b * kBlockSize;
+        uint64_t quote = 0, backslash = 0, op = 0, control = 0;
+        for (int i = 0; i < 4; ++i) {
+            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i * 16));
+            int shift = i * 16;
+            quote |= static_cast<uint64_t>(static_cast<uint16_t>(
+                         _mm_movemask_epi8(_mm_cmpeq_epi8(v, quoteChar)))) << shift;
+            backslash |= static_cast<uint64_t>(static_cast<uint16_t>(
+                             _mm_movemask_epi8(_mm_cmpeq_epi8(v, backslashChar)))) << shift;
+            control |= static_cast<uint64_t>(static_cast<uint16_t>(
+                           _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_min_epu8(v, controlMax), v)))) << shift;
+            op |= static_cast<uint64_t>(static_cast<uint16_t>(
+                      _mm_cvtsi128_si32(_mm_cmpestrm(opSet, 6, v, 16, kMode)))) << shift;
+        }
+        masks[b] = {quote, backslash, op, control};
+    }
+}
+
+/**
+ * AVX2：每块 2 × 32 字节
+ * '{' 和 '[' 只差 0x20 这一位，'}' 和 ']' 同理，先或上 0x20 再比较，四个括号只需两次比较
+ */
+__attribute__((target("avx2")))
+void classifyAvx2(const char* data, size_t blocks, BlockMasks* masks) {
+    const __m256i quoteChar = _mm256_set1_epi8('"');
+    const __m256i backslashChar = _mm256_set1_epi8('\\');
+    const __m256i controlMax = _mm256_set1_epi8(0x1F);
+    const __m256i caseBit = _mm256_set1_epi8(0x20);
+    const __m256i openBrace = _mm256_set1_epi8('{');
+    const __m256i closeBrace = _mm256_set1_epi8('}');
+    const __m256i colon = _mm256_set1_epi8(':');
+    const __m256i comma = _mm256_set1_epi8(',');
+
+    for (size_t b = 0; b < blocks; ++b) {
+        const char* p = data + b * kBlockSize;
+        uint64_t quote = 0, backslash = 0, op = 0, control = 0;
+        for (int i = 0; i < 2; ++i) {
+            __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + i * 32));
+            int shift = i * 32;
+            __m256i folded = _mm256_or_si256(v, caseBit);
+            __m256i ops = _mm256_or_si256(
+                _mm256_or_si256(_mm256_cmpeq_epi8(folded, openBrace), _mm256_cmpeq_epi8(folded, closeBrace)),
+                _mm256_or_si256(_mm256_cmpeq_epi8(v, colon), _mm256_cmpeq_epi8(v, comma)));
+            quote |= static_cast<uint64_t>(static_cast<uint32_t>(
+                         _mm256_movemask_epi8(_mm256_cmpeq_epi8(v, quoteChar)))) << shift;
+            backslash |= static_cast<uint64_t>(static_cast<uint32_t>(
+                             _mm256_movemask_epi8(_mm256_cmpeq_epi8(v, backslashChar)))) << shift;
+            control |= static_cast<uint64_t>(static_cast<uint32_t>(
+                           _mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_min_epu8(v, controlMax), v)))) << shift;
+            op |= static_cast<uint64_t>(static_cast<uint32_t>(_mm256_movemask_epi8(ops))) << shift;
+        }
+        masks[b] = {quote, backslash, op, control};
+    }
+}
+
+#endif  // MUSICFREE_TRACK_PARSER_X86
+
+using ClassifyFn = void (*)(const char* data, size_t blocks, BlockMasks* masks);
+
+ClassifyFn classifierFor(SimdLevel level) {
+#ifdef MUSICFREE_TRACK_PARSER_X86
+    switch (level) {
+        case SimdLevel::AVX2: return classifyAvx2;
+        case SimdLevel::SSE42: return classifySse42;
+        case SimdLevel::SCALAR: break;
+    }
+#else
+    (void)level;
+#endif
+    return classifyScalar;
+}
+
+// ===== 第一阶段：位运算 =====
+
+/**
+ * 被转义的字符：紧跟在奇数长度反斜杠序列之后的字符
+ * 分别从偶数位和奇数位开始的反斜杠序列加上自身，进位落在序列之后的位置，
+ * 结束位置与起始位置奇偶性不同的序列长度为奇数
+ * @param prevEndsOdd 上一块是否以奇数长度的反斜杠序列结尾（1 或 0），返回时更新
+ */
+inline uint64_t findEscaped(uint64_t backslash, uint64_t& prevEndsOdd) {
+    constexpr uint64_t kEvenBits = 0x5555555555555555ULL;
+    constexpr uint64_t kOddBits = ~kEvenBits;
+
+    uint64_t startEdges = backslash & ~(backslash << 1);
+    uint64_t evenStartMask = kEvenBits ^ prevEndsOdd;
+    uint64_t evenStarts = startEdges & evenStartMask;
+    uint64_t oddStarts = startEdges & ~evenStartMask;
+
+    uint64_t evenCarries = backslash + evenStarts;
+    uint64_t oddCarries = backslash + oddStarts;
+    bool endsOdd = oddCarries < backslash;  // 加法溢出：奇数位开始的序列延续到下一块
+    oddCarries |= prevEndsOdd;
+    prevEndsOdd = endsOdd ? 1 : 0;
+
+    uint64_t evenCarryEnds = evenCarries & ~backslash;
+    uint64_t oddCarryEnds = oddCarries & ~backslash;
+    return (evenCarryEnds & kOddBits) | (oddCarryEnds & kEvenBits);
+}
+
+/**
+ * 前缀异或：第 i 位是输入第 0..i 位的异或，用于从引号位置得到字符串内部的范围
+ */
+inline uint64_t prefixXor(uint64_t bits) {
+    bits ^= bits << 1;
+    bits ^= bits << 2;
+    bits ^= bits << 4;
+    bits ^= bits << 8;
+    bits ^= bits << 16;
+    bits ^= bits << 32;
+    return bits;
+}
+
+inline bool isSpace(char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+// ===== 第二阶段：字符串解码 =====
+
+inline int hexValue(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+bool parseHex4(const char*& p, const char* end, unsigned& code) {
+    if (end - p < 4) {
+        return false;
+    }
+    code = 0;
+    for (int i = 0; i < 4; ++i) {
+        int digit = hexValue(*p++);
+        if (digit < 0) {
+            return false;
+        }
+        code = (code << 4) | static_cast<unsigned>(digit);
+    }
+    return true;
+}
+
+char* writeUtf8(char* dst, unsigned code) {
+    if (code < 0x80) {
+        *dst++ = static_cast<char>(code);
+    } else if (code < 0x800) {
+        *dst++ = static_cast<char>(0xC0 | (code >> 6));
+        *dst++ = static_cast<char>(0x80 | (code & 0x3F));
+    } else if (code < 0x10000) {
+        *dst++ = static_cast<char>(0xE0 | (code >> 12));
+        *dst++ = static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+        *dst++ = static_cast<char>(0x80 | (code & 0x3F));
+    } else {
+        *dst++ = static_cast<char>(0xF0 | (code >> 18));
+        *dst++ = static_cast<char>(0x80 | ((code >> 12) & 0x3F));
+        *dst++ = static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+        *dst++ = static_cast<char>(0x80 | (code & 0x3F));
+    }
+    return dst;
+}
+
+/**
+ * 原地解码转义序列，解码结果不会比原文长
+ * @param begin 第一个反斜杠的位置
+ * @param end 结束引号的位置
+ * @return 解码后内容的末尾，转义序列非法时返回 nullptr
+ */
+char* unescapeInPlace(char* begin, const char* end) {
+    char* dst = begin;
+    const char* src = begin;
+    while (src < end) {
+        const char* next = static_cast<const char*>(std::memchr(src, '\\', static_cast<size_t>(end - src)));
+        if (next == nullptr) {
+            next = end;
+        }
+        size_t plain = static_cast<size_t>(next - src);
+        std::memmove(dst, src, plain);
+        dst += plain;
+        src = next;
+        if (src == end) {
+            break;
+        }
+
+        // 结束引号前不会是单独的反斜杠（否则引号会被转义），src + 1 < end
+        ++src;
+        switch (*src++) {
+            case '"':  *dst++ = '"'; break;
+            case '\\': *dst++ = '\\'; break;
+            case '/':  *dst++ = '/'; break;
+            case 'b':  *dst++ = '\b'; break;
+            case 'f':  *dst++ = '\f'; break;
+            case 'n':  *dst++ = '\n'; break;
+            case 'r':  *dst++ = '\r'; break;
+            case 't':  *dst++ = '\t'; break;
+            case 'u': {
+                unsigned code = 0;
+                if (!parseHex4(src, end, code)) {
+                    return nullptr;
+                }
+                // UTF-16 代理对
+                if (code >= 0xD800 && code < 0xDC00) {
+                    unsigned low = 0;
+                    if (end - src < 2 || src[0] != '\\' || src[1] != 'u') {
+                        return nullptr;
+                    }
+                    src += 2;
+                    if (!parseHex4(src, end, low) || low < 0xDC00 || low >= 0xE000) {
+                        return nullptr;
+                    }
+                    code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+                }
+                dst = writeUtf8(dst, code);
+                break;
+            }
+            default:
+                return nullptr;
+        }
+    }
+    return dst;
+}
+
+inline bool keyIs(std::string_view key, const char* name, size_t size) {
+    return key.size() == size && std::memcmp(key.data(), name, size) == 0;
+}
+
+// 轨道字段，用于记录已经出现过的键（重复的键取第一个）
+enum : unsigned {
+    kFieldId = 1u << 0,
+    kFieldTitle = 1u << 1,
+    kFieldArtist = 1u << 2,
+    kFieldAlbum = 1u << 3,
+    kFieldUrl = 1u << 4,
+    kFieldDuration = 1u << 5,
+    kFieldSource = 1u << 6,
+    kFieldCoverUrl = 1u << 7
+};
+
+}  // namespace
+
+// ===== TrackView =====
+
+Track TrackView::toTrack() const {
+    Track track;
+    track.id.assign(id.data(), id.size());
+    track.title.assign(title.data(), title.size());
+    track.artist.assign(artist.data(), artist.size());
+    track.album.assign(album.data(), album.size());
+    track.url.assign(url.data(), url.size());
+    track.duration = duration;
+    track.source.assign(source.data(), source.size());
+    track.coverUrl.assign(coverUrl.data(), coverUrl.size());
+    return track;
+}
+
+// ===== TrackParser =====
+
+TrackParser::TrackParser(SimdLevel level) : level_(std::min(level, detectSimdLevel())) {}
+
+bool TrackParser::fail(const char* message) {
+    error_ = message;
+    return false;
+}
+
+bool TrackParser::buildIndex(const std::string& body) {
+    size_t size = body.size();
+    if (size >= std::numeric_limits<uint32_t>::max()) {
+        return fail("Request body too large");
+    }
+
+    ClassifyFn classify = classifierFor(level_);
+    const char* data = body.data();
+    size_t fullBlocks = size / kBlockSize;
+    size_t blocks = (size + kBlockSize - 1) / kBlockSize;
+
+    BlockMasks masks[kBatchBlocks];
+    char tail[kBlockSize];
+    uint64_t prevEndsOdd = 0;
+    uint64_t prevInString = 0;
+    uint64_t controlInString = 0;
+    count_ = 0;
+
+    for (size_t block = 0; block < blocks;) {
+        size_t batch;
+        if (block < fullBlocks) {
+            batch = std::min(kBatchBlocks, fullBlocks - block);
+            classify(data + block * kBlockSize, batch, masks);
+        } else {
+            // 最后不满 64 字节的部分补空格
+            std::memset(tail, ' ', kBlockSize);
+            std::memcpy(tail, data + block * kBlockSize, size - block * kBlockSize);
+            batch = 1;
+            classify(tail, 1, masks);
+        }
+
+        for (size_t i = 0; i < batch; ++i) {
+            const BlockMasks& m = masks[i];
+            uint64_t quotes = m.quote & ~findEscaped(m.backslash, prevEndsOdd);
+            // 字符串内部（含开始引号，不含结束引号）
+            uint64_t inString = prefixXor(quotes) ^ prevInString;
+            prevInString = static_cast<uint64_t>(static_cast<int64_t>(inString) >> 63);
+            controlInString |= m.control & inString;
+
+            uint64_t structurals = (m.op & ~inString) | quotes;
+            if (index_.size() < count_ + kBlockSize) {
+                index_.resize(std::max(index_.size() * 2, count_ + kBlockSize * kBatchBlocks));
+            }
+            uint32_t* out = index_.data() + count_;
+            uint32_t base = static_cast<uint32_t>((block + i) * kBlockSize);
+            count_ += static_cast<size_t>(__builtin_popcountll(structurals));
+            while (structurals != 0) {
+                *out++ = base + static_cast<uint32_t>(__builtin_ctzll(structurals));
+                structurals &= structurals - 1;
+            }
+        }
+        block += batch;
+    }
+
+    if (prevInString != 0) {
+        return fail("Unterminated string");
+    }
+    if (controlInString != 0) {
+        return fail("Control character in string");
+    }
+
+    if (index_.size() < count_ + 1) {
+        index_.resize(count_ + 1);
+    }
+    index_[count_++] = static_cast<uint32_t>(size);
+    return true;
+}
+
+bool TrackParser::blank(size_t from, size_t to) const {
+    for (size_t i = from; i < to; ++i) {
+        if (!isSpace(data_[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool TrackParser::parseString(std::string_view& out) {
+    // 当前是开始引号，下一个位置一定是配对的结束引号
+    char* begin = data_ + pos() + 1;
+    char* end = data_ + tokens_[k_ + 1];
+    k_ += 2;
+
+    char* escape = static_cast<char*>(std::memchr(begin, '\\', static_cast<size_t>(end - begin)));
+    if (escape == nullptr) {
+        out = std::string_view(begin, static_cast<size_t>(end - begin));
+        return true;
+    }
+    char* decodedEnd = unescapeInPlace(escape, end);
+    if (decodedEnd == nullptr) {
+        return fail("Invalid escape sequence");
+    }
+    out = std::string_view(begin, static_cast<size_t>(decodedEnd - begin));
+    return true;
+}
+
+bool TrackParser::parseScalar(size_t from, size_t to, ValueType& type, double& number) {
+    while (isSpace(data_[from])) ++from;
+    while (isSpace(data_[to - 1])) --to;
+
+    std::string_view text(data_ + from, to - from);
+    if (text == "true" || text == "false" || text == "null") {
+        type = ValueType::OTHER;
+        return true;
+    }
+
+    // 与 parseJson 相同：由数字、'.'、'e'、'E'、'+'、'-' 组成且能被 strtod 完整解析
+    for (char c : text) {
+        if (!((c >= '0' && c <= '9') || c == '.' || c == 'e' || c == 'E' || c == '+' || c == '-')) {
+            return fail("Invalid value");
+        }
+    }
+    // 数字之后是空白或结构字符，strtod 会在那里停下
+    char* parsedEnd = nullptr;
+    number = std::strtod(data_ + from, &parsedEnd);
+    if (parsedEnd != data_ + to) {
+        return fail("Invalid number");
+    }
+    type = ValueType::NUMBER;
+    return true;
+}
+
+bool TrackParser::parseValue(size_t from, int depth, size_t& end, ValueType& type,
+                             std::string_view& text, double& number) {
+    if (depth > kMaxDepth) {
+        return fail("Nesting too deep");
+    }
+
+    size_t at = pos();
+    if (!blank(from, at)) {
+        // 数字和字面量不是结构字符，位于两个结构字符之间
+        end = at;
+        return parseScalar(from, at, type, number);
+    }
+
+    switch (token()) {
+        case '"':
+            type = ValueType::STRING;
+            end = tokens_[k_ + 1] + 1;
+            return parseString(text);
+        case '{':
+            type = ValueType::OTHER;
+            return parseObject(depth, end, nullptr);
+        case '[':
+            type = ValueType::OTHER;
+            return parseArray(depth, end);
+        default:
+            return fail(at >= tokens_[count_ - 1] ? "Unexpected end of input" : "Expected value");
+    }
+}
+
+bool TrackParser::parseObject(int depth, size_t& end, TrackView* track) {
+    size_t from = pos() + 1;
+    ++k_;  // '{'
+
+    if (blank(from, pos()) && token() == '}') {
+        end = pos() + 1;
+        ++k_;
+        return true;
+    }
+
+    unsigned seen = 0;
+    while (true) {
+        if (!blank(from, pos()) || token() != '"') {
+            return fail("Expected object key");
+        }
+        std::string_view key;
+        size_t keyEnd = tokens_[k_ + 1] + 1;
+        if (!parseString(key)) {
+            return false;
+        }
+        if (!blank(keyEnd, pos()) || token() != ':') {
+            return fail("Expected ':'");
+        }
+        from = pos() + 1;
+        ++k_;
+
+        ValueType type = ValueType::OTHER;
+        std::string_view text;
+        double number = 0;
+        if (!parseValue(from, depth + 1, from, type, text, number)) {
+            return false;
+        }
+
+        if (track != nullptr) {
+            std::string_view* field = nullptr;
+            unsigned bit = 0;
+            switch (key.size()) {
+                case 2:
+                    if (keyIs(key, "id", 2)) { field = &track->id; bit = kFieldId; }
+                    break;
+                case 3:
+                    if (keyIs(key, "url", 3)) { field = &track->url; bit = kFieldUrl; }
+                    break;
+                case 5:
+                    if (keyIs(key, "title", 5)) { field = &track->title; bit = kFieldTitle; }
+                    else if (keyIs(key, "album", 5)) { field = &track->album; bit = kFieldAlbum; }
+                    break;
+                case 6:
+                    if (keyIs(key, "artist", 6)) { field = &track->artist; bit = kFieldArtist; }
+                    else if (keyIs(key, "source", 6)) { field = &track->source; bit = kFieldSource; }
+                    break;
+                case 8:
+                    if (keyIs(key, "coverUrl", 8)) { field = &track->coverUrl; bit = kFieldCoverUrl; }
+                    else if (keyIs(key, "duration", 8)) { bit = kFieldDuration; }
+                    break;
+                default:
+                    break;
+            }
+
+            if (bit != 0 && (seen & bit) == 0) {
+                seen |= bit;
+                if (bit == kFieldDuration) {
+                    if (type == ValueType::NUMBER) {
+                        // 超出 int 范围时截断，避免未定义的转换
+                        number = std::max(number, static_cast<double>(std::numeric_limits<int>::min()));
+                        number = std::min(number, static_cast<double>(std::numeric_limits<int>::max()));
+                        track->duration = static_cast<int>(number);
+                    }
+                } else if (type == ValueType::STRING) {
+                    *field = text;
+                    if (bit == kFieldId) {
+                        track->valid = true;
+                    }
+                }
+            }
+        }
+
+        if (!blank(from, pos())) {
+            return fail("Expected ',' or '}'");
+        }
+        if (token() == ',') {
+            from = pos() + 1;
+            ++k_;
+            continue;
+        }
+        if (token() == '}') {
+            end = pos() + 1;
+            ++k_;
+            return true;
+        }
+        return fail("Expected ',' or '}'");
+    }
+}
+
+bool TrackParser::parseArray(int depth, size_t& end) {
+    size_t from = pos() + 1;
+    ++k_;  // '['
+
+    if (blank(from, pos()) && token() == ']') {
+        end = pos() + 1;
+        ++k_;
+        return true;
+    }
+
+    while (true) {
+        ValueType type = ValueType::OTHER;
+        std::string_view text;
+        double number = 0;
+        if (!parseValue(from, depth + 1, from, type, text, number)) {
+            return false;
+        }
+        if (!blank(from, pos())) {
+            return fail("Expected ',' or ']'");
+        }
+        if (token() == ',') {
+            from = pos() + 1;
+            ++k_;
+            continue;
+        }
+        if (token() == ']') {
+            end = pos() + 1;
+            ++k_;
+            return true;
+        }
+        return fail("Expected ',' or ']'");
+    }
+}
+
+bool TrackParser::parse(std::string& body, std::vector<TrackView>& tracks, bool& isArray) {
+    tracks.clear();
+    isArray = false;
+    error_.clear();
+
+    bool ok = parseDocument(body, tracks, isArray);
+    // 视图指向请求体而不是索引，解析完即可释放偶尔出现的大索引
+    if (index_.size() > kMaxRetainedIndex) {
+        std::vector<uint32_t>().swap(index_);
+    }
+    return ok;
+}
+
+bool TrackParser::parseDocument(std::string& body, std::vector<TrackView>& tracks, bool& isArray) {
+    if (!buildIndex(body)) {
+        return false;
+    }
+    data_ = &body[0];
+    tokens_ = index_.data();
+    k_ = 0;
+
+    if (!blank(0, pos()) || (token() != '{' && token() != '[')) {
+        return fail("Request body must be a JSON object or array");
+    }
+
+    size_t end = 0;
+    if (token() == '{') {
+        tracks.emplace_back();
+        if (!parseObject(0, end, &tracks.back())) {
+            return false;
+        }
+    } else {
+        isArray = true;
+        size_t from = pos() + 1;
+        ++k_;  // '['
+
+        if (blank(from, pos()) && token() == ']') {
+            end = pos() + 1;
+            ++k_;
+        } else {
+            while (true) {
+                tracks.emplace_back();
+                if (blank(from, pos()) && token() == '{') {
+                    if (!parseObject(1, from, &tracks.back())) {
+                        return false;
+                    }
+                } else {
+                    // 不是对象的元素仍需通过语法检查，对应的轨道无效
+                    ValueType type = ValueType::OTHER;
+                    std::string_view text;
+                    double number = 0;
+                    if (!parseValue(from, 1, from, type, text, number)) {
+                        return false;
+                    }
+                }
+
+                if (!blank(from, pos())) {
+                    return fail("Expected ',' or ']'");
+                }
+                if (token() == ',') {
+                    from = pos() + 1;
+                    ++k_;
+                    continue;
+                }
+                if (token() == ']') {
+                    end = pos() + 1;
+                    ++k_;
+                    break;
+                }
+                return fail("Expected ',' or ']'");
+            }
+        }
+    }
+
+    // 文档之后只能有空白
+    if (k_ != count_ - 1 || !blank(end, body.size())) {
+        return fail("Unexpected data after JSON value");
+    }
+    return true;
+}
+
+}  // namespace musicfree
@@ -0,0 +1,104 @@
+#ifndef MUSICFREE_TRACK_PARSER_H
+#define MUSICFREE_TRACK_PARSER_H
+
+#include "../include/playlist_manager.h"
+#include "../core/simd_level.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace musicfree {
+
+/**
+ * 请求体中的一个轨道
+ * 字符串是请求缓冲区上的视图（转义序列已原地解码），缓冲区释放或修改后失效
+ */
+struct TrackView {
+    std::string_view id;
+    std::string_view title;
+    std::string_view artist;
+    std::string_view album;
+    std::string_view url;
+    std::string_view source;
+    std::string_view coverUrl;
+    int duration = 0;
+    bool valid = false;  // 是对象且 id 是字符串（与 jsonToTrack 的要求一致）
+
+    Track toTrack() const;
+};
+
+/**
+ * 轨道请求体解析器（单个 Track 对象或 Track 数组）
+ *
+ * 分两个阶段：
+ * 1. 结构扫描：每次处理 64 字节，用 SIMD 比较得到引号、反斜杠、结构字符（{}[]:,）的位掩码，
+ *    用位运算去掉被转义的引号和字符串内部的字符，记录所有结构字符和引号的位置
+ * 2. 沿位置索引读取值：字符串由相邻的两个引号定界，不再逐字节查找结尾；
+ *    已知字段写入 TrackView，其他字段跳过但仍做完整的语法检查
+ *
+ * 语义与 parseJson + jsonToTrack 一致：重复的键取第一个，id 必须是字符串，
+ * 其他字段类型不符时取默认值。解析器持有可复用的索引缓冲区，每个线程使用一个实例。
+ */
+class TrackParser {
+public:
+    /**
+     * @param level 使用的指令集，超出 CPU 支持范围时降级
+     */
+    explicit TrackParser(SimdLevel level = detectSimdLevel());
+
+    /**
+     * 解析请求体
+     * 字符串中的转义序列在 body 内原地解码，结果中的视图指向 body
+     * @param body 请求体，会被修改
+     * @param tracks 输出：解析出的轨道（先清空）
+     * @param isArray 输出：请求体是否为数组
+     * @return 成功返回 true，失败时 error() 给出原因
+     */
+    bool parse(std::string& body, std::vector<TrackView>& tracks, bool& isArray);
+
+    const std::string& error() const { return error_; }
+    SimdLevel level() const { return level_; }
+
+private:
+    enum class ValueType {
+        STRING = 0,
+        NUMBER = 1,
+        OTHER = 2
+    };
+
+    bool parseDocument(std::string& body, std::vector<TrackView>& tracks, bool& isArray);
+    bool buildIndex(const std::string& body);
+
+    /**
+     * 读取一个值
+     * @param from 上一个结构字符之后的位置，值从这里开始（可能有前导空白）
+     * @param end 输出：值之后的位置
+     */
+    bool parseValue(size_t from, int depth, size_t& end, ValueType& type, std::string_view& text, double& number);
+    bool parseObject(int depth, size_t& end, TrackView* track);
+    bool parseArray(int depth, size_t& end);
+    bool parseString(std::string_view& out);
+    bool parseScalar(size_t from, size_t to, ValueType& type, double& number);
+
+    size_t pos() const { return tokens_[k_]; }
+    char token() const { return data_[tokens_[k_]]; }
+    bool blank(size_t from, size_t to) const;
+    bool fail(const char* message);
+
+    SimdLevel level_;
+    std::vector<uint32_t> index_;  // 结构字符和引号的位置，末尾是指向请求体末尾的哨兵
+    size_t count_ = 0;
+
+    // 第二阶段的游标
+    char* data_ = nullptr;
+    const uint32_t* tokens_ = nullptr;
+    size_t k_ = 0;
+
+    std::string error_;
+};
+
+}  // namespace musicfree
+
+#endif  // MUSICFREE_TRACK_PARSER_H
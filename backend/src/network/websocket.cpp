@@ -0,0 +1,178 @@
+#include "websocket.h"
+
+namespace musicfree {
+namespace websocket {
+
+namespace {
+
+const char* kHandshakeGuid = "258EAFA5-E914-47DA-95CA-C5AB0DC85B11";
+
+inline uint32_t rotl(uint32_t value, int bits) {
+    return (value << bits) | (value >> (32 - bits));
+}
+
+/**
+ * SHA-1，仅用于计算握手应答
+ */
+void sha1(const std::string& message, uint8_t digest[20]) {
+    uint32_t h[5] = {0x67452301, 0xEFCDAB89, 0x98BADCFE, 0x10325476, 0xC3D2E1F0};
+
+    std::string data = message;
+    uint64_t bitLength = static_cast<uint64_t>(message.size()) * 8;
+    data.push_back(static_cast<char>(0x80));
+    while (data.size() % 64 != 56) {
+        data.push_back('\0');
+    }
+    for (int i = 7; i >= 0; --i) {
+        data.push_back(static_cast<char>((bitLength >> (i * 8)) & 0xFF));
+    }
+
+    for (size_t chunk = 0; chunk < data.size(); chunk += 64) {
+        uint32_t w[80];
+        for (int i = 0; i < 16; ++i) {
+            const auto* p = reinterpret_cast<const uint8_t*>(data.data() + chunk + i * 4);
+            w[i] = (uint32_t(p[0]) << 24) | (uint32_t(p[1]) << 16) | (uint32_t(p[2]) << 8) | p[3];
+        }
+        for (int i = 16; i < 80; ++i) {
+            w[i] = rotl(w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16], 1);
+        }
+
+        uint32_t a = h[0], b = h[1], c = h[2], d = h[3], e = h[4];
+        for (int i = 0; i < 80; ++i) {
+            uint32_t f, k;
+            if (i < 20) {
+                f = (b & c) | (~b & d);
+                k = 0x5A827999;
+            } else if (i < 40) {
+                f = b ^ c ^ d;
+                k = 0x6ED9EBA1;
+            } else if (i < 60) {
+                f = (b & c) | (b & d) | (c & d);
+                k = 0x8F1BBCDC;
+            } else {
+                f = b ^ c ^ d;
+                k = 0xCA62C1D6;
+            }
+            uint32_t temp = rotl(a, 5) + f + e + k + w[i];
+            e = d;
+            d = c;
+            c = rotl(b, 30);
+            b = a;
+            a = temp;
+        }
+
+        h[0] += a;
+        h[1] += b;
+        h[2] += c;
+        h[3] += d;
+        h[4] += e;
+    }
+
+    for (int i = 0; i < 5; ++i) {
+        digest[i * 4] = static_cast<uint8_t>(h[i] >> 24);
+        digest[i * 4 + 1] = static_cast<uint8_t>(h[i] >> 16);
+        digest[i * 4 + 2] = static_cast<uint8_t>(h[i] >> 8);
+        digest[i * 4 + 3] = static_cast<uint8_t>(h[i]);
+    }
+}
+
+std::string base64(const uint8_t* data, size_t size) {
+    static const char* kAlphabet = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+    std::string out;
+    out.reserve((size + 2) / 3 * 4);
+    for (size_t i = 0; i < size; i += 3) {
+        uint32_t n = uint32_t(data[i]) << 16;
+        if (i + 1 < size) n |= uint32_t(data[i + 1]) << 8;
+        if (i + 2 < size) n |= data[i + 2];
+
+        out.push_back(kAlphabet[(n >> 18) & 0x3F]);
+        out.push_back(kAlphabet[(n >> 12) & 0x3F]);
+        out.push_back(i + 1 < size ? kAlphabet[(n >> 6) & 0x3F] : '=');
+        out.push_back(i + 2 < size ? kAlphabet[n & 0x3F] : '=');
+    }
+    return out;
+}
+
+}  // namespace
+
+std::string acceptKey(const std::string& clientKey) {
+    uint8_t digest[20];
+    sha1(clientKey + kHandshakeGuid, digest);
+    return base64(digest, sizeof(digest));
+}
+
+void appendFrame(std::string& out, Opcode opcode, const char* payload, size_t size) {
+    out.push_back(static_cast<char>(0x80 | opcode));
+
+    if (size < 126) {
+        out.push_back(static_cast<char>(size));
+    } else if (size <= 0xFFFF) {
+        out.push_back(static_cast<char>(126));
+        out.push_back(static_cast<char>((size >> 8) & 0xFF));
+        out.push_back(static_cast<char>(size & 0xFF));
+    } else {
+        out.push_back(static_cast<char>(127));
+        for (int i = 7; i >= 0; --i) {
+            out.push_back(static_cast<char>((static_cast<uint64_t>(size) >> (i * 8)) & 0xFF));
+        }
+    }
+
+    out.append(payload, size);
+}
+
+ParseResult parseFrame(const char* data, size_t size, Frame& frame, size_t& consumed, size_t maxPayload) {
+    consumed = 0;
+    if (size < 2) {
+        return ParseResult::INCOMPLETE;
+    }
+
+    const auto* p = reinterpret_cast<const uint8_t*>(data);
+    frame.fin = (p[0] & 0x80) != 0;
+    frame.opcode = static_cast<Opcode>(p[0] & 0x0F);
+
+    bool masked = (p[1] & 0x80) != 0;
+    if (!masked) {
+        // 客户端发往服务端的帧必须加掩码
+        return ParseResult::ERROR;
+    }
+
+    uint64_t length = p[1] & 0x7F;
+    size_t header = 2;
+    if (length == 126) {
+        if (size < 4) return ParseResult::INCOMPLETE;
+        length = (uint64_t(p[2]) << 8) | p[3];
+        header = 4;
+    } else if (length == 127) {
+        if (size < 10) return ParseResult::INCOMPLETE;
+        length = 0;
+        for (int i = 0; i < 8; ++i) {
+            length = (length << 8) | p[2 + i];
+        }
+        header = 10;
+    }
+
+    if ((frame.opcode & 0x8) != 0 && length > 125) {
+        return ParseResult::ERROR;
+    }
+    if (length > maxPayload) {
+        return ParseResult::ERROR;
+    }
+
+    if (size < header + 4 + length) {
+        return ParseResult::INCOMPLETE;
+    }
+
+    const uint8_t* mask = p + header;
+    const uint8_t* payload = mask + 4;
+    frame.payload.resize(length);
+    for (uint64_t i = 0; i < length; ++i) {
+        frame.payload[i] = static_cast<char>(payload[i] ^ mask[i & 3]);
+    }
+
+    consumed = header + 4 + length;
+    return ParseResult::COMPLETE;
+}
+
+}  // namespace websocket
+}  // namespace musicfree
@@ -0,0 +1,65 @@
+#ifndef MUSICFREE_WEBSOCKET_H
+#define MUSICFREE_WEBSOCKET_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace musicfree {
+
+/**
+ * WebSocket（RFC 6455）的最小实现：握手应答和帧编解码
+ * 服务端只发送文本 / 控制帧，不支持分片消息和扩展
+ */
+namespace websocket {
+
+enum Opcode : uint8_t {
+    CONTINUATION = 0x0,
+    TEXT = 0x1,
+    BINARY = 0x2,
+    CLOSE = 0x8,
+    PING = 0x9,
+    PONG = 0xA
+};
+
+/**
+ * 根据客户端的 Sec-WebSocket-Key 计算 Sec-WebSocket-Accept
+ */
+std::string acceptKey(const std::string& clientKey);
+
+/**
+ * 追加一个服务端帧（不加掩码，FIN=1）
+ */
+void appendFrame(std::string& out, Opcode opcode, const char* payload, size_t size);
+
+/**
+ * 客户端帧
+ */
+struct Frame {
+    Opcode opcode = TEXT;
+    bool fin = true;
+    std::string payload;  // 已去掉掩码
+};
+
+enum class ParseResult {
+    INCOMPLETE = 0,
+    COMPLETE = 1,
+    ERROR = 2   // 未加掩码、控制帧过长或长度超出上限
+};
+
+/**
+ * 从缓冲区解析一个客户端帧
+ * @param data 输入
+ * @param size 可用字节数
+ * @param frame 输出：帧
+ * @param consumed 输出：返回 COMPLETE 时该帧占用的字节数
+ * @param maxPayload 允许的最大负载长度
+ */
+ParseResult parseFrame(const char* data, size_t size, Frame& frame, size_t& consumed,
+                       size_t maxPayload = 64 * 1024);
+
+}  // namespace websocket
+
+}  // namespace musicfree
+
+#endif  // MUSICFREE_WEBSOCKET_H
@@ -0,0 +1,59 @@
+/**
+ * 插件管理器实现
+ * TODO: 动态库插件加载（.dll / .so）尚未实现
+ */
+
+#include "../include/plugin_manager.h"
+#include <iostream>
+
+namespace musicfree {
+
+PluginManager& PluginManager::getInstance() {
+    static PluginManager instance;
+    return instance;
+}
+
+bool PluginManager::loadPlugin(const std::string& pluginPath) {
+    // TODO: 使用 dlopen / LoadLibrary 加载插件并调用其工厂函数
+    std::cerr << "Plugin loading is not supported yet: " << pluginPath << std::endl;
+    return false;
+}
+
+bool PluginManager::unloadPlugin(const std::string& pluginName) {
+    auto it = plugins_.find(pluginName);
+    if (it == plugins_.end()) {
+        return false;
+    }
+
+    it->second->shutdown();
+    plugins_.erase(it);
+    return true;
+}
+
+std::vector<std::string> PluginManager::getLoadedPlugins() const {
+    std::vector<std::string> names;
+    names.reserve(plugins_.size());
+    for (const auto& entry : plugins_) {
+        names.push_back(entry.first);
+    }
+    return names;
+}
+
+IPlugin* PluginManager::getPlugin(const std::string& pluginName) const {
+    auto it = plugins_.find(pluginName);
+    if (it == plugins_.end()) {
+        return nullptr;
+    }
+    return it->second.get();
+}
+
+std::vector<Track> PluginManager::searchMusic(const std::string& query) {
+    std::vector<Track> results;
+    for (const auto& entry : plugins_) {
+        auto tracks = entry.second->searchMusic(query);
+        results.insert(results.end(), tracks.begin(), tracks.end());
+    }
+    return results;
+}
+
+}  // namespace musicfree
@@ -4,7 +4,7 @@
  */
 
 import React, { useState, useEffect } from 'react';
-import { playerAPI, PlayerStatus } from '../services/api';
+import { playerAPI, eventsAPI, PlayerStatus } from '../services/api';
 
 export const Player: React.FC = () => {
   const [status, setStatus] = useState<PlayerStatus | null>(null);
@@ -22,12 +22,22 @@ export const Player: React.FC = () => {
     }
   };
 
-  // 初始化时获取状态
+  // 订阅后端推送的播放器事件，不再轮询状态
   useEffect(() => {
-    updateStatus();
-    // 每秒更新一次播放位置
-    const interval = setInterval(updateStatus, 1000);
-    return () => clearInterval(interval);
+    return eventsAPI.subscribe({
+      onStatus: (newStatus) => {
+        setStatus(newStatus);
+        setError(null);
+      },
+      onState: (state) => setStatus((prev) => (prev ? { ...prev, state } : prev)),
+      onPosition: (position) => setStatus((prev) => (prev ? { ...prev, position } : prev)),
+      // 无缝切换到下一首：换成新的轨道信息和时长，位置从头开始
+      onTrackChanged: (track) =>
+        setStatus((prev) =>
+          prev ? { ...prev, currentTrack: track, duration: track.duration, position: 0 } : prev
+        ),
+      onError: () => setError('与后端的事件连接已断开，正在重连...')
+    });
   }, []);
 
   // 播放
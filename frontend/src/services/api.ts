@@ -84,7 +84,8 @@ export const playerAPI = {
    */
   async play(): Promise<void> {
     const response = await fetch(`${API_BASE_URL}/player/play`, {
-      method: 'POST'
+      method: 'POST',
+      headers: { 'Content-Type': 'application/json' }
     });
     await handleResponse(response);
   },
@@ -94,7 +95,8 @@ export const playerAPI = {
    */
   async pause(): Promise<void> {
     const response = await fetch(`${API_BASE_URL}/player/pause`, {
-      method: 'POST'
+      method: 'POST',
+      headers: { 'Content-Type': 'application/json' }
     });
     await handleResponse(response);
   },
@@ -104,7 +106,8 @@ export const playerAPI = {
    */
   async stop(): Promise<void> {
     const response = await fetch(`${API_BASE_URL}/player/stop`, {
-      method: 'POST'
+      method: 'POST',
+      headers: { 'Content-Type': 'application/json' }
     });
     await handleResponse(response);
   },
@@ -141,6 +144,14 @@ export const playerAPI = {
   async getStatus(): Promise<PlayerStatus> {
     const response = await fetch(`${API_BASE_URL}/player/status`);
     return handleResponse(response);
+  },
+
+  /**
+   * 获取已加载本地轨道的音频流地址（支持 Range，可直接用于 <audio> 播放和拖动）
+   * @param trackId 轨道ID
+   */
+  getStreamUrl(trackId: string): string {
+    return `${API_BASE_URL}/stream/${encodeURIComponent(trackId)}`;
   }
 };
 
@@ -168,6 +179,19 @@ export const playlistAPI = {
     return handleResponse(response);
   },
 
+  /**
+   * 批量添加轨道（一次请求）
+   * @param tracks 轨道列表
+   */
+  async addTracks(tracks: Track[]): Promise<Playlist> {
+    const response = await fetch(`${API_BASE_URL}/playlist/add`, {
+      method: 'POST',
+      headers: { 'Content-Type': 'application/json' },
+      body: JSON.stringify(tracks)
+    });
+    return handleResponse(response);
+  },
+
   /**
    * 删除播放列表中的轨道
    * @param index 轨道索引
@@ -184,7 +208,8 @@ export const playlistAPI = {
    */
   async clear(): Promise<void> {
     const response = await fetch(`${API_BASE_URL}/playlist/clear`, {
-      method: 'POST'
+      method: 'POST',
+      headers: { 'Content-Type': 'application/json' }
     });
     await handleResponse(response);
   },
@@ -245,6 +270,20 @@ export const userAPI = {
     await handleResponse(response);
   },
 
+  /**
+   * 批量添加到收藏（一次请求），已收藏的轨道会被跳过
+   * @param tracks 轨道列表
+   * @returns 添加后的收藏列表
+   */
+  async addFavorites(tracks: Track[]): Promise<Track[]> {
+    const response = await fetch(`${API_BASE_URL}/favorites`, {
+      method: 'POST',
+      headers: { 'Content-Type': 'application/json' },
+      body: JSON.stringify(tracks)
+    });
+    return handleResponse(response);
+  },
+
   /**
    * 从收藏删除
    * @param trackId 轨道ID
@@ -276,6 +315,87 @@ export const userAPI = {
   }
 };
 
+// ===== 批量操作 API =====
+
+export type BatchOperation =
+  | { op: 'player/load'; filePath: string }
+  | { op: 'player/play' | 'player/pause' | 'player/stop' | 'player/status' }
+  | { op: 'player/seek'; position: number }
+  | { op: 'player/volume'; volume: number }
+  | { op: 'playlist/add'; track?: Track; tracks?: Track[] }
+  | { op: 'playlist/remove'; index: number }
+  | { op: 'playlist/clear' | 'playlist/next' | 'playlist/prev' };
+
+export interface BatchResult {
+  op: string;
+  status: number;
+  message?: string;
+  track?: Track;
+  trackCount?: number;
+}
+
+export interface BatchResponse {
+  results: BatchResult[];
+  player: PlayerStatus;
+  playlist: { version: number; trackCount: number };
+}
+
+export const batchAPI = {
+  /**
+   * 在一次请求中按顺序执行多个操作（例如 清空 → 添加 → 加载 → 播放）
+   * 服务器在一次加锁内执行全部操作，每个操作的结果单独返回
+   * @param ops 操作列表
+   * @param stopOnError 为 true 时第一个失败之后的操作不执行
+   */
+  async run(ops: BatchOperation[], stopOnError = false): Promise<BatchResponse> {
+    const response = await fetch(`${API_BASE_URL}/batch`, {
+      method: 'POST',
+      headers: { 'Content-Type': 'application/json' },
+      body: JSON.stringify({ ops, stopOnError })
+    });
+    return handleResponse(response);
+  }
+};
+
+// ===== 事件推送 API =====
+
+export interface PlayerEventHandlers {
+  onStatus?: (status: PlayerStatus) => void;
+  onState?: (state: PlayerStatus['state']) => void;
+  onPosition?: (position: number) => void;
+  onTrackEnded?: () => void;
+  onTrackChanged?: (track: Track) => void;
+  onPlaylistChanged?: (change: { version: number; trackCount: number }) => void;
+  onError?: (event: Event) => void;
+}
+
+export const eventsAPI = {
+  /**
+   * 订阅播放器事件（Server-Sent Events），替代轮询 /player/status
+   * 连接建立（以及断线重连）时先收到一条完整的 status 事件
+   * @param handlers 事件处理函数
+   * @returns 取消订阅函数
+   */
+  subscribe(handlers: PlayerEventHandlers): () => void {
+    const source = new EventSource(`${API_BASE_URL}/events`);
+    const listen = (name: string, handler: (data: any) => void) => {
+      source.addEventListener(name, (event) => {
+        handler(JSON.parse((event as MessageEvent).data));
+      });
+    };
+
+    listen('status', (data) => handlers.onStatus?.(data));
+    listen('state', (data) => handlers.onState?.(data.state));
+    listen('position', (data) => handlers.onPosition?.(data.position));
+    listen('trackEnded', () => handlers.onTrackEnded?.());
+    listen('trackChanged', (data) => handlers.onTrackChanged?.(data));
+    listen('playlistChanged', (data) => handlers.onPlaylistChanged?.(data));
+    source.onerror = (event) => handlers.onError?.(event);
+
+    return () => source.close();
+  }
+};
+
 // ===== 系统 API =====
 
 export const systemAPI = {
@@ -293,6 +413,14 @@ export const systemAPI = {
   async healthCheck(): Promise<{ status: 'ok'; version: string }> {
     const response = await fetch(`${API_BASE_URL}/health`);
     return handleResponse(response);
+  },
+
+  /**
+   * 获取运行指标（Prometheus 文本格式）
+   */
+  async getMetrics(): Promise<string> {
+    const response = await fetch(`${API_BASE_URL}/metrics`);
+    return handleResponse(response);
   }
 };
 
@@ -301,6 +429,8 @@ export default {
   playlistAPI,
   searchAPI,
   userAPI,
+  batchAPI,
+  eventsAPI,
   systemAPI,
   ApiError
 };